@@ -14,6 +14,7 @@ limitations under the License.
 */
 
 #include <glob.h>
+#include <dirent.h>
 #include <stdlib.h>
 #include <sys/stat.h>
 #include <string.h>
@@ -47,6 +48,47 @@ int isDirectory(const char* filename) {
 	return S_ISDIR(s.st_mode);
 }
 
+struct DirectoryStream {
+	DIR* dir;
+};
+
+DirectoryStream* openDirectory(const char* path) {
+	DirectoryStream* ds;
+	DIR* dir = opendir(path);
+	if(dir == NULL)
+		return NULL;
+	ds = (DirectoryStream*)malloc(sizeof(DirectoryStream));
+	ds->dir = dir;
+	return ds;
+}
+
+int readDirectory(DirectoryStream* ds, DirectoryEntry* entry) {
+	struct dirent* d;
+	do {
+		d = readdir(ds->dir);
+		if(d == NULL)
+			return 0;
+	} while(!strcmp(d->d_name, ".") || !strcmp(d->d_name, ".."));
+	entry->name = d->d_name;
+	entry->haveInfo = 0;
+#if defined(_DIRENT_HAVE_D_TYPE) || defined(DT_DIR)
+	switch(d->d_type) {
+	case DT_REG: entry->type = FILELIST_TYPE_FILE; break;
+	case DT_DIR: entry->type = FILELIST_TYPE_DIRECTORY; break;
+	case DT_UNKNOWN: case DT_LNK: entry->type = FILELIST_TYPE_UNKNOWN; break;
+	default: entry->type = FILELIST_TYPE_OTHER;
+	}
+#else
+	entry->type = FILELIST_TYPE_UNKNOWN;
+#endif
+	return 1;
+}
+
+void closeDirectory(DirectoryStream* ds) {
+	closedir(ds->dir);
+	free(ds);
+}
+
 int compareTime(const char* file1, const char* file2) {
 	struct stat s1, s2;
 	time_t t1, t2;
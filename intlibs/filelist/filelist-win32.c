@@ -21,6 +21,7 @@ limitations under the License.
 #include <windows.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include "filelist.h"
 
 #ifdef _WIN32_WCE
@@ -67,6 +68,85 @@ int scanDirectory(const char* path, FileListCallback cb) {
 	return 0;
 }
 
+struct DirectoryStream {
+	HANDLE h;
+	WIN32_FIND_DATA wfd;
+	// Non-zero if wfd holds an entry that has not been returned yet.
+	int pending;
+#ifdef _WIN32_WCE
+	char name[MAX_PATH];
+#endif
+};
+
+DirectoryStream* openDirectory(const char* path) {
+	char pattern[MAX_PATH];
+#ifdef _WIN32_WCE
+	WCHAR tpattern[MAX_PATH];
+#else
+	const char* tpattern = pattern;
+#endif
+	DirectoryStream* ds;
+	size_t len = strlen(path);
+	if(len + 3 > MAX_PATH)
+		return NULL;
+	memcpy(pattern, path, len);
+	if(len > 0 && path[len-1] != '/' && path[len-1] != '\\')
+		pattern[len++] = '/';
+	pattern[len++] = '*';
+	pattern[len] = 0;
+#ifdef _WIN32_WCE
+	convertAsciiToUnicode(tpattern, MAX_PATH, pattern);
+#endif
+
+	ds = (DirectoryStream*)malloc(sizeof(DirectoryStream));
+	ds->h = FindFirstFile(tpattern, &ds->wfd);
+	if(ds->h == INVALID_HANDLE_VALUE) {
+		free(ds);
+		return NULL;
+	}
+	ds->pending = 1;
+	return ds;
+}
+
+int readDirectory(DirectoryStream* ds, DirectoryEntry* entry) {
+	const WIN32_FIND_DATA* w = &ds->wfd;
+	ULARGE_INTEGER t;
+	const char* name;
+	do {
+		if(!ds->pending && !FindNextFile(ds->h, &ds->wfd))
+			return GetLastError() == ERROR_NO_MORE_FILES ? 0 : -1;
+		ds->pending = 0;
+#ifdef _WIN32_WCE
+		convertUnicodeToAscii(ds->name, MAX_PATH, w->cFileName);
+		name = ds->name;
+#else
+		name = w->cFileName;
+#endif
+	} while(!strcmp(name, ".") || !strcmp(name, ".."));
+
+	entry->name = name;
+	if(w->dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)
+		entry->type = FILELIST_TYPE_DIRECTORY;
+	else if(w->dwFileAttributes & FILE_ATTRIBUTE_DEVICE)
+		entry->type = FILELIST_TYPE_OTHER;
+	else
+		entry->type = FILELIST_TYPE_FILE;
+
+	// The find data has the size and date, so stat() isn't needed.
+	entry->haveInfo = 1;
+	entry->size = ((long long)w->nFileSizeHigh << 32) | w->nFileSizeLow;
+	// FILETIME counts 100ns intervals since 1601.
+	t.LowPart = w->ftLastWriteTime.dwLowDateTime;
+	t.HighPart = w->ftLastWriteTime.dwHighDateTime;
+	entry->mtime = (time_t)(t.QuadPart / 10000000 - 11644473600LL);
+	return 1;
+}
+
+void closeDirectory(DirectoryStream* ds) {
+	FindClose(ds->h);
+	free(ds);
+}
+
 int isDirectory(const char* filename) {
 #ifdef _WIN32_WCE
 	WCHAR tfn[MAX_PATH];
@@ -16,6 +16,8 @@ limitations under the License.
 #ifndef FILELIST_H
 #define FILELIST_H
 
+#include <time.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -33,6 +35,37 @@ int scanDirectory(const char* path, FileListCallback cb);
 //Returns <0 if the file does not exist or is inaccessible.
 int isDirectory(const char* filename);
 
+// Types of DirectoryEntry.
+#define FILELIST_TYPE_UNKNOWN 0
+#define FILELIST_TYPE_FILE 1
+#define FILELIST_TYPE_DIRECTORY 2
+#define FILELIST_TYPE_OTHER 3
+
+typedef struct DirectoryEntry {
+	// Contains only the filename. Valid until the next call to
+	// readDirectory() or closeDirectory().
+	const char* name;
+	// FILELIST_TYPE_UNKNOWN if the file system didn't tell.
+	int type;
+	// Non-zero if size and mtime are valid; some file systems report them
+	// while listing, others must be asked with stat().
+	int haveInfo;
+	long long size;
+	time_t mtime;
+} DirectoryEntry;
+
+typedef struct DirectoryStream DirectoryStream;
+
+// Opens the directory \a path, without wildcards, for reading one entry at a time.
+// Returns NULL on failure.
+DirectoryStream* openDirectory(const char* path);
+
+// Reads the next entry, skipping "." and "..".
+// Returns 1 on success, 0 at the end of the directory, <0 on failure.
+int readDirectory(DirectoryStream* ds, DirectoryEntry* entry);
+
+void closeDirectory(DirectoryStream* ds);
+
 // Returns a malloc'd string containing the absolute path of the file
 // referred to by \a name.
 // \a name is a relative filename.
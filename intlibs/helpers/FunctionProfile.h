@@ -0,0 +1,58 @@
+/* Copyright 2013 David Axmark
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+	http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+// The function profile that MoRE writes to fp.bin, when it's built with
+// FUNCTION_PROFILING. tools/fpconv converts it to fp.xml, for ProfileViewer,
+// and to folded stacks.
+//
+// The file is a FunctionProfileHeader, followed by nodeCount
+// FunctionProfileNodes and nameCount names. Each name is an s32 ip,
+// an s32 length and that many characters, without a terminator.
+// All values are in the byte order of the host that wrote the file.
+//
+// There is one node for every call path. The first node is the root, which
+// is the program's entry point; every other node's parent comes before it.
+
+#ifndef FUNCTION_PROFILE_H
+#define FUNCTION_PROFILE_H
+
+#include "types.h"
+
+#define FUNCTION_PROFILE_MAGIC "MAFP"
+#define FUNCTION_PROFILE_VERSION 1
+
+struct FunctionProfileHeader {
+	char magic[4];
+	s32 version;
+	s32 nodeCount;
+	s32 nameCount;
+	// the unit of the node times.
+	s64 ticksPerSecond;
+};
+
+struct FunctionProfileNode {
+	// time from call to return, including the callees.
+	s64 totalTicks;
+	// totalTicks, without the callees' totalTicks.
+	s64 selfTicks;
+	// index of the parent node, or -1 for the root.
+	s32 parent;
+	// the function's address, or minus the syscall number.
+	s32 ip;
+	u32 count;
+	u32 reserved;
+};
+
+#endif	//FUNCTION_PROFILE_H
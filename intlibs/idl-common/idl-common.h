@@ -157,6 +157,9 @@ void streamIoctlFunction(ostream& stream, const Interface& inf, const Function&
 void streamCppDefs(ostream& stream, const Interface& inf, int ix, const string& headerName);
 
 void streamInvokeSyscall(ostream&, const Interface&, bool java, int argOffset = 0);
+// Version 2 extension ABI, see runtimes/cpp/core/extensionCommon.h.
+void streamTypedInvokeExtension(ostream&, const Interface&);
+void streamTypedBlockDefines(ostream&, const Interface&);
 void streamHeaderFunctions(ostream& stream, const Interface& inf, bool syscall);
 
 std::string getCSharpType(const Interface& maapi, const std::string& maapiType, bool in);
@@ -605,25 +605,20 @@ static bool isctc(int c) {
 	return isalnum(c) || c == '_';
 }
 
-static void streamArgRange(ostream& stream, const vector<Argument>& args,
-	const string& range)
-{
-	stream << ", ";
-	// tokenize range expression.
-	// for each token, compare to args.
-	// on match, add "_".
-	//arg.range;
+// Returns \a expr with each token that names an argument prefixed with "_".
+static string argExpression(const vector<Argument>& args, const string& expr) {
+	string result;
 	size_t pos = 0;
-	while(pos < range.length()) {
+	while(pos < expr.length()) {
 		size_t beg = pos;
-		bool cToken = isctc(range[beg]);
+		bool cToken = isctc(expr[beg]);
 		size_t end = beg + 1;
-		while(end < range.length()) {
-			if(isctc(range[end]) != cToken)
+		while(end < expr.length()) {
+			if(isctc(expr[end]) != cToken)
 				break;
 			end++;
 		}
-		string token = range.substr(beg, end - beg);
+		string token = expr.substr(beg, end - beg);
 		pos = end;
 
 		// we now have a token.
@@ -631,14 +626,46 @@ static void streamArgRange(ostream& stream, const vector<Argument>& args,
 		for(size_t i=0; i<args.size(); i++) {
 			if(token == args[i].name) {
 				match = true;
-				stream << "_" << token;
+				result += "_" + token;
 				break;
 			}
 		}
 		if(!match)
-			stream << token;
+			result += token;
 	}
-	stream << ")";
+	return result;
+}
+
+// A range that is a product, like "count * 8", is computed with
+// validatedRangeProduct(), so that a large count can't wrap it around
+// to a small size that passes validation.
+static void streamArgRange(ostream& stream, const vector<Argument>& args,
+	const string& range)
+{
+	stream << ", ";
+	vector<string> factors;
+	size_t pos = 0;
+	while(pos <= range.length()) {
+		size_t end = range.find('*', pos);
+		if(end == string::npos)
+			end = range.length();
+		string factor = range.substr(pos, end - pos);
+		size_t first = factor.find_first_not_of(" \t");
+		size_t last = factor.find_last_not_of(" \t");
+		if(first != string::npos)
+			factor = factor.substr(first, last - first + 1);
+		factors.push_back(argExpression(args, factor));
+		pos = end + 1;
+	}
+	string size = factors[0];
+	for(size_t i=1; i<factors.size(); i++)
+		size = "validatedRangeProduct(" + size + ", " + factors[i] + ")";
+	stream << size << ")";
+}
+
+// A double input takes two ioctl argument slots, hi and lo.
+static size_t ioctlArgSlots(const Interface& inf, const Argument& arg) {
+	return (arg.in && resolveType(inf, cType(inf, arg.type)) == "double") ? 2 : 1;
 }
 
 static void streamIoctlArg(ostream& stream, const vector<Argument>& args,
@@ -698,7 +725,7 @@ static void streamIoctlArg(ostream& stream, const vector<Argument>& args,
 			if(arg.range.empty()) {
 				stream << "GVMR(";
 			} else {
-				stream << "(" << arg.type << ") SYSCALL_THIS->GetValidatedMemRange(";
+				stream << "(" << ctype << ") SYSCALL_THIS->GetValidatedMemRange(";
 			}
 		} else if(ctype != "int")
 			stream << "(" << ctype << ")";
@@ -770,15 +797,17 @@ void streamIoctlDefines(ostream& stream, const Interface& inf, const string& hea
 			stream << "#define " << ioctl.name << "_" << f.f.name << "_case(func) \\\n";
 			stream << "case " << f.f.number << ": \\\n";
 			stream << "{ \\\n";
-			for(size_t k = 0, inK = 0; k < f.f.args.size(); k++, inK++) {
+			for(size_t k = 0, inK = 0; k < f.f.args.size(); k++) {
 				const Argument& arg(f.f.args[k]);
 				if(arg.range.empty())
 					streamIoctlArg(stream, f.f.args, arg, inf, inK, java);
+				inK += ioctlArgSlots(inf, arg);
 			}
-			for(size_t k = 0, inK = 0; k < f.f.args.size(); k++, inK++) {
+			for(size_t k = 0, inK = 0; k < f.f.args.size(); k++) {
 				const Argument& arg(f.f.args[k]);
 				if(!arg.range.empty())
 					streamIoctlArg(stream, f.f.args, arg, inf, inK, java);
+				inK += ioctlArgSlots(inf, arg);
 			}
 
 			string resolvedReturnType = resolveType(inf, f.f.returnType);
@@ -981,7 +1010,11 @@ void streamInvokeSyscall(ostream& stream, const Interface& maapi, bool java, int
 			if(argType == "double" || argType == "long")
 				sizeOfArgType = 2;
 
-			stream << "\t" << argType << " " << a.name << " = _SYSCALL_CONVERT_" << convType;
+			// raw pointer types only occur in extensions.
+			if(!java && convType[convType.size()-1] == '*')
+				stream << "\t" << argType << " " << a.name << " = (" << argType << ")_SYSCALL_CONVERT_MAAddress";
+			else
+				stream << "\t" << argType << " " << a.name << " = _SYSCALL_CONVERT_" << convType;
 			if(ireg+sizeOfArgType>4) {
 				if(java) {
 					stream << "(RINT(REG(REG_sp)+" << (stack_ireg<<2) << ")";
@@ -1036,6 +1069,109 @@ void streamInvokeSyscall(ostream& stream, const Interface& maapi, bool java, int
 	}
 }
 
+static int typedWords(const Interface& inf, const string& type) {
+	string ct = cType(inf, type);
+	return (ct == "double" || ct == "long long") ? 2 : 1;
+}
+
+static int typedArgWords(const Interface& inf, const Function& f) {
+	int words = 0;
+	for(size_t j=0; j<f.args.size(); j++) {
+		const Argument& a(f.args[j]);
+		words += (isPointerType(inf, a.type) || !a.in) ? 1 : typedWords(inf, a.type);
+	}
+	return words;
+}
+
+static int typedResultWords(const Interface& inf, const Function& f) {
+	if(f.returnType == "void" || f.returnType == "noreturn")
+		return 0;
+	return typedWords(inf, f.returnType);
+}
+
+void streamTypedInvokeExtension(ostream& stream, const Interface& inf) {
+	for(size_t i=0; i<inf.functions.size(); i++) {
+		const Function& f(inf.functions[i]);
+		stream << "static int typed_" << f.name << "(int* block, const ExtensionMemory* mem) {\n";
+
+		// scalars first, so that ranges may refer to them.
+		int word = 0;
+		for(size_t j=0; j<f.args.size(); j++) {
+			const Argument& a(f.args[j]);
+			if(isPointerType(inf, a.type) || !a.in) {
+				word++;
+				continue;
+			}
+			string ct = cType(inf, a.type);
+			stream << "\t" << ct << " " << a.name << ";\n";
+			stream << "\tmemcpy(&" << a.name << ", block + " << word << ", sizeof(" << ct << "));\n";
+			word += typedWords(inf, a.type);
+		}
+
+		// then pointers, each validated once.
+		word = 0;
+		for(size_t j=0; j<f.args.size(); j++) {
+			const Argument& a(f.args[j]);
+			bool pointer = isPointerType(inf, a.type);
+			if(!pointer && a.in) {
+				word += typedWords(inf, a.type);
+				continue;
+			}
+			string ct = cType(inf, a.type);
+			string base = pointer ? ct.substr(0, ct.size() - 1) : ct;
+			string pt = string(a.in ? "const " : "") + base + "*";
+			stream << "\t" << pt << " " << a.name << " = (" << pt << ")";
+			if(!a.range.empty()) {
+				stream << "extensionPointer(mem, block[" << word << "], " << a.range << ");\n";
+			} else if(a.in && base == "char") {
+				stream << "extensionString(mem, block[" << word << "]);\n";
+			} else if(base == "void") {
+				stream << "extensionPointer(mem, block[" << word << "], 0);\n";
+			} else {
+				stream << "extensionPointer(mem, block[" << word << "], sizeof(" << base << "));\n";
+			}
+			stream << "\tif(!" << a.name << ")\n"
+				"\t\treturn EXTENSION_INVALID_ARGUMENT;\n";
+			word++;
+		}
+
+		stream << "\t";
+		if(typedResultWords(inf, f) > 0)
+			stream << cType(inf, f.returnType) << " res = ";
+		stream << f.name << "(";
+		for(size_t j=0; j<f.args.size(); j++) {
+			if(j != 0)
+				stream << ", ";
+			stream << f.args[j].name;
+		}
+		stream << ");\n";
+		if(typedResultWords(inf, f) > 0)
+			stream << "\tmemcpy(block + " << word << ", &res, sizeof(res));\n";
+		stream << "\treturn 0;\n"
+			"}\n\n";
+	}
+
+	stream << "static const TypedFunctionInfo sTypedFunctions[] = {\n";
+	for(size_t i=0; i<inf.functions.size(); i++) {
+		const Function& f(inf.functions[i]);
+		stream << "\t{ typed_" << f.name << ", " << typedArgWords(inf, f) << ", " <<
+			typedResultWords(inf, f) << " },\n";
+	}
+	stream << "};\n";
+}
+
+void streamTypedBlockDefines(ostream& stream, const Interface& inf) {
+	for(size_t i=0; i<inf.functions.size(); i++) {
+		const Function& f(inf.functions[i]);
+		string name = toupper(f.name);
+		int argWords = typedArgWords(inf, f);
+		stream << "#define MX_WORDS_" << name << " " << (argWords + typedResultWords(inf, f)) << "\n";
+		if(typedResultWords(inf, f) > 0)
+			stream << "#define MX_RESULT_" << name << " " << argWords << "\n";
+	}
+	stream << "\n";
+}
+
 std::string getCSharpType(const Interface& maapi, const std::string& maapiType, bool in) {
 	std::string resolvedMaapiType = resolveType(maapi, maapiType);
 	if(resolvedMaapiType == "unsigned char" || resolvedMaapiType == "unsigned int" || resolvedMaapiType == "unsigned long"
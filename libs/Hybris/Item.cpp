@@ -23,7 +23,11 @@ namespace Hybris {
 		id(id), 
 		sprite(sprite), 
 		p(x, y),
-		frame(0) {
+		frame(0),
+		serial(0),
+		slot(0),
+		nextSameId(0),
+		cellX0(0), cellY0(0), cellX1(-1), cellY1(-1) {
 	}
 			
 	int Item::getId() {
@@ -46,13 +50,50 @@ namespace Hybris {
 		sw = i->getSprite()->getWidth();
 		sh = i->getSprite()->getHeight();
 		Rect o2 = Rect(o2p.x-(sw>>1), o2p.y-(sh>>1), sw, sh);
-		return o1.overlaps(o2);
+		if(!o1.overlaps(o2)) return false;
+		if(!sprite->hasCollisionMask() || !i->getSprite()->hasCollisionMask()) return true;
+		return masksOverlap(i, o1, o2);
+	}
+
+	/**
+	 * Returns 32 mask bits starting at pixel x of a row.
+	 */
+	static unsigned int getMaskBits(const unsigned int *row, int x) {
+		int word = x>>5, shift = x&31;
+		if(shift == 0) return row[word];
+		return (row[word]>>shift) | (row[word+1]<<(32-shift));
+	}
+
+	bool Item::masksOverlap(Item *i, const Rect& o1, const Rect& o2) {
+		Sprite *s2 = i->getSprite();
+		if(frame<0 || frame>=sprite->getNumFrames() ||
+			i->frame<0 || i->frame>=s2->getNumFrames()) return true;
+
+		int x0 = o1.x > o2.x ? o1.x : o2.x;
+		int x1 = o1.x+o1.width < o2.x+o2.width ? o1.x+o1.width : o2.x+o2.width;
+		int y0 = o1.y > o2.y ? o1.y : o2.y;
+		int y1 = o1.y+o1.height < o2.y+o2.height ? o1.y+o1.height : o2.y+o2.height;
+		for(int y = y0; y < y1; y++) {
+			const unsigned int *r1 = sprite->getMaskRow(frame, y-o1.y);
+			const unsigned int *r2 = s2->getMaskRow(i->frame, y-o2.y);
+			for(int x = x0; x < x1; x += 32) {
+				int n = x1-x;
+				unsigned int bits = getMaskBits(r1, x-o1.x) & getMaskBits(r2, x-o2.x);
+				if(n < 32) bits &= (1u<<n)-1;
+				if(bits) return true;
+			}
+		}
+		return false;
 	}
 			
 	void Item::setFrame(int frame) {
 		this->frame = frame;
 	}
 			
+	int Item::getFrame() {
+		return frame;
+	}
+
 	void Item::draw() {
 		sprite->draw(p.x, p.y, frame);
 	}	
@@ -21,7 +21,10 @@ limitations under the License.
 
 namespace Hybris {
 
+	class Room;
+
 	class Item {
+		friend class Room;
 		public:
 			Item(int id, Sprite *sprite, int x, int y);
 			int getId();
@@ -36,15 +39,26 @@ namespace Hybris {
 			void moveDown(int amt);
 			
 			void setFrame(int frame);
+			int getFrame();
 			void setAnimation(int startFrame, int startOfAnim, int numFrames);
 			void stepAnimationForward();
 			void stepAnimationBackwards();
 		private:
+			bool masksOverlap(Item *i, const MAUtil::Rect& o1, const MAUtil::Rect& o2);
+
 			int id, frame;
 			MAUtil::Point p;
 			Sprite *sprite;
 			
 			int startOfAnim, numFrames;
+
+			// Maintained by Room: the order the item was made in,
+			// its place in Room's item list, the next item made with the
+			// same id, and the range of grid cells it covers.
+			int serial;
+			int slot;
+			Item *nextSameId;
+			int cellX0, cellY0, cellX1, cellY1;
 	};
 		
 }
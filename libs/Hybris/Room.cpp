@@ -17,8 +17,31 @@ limitations under the License.
 
 #include <conprint.h>
 
+#define DEFAULT_CELL_SIZE 64
+#define MIN_BUCKETS 64
+
 namespace Hybris {
-	Room::Room(int id) : id(id) {
+	Room::Room(int id) :
+		id(id),
+		cellSize(DEFAULT_CELL_SIZE),
+		buckets(0),
+		bucketMask(0),
+		nextSerial(0),
+		deadItems(0) {
+		rebuildGrid(MIN_BUCKETS);
+	}
+
+	Room::~Room() {
+		for(int i = 0; i < items.size(); i++) {
+			delete items[i];
+		}
+		delete[] buckets;
+	}
+
+	void Room::setCellSize(int size) {
+		if(size<1) return;
+		cellSize = size;
+		rebuildGrid(bucketMask+1);
 	}
 		
 	void Room::addCollisionListener(CollisionListener *cl) {
@@ -27,70 +50,122 @@ namespace Hybris {
 		
 	void Room::addSprite(Sprite *sprite) {
 		sprites.add(sprite);
+		spriteMap.insert(sprite->getId(), sprite);
 	}
 		
 	void Room::makeItem(int id, int spriteId, int x, int y) {
-		int i = findSprite(spriteId);
-		if(i==-1) return;
-		Sprite *sprite = sprites[i];
-		items.add(new Item(id, sprite, x, y));
+		Sprite *sprite = findSprite(spriteId);
+		if(!sprite) return;
+		Item *item = new Item(id, sprite, x, y);
+		item->serial = nextSerial++;
+		item->slot = items.size();
+		items.add(item);
+		Item *first = findItem(id);
+		if(first) {
+			// The first item with an id is the one the other calls use.
+			while(first->nextSameId) first = first->nextSameId;
+			first->nextSameId = item;
+		} else {
+			itemMap.insert(id, item);
+		}
+		if(items.size() - deadItems > 2*(bucketMask+1))
+			rebuildGrid(2*(bucketMask+1));
+		else
+			addToGrid(item);
 	}
 		
 	void Room::killItem(int id) {
-		int i = findItem(id);
-		if(i==-1) return;
-		Item *item = items[i];
+		Item *item = findItem(id);
+		if(!item) return;
+		removeFromGrid(item);
+		itemMap.erase(id);
+		if(item->nextSameId)
+			itemMap.insert(id, item->nextSameId);
+		items[item->slot] = 0;
+		deadItems++;
 		delete item;
-		items.remove(i);
+		if(deadItems > items.size()/2)
+			compactItems();
 	}
 		
 	void Room::setItemPosition(int id, int x, int y) {
-		int i = findItem(id);
-		if(i==-1) return;
-		Item *item = items[i];
+		Item *item = findItem(id);
+		if(!item) return;
 		item->setPosition(x, y);
+		updateGrid(item);
 	}
 	
 	void Room::moveItemLeft(int id, int amt) {
-		int i = findItem(id);
-		if(i==-1) return;
-		Item *item = items[i];
+		Item *item = findItem(id);
+		if(!item) return;
 		item->moveLeft(amt);
+		updateGrid(item);
 	}
 	
 	void Room::moveItemUp(int id, int amt) {
-		int i = findItem(id);
-		if(i==-1) return;
-		Item *item = items[i];
+		Item *item = findItem(id);
+		if(!item) return;
 		item->moveUp(amt);	
+		updateGrid(item);
 	}
 	
 	void Room::moveItemRight(int id, int amt) {
-		int i = findItem(id);
-		if(i==-1) return;
-		Item *item = items[i];
+		Item *item = findItem(id);
+		if(!item) return;
 		item->moveRight(amt);		
+		updateGrid(item);
 	}
 	
 	void Room::moveItemDown(int id, int amt) {
-		int i = findItem(id);
-		if(i==-1) return;
-		Item *item = items[i];
+		Item *item = findItem(id);
+		if(!item) return;
 		item->moveDown(amt);		
+		updateGrid(item);
 	}
 		
 	void Room::setItemFrame(int id, int frame) {
-		int i = findItem(id);
-		if(i==-1) return;
-		Item *item = items[i];
+		Item *item = findItem(id);
+		if(!item) return;
 		item->setFrame(frame);		
 	}
 		
 	void Room::update() {
 		for(int i = 0; i < items.size(); i++) {
-			for(int j = i+1; j < items.size(); j++) {
-				if(items[i]->collideWith(items[j])) {
-					fireOnItemCollision(i, items[i]->getSprite()->getId(), j, items[j]->getSprite()->getId());
+			Item *a = items[i];
+			if(!a) continue;
+			candidates.clear();
+			for(int cy = a->cellY0; cy <= a->cellY1; cy++) {
+				for(int cx = a->cellX0; cx <= a->cellX1; cx++) {
+					Vector<Item*>& bucket = getBucket(cx, cy);
+					for(int j = 0; j < bucket.size(); j++) {
+						Item *b = bucket[j];
+						if(b->serial <= a->serial) continue;
+						// Only test a pair in the first cell they share,
+						// which b must actually cover, since cells share buckets.
+						int firstX = a->cellX0 > b->cellX0 ? a->cellX0 : b->cellX0;
+						int firstY = a->cellY0 > b->cellY0 ? a->cellY0 : b->cellY0;
+						if(cx != firstX || cy != firstY) continue;
+						if(cx > b->cellX1 || cy > b->cellY1) continue;
+						candidates.add(b);
+					}
+				}
+			}
+
+			// Items are in the order they were made, so sorting by serial
+			// fires the collisions in the same order as testing every pair.
+			for(int j = 1; j < candidates.size(); j++) {
+				Item *c = candidates[j];
+				int k = j;
+				for(; k > 0 && candidates[k-1]->serial > c->serial; k--) {
+					candidates[k] = candidates[k-1];
+				}
+				candidates[k] = c;
+			}
+
+			for(int j = 0; j < candidates.size(); j++) {
+				Item *b = candidates[j];
+				if(a->collideWith(b)) {
+					fireOnItemCollision(a->getId(), a->getSprite()->getId(), b->getId(), b->getSprite()->getId());
 				}
 			}
 		}
@@ -98,7 +173,7 @@ namespace Hybris {
 		
 	void Room::draw() {
 		for(int i = 0; i < items.size(); i++) {
-			items[i]->draw();
+			if(items[i]) items[i]->draw();
 		}			
 	}
 		
@@ -112,14 +187,97 @@ namespace Hybris {
 		}
 	}
 
-	int Room::findItem(int id) {
-		for(int i = 0; i < items.size(); i++) if(items[i]->getId() == id) { return i; }
-		return -1;
+	Item* Room::findItem(int id) {
+		HashMap<int, Item*>::Iterator itr = itemMap.find(id);
+		if(itr == itemMap.end()) return 0;
+		return itr->second;
 	}
 		
-	int Room::findSprite(int id) {
-		for(int i = 0; i < sprites.size(); i++) if(sprites[i]->getId() == id) { return i; }
-		return -1;
+	Sprite* Room::findSprite(int id) {
+		HashMap<int, Sprite*>::Iterator itr = spriteMap.find(id);
+		if(itr == spriteMap.end()) return 0;
+		return itr->second;
+	}
+
+	static int floorDiv(int a, int b) {
+		return a >= 0 ? a/b : -((-a+b-1)/b);
+	}
+
+	void Room::getCells(Item *item, int& x0, int& y0, int& x1, int& y1) {
+		const Point& p = item->getPosition();
+		int w = item->getSprite()->getWidth();
+		int h = item->getSprite()->getHeight();
+		int left = p.x-(w>>1), top = p.y-(h>>1);
+		// Edges that touch count as a collision, so include them.
+		x0 = floorDiv(left, cellSize);
+		y0 = floorDiv(top, cellSize);
+		x1 = floorDiv(left+w, cellSize);
+		y1 = floorDiv(top+h, cellSize);
+	}
+
+	Vector<Item*>& Room::getBucket(int cx, int cy) {
+		unsigned int h = ((unsigned int)cx*73856093u) ^ ((unsigned int)cy*19349663u);
+		return buckets[h & bucketMask];
+	}
+
+	void Room::addToGrid(Item *item) {
+		getCells(item, item->cellX0, item->cellY0, item->cellX1, item->cellY1);
+		for(int cy = item->cellY0; cy <= item->cellY1; cy++) {
+			for(int cx = item->cellX0; cx <= item->cellX1; cx++) {
+				Vector<Item*>& bucket = getBucket(cx, cy);
+				bool found = false;
+				for(int i = 0; i < bucket.size(); i++) {
+					if(bucket[i] == item) { found = true; break; }
+				}
+				if(!found) bucket.add(item);
+			}
+		}
+	}
+
+	void Room::removeFromGrid(Item *item) {
+		for(int cy = item->cellY0; cy <= item->cellY1; cy++) {
+			for(int cx = item->cellX0; cx <= item->cellX1; cx++) {
+				Vector<Item*>& bucket = getBucket(cx, cy);
+				for(int i = 0; i < bucket.size(); i++) {
+					if(bucket[i] == item) {
+						// Order within a bucket does not matter.
+						bucket[i] = bucket[bucket.size()-1];
+						bucket.resize(bucket.size()-1);
+						break;
+					}
+				}
+			}
+		}
+	}
+
+	void Room::updateGrid(Item *item) {
+		int x0, y0, x1, y1;
+		getCells(item, x0, y0, x1, y1);
+		if(x0 == item->cellX0 && y0 == item->cellY0 && x1 == item->cellX1 && y1 == item->cellY1)
+			return;
+		removeFromGrid(item);
+		addToGrid(item);
+	}
+
+	void Room::rebuildGrid(int numBuckets) {
+		delete[] buckets;
+		buckets = new Vector<Item*>[numBuckets];
+		bucketMask = numBuckets-1;
+		for(int i = 0; i < items.size(); i++) {
+			if(items[i]) addToGrid(items[i]);
+		}
+	}
+
+	// Closes the holes killItem() leaves, keeping the items in order.
+	void Room::compactItems() {
+		int n = 0;
+		for(int i = 0; i < items.size(); i++) {
+			if(!items[i]) continue;
+			items[i]->slot = n;
+			items[n++] = items[i];
+		}
+		items.resize(n);
+		deadItems = 0;
 	}
 
 }
@@ -19,6 +19,7 @@ limitations under the License.
 #include "Sprite.h"
 #include "Item.h"
 #include <MAUtil/Vector.h>
+#include <MAUtil/HashMap.h>
 
 namespace Hybris {	
 	using namespace MAUtil;
@@ -28,9 +29,22 @@ namespace Hybris {
 			virtual void onItemCollision(int itemId1, int spriteId1, int itemId2, int spriteId2) = 0;
 	};
 
+	/**
+	 * Items are kept in a uniform grid of cells, hashed into buckets,
+	 * which is updated when they are made, moved or killed. update()
+	 * only tests items that share a cell, and reports collisions in the
+	 * same order as testing every pair would.
+	 */
 	class Room {
 	public:
 		Room(int id);
+		~Room();
+
+		/**
+		 * Sets the width and height of a grid cell. Cells about the size
+		 * of the largest sprite work best. The default is 64.
+		 */
+		void setCellSize(int size);
 		void addCollisionListener(CollisionListener *cl);
 		void addSprite(Sprite *sprite);
 		void makeItem(int id, int spriteId, int x, int y);
@@ -47,13 +61,31 @@ namespace Hybris {
 		
 	private:
 		void fireOnItemCollision(int itemId1, int spriteId1, int itemId2, int spriteId2);
-		int findItem(int id);
-		int findSprite(int id);
+		Item* findItem(int id);
+		Sprite* findSprite(int id);
+
+		void getCells(Item *item, int& x0, int& y0, int& x1, int& y1);
+		Vector<Item*>& getBucket(int cx, int cy);
+		void addToGrid(Item *item);
+		void removeFromGrid(Item *item);
+		void updateGrid(Item *item);
+		void rebuildGrid(int numBuckets);
+		void compactItems();
 		
 		int id;
+		// Killed items leave a null in their slot until the next compaction.
 		Vector<Item*> items;
+		int deadItems;
 		Vector<CollisionListener*> collisionListeners;
 		Vector<Sprite*> sprites;
+		HashMap<int, Item*> itemMap;
+		HashMap<int, Sprite*> spriteMap;
+
+		int cellSize;
+		Vector<Item*> *buckets;
+		int bucketMask;
+		int nextSerial;
+		Vector<Item*> candidates;
 	};
 }
 
@@ -14,6 +14,8 @@ limitations under the License.
 */
 
 #include "Sprite.h"
+#include <maheap.h>
+#include <mastring.h>
 
 namespace Hybris {
 		Sprite::Sprite(int id, int sizeX, int sizeY, int numFrames, MAHandle image) : 
@@ -21,8 +23,14 @@ namespace Hybris {
 			sizeX(sizeX),
 			sizeY(sizeY),
 			numFrames(numFrames),
-			image(image) {
+			image(image),
+			mask(0),
+			maskWordsPerRow((sizeX+31)>>5) {
 			}
+
+		Sprite::~Sprite() {
+			delete[] mask;
+		}
 			
 		void Sprite::draw(int x, int y, int frame) {
 			if(frame<0 || frame>=numFrames) return;
@@ -47,4 +55,47 @@ namespace Hybris {
 			return sizeY;
 		}
 		
+		int Sprite::getNumFrames() {
+			return numFrames;
+		}
+
+		bool Sprite::createCollisionMask() {
+			MAExtent imageSize = maGetImageSize(image);
+			int imageWidth = EXTENT_X(imageSize);
+			int imageHeight = EXTENT_Y(imageSize);
+			if(imageWidth<sizeX) return false;
+			int framesPerRow = imageWidth/sizeX;
+			if(((numFrames+framesPerRow-1)/framesPerRow)*sizeY > imageHeight) return false;
+
+			int *pixels = new int[sizeX*sizeY];
+			// One extra word, so that rows can be read 32 bits at a time.
+			int words = numFrames*sizeY*maskWordsPerRow+1;
+			unsigned int *bits = new unsigned int[words];
+			memset(bits, 0, words*sizeof(unsigned int));
+			for(int frame = 0; frame < numFrames; frame++) {
+				MARect rect = {(sizeX*frame)%imageWidth, ((sizeX*frame)/imageWidth)*sizeY, sizeX, sizeY};
+				maGetImageData(image, pixels, &rect, sizeX);
+				unsigned int *row = bits + frame*sizeY*maskWordsPerRow;
+				for(int y = 0; y < sizeY; y++, row += maskWordsPerRow) {
+					const int *src = pixels + y*sizeX;
+					for(int x = 0; x < sizeX; x++) {
+						if(src[x]&0xff000000)
+							row[x>>5] |= 1u<<(x&31);
+					}
+				}
+			}
+			delete[] pixels;
+			delete[] mask;
+			mask = bits;
+			return true;
+		}
+
+		bool Sprite::hasCollisionMask() {
+			return mask != 0;
+		}
+
+		const unsigned int* Sprite::getMaskRow(int frame, int y) {
+			return mask + (frame*sizeY + y)*maskWordsPerRow;
+		}
+
 }
\ No newline at end of file
@@ -22,17 +22,36 @@ namespace Hybris {
 	class Sprite {
 	public:
 		Sprite(int id, int sizeX, int sizeY, int numFrames, MAHandle image);
+		~Sprite();
 		void draw(int x, int y, int frame);
 		int getId();
 		int getWidth();
 		int getHeight();
+		int getNumFrames();
+
+		/**
+		 * Precomputes a per-pixel collision mask for each frame from
+		 * the alpha channel of the image. Items with masks on both
+		 * sprites collide only where opaque pixels overlap.
+		 * Returns false if the image could not be read.
+		 */
+		bool createCollisionMask();
+		bool hasCollisionMask();
+
+		/**
+		 * Returns the mask bits of a row of a frame, one bit per pixel
+		 * with the leftmost pixel in the lowest bit of the first word.
+		 */
+		const unsigned int* getMaskRow(int frame, int y);
 	private:
 		MAHandle image;
 		int id;
 		int sizeX;
 		int sizeY;
 		int numFrames;
-			
+		unsigned int *mask;
+		int maskWordsPerRow;
+
 	};
 }
 
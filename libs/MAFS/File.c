@@ -32,8 +32,11 @@ limitations under the License.
 // Magic numbers used in the Bubdle file header.
 // The version 2 Bundle format has an Adler32 checksum
 // in the file header.
+// The version 3 Bundle format replaces the directory tree
+// with a sorted path index, see loadIndex().
 #define MAGIC1 0x12345678 // Bundle version 1 (has no checksum)
 #define MAGIC2 0x22345678 // Bundle version 2 (has Adler32 checksum)
+#define MAGIC3 0x32345678 // Bundle version 3 (has checksum and path index)
 
 // broken header files in linux/native
 int sprintf(char *buf, const char *fmt, ...);
@@ -81,12 +84,16 @@ typedef struct VolumeEntry_t {
 #define TYPE_READWRITE 1
 #define TYPE_WRITEONLY 2
 
+#define MIN(x, y) ((x)<(y)?(x):(y))
+
 #define RES_EOF 1
 #define RES_ERR 2
 
 struct MA_FILE_t {
 	// used for readonly
 	VolumeEntry *volEntry;
+	// version 3 bundles have no tree, volEntry points here.
+	VolumeEntry entry;
 	int filePtr;
 	// ----------------------
 
@@ -120,10 +127,26 @@ typedef struct {
 	int checksum;
 } BundleHeader;
 
+// An entry in the path index of a version 3 bundle.
+// Entries are sorted by path, compared with comparePaths(), case folded.
+// Ties are sorted case sensitively, then in the order the files were added.
+typedef struct {
+	int path;	// offset of the full path in the string table.
+	int type;	// VOL_TYPE_*
+	int dataOffset;
+	int dataLength;
+} IndexEntry;
+
 static MAHandle sCurrentFileSystem = 0;
 static VolumeEntry* sRoot = NULL;
 static BundleHeader sHeader;
 
+// Version 3 path index, all in one allocation, sIndexBlock.
+static int* sIndexBlock = NULL;
+static IndexEntry* sIndex = NULL;
+static int sIndexCount = 0;
+static const char* sStrings = NULL;
+
 static int sCaseSensitive = 0;
 
 static int readString(MAHandle fileSystem, int *offset, char **outString) {
@@ -143,6 +166,53 @@ static int readString(MAHandle fileSystem, int *offset, char **outString) {
 	return i;
 }
 
+static int foldChar(int c, int caseFold) {
+	if(c=='\\') return '/';
+	// c is an unsigned char, as in the Bundle tool.
+	return caseFold ? toupper((unsigned char)c) : c;
+}
+
+/**
+* Compares two paths, treating both kinds of slashes as equal.
+* Must match the ordering used by the Bundle tool.
+*/
+static int comparePaths(const char *a, const char *b, int caseFold) {
+	int ca, cb;
+	do {
+		ca = foldChar((unsigned char)*a++, caseFold);
+		cb = foldChar((unsigned char)*b++, caseFold);
+	} while(ca && ca==cb);
+	return ca - cb;
+}
+
+/**
+* Binary search of the path index.
+*/
+static IndexEntry *findIndexEntry(const char *filename) {
+	int lo = 0, hi = sIndexCount;
+	if(filename[0]=='.' && (filename[1]=='\\' || filename[1]=='/')) {
+		filename+=2;
+	}
+
+	// find the first entry that is equal when case folded.
+	while(lo < hi) {
+		int mid = (lo + hi) >> 1;
+		if(comparePaths(sStrings + sIndex[mid].path, filename, 1) < 0)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	for(; lo < sIndexCount; lo++) {
+		const char *path = sStrings + sIndex[lo].path;
+		if(comparePaths(path, filename, 1) != 0)
+			break;
+		if(!sCaseSensitive || comparePaths(path, filename, 0) == 0)
+			return &sIndex[lo];
+	}
+	return NULL;
+}
+
 static VolumeEntry *findFileRecursively(const char *filename, VolumeEntry *root) {
 	int endOfChild = 0;
 	VolumeEntry *findFile = NULL;
@@ -283,6 +353,44 @@ static void readVolumeEntriesRecursively(MAHandle fileSystem, int *offset, Volum
 	}
 }
 
+/**
+* Loads the path index of a version 3 bundle.
+* The index lies between startOfVolumes and startOfData, and is read with a single maReadData:
+* int numEntries;
+* IndexEntry entries[numEntries];
+* char strings[]; // zero-terminated paths, separated by '/'
+*/
+static void loadIndex(MAHandle fileSystem) {
+	int size = sHeader.startOfData - sHeader.startOfVolumes;
+	int i;
+
+	if(size < 4) {
+		maPanic(0, "MAFS: invalid bundle index");
+	}
+	sIndexBlock = (int*)malloc(size);
+	if(!sIndexBlock) {
+		maPanic(0, "MAFS: out of memory");
+	}
+	maReadData(fileSystem, sIndexBlock, sHeader.startOfVolumes, size);
+
+	sIndexCount = sIndexBlock[0];
+	FLIP_TO_ENDIAN_INT(sIndexCount);
+	if(sIndexCount < 0 || sIndexCount > (size - 4) / (int)sizeof(IndexEntry)) {
+		maPanic(0, "MAFS: invalid bundle index");
+	}
+	sIndex = (IndexEntry*)(sIndexBlock + 1);
+	sStrings = (const char*)(sIndex + sIndexCount);
+
+	for(i = 0; i < sIndexCount; i++) {
+		IndexEntry *e = &sIndex[i];
+		FLIP_TO_ENDIAN_INT(e->path);
+		FLIP_TO_ENDIAN_INT(e->type);
+		FLIP_TO_ENDIAN_INT(e->dataOffset);
+		FLIP_TO_ENDIAN_INT(e->dataLength);
+		e->dataOffset += sHeader.startOfData;
+	}
+}
+
 /**
 * Read the header into global variable sHeader.
 * Also set endianess.
@@ -292,7 +400,7 @@ static void readHeader(MAHandle fileSystem)
 	maReadData(fileSystem, &sHeader, 0, sizeof(BundleHeader));
 
 	LOG("0x%08x", sHeader.magic);
-	if (sHeader.magic != MAGIC1 && sHeader.magic != MAGIC2)
+	if (sHeader.magic != MAGIC1 && sHeader.magic != MAGIC2 && sHeader.magic != MAGIC3)
 	{
 		// Wrong endian, needs flipping.
 		sWrongEndian = 1;
@@ -309,7 +417,7 @@ static void readHeader(MAHandle fileSystem)
 	// We won't flip the checksum, no need for that,
 	// and it would break the old file format.
 
-	if (sHeader.magic != MAGIC1 && sHeader.magic != MAGIC2)
+	if (sHeader.magic != MAGIC1 && sHeader.magic != MAGIC2 && sHeader.magic != MAGIC3)
 	{
 		maPanic(0, "sHeader.magic invalid");
 	}
@@ -321,6 +429,11 @@ static void buildDirectoryTree(MAHandle fileSystem) {
 	// Read the header into sHeader.
 	readHeader(fileSystem);
 
+	if(sHeader.magic == MAGIC3) {
+		loadIndex(fileSystem);
+		return;
+	}
+
 	offset = sHeader.startOfVolumes;
 	sRoot = (VolumeEntry*)malloc(sizeof(VolumeEntry));
 	readVolumeEntriesRecursively(fileSystem, &offset, sRoot);
@@ -333,6 +446,13 @@ void freeCurrentFileSystem(void) {
 		freeVolumeEntriesRecursively(sRoot);
 		sRoot = NULL;
 	}
+	if(sIndexBlock) {
+		free(sIndexBlock);
+		sIndexBlock = NULL;
+		sIndex = NULL;
+		sIndexCount = 0;
+		sStrings = NULL;
+	}
 }
 
 void setCurrentFileSystem(MAHandle fileSystem, int caseSensitive) {
@@ -346,7 +466,7 @@ int MAFS_getFileSystemChecksum(MAHandle fileSystem)
 {
 	readHeader(fileSystem);
 
-	if (MAGIC2 == sHeader.magic)
+	if (MAGIC2 == sHeader.magic || MAGIC3 == sHeader.magic)
 	{
 		return sHeader.checksum;
 	}
@@ -417,6 +537,34 @@ static int ensureDirectoryExists(const char* path)
 	return 1;
 }
 
+/**
+ * Helper function that extracts a file.
+ * @param vol The file's volume entry.
+ * @param path Path to the extracted file.
+ * @return 1 on success, -1 on error.
+ */
+static int extractFile(VolumeEntry* vol, const char* path)
+{
+	MAHandle file;
+	int result;
+	void* data;
+
+	// Open file.
+	file = openFileForWriting(path);
+	if (-1 == file) { return -1; }
+
+	// Write data.
+	data = (void*) malloc(vol->dataLength);
+	maReadData(sCurrentFileSystem, data, vol->dataOffset, vol->dataLength);
+	result = maFileWrite(file, data, vol->dataLength);
+	maFileClose(file);
+	free(data);
+	maFileSetProperty(path,MA_FPROP_IS_BACKED_UP,0);
+	if (0 != result) { return -1; }
+
+	return 1;
+}
+
 /**
  * Helper function that extracts directories and files.
  * @param vol Current volume entry that represents a directory of file.
@@ -428,9 +576,7 @@ static int ensureDirectoryExists(const char* path)
 static int extractRecursively(VolumeEntry* vol, const char* basePath, int isRoot)
 {
 	char path[1024];
-	MAHandle file;
 	int result;
-	void* data;
 	int i;
 
 	// If we have no children this is a file.
@@ -438,24 +584,10 @@ static int extractRecursively(VolumeEntry* vol, const char* basePath, int isRoot
 	// added check for type of file (VOL_TYPE_FILE).
 	if (VOL_TYPE_FILE == vol->type && 0 == vol->numChildren)
 	{
-		// Open file.
 		sprintf(path, "%s%s", basePath, vol->name);
 		//MYLOG("@@@EXTRACTING:");
 		//MYLOG(path);
-		file = openFileForWriting(path);
-		if (-1 == file) { return -1; }
-
-		// Write data.
-		data = (void*) malloc(vol->dataLength);
-		maReadData(sCurrentFileSystem, data, vol->dataOffset, vol->dataLength);
-		result = maFileWrite(file, data, vol->dataLength);
-		maFileClose(file);
-		free(data);
-		maFileSetProperty(path,MA_FPROP_IS_BACKED_UP,0);
-		if (0 != result) { return -1; }
-
-		// Done extracting the file.
-		return 1;
+		return extractFile(vol, path);
 	}
 
 	// This is a directory, proceed extracting files and subdirectories.
@@ -484,6 +616,44 @@ static int extractRecursively(VolumeEntry* vol, const char* basePath, int isRoot
 	return 1;
 }
 
+/**
+ * Helper function that extracts a version 3 bundle.
+ * Directories sort before their contents in the path index,
+ * so each one is created before anything is extracted into it.
+ * @param destPath Path to the output directory, must end with a path delimiter.
+ * @return 1 on success, -1 on error.
+ */
+static int extractIndex(const char* destPath)
+{
+	char path[1024];
+	VolumeEntry vol;
+	int result;
+	int i;
+
+	result = ensureDirectoryExists(destPath);
+	if (-1 == result) { return -1; }
+
+	for (i = 0; i < sIndexCount; i++)
+	{
+		vol.type = (unsigned char)sIndex[i].type;
+		vol.dataOffset = sIndex[i].dataOffset;
+		vol.dataLength = sIndex[i].dataLength;
+		if (VOL_TYPE_FILE == vol.type)
+		{
+			sprintf(path, "%s%s", destPath, sStrings + sIndex[i].path);
+			result = extractFile(&vol, path);
+		}
+		else
+		{
+			sprintf(path, "%s%s/", destPath, sStrings + sIndex[i].path);
+			result = ensureDirectoryExists(path);
+		}
+		if (-1 == result) { return -1; }
+	}
+
+	return 1;
+}
+
 /**
 * Extract the current file system bundle to the local file
 * system on the device/emulator.
@@ -496,8 +666,9 @@ static int extractRecursively(VolumeEntry* vol, const char* basePath, int isRoot
 */
 int MAFS_extractCurrentFileSystem(const char* destPath)
 {
-	if (NULL == sRoot) { return -1; }
 	if (NULL == destPath) { return -1; }
+	if (NULL != sIndexBlock) { return extractIndex(destPath); }
+	if (NULL == sRoot) { return -1; }
 
 	return extractRecursively(sRoot, destPath, 1);
 }
@@ -618,28 +789,51 @@ static MA_FILE* openReadWrite(const char *filename, int modeFlags) {
 }
 
 static MA_FILE* openRead(const char *filename, int modeFlags) {
-	VolumeEntry* volEntry;
+	VolumeEntry* volEntry = NULL;
+	IndexEntry* indexEntry = NULL;
 	MA_FILE *file;
 
-	if(!sRoot) {
-		LOG("filesystem not initialized");
-		return NULL;
-	}
+	if(sIndexBlock) {
+		indexEntry = findIndexEntry(filename);
+		if(!indexEntry) {
+			LOG("couldn't find file");
+			return NULL;
+		}
+	} else {
+		if(!sRoot) {
+			LOG("filesystem not initialized");
+			return NULL;
+		}
 
-	volEntry = findFile(filename, sRoot);
-	if(!volEntry) {
-		LOG("couldn't find file");
-		return NULL;
+		volEntry = findFile(filename, sRoot);
+		if(!volEntry) {
+			LOG("couldn't find file");
+			return NULL;
+		}
 	}
 
 	file = (MA_FILE*) malloc(sizeof(MA_FILE));
+	if(!file) return NULL;
+	if(indexEntry) {
+		volEntry = &file->entry;
+		volEntry->type = (unsigned char)indexEntry->type;
+		volEntry->name = (char*)(sStrings + indexEntry->path);
+		volEntry->numChildren = 0;
+		volEntry->children = NULL;
+		volEntry->dataOffset = indexEntry->dataOffset;
+		volEntry->dataLength = indexEntry->dataLength;
+	}
 	file->volEntry = volEntry;
 	file->filePtr = volEntry->dataOffset;
 	file->modeFlags = modeFlags;
 	file->type = TYPE_READONLY;
 
-	file->buffer = (unsigned char*) malloc(BUFFER_SIZE);
-	file->bufferSize = BUFFER_SIZE;
+	// The buffer is allocated by the first small read, see readFromBuffer().
+	// Reads of at least a buffer's worth go straight from the resource
+	// to the caller's memory, so a file that is only read in large blocks
+	// never gets a buffer. It need not be larger than the file.
+	file->buffer = NULL;
+	file->bufferSize = MIN(BUFFER_SIZE, volEntry->dataLength);
 	file->bufferStart = 0x7fffffff;
 	file->resultFlags = 0;
 	//maReadData(currentFileSystem, file->data, file->volEntry->dataOffset, file->volEntry->dataLength);
@@ -664,8 +858,6 @@ MA_FILE * MA_fopen ( const char * filename, const char * mode ) {
 	}
 }
 
-#define MIN(x, y) ((x)<(y)?(x):(y))
-
 static void readFromBuffer(void *ptr, MA_FILE *stream, int bytesToRead) {
 	unsigned char *dst = (unsigned char*)ptr;
 
@@ -676,12 +868,22 @@ static void readFromBuffer(void *ptr, MA_FILE *stream, int bytesToRead) {
 		if(startInBuffer<0 || bytesToReadFromBuffer<=0)
 		{
 			int bytesToBuffer;
-			if(bytesToRead>stream->bufferSize)
+			if(bytesToRead>=stream->bufferSize)
 			{
 				maReadData(sCurrentFileSystem, dst, stream->filePtr, bytesToRead);
 				stream->filePtr+=bytesToRead;
 				return;
 			}
+			if(!stream->buffer)
+			{
+				stream->buffer = (unsigned char*) malloc(stream->bufferSize);
+				if(!stream->buffer)
+				{
+					maReadData(sCurrentFileSystem, dst, stream->filePtr, bytesToRead);
+					stream->filePtr+=bytesToRead;
+					return;
+				}
+			}
 			bytesToBuffer = MIN((stream->volEntry->dataOffset+stream->volEntry->dataLength) - stream->filePtr,
 				stream->bufferSize);
 			maReadData(sCurrentFileSystem, stream->buffer, stream->filePtr, bytesToBuffer);
@@ -0,0 +1,288 @@
+/* Copyright 2013 David Axmark
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+	http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+//
+// GeoPointIndex.cpp
+//
+
+#include "GeoPointIndex.h"
+
+namespace MAP
+{
+	static const int WorldSize = 1 << ( GeoPointIndex::ProjectionMagnification + 8 );
+	// log2 of the width of a grid cell, in pixels at ProjectionMagnification.
+	static const int CellShift = GeoPointIndex::ProjectionMagnification + 8 - GeoPointIndex::GridBits;
+	// Nodes with this few points are scanned rather than split.
+	static const int ScanThreshold = 16;
+
+	//-------------------------------------------------------------------------
+	static int clampToWorld( double v )
+	//-------------------------------------------------------------------------
+	{
+		return v < 0 ? 0 : v > WorldSize - 1 ? WorldSize - 1 : (int)v;
+	}
+
+	//-------------------------------------------------------------------------
+	static double scaleFrom( int magnification )
+	//-------------------------------------------------------------------------
+	{
+		int shift = GeoPointIndex::ProjectionMagnification - magnification;
+		return shift >= 0 ? (double)( 1 << shift ) : 1.0 / (double)( 1 << -shift );
+	}
+
+	//-------------------------------------------------------------------------
+	static int fromProjection( int v, int magnification )
+	//-------------------------------------------------------------------------
+	{
+		int shift = GeoPointIndex::ProjectionMagnification - magnification;
+		if ( shift <= 0 )
+			return v << -shift;
+		// round to nearest, like LonLat::toPixels( )
+		return ( v + ( 1 << ( shift - 1 ) ) ) >> shift;
+	}
+
+	//-------------------------------------------------------------------------
+	static int floorDiv( int a, int b )
+	//-------------------------------------------------------------------------
+	{
+		return a >= 0 ? a / b : -( ( -a + b - 1 ) / b );
+	}
+
+	//-------------------------------------------------------------------------
+	static unsigned int spreadBits( unsigned int v )
+	//-------------------------------------------------------------------------
+	{
+		v = ( v | ( v << 8 ) ) & 0x00FF00FF;
+		v = ( v | ( v << 4 ) ) & 0x0F0F0F0F;
+		v = ( v | ( v << 2 ) ) & 0x33333333;
+		v = ( v | ( v << 1 ) ) & 0x55555555;
+		return v;
+	}
+
+	//-------------------------------------------------------------------------
+	unsigned int GeoPointIndex::cellKey( int x, int y )
+	//-------------------------------------------------------------------------
+	{
+		return spreadBits( (unsigned int)x >> CellShift ) | ( spreadBits( (unsigned int)y >> CellShift ) << 1 );
+	}
+
+	//-------------------------------------------------------------------------
+	GeoPointIndex::GeoPointIndex( )
+	//-------------------------------------------------------------------------
+	{
+	}
+
+	//-------------------------------------------------------------------------
+	void GeoPointIndex::clear( )
+	//-------------------------------------------------------------------------
+	{
+		mEntries.clear( );
+		mPositions.clear( );
+	}
+
+	//-------------------------------------------------------------------------
+	void GeoPointIndex::add( int x, int y )
+	//-------------------------------------------------------------------------
+	{
+		Entry e;
+		e.x = clampToWorld( x );
+		e.y = clampToWorld( y );
+		e.key = cellKey( e.x, e.y );
+		e.item = mEntries.size( );
+		mEntries.add( e );
+	}
+
+	//-------------------------------------------------------------------------
+	void GeoPointIndex::build( )
+	//-------------------------------------------------------------------------
+	{
+		//
+		// Radix sort by key, a byte at a time. Each pass is stable,
+		// so items in the same cell stay in the order they were added.
+		//
+		int n = mEntries.size( );
+		Vector<Entry> sorted( n + 1 );
+		sorted.resize( n );
+		Entry* src = mEntries.pointer( );
+		Entry* dst = sorted.pointer( );
+		for ( int shift = 0; shift < 32; shift += 8 )
+		{
+			int count[257];
+			for ( int i = 0; i < 257; i++ )
+				count[i] = 0;
+			for ( int i = 0; i < n; i++ )
+				count[( ( src[i].key >> shift ) & 0xff ) + 1]++;
+			for ( int i = 1; i < 257; i++ )
+				count[i] += count[i - 1];
+			for ( int i = 0; i < n; i++ )
+				dst[count[( src[i].key >> shift ) & 0xff]++] = src[i];
+			Entry* t = src;
+			src = dst;
+			dst = t;
+		}
+		// after an even number of passes, the result is back in mEntries.
+
+		mPositions.resize( n );
+		for ( int i = 0; i < n; i++ )
+			mPositions[mEntries[i].item] = i;
+	}
+
+	//-------------------------------------------------------------------------
+	void GeoPointIndex::getPixel( int item, int magnification, int& x, int& y ) const
+	//-------------------------------------------------------------------------
+	{
+		const Entry& e = mEntries[mPositions[item]];
+		x = fromProjection( e.x, magnification );
+		y = fromProjection( e.y, magnification );
+	}
+
+	//-------------------------------------------------------------------------
+	int GeoPointIndex::lowerBound( int lo, int hi, unsigned int key ) const
+	//-------------------------------------------------------------------------
+	{
+		const Entry* entries = mEntries.pointer( );
+		while ( lo < hi )
+		{
+			int mid = ( lo + hi ) >> 1;
+			if ( entries[mid].key < key )
+				lo = mid + 1;
+			else
+				hi = mid;
+		}
+		return lo;
+	}
+
+	//-------------------------------------------------------------------------
+	void GeoPointIndex::query( int magnification, int left, int bottom, int right, int top, Vector<GeoPointHit>& hits ) const
+	//-------------------------------------------------------------------------
+	{
+		hits.clear( );
+		if ( mEntries.size( ) == 0 || left > right || bottom > top )
+			return;
+		//
+		// Rectangle in cells, widened by a pixel to allow for rounding.
+		// Points in it are then tested at the query magnification.
+		//
+		double scale = scaleFrom( magnification );
+		int cellLeft = clampToWorld( ( left - 1 ) * scale ) >> CellShift;
+		int cellRight = clampToWorld( ( right + 1 ) * scale ) >> CellShift;
+		int cellBottom = clampToWorld( ( bottom - 1 ) * scale ) >> CellShift;
+		int cellTop = clampToWorld( ( top + 1 ) * scale ) >> CellShift;
+
+		struct Node
+		{
+			int level;
+			int cx;
+			int cy;
+			int lo;
+			int hi;
+		};
+		// each split replaces one node with four.
+		Node stack[3 * GridBits + 1];
+		Node root = { GridBits, 0, 0, 0, mEntries.size( ) };
+		int depth = 0;
+		stack[depth++] = root;
+		const Entry* entries = mEntries.pointer( );
+
+		while ( depth > 0 )
+		{
+			Node node = stack[--depth];
+			int last = ( 1 << node.level ) - 1;
+			if ( node.cx > cellRight || node.cx + last < cellLeft ||
+				node.cy > cellTop || node.cy + last < cellBottom )
+				continue;
+
+			bool inside = node.cx >= cellLeft && node.cx + last <= cellRight &&
+				node.cy >= cellBottom && node.cy + last <= cellTop;
+			if ( inside || node.level == 0 || node.hi - node.lo <= ScanThreshold )
+			{
+				for ( int i = node.lo; i < node.hi; i++ )
+				{
+					const Entry& e = entries[i];
+					int x = fromProjection( e.x, magnification );
+					int y = fromProjection( e.y, magnification );
+					if ( x >= left && x <= right && y >= bottom && y <= top )
+					{
+						GeoPointHit hit = { e.item, x, y, 1 };
+						hits.add( hit );
+					}
+				}
+				continue;
+			}
+			//
+			// Split in four; child k covers keys [base + k * quarter, base + (k + 1) * quarter).
+			// They are pushed last first, so that points come out in key order.
+			//
+			int half = 1 << ( node.level - 1 );
+			unsigned int base = spreadBits( node.cx ) | ( spreadBits( node.cy ) << 1 );
+			unsigned int quarter = 1u << ( 2 * ( node.level - 1 ) );
+			int bounds[5];
+			bounds[0] = node.lo;
+			bounds[4] = node.hi;
+			for ( int k = 1; k < 4; k++ )
+				bounds[k] = lowerBound( bounds[k - 1], node.hi, base + k * quarter );
+			for ( int k = 3; k >= 0; k-- )
+			{
+				if ( bounds[k] == bounds[k + 1] )
+					continue;
+				Node child = { node.level - 1, node.cx + ( k & 1 ) * half, node.cy + ( k >> 1 ) * half, bounds[k], bounds[k + 1] };
+				stack[depth++] = child;
+			}
+		}
+	}
+
+	//-------------------------------------------------------------------------
+	void GeoPointIndex::cluster( int magnification, int left, int bottom, int right, int top, int cellSize, Vector<GeoPointHit>& hits ) const
+	//-------------------------------------------------------------------------
+	{
+		hits.clear( );
+		query( magnification, left, bottom, right, top, mClusterHits );
+		if ( mClusterHits.size( ) == 0 )
+			return;
+
+		int gridLeft = floorDiv( left, cellSize );
+		int gridBottom = floorDiv( bottom, cellSize );
+		int gridWidth = floorDiv( right, cellSize ) - gridLeft + 1;
+		int gridHeight = floorDiv( top, cellSize ) - gridBottom + 1;
+		mCells.resize( gridWidth * gridHeight );
+		for ( int i = 0; i < mCells.size( ); i++ )
+		{
+			mCells[i].item = -1;
+			mCells[i].count = 0;
+			mCells[i].sumX = 0;
+			mCells[i].sumY = 0;
+		}
+
+		for ( int i = 0; i < mClusterHits.size( ); i++ )
+		{
+			const GeoPointHit& h = mClusterHits[i];
+			Cell& c = mCells[( floorDiv( h.x, cellSize ) - gridLeft ) + ( floorDiv( h.y, cellSize ) - gridBottom ) * gridWidth];
+			if ( c.count == 0 || h.item < c.item )
+				c.item = h.item;
+			c.count++;
+			c.sumX += h.x;
+			c.sumY += h.y;
+		}
+
+		for ( int i = 0; i < mCells.size( ); i++ )
+		{
+			const Cell& c = mCells[i];
+			if ( c.count == 0 )
+				continue;
+			GeoPointHit hit = { c.item, (int)( c.sumX / c.count + 0.5 ), (int)( c.sumY / c.count + 0.5 ), c.count };
+			hits.add( hit );
+		}
+	}
+}
@@ -0,0 +1,142 @@
+/* Copyright 2013 David Axmark
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+	http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+/**
+* \file GeoPointIndex.h
+* \brief Spatial index over projected point locations
+*/
+#ifndef GEOPOINTINDEX_H_
+#define GEOPOINTINDEX_H_
+
+#include <MAUtil/Vector.h>
+
+namespace MAP
+{
+	using namespace MAUtil;
+
+	/**
+	 * \brief A point, or a cluster of points, found by GeoPointIndex.
+	 *
+	 * Coordinates are global pixels at the magnification of the query.
+	 */
+	struct GeoPointHit
+	{
+		/**
+		 * Index of the item; for a cluster, the first item in it.
+		 */
+		int item;
+		int x;
+		int y;
+		/**
+		 * Number of items; 1 unless this is a cluster.
+		 */
+		int count;
+	};
+
+	/**
+	 * \brief Spatial index over the global pixel coordinates of a set of points.
+	 *
+	 * Each point is projected once, at ProjectionMagnification; its pixel at
+	 * any lower magnification is found by shifting, so zooming needs no
+	 * reprojection. The points are kept sorted by the Z-order (Morton) key
+	 * of the grid cell they are in, which makes every node of a quadtree over
+	 * the grid a contiguous range of points. A rectangle query descends that
+	 * quadtree with binary searches and only looks at the points in the
+	 * nodes that overlap the rectangle.
+	 */
+	class GeoPointIndex
+	//=========================================================================
+	{
+	public:
+		enum
+		{
+			/**
+			 * Magnification of the stored coordinates. The global grid
+			 * is 2^30 pixels wide at this magnification.
+			 */
+			ProjectionMagnification = 22,
+			/**
+			 * The grid has 2^GridBits cells in each direction.
+			 */
+			GridBits = 16
+		};
+
+		GeoPointIndex( );
+		/**
+		 * Removes all points.
+		 */
+		void clear( );
+		/**
+		 * Adds the next item, by its global pixel coordinate at
+		 * ProjectionMagnification. Items are numbered in the order they
+		 * are added. build( ) must be called before the index is queried.
+		 */
+		void add( int x, int y );
+		/**
+		 * Sorts the points added since clear( ).
+		 */
+		void build( );
+		/**
+		 * Returns the number of items in the index.
+		 */
+		int size( ) const { return mEntries.size( ); }
+		/**
+		 * Returns the global pixel coordinate of \a item at \a magnification.
+		 */
+		void getPixel( int item, int magnification, int& x, int& y ) const;
+		/**
+		 * Finds the items inside a rectangle of global pixels at
+		 * \a magnification, edges included, and adds them to \a hits,
+		 * in a fixed order that keeps nearby items together.
+		 */
+		void query( int magnification, int left, int bottom, int right, int top, Vector<GeoPointHit>& hits ) const;
+		/**
+		 * Finds the items inside the rectangle like query( ), and groups them
+		 * by squares of \a cellSize pixels on the global grid, so that
+		 * clusters stay put while the map is panned. Each non-empty square
+		 * becomes one hit, at the average location of its items.
+		 */
+		void cluster( int magnification, int left, int bottom, int right, int top, int cellSize, Vector<GeoPointHit>& hits ) const;
+
+	private:
+		struct Entry
+		{
+			unsigned int key;
+			int x;
+			int y;
+			int item;
+		};
+
+		struct Cell
+		{
+			int item;
+			int count;
+			double sumX;
+			double sumY;
+		};
+
+		static unsigned int cellKey( int x, int y );
+		int lowerBound( int lo, int hi, unsigned int key ) const;
+
+		Vector<Entry> mEntries;
+		// position of each item in mEntries.
+		Vector<int> mPositions;
+		// scratch space for cluster( ).
+		mutable Vector<Cell> mCells;
+		mutable Vector<GeoPointHit> mClusterHits;
+	};
+}
+
+#endif // GEOPOINTINDEX_H_
@@ -33,7 +33,11 @@ namespace MAP
 	GeoPointLayer::GeoPointLayer( ) :
 	//-------------------------------------------------------------------------
 		mDataSource( NULL ),
-		mSelectedItem( 0 )
+		mSelectedItem( 0 ),
+		mIndexValid( false ),
+		mMaxMarkerSize( 0 ),
+		mClusterCellSize( 0 ),
+		mClusterMaxMagnification( 0 )
 	{
 	}
 
@@ -41,55 +45,116 @@ namespace MAP
 	void GeoPointLayer::draw( MapViewport* viewport, const Rect& bounds, MagnificationType magnification, bool isLayerSelected )
 	//-------------------------------------------------------------------------
 	{
-		Enumerator<GeoPoint*> e = Enumerator<GeoPoint*>( *this );
+		// temporary hack.
+		if(viewport->isZooming()) return;
 
-		while ( e.moveNext( ) )
+		findVisible( viewport, magnification );
+
+		for ( int i = 0; i < mHits.size( ); i++ )
 		{
-			GeoPoint* item = e.current( );
-			drawItem( viewport, item, bounds, magnification, false, false );
+			const GeoPointHit& hit = mHits[i];
+			GeoPoint* item = getItem( hit.item );
+			MAPoint2d widgetPx = viewport->worldPixelToViewport( PixelCoordinate( magnification, hit.x, hit.y ) );
+			if ( hit.count > 1 )
+				getRenderer( )->renderCluster( this, item, hit.count, bounds, bounds.x + widgetPx.x, bounds.y + widgetPx.y );
+			else
+				drawItem( item, bounds, widgetPx, false, false );
 		}
 		//
 		// Draw description text
 		//
-		if ( isLayerSelected )
+		if ( isLayerSelected && mSelectedItem >= 0 && mSelectedItem < mIndex.size( ) )
 		{
 			GeoPoint* item = getItem( mSelectedItem );
 			if ( item != NULL )
 			{
-				drawItem( viewport, item, bounds, magnification, true, true );
+				drawItem( item, bounds, getScreenPixel( viewport, magnification, mSelectedItem ), true, true );
 			}
 		}
 	}
 
 	//-------------------------------------------------------------------------
-	void GeoPointLayer::drawItem( MapViewport* viewport, GeoPoint* item, const Rect& bounds, MagnificationType magnification, bool selected, bool drawText )
+	void GeoPointLayer::drawItem( GeoPoint* item, const Rect& bounds, MAPoint2d widgetPx, bool selected, bool drawText )
 	//-------------------------------------------------------------------------
 	{
-		// temporary hack.
-		if(viewport->isZooming()) return;
-	
-		MAPoint2d widgetPx = getScreenPixel(viewport, magnification, item);
-
-		/* Removed to make items always be rendered.
-		if ( widgetPx.x >= bounds.x && 
-			widgetPx.x < bounds.width && 
-			widgetPx.y >= bounds.y && 
-			widgetPx.y < bounds.height )
+		GeoPointLayerRenderer* renderer = getRenderer( );
+		//
+		// Render marker
+		//
+		renderer->renderItem( this, item, bounds, bounds.x + widgetPx.x, bounds.y + widgetPx.y, selected );
+		//
+		// Render item text
+		//
+		if ( drawText )
 		{
-		*/
-			GeoPointLayerRenderer* renderer = getRenderer( );
-			//
-			// Render marker
-			//
-			renderer->renderItem( this, item, bounds, bounds.x + widgetPx.x, bounds.y + widgetPx.y, selected );
-			//
-			// Render item text
-			//
-			if ( drawText )
-			{
-				renderer->renderItemText( this, item, bounds, bounds.x + widgetPx.x, bounds.y + widgetPx.y );
-			}
-		//}
+			renderer->renderItemText( this, item, bounds, bounds.x + widgetPx.x, bounds.y + widgetPx.y );
+		}
+	}
+
+	//-------------------------------------------------------------------------
+	void GeoPointLayer::setClustering( int cellSize, int maxMagnification )
+	//-------------------------------------------------------------------------
+	{
+		mClusterCellSize = cellSize;
+		mClusterMaxMagnification = maxMagnification;
+		onContentChanged( );
+	}
+
+	//-------------------------------------------------------------------------
+	bool GeoPointLayer::isClustered( MagnificationType magnification ) const
+	//-------------------------------------------------------------------------
+	{
+		return mClusterCellSize > 0 && (int)magnification <= mClusterMaxMagnification;
+	}
+
+	//-------------------------------------------------------------------------
+	void GeoPointLayer::updateIndex( )
+	//-------------------------------------------------------------------------
+	{
+		if ( mIndexValid && mIndex.size( ) == size( ) )
+			return;
+
+		mIndex.clear( );
+		mMaxMarkerSize = 0;
+		Enumerator<GeoPoint*> e = Enumerator<GeoPoint*>( *this );
+
+		while ( e.moveNext( ) )
+		{
+			GeoPoint* item = e.current( );
+			PixelCoordinate px = item->getLocation( ).toPixels( GeoPointIndex::ProjectionMagnification );
+			mIndex.add( px.getX( ), px.getY( ) );
+			if ( item->getMarkerSize( ) > mMaxMarkerSize )
+				mMaxMarkerSize = item->getMarkerSize( );
+		}
+		mIndex.build( );
+		mIndexValid = true;
+	}
+
+	//-------------------------------------------------------------------------
+	void GeoPointLayer::findVisible( MapViewport* viewport, MagnificationType magnification )
+	//-------------------------------------------------------------------------
+	{
+		updateIndex( );
+		//
+		// Items just outside the viewport may still reach into it.
+		//
+		MAPoint2d topLeft;
+		topLeft.x = 0;
+		topLeft.y = 0;
+		MAPoint2d bottomRight;
+		bottomRight.x = viewport->getWidth( );
+		bottomRight.y = viewport->getHeight( );
+		PixelCoordinate topLeftPx = viewport->viewportToWorldPixel( topLeft );
+		PixelCoordinate bottomRightPx = viewport->viewportToWorldPixel( bottomRight );
+		int left = topLeftPx.getX( ) - mMaxMarkerSize;
+		int top = topLeftPx.getY( ) + mMaxMarkerSize;
+		int right = bottomRightPx.getX( ) + mMaxMarkerSize;
+		int bottom = bottomRightPx.getY( ) - mMaxMarkerSize;
+
+		if ( isClustered( magnification ) )
+			mIndex.cluster( (int)magnification, left, bottom, right, top, mClusterCellSize, mHits );
+		else
+			mIndex.query( (int)magnification, left, bottom, right, top, mHits );
 	}
 
 	//-------------------------------------------------------------------------
@@ -106,6 +171,7 @@ namespace MAP
 		deleteobject( mDataSource );
 		mDataSource = dataSource;
 		mDataSource->addListener( this );
+		mIndexValid = false;
 	}
 
 	//-------------------------------------------------------------------------
@@ -127,6 +193,7 @@ namespace MAP
 	void GeoPointLayer::dataChanged( GeoPointDataSource* sender )
 	//-------------------------------------------------------------------------
 	{
+		mIndexValid = false;
 		onContentChanged( );
 	}
 
@@ -134,6 +201,7 @@ namespace MAP
 	void GeoPointLayer::loadComplete( GeoPointDataSource* sender )
 	//-------------------------------------------------------------------------
 	{
+		mIndexValid = false;
 		onContentChanged( );
 	}
 
@@ -191,25 +259,42 @@ namespace MAP
 	void GeoPointLayer::selectItemAtPixel( MapViewport *viewport, MagnificationType magnification, MAPoint2d screenPixel )
 	//-------------------------------------------------------------------------
 	{
-		// If there's a point at this pixel coordinate, make it the selected point
-		Enumerator<GeoPoint*> e = Enumerator<GeoPoint*>( *this );
+		// If there's a point at this pixel coordinate, make it the selected point.
+		// Of several, the one drawn last wins.
 		int selectedIndex = -1;
-		int index = 0;
 
-		while ( e.moveNext( ) )
+		if ( isClustered( magnification ) )
 		{
-			GeoPoint* item = e.current( );
-			MAPoint2d widgetPixel = getScreenPixel(viewport, magnification, item);
+			findVisible( viewport, magnification );
+		}
+		else
+		{
+			updateIndex( );
+			PixelCoordinate worldPx = viewport->viewportToWorldPixel( screenPixel );
+			mIndex.query( (int)magnification,
+				worldPx.getX( ) - mMaxMarkerSize, worldPx.getY( ) - mMaxMarkerSize,
+				worldPx.getX( ) + mMaxMarkerSize, worldPx.getY( ) + mMaxMarkerSize, mHits );
+		}
 
-			if (abs(widgetPixel.x - screenPixel.x) < item->getMarkerSize() &&
+		for ( int i = 0; i < mHits.size( ); i++ )
+		{
+			const GeoPointHit& hit = mHits[i];
+			GeoPoint* item = getItem( hit.item );
+			MAPoint2d widgetPixel = viewport->worldPixelToViewport( PixelCoordinate( magnification, hit.x, hit.y ) );
+
+			if ( hit.count > 1 )
+			{
+				Rect r = mRenderer->getClusterRect( this, item, hit.count, widgetPixel.x, widgetPixel.y );
+				if ( r.contains( screenPixel.x, screenPixel.y ) )
+					selectedIndex = hit.item;
+			}
+			else if (abs(widgetPixel.x - screenPixel.x) < item->getMarkerSize() &&
 				abs(widgetPixel.y - screenPixel.y) < item->getMarkerSize()) {
-				Rect r = mRenderer->getItemRect(this, item, widgetPixel.x, widgetPixel.y, index == mSelectedItem);
+				Rect r = mRenderer->getItemRect(this, item, widgetPixel.x, widgetPixel.y, hit.item == mSelectedItem);
 				if (r.contains(screenPixel.x, screenPixel.y)) {
-					selectedIndex = index;
+					selectedIndex = hit.item;
 				}
 			}
-
-			index++;
 		}
 
 		if (selectedIndex != -1) {
@@ -243,16 +328,11 @@ namespace MAP
 	}
 
 	//-------------------------------------------------------------------------
-	MAPoint2d GeoPointLayer::getScreenPixel( MapViewport* viewport, MagnificationType magnification, GeoPoint* item )
+	MAPoint2d GeoPointLayer::getScreenPixel( MapViewport* viewport, MagnificationType magnification, int index )
 	//-------------------------------------------------------------------------
 	{
-		PixelCoordinate worldPx = item->getCachedPixelLocation( );
-		if ( worldPx.getMagnification() != magnification )
-		{
-			LonLat lonlat = item->getLocation( );
-			worldPx = lonlat.toPixels( magnification );
-			item->setCachedPixelLocation( worldPx );
-		}
-		return viewport->worldPixelToViewport( worldPx );
+		int x, y;
+		mIndex.getPixel( index, (int)magnification, x, y );
+		return viewport->worldPixelToViewport( PixelCoordinate( magnification, x, y ) );
 	}
 }
@@ -36,6 +36,7 @@ limitations under the License.
 
 #include "Layer.h"
 #include "GeoPointLayerRenderer.h"
+#include "GeoPointIndex.h"
 
 
 namespace MAP
@@ -66,6 +67,10 @@ namespace MAP
 	/**
 	 * \brief Layer class for GeoPoint.
 	 *
+	 * Items are kept in a GeoPointIndex, so that drawing and selection
+	 * only look at the items near the viewport. The index is rebuilt when
+	 * the data source reports a change; an item moved with
+	 * GeoPoint::setLocation( ) stays where it was until then.
 	 */
 	class GeoPointLayer : 
 		public Layer,
@@ -91,6 +96,15 @@ namespace MAP
 		GeoPointLayerRenderer* getRenderer( ) const { return mRenderer; }
 		void setRenderer( GeoPointLayerRenderer* renderer ) { mRenderer = renderer; }
 		//
+		// Clustering: at magnification maxMagnification and below, items are
+		// grouped by squares of cellSize pixels, and each group is drawn with
+		// GeoPointLayerRenderer::renderCluster( ). A cellSize of 0 turns it off,
+		// which is the default.
+		//
+		void setClustering( int cellSize, int maxMagnification );
+		int getClusterCellSize( ) const { return mClusterCellSize; }
+		int getClusterMaxMagnification( ) const { return mClusterMaxMagnification; }
+		//
 		// IGeoPointDataSourceListener implementation
 		//
 		void dataChanged( GeoPointDataSource* sender );
@@ -115,12 +129,22 @@ namespace MAP
 		virtual LonLat getSelectedItemLocation( );
 
 	private:
-		void drawItem( MapViewport* viewport, GeoPoint* item, const Rect& bounds, MagnificationType magnification, bool renderSelected, bool drawText );
-		MAPoint2d getScreenPixel( MapViewport* viewport, MagnificationType magnification, GeoPoint* point );
+		void drawItem( GeoPoint* item, const Rect& bounds, MAPoint2d widgetPx, bool renderSelected, bool drawText );
+		MAPoint2d getScreenPixel( MapViewport* viewport, MagnificationType magnification, int index );
+		void updateIndex( );
+		bool isClustered( MagnificationType magnification ) const;
+		void findVisible( MapViewport* viewport, MagnificationType magnification );
 
 		GeoPointDataSource* mDataSource;
 		GeoPointLayerRenderer* mRenderer;
 		int mSelectedItem;
+		GeoPointIndex mIndex;
+		bool mIndexValid;
+		int mMaxMarkerSize;
+		int mClusterCellSize;
+		int mClusterMaxMagnification;
+		// items, or clusters, found by the last findVisible( ).
+		Vector<GeoPointHit> mHits;
 	};
 }
 #endif // GEOPOINTLAYER_H_
@@ -43,6 +43,17 @@ namespace MAP
 			int halfsize = size / 2;
 			return Rect(x - halfsize, y - halfsize, size, size);
 		}
+		/**
+		 * Renders a cluster of \a count items, at their average location.
+		 * \a item is the first of them. The default renders \a item.
+		 */
+		virtual void renderCluster( Layer* layer, GeoPoint* item, int count, const Rect& bounds, int x, int y ) {
+			renderItem( layer, item, bounds, x, y, false );
+		}
+
+		virtual Rect getClusterRect( Layer* layer, GeoPoint* item, int count, int x, int y ) const {
+			return getItemRect( layer, item, x, y, false );
+		}
 	};
 }
 #endif // GEOPOINTLAYERRENDERER_H_
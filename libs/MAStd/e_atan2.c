@@ -55,7 +55,7 @@ pi_lo   = 1.2246467991473531772E-16; /* 0x3CA1A626, 0x33145C07 */
 
 extern double atan(double);
 
-double atan2(double y, double x)
+double __ieee754_atan2(double y, double x)
 {  
 	double z;
 	int k,m,hx,hy,ix,iy;
@@ -153,6 +153,50 @@ int isnan(double x);
 */
 int isinf(double x);
 
+/** Single precision sin(). */
+float sinf(float x);
+
+/** Single precision cos(). */
+float cosf(float x);
+
+/** Single precision sqrt(). */
+float sqrtf(float x);
+
+/** Single precision pow(). */
+float powf(float x, float y);
+
+/** Single precision log(). */
+float logf(float x);
+
+/** Single precision atan2(). */
+float atan2f(float y, float x);
+
+/**
+* Returns non-zero if the math functions are implemented natively by the runtime,
+* zero if they fall back to the portable code in MAStd.
+*/
+int mathIsNative(void);
+
+/**
+* Applies a function to each element of \a src, and stores the results in \a dst.
+* \a src and \a dst may be the same array.
+* \param func One of the \link #MA_MATH_FUNC_SIN MA_MATH_FUNC \endlink constants.
+* \returns \a count, or \< 0 if \a func is invalid.
+*/
+int mathEvaluate(int func, const double* src, double* dst, int count);
+
+/**
+* Single precision mathEvaluate().
+*/
+int mathEvaluatef(int func, const float* src, float* dst, int count);
+
+/**
+* Transforms \a count 3D points, three floats each, by a row major 3x4 affine \a matrix.
+* \a src and \a dst may be the same array.
+* \returns \a count.
+*/
+int mathTransformPointsf(const float* matrix, const float* src, float* dst, int count);
+
 #else
 
 #ifndef _CRT_SECURE_NO_WARNINGS
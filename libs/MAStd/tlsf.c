@@ -71,6 +71,17 @@
 #define	USE_SBRK 	(0)
 #endif
 
+/* Grow the pool with maHeapGrow(), in the room the runtime reserved
+   after the data segment, and give the memory of large freed blocks
+   back with maHeapRelease(). */
+#ifndef USE_HEAP_GROW
+#ifdef MAPIP
+#define	USE_HEAP_GROW 	(1)
+#else
+#define	USE_HEAP_GROW 	(0)
+#endif
+#endif
+
 
 #if TLSF_USE_LOCKS
 #include "target.h"
@@ -164,6 +175,9 @@
 #define PAGE_SIZE (getpagesize())
 #endif
 
+/* Freed blocks at least this large are released to the runtime. */
+#define RELEASE_SIZE (64*1024)
+
 #define PRINT_MSG(fmt, ...) printf(fmt, ## args)
 //#define ERROR_MSG(fmt, ...) printf(fmt, ## args)
 #define ERROR_MSG(string) maWriteLog(string, sizeof(string)-1)
@@ -236,7 +250,7 @@ static __inline__ void MAPPING_SEARCH(size_t * _r, int *_fl, int *_sl);
 static __inline__ void MAPPING_INSERT(size_t _r, int *_fl, int *_sl);
 static __inline__ bhdr_t *FIND_SUITABLE_BLOCK(tlsf_t * _tlsf, int *_fl, int *_sl);
 static __inline__ bhdr_t *process_area(void *area, size_t size);
-#if USE_SBRK || USE_MMAP
+#if USE_SBRK || USE_MMAP || USE_HEAP_GROW
 static __inline__ void *get_new_area(size_t * size);
 #endif
 
@@ -388,11 +402,20 @@ static __inline__ bhdr_t *FIND_SUITABLE_BLOCK(tlsf_t * _tlsf, int *_fl, int *_sl
 		set_bit (_fl, &_tlsf -> fl_bitmap);								\
 	} while(0)
 
-#if USE_SBRK || USE_MMAP
+#if USE_SBRK || USE_MMAP || USE_HEAP_GROW
 static __inline__ void *get_new_area(size_t * size) 
 {
     void *area;
 
+#if USE_HEAP_GROW
+    *size = (*size + MA_HEAP_GROW_GRANULARITY - 1) & ~(MA_HEAP_GROW_GRANULARITY - 1);
+    /* 0 when the reserved room is used up, IOCTL_UNAVAILABLE when the
+       runtime can't grow the data segment at all. */
+    area = (void *) maHeapGrow(*size);
+    if ((int) area > 0)
+        return area;
+#endif
+
 #if USE_SBRK
     area = (void *)sbrk(0);
     if (((void *)sbrk(*size)) != ((void *) -1))
@@ -490,7 +513,8 @@ size_t add_new_area(void *area, size_t area_size, void *mem_pool)
     area_info_t *ptr, *ptr_prev, *ai;
     bhdr_t *ib0, *b0, *lb0, *ib1, *b1, *lb1, *next_b;
 
-    memset(area, 0, area_size);
+    /* The area isn't cleared; only its block headers need to be set, and
+       clearing it would make the runtime commit every page of it. */
     ptr = tlsf->area_head;
     ptr_prev = 0;
 
@@ -691,7 +715,7 @@ void *malloc_ex(size_t size, void *mem_pool)
     /* Searching a free block, recall that this function changes the values of fl and sl,
        so they are not longer valid when the function fails */
     b = FIND_SUITABLE_BLOCK(tlsf, &fl, &sl);
-#if USE_MMAP || USE_SBRK
+#if USE_MMAP || USE_SBRK || USE_HEAP_GROW
     if (!b) {
         size_t area_size;
         void *area;
@@ -751,12 +775,18 @@ void free_ex(void *ptr, void *mem_pool)
     tlsf_t *tlsf = (tlsf_t *) mem_pool;
     bhdr_t *b, *tmp_b;
     int fl = 0, sl = 0;
+#if USE_HEAP_GROW
+    size_t freed_size;
+#endif
 
     if (!ptr) {
         return;
     }
     b = (bhdr_t *) ((char *) ptr - BHDR_OVERHEAD);
     b->size |= FREE_BLOCK;
+#if USE_HEAP_GROW
+    freed_size = b->size & BLOCK_SIZE;
+#endif
 
     TLSF_REMOVE_SIZE(tlsf, b);
 
@@ -781,6 +811,14 @@ void free_ex(void *ptr, void *mem_pool)
     tmp_b = GET_NEXT_BLOCK(b->ptr.buffer, b->size & BLOCK_SIZE);
     tmp_b->size |= PREV_FREE;
     tmp_b->prev_hdr = b;
+
+#if USE_HEAP_GROW
+    /* Everything in the free block, after its list pointers, is unused. */
+    if (freed_size >= RELEASE_SIZE) {
+        maHeapRelease(b->ptr.buffer + MIN_BLOCK_SIZE,
+            (b->size & BLOCK_SIZE) - MIN_BLOCK_SIZE);
+    }
+#endif
 }
 
 /******************************************************************/
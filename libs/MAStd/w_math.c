@@ -0,0 +1,132 @@
+/* Copyright 2013 David Axmark
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+	http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+// Wrappers that bind the math functions to the runtime's native
+// implementations, the maMath ioctls. Where the runtime lacks them,
+// the fdlibm code in e_*.c is used instead.
+
+#include "ma.h"
+#include "madmath.h"
+#include "math_private.h"
+
+// 0 until probed, then 1 if the ioctls are available, -1 if not.
+static int sNativeMath = 0;
+
+int mathIsNative(void) {
+	if(sNativeMath == 0) {
+		sNativeMath = (maMathEvaluate(MA_MATH_FUNC_SIN, 0, 0, 0) == 0) ? 1 : -1;
+	}
+	return sNativeMath > 0;
+}
+
+double pow(double x, double y) {
+	if(mathIsNative())
+		return maMathPow(x, y);
+	return __ieee754_pow(x, y);
+}
+
+double log(double x) {
+	if(mathIsNative())
+		return maMathLog(x);
+	return __ieee754_log(x);
+}
+
+double atan2(double y, double x) {
+	if(mathIsNative())
+		return maMathAtan2(y, x);
+	return __ieee754_atan2(y, x);
+}
+
+float sinf(float x) {
+	if(mathIsNative())
+		return maMathSinf(x);
+	return (float)sin(x);
+}
+
+float cosf(float x) {
+	if(mathIsNative())
+		return maMathCosf(x);
+	return (float)cos(x);
+}
+
+float sqrtf(float x) {
+	if(mathIsNative())
+		return maMathSqrtf(x);
+	return (float)sqrt(x);
+}
+
+float powf(float x, float y) {
+	if(mathIsNative())
+		return maMathPowf(x, y);
+	return (float)__ieee754_pow(x, y);
+}
+
+float logf(float x) {
+	if(mathIsNative())
+		return maMathLogf(x);
+	return (float)__ieee754_log(x);
+}
+
+float atan2f(float y, float x) {
+	if(mathIsNative())
+		return maMathAtan2f(y, x);
+	return (float)__ieee754_atan2(y, x);
+}
+
+static double evaluate(int func, double x) {
+	switch(func) {
+	case MA_MATH_FUNC_SIN: return sin(x);
+	case MA_MATH_FUNC_COS: return cos(x);
+	case MA_MATH_FUNC_SQRT: return sqrt(x);
+	case MA_MATH_FUNC_LOG: return __ieee754_log(x);
+	}
+	return 0;
+}
+
+int mathEvaluate(int func, const double* src, double* dst, int count) {
+	int i;
+	if(func < MA_MATH_FUNC_SIN || func > MA_MATH_FUNC_LOG)
+		return -1;
+	if(mathIsNative())
+		return maMathEvaluate(func, (MAAddress)src, dst, count);
+	for(i=0; i<count; i++)
+		dst[i] = evaluate(func, src[i]);
+	return count;
+}
+
+int mathEvaluatef(int func, const float* src, float* dst, int count) {
+	int i;
+	if(func < MA_MATH_FUNC_SIN || func > MA_MATH_FUNC_LOG)
+		return -1;
+	if(mathIsNative())
+		return maMathEvaluatef(func, (MAAddress)src, dst, count);
+	for(i=0; i<count; i++)
+		dst[i] = (float)evaluate(func, src[i]);
+	return count;
+}
+
+int mathTransformPointsf(const float* matrix, const float* src, float* dst, int count) {
+	const float* m = matrix;
+	int i;
+	if(mathIsNative())
+		return maMathTransformPointsf((MAAddress)matrix, (MAAddress)src, dst, count);
+	for(i=0; i<count; i++, src+=3, dst+=3) {
+		float x = src[0], y = src[1], z = src[2];
+		dst[0] = m[0]*x + m[1]*y + m[2]*z + m[3];
+		dst[1] = m[4]*x + m[5]*y + m[6]*z + m[7];
+		dst[2] = m[8]*x + m[9]*y + m[10]*z + m[11];
+	}
+	return count;
+}
@@ -0,0 +1,360 @@
+/* Copyright 2013 David Axmark
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+	http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+/*
+* @file Benchmark.cpp
+* @brief Microbenchmarks with statistical reporting.
+*/
+
+#include <mastring.h>
+#include <mavsprintf.h>
+
+#include "Benchmark.h"
+
+namespace MATest
+{
+	/* ========== Struct BenchmarkOptions ========== */
+
+	BenchmarkOptions::BenchmarkOptions() :
+		warmUpMs(200),
+		sampleMs(50),
+		samples(15),
+		maxIterations(1 << 24),
+		threshold(0.1)
+	{
+	}
+
+	/* ========== Class BenchmarkTimer ========== */
+
+	// 0 until probed, then 1 if maGetMicroSecondCount() is available, -1 if not.
+	static int sHighResolution = 0;
+
+	bool BenchmarkTimer::isHighResolution()
+	{
+		if (0 == sHighResolution)
+		{
+			sHighResolution =
+				(IOCTL_UNAVAILABLE != maGetMicroSecondCount()) ? 1 : -1;
+		}
+		return sHighResolution > 0;
+	}
+
+	int BenchmarkTimer::getMicroSeconds()
+	{
+		if (isHighResolution())
+		{
+			return maGetMicroSecondCount();
+		}
+		return maGetMilliSecondCount() * 1000;
+	}
+
+	/* ========== Class BenchmarkBaseline ========== */
+
+	BenchmarkBaseline::BenchmarkBaseline()
+	{
+	}
+
+	BenchmarkBaseline::~BenchmarkBaseline()
+	{
+	}
+
+	void BenchmarkBaseline::load(MAHandle data)
+	{
+		int size = maGetDataSize(data);
+		char* text = new char[size + 1];
+		maReadData(data, text, 0, size);
+		text[size] = 0;
+		parse(text, size);
+		delete[] text;
+	}
+
+	bool BenchmarkBaseline::loadStore(const char* storeName)
+	{
+		MAHandle store = maOpenStore(storeName, 0);
+		if (store <= 0)
+		{
+			return false;
+		}
+		MAHandle data = maCreatePlaceholder();
+		bool success = maReadStore(store, data) > 0;
+		if (success)
+		{
+			load(data);
+		}
+		maDestroyPlaceholder(data);
+		maCloseStore(store, 0);
+		return success;
+	}
+
+	bool BenchmarkBaseline::saveStore(const char* storeName)
+	{
+		MAUtil::String text = "# name median_us\n";
+		char line[32];
+		for (int i = 0; i < mNames.size(); i++)
+		{
+			sprintf(line, " %.3f\n", mMedians[i]);
+			text += mNames[i] + line;
+		}
+
+		MAHandle store = maOpenStore(storeName, MAS_CREATE_IF_NECESSARY);
+		if (store <= 0)
+		{
+			return false;
+		}
+		MAHandle data = maCreatePlaceholder();
+		maCreateData(data, text.length());
+		maWriteData(data, text.c_str(), 0, text.length());
+		bool success = maWriteStore(store, data) > 0;
+		maDestroyPlaceholder(data);
+		maCloseStore(store, 0);
+		return success;
+	}
+
+	void BenchmarkBaseline::parse(const char* text, int length)
+	{
+		const char* end = text + length;
+		const char* line = text;
+		while (line < end)
+		{
+			const char* lineEnd = line;
+			while (lineEnd < end && '\n' != *lineEnd)
+			{
+				lineEnd++;
+			}
+
+			if ('#' != *line)
+			{
+				const char* space = line;
+				while (space < lineEnd && ' ' != *space)
+				{
+					space++;
+				}
+				if (space > line && space < lineEnd)
+				{
+					set(MAUtil::String(line, space - line), strtod(space + 1, NULL));
+				}
+			}
+			line = lineEnd + 1;
+		}
+	}
+
+	double BenchmarkBaseline::get(const MAUtil::String& name) const
+	{
+		for (int i = 0; i < mNames.size(); i++)
+		{
+			if (mNames[i] == name)
+			{
+				return mMedians[i];
+			}
+		}
+		return 0;
+	}
+
+	void BenchmarkBaseline::set(const MAUtil::String& name, double median)
+	{
+		for (int i = 0; i < mNames.size(); i++)
+		{
+			if (mNames[i] == name)
+			{
+				mMedians[i] = median;
+				return;
+			}
+		}
+		mNames.add(name);
+		mMedians.add(median);
+	}
+
+	int BenchmarkBaseline::size() const
+	{
+		return mNames.size();
+	}
+
+	/* ========== Class Benchmark ========== */
+
+	BenchmarkBaseline* Benchmark::sBaseline = NULL;
+
+	Benchmark::~Benchmark()
+	{
+	}
+
+	void Benchmark::setBaseline(BenchmarkBaseline* baseline)
+	{
+		sBaseline = baseline;
+	}
+
+	BenchmarkBaseline* Benchmark::getBaseline()
+	{
+		return sBaseline;
+	}
+
+	int Benchmark::timeRun(int iterations)
+	{
+		unsigned int start = BenchmarkTimer::getMicroSeconds();
+		run(iterations);
+		return (int)((unsigned int)BenchmarkTimer::getMicroSeconds() - start);
+	}
+
+	void Benchmark::measure(
+		const MAUtil::String& name,
+		const BenchmarkOptions& options,
+		const BenchmarkBaseline* baseline,
+		BenchmarkResult& result)
+	{
+		// Calibrate the number of iterations per sample. Grow by ten
+		// until the time is measurable, then scale to the sample time.
+		int target = options.sampleMs * 1000;
+		int iterations = 1;
+		for (;;)
+		{
+			int time = timeRun(iterations);
+			if (time >= target || iterations >= options.maxIterations)
+			{
+				break;
+			}
+			double next;
+			if (time < target / 100)
+			{
+				next = iterations * 10.0;
+			}
+			else
+			{
+				next = iterations * 1.1 * target / time;
+			}
+			iterations = next > options.maxIterations ?
+				options.maxIterations : (int)next + 1;
+		}
+
+		// Warm up.
+		int start = maGetMilliSecondCount();
+		while (maGetMilliSecondCount() - start < options.warmUpMs)
+		{
+			timeRun(iterations);
+		}
+
+		double* samples = new double[options.samples];
+		for (int i = 0; i < options.samples; i++)
+		{
+			samples[i] = timeRun(iterations) / (double)iterations;
+		}
+
+		result.name = name;
+		result.iterations = iterations;
+		computeStatistics(samples, options.samples, result);
+		delete[] samples;
+
+		result.baseline = NULL != baseline ? baseline->get(name) : 0;
+		result.regression = result.baseline > 0 &&
+			result.median > result.baseline * (1 + options.threshold);
+	}
+
+	/**
+	 * Linear interpolation between the closest ranks.
+	 */
+	static double percentile(const double* sorted, int count, double p)
+	{
+		double rank = p * (count - 1);
+		int low = (int)rank;
+		if (low + 1 >= count)
+		{
+			return sorted[count - 1];
+		}
+		return sorted[low] + (rank - low) * (sorted[low + 1] - sorted[low]);
+	}
+
+	void Benchmark::computeStatistics(
+		double* samples,
+		int count,
+		BenchmarkResult& result)
+	{
+		result.samples = 0;
+		result.outliers = 0;
+		result.min = result.median = result.p95 = result.mean = 0;
+		if (count <= 0)
+		{
+			return;
+		}
+
+		// Insertion sort, there are few samples.
+		for (int i = 1; i < count; i++)
+		{
+			double s = samples[i];
+			int j = i;
+			for (; j > 0 && samples[j - 1] > s; j--)
+			{
+				samples[j] = samples[j - 1];
+			}
+			samples[j] = s;
+		}
+
+		// Reject samples outside Tukey's fences.
+		double q1 = percentile(samples, count, 0.25);
+		double q3 = percentile(samples, count, 0.75);
+		double low = q1 - 1.5 * (q3 - q1);
+		double high = q3 + 1.5 * (q3 - q1);
+		int first = 0;
+		while (first < count && samples[first] < low)
+		{
+			first++;
+		}
+		int last = count;
+		while (last > first && samples[last - 1] > high)
+		{
+			last--;
+		}
+
+		const double* kept = samples + first;
+		int n = last - first;
+		result.samples = n;
+		result.outliers = count - n;
+		result.min = kept[0];
+		result.median = percentile(kept, n, 0.5);
+		result.p95 = percentile(kept, n, 0.95);
+		double sum = 0;
+		for (int i = 0; i < n; i++)
+		{
+			sum += kept[i];
+		}
+		result.mean = sum / n;
+	}
+
+	/* ========== Class BenchmarkCase ========== */
+
+	BenchmarkCase::BenchmarkCase(const MAUtil::String& name) :
+		TestCase(name)
+	{
+	}
+
+	BenchmarkCase::~BenchmarkCase()
+	{
+	}
+
+	void BenchmarkCase::start()
+	{
+		BenchmarkResult result;
+		measure(getName(), mOptions, sBaseline, result);
+		getSuite()->fireBenchmark(result);
+		if (result.baseline > 0)
+		{
+			assert(getName() + " regression", !result.regression);
+		}
+		runNextTestCase();
+	}
+
+	BenchmarkOptions& BenchmarkCase::getOptions()
+	{
+		return mOptions;
+	}
+
+} // namespace
@@ -0,0 +1,299 @@
+/* Copyright 2013 David Axmark
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+	http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+/*
+* @file Benchmark.h
+* @brief Microbenchmarks with statistical reporting.
+*/
+
+#ifndef __MOSYNC_LIBS_MATEST_BENCHMARK_H__
+#define __MOSYNC_LIBS_MATEST_BENCHMARK_H__
+
+#include <ma.h>
+#include <MAUtil/Vector.h>
+#include <MAUtil/String.h>
+
+#include "Test.h"
+
+namespace MATest
+{
+	/**
+	* @brief Timing statistics of a benchmark.
+	* The times are in microseconds per iteration.
+	*/
+	struct BenchmarkResult
+	{
+		/**
+		 * @brief Name of the benchmark.
+		 */
+		MAUtil::String name;
+
+		/**
+		 * @brief Number of iterations in each sample, as calibrated.
+		 */
+		int iterations;
+
+		/**
+		 * @brief Number of samples kept after outlier rejection.
+		 */
+		int samples;
+
+		/**
+		 * @brief Number of samples rejected as outliers.
+		 */
+		int outliers;
+
+		double min;
+		double median;
+		double p95;
+		double mean;
+
+		/**
+		 * @brief The median of the baseline, 0 if there is none.
+		 */
+		double baseline;
+
+		/**
+		 * @brief true if the median exceeds the baseline
+		 * by more than the threshold.
+		 */
+		bool regression;
+	};
+
+	/**
+	* @brief Settings for measuring a benchmark.
+	*/
+	struct BenchmarkOptions
+	{
+		/**
+		 * @brief Constructor. Sets the default values.
+		 */
+		BenchmarkOptions();
+
+		/**
+		 * @brief Time to run the benchmark before sampling,
+		 * in milliseconds. Default 200.
+		 */
+		int warmUpMs;
+
+		/**
+		 * @brief The time a sample should take, in milliseconds.
+		 * The number of iterations per sample is calibrated to this.
+		 * Default 50.
+		 */
+		int sampleMs;
+
+		/**
+		 * @brief Number of samples. Default 15.
+		 */
+		int samples;
+
+		/**
+		 * @brief Upper limit for the calibrated number of iterations.
+		 */
+		int maxIterations;
+
+		/**
+		 * @brief How much slower than the baseline the median
+		 * may be before it is a regression, as a fraction.
+		 * Default 0.1, 10 percent.
+		 */
+		double threshold;
+	};
+
+	/**
+	* @brief Time source for benchmarks.
+	*
+	* Uses maGetMicroSecondCount() where the runtime has it,
+	* and maGetMilliSecondCount() elsewhere.
+	*/
+	class BenchmarkTimer
+	{
+	public:
+		/**
+		 * @brief Returns the time in microseconds. It wraps around,
+		 * so only the difference between two values is meaningful.
+		 */
+		static int getMicroSeconds();
+
+		/**
+		 * @brief Returns true if the time has microsecond resolution.
+		 */
+		static bool isHighResolution();
+	};
+
+	/**
+	* @brief Medians from an earlier run, to compare results with.
+	*
+	* The baseline is text, with one benchmark per line:
+	* the name, a space, and the median in microseconds.
+	* Lines that start with '#' are ignored. Names must not
+	* contain spaces.
+	*/
+	class BenchmarkBaseline
+	{
+	public:
+		/**
+		 * @brief Constructor. Creates an empty baseline.
+		 */
+		BenchmarkBaseline();
+
+		/**
+		 * @brief Destructor.
+		 */
+		virtual ~BenchmarkBaseline();
+
+		/**
+		 * @brief Add the lines of a data object, such as a resource.
+		 */
+		void load(MAHandle data);
+
+		/**
+		 * @brief Add the lines of a store.
+		 * @return false if the store does not exist.
+		 */
+		bool loadStore(const char* storeName);
+
+		/**
+		 * @brief Write the baseline to a store, replacing its contents.
+		 * @return false on failure.
+		 */
+		bool saveStore(const char* storeName);
+
+		/**
+		 * @brief Parse lines of baseline text.
+		 */
+		void parse(const char* text, int length);
+
+		/**
+		 * @brief Get the median of a benchmark.
+		 * @return The median, or 0 if the benchmark is not in the baseline.
+		 */
+		double get(const MAUtil::String& name) const;
+
+		/**
+		 * @brief Set the median of a benchmark.
+		 */
+		void set(const MAUtil::String& name, double median);
+
+		/**
+		 * @brief Returns the number of benchmarks in the baseline.
+		 */
+		int size() const;
+
+	protected:
+		MAUtil::Vector<MAUtil::String> mNames;
+		MAUtil::Vector<double> mMedians;
+	};
+
+	/**
+	* @brief Code that is measured as a benchmark.
+	*
+	* measure() calibrates the number of iterations so that a sample
+	* takes about BenchmarkOptions::sampleMs, warms up, takes the
+	* samples, and computes statistics after rejecting outliers.
+	*/
+	class Benchmark
+	{
+	public:
+		/**
+		 * @brief Destructor.
+		 */
+		virtual ~Benchmark();
+
+		/**
+		 * @brief Run the benchmarked code \a iterations times.
+		 */
+		virtual void run(int iterations) = 0;
+
+		/**
+		 * @brief Measure run().
+		 * @param baseline Compared with the result, unless NULL.
+		 */
+		void measure(
+			const MAUtil::String& name,
+			const BenchmarkOptions& options,
+			const BenchmarkBaseline* baseline,
+			BenchmarkResult& result);
+
+		/**
+		 * @brief Compute the statistics of samples, in microseconds
+		 * per iteration. Samples outside 1.5 interquartile ranges
+		 * from the quartiles are rejected as outliers.
+		 * The samples are sorted in place.
+		 */
+		static void computeStatistics(
+			double* samples,
+			int count,
+			BenchmarkResult& result);
+
+		/**
+		 * @brief Set the baseline that benchmarks are compared with
+		 * by default. It is not deleted.
+		 */
+		static void setBaseline(BenchmarkBaseline* baseline);
+
+		/**
+		 * @brief Get the default baseline, NULL if there is none.
+		 */
+		static BenchmarkBaseline* getBaseline();
+
+	protected:
+		/**
+		 * @brief Time one call to run(), in microseconds.
+		 */
+		int timeRun(int iterations);
+
+		static BenchmarkBaseline* sBaseline;
+	};
+
+	/**
+	* @brief A test case that is a benchmark.
+	*
+	* Override run(int). When the test case is started, it is measured
+	* and the result is sent to the test listeners. If the default
+	* baseline has a median for the test case, a regression beyond
+	* the threshold fails the assertion "<name> regression".
+	*/
+	class BenchmarkCase : public TestCase, public Benchmark
+	{
+	public:
+		/**
+		 * @brief Constructor.
+		 */
+		BenchmarkCase(const MAUtil::String& name);
+
+		/**
+		 * @brief Destructor.
+		 */
+		virtual ~BenchmarkCase();
+
+		/**
+		 * @brief Measures the benchmark and runs the next test case.
+		 */
+		virtual void start();
+
+		/**
+		 * @brief The options of this benchmark.
+		 */
+		BenchmarkOptions& getOptions();
+
+	protected:
+		BenchmarkOptions mOptions;
+	};
+
+} // namespace
+
+#endif
@@ -0,0 +1,92 @@
+/* Copyright 2013 David Axmark
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+	http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <conprint.h>
+
+#include "BenchmarkRunner.h"
+#include "TestRunner.h"
+#include "XMLOutputTestListener.h"
+#include "JSONOutputTestListener.h"
+
+namespace MATest
+{
+	BenchmarkRunner::BenchmarkRunner(const MAUtil::String& name) :
+		mName(name),
+		mSuite(name),
+		mFailed(0)
+	{
+		if (mBaseline.loadStore((mName + ".baseline").c_str()))
+		{
+			Benchmark::setBaseline(&mBaseline);
+		}
+		else
+		{
+			printf("No baseline, this run will be the baseline.\n");
+		}
+
+		mSuite.addTestListener(new HighLevelTestListener());
+		mSuite.addTestListener(new XMLOutputTestListener(
+			maCreatePlaceholder(), mName + ".xml"));
+		mSuite.addTestListener(new JSONOutputTestListener(
+			maCreatePlaceholder(), mName + ".json"));
+		mSuite.addTestListener(this);
+	}
+
+	BenchmarkRunner::~BenchmarkRunner()
+	{
+	}
+
+	void BenchmarkRunner::addBenchmark(BenchmarkCase* benchmark)
+	{
+		mSuite.addTestCase(benchmark);
+	}
+
+	TestSuite& BenchmarkRunner::getSuite()
+	{
+		return mSuite;
+	}
+
+	void BenchmarkRunner::runBenchmarks()
+	{
+		mSuite.runNextCase();
+		MAUtil::Moblet::run(this);
+	}
+
+	void BenchmarkRunner::assertion(
+		const MAUtil::String& assertionName,
+		bool cond)
+	{
+		if (!cond)
+		{
+			mFailed++;
+		}
+	}
+
+	void BenchmarkRunner::benchmark(const BenchmarkResult& result)
+	{
+		mResults.set(result.name, result.median);
+	}
+
+	void BenchmarkRunner::endTestSuite()
+	{
+		if (0 == mBaseline.size())
+		{
+			mResults.saveStore((mName + ".baseline").c_str());
+		}
+		printf("%s: %i failures.\n", mName.c_str(), mFailed);
+		maExit(mFailed);
+	}
+
+} // namespace
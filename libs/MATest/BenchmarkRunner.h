@@ -0,0 +1,101 @@
+/* Copyright 2013 David Axmark
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+	http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+/*
+* @file BenchmarkRunner.h
+* @brief Runs a suite of benchmarks without user interaction.
+*/
+
+#ifndef __MOSYNC_LIBS_MATEST_BENCHMARKRUNNER_H__
+#define __MOSYNC_LIBS_MATEST_BENCHMARKRUNNER_H__
+
+#include <MAUtil/Moblet.h>
+#include <MAUtil/String.h>
+
+#include "Test.h"
+#include "Benchmark.h"
+
+namespace MATest
+{
+	/**
+	* @brief Runs a suite of benchmarks and exits when it is done,
+	* so that it can run on a headless runtime.
+	*
+	* The medians are compared with the baseline in the store
+	* "<name>.baseline". If there is no such store, it is created
+	* from the medians of this run. The results are written to the
+	* console, as XML to the store "<name>.xml" and as JSON to the
+	* store "<name>.json" and the log.
+	*
+	* The exit code is the number of failed assertions, which
+	* includes the regressions.
+	*/
+	class BenchmarkRunner : public MAUtil::Moblet, public TestListener
+	{
+	public:
+		/**
+		 * @brief Constructor.
+		 * @param name Name of the suite and prefix of the stores.
+		 */
+		BenchmarkRunner(const MAUtil::String& name);
+
+		/**
+		 * @brief Destructor.
+		 */
+		virtual ~BenchmarkRunner();
+
+		/**
+		 * @brief Add a benchmark to the suite.
+		 */
+		void addBenchmark(BenchmarkCase* benchmark);
+
+		/**
+		 * @brief The suite, for adding listeners or other test cases.
+		 */
+		TestSuite& getSuite();
+
+		/**
+		 * @brief Run the benchmarks. Does not return.
+		 */
+		void runBenchmarks();
+
+		// ***** Methods inherited from TestListener *****
+
+		virtual void assertion(const MAUtil::String& assertionName, bool cond);
+
+		virtual void benchmark(const BenchmarkResult& result);
+
+		virtual void endTestSuite();
+
+	protected:
+		MAUtil::String mName;
+		TestSuite mSuite;
+
+		/**
+		 * @brief The baseline that is compared with.
+		 */
+		BenchmarkBaseline mBaseline;
+
+		/**
+		 * @brief The medians of this run.
+		 */
+		BenchmarkBaseline mResults;
+
+		int mFailed;
+	};
+
+} // namespace
+
+#endif
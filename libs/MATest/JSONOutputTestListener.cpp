@@ -0,0 +1,149 @@
+/* Copyright 2013 David Axmark
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+	http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <conprint.h>
+#include <matime.h>
+#include <mavsprintf.h>
+
+#include "Test.h"
+#include "Benchmark.h"
+#include "JSONOutputTestListener.h"
+
+namespace MATest
+{
+	using namespace MAUtil;
+
+	JSONOutputTestListener::JSONOutputTestListener(
+		MAHandle placeholder,
+		const String& storeName)
+	{
+		this->storeName = storeName;
+		this->placeHolder = placeholder;
+		beginJSON();
+	}
+
+	JSONOutputTestListener::~JSONOutputTestListener()
+	{
+	}
+
+	void JSONOutputTestListener::appendString(String& output, const String& str)
+	{
+		char buf[8];
+		output+="\"";
+		for (int i = 0; i < str.length(); i++)
+		{
+			char c = str[i];
+			if ('"' == c || '\\' == c)
+			{
+				output+="\\";
+				output+=c;
+			}
+			else if ((unsigned char)c < 0x20)
+			{
+				sprintf(buf, "\\u%04x", c);
+				output+=buf;
+			}
+			else
+			{
+				output+=c;
+			}
+		}
+		output+="\"";
+	}
+
+	void JSONOutputTestListener::beginJSON()
+	{
+		jsonOutput="{\"time\":";
+		appendString(jsonOutput, sprint_time(maLocalTime()));
+		jsonOutput+=",\"suites\":[";
+	}
+
+	void JSONOutputTestListener::endJSON()
+	{
+		jsonOutput+="]}\n";
+		maWriteLog(jsonOutput.c_str(), jsonOutput.length());
+
+		MAHandle store = maOpenStore(storeName.c_str(), MAS_CREATE_IF_NECESSARY);
+		maCreateData(placeHolder, jsonOutput.length());
+		maWriteData(placeHolder, jsonOutput.c_str(), 0, jsonOutput.length());
+		maWriteStore(store, placeHolder);
+		maCloseStore(store, 0);
+	}
+
+	void JSONOutputTestListener::beginTestSuite(const String &str)
+	{
+		beginJSON();
+		jsonOutput+="{\"name\":";
+		appendString(jsonOutput, str);
+		jsonOutput+=",\"cases\":[";
+		firstCase = true;
+	}
+
+	void JSONOutputTestListener::endTestSuite()
+	{
+		jsonOutput+="]}";
+		endJSON();
+	}
+
+	void JSONOutputTestListener::beginTestCase(const String &str)
+	{
+		if (!firstCase)
+		{
+			jsonOutput+=",";
+		}
+		firstCase = false;
+		jsonOutput+="\n{\"name\":";
+		appendString(jsonOutput, str);
+		assertions="";
+		benchmarks="";
+	}
+
+	void JSONOutputTestListener::endTestCase()
+	{
+		jsonOutput+=",\"assertions\":[" + assertions + "]";
+		jsonOutput+=",\"benchmarks\":[" + benchmarks + "]}";
+	}
+
+	void JSONOutputTestListener::assertion(const String &str, bool cond)
+	{
+		if (assertions.length() > 0)
+		{
+			assertions+=",";
+		}
+		assertions+="{\"name\":";
+		appendString(assertions, str);
+		assertions+=cond ? ",\"result\":true}" : ",\"result\":false}";
+	}
+
+	void JSONOutputTestListener::benchmark(const BenchmarkResult& result)
+	{
+		char buf[256];
+		if (benchmarks.length() > 0)
+		{
+			benchmarks+=",";
+		}
+		benchmarks+="{\"name\":";
+		appendString(benchmarks, result.name);
+		sprintf(buf,
+			",\"iterations\":%i,\"samples\":%i,\"outliers\":%i,"
+			"\"min\":%.3f,\"median\":%.3f,\"p95\":%.3f,\"mean\":%.3f,"
+			"\"baseline\":%.3f,\"regression\":%s}",
+			result.iterations, result.samples, result.outliers,
+			result.min, result.median, result.p95, result.mean,
+			result.baseline, result.regression ? "true" : "false");
+		benchmarks+=buf;
+	}
+}
+// namespace
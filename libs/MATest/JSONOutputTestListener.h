@@ -0,0 +1,71 @@
+/* Copyright 2013 David Axmark
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+	http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+/*
+* @file JSONOutputTestListener.h
+* @brief Test listener that saves test result as JSON.
+*/
+
+#ifndef __MOSYNC_LIBS_MATEST_JSON_OUTPUT_TEST_LISTENER_H__
+#define __MOSYNC_LIBS_MATEST_JSON_OUTPUT_TEST_LISTENER_H__
+
+#include <ma.h>
+#include <MAUtil/String.h>
+
+#include "Test.h"
+
+namespace MATest
+{
+	/**
+	* @brief Implementation of a TestListener that ouputs
+	* test results as JSON to a data store.
+	*
+	* The output has the form:
+	* {"time":"...","suites":[{"name":"...","cases":[{"name":"...",
+	* "assertions":[{"name":"...","result":true}],
+	* "benchmarks":[{"name":"...","median":1.5,...}]}]}]}
+	*/
+	class JSONOutputTestListener : public TestListener
+	{
+	private:
+		MAUtil::String jsonOutput;
+		MAUtil::String storeName;
+		MAHandle placeHolder;
+		MAUtil::String assertions;
+		MAUtil::String benchmarks;
+		bool firstCase;
+
+		void appendString(MAUtil::String& output, const MAUtil::String& str);
+	public:
+		JSONOutputTestListener(
+			MAHandle placeholder,
+			const MAUtil::String& storeName);
+
+		~JSONOutputTestListener();
+
+		void beginJSON();
+		void endJSON();
+
+		void beginTestSuite(const MAUtil::String &str);
+		void endTestSuite();
+		void beginTestCase(const MAUtil::String &str);
+		void endTestCase();
+		void assertion(const MAUtil::String &str, bool success);
+		void benchmark(const BenchmarkResult& result);
+	};
+
+} // namespace
+
+#endif
@@ -36,6 +36,7 @@ namespace MATest
 	void TestListener::assertion(const MAUtil::String& assertionName, bool cond) {}
 	void TestListener::expectation(const MAUtil::String& assertionName) {}
 	void TestListener::timedOut(const MAUtil::String& testCaseName) {}
+	void TestListener::benchmark(const BenchmarkResult& result) {}
 
 	/* ========== Class TestCaseTimeOutListener ========== */
 
@@ -331,5 +332,13 @@ namespace MATest
 			mTestListeners[i]->timedOut(testCaseName);
 		}
 	}
+
+	void TestSuite::fireBenchmark(const BenchmarkResult& result)
+	{
+		for (int i = 0; i < mTestListeners.size(); i++)
+		{
+			mTestListeners[i]->benchmark(result);
+		}
+	}
 }
 // namespace
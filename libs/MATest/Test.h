@@ -31,6 +31,7 @@ namespace MATest
 	// Forward declarations.
 	class TestSuite;
 	class TestCase;
+	struct BenchmarkResult;
 
 	/**
 	* @brief Listener for events triggered when running tests.
@@ -84,6 +85,11 @@ namespace MATest
 		 * @brief Called when a test case times out.
 		 */
 		virtual void timedOut(const MAUtil::String& testCaseName);
+
+		/**
+		 * @brief Called when a benchmark has been measured.
+		 */
+		virtual void benchmark(const BenchmarkResult& result);
 	};
 
 	/**
@@ -307,6 +313,11 @@ namespace MATest
 		 */
 		virtual void fireTimedOut(const MAUtil::String& testCaseName);
 
+		/**
+		 * @brief Send benchmark result to listeners.
+		 */
+		virtual void fireBenchmark(const BenchmarkResult& result);
+
 	protected:
 		/**
 		 * @brief Name of test suite.
@@ -221,4 +221,16 @@ namespace MATest
 		mTestCasesTimedOut.add(testCaseName);
 	}
 
+	void HighLevelTestListener::benchmark(
+		const BenchmarkResult& result)
+	{
+		printf("%s: median %.3f us, p95 %.3f us, min %.3f us\n",
+			result.name.c_str(), result.median, result.p95, result.min);
+		if (result.baseline > 0)
+		{
+			printf("  baseline %.3f us%s\n", result.baseline,
+				result.regression ? ", REGRESSION" : "");
+		}
+	}
+
 } // namespace
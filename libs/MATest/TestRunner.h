@@ -26,6 +26,7 @@ limitations under the License.
 #include <MAUtil/Set.h>
 #include <MAUtil/Environment.h>
 #include "Test.h"
+#include "Benchmark.h"
 
 namespace MATest
 {
@@ -225,6 +226,11 @@ namespace MATest
 		 */
 		virtual void timedOut(const MAUtil::String& testCaseName);
 
+		/**
+		 * @brief Prints the benchmark result.
+		 */
+		virtual void benchmark(const BenchmarkResult& result);
+
 	protected:
 
 		// ***** Instance variables *****
@@ -17,6 +17,7 @@ limitations under the License.
 #include <matime.h>
 #include <mavsprintf.h>
 #include "Test.h"
+#include "Benchmark.h"
 #include "XMLOutputTestListener.h"
 
 #define XML_LOGGING
@@ -115,5 +116,20 @@ namespace MATest
 		}
 		xmlOutput+="\t\t\t<Assertion name=\"" + str + "\" result=\"" + res + "\"/>\n";
 	}
+
+	void XMLOutputTestListener::benchmark(const BenchmarkResult& result)
+	{
+		char buf[256];
+		XML_LOG("%s: median %.3f us, p95 %.3f us",
+			result.name.c_str(), result.median, result.p95);
+		sprintf(buf,
+			"iterations=\"%i\" samples=\"%i\" outliers=\"%i\" "
+			"min=\"%.3f\" median=\"%.3f\" p95=\"%.3f\" mean=\"%.3f\" "
+			"baseline=\"%.3f\" regression=\"%s\"",
+			result.iterations, result.samples, result.outliers,
+			result.min, result.median, result.p95, result.mean,
+			result.baseline, result.regression ? "true" : "false");
+		xmlOutput+="\t\t\t<Benchmark name=\"" + result.name + "\" " + buf + "/>\n";
+	}
 }
 // namespace
@@ -51,6 +51,7 @@ namespace MATest
 		void beginTestCase(const MAUtil::String &str);
 		void endTestCase();
 		void assertion(const MAUtil::String &str, bool success);
+		void benchmark(const BenchmarkResult& result);
 	};
 } // namespace
 
@@ -235,8 +235,11 @@ namespace MAUI {
 			bound.x = 0;
 		}
 
-//		Rect r = font->calculateRectOfIndex(cursorIndex, text.c_str(), bound);
-		Rect r = font->calculateRectOfIndex(cursorIndex, caption.c_str(), bound);
+		// the caption is only laid out again when it changes.
+		const TextLayout& layout = getLayout(
+			multiLine ? bound.width : (int)TextLayout::UNBOUNDED);
+		Rect r = layout.getRectOfIndex(cursorIndex);
+		Rect clip = Rect(0, 0, paddedBounds.width, paddedBounds.height);
 
 		if(multiLine) {
 			// 2 equals the cursor width ;)
@@ -244,9 +247,7 @@ namespace MAUI {
 				y-=(bound.y+r.y+r.height+2)-(paddedBounds.height);
 				//Gfx_translate(x, y);
 			}
-//			font->drawBoundedString(text.c_str(), x, y, bound);
-//			Gfx_translate(x, y);
-			font->drawBoundedString(caption.c_str(), bound.x+x, bound.y+y, bound);
+			layout.draw(bound.x+x, bound.y+y, clip);
 			
 		} else {
 			// 2 equals the cursor width ;)
@@ -254,10 +255,7 @@ namespace MAUI {
 				x-=(bound.x+r.x+r.width+2)-(paddedBounds.width);
 				//Gfx_translate(x, y);
 			}
-//			font->drawString(text.c_str(), x, y);
-			
-			//Gfx_translate(x, y);
-			font->drawString(caption.c_str(), bound.x+x, bound.y+y);
+			layout.draw(bound.x+x, bound.y+y, clip);
 		}
 
 		//Label::drawWidget();
@@ -336,7 +334,7 @@ namespace MAUI {
 		fireCharacterChanged(c);
 	
 		//calcStrSize();
-		mustCalcStrSize = true;
+		captionChanged();
 	}
 	
 	void EditBox::characterDeployed(char c) {
@@ -357,6 +355,7 @@ namespace MAUI {
 		} else {
 			caption[currentIndex] = c;
 		}
+		captionChanged();
 		fireTextChanged();
 		fireCharacterAdded(c);
 		requestRepaint();
@@ -402,12 +401,10 @@ namespace MAUI {
 		text.resize(text.size()-1);
 		cursorIndex--;
 */
+		captionChanged();
 		fireCharacterDeleted(deletedCharacter);
 		fireTextChanged();
 		requestRepaint();
-				
-		//calcStrSize();
-		mustCalcStrSize = true;
 
 		return true;
 	}
@@ -492,10 +489,12 @@ namespace MAUI {
 			for(int i=0; i<caption.length(); i++) {
 				caption[i] = '*';
 			}
+			captionChanged();
 			requestRepaint();
 		}
 		if(!enabled && this->passwordMode) {
 			caption = password;
+			captionChanged();
 			requestRepaint();
 		}
 		this->passwordMode = enabled;
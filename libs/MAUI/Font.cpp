@@ -14,6 +14,7 @@ limitations under the License.
 */
 
 #include <ma.h>
+#include <mastring.h>
 
 #include "Font.h"
 #include <MAUtil/Graphics.h>
@@ -257,11 +258,15 @@ namespace MAUI {
 		return 1;
 	}
 
-	Font::Font(MAHandle font) : mFontImage(0), mCharset(NULL), mLineSpacing(0) {
+	Font::Font(MAHandle font) : mFontImage(0), mCharset(NULL), mLineSpacing(0), mNextLayout(0) {
+		for(int i = 0; i < LAYOUT_CACHE_SIZE; i++) {
+			mLayouts[i] = NULL;
+		}
 		setResource(font);
 	}
 
 	Font::~Font() {
+		clearLayouts();
 		if(mFontImage) {
 			maDestroyPlaceholder(mFontImage);
 		}
@@ -277,6 +282,8 @@ namespace MAUI {
 	}
 
 	void Font::setLineSpacing(int size) {
+		if(size != mLineSpacing)
+			clearLayouts();
 		mLineSpacing = size;
 	}
 
@@ -286,6 +293,7 @@ namespace MAUI {
 
 	void Font::setResource(MAHandle font) {
 		//printf("Font is using resource: %d\n", font);
+		clearLayouts();
 		if(font == 0) {
 			mFontImage = 0;
 			return;
@@ -376,82 +384,31 @@ namespace MAUI {
 		}
 	}
 
-	short lineBreaks[2048]; // TODO: should probably change this to a vector (no good with limitations)
-	int numLineBreaks;
-
-	void Font::calcLineBreaks(const char* strS, int x, int y, const Rect& bound) const {
-		int i = 0;
-		int j = 0;
-		int lastSpace = -1;
-		MAPoint2d cursor = {x, y};
-		CharDescriptor *chars = mCharset->chars;
-		const unsigned char* str = (const unsigned char*)strS;
-
-		while(str[i]) {
-			if(str[i] == ' ') {
-				lastSpace = i;
-			} else if(str[i]=='\n') {
-
-				cursor.x = x;
-				cursor.y += mCharset->lineHeight + mLineSpacing;
-				lineBreaks[j++] = i;
-				i++;
-				continue;
-			}
-
-
-			 cursor.x += chars[str[i]].xAdvance;
-			 if(cursor.x > bound.x + bound.width) {
-				if(lastSpace == -1) {
-					lineBreaks[j++] = i;
-				} else {
-					lineBreaks[j++] = lastSpace+1;
-					i = lastSpace+1;
-					lastSpace = -1;
-				}
-				cursor.x = x + chars[str[i]].xAdvance;
-			}
+	void Font::clearLayouts() {
+		for(int i = 0; i < LAYOUT_CACHE_SIZE; i++) {
+			delete mLayouts[i];
+			mLayouts[i] = NULL;
+		}
+	}
 
-			i++;
+	const TextLayout& Font::getLayout(const char* str, int width) const {
+		int length = strlen(str);
+		for(int i = 0; i < LAYOUT_CACHE_SIZE; i++) {
+			if(mLayouts[i] && mLayouts[i]->matches(this, str, length, width))
+				return *mLayouts[i];
 		}
-		numLineBreaks = j;
-		lineBreaks[j] = -1;
+		// replace the oldest one.
+		TextLayout*& layout = mLayouts[mNextLayout];
+		mNextLayout = (mNextLayout + 1) % LAYOUT_CACHE_SIZE;
+		delete layout;
+		layout = new TextLayout(this, str, width);
+		return *layout;
 	}
 
-	void Font::drawBoundedString(const char* strS, int x, int y, const Rect& bound) {
-		int i = 0;
-		int j = 0;
+	void Font::drawBoundedString(const char* str, int x, int y, const Rect& bound) {
 		if(!mFontImage) return;
-		const unsigned char* str = (const unsigned char*)strS;
-		calcLineBreaks(strS, x, y, bound);
-		MARect srcRect = {0, 0, 0, 0};
-		MAPoint2d cursor = {x, y};
-		CharDescriptor *chars = mCharset->chars;
-		while(str[i]) {
-			if(lineBreaks[j] == i) {
-				j++;
-				cursor.x = x;
-				cursor.y += mCharset->lineHeight + mLineSpacing;
-				if(str[i]=='\n') {
-					i++;
-					continue;
-				}
-			}
-
-			srcRect.left = chars[str[i]].x;
-			srcRect.top = chars[str[i]].y;
-			srcRect.width = chars[str[i]].width;
-			srcRect.height = chars[str[i]].height;
-
-			MAPoint2d destPoint = {cursor.x + chars[str[i]].xOffset,
-				cursor.y + chars[str[i]].yOffset};
-
-			//maDrawImageRegion(this->mFontImage, &srcRect, &destPoint, 0);
-			Gfx_drawImageRegion(this->mFontImage, &srcRect, &destPoint, 0);
-
-			cursor.x += chars[str[i]].xAdvance;
-			i++;
-		}
+		// lines end at the right edge of bound.
+		getLayout(str, bound.x + bound.width - x).draw(x, y);
 	}
 
 	MAExtent Font::getStringDimensions(const char *strS, int length) const {
@@ -489,82 +446,24 @@ namespace MAUI {
 		return EXTENT(width, height);
 	}
 
-	MAExtent Font::getBoundedStringDimensions(const char *strS, const Rect &bound,
+	MAExtent Font::getBoundedStringDimensions(const char *str, const Rect &bound,
 		int length) const
 	{
 		if(length == 0) return EXTENT(0, 0);
-		int i = 0;
-		int j = 0;
 		if(!mFontImage) return EXTENT(0, 0);
-		calcLineBreaks(strS, bound.x, bound.y, bound);
-		//MARect srcRect = {0, 0, 0, 0};
-		MAPoint2d cursor = {0, 0};
-		int height = 0;
-		int width = 0;
-		CharDescriptor *chars = mCharset->chars;
-		const unsigned char* str = (const unsigned char*)strS;
-		while(*str && (i!=length)) {
-			if((lineBreaks[j] == i) || ((*str) == '\n')) {
-				j++;
-				cursor.x = 0;
-				cursor.y += mCharset->lineHeight + mLineSpacing;
-				str++;
-				i++;
-				continue;
-			} else {
-				cursor.x += chars[*str].xAdvance;
-			}
-
-			if(cursor.y + mCharset->lineHeight//mCharset.chars[*str].yOffset + mCharset.chars[*str].height
-			> height) {
-				//height = (cursor.y + mCharset.chars[*str].yOffset + mCharset.chars[*str].height);
-				height = cursor.y + mCharset->lineHeight;
-			}
-
-			if(cursor.x//mCharset.chars[*str].xOffset + mCharset.chars[*str].width
-			> width) {
-				//width = (cursor.x + mCharset.chars[*str].xOffset + mCharset.chars[*str].width);
-				width = cursor.x; //cursor.x + mCharset.chars[*str].xAdvance;
-			}
-
-
-			str++;
-			i++;
-		}
-		return EXTENT(width, height);
+		return getLayout(str, bound.width).getDimensions(length);
 	}
 
 	int Font::getLineBreak(int line, const char *str, const Rect& bound) const {
-		calcLineBreaks(str, bound.x, bound.y, bound);
-		if(line < 0 || line >= numLineBreaks) return -1;
-		else return lineBreaks[line];
+		return getLayout(str, bound.width).getLineBreak(line);
 	}
 
 	int Font::calculateLine(int index, const char *str, const Rect& bound) const {
-		calcLineBreaks(str, bound.x, bound.y, bound);
-		//short *ptrLineBreaks = lineBreaks;
-		int i = 0;
-		for(i = 0; i < numLineBreaks; i++) {
-			if(index<=lineBreaks[i]) {
-				return i;
-			}
-		}
-		return i;
+		return getLayout(str, bound.width).getLineOfIndex(index);
 	}
 
 	Rect Font::calculateRectOfIndex(int index, const char *str, const Rect& bound) const {
-		int line = calculateLine(index, str, bound);
-		int lineBreak = 0;
-		if(line>0)
-			lineBreak = getLineBreak(line-1, str, bound);
-
-		MAPoint2d cursor = {0, 0};
-		cursor.y+=line*mCharset->lineHeight;
-		MAExtent lineRect = getStringDimensions(&str[lineBreak], index-lineBreak);
-		cursor.x+=EXTENT_X(lineRect);
-		MAExtent charRect = getStringDimensions(&str[index], 1);
-		return Rect(cursor.x, cursor.y, EXTENT_X(charRect), mCharset->lineHeight);
-
+		return getLayout(str, bound.width).getRectOfIndex(index);
 	}
 
 	const Charset& Font::getCharset() const {
@@ -26,6 +26,8 @@ limitations under the License.
 
 #include <MAUtil/Geometry.h>
 
+#include "TextLayout.h"
+
 namespace MAUI {
 
 	using namespace MAUtil;
@@ -127,14 +129,28 @@ namespace MAUI {
 
 		const Charset& getCharset() const;
 
+		/**
+		* Returns the layout of str, linebroken at \a width pixels.
+		* The last few layouts are kept, so asking for the same string and
+		* width again, as a widget does every time it is drawn, doesn't lay it
+		* out again. The layout is valid until the next call to getLayout(),
+		* setResource() or setLineSpacing().
+		**/
+		const TextLayout& getLayout(const char* str, int width=TextLayout::UNBOUNDED) const;
+
 	protected:
-		
+		friend class TextLayout;
+
 		void calcCharPos(char c, int *x, int *y);
-		void calcLineBreaks(const char* str, int x, int y, const Rect& bound) const;
+		void clearLayouts();
 
 		MAHandle mFontImage;
 		Charset *mCharset;
 		int mLineSpacing;
+
+		enum { LAYOUT_CACHE_SIZE = 4 };
+		mutable TextLayout* mLayouts[LAYOUT_CACHE_SIZE];
+		mutable int mNextLayout;
 	};
 }
 
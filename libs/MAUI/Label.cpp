@@ -82,7 +82,9 @@ namespace MAUI {
 		autoSizeY(false),
 		multiLine(false),
 		horizontalAlignment(HA_LEFT),
-		verticalAlignment(VA_TOP)
+		verticalAlignment(VA_TOP),
+		layout(NULL),
+		cutWidth(-1)
 	{
 		if(!font)
 		{
@@ -105,7 +107,9 @@ namespace MAUI {
 		autoSizeY(false),
 		multiLine(false),
 		horizontalAlignment(HA_LEFT),
-		verticalAlignment(VA_TOP)
+		verticalAlignment(VA_TOP),
+		layout(NULL),
+		cutWidth(-1)
 	{
 		if(!font)
 		{
@@ -120,23 +124,47 @@ namespace MAUI {
 		//calcStrSize();
 	}
 
+	Label::~Label() {
+		delete layout;
+	}
+
+	const TextLayout& Label::getLayout(int width) {
+		if(layout && layout->getWidth() != width) {
+			delete layout;
+			layout = NULL;
+		}
+		if(!layout)
+			layout = new TextLayout(font, caption.c_str(), width);
+		return *layout;
+	}
+
+	void Label::captionChanged() {
+		delete layout;
+		layout = NULL;
+		cutWidth = -1;
+		mustCalcStrSize = true;
+	}
+
 	void Label::calcStrSize() {
 		mustCalcStrSize = false;
-		Rect tempRect = Rect(0, 0, paddedBounds.width, paddedBounds.height);
 		if(!font) {
 			strSize = EXTENT(0,0);
+		} else if(multiLine && !autoSizeX) {
+			strSize = getLayout(paddedBounds.width).getDimensions();
 		} else {
-			if(autoSizeX)
-				strSize = font->getStringDimensions(caption.c_str());
-			else {
-				if(multiLine) {	
-					strSize = font->getBoundedStringDimensions(caption.c_str(), tempRect);
+			// a single line is only measured again when it changes.
+			int width = autoSizeX ? (int)TextLayout::UNBOUNDED : paddedBounds.width;
+			if(width != cutWidth) {
+				if(autoSizeX) {
+					cutSize = font->getStringDimensions(caption.c_str());
 				} else {
+					Rect tempRect = Rect(0, 0, paddedBounds.width, paddedBounds.height);
 					cutText(cuttedCaption, font, caption, tempRect);
-					strSize = font->getStringDimensions(cuttedCaption.c_str());
+					cutSize = font->getStringDimensions(cuttedCaption.c_str());
 				}
+				cutWidth = width;
 			}
-
+			strSize = cutSize;
 		}
 		strWidth  = EXTENT_X(strSize);
 		strHeight = EXTENT_Y(strSize);
@@ -221,8 +249,10 @@ namespace MAUI {
 
 		Rect tempRect = Rect(0, 0, paddedBounds.width, paddedBounds.height);
 		if(font) {
+			// laid out at the same width as in calcStrSize(), so this
+			// is the cached layout; only the visible lines are drawn.
 			if(multiLine)
-				font->drawBoundedString(wStr, textX, textY, tempRect);
+				getLayout(paddedBounds.width).draw(textX, textY, tempRect);
 			else  {
 
 				if(autoSizeX)
@@ -281,7 +311,7 @@ namespace MAUI {
 		this->caption = caption;
 		requestRepaint();
 		//calcStrSize();
-		mustCalcStrSize = true;
+		captionChanged();
 	}
 
 	const String& Label::getCaption() const {
@@ -295,7 +325,7 @@ namespace MAUI {
 			this->font = Engine::getSingleton().getDefaultFont();
 		requestRepaint();
 		//calcStrSize();
-		mustCalcStrSize = true;
+		captionChanged();
 	}
 
 	Font* Label::getFont() const {
@@ -72,6 +72,8 @@ namespace MAUI {
 		Label(int x, int y, int width, int height, Widget* parent, const String &caption,
 			int backColor, Font* font);
 
+		virtual ~Label();
+
 		/** Turns multiline mode on or off **/
 		void setMultiLine(bool b=true);
 		/** Returns whether multiline is enabled or not **/
@@ -130,9 +132,20 @@ namespace MAUI {
 		bool mustCalcStrSize;
 		void calcStrSize();
 
+		/** Returns the caption laid out at \a width, which is kept until the
+		* caption, the font or the width changes. **/
+		const TextLayout& getLayout(int width);
+		/** Forgets the cached layout and sizes. Call it after changing caption directly. **/
+		void captionChanged();
+
 		String caption;
 		String cuttedCaption;
 
+		TextLayout* layout;
+		/** The width cuttedCaption and cutSize were made for, or -1. **/
+		int cutWidth;
+		MAExtent cutSize;
+
 		Font* font;
 
 		bool autoSizeX;
@@ -0,0 +1,273 @@
+/* Copyright 2013 David Axmark
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+	http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <ma.h>
+#include <mastring.h>
+
+#include "TextLayout.h"
+#include "Font.h"
+#include <MAUtil/Graphics.h>
+
+namespace MAUI {
+
+	TextLayout::TextLayout(const Font* font, const char* str, int width) :
+		mFont(font), mText(str), mWidth(width)
+	{
+		build();
+	}
+
+	void TextLayout::build() {
+		const Charset* charset = mFont->mCharset;
+		const CharDescriptor* chars = charset ? charset->chars : NULL;
+		const unsigned char* str = (const unsigned char*)mText.c_str();
+		int n = mText.length();
+		mLineHeight = charset ? charset->lineHeight : 0;
+		mLineStep = mLineHeight + mFont->mLineSpacing;
+		mPen.resize(n);
+
+		int pen = 0;
+		int lastSpace = -1;
+		// the first character that is drawn on the current line.
+		int lineStart = 0;
+		int i = 0;
+		while(i < n) {
+			if(str[i] == '\n') {
+				mBreaks.add(i);
+				mPen[i] = 0;
+				pen = 0;
+				lastSpace = -1;
+				lineStart = i + 1;
+				i++;
+				continue;
+			}
+			if(str[i] == ' ')
+				lastSpace = i;
+			pen += chars ? chars[str[i]].xAdvance : 0;
+			mPen[i] = pen;
+
+			// a line isn't broken before its first character, nor after
+			// a space that ends it anyway.
+			if(pen > mWidth && i > lineStart &&
+				!(lastSpace == i && (i + 1 == n || str[i + 1] == '\n')))
+			{
+				int b = lastSpace == -1 ? i : lastSpace + 1;
+				mBreaks.add(b);
+				lastSpace = -1;
+				lineStart = b;
+				pen = 0;
+				// the characters after the break are laid out again.
+				i = b;
+				continue;
+			}
+			i++;
+		}
+
+		int lines = mBreaks.size() + 1;
+		mLineWidths.resize(lines);
+		mMaxWidths.resize(lines);
+		mLastFilled.resize(lines);
+		int maxWidth = 0;
+		int lastFilled = -1;
+		for(int line = 0; line < lines; line++) {
+			int start = getLineStart(line);
+			int end = getLineEnd(line);
+			// a '\n' is only ever first on its line, with a pen position of 0.
+			int width = end > start ? mPen[end - 1] : 0;
+			mLineWidths[line] = width;
+			if(width > maxWidth)
+				maxWidth = width;
+			mMaxWidths[line] = maxWidth;
+			if(end - start > (str[start] == '\n' ? 1 : 0))
+				lastFilled = line;
+			mLastFilled[line] = lastFilled;
+		}
+	}
+
+	bool TextLayout::matches(const Font* font, const char* str, int length, int width) const {
+		return mFont == font && mWidth == width && mText.length() == length &&
+			memcmp(mText.c_str(), str, length) == 0;
+	}
+
+	const String& TextLayout::getText() const {
+		return mText;
+	}
+
+	int TextLayout::getWidth() const {
+		return mWidth;
+	}
+
+	int TextLayout::getLineCount() const {
+		return mBreaks.size() + 1;
+	}
+
+	int TextLayout::getLineStep() const {
+		return mLineStep;
+	}
+
+	int TextLayout::getLineBreak(int line) const {
+		if(line < 0 || line >= mBreaks.size()) return -1;
+		return mBreaks[line];
+	}
+
+	int TextLayout::getLineWidth(int line) const {
+		return mLineWidths[line];
+	}
+
+	int TextLayout::getLineStart(int line) const {
+		return line == 0 ? 0 : mBreaks[line - 1];
+	}
+
+	int TextLayout::getLineEnd(int line) const {
+		return line < mBreaks.size() ? mBreaks[line] : mText.length();
+	}
+
+	int TextLayout::getLineOfIndex(int index) const {
+		// the first break at or after index.
+		int lo = 0, hi = mBreaks.size();
+		while(lo < hi) {
+			int mid = (lo + hi) >> 1;
+			if(mBreaks[mid] < index)
+				lo = mid + 1;
+			else
+				hi = mid;
+		}
+		return lo;
+	}
+
+	int TextLayout::getCursorX(int index) const {
+		return index <= 0 ? 0 : mPen[index - 1];
+	}
+
+	int TextLayout::getIndexAt(int x, int y) const {
+		int line = (y < 0 || mLineStep <= 0) ? 0 : y / mLineStep;
+		if(line >= getLineCount())
+			line = getLineCount() - 1;
+
+		// a cursor at the start of a line after the first is at
+		// the end of the line before it.
+		int lo = line == 0 ? 0 : getLineStart(line) + 1;
+		int hi = getLineEnd(line);
+		int first = lo;
+		while(lo < hi) {
+			int mid = (lo + hi) >> 1;
+			if(getCursorX(mid) < x)
+				lo = mid + 1;
+			else
+				hi = mid;
+		}
+		if(lo > first && x - getCursorX(lo - 1) <= getCursorX(lo) - x)
+			lo--;
+		return lo;
+	}
+
+	Rect TextLayout::getRectOfIndex(int index) const {
+		int n = mText.length();
+		if(index < 0) index = 0;
+		if(index > n) index = n;
+		int line = getLineOfIndex(index);
+		int width = 0;
+		if(index < n && mText[index] != '\n' && mFont->mCharset)
+			width = mFont->mCharset->chars[(unsigned char)mText[index]].xAdvance;
+		return Rect(getCursorX(index), line * mLineStep, width, mLineHeight);
+	}
+
+	MAExtent TextLayout::getDimensions(int length) const {
+		int n = mText.length();
+		if(length < 0 || length > n) length = n;
+		if(length == 0) return EXTENT(0, 0);
+
+		// the line of the last character; the number of breaks before it.
+		int last = length - 1;
+		int line = getLineOfIndex(last + 1);
+
+		int width = mPen[last];
+		int lastFilled = -1;
+		if(line > 0) {
+			if(mMaxWidths[line - 1] > width)
+				width = mMaxWidths[line - 1];
+			lastFilled = mLastFilled[line - 1];
+		}
+		int start = getLineStart(line);
+		if(last > start || mText[start] != '\n')
+			lastFilled = line;
+		int height = lastFilled < 0 ? 0 : lastFilled * mLineStep + mLineHeight;
+		return EXTENT(width, height);
+	}
+
+	void TextLayout::draw(int x, int y) const {
+		for(int line = 0; line < getLineCount(); line++) {
+			drawLine(line, x, y + line * mLineStep, -0x7fffffff, 0x7fffffff);
+		}
+	}
+
+	void TextLayout::draw(int x, int y, const Rect& clip) const {
+		int first = 0;
+		int last = getLineCount() - 1;
+		if(mLineStep > 0) {
+			// glyphs may reach a little outside their line.
+			int top = clip.y - y - mLineStep;
+			int bottom = clip.y + clip.height - y + mLineStep;
+			if(top > 0)
+				first = top / mLineStep;
+			if(bottom < 0)
+				return;
+			if(bottom / mLineStep < last)
+				last = bottom / mLineStep;
+		}
+		for(int line = first; line <= last; line++) {
+			drawLine(line, x, y + line * mLineStep, clip.x, clip.x + clip.width);
+		}
+	}
+
+	void TextLayout::drawLine(int line, int x, int y, int left, int right) const {
+		if(!mFont->mFontImage) return;
+		const unsigned char* str = (const unsigned char*)mText.c_str();
+		const CharDescriptor* chars = mFont->mCharset->chars;
+		int start = getLineStart(line);
+		int end = getLineEnd(line);
+		int i = start;
+		if(i < end && str[i] == '\n')
+			i++;
+
+		// skip the characters that end left of the clip rect,
+		// and one more, which may reach into it.
+		int lo = i, hi = end;
+		while(lo < hi) {
+			int mid = (lo + hi) >> 1;
+			if(x + mPen[mid] < left)
+				lo = mid + 1;
+			else
+				hi = mid;
+		}
+		if(lo > i)
+			i = lo - 1;
+
+		if(i >= end) return;
+		MARect srcRect = {0, 0, 0, 0};
+		MAPoint2d cursor = {x + mPen[i] - chars[str[i]].xAdvance, y};
+		for(; i < end && cursor.x <= right; i++) {
+			const CharDescriptor& cd = chars[str[i]];
+			srcRect.left = cd.x;
+			srcRect.top = cd.y;
+			srcRect.width = cd.width;
+			srcRect.height = cd.height;
+
+			MAPoint2d destPoint = {cursor.x + cd.xOffset, cursor.y + cd.yOffset};
+			Gfx_drawImageRegion(mFont->mFontImage, &srcRect, &destPoint, 0);
+
+			cursor.x += cd.xAdvance;
+		}
+	}
+}
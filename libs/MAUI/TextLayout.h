@@ -0,0 +1,144 @@
+/* Copyright 2013 David Axmark
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+	http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+/**
+* \file TextLayout.h
+* \brief Line breaks and glyph positions of a string in a bitmap font
+*/
+
+#ifndef _SE_MSAB_MAUI_TEXTLAYOUT_H_
+#define _SE_MSAB_MAUI_TEXTLAYOUT_H_
+
+#include <ma.h>
+
+#include <MAUtil/Geometry.h>
+#include <MAUtil/String.h>
+#include <MAUtil/Vector.h>
+
+namespace MAUI {
+
+	using namespace MAUtil;
+
+	class Font;
+
+	/** \brief The layout of a string in a Font, linebroken at a given width.
+	*
+	* A TextLayout is built once, and holds the line breaks, the position
+	* of every glyph and the width of every line. It doesn't change after
+	* that, so it can be drawn and queried any number of times; the queries
+	* that map between string indices and positions are binary searches.
+	*
+	* Lines are broken after the last space that fits, or before the first
+	* character that doesn't if there is no space, and at every '\\n'.
+	* The line breaks are those Font::getLineBreak() returns: the index of
+	* the first character of the next line, or of the '\\n' that ended it.
+	**/
+	class TextLayout {
+	public:
+		/** A width at which no lines are broken, other than at '\\n'. **/
+		enum { UNBOUNDED = 0x7fffffff };
+
+		/**
+		* Lays out \a str in \a font, with lines no wider than \a width
+		* pixels. The string is copied. The font must outlive the layout,
+		* and its resource and line spacing must not change.
+		**/
+		TextLayout(const Font* font, const char* str, int width=UNBOUNDED);
+
+		/** Returns true if this is the layout of \a str at \a width in \a font. **/
+		bool matches(const Font* font, const char* str, int length, int width) const;
+
+		/** Returns the laid out string. **/
+		const String& getText() const;
+
+		/** Returns the width the layout was made for. **/
+		int getWidth() const;
+
+		/** Returns the number of lines. There is always at least one. **/
+		int getLineCount() const;
+
+		/** Returns the vertical distance between lines, including the font's line spacing. **/
+		int getLineStep() const;
+
+		/**
+		* Returns the index of the line break that ends \a line,
+		* or -1 if it is the last line.
+		**/
+		int getLineBreak(int line) const;
+
+		/** Returns the width of \a line, in pixels. **/
+		int getLineWidth(int line) const;
+
+		/**
+		* Returns the line a cursor at \a index is on. A cursor at a line
+		* break is at the end of the line before it.
+		**/
+		int getLineOfIndex(int index) const;
+
+		/**
+		* Returns the cursor index nearest to \a x, \a y,
+		* relative to the top left corner of the text.
+		**/
+		int getIndexAt(int x, int y) const;
+
+		/**
+		* Returns the rectangle of the character at \a index, relative to the
+		* top left corner of the text. Its left edge is where a cursor at
+		* \a index is drawn; its width is 0 at a '\\n' or the end of the string.
+		**/
+		Rect getRectOfIndex(int index) const;
+
+		/**
+		* Returns the width and height of the first \a length characters,
+		* or of all of them if \a length is -1. Lines with nothing but a '\\n'
+		* at the end of the text aren't counted.
+		**/
+		MAExtent getDimensions(int length=-1) const;
+
+		/** Draws the text with its top left corner at \a x, \a y. **/
+		void draw(int x, int y) const;
+
+		/**
+		* Draws the text with its top left corner at \a x, \a y,
+		* skipping the lines and the characters outside \a clip.
+		**/
+		void draw(int x, int y, const Rect& clip) const;
+
+	private:
+		void build();
+		int getLineStart(int line) const;
+		int getLineEnd(int line) const;
+		int getCursorX(int index) const;
+		void drawLine(int line, int x, int y, int left, int right) const;
+
+		const Font* mFont;
+		String mText;
+		int mWidth;
+		int mLineHeight;
+		int mLineStep;
+
+		/** The breaks that end each line but the last. **/
+		Vector<int> mBreaks;
+		/** The pen position after each character, from the start of its line. **/
+		Vector<int> mPen;
+		Vector<int> mLineWidths;
+		/** The widest of lines 0 to n. **/
+		Vector<int> mMaxWidths;
+		/** The last line, of lines 0 to n, with more than a '\\n' on it; -1 if none. **/
+		Vector<int> mLastFilled;
+	};
+}
+
+#endif
@@ -0,0 +1,386 @@
+/* Copyright 2013 David Axmark
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+	http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <ma.h>
+#include "VirtualListBox.h"
+
+namespace MAUI {
+	VirtualListBox::VirtualListBox(int x, int y, int width, int height, Widget *parent,
+		ListBox::ListBoxOrientation orientation)
+		: Widget(x, y, width, height, parent),
+		adapter(NULL),
+		orientation(orientation),
+		scrollOffset(0),
+		margin(2),
+		selectedIndex(-1),
+		wrapping(true),
+		firstIndex(0)
+	{
+		offsets.add(0);
+		requestRepaint();
+	}
+
+	VirtualListBox::~VirtualListBox() {
+		for(int i = 0; i < released.size(); i++)
+			delete released[i].widget;
+		// the children are deleted by ~Widget().
+	}
+
+	void VirtualListBox::setAdapter(ListBoxAdapter* adapter) {
+		releaseAll();
+		for(int i = 0; i < released.size(); i++)
+			delete released[i].widget;
+		released.clear();
+		this->adapter = adapter;
+		scrollOffset = 0;
+		selectedIndex = -1;
+		readExtents();
+		if(offsets.size() > 1)
+			selectedIndex = 0;
+		layout();
+	}
+
+	ListBoxAdapter* VirtualListBox::getAdapter() const {
+		return adapter;
+	}
+
+	void VirtualListBox::readExtents() {
+		int count = adapter ? adapter->getItemCount() : 0;
+		offsets.resize(count + 1);
+		int offset = 0;
+		for(int i = 0; i < count; i++) {
+			offsets[i] = offset;
+			offset += adapter->getItemExtent(i);
+		}
+		offsets[count] = offset;
+	}
+
+	void VirtualListBox::notifyDataChanged() {
+		releaseAll();
+		readExtents();
+		int count = offsets.size() - 1;
+		if(selectedIndex >= count)
+			selectedIndex = count - 1;
+		else if(selectedIndex < 0 && count > 0)
+			selectedIndex = 0;
+		clampScrollOffset();
+		layout();
+	}
+
+	void VirtualListBox::notifyItemChanged(int index) {
+		int count = offsets.size() - 1;
+		if(index < 0 || index >= count) {
+			maPanic(0, "VirtualListBox::notifyItemChanged, index out of bounds");
+		}
+		int delta = adapter->getItemExtent(index) - (offsets[index + 1] - offsets[index]);
+		if(delta != 0) {
+			for(int i = index + 1; i <= count; i++)
+				offsets[i] += delta;
+			clampScrollOffset();
+		}
+
+		int i = index - firstIndex;
+		if(i >= 0 && i < children.size()) {
+			int type = adapter->getItemType(index);
+			Widget* old = children[i];
+			Widget* w = adapter->getItemWidget(index, type == childTypes[i] ? old : NULL);
+			if(w != old) {
+				if(type == childTypes[i]) {
+					old->setParent(NULL);
+					delete old;
+				} else {
+					release(old, childTypes[i]);
+				}
+				w->setParent(this);
+				children[i] = w;
+				childTypes[i] = type;
+			}
+			if(w->isSelected() != (index == selectedIndex))
+				w->setSelected(index == selectedIndex);
+		}
+		layout();
+	}
+
+	void VirtualListBox::add(Widget *w) {
+		maPanic(0, "VirtualListBox::add, items must come from the adapter");
+	}
+
+	int VirtualListBox::getViewportExtent() const {
+		return orientation == ListBox::LBO_VERTICAL ? paddedBounds.height : paddedBounds.width;
+	}
+
+	int VirtualListBox::getItemAtOffset(int offset) const {
+		int count = offsets.size() - 1;
+		if(offset < 0 || offset >= offsets[count])
+			return -1;
+		// the last item that starts at or before offset.
+		int low = 0, high = count - 1;
+		while(low < high) {
+			int mid = (low + high + 1) >> 1;
+			if(offsets[mid] <= offset)
+				low = mid;
+			else
+				high = mid - 1;
+		}
+		return low;
+	}
+
+	void VirtualListBox::release(Widget* widget, int type) {
+		widget->setParent(NULL);
+		Released r = { widget, type };
+		released.add(r);
+	}
+
+	void VirtualListBox::releaseAll() {
+		for(int i = 0; i < children.size(); i++)
+			release(children[i], childTypes[i]);
+		children.clear();
+		childTypes.clear();
+		firstIndex = 0;
+	}
+
+	Widget* VirtualListBox::bind(int index, int type) {
+		Widget* recycled = NULL;
+		for(int i = released.size() - 1; i >= 0; i--) {
+			if(released[i].type == type) {
+				recycled = released[i].widget;
+				released.remove(i);
+				break;
+			}
+		}
+		Widget* w = adapter->getItemWidget(index, recycled);
+		if(w != recycled)
+			delete recycled;
+		w->setParent(this);
+		if(w->isSelected() != (index == selectedIndex))
+			w->setSelected(index == selectedIndex);
+		return w;
+	}
+
+	void VirtualListBox::layout() {
+		int count = offsets.size() - 1;
+		int viewport = getViewportExtent();
+
+		// the range of items that should have widgets, inclusive.
+		int first = 0, last = -1;
+		if(count > 0 && viewport > 0) {
+			first = getItemAtOffset(scrollOffset);
+			last = getItemAtOffset(scrollOffset + viewport - 1);
+			if(last < 0)
+				last = count - 1;
+			if((first -= margin) < 0)
+				first = 0;
+			if((last += margin) > count - 1)
+				last = count - 1;
+		}
+
+		// keep the widgets still in range, release the others.
+		int oldFirst = firstIndex;
+		int oldCount = children.size();
+		for(int i = 0; i < oldCount; i++) {
+			int index = oldFirst + i;
+			if(index < first || index > last)
+				release(children[i], childTypes[i]);
+		}
+
+		// the scratch vectors keep their capacity, so scrolling doesn't allocate.
+		scratchWidgets.clear();
+		scratchTypes.clear();
+		for(int index = first; index <= last; index++) {
+			int i = index - oldFirst;
+			if(i >= 0 && i < oldCount) {
+				scratchWidgets.add(children[i]);
+				scratchTypes.add(childTypes[i]);
+			} else {
+				int type = adapter->getItemType(index);
+				scratchWidgets.add(bind(index, type));
+				scratchTypes.add(type);
+			}
+		}
+		children.clear();
+		children.add(scratchWidgets.pointer(), scratchWidgets.size());
+		childTypes.clear();
+		childTypes.add(scratchTypes.pointer(), scratchTypes.size());
+		firstIndex = first;
+
+		for(int i = 0; i < children.size(); i++) {
+			Widget* w = children[i];
+			int index = first + i;
+			int start = offsets[index] - scrollOffset;
+			int extent = offsets[index + 1] - offsets[index];
+			if(orientation == ListBox::LBO_VERTICAL) {
+				if(w->getWidth() != paddedBounds.width)
+					w->setWidth(paddedBounds.width);
+				if(w->getHeight() != extent)
+					w->setHeight(extent);
+				w->setPosition(0, start);
+			} else {
+				if(w->getHeight() != paddedBounds.height)
+					w->setHeight(paddedBounds.height);
+				if(w->getWidth() != extent)
+					w->setWidth(extent);
+				w->setPosition(start, 0);
+			}
+		}
+		requestRepaint();
+	}
+
+	void VirtualListBox::draw(bool forceDraw) {
+		// children are positioned relative to the scroll offset,
+		// and only the ones in view exist, so the default drawing will do.
+		Widget::draw(forceDraw);
+	}
+
+	void VirtualListBox::drawWidget() {
+	}
+
+	void VirtualListBox::setOrientation(ListBox::ListBoxOrientation orientation) {
+		this->orientation = orientation;
+		clampScrollOffset();
+		layout();
+	}
+
+	ListBox::ListBoxOrientation VirtualListBox::getOrientation() const {
+		return orientation;
+	}
+
+	void VirtualListBox::setMargin(int items) {
+		margin = items;
+		layout();
+	}
+
+	void VirtualListBox::clampScrollOffset() {
+		int max = offsets[offsets.size() - 1] - getViewportExtent();
+		if(scrollOffset > max)
+			scrollOffset = max;
+		if(scrollOffset < 0)
+			scrollOffset = 0;
+	}
+
+	void VirtualListBox::setScrollOffset(int offset) {
+		int old = scrollOffset;
+		scrollOffset = offset;
+		clampScrollOffset();
+		if(scrollOffset != old)
+			layout();
+	}
+
+	int VirtualListBox::getScrollOffset() const {
+		return scrollOffset;
+	}
+
+	int VirtualListBox::getContentExtent() const {
+		return offsets[offsets.size() - 1];
+	}
+
+	void VirtualListBox::scrollToItem(int index) {
+		int viewport = getViewportExtent();
+		if(offsets[index] < scrollOffset)
+			setScrollOffset(offsets[index]);
+		else if(offsets[index + 1] > scrollOffset + viewport)
+			setScrollOffset(offsets[index + 1] - viewport);
+	}
+
+	Widget* VirtualListBox::getItemWidget(int index) {
+		int i = index - firstIndex;
+		if(i >= 0 && i < children.size())
+			return children[i];
+		return NULL;
+	}
+
+	void VirtualListBox::setSelectedIndex(int index, bool shouldFireListeners) {
+		if(index < 0 || index >= offsets.size() - 1) {
+			maPanic(0, "VirtualListBox::setSelectedIndex, index out of bounds");
+		}
+		int unselectedIndex = selectedIndex;
+		if(index != unselectedIndex) {
+			Widget* w = getItemWidget(unselectedIndex);
+			if(w)
+				w->setSelected(false);
+			selectedIndex = index;
+			w = getItemWidget(index);
+			if(w)
+				w->setSelected(true);
+		}
+		scrollToItem(index);
+		if(shouldFireListeners)
+			fireItemSelected(index, unselectedIndex);
+		requestRepaint();
+	}
+
+	int VirtualListBox::getSelectedIndex() const {
+		return selectedIndex;
+	}
+
+	void VirtualListBox::selectNextItem(bool shouldFireListeners) {
+		int count = offsets.size() - 1;
+		if(count == 0)
+			return;
+		if(selectedIndex < count - 1) {
+			setSelectedIndex(selectedIndex + 1, shouldFireListeners);
+		} else if(wrapping) {
+			setSelectedIndex(0, shouldFireListeners);
+		} else if(shouldFireListeners) {
+			Vector_each(VirtualListBoxListener*, i, listeners) {
+				(*i)->blocked(this, 1);
+			}
+		}
+	}
+
+	void VirtualListBox::selectPreviousItem(bool shouldFireListeners) {
+		int count = offsets.size() - 1;
+		if(count == 0)
+			return;
+		if(selectedIndex > 0) {
+			setSelectedIndex(selectedIndex - 1, shouldFireListeners);
+		} else if(wrapping) {
+			setSelectedIndex(count - 1, shouldFireListeners);
+		} else if(shouldFireListeners) {
+			Vector_each(VirtualListBoxListener*, i, listeners) {
+				(*i)->blocked(this, -1);
+			}
+		}
+	}
+
+	void VirtualListBox::setWrapping(bool wrapping) {
+		this->wrapping = wrapping;
+	}
+
+	bool VirtualListBox::isWrapping() const {
+		return wrapping;
+	}
+
+	void VirtualListBox::addVirtualListBoxListener(VirtualListBoxListener* listener) {
+		listeners.add(listener);
+	}
+
+	void VirtualListBox::fireItemSelected(int selectedIndex, int unselectedIndex) {
+		Vector_each(VirtualListBoxListener*, i, listeners) {
+			(*i)->itemSelected(this, selectedIndex, unselectedIndex);
+		}
+	}
+
+	void VirtualListBox::setWidth(int w) {
+		Widget::setWidth(w);
+		clampScrollOffset();
+		layout();
+	}
+
+	void VirtualListBox::setHeight(int h) {
+		Widget::setHeight(h);
+		clampScrollOffset();
+		layout();
+	}
+}
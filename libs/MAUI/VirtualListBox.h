@@ -0,0 +1,234 @@
+/* Copyright 2013 David Axmark
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+	http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+/**
+* \file VirtualListBox.h
+* \brief List box that only has widgets for the visible items.
+*/
+
+#ifndef _SE_MSAB_MAUI_VIRTUALLISTBOX_H_
+#define _SE_MSAB_MAUI_VIRTUALLISTBOX_H_
+
+#include "Widget.h"
+#include "ListBox.h"
+
+namespace MAUI {
+
+	class VirtualListBox;
+
+	/** \brief Provides the items of a VirtualListBox.
+	  *
+	  * The VirtualListBox asks for widgets only for the items that are visible,
+	  * and hands back widgets that have scrolled out of view, so that they can
+	  * be reused for other items.
+	  **/
+	class ListBoxAdapter {
+	public:
+		virtual ~ListBoxAdapter() {}
+
+		/** Returns the number of items. **/
+		virtual int getItemCount() = 0;
+
+		/** Returns the size of item \a index along the list: its height if the list
+		  * is vertical, its width if it's horizontal.
+		  **/
+		virtual int getItemExtent(int index) = 0;
+
+		/** Returns the type of item \a index. Widgets are only reused for items
+		  * of the same type. The default implementation returns 0 for all items.
+		  **/
+		virtual int getItemType(int index) { return 0; }
+
+		/** Returns a widget that shows item \a index.
+		  * \param index The item.
+		  * \param recycled A widget returned earlier for an item of the same type,
+		  * which is no longer in use, or NULL. The adapter should update it to show
+		  * item \a index and return it. If another widget is returned instead,
+		  * \a recycled is deleted.
+		  * The VirtualListBox sets the position and size of the returned widget,
+		  * and owns it.
+		  **/
+		virtual Widget* getItemWidget(int index, Widget* recycled) = 0;
+	};
+
+	/** \brief Listener interface that receives notifications when an item in a VirtualListBox is selected.
+	  **/
+	class VirtualListBoxListener {
+	public:
+		/** This function is called whenever the selected item changes.
+		  * \a unselectedIndex is -1 if no item was selected before.
+		  **/
+		virtual void itemSelected(VirtualListBox* sender, int selectedIndex, int unselectedIndex) = 0;
+
+		/** This function is called whenever the selection is blocked, due to bounds. 'direction' is -1 when selectPreviousItem was called and 1 when selectedNextItem was called. */
+		virtual void blocked(VirtualListBox* sender, int direction) = 0;
+	};
+
+	/** \brief List box for long lists, with widgets only for the visible items.
+	  *
+	  * A ListBox keeps a widget for every item, and positions and draws all of them.
+	  * A VirtualListBox gets its items from a ListBoxAdapter, and only has widgets
+	  * for the items that are visible, plus a margin of a few items on either side.
+	  * When the list scrolls, the widgets of items that leave the view are given
+	  * back to the adapter for items that come into view. Memory use and the time
+	  * to draw a frame depend on the size of the list box, not on the number of items.
+	  *
+	  * Items may have different sizes along the list. Their offsets are kept in
+	  * a table, so that the items at a scroll offset are found by binary search.
+	  * Across the list, items get the size of the padded list box.
+	  *
+	  * Scrolling is immediate; there is no animation.
+	  * The widget draws its background by default, use setDrawBackground(false) to disable it.
+	  **/
+	class VirtualListBox : public Widget {
+	public:
+		/** Constructor.
+		  * \param x the horizontal position of the VirtualListBox relative to its parent's top left padded corner.
+		  * \param y the vertical position of the VirtualListBox relative to its parent's top left padded corner
+		  * \param width the width of the VirtualListBox.
+		  * \param height the height of the VirtualListBox.
+		  * \param parent pointer to the parent widget. Passing anything else than NULL causes the VirtualListBox to be added to the parent's children.
+		  * \param orientation controls the orientation of the VirtualListBox.
+		  **/
+		VirtualListBox(int x, int y, int width, int height, Widget *parent,
+			ListBox::ListBoxOrientation orientation=ListBox::LBO_VERTICAL);
+
+		/** Destructor. Deletes the item widgets, but not the adapter. **/
+		virtual ~VirtualListBox();
+
+		/** Sets the adapter that provides the items, or NULL for an empty list.
+		  * The VirtualListBox does not take ownership of the adapter.
+		  * The widgets of the old adapter are deleted.
+		  **/
+		void setAdapter(ListBoxAdapter* adapter);
+		ListBoxAdapter* getAdapter() const;
+
+		/** Call this when items have been added, removed or changed.
+		  * Reads the number of items and their extents from the adapter,
+		  * and asks it again for the widgets of the visible items.
+		  **/
+		void notifyDataChanged();
+
+		/** Call this when a single item has changed, but the number of items has not.
+		  * Reads its extent again and, if it is visible, asks the adapter to update its widget.
+		  **/
+		void notifyItemChanged(int index);
+
+		/** Items from the adapter cannot be mixed with widgets added directly.
+		  * This function panics.
+		  **/
+		void add(Widget *w);
+
+		/** Renders the list box **/
+		void draw(bool forceDraw=false);
+
+		/** Sets the orientation of the VirtualListBox **/
+		void setOrientation(ListBox::ListBoxOrientation orientation);
+		ListBox::ListBoxOrientation getOrientation() const;
+
+		/** Sets the number of items outside the visible area, on each side,
+		  * that also have widgets. The default is 2.
+		  **/
+		void setMargin(int items);
+
+		/** Scrolls the list so that the item at \a offset pixels from the start of the list is at the top (or left) edge.
+		  * The offset is clamped so that the list doesn't scroll past its end.
+		  **/
+		void setScrollOffset(int offset);
+		/** Returns the list box's current scroll offset in pixels. */
+		int getScrollOffset() const;
+		/** Returns the total size of the items along the list, in pixels. */
+		int getContentExtent() const;
+
+		/** Scrolls the list as little as possible to make item \a index fully visible. **/
+		void scrollToItem(int index);
+
+		/** Returns the index of the item at \a offset pixels from the start of the list,
+		  * or -1 if there is none.
+		  **/
+		int getItemAtOffset(int offset) const;
+
+		/** Returns the widget that currently shows item \a index, or NULL if the item has none. **/
+		Widget* getItemWidget(int index);
+
+		/** Navigates to the next item in the list box - down if the orientation is vertical, right if it's horizontal. **/
+		void selectNextItem(bool shouldFireListeners=true);
+		/** Navigates to the previous item in the list box - up if the orientation is vertical, left if it's horizontal. **/
+		void selectPreviousItem(bool shouldFireListeners=true);
+		/** Selects item \a index, and scrolls to make it visible. **/
+		void setSelectedIndex(int index, bool shouldFireListeners=true);
+		/** Returns the index of the selected item, or -1 if the list is empty. **/
+		int getSelectedIndex() const;
+		/** Controls the wrapping behavior of the VirtualListBox. When set to true (default), the list box will wrap around to selecting the first item when moving beyond the last one, and the other way around. **/
+		void setWrapping(bool wrapping=true);
+		bool isWrapping() const;
+		/** Adds a item selection listener **/
+		void addVirtualListBoxListener(VirtualListBoxListener* listener);
+
+		/** Overloaded setWidth. Item widgets get the new padded width if the list is vertical. **/
+		void setWidth(int w);
+		/** Overloaded setHeight. Item widgets get the new padded height if the list is horizontal. **/
+		void setHeight(int h);
+
+	protected:
+		void drawWidget();
+
+		/** Binds widgets to the items in view and positions them. **/
+		void layout();
+		/** Returns the size of the padded list box along the list. **/
+		int getViewportExtent() const;
+		/** Returns a widget for \a index, reusing one of the released widgets if possible. **/
+		Widget* bind(int index, int type);
+		/** Puts a widget that is no longer in view aside for reuse. **/
+		void release(Widget* widget, int type);
+		/** Releases all the item widgets. **/
+		void releaseAll();
+		/** Re-reads the item extents from the adapter. **/
+		void readExtents();
+		/** Clamps the scroll offset to the content. **/
+		void clampScrollOffset();
+		void fireItemSelected(int selectedIndex, int unselectedIndex);
+
+		ListBoxAdapter* adapter;
+		ListBox::ListBoxOrientation orientation;
+
+		/// offsets[i] is the start of item i; the last element is the total extent.
+		Vector<int> offsets;
+		int scrollOffset;
+		int margin;
+		int selectedIndex;
+		bool wrapping;
+
+		/// The index of the item shown by children[0].
+		int firstIndex;
+		/// The item type of each child.
+		Vector<int> childTypes;
+
+		/** \brief A widget that can be reused. **/
+		struct Released {
+			Widget* widget;
+			int type;
+		};
+		Vector<Released> released;
+
+		/// Used by layout().
+		Vector<Widget*> scratchWidgets;
+		Vector<int> scratchTypes;
+
+		Vector<VirtualListBoxListener*> listeners;
+	};
+}
+
+#endif /* _SE_MSAB_MAUI_VIRTUALLISTBOX_H_ */
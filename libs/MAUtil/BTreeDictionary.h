@@ -0,0 +1,340 @@
+/* Copyright 2013 David Axmark
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+	http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+/** \file BTreeDictionary.h
+* \brief Template sorted dictionary stored in a B+ tree.
+*/
+
+#ifndef _SE_MSAB_MAUTIL_BTREEDICTIONARY_H_
+#define _SE_MSAB_MAUTIL_BTREEDICTIONARY_H_
+
+#ifndef __WINDOWS_PHONE_8_LIB__
+#include <ma.h>
+#include <maassert.h>
+#else
+#include "../MAStd/ma.h"
+#include "../MAStd/maassert.h"
+#endif
+
+#include "collection_common.h"
+#include "Vector.h"
+
+namespace MAUtil {
+
+//******************************************************************************
+// BTreeDictionary
+//******************************************************************************
+
+/** \brief Template sorted dictionary stored in a B+ tree.
+*
+* The BTreeDictionary stores unique values sorted by key, like Dictionary,
+* and has the same Iterator and Pair based interface. The elements are
+* stored by value in wide leaves of about 512 bytes, which are linked
+* together for iteration. Lookups compare keys with an inlined \a Less
+* functor instead of calling a compare function through a pointer, and
+* touch a few nodes instead of one node per level of a binary tree.
+* Nodes are allocated in chunks and reused from a free list.
+*
+* Inserting in ascending order, such as when copying another dictionary,
+* fills the leaves completely.
+*
+* This class is not meant to be instantiated directly.
+* It is the base class for BTreeSet and BTreeMap.
+*
+* \note Unlike Dictionary, insert() and erase() move elements between
+* nodes, so they invalidate all Iterators and pointers to elements.
+* erase(Iterator) and insert() do return valid Iterators.
+*
+* \note \a Key must be default-constructible and assignable, and \a Storage
+* copy-constructible. The elements are constructed in place in the leaves,
+* and only the used slots hold one.
+*
+* \param Key The key type.
+* \param Storage The element type, as stored and seen through an Iterator.
+* \param Slot The element type as inserted, \a Storage without const.
+* \param KeyOf Has static functions "const Key& get(const Slot&)" and
+* "const Key& get(const Storage&)" that return the key of an element.
+* \param Less A functor that returns true if its first argument is
+* ordered before its second.
+*/
+template<class Key, class Storage, class Slot, class KeyOf, class Less>
+class BTreeDictionary {
+protected:
+	enum {
+		/// Maximum number of elements in a leaf.
+		LEAF_SLOTS = (512 / sizeof(Slot)) > 8 ? (512 / sizeof(Slot)) : 8,
+		/// Maximum number of keys in an inner node, which has one more child.
+		INNER_SLOTS = (512 / (sizeof(Key) + sizeof(void*))) > 8 ?
+			(512 / (sizeof(Key) + sizeof(void*))) : 8,
+		/// Nodes other than the root are rebalanced when they have fewer elements or keys.
+		LEAF_MIN = LEAF_SLOTS / 2,
+		INNER_MIN = INNER_SLOTS / 2
+	};
+
+	/** \brief Internal storage. */
+	struct Node {
+		int count;
+	};
+
+	/** \brief An element, constructed in place in a Leaf. */
+	struct Element {
+		Storage value;
+		template<class S> Element(const S& s) : value(s) {}
+		static void* operator new(size_t, void* p) { return p; }
+		static void operator delete(void*, void*) {}
+	};
+
+	/** \brief A node on the bottom level. Holds the elements.
+	* Only the first \a count slots are constructed.
+	*/
+	struct Leaf : Node {
+		Leaf* next;
+		Leaf* prev;
+		union {
+			char bytes[LEAF_SLOTS * sizeof(Element)];
+			double alignDouble;
+			long long alignLong;
+			void* alignPointer;
+		} memory;
+
+		Element* elements() { return (Element*)(void*)memory.bytes; }
+		Storage& slot(int i) { return elements()[i].value; }
+		const Storage& slot(int i) const { return ((const Element*)(const void*)memory.bytes)[i].value; }
+	};
+
+	/** \brief A node above the leaves.
+	* Every key in children[i] is less than keys[i],
+	* which is not greater than any key in children[i + 1].
+	*/
+	struct Inner : Node {
+		Key keys[INNER_SLOTS];
+		Node* children[INNER_SLOTS + 1];
+	};
+
+	/** \brief Allocates nodes in chunks and keeps the released ones for reuse.
+	* Released nodes must be empty, and inner nodes must have default-constructed keys.
+	*/
+	template<class T> class NodePool {
+	public:
+		NodePool();
+		~NodePool();
+		T* alloc();
+		void release(T*);
+		/// Deletes all nodes.
+		void clear();
+	protected:
+		Vector<T*> mChunks;
+		Vector<T*> mFree;
+		int mNextChunkSize;
+	};
+
+public:
+	class ConstIterator;
+
+	/** \brief Iterator for a BTreeDictionary.
+	*
+	* Works like Dictionary::Iterator, but is invalidated
+	* when the BTreeDictionary is modified.
+	*/
+	class Iterator {
+	public:
+		Storage& operator*();
+		Storage* operator->();
+
+		/**
+		* Causes the Iterator to point to the next element in the BTreeDictionary to which it is bound.
+		* If the Iterator points to BTreeDictionary::end(), this operation will cause a crash.
+		*/
+		Iterator& operator++();
+		Iterator operator++(int);
+
+		/**
+		* Causes the Iterator to point to the previous element in the BTreeDictionary to which it is bound.
+		* \note If the iterator points to the first element,
+		* this operation will cause it to point to BTreeDictionary::end().
+		*/
+		Iterator& operator--();
+		Iterator operator--(int);
+
+		bool operator==(const Iterator&) const;
+		bool operator!=(const Iterator&) const;
+
+		Iterator& operator=(const Iterator&);
+		Iterator(const Iterator&);
+	protected:
+		Leaf* mLeaf;
+		int mIndex;
+		const BTreeDictionary* mTree;
+		Iterator(const BTreeDictionary*, Leaf*, int);
+		friend class BTreeDictionary;
+		friend class ConstIterator;
+	};
+
+	/** \brief Const Iterator for a BTreeDictionary.
+	*
+	* A ConstIterator is just like an ordinary Iterator, except
+	* all its methods and return values are const.
+	*/
+	class ConstIterator {
+	public:
+		const Storage& operator*() const;
+		const Storage* operator->() const;
+
+		ConstIterator& operator++();
+		ConstIterator operator++(int);
+		ConstIterator& operator--();
+		ConstIterator operator--(int);
+
+		bool operator==(const ConstIterator&) const;
+		bool operator!=(const ConstIterator&) const;
+
+		ConstIterator& operator=(const ConstIterator&);
+		ConstIterator(const ConstIterator&);
+		ConstIterator(const Iterator&);
+	protected:
+		const Leaf* mLeaf;
+		int mIndex;
+		const BTreeDictionary* mTree;
+		ConstIterator(const BTreeDictionary*, const Leaf*, int);
+		friend class BTreeDictionary;
+	};
+
+	//constructors
+	/// Constructs a copy of another BTreeDictionary. All elements are also copied.
+	BTreeDictionary(const BTreeDictionary&);
+	/// Clears this BTreeDictionary, then copies the other BTreeDictionary to this one.
+	BTreeDictionary& operator=(const BTreeDictionary&);
+	/// The destructor deletes all elements.
+	~BTreeDictionary();
+
+	//methods
+	/**
+	* Searches the BTreeDictionary for a specified Key. The returned Iterator points to
+	* the element matching the Key if one was found, or to BTreeDictionary::end() if not.
+	*/
+	Iterator find(const Key&);
+	ConstIterator find(const Key&) const;
+	/**
+	* Returns an Iterator pointing to the first element whose Key is not less than
+	* the specified Key, or to BTreeDictionary::end() if there is none.
+	*/
+	Iterator lowerBound(const Key&);
+	ConstIterator lowerBound(const Key&) const;
+	/**
+	* Returns an Iterator pointing to the first element whose Key is greater than
+	* the specified Key, or to BTreeDictionary::end() if there is none.
+	*/
+	Iterator upperBound(const Key&);
+	ConstIterator upperBound(const Key&) const;
+	/**
+	* Deletes an element, matching the specified Key, from the BTreeDictionary.
+	* Returns true if an element was erased, or false if there was no element matching the Key.
+	*/
+	bool erase(const Key&);
+	/**
+	* Deletes an element, pointed to by the specified Iterator.
+	* Returns an Iterator pointing to the element that followed the erased one.
+	* \warning If the Iterator is bound to a different BTreeDictionary, or if it
+	* points to end(), the system will crash.
+	*/
+	Iterator erase(Iterator);
+	/**
+	* Returns an Iterator pointing to the first element in the BTreeDictionary.
+	*/
+	Iterator begin();
+	ConstIterator begin() const;
+	/**
+	* Returns an Iterator pointing to a place beyond the last element of the BTreeDictionary.
+	* This Iterator is often used to determine when another Iterator has reached its end.
+	*/
+	Iterator end();
+	ConstIterator end() const;
+	/**
+	* Returns the number of elements in the BTreeDictionary.
+	*/
+	size_t size() const;
+	/**
+	* Deletes all elements and frees all nodes.
+	*/
+	void clear();
+
+protected:
+	Node* mRoot;
+	/// Number of levels of inner nodes above the leaves.
+	int mHeight;
+	Leaf* mFirst;
+	Leaf* mLast;
+	size_t mSize;
+	Less mLess;
+	NodePool<Leaf> mLeafPool;
+	NodePool<Inner> mInnerPool;
+
+	/// Constructs an empty BTreeDictionary.
+	BTreeDictionary(const Less& less = Less());
+
+	/**
+	* Inserts a new value into the BTreeDictionary.
+	*
+	* Returns a Pair. The Pair's second element is true if the value was indeed inserted.
+	* The Pair's first element is an Iterator that points to the element in the BTreeDictionary.
+	*
+	* An element which compares equal to the new one may already be present in the BTreeDictionary;
+	* in that case, this operation does nothing, and the Iterator returned will point to
+	* the old element.
+	*/
+	Pair<Iterator, bool> insert(const Slot&);
+
+	/// Returns the index of the first key in \a keys that is not less than \a key.
+	int lowerIndex(const Key* keys, int count, const Key& key) const;
+	/// Returns the index of the first key in \a keys that is greater than \a key.
+	int upperIndex(const Key* keys, int count, const Key& key) const;
+	/// Returns the index of the first element in \a leaf whose key is not less than \a key.
+	int lowerSlot(const Leaf* leaf, const Key& key) const;
+	/// Returns the index of the first element in \a leaf whose key is greater than \a key.
+	int upperSlot(const Leaf* leaf, const Key& key) const;
+	/// Returns the leaf that would contain \a key.
+	Leaf* findLeaf(const Key& key) const;
+
+	/// Constructs element \a i of \a leaf, which must not hold one.
+	static void constructSlot(Leaf* leaf, int i, const Slot& s);
+	/// Moves element \a si of \a src to the empty slot \a di of \a dst.
+	static void moveSlot(Leaf* dst, int di, Leaf* src, int si);
+	/// Destroys element \a i of \a leaf.
+	static void destroySlot(Leaf* leaf, int i);
+
+	/**
+	* Inserts \a s into the subtree \a node at \a level.
+	* If the node is split, the new right node and its separator key are
+	* returned in \a splitNode and \a splitKey.
+	* \param rightmost True if \a node is the last one on its level.
+	* It is then split unevenly when appending, to fill the nodes.
+	*/
+	void insertIn(Node* node, int level, bool rightmost, const Slot& s,
+		Pair<Iterator, bool>& result, Node*& splitNode, Key& splitKey);
+
+	/// Erases \a key from the subtree \a node at \a level.
+	bool eraseIn(Node* node, int level, const Key& key);
+	/// Rebalances child \a index of \a parent after an erase left it with too few elements or keys.
+	void fixLeaf(Inner* parent, int index);
+	void fixInner(Inner* parent, int index);
+	/// Removes key \a index and child \a index + 1 from \a parent.
+	void removeKey(Inner* parent, int index);
+};
+
+}	//MAUtil
+
+#include "BTreeDictionary_impl.h"
+
+#endif	//_SE_MSAB_MAUTIL_BTREEDICTIONARY_H_
@@ -0,0 +1,735 @@
+/* Copyright 2013 David Axmark
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+	http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+/** \file BTreeDictionary_impl.h
+* \brief BTreeDictionary implementation
+*/
+
+#ifndef _SE_MSAB_MAUTIL_BTREEDICTIONARY_H_
+#error Do not include this file directly.
+#endif
+
+#define BTD_TEMPLATE template<class Key, class Storage, class Slot, class KeyOf, class Less>
+#define BTD MAUtil::BTreeDictionary<Key, Storage, Slot, KeyOf, Less>
+
+//******************************************************************************
+// NodePool
+//******************************************************************************
+
+BTD_TEMPLATE template<class T>
+BTD::NodePool<T>::NodePool() : mNextChunkSize(4) {}
+
+BTD_TEMPLATE template<class T>
+BTD::NodePool<T>::~NodePool() {
+	clear();
+}
+
+BTD_TEMPLATE template<class T>
+T* BTD::NodePool<T>::alloc() {
+	if(mFree.size() == 0) {
+		T* chunk = new T[mNextChunkSize];
+		mChunks.add(chunk);
+		for(int i = mNextChunkSize - 1; i >= 0; i--)
+			mFree.add(chunk + i);
+		if(mNextChunkSize < 64)
+			mNextChunkSize *= 2;
+	}
+	T* node = mFree[mFree.size() - 1];
+	mFree.resize(mFree.size() - 1);
+	node->count = 0;
+	return node;
+}
+
+BTD_TEMPLATE template<class T>
+void BTD::NodePool<T>::release(T* node) {
+	MAASSERT(node->count == 0);
+	mFree.add(node);
+}
+
+BTD_TEMPLATE template<class T>
+void BTD::NodePool<T>::clear() {
+	for(int i = 0; i < mChunks.size(); i++)
+		delete[] mChunks[i];
+	mChunks.clear();
+	mFree.clear();
+	mNextChunkSize = 4;
+}
+
+//******************************************************************************
+// BTreeDictionary
+//******************************************************************************
+
+BTD_TEMPLATE
+BTD::BTreeDictionary(const Less& less)
+: mRoot(NULL), mHeight(0), mFirst(NULL), mLast(NULL), mSize(0), mLess(less)
+{
+}
+
+BTD_TEMPLATE
+BTD::BTreeDictionary(const BTreeDictionary& o)
+: mRoot(NULL), mHeight(0), mFirst(NULL), mLast(NULL), mSize(0), mLess(o.mLess)
+{
+	operator=(o);
+}
+
+BTD_TEMPLATE
+BTD& BTD::operator=(const BTreeDictionary& o) {
+	if(this == &o)
+		return *this;
+	clear();
+	mLess = o.mLess;
+	// The elements come in order, so every insert appends to the last leaf.
+	for(ConstIterator itr = o.begin(); itr != o.end(); ++itr) {
+		insert(Slot(*itr));
+	}
+	return *this;
+}
+
+BTD_TEMPLATE
+BTD::~BTreeDictionary() {
+	clear();
+}
+
+BTD_TEMPLATE
+void BTD::clear() {
+	for(Leaf* leaf = mFirst; leaf != NULL; leaf = leaf->next) {
+		for(int i = 0; i < leaf->count; i++)
+			destroySlot(leaf, i);
+	}
+	mLeafPool.clear();
+	mInnerPool.clear();
+	mRoot = NULL;
+	mHeight = 0;
+	mFirst = mLast = NULL;
+	mSize = 0;
+}
+
+BTD_TEMPLATE
+size_t BTD::size() const {
+	return mSize;
+}
+
+BTD_TEMPLATE
+int BTD::lowerIndex(const Key* keys, int count, const Key& key) const {
+	int low = 0, high = count;
+	while(low < high) {
+		int mid = (low + high) >> 1;
+		if(mLess(keys[mid], key))
+			low = mid + 1;
+		else
+			high = mid;
+	}
+	return low;
+}
+
+BTD_TEMPLATE
+int BTD::upperIndex(const Key* keys, int count, const Key& key) const {
+	int low = 0, high = count;
+	while(low < high) {
+		int mid = (low + high) >> 1;
+		if(mLess(key, keys[mid]))
+			high = mid;
+		else
+			low = mid + 1;
+	}
+	return low;
+}
+
+BTD_TEMPLATE
+int BTD::lowerSlot(const Leaf* leaf, const Key& key) const {
+	int low = 0, high = leaf->count;
+	while(low < high) {
+		int mid = (low + high) >> 1;
+		if(mLess(KeyOf::get(leaf->slot(mid)), key))
+			low = mid + 1;
+		else
+			high = mid;
+	}
+	return low;
+}
+
+BTD_TEMPLATE
+int BTD::upperSlot(const Leaf* leaf, const Key& key) const {
+	int low = 0, high = leaf->count;
+	while(low < high) {
+		int mid = (low + high) >> 1;
+		if(mLess(key, KeyOf::get(leaf->slot(mid))))
+			high = mid;
+		else
+			low = mid + 1;
+	}
+	return low;
+}
+
+BTD_TEMPLATE
+typename BTD::Leaf* BTD::findLeaf(const Key& key) const {
+	Node* node = mRoot;
+	if(node == NULL)
+		return NULL;
+	for(int level = mHeight; level > 0; level--) {
+		Inner* inner = (Inner*)node;
+		node = inner->children[upperIndex(inner->keys, inner->count, key)];
+	}
+	return (Leaf*)node;
+}
+
+BTD_TEMPLATE
+void BTD::constructSlot(Leaf* leaf, int i, const Slot& s) {
+	new(leaf->elements() + i) Element(s);
+}
+
+BTD_TEMPLATE
+void BTD::moveSlot(Leaf* dst, int di, Leaf* src, int si) {
+	new(dst->elements() + di) Element(src->slot(si));
+	destroySlot(src, si);
+}
+
+BTD_TEMPLATE
+void BTD::destroySlot(Leaf* leaf, int i) {
+	leaf->elements()[i].~Element();
+}
+
+BTD_TEMPLATE
+typename BTD::Iterator BTD::find(const Key& key) {
+	Leaf* leaf = findLeaf(key);
+	if(leaf != NULL) {
+		int i = lowerSlot(leaf, key);
+		if(i < leaf->count && !mLess(key, KeyOf::get(leaf->slot(i))))
+			return Iterator(this, leaf, i);
+	}
+	return end();
+}
+
+BTD_TEMPLATE
+typename BTD::ConstIterator BTD::find(const Key& key) const {
+	return ((BTreeDictionary*)this)->find(key);
+}
+
+BTD_TEMPLATE
+typename BTD::Iterator BTD::lowerBound(const Key& key) {
+	Leaf* leaf = findLeaf(key);
+	if(leaf == NULL)
+		return end();
+	int i = lowerSlot(leaf, key);
+	if(i == leaf->count)
+		return Iterator(this, leaf->next, 0);
+	return Iterator(this, leaf, i);
+}
+
+BTD_TEMPLATE
+typename BTD::ConstIterator BTD::lowerBound(const Key& key) const {
+	return ((BTreeDictionary*)this)->lowerBound(key);
+}
+
+BTD_TEMPLATE
+typename BTD::Iterator BTD::upperBound(const Key& key) {
+	Leaf* leaf = findLeaf(key);
+	if(leaf == NULL)
+		return end();
+	int i = upperSlot(leaf, key);
+	if(i == leaf->count)
+		return Iterator(this, leaf->next, 0);
+	return Iterator(this, leaf, i);
+}
+
+BTD_TEMPLATE
+typename BTD::ConstIterator BTD::upperBound(const Key& key) const {
+	return ((BTreeDictionary*)this)->upperBound(key);
+}
+
+BTD_TEMPLATE
+MAUtil::Pair<typename BTD::Iterator, bool> BTD::insert(const Slot& s) {
+	Pair<Iterator, bool> result(end(), false);
+	if(mRoot == NULL) {
+		Leaf* leaf = mLeafPool.alloc();
+		leaf->next = leaf->prev = NULL;
+		mRoot = mFirst = mLast = leaf;
+		mHeight = 0;
+	}
+	Node* splitNode = NULL;
+	Key splitKey;
+	insertIn(mRoot, mHeight, true, s, result, splitNode, splitKey);
+	if(splitNode != NULL) {
+		Inner* root = mInnerPool.alloc();
+		root->count = 1;
+		root->keys[0] = splitKey;
+		root->children[0] = mRoot;
+		root->children[1] = splitNode;
+		mRoot = root;
+		mHeight++;
+	}
+	return result;
+}
+
+BTD_TEMPLATE
+void BTD::insertIn(Node* node, int level, bool rightmost, const Slot& s,
+	Pair<Iterator, bool>& result, Node*& splitNode, Key& splitKey)
+{
+	const Key& key = KeyOf::get(s);
+	if(level == 0) {
+		Leaf* leaf = (Leaf*)node;
+		int pos = lowerSlot(leaf, key);
+		if(pos < leaf->count && !mLess(key, KeyOf::get(leaf->slot(pos)))) {	//insert->dupe
+			result.first = Iterator(this, leaf, pos);
+			return;
+		}
+		result.second = true;
+		mSize++;
+		if(leaf->count < LEAF_SLOTS) {
+			for(int i = leaf->count; i > pos; i--)
+				moveSlot(leaf, i, leaf, i - 1);
+			constructSlot(leaf, pos, s);
+			leaf->count++;
+			result.first = Iterator(this, leaf, pos);
+			return;
+		}
+
+		// Split the LEAF_SLOTS + 1 elements, with s at pos, so that the first
+		// m stay. Appending to the last leaf leaves it full.
+		Leaf* right = mLeafPool.alloc();
+		int m = (rightmost && pos == LEAF_SLOTS) ? (int)LEAF_SLOTS : (LEAF_SLOTS + 1) / 2;
+		for(int i = m; i <= LEAF_SLOTS; i++) {
+			if(i == pos)
+				constructSlot(right, i - m, s);
+			else
+				moveSlot(right, i - m, leaf, i < pos ? i : i - 1);
+		}
+		right->count = LEAF_SLOTS + 1 - m;
+		if(pos < m) {
+			for(int i = m - 1; i > pos; i--)
+				moveSlot(leaf, i, leaf, i - 1);
+			constructSlot(leaf, pos, s);
+			result.first = Iterator(this, leaf, pos);
+		} else {
+			result.first = Iterator(this, right, pos - m);
+		}
+		leaf->count = m;
+
+		right->prev = leaf;
+		right->next = leaf->next;
+		if(leaf->next != NULL)
+			leaf->next->prev = right;
+		else
+			mLast = right;
+		leaf->next = right;
+
+		splitNode = right;
+		splitKey = KeyOf::get(right->slot(0));
+		return;
+	}
+
+	Inner* inner = (Inner*)node;
+	const int n = INNER_SLOTS;
+	int pos = upperIndex(inner->keys, inner->count, key);
+	Node* childNode = NULL;
+	Key childKey;
+	insertIn(inner->children[pos], level - 1, rightmost && pos == inner->count,
+		s, result, childNode, childKey);
+	if(childNode == NULL)
+		return;
+
+	// childKey goes to keys[pos] and childNode to children[pos + 1].
+	if(inner->count < n) {
+		for(int i = inner->count; i > pos; i--) {
+			inner->keys[i] = inner->keys[i - 1];
+			inner->children[i + 1] = inner->children[i];
+		}
+		inner->keys[pos] = childKey;
+		inner->children[pos + 1] = childNode;
+		inner->count++;
+		return;
+	}
+
+	// Split the n + 1 keys so that the first m stay and key m moves up.
+	// The new node needs at least one key, so appending leaves n - 1.
+	Inner* right = mInnerPool.alloc();
+	int m = (rightmost && pos == n) ? n - 1 : n / 2;
+	for(int i = m + 1; i <= n; i++) {
+		right->keys[i - m - 1] = i < pos ? inner->keys[i] :
+			i == pos ? childKey : inner->keys[i - 1];
+	}
+	for(int i = m + 1; i <= n + 1; i++) {
+		right->children[i - m - 1] = i <= pos ? inner->children[i] :
+			i == pos + 1 ? childNode : inner->children[i - 1];
+	}
+	right->count = n - m;
+	splitKey = m < pos ? inner->keys[m] : m == pos ? childKey : inner->keys[m - 1];
+	if(pos < m) {
+		for(int i = m - 1; i > pos; i--)
+			inner->keys[i] = inner->keys[i - 1];
+		inner->keys[pos] = childKey;
+		for(int i = m; i > pos + 1; i--)
+			inner->children[i] = inner->children[i - 1];
+		inner->children[pos + 1] = childNode;
+	}
+	for(int i = m; i < n; i++)
+		inner->keys[i] = Key();
+	inner->count = m;
+	splitNode = right;
+}
+
+BTD_TEMPLATE
+bool BTD::erase(const Key& key) {
+	if(mRoot == NULL || !eraseIn(mRoot, mHeight, key))
+		return false;
+	mSize--;
+	if(mRoot->count == 0) {
+		if(mHeight == 0) {
+			mLeafPool.release((Leaf*)mRoot);
+			mRoot = mFirst = mLast = NULL;
+		} else {
+			Inner* old = (Inner*)mRoot;
+			mRoot = old->children[0];
+			mHeight--;
+			mInnerPool.release(old);
+		}
+	}
+	return true;
+}
+
+BTD_TEMPLATE
+typename BTD::Iterator BTD::erase(Iterator itr) {
+	MAASSERT(itr.mLeaf != NULL);
+	Key key = KeyOf::get(itr.mLeaf->slot(itr.mIndex));
+	erase(key);
+	return lowerBound(key);
+}
+
+BTD_TEMPLATE
+bool BTD::eraseIn(Node* node, int level, const Key& key) {
+	if(level == 0) {
+		Leaf* leaf = (Leaf*)node;
+		int pos = lowerSlot(leaf, key);
+		if(pos == leaf->count || mLess(key, KeyOf::get(leaf->slot(pos))))
+			return false;
+		destroySlot(leaf, pos);
+		for(int i = pos + 1; i < leaf->count; i++)
+			moveSlot(leaf, i - 1, leaf, i);
+		leaf->count--;
+		return true;
+	}
+
+	Inner* inner = (Inner*)node;
+	int index = upperIndex(inner->keys, inner->count, key);
+	Node* child = inner->children[index];
+	if(!eraseIn(child, level - 1, key))
+		return false;
+	if(level == 1) {
+		if(child->count < LEAF_MIN)
+			fixLeaf(inner, index);
+	} else {
+		if(child->count < INNER_MIN)
+			fixInner(inner, index);
+	}
+	return true;
+}
+
+BTD_TEMPLATE
+void BTD::removeKey(Inner* parent, int index) {
+	for(int i = index + 1; i < parent->count; i++) {
+		parent->keys[i - 1] = parent->keys[i];
+		parent->children[i] = parent->children[i + 1];
+	}
+	parent->count--;
+	parent->keys[parent->count] = Key();
+}
+
+BTD_TEMPLATE
+void BTD::fixLeaf(Inner* parent, int index) {
+	Leaf* leaf = (Leaf*)parent->children[index];
+	Leaf* left = index > 0 ? (Leaf*)parent->children[index - 1] : NULL;
+	Leaf* right = index < parent->count ? (Leaf*)parent->children[index + 1] : NULL;
+
+	if(left != NULL && left->count > LEAF_MIN) {
+		for(int i = leaf->count; i > 0; i--)
+			moveSlot(leaf, i, leaf, i - 1);
+		left->count--;
+		moveSlot(leaf, 0, left, left->count);
+		leaf->count++;
+		parent->keys[index - 1] = KeyOf::get(leaf->slot(0));
+		return;
+	}
+	if(right != NULL && right->count > LEAF_MIN) {
+		moveSlot(leaf, leaf->count++, right, 0);
+		for(int i = 1; i < right->count; i++)
+			moveSlot(right, i - 1, right, i);
+		right->count--;
+		parent->keys[index] = KeyOf::get(right->slot(0));
+		return;
+	}
+
+	// Merge with a sibling. The one on the right goes away.
+	if(left != NULL) {
+		right = leaf;
+		leaf = left;
+		index--;
+	}
+	MAASSERT(right != NULL);
+	for(int i = 0; i < right->count; i++)
+		moveSlot(leaf, leaf->count++, right, i);
+	right->count = 0;
+	leaf->next = right->next;
+	if(right->next != NULL)
+		right->next->prev = leaf;
+	else
+		mLast = leaf;
+	mLeafPool.release(right);
+	removeKey(parent, index);
+}
+
+BTD_TEMPLATE
+void BTD::fixInner(Inner* parent, int index) {
+	Inner* node = (Inner*)parent->children[index];
+	Inner* left = index > 0 ? (Inner*)parent->children[index - 1] : NULL;
+	Inner* right = index < parent->count ? (Inner*)parent->children[index + 1] : NULL;
+
+	if(left != NULL && left->count > INNER_MIN) {
+		for(int i = node->count; i > 0; i--) {
+			node->keys[i] = node->keys[i - 1];
+			node->children[i + 1] = node->children[i];
+		}
+		node->children[1] = node->children[0];
+		node->keys[0] = parent->keys[index - 1];
+		node->children[0] = left->children[left->count];
+		node->count++;
+		left->count--;
+		parent->keys[index - 1] = left->keys[left->count];
+		left->keys[left->count] = Key();
+		return;
+	}
+	if(right != NULL && right->count > INNER_MIN) {
+		node->keys[node->count] = parent->keys[index];
+		node->children[node->count + 1] = right->children[0];
+		node->count++;
+		parent->keys[index] = right->keys[0];
+		right->children[0] = right->children[1];
+		for(int i = 1; i < right->count; i++) {
+			right->keys[i - 1] = right->keys[i];
+			right->children[i] = right->children[i + 1];
+		}
+		right->count--;
+		right->keys[right->count] = Key();
+		return;
+	}
+
+	// Merge with a sibling, pulling down the key between them.
+	if(left != NULL) {
+		right = node;
+		node = left;
+		index--;
+	}
+	MAASSERT(right != NULL);
+	node->keys[node->count] = parent->keys[index];
+	node->children[node->count + 1] = right->children[0];
+	node->count++;
+	for(int i = 0; i < right->count; i++) {
+		node->keys[node->count] = right->keys[i];
+		node->children[node->count + 1] = right->children[i + 1];
+		node->count++;
+		right->keys[i] = Key();
+	}
+	right->count = 0;
+	mInnerPool.release(right);
+	removeKey(parent, index);
+}
+
+BTD_TEMPLATE
+typename BTD::Iterator BTD::begin() {
+	return Iterator(this, mFirst, 0);
+}
+
+BTD_TEMPLATE
+typename BTD::ConstIterator BTD::begin() const {
+	return ConstIterator(this, mFirst, 0);
+}
+
+BTD_TEMPLATE
+typename BTD::Iterator BTD::end() {
+	return Iterator(this, NULL, 0);
+}
+
+BTD_TEMPLATE
+typename BTD::ConstIterator BTD::end() const {
+	return ConstIterator(this, NULL, 0);
+}
+
+//******************************************************************************
+// Iterator
+//******************************************************************************
+
+BTD_TEMPLATE
+BTD::Iterator::Iterator(const BTreeDictionary* tree, Leaf* leaf, int index) :
+mLeaf(leaf), mIndex(index), mTree(tree) {}
+
+BTD_TEMPLATE
+BTD::Iterator::Iterator(const Iterator& o) :
+mLeaf(o.mLeaf), mIndex(o.mIndex), mTree(o.mTree) {}
+
+BTD_TEMPLATE
+typename BTD::Iterator& BTD::Iterator::operator=(const Iterator& o) {
+	mLeaf = o.mLeaf;
+	mIndex = o.mIndex;
+	mTree = o.mTree;
+	return *this;
+}
+
+BTD_TEMPLATE
+Storage& BTD::Iterator::operator*() {
+	MAASSERT(mLeaf != NULL);
+	return mLeaf->slot(mIndex);
+}
+
+BTD_TEMPLATE
+Storage* BTD::Iterator::operator->() {
+	MAASSERT(mLeaf != NULL);
+	return &mLeaf->slot(mIndex);
+}
+
+BTD_TEMPLATE
+typename BTD::Iterator& BTD::Iterator::operator++() {
+	MAASSERT(mLeaf != NULL);
+	if(++mIndex == mLeaf->count) {
+		mLeaf = mLeaf->next;
+		mIndex = 0;
+	}
+	return *this;
+}
+
+BTD_TEMPLATE
+typename BTD::Iterator BTD::Iterator::operator++(int) {
+	Iterator old = *this;
+	++*this;
+	return old;
+}
+
+BTD_TEMPLATE
+typename BTD::Iterator& BTD::Iterator::operator--() {
+	if(mLeaf == NULL) {
+		mLeaf = mTree->mLast;
+		MAASSERT(mLeaf != NULL);
+		mIndex = mLeaf->count - 1;
+	} else if(mIndex > 0) {
+		mIndex--;
+	} else {
+		mLeaf = mLeaf->prev;
+		mIndex = mLeaf != NULL ? mLeaf->count - 1 : 0;
+	}
+	return *this;
+}
+
+BTD_TEMPLATE
+typename BTD::Iterator BTD::Iterator::operator--(int) {
+	Iterator old = *this;
+	--*this;
+	return old;
+}
+
+BTD_TEMPLATE
+bool BTD::Iterator::operator==(const Iterator& o) const {
+	return mLeaf == o.mLeaf && mIndex == o.mIndex;
+}
+
+BTD_TEMPLATE
+bool BTD::Iterator::operator!=(const Iterator& o) const {
+	return mLeaf != o.mLeaf || mIndex != o.mIndex;
+}
+
+//******************************************************************************
+// ConstIterator
+//******************************************************************************
+
+BTD_TEMPLATE
+BTD::ConstIterator::ConstIterator(const BTreeDictionary* tree, const Leaf* leaf, int index) :
+mLeaf(leaf), mIndex(index), mTree(tree) {}
+
+BTD_TEMPLATE
+BTD::ConstIterator::ConstIterator(const ConstIterator& o) :
+mLeaf(o.mLeaf), mIndex(o.mIndex), mTree(o.mTree) {}
+
+BTD_TEMPLATE
+BTD::ConstIterator::ConstIterator(const Iterator& o) :
+mLeaf(o.mLeaf), mIndex(o.mIndex), mTree(o.mTree) {}
+
+BTD_TEMPLATE
+typename BTD::ConstIterator& BTD::ConstIterator::operator=(const ConstIterator& o) {
+	mLeaf = o.mLeaf;
+	mIndex = o.mIndex;
+	mTree = o.mTree;
+	return *this;
+}
+
+BTD_TEMPLATE
+const Storage& BTD::ConstIterator::operator*() const {
+	MAASSERT(mLeaf != NULL);
+	return mLeaf->slot(mIndex);
+}
+
+BTD_TEMPLATE
+const Storage* BTD::ConstIterator::operator->() const {
+	MAASSERT(mLeaf != NULL);
+	return &mLeaf->slot(mIndex);
+}
+
+BTD_TEMPLATE
+typename BTD::ConstIterator& BTD::ConstIterator::operator++() {
+	MAASSERT(mLeaf != NULL);
+	if(++mIndex == mLeaf->count) {
+		mLeaf = mLeaf->next;
+		mIndex = 0;
+	}
+	return *this;
+}
+
+BTD_TEMPLATE
+typename BTD::ConstIterator BTD::ConstIterator::operator++(int) {
+	ConstIterator old = *this;
+	++*this;
+	return old;
+}
+
+BTD_TEMPLATE
+typename BTD::ConstIterator& BTD::ConstIterator::operator--() {
+	if(mLeaf == NULL) {
+		mLeaf = mTree->mLast;
+		MAASSERT(mLeaf != NULL);
+		mIndex = mLeaf->count - 1;
+	} else if(mIndex > 0) {
+		mIndex--;
+	} else {
+		mLeaf = mLeaf->prev;
+		mIndex = mLeaf != NULL ? mLeaf->count - 1 : 0;
+	}
+	return *this;
+}
+
+BTD_TEMPLATE
+typename BTD::ConstIterator BTD::ConstIterator::operator--(int) {
+	ConstIterator old = *this;
+	--*this;
+	return old;
+}
+
+BTD_TEMPLATE
+bool BTD::ConstIterator::operator==(const ConstIterator& o) const {
+	return mLeaf == o.mLeaf && mIndex == o.mIndex;
+}
+
+BTD_TEMPLATE
+bool BTD::ConstIterator::operator!=(const ConstIterator& o) const {
+	return mLeaf != o.mLeaf || mIndex != o.mIndex;
+}
+
+#undef BTD
+#undef BTD_TEMPLATE
@@ -0,0 +1,69 @@
+/* Copyright 2013 David Axmark
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+	http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+/** \file BTreeMap.h
+* \brief Template sorted Map stored in a B+ tree.
+*/
+
+#ifndef _SE_MSAB_MAUTIL_BTREEMAP_H_
+#define _SE_MSAB_MAUTIL_BTREEMAP_H_
+
+#include "BTreeDictionary.h"
+
+namespace MAUtil {
+
+/** \brief Returns the key of a BTreeMap element. */
+template<class Key, class Value> struct BTreeMapKey {
+	static const Key& get(const Pair<Key, Value>& p) { return p.first; }
+	static const Key& get(const Pair<const Key, Value>& p) { return p.first; }
+};
+
+/** \brief Template sorted Map stored in a B+ tree.
+*
+* A drop-in replacement for Map where elements are not referenced
+* across inserts and erases: it is smaller and faster, particularly
+* for iteration, but modifying it invalidates Iterators.
+* The order is given by the \a Less functor instead of a compare function.
+* \see BTreeDictionary
+*/
+template<class Key, class Value, class LessKey = Less<Key> >
+class BTreeMap : public BTreeDictionary<Key, Pair<const Key, Value>,
+	Pair<Key, Value>, BTreeMapKey<Key, Value>, LessKey>
+{
+public:
+	typedef Pair<const Key, Value> PairKV;
+	typedef Pair<Key, Value> MutableStorage;
+protected:
+	typedef BTreeDictionary<Key, PairKV, MutableStorage, BTreeMapKey<Key, Value>, LessKey> D;
+public:
+
+	BTreeMap(const LessKey& less = LessKey()) : D::BTreeDictionary(less) {}
+	Pair<typename D::Iterator, bool> insert(const Key& key, const Value& value) {
+		return D::insert(MutableStorage(key, value));
+	}
+	Pair<typename D::Iterator, bool> insert(const MutableStorage& pkv) {
+		return D::insert(pkv);
+	}
+	Value& operator[](const Key& key) {
+		typename D::Iterator itr = D::find(key);
+		if(itr == D::end())
+			itr = D::insert(MutableStorage(key, Value())).first;
+		return itr->second;
+	}
+};
+
+}
+
+#endif
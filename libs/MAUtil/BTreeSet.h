@@ -0,0 +1,52 @@
+/* Copyright 2013 David Axmark
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+	http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+/** \file BTreeSet.h
+* \brief Template sorted Set stored in a B+ tree.
+*/
+
+#ifndef _SE_MSAB_MAUTIL_BTREESET_H_
+#define _SE_MSAB_MAUTIL_BTREESET_H_
+
+#include "BTreeDictionary.h"
+
+namespace MAUtil {
+
+/** \brief Returns a BTreeSet element, which is its own key. */
+template<class Key> struct BTreeSetKey {
+	static const Key& get(const Key& k) { return k; }
+};
+
+/** \brief Template sorted Set stored in a B+ tree.
+*
+* A drop-in replacement for Set where elements are not referenced
+* across inserts and erases: it is smaller and faster, particularly
+* for iteration, but modifying it invalidates Iterators.
+* The order is given by the \a Less functor instead of a compare function.
+* \see BTreeDictionary
+*/
+template<class Key, class LessKey = Less<Key> >
+class BTreeSet : public BTreeDictionary<Key, const Key, Key, BTreeSetKey<Key>, LessKey> {
+public:
+	typedef BTreeDictionary<Key, const Key, Key, BTreeSetKey<Key>, LessKey> D;
+	typedef Key MutableStorage;
+
+	BTreeSet(const LessKey& less = LessKey()) : D::BTreeDictionary(less) {}
+	Pair<typename D::Iterator, bool> insert(const Key& key) { return D::insert(key); }
+};
+
+}	//MAUtil
+
+#endif	//_SE_MSAB_MAUTIL_BTREESET_H_
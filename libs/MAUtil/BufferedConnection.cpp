@@ -0,0 +1,319 @@
+/* Copyright 2013 David Axmark
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+	http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <mastring.h>
+#include "BufferedConnection.h"
+
+#ifndef MIN
+#define MIN(a,b) (((a) < (b)) ? (a) : (b))
+#endif
+#ifndef MAX
+#define MAX(a,b) (((a) > (b)) ? (a) : (b))
+#endif
+
+namespace MAUtil {
+
+void BufferedConnectionListener::connReadLineFinished(BufferedConnection* conn, int result) {
+	PANIC_MESSAGE("BufferedConnectionListener::connReadLineFinished unimplemented!");
+}
+void BufferedConnectionListener::connReadUntilFinished(BufferedConnection* conn, int result) {
+	PANIC_MESSAGE("BufferedConnectionListener::connReadUntilFinished unimplemented!");
+}
+void BufferedConnectionListener::connReadFrameFinished(BufferedConnection* conn, int result) {
+	PANIC_MESSAGE("BufferedConnectionListener::connReadFrameFinished unimplemented!");
+}
+
+
+BufferedConnection::BufferedConnection(BufferedConnectionListener* listener,
+	int bufferSize, MAHandle conn)
+: Connection(listener, conn), mOp(OP_NONE), mInSize(bufferSize), mInStart(0), mInLen(0),
+	mReading(false), mReadingDirect(false), mReadError(0), mProcessing(false),
+	mOutLen(0), mOutCap(bufferSize), mSendingLen(0), mSendingCap(bufferSize),
+	mFlushRequested(false)
+{
+	// a frame header must fit.
+	ASSERT_MSG(bufferSize >= 16, "buffer too small");
+	mIn = new byte[bufferSize];
+	mOut = new byte[bufferSize];
+	mSending = new byte[bufferSize];
+}
+
+BufferedConnection::~BufferedConnection() {
+	close();
+	delete[] mIn;
+	delete[] mOut;
+	delete[] mSending;
+}
+
+void BufferedConnection::close() {
+	Connection::close();
+	mOp = OP_NONE;
+	mInStart = mInLen = 0;
+	mReading = mReadingDirect = false;
+	mReadError = 0;
+	mOutLen = mSendingLen = 0;
+	mFlushRequested = false;
+}
+
+int BufferedConnection::buffered() const {
+	return mInLen;
+}
+
+int BufferedConnection::unflushed() const {
+	return mOutLen;
+}
+
+void BufferedConnection::readLine(char* dst, int maxlen) {
+	ASSERT_MSG(maxlen > 0, "invalid length");
+	mDelimiter = '\n';
+	startOp(OP_LINE, dst, maxlen);
+}
+
+void BufferedConnection::readUntil(byte delimiter, void* dst, int maxlen) {
+	ASSERT_MSG(maxlen > 0, "invalid length");
+	mDelimiter = delimiter;
+	startOp(OP_UNTIL, dst, maxlen);
+}
+
+void BufferedConnection::readFrame(void* dst, int maxlen, int headerSize, bool bigEndian) {
+	ASSERT_MSG(maxlen >= 0, "invalid length");
+	ASSERT_MSG(headerSize == 1 || headerSize == 2 || headerSize == 4, "invalid header size");
+	mHeaderSize = headerSize;
+	mBigEndian = bigEndian;
+	startOp(OP_FRAME, dst, maxlen);
+}
+
+void BufferedConnection::read(void* dst, int len) {
+	ASSERT_MSG(len > 0, "invalid length");
+	startOp(OP_READ, dst, len);
+}
+
+void BufferedConnection::recv(void* dst, int maxlen) {
+	ASSERT_MSG(maxlen > 0, "invalid length");
+	startOp(OP_RECV, dst, maxlen);
+}
+
+void BufferedConnection::startOp(Op op, void* dst, int maxlen) {
+	ASSERT_MSG(mOp == OP_NONE, "a read is already active");
+	mOp = op;
+	mOpDst = (byte*)dst;
+	mOpMax = maxlen;
+	mOpDone = 0;
+	mFrameLen = -1;
+	process();
+}
+
+// Finishes operations for as long as the buffer has the data for them.
+// When called from a listener, the outer call finishes the new operation.
+void BufferedConnection::process() {
+	if(mProcessing)
+		return;
+	mProcessing = true;
+	while(mOp != OP_NONE) {
+		int result;
+		if(!step(result)) {
+			if(mReadError == 0) {
+				fill();
+				break;
+			}
+			result = mReadError;
+		}
+		Op op = mOp;
+		mOp = OP_NONE;
+		finish(op, result);
+	}
+	mProcessing = false;
+}
+
+// Takes what the active operation needs from the buffer.
+// Returns true if the operation is finished.
+bool BufferedConnection::step(int& result) {
+	switch(mOp) {
+	case OP_RECV:
+		if(mInLen == 0)
+			return false;
+		result = MIN(mInLen, mOpMax);
+		consume(mOpDst, result);
+		return true;
+	case OP_READ:
+	case OP_FRAME:
+		if(mOp == OP_FRAME && mFrameLen < 0) {
+			if(mInLen < mHeaderSize)
+				return false;
+			byte h[4];
+			consume(h, mHeaderSize);
+			unsigned int len = 0;
+			for(int i=0; i<mHeaderSize; i++) {
+				int b = mBigEndian ? i : mHeaderSize - 1 - i;
+				len = (len << 8) | h[b];
+			}
+			if(len > (unsigned int)mOpMax) {
+				result = CONNERR_PROTOCOL;
+				return true;
+			}
+			mFrameLen = len;
+		}
+		{
+			int len = mOp == OP_READ ? mOpMax : mFrameLen;
+			int n = MIN(mInLen, len - mOpDone);
+			consume(mOpDst + mOpDone, n);
+			mOpDone += n;
+			if(mOpDone < len)
+				return false;
+			result = mOp == OP_READ ? 1 : len;
+			return true;
+		}
+	case OP_LINE:
+	case OP_UNTIL:
+		{
+			int avail = MIN(mInLen, mOpMax - mOpDone);
+			const byte* d = (byte*)memchr(mIn + mInStart, mDelimiter, avail);
+			int n = d ? (d - (mIn + mInStart)) + 1 : avail;
+			consume(mOpDst + mOpDone, n);
+			mOpDone += n;
+			if(d) {
+				result = mOpDone;
+				if(mOp == OP_LINE) {
+					// replace the line ending with a terminator.
+					result--;
+					if(result > 0 && mOpDst[result - 1] == '\r')
+						result--;
+					mOpDst[result] = 0;
+				}
+				return true;
+			}
+			if(mOpDone == mOpMax) {
+				result = CONNERR_PROTOCOL;
+				return true;
+			}
+			return false;
+		}
+	default:
+		BIG_PHAT_ERROR;
+	}
+}
+
+void BufferedConnection::finish(Op op, int result) {
+	BufferedConnectionListener* l = (BufferedConnectionListener*)mListener;
+	switch(op) {
+	case OP_LINE: l->connReadLineFinished(this, result); break;
+	case OP_UNTIL: l->connReadUntilFinished(this, result); break;
+	case OP_FRAME: l->connReadFrameFinished(this, result); break;
+	case OP_READ: l->connReadFinished(this, result); break;
+	case OP_RECV: l->connRecvFinished(this, result); break;
+	default: BIG_PHAT_ERROR;
+	}
+}
+
+void BufferedConnection::consume(void* dst, int len) {
+	memcpy(dst, mIn + mInStart, len);
+	mInStart += len;
+	mInLen -= len;
+	if(mInLen == 0)
+		mInStart = 0;
+}
+
+// Starts a read for the active operation.
+void BufferedConnection::fill() {
+	if(mReading)
+		return;
+	mReading = true;
+	// large reads skip the buffer once it's empty.
+	if(mInLen == 0 && (mOp == OP_READ || (mOp == OP_FRAME && mFrameLen >= 0))) {
+		int remain = (mOp == OP_READ ? mOpMax : mFrameLen) - mOpDone;
+		if(remain >= mInSize) {
+			mReadingDirect = true;
+			maConnRead(mConn, mOpDst + mOpDone, remain);
+			return;
+		}
+	}
+	// step() left less than a frame header in the buffer.
+	if(mInStart > 0) {
+		memmove(mIn, mIn + mInStart, mInLen);
+		mInStart = 0;
+	}
+	maConnRead(mConn, mIn + mInLen, mInSize - mInLen);
+}
+
+void BufferedConnection::write(const void* src, int len) {
+	if(mOutLen + len > mOutCap) {
+		// a write is active, or this one is larger than the buffer.
+		int cap = MAX(mOutCap * 2, mOutLen + len);
+		byte* out = new byte[cap];
+		memcpy(out, mOut, mOutLen);
+		delete[] mOut;
+		mOut = out;
+		mOutCap = cap;
+	}
+	memcpy(mOut + mOutLen, src, len);
+	mOutLen += len;
+	if(mSendingLen == 0 && mOutLen >= mInSize)
+		send();
+}
+
+void BufferedConnection::flush() {
+	mFlushRequested = true;
+	if(mSendingLen > 0)
+		return;
+	if(mOutLen > 0) {
+		send();
+	} else {
+		mFlushRequested = false;
+		mListener->connWriteFinished(this, 1);
+	}
+}
+
+void BufferedConnection::send() {
+	byte* b = mSending;
+	int cap = mSendingCap;
+	mSending = mOut;
+	mSendingCap = mOutCap;
+	mSendingLen = mOutLen;
+	mOut = b;
+	mOutCap = cap;
+	mOutLen = 0;
+	maConnWrite(mConn, mSending, mSendingLen);
+}
+
+void BufferedConnection::connEvent(const MAConnEventData& data) {
+	ASSERT_MSG(data.handle == mConn, "didn't register for this connection handle");
+	if(data.opType == CONNOP_READ && mReading) {
+		mReading = false;
+		if(data.result < 0)
+			mReadError = data.result;
+		else if(mReadingDirect)
+			mOpDone += data.result;
+		else
+			mInLen += data.result;
+		mReadingDirect = false;
+		process();
+	} else if(data.opType == CONNOP_WRITE && mSendingLen > 0) {
+		mSendingLen = 0;
+		if(data.result < 0) {
+			mOutLen = 0;
+			mFlushRequested = false;
+			mListener->connWriteFinished(this, data.result);
+		} else if(mOutLen > 0 && (mFlushRequested || mOutLen >= mInSize)) {
+			send();
+		} else if(mFlushRequested) {
+			mFlushRequested = false;
+			mListener->connWriteFinished(this, 1);
+		}
+	} else {
+		Connection::connEvent(data);
+	}
+}
+
+}	//namespace MAUtil
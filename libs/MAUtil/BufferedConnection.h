@@ -0,0 +1,230 @@
+/* Copyright 2013 David Axmark
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+	http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+/** \file BufferedConnection.h
+* \brief A Connection that buffers its reads and writes, for line and frame based protocols.
+*/
+
+#ifndef _MAUTIL_BUFFERED_CONNECTION_H_
+#define _MAUTIL_BUFFERED_CONNECTION_H_
+
+#include "Connection.h"
+
+namespace MAUtil {
+
+class BufferedConnection;
+
+/**
+* \brief A listener for events from the BufferedConnection class.
+* All the default implementations call maPanic().
+*/
+class BufferedConnectionListener : public ConnectionListener {
+public:
+	/**
+	* Called when a readLine() operation finishes.
+	* \param conn The BufferedConnection that ran the operation.
+	* \param result The length of the line on success,
+	* or a \link #CONNERR_GENERIC CONNERR \endlink code \< 0 on failure.
+	*/
+	virtual void ATTRIBUTE(noreturn, connReadLineFinished(BufferedConnection* conn, int result));
+
+	/**
+	* Called when a readUntil() operation finishes.
+	* \param conn The BufferedConnection that ran the operation.
+	* \param result The number of bytes read, including the delimiter, on success,
+	* or a \link #CONNERR_GENERIC CONNERR \endlink code \< 0 on failure.
+	*/
+	virtual void ATTRIBUTE(noreturn, connReadUntilFinished(BufferedConnection* conn, int result));
+
+	/**
+	* Called when a readFrame() operation finishes.
+	* \param conn The BufferedConnection that ran the operation.
+	* \param result The length of the frame, not counting its header, on success,
+	* or a \link #CONNERR_GENERIC CONNERR \endlink code \< 0 on failure.
+	*/
+	virtual void ATTRIBUTE(noreturn, connReadFrameFinished(BufferedConnection* conn, int result));
+};
+
+/**
+* \brief A Connection with a read buffer and a write buffer.
+*
+* Reads fill a buffer with as much data as the connection has,
+* up to the size of the buffer. readLine(), readUntil(), readFrame(), read() and
+* recv() are then served from the buffer, and only read from the connection
+* when the buffer doesn't have enough data. When the data is already in the
+* buffer, the listener is called before the read function returns.
+* A read function may be called from the listener; the operation then finishes
+* after the listener returns, so many buffered lines don't nest the calls.
+*
+* write() copies the data to a buffer, which is written to the connection
+* by flush(), or when it is full. Small writes are thus sent with one
+* maConnWrite().
+*
+* As with Connection, only one read operation may be active at a time.
+* recvToData(), recvFrom() and readToData() bypass the buffer, and must not
+* be used while it has data. The same goes for the read and write functions
+* of Connection, which this class hides.
+*/
+class BufferedConnection : public Connection {
+public:
+	enum {
+		DEFAULT_BUFFER_SIZE = 4096
+	};
+
+	/**
+	* \param listener Will recieve events from this BufferedConnection.
+	* \param bufferSize The size of the read buffer, and the amount of
+	* written data that makes write() send the data without a flush().
+	* \param conn Optional. If you have a connection handle,
+	* you can pass it here to wrap it in a BufferedConnection.
+	*/
+	BufferedConnection(BufferedConnectionListener* listener,
+		int bufferSize = DEFAULT_BUFFER_SIZE, MAHandle conn = 0);
+
+	virtual ~BufferedConnection();
+
+	/**
+	* Closes the connection, if open, and discards the buffered data.
+	* \see Connection::close()
+	*/
+	void close();
+
+	/**
+	* Reads a line of text, which ends with '\\n' or "\r\n", to \a dst.
+	* The line is stored without the line ending, and is null-terminated.
+	* Causes BufferedConnectionListener::connReadLineFinished() to be called
+	* when the operation is complete.
+	* If the line, with its '\\n', doesn't fit in \a maxlen bytes,
+	* the operation fails with #CONNERR_PROTOCOL.
+	*/
+	void readLine(char* dst, int maxlen);
+
+	/**
+	* Reads up to and including the first \a delimiter byte, to \a dst.
+	* Causes BufferedConnectionListener::connReadUntilFinished() to be called
+	* when the operation is complete.
+	* If there's no delimiter in the first \a maxlen bytes,
+	* the operation fails with #CONNERR_PROTOCOL.
+	*/
+	void readUntil(byte delimiter, void* dst, int maxlen);
+
+	/**
+	* Reads a frame with a header that is its length, to \a dst.
+	* The header is not stored.
+	* Causes BufferedConnectionListener::connReadFrameFinished() to be called
+	* when the operation is complete.
+	* If the length is more than \a maxlen, the operation fails with
+	* #CONNERR_PROTOCOL. The frame is then left unread, so the connection
+	* should be closed.
+	* \param headerSize The size of the header: 1, 2 or 4 bytes.
+	* \param bigEndian True if the header is big-endian (network byte order).
+	*/
+	void readFrame(void* dst, int maxlen, int headerSize, bool bigEndian = true);
+
+	/**
+	* Reads exactly \a len bytes to \a dst.
+	* Causes ConnectionListener::connReadFinished() to be called when the operation is complete.
+	* Reads of more than the size of the buffer go straight to \a dst,
+	* once the buffered data has been copied.
+	*/
+	void read(void* dst, int len);
+
+	/**
+	* Reads between 1 and \a maxlen bytes to \a dst.
+	* Causes ConnectionListener::connRecvFinished() to be called when the operation is complete.
+	*/
+	void recv(void* dst, int maxlen);
+
+	/**
+	* Returns the number of bytes in the read buffer.
+	*/
+	int buffered() const;
+
+	/**
+	* Copies \a len bytes from \a src to the write buffer.
+	* The buffer is written to the connection when there are at least
+	* as many bytes in it as the size of the read buffer, or when flush() is called.
+	* \a src may be discarded once this function returns.
+	* ConnectionListener::connWriteFinished() is only called by write() if a write fails.
+	*/
+	void write(const void* src, int len);
+
+	/**
+	* Writes the write buffer to the connection.
+	* Causes ConnectionListener::connWriteFinished() to be called when
+	* all the data written before the flush() has been written.
+	* If there is nothing to write, it is called before flush() returns.
+	*/
+	void flush();
+
+	/**
+	* Returns the number of bytes that have been written but not yet sent.
+	*/
+	int unflushed() const;
+
+protected:
+	enum Op { OP_NONE, OP_LINE, OP_UNTIL, OP_FRAME, OP_READ, OP_RECV };
+
+	// The active read operation.
+	Op mOp;
+	byte* mOpDst;
+	int mOpMax;
+	int mOpDone;
+	byte mDelimiter;
+	int mHeaderSize;
+	bool mBigEndian;
+	// the length of the frame, or -1 if its header hasn't been read.
+	int mFrameLen;
+
+	// The read buffer: mInLen bytes, starting at mInStart.
+	// Operations take all the data they can, so there are at most a few
+	// bytes left when the buffer needs filling; they are moved to the start.
+	byte* mIn;
+	int mInSize;
+	int mInStart;
+	int mInLen;
+	// set while a maConnRead() is active.
+	bool mReading;
+	// set if the active maConnRead() reads straight to mOpDst.
+	bool mReadingDirect;
+	// the result of the read that failed, or 0.
+	int mReadError;
+	// set while finishing operations, so that the listener can start a new one.
+	bool mProcessing;
+
+	// The write buffers: mOut collects data while mSending is being written.
+	byte* mOut;
+	int mOutLen;
+	int mOutCap;
+	byte* mSending;
+	int mSendingLen;
+	int mSendingCap;
+	bool mFlushRequested;
+
+	void startOp(Op op, void* dst, int maxlen);
+	void process();
+	bool step(int& result);
+	void finish(Op op, int result);
+	void fill();
+	void consume(void* dst, int len);
+	void send();
+
+	//ConnListener
+	virtual void connEvent(const MAConnEventData& data);
+};
+
+}	//namespace MAUtil
+
+#endif	//_MAUTIL_BUFFERED_CONNECTION_H_
@@ -48,7 +48,6 @@ namespace MAUtil {
 		: mKeyListeners(false),
 		mPointerListeners(false),
 		mBtListener(NULL),
-		mConnListeners(false),
 		mIdleListeners(false),
 		mTimerEvents(true),
 		mFocusListeners(false),
@@ -137,21 +136,11 @@ namespace MAUtil {
 		}
 		
 		//MAASSERT(sEnvironment == this);
-		
-		// First remove the existing listener, if any.
-		removeConnListener(conn);
-		
-		// Set the listener for the connection.
-		cl->_mConn = conn;
-		mConnListeners.add(cl);
+		mConnListeners.set(conn, cl);
 	}
 	
 	void Environment::removeConnListener(MAHandle conn) {
-		ListenerSet_each(ConnListener, itr, mConnListeners) {
-			if(itr->_mConn == conn) {
-				mConnListeners.remove(&*itr);
-			}
-		}
+		mConnListeners.remove(conn);
 	}
 
 	void Environment::addCloseListener(CloseListener* cl) {
@@ -396,14 +385,9 @@ namespace MAUtil {
 
 	void Environment::fireConnEvent(const MAConnEventData& data) {
 		//MAASSERT(sEnvironment == this);
-		mConnListeners.setRunning(true);
-		ListenerSet_each(ConnListener, itr, mConnListeners) {
-			if(itr->_mConn == data.handle) {
-				itr->connEvent(data);
-				break;
-			}
-		}
-		mConnListeners.setRunning(false);
+		ConnListener* cl = mConnListeners.get(data.handle);
+		if(cl)
+			cl->connEvent(data);
 	}
 
 	void Environment::fireCloseEvent() {
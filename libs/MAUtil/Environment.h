@@ -32,6 +32,7 @@ limitations under the License.
 #include <maassert.h>
 #include "Vector.h"
 #include "ListenerSet.h"
+#include "HandleTable.h"
 
 namespace MAUtil {
 	/*
@@ -98,9 +99,6 @@ namespace MAUtil {
 	class ConnListener {
 	public:	
 		virtual void connEvent(const MAConnEventData& data) = 0;
-	private:
-		MAHandle _mConn;
-		friend class Environment;
 	};
 
 	/**
@@ -311,6 +309,9 @@ namespace MAUtil {
 		* Sets the listener for a connection.
 		* Only one listener per connection is allowed, but the same ConnListener
 		* can be used with several connections.
+		* The listeners are indexed by connection handle, so setting, removing
+		* and calling a listener takes constant time, however many connections
+		* there are. Listeners may be set and removed from within connEvent().
 		*/
 		void setConnListener(MAHandle conn, ConnListener* cl);
 
@@ -555,7 +556,7 @@ namespace MAUtil {
 		ListenerSet<PointerListener> mPointerListeners;
 		BluetoothListener* mBtListener;
 		Vector<CloseListener*> mCloseListeners;
-		ListenerSet<ConnListener> mConnListeners;
+		HandleTable<ConnListener> mConnListeners;
 		ListenerSet<IdleListener> mIdleListeners;
 		ListenerSet<TimerEventInstance> mTimerEvents;
 		ListenerSet<FocusListener> mFocusListeners;
@@ -0,0 +1,148 @@
+/* Copyright 2013 David Axmark
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+	http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+/** \file HandleTable.h
+ * \brief Table of per-handle listeners.
+ */
+
+#ifndef _MAUTIL_HANDLE_TABLE_H_
+#define _MAUTIL_HANDLE_TABLE_H_
+
+#include <ma.h>
+#include <maassert.h>
+
+#include "Vector.h"
+
+namespace MAUtil {
+	/**
+	* \brief A table of pointers, indexed by MAHandle.
+	*
+	* Used for listeners that are set per handle, like connection listeners.
+	* set(), remove() and get() take constant time, however many handles
+	* there are. The table doesn't keep any iterators or pointers into itself,
+	* so a listener that was found by get() may set and remove
+	* listeners while it is being called.
+	*
+	* The table is an open-addressed hash table, which is allocated when the
+	* first pointer is set. Unlike MAUtil::HashMap, it doesn't allocate
+	* anything per handle.
+	*/
+	template<typename T> class HandleTable {
+	public:
+		HandleTable() : mSize(0) {}
+
+		/**
+		* Sets the pointer for \a handle, replacing the old one, if any.
+		* \a t must not be NULL.
+		*/
+		void set(MAHandle handle, T* t) {
+			MAASSERT(t != NULL);
+			if((mSize + 1) * 2 > mTable.size())
+				grow();
+			int pos = find(handle);
+			if(mTable[pos].value == NULL) {
+				mTable[pos].handle = handle;
+				mSize++;
+			}
+			mTable[pos].value = t;
+		}
+
+		/**
+		* Removes the pointer for \a handle, if any.
+		*/
+		void remove(MAHandle handle) {
+			if(mSize == 0)
+				return;
+			int pos = find(handle);
+			if(mTable[pos].value == NULL)
+				return;
+			// Move the entries after it back, so that no probe
+			// sequence has a gap in it.
+			int mask = mTable.size() - 1;
+			int next = pos;
+			for(;;) {
+				next = (next + 1) & mask;
+				if(mTable[next].value == NULL)
+					break;
+				int home = hash(mTable[next].handle) & mask;
+				// Move it if pos is between its home and next, cyclically.
+				if(((next - home) & mask) >= ((next - pos) & mask)) {
+					mTable[pos] = mTable[next];
+					pos = next;
+				}
+			}
+			mTable[pos].value = NULL;
+			mSize--;
+		}
+
+		/**
+		* Returns the pointer for \a handle, or NULL if there is none.
+		*/
+		T* get(MAHandle handle) const {
+			if(mSize == 0)
+				return NULL;
+			return mTable[find(handle)].value;
+		}
+
+		/**
+		* Returns the number of handles that have a pointer.
+		*/
+		int size() const {
+			return mSize;
+		}
+
+	private:
+		struct Entry {
+			MAHandle handle;
+			T* value;
+		};
+
+		static unsigned int hash(MAHandle handle) {
+			// handles are often consecutive; spread them over the table.
+			return (unsigned int)handle * 2654435761u >> 8;
+		}
+
+		// Returns the position of \a handle, or the empty position where it would be.
+		int find(MAHandle handle) const {
+			int mask = mTable.size() - 1;
+			int pos = hash(handle) & mask;
+			while(mTable[pos].value != NULL && mTable[pos].handle != handle)
+				pos = (pos + 1) & mask;
+			return pos;
+		}
+
+		void grow() {
+			Vector<Entry> old;
+			old.resize(mTable.size());
+			for(int i=0; i<mTable.size(); i++)
+				old[i] = mTable[i];
+			int cap = mTable.size() == 0 ? 16 : mTable.size() * 2;
+			mTable.resize(cap);
+			for(int i=0; i<cap; i++)
+				mTable[i].value = NULL;
+			for(int i=0; i<old.size(); i++) {
+				if(old[i].value != NULL) {
+					int pos = find(old[i].handle);
+					mTable[pos] = old[i];
+				}
+			}
+		}
+
+		Vector<Entry> mTable;
+		int mSize;
+	};
+}
+
+#endif	//_MAUTIL_HANDLE_TABLE_H_
@@ -40,6 +40,17 @@ limitations under the License.
 namespace MAUtil {
 	/**
 	* \brief A listener set.
+	*
+	* Listeners are called in the order they were added.
+	* Listeners may be added and removed while the set is running,
+	* that is, while its listeners are being called.
+	* Listeners added while running are not called until the next run.
+	*
+	* Every listener has a slot that doesn't move while the set is running.
+	* Removing a listener empties its slot; the empty slots are compacted away
+	* when there are more of them than there are listeners.
+	* Sets with more than a few listeners keep an index of the slots,
+	* so that add(), remove() and contains() take constant time.
 	*/
 	template<typename T> class ListenerSet {
 	private:
@@ -48,6 +59,13 @@ namespace MAUtil {
 			int refCount;
 		};
 
+		enum {
+			// sets with more slots than this are indexed.
+			INDEX_THRESHOLD = 8,
+			// the empty slots aren't compacted until there are this many.
+			COMPACT_THRESHOLD = 8
+		};
+
 	public:
 		/**
 		* \brief An iterator for a listener set.
@@ -76,8 +94,8 @@ namespace MAUtil {
 			int mIndex;
 		};
 
-		ListenerSet(bool shouldDelete) : mRunning(false), mUpdateRequired(false),
-			mShouldDelete(shouldDelete)
+		ListenerSet(bool shouldDelete) : mRunning(0), mUpdateRequired(false),
+			mShouldDelete(shouldDelete), mDead(0)
 		{
 		}
 
@@ -86,63 +104,156 @@ namespace MAUtil {
 		}
 
 		void add(T* t) {
-			templateVector_each(Combo, i, mVec) {
-				if(i->listener == t) {
-					i->refCount = 1;
-					return;
+			int pos = find(t);
+			if(pos >= 0) {
+				// the slot of a listener that was removed while running is
+				// kept until the run is over, so it can be put back.
+				Combo& c(mVec[slot(pos)]);
+				if(c.refCount == 0) {
+					c.refCount = 1;
+					mDead--;
 				}
+				return;
 			}
 			Combo c = { t, 1 };
 			mVec.add(c);
+			if(mIndex.size() > 0 && mVec.size() * 2 <= mIndex.size())
+				insertIndex(mVec.size() - 1);
+			else if(mVec.size() > INDEX_THRESHOLD)
+				rebuildIndex();
 		}
 
 		void remove(T* t) {
-			templateVector_each(Combo, i, mVec) {
-				if(i->listener == t) {
-					if(mRunning) {
-						i->refCount = 0;
-						mUpdateRequired = true;
-					} else {
-						if(mShouldDelete)
-							delete i->listener;
-						mVec.remove(i);
-					}
-					return;
-				}
+			int pos = find(t);
+			if(pos < 0)
+				return;
+			Combo& c(mVec[slot(pos)]);
+			if(c.refCount == 0)
+				return;
+			c.refCount = 0;
+			mDead++;
+			if(mRunning) {
+				mUpdateRequired = true;
+			} else {
+				if(mShouldDelete)
+					delete c.listener;
+				c.listener = NULL;
+				maybeCompact();
 			}
 		}
 
 		bool contains(T* t) {
-			templateVector_each(Combo, i, mVec)
-				if(i->listener == t)
-					return true;
-			return false;
+			int pos = find(t);
+			return pos >= 0 && mVec[slot(pos)].refCount != 0;
 		}
 
+		/**
+		* Call with true before calling the listeners, and with false afterwards.
+		* The calls may be nested.
+		*/
 		void setRunning(bool r=true) {
-			mRunning = r;
-			if(mRunning == false && mUpdateRequired) {
-				int s = mVec.size();
-				//for(int i=vec.size(); i>=0; i--)
+			if(r) {
+				mRunning++;
+				return;
+			}
+			mRunning--;
+			if(mRunning == 0 && mUpdateRequired) {
 				templateVector_each(Combo, itr, mVec) {
-					if(itr->refCount <= 0) {
+					if(itr->refCount == 0 && itr->listener != NULL) {
 						if(mShouldDelete)
 							delete itr->listener;
-						*itr = mVec[--s];
+						itr->listener = NULL;
 					}
 				}
-				mVec.resize(s);
 				mUpdateRequired = false;
+				maybeCompact();
 			}
 		}
 
-		int size() const {	//unsafe if running
-			return mVec.size();
+		int size() const {
+			return mVec.size() - mDead;
 		}
 
 	private:
-		bool mRunning, mUpdateRequired, mShouldDelete;
+		// Returns the position of \a t in the index, or its slot if there is
+		// no index, or -1 if there is no slot with \a t.
+		int find(T* t) const {
+			if(mIndex.size() == 0) {
+				for(int i=0; i<mVec.size(); i++) {
+					if(mVec[i].listener == t)
+						return i;
+				}
+				return -1;
+			}
+			int mask = mIndex.size() - 1;
+			for(int pos = hash(t) & mask; ; pos = (pos + 1) & mask) {
+				int s = mIndex[pos];
+				if(s == 0)
+					return -1;
+				if(mVec[s - 1].listener == t)
+					return pos;
+			}
+		}
+
+		int slot(int pos) const {
+			return mIndex.size() == 0 ? pos : mIndex[pos] - 1;
+		}
+
+		static unsigned int hash(T* t) {
+			// listeners are aligned, so the low bits are discarded.
+			unsigned int h = (unsigned int)(size_t)t >> 2;
+			return h ^ (h >> 12);
+		}
+
+		// Empty slots are kept in the index, with a NULL listener,
+		// so that the probe sequences past them are unbroken.
+		void insertIndex(int s) {
+			int mask = mIndex.size() - 1;
+			int pos = hash(mVec[s].listener) & mask;
+			while(mIndex[pos] != 0)
+				pos = (pos + 1) & mask;
+			mIndex[pos] = s + 1;
+		}
+
+		void rebuildIndex() {
+			if(mVec.size() <= INDEX_THRESHOLD) {
+				mIndex.clear();
+				return;
+			}
+			int cap = 16;
+			while(cap < mVec.size() * 4)
+				cap *= 2;
+			mIndex.clear();
+			mIndex.resize(cap);
+			for(int i=0; i<cap; i++)
+				mIndex[i] = 0;
+			for(int i=0; i<mVec.size(); i++) {
+				if(mVec[i].listener != NULL)
+					insertIndex(i);
+			}
+		}
+
+		// Removes the empty slots, keeping the order of the listeners.
+		// Must not be called while running.
+		void maybeCompact() {
+			if(mDead < COMPACT_THRESHOLD || mDead * 2 < mVec.size())
+				return;
+			int s = 0;
+			for(int i=0; i<mVec.size(); i++) {
+				if(mVec[i].refCount != 0)
+					mVec[s++] = mVec[i];
+			}
+			mVec.resize(s);
+			mDead = 0;
+			rebuildIndex();
+		}
+
+		int mRunning;
+		bool mUpdateRequired, mShouldDelete;
+		int mDead;
 		Vector<Combo> mVec;
+		// slot + 1, or 0 for an unused position. Empty if there are few slots.
+		Vector<int> mIndex;
 	};
 } // namespace MAUtil
 
@@ -51,6 +51,14 @@ template<class T> int Compare(const T& a, const T& b) {
 		return 1;
 }
 
+/** \brief Template less-than functor.
+* Unlike Compare(), it is a type, so containers that take it as a template
+* parameter can have the comparison inlined.
+*/
+template<class T> struct Less {
+	bool operator()(const T& a, const T& b) const { return a < b; }
+};
+
 //******************************************************************************
 // Pair
 //******************************************************************************
@@ -97,15 +97,157 @@ namespace MoGraph
 
 		mShader.init();
 
-		// Generate a buffer for the vertices
-		glGenBuffers(1, &mShader.mVertexbuffer);
-		glBindBuffer(GL_ARRAY_BUFFER, mShader.mVertexbuffer);
-		glBufferData(GL_ARRAY_BUFFER, mVertices.size() * sizeof(glm::vec3), &mVertices[0], GL_STATIC_DRAW);
+		// one index buffer shared by all chunks, the cube faces repeated for every bar in a full chunk
+		const int maxBars = CHUNK_BARS*CHUNK_BARS;
+		const int nVertices = mVertices.size();
+		std::vector<unsigned short> chunkIndices;
+		chunkIndices.reserve(maxBars*mFaces.size());
+		for(int b=0; b<maxBars; b++)
+		{
+			for(size_t i=0; i<mFaces.size(); i++)
+			{
+				chunkIndices.push_back(b*nVertices+mFaces[i]);
+			}
+		}
 
 		// Generate a buffer for the indices
 		glGenBuffers(1, &mShader.mElementbuffer);
 		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mShader.mElementbuffer);
-		glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned short), &indices[0], GL_STATIC_DRAW);
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, chunkIndices.size() * sizeof(unsigned short), &chunkIndices[0], GL_STATIC_DRAW);
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+		createChunks();
+	}
+
+	/**
+	 * \brief BarMgr::createChunks, divides the grid into chunks of CHUNK_BARS*CHUNK_BARS
+	 */
+	void BarMgr::createChunks()
+	{
+		releaseChunks();
+
+		const int iGridX	= mScene->getGridX();
+		const int iGridZ	= mScene->getGridZ();
+		for(int z=0; z<iGridZ; z+=CHUNK_BARS)
+		{
+			for(int x=0; x<iGridX; x+=CHUNK_BARS)
+			{
+				BarChunk chunk;
+				chunk.mX = x;
+				chunk.mZ = z;
+				chunk.mW = glm::min((int)CHUNK_BARS, iGridX-x);
+				chunk.mH = glm::min((int)CHUNK_BARS, iGridZ-z);
+				glGenBuffers(1, &chunk.mVertexbuffer);
+				mChunks.push_back(chunk);
+			}
+		}
+		mChunksBars = mBarArray.size();
+	}
+
+	/**
+	 * \brief BarMgr::releaseChunks, deletes the chunk vertex buffers
+	 */
+	void BarMgr::releaseChunks()
+	{
+		for(size_t i=0; i<mChunks.size(); i++)
+		{
+			glDeleteBuffers(1, &mChunks[i].mVertexbuffer);
+		}
+		mChunks.clear();
+	}
+
+	/**
+	 * \brief BarMgr::invalidate, forces all chunks to be rebuilt on next draw
+	 */
+	void BarMgr::invalidate()
+	{
+		for(size_t i=0; i<mChunks.size(); i++)
+		{
+			mChunks[i].mDirty = true;
+		}
+	}
+
+	/**
+	 * \brief BarMgr::update, copies values and colors from the scene to the bars.
+	 * only chunks containing a changed bar are marked dirty.
+	 */
+	void BarMgr::update()
+	{
+		const int iGridX	= mScene->getGridX();
+		for(size_t c=0; c<mChunks.size(); c++)
+		{
+			BarChunk &chunk = mChunks[c];
+			for(int j=chunk.mZ; j<chunk.mZ+chunk.mH; j++)
+			{
+				for(int i=chunk.mX; i<chunk.mX+chunk.mW; i++)
+				{
+					const int id = j*iGridX+i;
+					Bar &bar = getBar(id);
+					const float value = mScene->getValue(id);
+					const glm::vec4 &color = mScene->getColor(id);
+					if (bar.getValue() != value || bar.getColor() != color)
+					{
+						bar.setValue(value);
+						bar.setColor(color.x, color.y, color.z, color.w);
+						chunk.mDirty = true;
+					}
+				}
+			}
+		}
+	}
+
+	static unsigned char toByte(float c)
+	{
+		return (unsigned char)(glm::clamp(c, 0.0f, 1.0f)*255.0f + 0.5f);
+	}
+
+	/**
+	 * \brief BarMgr::buildChunk, bakes position, height and color of every bar
+	 * in the chunk into its vertex buffer.
+	 * @param chunk, input chunk to rebuild
+	 */
+	void BarMgr::buildChunk(BarChunk &chunk)
+	{
+		const int iGridX	= mScene->getGridX();
+		const float centerX = mScene->getCx();
+		const float centerZ = mScene->getCz();
+		const int nVertices = mVertices.size();
+		float minY = 0.0f;
+		float maxY = 0.0f;
+
+		mBuildBuffer.resize(chunk.mW*chunk.mH*nVertices);
+		BarVertex *v = &mBuildBuffer[0];
+		for(int j=chunk.mZ; j<chunk.mZ+chunk.mH; j++)
+		{
+			for(int i=chunk.mX; i<chunk.mX+chunk.mW; i++)
+			{
+				Bar &bar = getBar(j*iGridX+i);
+				const float value = bar.getValue();
+				const glm::vec4 &color = bar.getColor();
+				const glm::vec3 tpos((centerX+i)+0.5f, 0.0f, (centerZ-j)-0.5f);
+				// mirrored in X when negative, which keeps the winding of the faces.
+				const glm::vec3 sv((value >= 0.0f)? 0.5f: -0.5f, value, 0.5f);
+				minY = glm::min(minY, value);
+				maxY = glm::max(maxY, value);
+				for(int k=0; k<nVertices; k++, v++)
+				{
+					const glm::vec3 &p = mVertices[k];
+					v->mPos = tpos + p*sv;
+					// bars are shaded from black at the bottom to the color at the top.
+					v->mColor[0] = toByte(color.x*p.y);
+					v->mColor[1] = toByte(color.y*p.y);
+					v->mColor[2] = toByte(color.z*p.y);
+					v->mColor[3] = toByte(color.w);
+				}
+			}
+		}
+
+		chunk.mMin = glm::vec3(centerX+chunk.mX, minY, centerZ-(chunk.mZ+chunk.mH));
+		chunk.mMax = glm::vec3(centerX+chunk.mX+chunk.mW, maxY, centerZ-chunk.mZ);
+
+		glBindBuffer(GL_ARRAY_BUFFER, chunk.mVertexbuffer);
+		glBufferData(GL_ARRAY_BUFFER, mBuildBuffer.size()*sizeof(BarVertex), &mBuildBuffer[0], GL_DYNAMIC_DRAW);
+		chunk.mDirty = false;
 	}
 
 	/**
@@ -115,73 +257,57 @@ namespace MoGraph
 	{
 		float tick = mScene->getElapsedTime();
 
+		if (mChunksBars != (int)mBarArray.size())
+			createChunks();
+		update();
+
 		glEnable(GL_CULL_FACE);
 		BarShader &shader = getShader();
-		std::vector<unsigned short> &indices = mScene->getIndices();	// Index list of faces
+		const int indicesPerBar = mFaces.size();
 
 		// Use the program object   shader and its specific arguments
 		glUseProgram(shader.mShader);
 		checkGLError("glUseProgram");
 
-		// 1rst attribute buffer : vertices
 		glEnableVertexAttribArray(shader.mAttribVtxLoc);
-		glBindBuffer(GL_ARRAY_BUFFER, shader.mVertexbuffer);
-		glVertexAttribPointer(
-			shader.mAttribVtxLoc,     	// attribute
-			3,                  		// size
-			GL_FLOAT,           		// type
-			GL_FALSE,           		// normalized?
-			0,                  		// stride
-			(void*)0            		// array buffer offset
-		);
-
+		glEnableVertexAttribArray(shader.mAttribColorLoc);
 		checkGLError("glEnableVertexAttribArray");
 
-		// bind the Index buffer with vertex buffer
+		// bind the Index buffer shared by all chunks
 		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, shader.mElementbuffer);
 
 		// Update variables to the shader, that is only updated commonly for all bars once per frame such as ParojactionMatrix, ViewMatrix, should be World Matrix aswell
-		// projectionMatrix and viewMatrix tick time, resolution constants for pixel shader that are identical trough out the obj calls. hence update only once.
 		glUniform1f(shader.mTimeLoc, tick);
 		checkGLError("glUniform1f");
 		glUniform2f(shader.mResolutionLoc, 1.0f/(float)mScene->getWidth(), 1.0f/(float)mScene->getHeight());
 		checkGLError("glUniform2f");
 		glUniformMatrix4fv(shader.mMatrixPVW, 1, GL_FALSE, &mScene->getPVWMat()[0][0]);
 
-		// setting up a 2D grid.  prepare const variable for a tight loop
-		const int iGridX	= mScene->getGridX();
-		const int iGridZ	= mScene->getGridZ();
-		const float centerX = mScene->getCx();
-		const float centerZ = mScene->getCz();
-		glm::vec3 sv(0.5f,0.5f,0.5f);
-		glm::vec4 tpos(0.0f,0.0f,0.0f,1.0f);
-		for(int j=0; j<iGridZ; j++)
+		mFrustum.set(mScene->getPVWMat());
+		mDrawnChunks = 0;
+		for(size_t c=0; c<mChunks.size(); c++)
 		{
-			for(int i=0; i<iGridX; i++)
-			{
-				const int id = j*iGridX+i;
-				Bar &bar = getBar(id);
-				tpos.x 	= (centerX+i)+0.5f;
-				tpos.z 	= (centerZ-j)-0.5f;
-				sv.y 	= bar.getValue();
-				bar.setColor(mScene->getColor(id));				//	bar.setColor(i/30.0f,0.0f,j/30.0f,1.0f);
-				bar.setValue(mScene->getValue(id));
-
-				// upload our obj matrix to the vertex shader.
-				glUniform4fv(shader.mTPos,		1, (float *)&tpos.x);
-				glUniform3fv(shader.mScaleV,	1, (float *)&sv.x);				// mScale location => variable "ScaleV" in vertex shader
-				glUniform4fv(shader.mColor,		1, (float *)&bar.getColor().x);
-				glDrawElements(
-					 GL_TRIANGLES,      	// mode
-					 indices.size(),    	// count
-					 GL_UNSIGNED_SHORT,   	// type
-					 (void*)0           	// element array buffer offset
-				 );
-			}
+			BarChunk &chunk = mChunks[c];
+			if (chunk.mDirty)
+				buildChunk(chunk);
+			if (!mFrustum.isBoxVisible(chunk.mMin, chunk.mMax))
+				continue;
+
+			glBindBuffer(GL_ARRAY_BUFFER, chunk.mVertexbuffer);
+			glVertexAttribPointer(shader.mAttribVtxLoc, 3, GL_FLOAT, GL_FALSE, sizeof(BarVertex), (void*)0);
+			glVertexAttribPointer(shader.mAttribColorLoc, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(BarVertex), (void*)sizeof(glm::vec3));
+			glDrawElements(
+				 GL_TRIANGLES,      				// mode
+				 chunk.mW*chunk.mH*indicesPerBar,	// count
+				 GL_UNSIGNED_SHORT,   				// type
+				 (void*)0           				// element array buffer offset
+			 );
+			mDrawnChunks++;
 		}
 
 		// Clean-up
 		glDisableVertexAttribArray(shader.mAttribVtxLoc);
+		glDisableVertexAttribArray(shader.mAttribColorLoc);
 		glBindBuffer(GL_ARRAY_BUFFER,0);
 		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
 		glUseProgram(0);
@@ -29,6 +29,7 @@ limitations under the License.
 #include <string>
 #include "IRender.h"
 #include "Shaders.h"
+#include "Frustum.h"
 
 namespace MoGraph
 {
@@ -84,18 +85,59 @@ namespace MoGraph
 	};
 
 
+	/**
+	 * \brief BarVertex, one vertex of a bar as stored in the chunk vertex buffers.
+	 * the bar position, height and color are baked into the vertex.
+	 */
+	struct BarVertex
+	{
+		glm::vec3		mPos;
+		unsigned char	mColor[4];
+	};
+
+	/**
+	 * \brief BarChunk, a block of up to CHUNK_BARS*CHUNK_BARS bars
+	 * that is kept in one vertex buffer and drawn with one draw call.
+	 */
+	struct BarChunk
+	{
+		BarChunk() : mVertexbuffer(0), mDirty(true) {}
+
+		int			mX, mZ;			// first bar of the chunk in the grid
+		int			mW, mH;			// bars in X & Z
+		GLuint		mVertexbuffer;	// baked vertices of all bars in the chunk
+		bool		mDirty;			// vertex buffer needs to be rebuilt
+		glm::vec3	mMin;			// bounding box used for culling
+		glm::vec3	mMax;
+	};
+
 	/**
 	 * \brief BarMgr handles all the bars that are being displayed
 	 *	using Render base class for the render calls init() & draw()
+	 *
+	 * The bars are retained in vertex buffers, one per chunk of the grid.
+	 * Every frame the values and colors from the scene are compared to the
+	 * bars, and only the chunks with changed bars are rebuilt.
+	 * Chunks outside the view are culled.
+	 * \note OpenGL ES 2.0 has no instanced drawing, so the bar cube is
+	 * replicated into the chunk buffers instead (pseudo instancing).
 	 */
 
 	class BarMgr : public Render
 	{
+	public:
+		enum { CHUNK_BARS = 16 };	// bars per chunk side. 16*16*8 vertices fit an unsigned short index.
+
 	protected:
 		std::vector<Bar> 			mBarArray;		// question absolute amount of bars or display fromc..to
 		std::vector<glm::vec3> 		mVertices;
 		std::vector<unsigned short> mFaces;
 		BarShader					mShader;
+		std::vector<BarChunk>		mChunks;		// retained vertex buffers of the grid
+		int							mChunksBars;	// amount of bars mChunks was created for
+		std::vector<BarVertex>		mBuildBuffer;	// temporary vertices for rebuilding a chunk
+		Frustum						mFrustum;
+		int							mDrawnChunks;	// chunks that passed the culling last frame
 
 		/**
 		 * \brief create3D
@@ -104,18 +146,40 @@ namespace MoGraph
 		 */
 
 		void create3D();			// create 3D obj. one instance of a cube with origo at bottom with indices
+
+		/**
+		 * \brief createChunks, divides the grid into chunks
+		 */
+		void createChunks();
+
+		/**
+		 * \brief releaseChunks, deletes the chunk vertex buffers
+		 */
+		void releaseChunks();
+
+		/**
+		 * \brief update, copies values and colors from the scene to the bars
+		 * and marks the chunks of changed bars as dirty.
+		 */
+		void update();
+
+		/**
+		 * \brief buildChunk, bakes the bars of a chunk into its vertex buffer.
+		 * @param chunk
+		 */
+		void buildChunk(BarChunk &chunk);
 	public:
 
 		/**
 		 * \brief BarMgr Constructor
 		 * @param scene input reference for the scene
 		 */
-		BarMgr(Scene *scene) : Render(scene) 	{create3D();}
+		BarMgr(Scene *scene) : Render(scene), mChunksBars(0), mDrawnChunks(0) 	{create3D();}
 
 		/**
 		 * \brief ~BarMgr Destructor
 		 */
-		virtual ~BarMgr()						{}
+		virtual ~BarMgr()						{releaseChunks();}
 
 		/**
 		 * \brief addBars, 	set up amount of bars that shall be used for the graph
@@ -166,6 +230,23 @@ namespace MoGraph
 		 */
 		BarShader &getShader() 					{return mShader;}
 
+		/**
+		 * \brief invalidate, forces all chunks to be rebuilt on next draw
+		 */
+		void invalidate();
+
+		/**
+		 * \brief getDrawnChunks, amount of chunks drawn last frame (not culled)
+		 * @return chunk count
+		 */
+		int getDrawnChunks()					{return mDrawnChunks;}
+
+		/**
+		 * \brief getChunkCount, total amount of chunks in the grid
+		 * @return chunk count
+		 */
+		int getChunkCount()						{return mChunks.size();}
+
 		// virtuals from render class
 		/**
 		 * \brief init, initiate bar manager class to set up the graph bars
@@ -0,0 +1,73 @@
+/* Copyright 2013 David Axmark
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+	http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef FRUSTUM_H_
+#define FRUSTUM_H_
+
+#include <glm/glm.hpp>
+
+namespace MoGraph
+{
+	/**
+	 * \brief Frustum, the six clip planes of a Projection*View*World matrix.
+	 * used for culling whole groups of objects before they are sent to GL.
+	 */
+	class Frustum
+	{
+	protected:
+		glm::vec4 mPlanes[6];	// left right bottom top near far, normals pointing inwards.
+
+	public:
+		/**
+		 * \brief set, extracts the planes from a matrix
+		 * @param m, input Projection*View*World matrix
+		 */
+		void set(const glm::mat4 &m)
+		{
+			for(int i=0; i<3; i++)
+			{
+				for(int j=0; j<4; j++)
+				{
+					mPlanes[i*2][j]		= m[j][3] + m[j][i];
+					mPlanes[i*2+1][j]	= m[j][3] - m[j][i];
+				}
+			}
+		}
+
+		/**
+		 * \brief isBoxVisible, tests an axis aligned box against the planes.
+		 * \note conservative, a box near a corner may pass without being visible.
+		 * @param bmin, input box min corner
+		 * @param bmax, input box max corner
+		 * @return false if the box is entirely outside.
+		 */
+		bool isBoxVisible(const glm::vec3 &bmin, const glm::vec3 &bmax) const
+		{
+			for(int i=0; i<6; i++)
+			{
+				const glm::vec4 &p = mPlanes[i];
+				// the box corner furthest along the plane normal
+				glm::vec3 v((p.x >= 0.0f)? bmax.x: bmin.x,
+							(p.y >= 0.0f)? bmax.y: bmin.y,
+							(p.z >= 0.0f)? bmax.z: bmin.z);
+				if (p.x*v.x + p.y*v.y + p.z*v.z + p.w < 0.0f)
+					return false;
+			}
+			return true;
+		}
+	};
+}
+
+#endif /* FRUSTUM_H_ */
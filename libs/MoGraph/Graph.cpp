@@ -141,13 +141,23 @@ namespace MoGraph
 			Text &text = textMgr.getText(i);
 			mRenderText.setScale(text.mScale.x,text.mScale.y);
 			glm::vec3 pos = text.mPos;
+
+			// measuring is expensive, only do it when the text has changed.
+			if (text.mLayoutText != text.mText || text.mLayoutScale != text.mScale)
+			{
+				text.mLayoutWidth 		= mRenderText.getTextWidth(text.mText.c_str());
+				text.mLayoutLineHeight 	= mRenderText.getTextProperty(text.mText.c_str(),&prop);
+				text.mLayoutText 		= text.mText;
+				text.mLayoutScale 		= text.mScale;
+			}
+
 			switch (text.mTextFlagX)
 			{
 				case Text::CENTER_X:
-					pos.x -= 0.5f * mRenderText.getTextWidth(text.mText.c_str());	// this function is expensive.
+					pos.x -= 0.5f * text.mLayoutWidth;
 					break;
 				case Text::CENTER_RIGHT:
-					pos.x -= mRenderText.getTextWidth(text.mText.c_str());
+					pos.x -= text.mLayoutWidth;
 					break;
 				case Text::CENTER_LEFT:		// obsolete because it is by default
 					break;
@@ -159,10 +169,10 @@ namespace MoGraph
 			switch (text.mTextFlagY)
 			{
 				case Text::CENTER_Y:
-					pos.y -= 0.5f * mRenderText.getTextProperty(text.mText.c_str(),&prop);
+					pos.y -= 0.5f * text.mLayoutLineHeight;
 					break;
 				case Text::CENTER_BOTTOM:
-					pos.y -= mRenderText.getTextProperty(text.mText.c_str(),&prop);
+					pos.y -= text.mLayoutLineHeight;
 					break;
 				case Text::CENTER_TOP:		// obsolete because it is by default
 					break;
@@ -32,7 +32,8 @@ RenderText::RenderText()
 	mHeight(0),
 	mScaleX(0),
 	mScaleY(0),
-	mBlendType(BL_ADDITIVE)
+	mBlendType(BL_ADDITIVE),
+	mCachedVertexbuffer(0)
 {
 }
 
@@ -55,6 +56,8 @@ void RenderText::release()
 		VertStore &vstore = it->second;
 		delete [] static_cast<glm::vec4 *>(vstore.mVertices);
 		vstore.mVertices = 0;
+		glDeleteBuffers(1, &vstore.mVertexbuffer);
+		vstore.mVertexbuffer = 0;
 	}
 }
 
@@ -103,6 +106,7 @@ glm::vec4 *RenderText::getVertices(const char *str, bool bUseCache, float *width
 {
 	glm::vec4 *vertices = 0;
 	int num = 0;
+	mCachedVertexbuffer = 0;
 	if (bUseCache)
 	{
 		std::string key = str;
@@ -117,7 +121,12 @@ glm::vec4 *RenderText::getVertices(const char *str, bool bUseCache, float *width
 			*width = mFont->BuildVertexArray(vertices, key.c_str(), mOPos.x, mOPos.y, mScaleX, mScaleY);			// get vertex array from string,
 
 			glm::vec2 scaleXZ(mScaleX,mScaleY);
-			VertStore vstore(vertices,*width,scaleXZ);
+			// keep a GL copy of the vertices, reused every draw of this text
+			glGenBuffers(1, &mCachedVertexbuffer);
+			glBindBuffer(GL_ARRAY_BUFFER, mCachedVertexbuffer);
+			glBufferData(GL_ARRAY_BUFFER, 6*num*sizeof(glm::vec4), vertices, GL_STATIC_DRAW);
+			glBindBuffer(GL_ARRAY_BUFFER, 0);
+			VertStore vstore(vertices,*width,scaleXZ,mCachedVertexbuffer);
 
 			if ( (mTextCache.insert(TextCachePair(key,vstore))).second == false )
 			{
@@ -130,6 +139,7 @@ glm::vec4 *RenderText::getVertices(const char *str, bool bUseCache, float *width
 			VertStore &vstore = it->second;
 			vertices = static_cast<glm::vec4 *>(vstore.mVertices);
 			*width	 = vstore.mWidth;
+			mCachedVertexbuffer = vstore.mVertexbuffer;
 
 			// may need to check current scale state or restore system with it.
 			mScaleX = vstore.mScaleXZ.x;
@@ -215,7 +225,15 @@ float RenderText::drawText3D(const char*str, glm::vec3 &pos, glm::vec4 &rgba, gl
 
 	// 1. create buffers tri array for simplicity? so that every tri can be handled separately or with a new index buffer could be expensive though???
 	// Load the vertex data
-	glVertexAttribPointer(shader.mAttribVtxLoc, 4, GL_FLOAT, GL_FALSE, sizeof(float)*4, &vertices[0].x);
+	if (mCachedVertexbuffer)
+	{
+		glBindBuffer(GL_ARRAY_BUFFER, mCachedVertexbuffer);
+		glVertexAttribPointer(shader.mAttribVtxLoc, 4, GL_FLOAT, GL_FALSE, sizeof(float)*4, (void*)0);
+	}
+	else
+	{
+		glVertexAttribPointer(shader.mAttribVtxLoc, 4, GL_FLOAT, GL_FALSE, sizeof(float)*4, &vertices[0].x);
+	}
 	checkGLError("RenderText::DrawText   glVertexAttribPointer (V)");
 	glEnableVertexAttribArray(shader.mAttribVtxLoc);
 	checkGLError("RenderText::DrawText   glEnableVertexAttribArray (V)");
@@ -248,6 +266,7 @@ float RenderText::drawText3D(const char*str, glm::vec3 &pos, glm::vec4 &rgba, gl
 	checkGLError("RenderText::DrawText   glUniformMatrix4fv");
 	glDrawArrays(GL_TRIANGLES, 0, 6*num);
 	checkGLError("RenderText::DrawText   glDrawArrays");
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
 
 	// Clean-up
 	glDisableVertexAttribArray(shader.mAttribVtxLoc);
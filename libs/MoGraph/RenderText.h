@@ -24,11 +24,12 @@ limitations under the License.
 
 struct VertStore
 {
-	VertStore(void *vertices, float width, glm::vec2 &scaleXZ) : mVertices(vertices), mWidth(width), mScaleXZ(scaleXZ) {};
+	VertStore(void *vertices, float width, glm::vec2 &scaleXZ, GLuint vertexbuffer = 0) : mVertices(vertices), mWidth(width), mScaleXZ(scaleXZ), mVertexbuffer(vertexbuffer) {};
 
 	void 		*mVertices;
 	float		mWidth;
 	glm::vec2 	mScaleXZ;
+	GLuint		mVertexbuffer;	// copy of mVertices in a GL buffer, so cached text is not uploaded every draw
 };
 
 typedef std::pair<std::string, VertStore > 	TextCachePair;
@@ -163,6 +164,7 @@ protected:
 	TextShader		mTextShader;	// Text shader to be used for the rendering
 	TextCacheTable	mTextCache;	// using text cache re using vertex buffers for specific text.
 	BlendType		mBlendType;	// blend parameters for th text.
+	GLuint			mCachedVertexbuffer;	// GL buffer of the vertices last returned by getVertices, 0 if not cached
 };
 
 #endif /* TEXT_H_ */
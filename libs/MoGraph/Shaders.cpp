@@ -40,35 +40,18 @@ limitations under the License.
 
 /**
  * \brief vertexShaderBars,		vertex shader for building up the bars in 3D space.
+ * \note position, height and color of the bars are already baked into the vertices, see BarMgr::buildChunk
  */
 	// BARS VERTEX SHADER
 	char vertexShaderBars[]=STRINGIFY(
 		attribute vec4 vPosition;
+		attribute vec4 vColor;
 		uniform mat4 ProjViewWorld;
-		uniform vec4 TPos;
-		uniform vec3 ScaleV;
-		uniform vec4 Color;
 		varying vec4 v_color;
 		void main( void )
 		{
-			mat4 sm  	= mat4(1.0);
-			sm[3][0]	= TPos.x;
-			sm[3][1]	= TPos.y;
-			sm[3][2]	= TPos.z;
-			if (ScaleV.y >= 0.0)
-			{
-				sm[0][0] 	= ScaleV.x;
-				sm[1][1] 	= ScaleV.y;
-				sm[2][2] 	= ScaleV.z;
-			}
-			else
-			{
-				sm[0][0] 	= -ScaleV.x;
-				sm[1][1] 	= ScaleV.y;
-				sm[2][2] 	= ScaleV.z;
-			}
-			v_color  	= vec4(Color.x*vPosition.y, Color.y*vPosition.y, Color.z*vPosition.y, Color.w);
-			gl_Position = (ProjViewWorld * sm) * vPosition;
+			v_color  	= vColor;
+			gl_Position = ProjViewWorld * vPosition;
 		}
 	);
 
@@ -352,10 +335,8 @@ void BarShader::init()
 	mTimeLoc 		= glGetUniformLocation(mShader, "time");			// time tick variable (fragment)
 	mResolutionLoc 	= glGetUniformLocation(mShader, "resolution");		// constant resolution of screen (fragment)
 	mMatrixPVW 		= glGetUniformLocation(mShader, "ProjViewWorld");	// Projection*View*World Matrix
-	mTPos			= glGetUniformLocation(mShader, "TPos");			// Translate vector postion
-	mScaleV			= glGetUniformLocation(mShader, "ScaleV");			// scale vector (height of bar)
-	mColor			= glGetUniformLocation(mShader, "Color");			// Color of one bar (vertex shader)
 	mAttribVtxLoc	= glGetAttribLocation( mShader, "vPosition");		// input vertex attrib
+	mAttribColorLoc	= glGetAttribLocation( mShader, "vColor");			// input color attrib
 	lprintfln("BarShader::init: initiate");
 }
 
@@ -51,14 +51,11 @@ struct BarShader : public Shader
 
 	GLuint 	mShader;			// shader for bars
 	GLuint 	mAttribVtxLoc;		// Attribute to the vertex shader of vpos location
+	GLuint 	mAttribColorLoc;	// Attribute to the vertex shader of color location
 	GLuint 	mTimeLoc;			// time tick variable for shaders (fragment)
 	GLuint 	mResolutionLoc;		// screen resulution
 	GLuint 	mMatrixPVW;			// Shader Perspective Projection
-	GLuint	mTPos;				// Translate position
-	GLuint 	mScaleV;			// Scale vector of bars. its height...
-	GLuint	mColor;				// individual color of a bar.
-	GLuint 	mElementbuffer;		// Element buffer holding the index buffer for bars
-	GLuint 	mVertexbuffer;		// Vertex buffer for bars. (cube)
+	GLuint 	mElementbuffer;		// Element buffer holding the index buffer for a chunk of bars
 
 	/**
 	 * \brief,	init, initiate loads shader and setsup each parameter locations
@@ -42,7 +42,9 @@ struct Text
 {
 	Text() :
 		mTextFlagX(CENTER_LEFT),
-		mTextFlagY(CENTER_Y)
+		mTextFlagY(CENTER_Y),
+		mLayoutWidth(0.0f),
+		mLayoutLineHeight(0.0f)
 	{
 
 	}
@@ -63,6 +65,12 @@ struct Text
 	glm::vec4 		mColor;			// Text color
 	glm::vec2		mScale;			// Text scale
 	glm::vec3		mRotate;		// Rotation in degrees. prio Yaw Pitch Roll
+
+	// measured size of the text, used for aligning it. only remeasured when mText or mScale changes.
+	std::string		mLayoutText;	// mText when measured
+	glm::vec2		mLayoutScale;	// mScale when measured
+	float			mLayoutWidth;	// text width
+	float			mLayoutLineHeight;	// text line height
 };
 
 
@@ -112,6 +112,13 @@ public:
 	virtual void testFailed ( const char *f,
 							  int l,
 							  const char *a );
+
+	/**
+	 * Notifies the listener of the result of a benchmark
+	 *
+	 * @param r Result, times in microseconds per iteration
+	 */
+	virtual void benchmark ( const MATest::BenchmarkResult &r );
 };
 
 NAMESPACE_END
@@ -29,6 +29,7 @@ Software Foundation, 59 Temple Place - Suite 330, Boston, MA
 #include "common.h"
 #include "bind.hpp"
 #include "test.hpp"
+#include <MATest/Benchmark.h>
 
 NAMESPACE_BEGIN( Testify )
 
@@ -66,6 +67,56 @@ public:
 	virtual void run ( void );
 };
 
+/**
+ * @brief A wrapper for a benchmark function. The function is one
+ * iteration of the benchmark. It is measured with MATest::Benchmark
+ * and compared with MATest::Benchmark::getBaseline( ).
+ *
+ */
+class BenchmarkFunction : public Test, private MATest::Benchmark
+{
+private:
+	const char *m_name;
+	Functor *	m_test;
+	char		m_message[128];
+	MATest::BenchmarkOptions m_options;
+
+	/**
+	 * Runs the benchmark function i times
+	 *
+	 * @param i Number of iterations
+	 */
+	virtual void run ( int i );
+
+public:
+	/**
+	 * Constructor
+	 *
+	 * @param f Pointer to a functor which contains one iteration
+	 * @param n Benchmark name, default value is 'no_name_benchmark'
+	 */
+	BenchmarkFunction ( Functor *f,
+						const char *n = "no_name_benchmark" );
+
+	/**
+	 * Destructor
+	 */
+	virtual ~BenchmarkFunction ( void );
+
+	/**
+	 * Measures the benchmark, fails the test on a regression
+	 *
+	 */
+	virtual void run ( void );
+
+	/**
+	 * Returns the options used for measuring
+	 *
+	 * @return Reference to options
+	 */
+	MATest::BenchmarkOptions &getOptions ( void );
+};
+
 NAMESPACE_END
 
 #endif 	// __TESTIFY_TESTFUNCTION_HPP__
@@ -68,5 +68,11 @@ Software Foundation, 59 Temple Place - Suite 330, Boston, MA
 	static TestHook hook_##name( Testify::bind( name ), #name ); \
 	void name ( void )
 
+// Declares a benchmark function, which is one iteration of the benchmark
+#define TESTIFY_DECL_BENCHMARK_FUNC( name ) \
+	void name ( void ); \
+	static TestHook hook_##name( new Testify::BenchmarkFunction( Testify::bind( name ), #name ) ); \
+	void name ( void )
+
 
 #endif /* __TESTIFY_HPP__ */
@@ -28,6 +28,11 @@ Software Foundation, 59 Temple Place - Suite 330, Boston, MA
 
 #include "common.h"
 
+namespace MATest
+{
+	struct BenchmarkResult;
+}
+
 NAMESPACE_BEGIN( Testify )
 
 /**
@@ -100,6 +105,14 @@ public:
 	virtual void testFailed ( const char *f,
 							  int l,
 							  const char *a ) = 0;
+
+	/**
+	 * Notifies the listener of the result of a benchmark.
+	 * Does nothing by default.
+	 *
+	 * @param r Result, times in microseconds per iteration
+	 */
+	virtual void benchmark ( const MATest::BenchmarkResult &r ) { }
 };
 
 NAMESPACE_END
@@ -31,12 +31,18 @@ Software Foundation, 59 Temple Place - Suite 330, Boston, MA
 #include <MAUtil/Vector.h>
 #include <MAUtil/collection_common.h>
 
+namespace MATest
+{
+	struct BenchmarkResult;
+}
+
 NAMESPACE_BEGIN( Testify )
 
 class Test;
 class TestCase;
 class TestHook;
 class TestFunction;
+class BenchmarkFunction;
 class TestListener;
 
 using MAUtil::Pair;
@@ -57,6 +63,7 @@ class TestManager
 	friend class TestHook;
 	friend class TestCase;
 	friend class TestFunction;
+	friend class BenchmarkFunction;
 
 
 private:
@@ -130,6 +137,13 @@ private:
 	 */
 	void endTest ( void );
 
+	/**
+	 * Notifies the listeners of the result of a benchmark
+	 *
+	 * @param r Benchmark result
+	 */
+	void benchmark ( const MATest::BenchmarkResult &r );
+
 	/**
 	 * Adds a test to a suite
 	 *
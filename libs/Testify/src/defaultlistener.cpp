@@ -24,6 +24,7 @@ Software Foundation, 59 Temple Place - Suite 330, Boston, MA
 #include <conprint.h>
 #endif
 
+#include <MATest/Benchmark.h>
 #include "defaultlistener.hpp"
 
 NAMESPACE_BEGIN( Testify )
@@ -143,6 +144,19 @@ void DefaultListener::testFailed ( const char *f,
 	indentDec( );
 }
 
+/**
+ * Notifies the listener of the result of a benchmark
+ *
+ * @param r Result, times in microseconds per iteration
+ */
+void DefaultListener::benchmark ( const MATest::BenchmarkResult &r )
+{
+	printf( "median %.3f us, p95 %.3f us, min %.3f us...",
+			r.median, r.p95, r.min );
+	if ( r.baseline > 0 )
+		printf( "baseline %.3f us...", r.baseline );
+}
+
 /**
  * Internal, increase indentation level
  */
@@ -16,6 +16,7 @@ Software Foundation, 59 Temple Place - Suite 330, Boston, MA
 */
 #include <maapi.h>
 #include <conprint.h>
+#include <MATest/Benchmark.h>
 #include "idelistener.hpp"
 
 NAMESPACE_BEGIN( Testify )
@@ -121,6 +122,21 @@ void IDEListener::testFailed ( const char *f,
     	maWriteLog( m_buffer, len );
 }
 
+/**
+ * Notifies the listener of the result of a benchmark
+ *
+ * @param r Result, times in microseconds per iteration
+ */
+void IDEListener::benchmark ( const MATest::BenchmarkResult &r )
+{
+	int len = sprintf( m_buffer, "__TEST_MARKUP__<benchmark iterations=\"%d\" "
+					   "samples=\"%d\" outliers=\"%d\" min=\"%.3f\" median=\"%.3f\" "
+					   "p95=\"%.3f\" mean=\"%.3f\" baseline=\"%.3f\"/>",
+					   r.iterations, r.samples, r.outliers, r.min, r.median,
+					   r.p95, r.mean, r.baseline );
+	maWriteLog( m_buffer, len );
+}
+
 
 
 NAMESPACE_END
@@ -14,6 +14,8 @@ along with this program; see the file COPYING.  If not, write to the Free
 Software Foundation, 59 Temple Place - Suite 330, Boston, MA
 02111-1307, USA.
 */
+#include <mavsprintf.h>
+
 #include "common.h"
 #include "bind.hpp"
 #include "test.hpp"
@@ -56,4 +58,67 @@ void TestFunction::run ( void )
 	TestManager::getInstance( )->endTest( );
 }
 
+/**
+ * Constructor
+ *
+ * @param f Pointer to a functor which contains one iteration
+ * @param n Benchmark name, default value is 'no_name_benchmark'
+ */
+BenchmarkFunction::BenchmarkFunction ( Functor *f,
+									   const char *n )
+{
+	m_test = f;
+	m_name = n;
+}
+
+/**
+ * Destructor
+ *
+ */
+BenchmarkFunction::~BenchmarkFunction ( void )
+{
+	delete m_test;
+}
+
+/**
+ * Runs the benchmark function i times
+ *
+ * @param i Number of iterations
+ */
+void BenchmarkFunction::run ( int i )
+{
+	while ( i-- > 0 )
+		(*m_test)( );
+}
+
+/**
+ * Measures the benchmark, fails the test on a regression
+ *
+ */
+void BenchmarkFunction::run ( void )
+{
+	MATest::BenchmarkResult r;
+
+	TestManager::getInstance( )->beginTest( m_name );
+	measure( m_name, m_options, getBaseline( ), r );
+	TestManager::getInstance( )->benchmark( r );
+	if ( r.regression == true )
+	{
+		sprintf( m_message, "median %.3f us > baseline %.3f us",
+				 r.median, r.baseline );
+		TestManager::getInstance( )->testFailed( m_name, 0, m_message );
+	}
+	TestManager::getInstance( )->endTest( );
+}
+
+/**
+ * Returns the options used for measuring
+ *
+ * @return Reference to options
+ */
+MATest::BenchmarkOptions &BenchmarkFunction::getOptions ( void )
+{
+	return m_options;
+}
+
 NAMESPACE_END
@@ -144,6 +144,17 @@ void TestManager::endTest ( void )
 }
 
 
+/**
+ * Notifies the listeners of the result of a benchmark
+ *
+ * @param r Benchmark result
+ */
+void TestManager::benchmark ( const MATest::BenchmarkResult &r )
+{
+	for ( int i = 0; i < m_listenerList.size( ); i++ )
+		m_listenerList[i]->benchmark( r );
+}
+
 /**
  * Tells the test manager that the current
  * test has failed
@@ -42,7 +42,19 @@ void FunTable::addMessageFun(
 	const char* command,
 	MessageHandlerFun fun)
 {
-	mFunMap[command] = fun;
+	bool found;
+	int index = findEntry(command, &found);
+	if (found)
+	{
+		mFunEntries[index].fun = fun;
+	}
+	else
+	{
+		Entry entry;
+		entry.command = command;
+		entry.fun = fun;
+		mFunEntries.insert(index, entry);
+	}
 }
 
 void FunTable::callMessageFun(
@@ -50,9 +62,11 @@ void FunTable::callMessageFun(
 	Wormhole::MessageStream& stream,
 	FunObject* object)
 {
-	if (mFunMap.find(command) != mFunMap.end())
+	bool found;
+	int index = findEntry(command, &found);
+	if (found)
 	{
-		MessageHandlerFun fun = mFunMap[command];
+		MessageHandlerFun fun = mFunEntries[index].fun;
 		(object->*fun)(stream);
 	}
 	else
@@ -63,4 +77,31 @@ void FunTable::callMessageFun(
 	}
 }
 
+int FunTable::findEntry(const char* command, bool* found)
+{
+	// Binary search.
+	int low = 0;
+	int high = mFunEntries.size();
+	while (low < high)
+	{
+		int mid = (low + high) / 2;
+		int result = strcmp(mFunEntries[mid].command.c_str(), command);
+		if (0 == result)
+		{
+			*found = true;
+			return mid;
+		}
+		if (result < 0)
+		{
+			low = mid + 1;
+		}
+		else
+		{
+			high = mid;
+		}
+	}
+	*found = false;
+	return low;
+}
+
 } // namespace
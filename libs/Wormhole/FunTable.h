@@ -34,7 +34,7 @@ limitations under the License.
 #include <Wormhole/Libs/JSNativeUI/ResourceMessageHandler.h>
 #include <Wormhole/Encoder.h>
 #include <MAUtil/String.h>
-#include <MAUtil/HashMap.h>
+#include <MAUtil/Vector.h>
 
 namespace Wormhole
 {
@@ -74,10 +74,28 @@ public:
 
 protected:
 	/**
-	 * Dictionary with pointers to message handler functions.
-	 * command -> fun
+	 * A command and its message handler function.
 	 */
-	MAUtil::HashMap<MAUtil::String, MessageHandlerFun> mFunMap;
+	struct Entry
+	{
+		MAUtil::String command;
+		MessageHandlerFun fun;
+	};
+
+	/**
+	 * Find the index of a command in mFunEntries.
+	 * @param found Set to true if the command was found.
+	 * @return The index of the command, or the index where
+	 * it should be inserted.
+	 */
+	int findEntry(const char* command, bool* found);
+
+	/**
+	 * Pointers to message handler functions, sorted by command.
+	 * Looked up with the strings in the message data, so that
+	 * dispatch does not create String objects.
+	 */
+	MAUtil::Vector<Entry> mFunEntries;
 };
 
 } // namespace
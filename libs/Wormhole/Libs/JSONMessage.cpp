@@ -55,89 +55,43 @@ namespace Wormhole
 	{
 	}
 
+	// The args are read from the decoder's arena, so that
+	// the YAJLDom tree is not built for these accessors.
+
 	MAUtil::String JSONMessage::getArgsField(const MAUtil::String& fieldName)
 	{
-		YAJLDom::Value* argsNode = getParamNode("args");
-		if (NULL != argsNode && YAJLDom::Value::MAP == argsNode->getType())
-		{
-			YAJLDom::Value* value = argsNode->getValueForKey(fieldName.c_str());
-			if (NULL != value && YAJLDom::Value::STRING == value->getType())
-			{
-				return value->toString();
-			}
-		}
-		return "";
+		return toString(mDecoder->getValueForKey(
+			getParamValue("args"), fieldName.c_str()));
 	}
 
 	int JSONMessage::getArgsFieldInt(const MAUtil::String& fieldName)
 	{
-		YAJLDom::Value* argsNode = getParamNode("args");
-		if (NULL != argsNode && YAJLDom::Value::MAP == argsNode->getType())
-		{
-			YAJLDom::Value* value = argsNode->getValueForKey(fieldName.c_str());
-			if (NULL != value && YAJLDom::Value::NUMBER == value->getType())
-			{
-				return value->toInt();
-			}
-		}
-		return 0;
+		return mDecoder->toInt(mDecoder->getValueForKey(
+			getParamValue("args"), fieldName.c_str()));
 	}
 
 	MAUtil::String JSONMessage::getArgsField(int index)
 	{
-		YAJLDom::Value* argsNode = getParamNode("args");
-		if (NULL != argsNode && YAJLDom::Value::ARRAY == argsNode->getType())
-		{
-			YAJLDom::Value* value = argsNode->getValueByIndex(index);
-			if (NULL != value && YAJLDom::Value::STRING == value->getType())
-			{
-				return value->toString();
-			}
-		}
-		return "";
+		return toString(mDecoder->getValueByIndex(
+			getParamValue("args"), index));
 	}
 
 	int JSONMessage::getArgsFieldInt(int index)
 	{
-		YAJLDom::Value* argsNode = getParamNode("args");
-		if (NULL != argsNode && YAJLDom::Value::ARRAY == argsNode->getType())
-		{
-			YAJLDom::Value* value = argsNode->getValueByIndex(index);
-			if (NULL != value && YAJLDom::Value::NUMBER == value->getType())
-			{
-				return value->toInt();
-			}
-		}
-		return 0;
+		return mDecoder->toInt(mDecoder->getValueByIndex(
+			getParamValue("args"), index));
 	}
 
-
 	bool JSONMessage::getArgsFieldBool(const MAUtil::String& fieldName)
 	{
-		YAJLDom::Value* argsNode = getParamNode("args");
-		if (NULL != argsNode && YAJLDom::Value::MAP == argsNode->getType())
-		{
-			YAJLDom::Value* value = argsNode->getValueForKey(fieldName.c_str());
-			if (NULL != value && YAJLDom::Value::BOOLEAN == value->getType())
-			{
-				return value->toBoolean();
-			}
-		}
-		return false;
+		return mDecoder->toBoolean(mDecoder->getValueForKey(
+			getParamValue("args"), fieldName.c_str()));
 	}
 
 	bool JSONMessage::getArgsFieldBool(int index)
 	{
-		YAJLDom::Value* argsNode = getParamNode("args");
-		if (NULL != argsNode && YAJLDom::Value::ARRAY == argsNode->getType())
-		{
-			YAJLDom::Value* value = argsNode->getValueByIndex(index);
-			if (NULL != value && YAJLDom::Value::BOOLEAN == value->getType())
-			{
-				return value->toBoolean();
-			}
-		}
-		return false;
+		return mDecoder->toBoolean(mDecoder->getValueByIndex(
+			getParamValue("args"), index));
 	}
 
 } // namespace
@@ -0,0 +1,683 @@
+/* Copyright 2013 David Axmark
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+	http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+/**
+ * @file MessageDecoder.cpp
+ *
+ * Decoder for batches of messages from a WebView, that
+ * parses the message data in place.
+ */
+
+#include <ma.h>				// MoSync API
+#include <maheap.h>			// C memory allocation
+#include <mastring.h>		// C string functions
+
+#include "MessageDecoder.h"
+
+// Maximum nesting of JSON arrays and maps.
+#define MAX_DEPTH 32
+
+// Initial size of the JSON arena, in values.
+#define INITIAL_VALUE_CAPACITY 64
+
+namespace Wormhole
+{
+	/**
+	 * The decoder returned by acquire() when it is not in use.
+	 */
+	static MessageDecoder* sSharedDecoder = NULL;
+
+	bool StringView::equals(const char* s) const
+	{
+		return 0 == strncmp(data, s, length) && 0 == s[length];
+	}
+
+	static bool isHexDigit(char c)
+	{
+		return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'f') ||
+			(c >= 'A' && c <= 'F');
+	}
+
+	/**
+	 * Decodes one character of a JSON string, which may be an escape
+	 * sequence, into UTF-8. The string must have been checked by
+	 * parseString().
+	 * @param p The character. Moved past it.
+	 * @param out Receives the UTF-8 bytes.
+	 * @return The number of bytes in \a out.
+	 */
+	static int unescapeChar(const char*& p, char* out)
+	{
+		if ('\\' != *p)
+		{
+			*out = *p++;
+			return 1;
+		}
+		p++;
+		char c = *p++;
+		switch (c)
+		{
+			case 'b': *out = '\b'; return 1;
+			case 'f': *out = '\f'; return 1;
+			case 'n': *out = '\n'; return 1;
+			case 'r': *out = '\r'; return 1;
+			case 't': *out = '\t'; return 1;
+			case 'u': break;
+			default: *out = c; return 1;
+		}
+
+		// \uXXXX, possibly a surrogate pair.
+		unsigned int code = 0;
+		for (int i = 0; i < 4; i++)
+		{
+			char h = *p++;
+			code <<= 4;
+			if (h >= '0' && h <= '9') code |= h - '0';
+			else if (h >= 'a' && h <= 'f') code |= h - 'a' + 10;
+			else if (h >= 'A' && h <= 'F') code |= h - 'A' + 10;
+		}
+		if (code >= 0xD800 && code < 0xDC00 && '\\' == p[0] && 'u' == p[1])
+		{
+			const char* q = p + 2;
+			unsigned int low = 0;
+			for (int i = 0; i < 4; i++)
+			{
+				char h = *q++;
+				low <<= 4;
+				if (h >= '0' && h <= '9') low |= h - '0';
+				else if (h >= 'a' && h <= 'f') low |= h - 'a' + 10;
+				else if (h >= 'A' && h <= 'F') low |= h - 'A' + 10;
+			}
+			if (low >= 0xDC00 && low < 0xE000)
+			{
+				code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+				p = q;
+			}
+		}
+
+		if (code < 0x80)
+		{
+			out[0] = (char)code;
+			return 1;
+		}
+		if (code < 0x800)
+		{
+			out[0] = (char)(0xC0 | (code >> 6));
+			out[1] = (char)(0x80 | (code & 0x3F));
+			return 2;
+		}
+		if (code < 0x10000)
+		{
+			out[0] = (char)(0xE0 | (code >> 12));
+			out[1] = (char)(0x80 | ((code >> 6) & 0x3F));
+			out[2] = (char)(0x80 | (code & 0x3F));
+			return 3;
+		}
+		out[0] = (char)(0xF0 | (code >> 18));
+		out[1] = (char)(0x80 | ((code >> 12) & 0x3F));
+		out[2] = (char)(0x80 | ((code >> 6) & 0x3F));
+		out[3] = (char)(0x80 | (code & 0x3F));
+		return 4;
+	}
+
+	MessageDecoder::MessageDecoder() :
+		mBuffer(NULL),
+		mCapacity(0),
+		mSize(0),
+		mProtocol(PROTOCOL_NONE),
+		mPos(NULL),
+		mValues(NULL),
+		mValueCount(0),
+		mValueCapacity(0),
+		mParsed(false),
+		mAllocationCount(0),
+		mInUse(false)
+	{
+	}
+
+	MessageDecoder::~MessageDecoder()
+	{
+		free(mBuffer);
+		free(mValues);
+	}
+
+	MessageDecoder* MessageDecoder::acquire()
+	{
+		if (NULL == sSharedDecoder)
+		{
+			sSharedDecoder = new MessageDecoder();
+		}
+		if (sSharedDecoder->mInUse)
+		{
+			// A message is handled while another one is in progress.
+			MessageDecoder* decoder = new MessageDecoder();
+			decoder->mInUse = true;
+			return decoder;
+		}
+		sSharedDecoder->mInUse = true;
+		return sSharedDecoder;
+	}
+
+	void MessageDecoder::release(MessageDecoder* decoder)
+	{
+		if (NULL == decoder)
+		{
+			return;
+		}
+		if (decoder != sSharedDecoder)
+		{
+			delete decoder;
+			return;
+		}
+		decoder->mInUse = false;
+		decoder->mProtocol = PROTOCOL_NONE;
+		decoder->mParsed = false;
+	}
+
+	MessageDecoder::Protocol MessageDecoder::load(MAHandle dataHandle)
+	{
+		mProtocol = PROTOCOL_NONE;
+		mParsed = false;
+		if (NULL == dataHandle)
+		{
+			return mProtocol;
+		}
+
+		// Get length of the data, it is not zero terminated.
+		int size = maGetDataSize(dataHandle);
+		if (!reserve(size + 1))
+		{
+			return mProtocol;
+		}
+		maReadData(dataHandle, mBuffer, 0, size);
+		return load(NULL, size);
+	}
+
+	MessageDecoder::Protocol MessageDecoder::load(const char* data, int size)
+	{
+		mProtocol = PROTOCOL_NONE;
+		mParsed = false;
+		if (NULL != data)
+		{
+			if (!reserve(size + 1))
+			{
+				return mProtocol;
+			}
+			memcpy(mBuffer, data, size);
+		}
+		mBuffer[size] = 0;
+		mSize = size;
+
+		if (size >= 3 && 'm' == mBuffer[0] && ':' == mBuffer[2])
+		{
+			if ('s' == mBuffer[1])
+			{
+				mProtocol = PROTOCOL_STREAM;
+			}
+			else if ('a' == mBuffer[1])
+			{
+				mProtocol = PROTOCOL_JSON;
+			}
+		}
+		mPos = mBuffer + 3;
+		return mProtocol;
+	}
+
+	MessageDecoder::Protocol MessageDecoder::getProtocol() const
+	{
+		return mProtocol;
+	}
+
+	const char* MessageDecoder::getData() const
+	{
+		return mBuffer;
+	}
+
+	int MessageDecoder::getSize() const
+	{
+		return mSize;
+	}
+
+	const char* MessageDecoder::nextString(int* length)
+	{
+		if (PROTOCOL_STREAM != mProtocol)
+		{
+			return NULL;
+		}
+
+		char* end = mBuffer + mSize;
+		char* p = mPos;
+
+		// The length is encoded in up to five base 93 digits,
+		// least significant first, followed by a space.
+		int len = 0;
+		int factor = 1;
+		int i;
+		for (i = 0; p + i < end && ' ' != p[i]; i++)
+		{
+			if (i > 4)
+			{
+				mPos = end;
+				return NULL;
+			}
+			len += factor * (p[i] - 33);
+			factor *= 93;
+		}
+		p += i;
+
+		// There must be a separator after the string, which is
+		// overwritten by the terminating zero.
+		char* start = p + 1;
+		if (p >= end || len < 0 || len >= end - start)
+		{
+			mPos = end;
+			return NULL;
+		}
+		start[len] = 0;
+		mPos = start + len + 1;
+
+		if (NULL != length)
+		{
+			*length = len;
+		}
+		return start;
+	}
+
+	bool MessageDecoder::parseJSON()
+	{
+		mParsed = false;
+		mValueCount = 0;
+		if (PROTOCOL_JSON != mProtocol)
+		{
+			return false;
+		}
+
+		int parents[MAX_DEPTH];
+		int lastChild[MAX_DEPTH];
+		int depth = 0;
+		const char* end = mBuffer + mSize;
+		const char* p = mBuffer + 3;
+
+		for (;;)
+		{
+			// Read a value.
+			p = skipSpace(p);
+			if (p >= end)
+			{
+				return false;
+			}
+			int parent = depth > 0 ? parents[depth - 1] : -1;
+			if (parent >= 0 && JSONValue::MAP == mValues[parent].type &&
+				0 == mValues[parent].count % 2 && '"' != *p)
+			{
+				// Map keys must be strings.
+				return false;
+			}
+
+			int index;
+			bool container = false;
+			char c = *p;
+			if ('"' == c)
+			{
+				index = addValue(JSONValue::STRING, p);
+				if (index < 0)
+				{
+					return false;
+				}
+				p = parseString(p, mValues[index]);
+				if (NULL == p)
+				{
+					return false;
+				}
+			}
+			else if ('[' == c || '{' == c)
+			{
+				index = addValue('[' == c ? JSONValue::ARRAY : JSONValue::MAP, p);
+				container = true;
+				p++;
+			}
+			else if ('t' == c || 'f' == c || 'n' == c)
+			{
+				const char* literal = 't' == c ? "true" : ('f' == c ? "false" : "null");
+				int len = strlen(literal);
+				if (end - p < len || 0 != strncmp(p, literal, len))
+				{
+					return false;
+				}
+				index = addValue('n' == c ? JSONValue::NUL : JSONValue::BOOLEAN, p);
+				p += len;
+			}
+			else if ('-' == c || (c >= '0' && c <= '9'))
+			{
+				index = addValue(JSONValue::NUMBER, p);
+				while (p < end && ((*p >= '0' && *p <= '9') ||
+					'-' == *p || '+' == *p || '.' == *p || 'e' == *p || 'E' == *p))
+				{
+					p++;
+				}
+			}
+			else
+			{
+				return false;
+			}
+			if (index < 0)
+			{
+				return false;
+			}
+			if (!container && JSONValue::STRING != mValues[index].type)
+			{
+				mValues[index].text.length = p - mValues[index].text.data;
+			}
+
+			// Link it to its parent.
+			if (parent >= 0)
+			{
+				if (lastChild[depth - 1] >= 0)
+				{
+					mValues[lastChild[depth - 1]].next = index;
+				}
+				lastChild[depth - 1] = index;
+				mValues[parent].count++;
+			}
+
+			if (container)
+			{
+				if (MAX_DEPTH == depth)
+				{
+					return false;
+				}
+				parents[depth] = index;
+				lastChild[depth] = -1;
+				depth++;
+				p = skipSpace(p);
+				if (']' != *p && '}' != *p)
+				{
+					// Read the first child.
+					continue;
+				}
+			}
+
+			// Handle separators and the ends of containers.
+			for (;;)
+			{
+				p = skipSpace(p);
+				if (0 == depth)
+				{
+					if (p != end)
+					{
+						return false;
+					}
+					mParsed = true;
+					return true;
+				}
+				JSONValue& current = mValues[parents[depth - 1]];
+				bool isMap = JSONValue::MAP == current.type;
+				if (isMap && 1 == current.count % 2)
+				{
+					// After a key.
+					if (':' != *p)
+					{
+						return false;
+					}
+					p++;
+					break;
+				}
+				if (',' == *p)
+				{
+					p++;
+					break;
+				}
+				if ((isMap ? '}' : ']') != *p)
+				{
+					return false;
+				}
+				p++;
+				current.text.length = p - current.text.data;
+				depth--;
+			}
+		}
+	}
+
+	const JSONValue* MessageDecoder::getRoot() const
+	{
+		return mParsed ? mValues : NULL;
+	}
+
+	const JSONValue* MessageDecoder::getFirstChild(const JSONValue* value) const
+	{
+		if (NULL == value || 0 == value->count)
+		{
+			return NULL;
+		}
+		return value + 1;
+	}
+
+	const JSONValue* MessageDecoder::getNextSibling(const JSONValue* value) const
+	{
+		if (NULL == value || value->next < 0)
+		{
+			return NULL;
+		}
+		return mValues + value->next;
+	}
+
+	const JSONValue* MessageDecoder::getValueByIndex(
+		const JSONValue* array,
+		int index) const
+	{
+		if (NULL == array || JSONValue::ARRAY != array->type ||
+			index < 0 || index >= array->count)
+		{
+			return NULL;
+		}
+		const JSONValue* value = getFirstChild(array);
+		while (index-- > 0)
+		{
+			value = getNextSibling(value);
+		}
+		return value;
+	}
+
+	const JSONValue* MessageDecoder::getValueForKey(
+		const JSONValue* map,
+		const char* key) const
+	{
+		if (NULL == map || JSONValue::MAP != map->type)
+		{
+			return NULL;
+		}
+		const JSONValue* result = NULL;
+		const JSONValue* k = getFirstChild(map);
+		while (NULL != k)
+		{
+			const JSONValue* v = getNextSibling(k);
+			if (stringEquals(k, key))
+			{
+				result = v;
+			}
+			k = getNextSibling(v);
+		}
+		return result;
+	}
+
+	int MessageDecoder::copyString(const JSONValue* value, char* dst) const
+	{
+		const char* p = value->text.data;
+		const char* end = p + value->text.length;
+		if (!value->escaped)
+		{
+			if (NULL != dst)
+			{
+				memcpy(dst, p, value->text.length);
+				dst[value->text.length] = 0;
+			}
+			return value->text.length;
+		}
+
+		int len = 0;
+		char buf[4];
+		while (p < end)
+		{
+			int n = unescapeChar(p, NULL != dst ? dst + len : buf);
+			len += n;
+		}
+		if (NULL != dst)
+		{
+			dst[len] = 0;
+		}
+		return len;
+	}
+
+	bool MessageDecoder::stringEquals(const JSONValue* value, const char* s) const
+	{
+		if (NULL == value || JSONValue::STRING != value->type)
+		{
+			return false;
+		}
+		if (!value->escaped)
+		{
+			return value->text.equals(s);
+		}
+
+		const char* p = value->text.data;
+		const char* end = p + value->text.length;
+		char buf[4];
+		while (p < end)
+		{
+			int n = unescapeChar(p, buf);
+			if (0 != strncmp(buf, s, n))
+			{
+				return false;
+			}
+			s += n;
+		}
+		return 0 == *s;
+	}
+
+	int MessageDecoder::toInt(const JSONValue* value) const
+	{
+		if (NULL == value || JSONValue::NUMBER != value->type)
+		{
+			return 0;
+		}
+		// The number is followed by a character that ends it.
+		return (int) strtod(value->text.data, NULL);
+	}
+
+	bool MessageDecoder::toBoolean(const JSONValue* value) const
+	{
+		return NULL != value && JSONValue::BOOLEAN == value->type &&
+			't' == value->text.data[0];
+	}
+
+	int MessageDecoder::getAllocationCount() const
+	{
+		return mAllocationCount;
+	}
+
+	bool MessageDecoder::reserve(int size)
+	{
+		if (size <= mCapacity)
+		{
+			return true;
+		}
+		int capacity = mCapacity * 2;
+		if (capacity < size)
+		{
+			capacity = size;
+		}
+		char* buffer = (char*) realloc(mBuffer, capacity);
+		if (NULL == buffer)
+		{
+			return false;
+		}
+		mBuffer = buffer;
+		mCapacity = capacity;
+		mAllocationCount++;
+		return true;
+	}
+
+	int MessageDecoder::addValue(JSONValue::Type type, const char* start)
+	{
+		if (mValueCount == mValueCapacity)
+		{
+			int capacity = mValueCapacity > 0 ?
+				mValueCapacity * 2 : INITIAL_VALUE_CAPACITY;
+			JSONValue* values = (JSONValue*) realloc(
+				mValues, capacity * sizeof(JSONValue));
+			if (NULL == values)
+			{
+				return -1;
+			}
+			mValues = values;
+			mValueCapacity = capacity;
+			mAllocationCount++;
+		}
+		JSONValue& value = mValues[mValueCount];
+		value.type = type;
+		value.text.data = start;
+		value.text.length = 0;
+		value.escaped = false;
+		value.count = 0;
+		value.next = -1;
+		return mValueCount++;
+	}
+
+	const char* MessageDecoder::skipSpace(const char* p) const
+	{
+		const char* end = mBuffer + mSize;
+		while (p < end && (' ' == *p || '\t' == *p || '\n' == *p || '\r' == *p))
+		{
+			p++;
+		}
+		return p;
+	}
+
+	const char* MessageDecoder::parseString(const char* p, JSONValue& value)
+	{
+		const char* end = mBuffer + mSize;
+		p++;
+		value.text.data = p;
+		while (p < end && '"' != *p)
+		{
+			if ('\\' == *p)
+			{
+				value.escaped = true;
+				p++;
+				if (p < end && 'u' == *p)
+				{
+					// unescapeChar() reads the digits without looking
+					// for the end of the string.
+					for (int i = 1; i <= 4; i++)
+					{
+						if (p + i >= end || !isHexDigit(p[i]))
+						{
+							return NULL;
+						}
+					}
+					p += 4;
+				}
+			}
+			p++;
+		}
+		if (p >= end)
+		{
+			return NULL;
+		}
+		value.text.length = p - value.text.data;
+		return p + 1;
+	}
+
+} // namespace
@@ -0,0 +1,252 @@
+/* Copyright 2013 David Axmark
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+	http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+/*! \addtogroup WormHoleGroup
+ *  @{
+ */
+
+/** @defgroup WormHoleGroup Wormhole Library
+ *  @{
+ */
+
+/**
+ * @file MessageDecoder.h
+ *
+ * @brief Decoder for batches of messages from a WebView, that
+ * parses the message data in place.
+ */
+
+#ifndef WORMHOLE_MESSAGE_DECODER_H_
+#define WORMHOLE_MESSAGE_DECODER_H_
+
+#include <ma.h>
+
+namespace Wormhole
+{
+
+/**
+ * @brief A string inside a decoder's buffer.
+ * It is not zero terminated unless stated otherwise.
+ */
+struct StringView
+{
+	const char* data;
+	int length;
+
+	/**
+	 * @return true if the view has the same characters as \a s.
+	 */
+	bool equals(const char* s) const;
+};
+
+/**
+ * @brief A JSON value in a decoder's arena.
+ *
+ * The values are stored in document order. The first child of an array
+ * or map is the value right after it; the remaining children are linked
+ * with \a next. The children of a map alternate between keys and values.
+ */
+struct JSONValue
+{
+	enum Type { NUL, BOOLEAN, NUMBER, STRING, ARRAY, MAP };
+
+	Type type;
+
+	/**
+	 * The contents of a string, without the quotes and with any
+	 * escapes left in place, or the text of a number or literal.
+	 */
+	StringView text;
+
+	/**
+	 * true if the string contains escapes.
+	 */
+	bool escaped;
+
+	/**
+	 * The number of children. Map keys and values are counted separately.
+	 */
+	int count;
+
+	/**
+	 * The arena index of the next sibling, or -1.
+	 */
+	int next;
+};
+
+/**
+ * @brief Decodes a batch of messages, as passed in
+ * MAW_EVENT_WEB_VIEW_HOOK_INVOKED events.
+ *
+ * The message data is read into a buffer that is kept between batches,
+ * and parsed in place: strings are returned as views into the buffer
+ * and JSON values are stored in an arena that is also kept between batches.
+ * Once the buffer and arena have grown to fit the largest batch,
+ * decoding does not allocate memory.
+ *
+ * MessageStream and MessageStreamJSON use the shared decoder returned by
+ * acquire().
+ */
+class MessageDecoder
+{
+public:
+	enum Protocol
+	{
+		PROTOCOL_NONE,
+		/**
+		 * ms:<length> <string> <length> <string>...
+		 */
+		PROTOCOL_STREAM,
+		/**
+		 * ma:[{"messageName":"message1",...},...]
+		 */
+		PROTOCOL_JSON
+	};
+
+	MessageDecoder();
+
+	virtual ~MessageDecoder();
+
+	/**
+	 * Returns the shared decoder if it is not in use, or else a new one.
+	 * Must be matched by a call to release().
+	 */
+	static MessageDecoder* acquire();
+
+	/**
+	 * Releases a decoder returned by acquire().
+	 */
+	static void release(MessageDecoder* decoder);
+
+	/**
+	 * Reads the data of a message batch into the buffer.
+	 * @return The protocol of the batch, PROTOCOL_NONE if unknown.
+	 */
+	Protocol load(MAHandle dataHandle);
+
+	/**
+	 * Copies a message batch into the buffer.
+	 * @return The protocol of the batch, PROTOCOL_NONE if unknown.
+	 */
+	Protocol load(const char* data, int size);
+
+	Protocol getProtocol() const;
+
+	/**
+	 * @return The batch data, zero terminated.
+	 */
+	const char* getData() const;
+
+	int getSize() const;
+
+	/**
+	 * Get the next string of a PROTOCOL_STREAM batch.
+	 * The string is zero terminated in place.
+	 *
+	 * @param length Set to the length of the string, unless NULL.
+	 * @return Pointer to the string, NULL if there are no more strings.
+	 */
+	const char* nextString(int* length = NULL);
+
+	/**
+	 * Parses the JSON array of a PROTOCOL_JSON batch into the arena.
+	 * The buffer is not modified.
+	 * @return true on success.
+	 */
+	bool parseJSON();
+
+	/**
+	 * @return The root value, NULL if parseJSON() failed.
+	 */
+	const JSONValue* getRoot() const;
+
+	/**
+	 * @return The first child of an array or map, NULL if it has none.
+	 */
+	const JSONValue* getFirstChild(const JSONValue* value) const;
+
+	/**
+	 * @return The next sibling of a value, NULL if it is the last one.
+	 */
+	const JSONValue* getNextSibling(const JSONValue* value) const;
+
+	/**
+	 * @return The child of an array at \a index, NULL if there is none.
+	 */
+	const JSONValue* getValueByIndex(const JSONValue* array, int index) const;
+
+	/**
+	 * @return The value of a map for \a key, NULL if there is none.
+	 * If the key occurs more than once, the last value is returned.
+	 */
+	const JSONValue* getValueForKey(const JSONValue* map, const char* key) const;
+
+	/**
+	 * Unescapes a string value.
+	 * @param dst Receives the unescaped string, zero terminated, unless NULL.
+	 * @return The length of the unescaped string.
+	 */
+	int copyString(const JSONValue* value, char* dst) const;
+
+	/**
+	 * @return true if a string value equals \a s.
+	 */
+	bool stringEquals(const JSONValue* value, const char* s) const;
+
+	/**
+	 * @return A number value truncated to an int, as YAJLDom's toInt().
+	 */
+	int toInt(const JSONValue* value) const;
+
+	/**
+	 * @return true for the literal "true".
+	 */
+	bool toBoolean(const JSONValue* value) const;
+
+	/**
+	 * @return The number of times the buffer or arena has been grown.
+	 */
+	int getAllocationCount() const;
+
+protected:
+	bool reserve(int size);
+	int addValue(JSONValue::Type type, const char* start);
+	const char* skipSpace(const char* p) const;
+	const char* parseString(const char* p, JSONValue& value);
+
+	char* mBuffer;
+	int mCapacity;
+	int mSize;
+	Protocol mProtocol;
+
+	/**
+	 * Position of the next string of a PROTOCOL_STREAM batch.
+	 */
+	char* mPos;
+
+	JSONValue* mValues;
+	int mValueCount;
+	int mValueCapacity;
+	bool mParsed;
+
+	int mAllocationCount;
+	bool mInUse;
+};
+
+} // namespace
+
+#endif
+
+/*! @} */
@@ -61,11 +61,11 @@ namespace Wormhole
 	 */
 	MessageStream::~MessageStream()
 	{
-		if (NULL != mData)
-		{
-			free(mData);
-			mData = NULL;
-		}
+		// The data is owned by the decoder, which is kept
+		// for the next message.
+		MessageDecoder::release(mDecoder);
+		mDecoder = NULL;
+		mData = NULL;
 	}
 
 	/**
@@ -118,36 +118,16 @@ namespace Wormhole
 	 */
 	const char* MessageStream::getNext(int* length)
 	{
-		char* p;
-
-		// If first call then start at beginning of data,
-		// else move forward one character.
-		if (NULL == mEnd)
-		{
-			// Move past the protocol specifier.
-			p = mData + 3;
-		}
-		else
-		{
-			p = mEnd + 1;
-		}
-
-//		lprintfln("value of p: %i", (int)p);
-
-		// Check boundary.
-		if (p - mData >= mDataSize)
+		if (NULL == mData)
 		{
-//			lprintfln("1: p - mData >= mDataSize");
 			return NULL;
 		}
 
-		// Get string length and updated pointer.
-		int len = xtoi(p, &p);
-
-		// Check boundary.
-		if (p - mData >= mDataSize)
+		// The decoder zero terminates the string in place.
+		int len;
+		const char* start = mDecoder->nextString(&len);
+		if (NULL == start)
 		{
-//			lprintfln("2: p - mData >= mDataSize");
 			return NULL;
 		}
 
@@ -157,27 +137,9 @@ namespace Wormhole
 			*length = len;
 		}
 
-//		lprintfln("String length: %i", len);
-
-		// Point p to start of string data.
-		mStart = p + 1;
-
-		// Point to end of string.
+		mStart = (char*) start;
 		mEnd = mStart + len;
 
-		// Check boundary.
-		if (mEnd - mData >= mDataSize)
-		{
-//			lprintfln("3: mEnd - mData >= mDataSize");
-			return NULL;
-		}
-
-		// Zero terminate string.
-		*mEnd = 0;
-
-		//lprintfln("@@@ mStart: %s", mStart);
-
-		// Return string start.
 		return mStart;
 	}
 
@@ -234,33 +196,22 @@ namespace Wormhole
 	void MessageStream::initialize(MAHandle dataHandle)
 	{
 		mData = NULL;
+		mDataSize = 0;
+		mStart = NULL;
+		mEnd = NULL;
+
+		// Read the data into the decoder's buffer, which is
+		// reused between messages.
+		mDecoder = MessageDecoder::acquire();
 
-		// We must have data.
-		if (NULL == dataHandle)
+		// Check that we have the "ms:" prefix.
+		if (MessageDecoder::PROTOCOL_STREAM != mDecoder->load(dataHandle))
 		{
 			return;
 		}
 
-		// Get length of the data, it is not zero terminated.
-		int dataSize = maGetDataSize(dataHandle);
-
-		// Allocate buffer for string data.
-		char* data = (char*) malloc(dataSize + 1);
-
-		// Get the data.
-		maReadData(dataHandle, data, 0, dataSize);
-
-		data[dataSize] = 0;
-
-		// Check that we have the "ms:" prefix.
-		if (data[0] != 'm') { return; }
-		if (data[1] != 's') { return; }
-		if (data[2] != ':') { return; }
-
-		mData = data;
-		mDataSize = dataSize;
-		mStart = NULL;
-		mEnd = NULL;
+		mData = (char*) mDecoder->getData();
+		mDataSize = mDecoder->getSize();
 	}
 
 } // namespace
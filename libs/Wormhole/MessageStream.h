@@ -33,6 +33,7 @@ limitations under the License.
 
 #include <ma.h>
 #include <NativeUI/WebView.h>
+#include "MessageDecoder.h"
 
 namespace Wormhole
 {
@@ -139,9 +140,15 @@ protected:
 	 */
 	NativeUI::WebView* mWebView;
 
+	/**
+	 * The decoder that holds the message data.
+	 */
+	MessageDecoder* mDecoder;
+
 	/**
 	 * Variables for internal use only, but made protected
 	 * if some future need for subclassing would arise.
+	 * mData points into the decoder's buffer.
 	 */
 	char* mData;
 	int mDataSize;
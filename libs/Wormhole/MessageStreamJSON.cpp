@@ -43,6 +43,10 @@ namespace Wormhole
 		mWebViewHandle = webViewHandle;
 		mWebView = NULL;
 		mCurrentMessageIndex = -1;
+		mCurrentMessage = NULL;
+		mJSONRoot = NULL;
+		mJSONRootBuilt = false;
+		mDecoder = MessageDecoder::acquire();
 		parse(dataHandle);
 	}
 
@@ -57,6 +61,10 @@ namespace Wormhole
 		mWebViewHandle = webView->getWidgetHandle();
 		mWebView = webView;
 		mCurrentMessageIndex = -1;
+		mCurrentMessage = NULL;
+		mJSONRoot = NULL;
+		mJSONRootBuilt = false;
+		mDecoder = MessageDecoder::acquire();
 		parse(dataHandle);
 	}
 
@@ -72,6 +80,10 @@ namespace Wormhole
 			YAJLDom::deleteValue(mJSONRoot);
 			mJSONRoot = NULL;
 		}
+
+		// The decoder is kept for the next message.
+		MessageDecoder::release(mDecoder);
+		mDecoder = NULL;
 	}
 
 	/**
@@ -116,12 +128,27 @@ namespace Wormhole
 	 */
 	bool MessageStreamJSON::next()
 	{
-		if (NULL != mJSONRoot && YAJLDom::Value::ARRAY == mJSONRoot->getType())
+		const JSONValue* root = mDecoder->getRoot();
+		if (NULL == root || JSONValue::ARRAY != root->type)
+		{
+			return false;
+		}
+
+		if (NULL == mCurrentMessage)
+		{
+			if (mCurrentMessageIndex >= 0)
+			{
+				// Already past the last message.
+				return false;
+			}
+			mCurrentMessage = mDecoder->getFirstChild(root);
+		}
+		else
 		{
-			++mCurrentMessageIndex;
-			return mCurrentMessageIndex < mJSONRoot->getNumChildValues();
+			mCurrentMessage = mDecoder->getNextSibling(mCurrentMessage);
 		}
-		return false;
+		++mCurrentMessageIndex;
+		return NULL != mCurrentMessage;
 	}
 
 	/**
@@ -129,25 +156,9 @@ namespace Wormhole
 	 */
 	bool MessageStreamJSON::is(const char* paramName)
 	{
-		YAJLDom::Value* value = getParamNode("messageName");
-		if (NULL != value && YAJLDom::Value::STRING == value->getType())
-		{
-		// Commented out code that was intended to be used with
-		// pointers into the unparsed JSON data. This was made as
-		// part of a project to remove creation of String objects
-		// from YAJLDom. But this was never finished. A problem
-		// with the raw string data is that it needs to be unstringified,
-		// and therefore one of the benefits of using raw data gets lost,
-		// you still need to create a new string. Code left here as a
-		// reference.
-//			YAJLDom::StringValue* stringValue = (YAJLDom::StringValue*) value;
-//			return 0 == strncmp(
-//				paramName,
-//				stringValue->getCharPointer(),
-//				stringValue->getLength());
-			return value->toString() == paramName;
-		}
-		return false;
+		// Compare with the string in the message data, this does
+		// not create a String object.
+		return mDecoder->stringEquals(getParamValue("messageName"), paramName);
 	}
 
 	/**
@@ -156,12 +167,7 @@ namespace Wormhole
 	 */
 	String MessageStreamJSON::getParam(const char* paramName)
 	{
-		YAJLDom::Value* value = getParamNode(paramName);
-		if (NULL != value && YAJLDom::Value::STRING == value->getType())
-		{
-			return value->toString();
-		}
-		return "";
+		return toString(getParamValue(paramName));
 	}
 
 	/**
@@ -170,12 +176,7 @@ namespace Wormhole
 	 */
 	int MessageStreamJSON::getParamInt(const char* paramName)
 	{
-		YAJLDom::Value* value = getParamNode(paramName);
-		if (NULL != value && YAJLDom::Value::NUMBER == value->getType())
-		{
-			return value->toInt();
-		}
-		return 0;
+		return mDecoder->toInt(getParamValue(paramName));
 	}
 
 	/**
@@ -183,8 +184,45 @@ namespace Wormhole
 	 */
 	bool MessageStreamJSON::hasParam(const char* paramName)
 	{
-		YAJLDom::Value* value = getParamNode(paramName);
-		return (NULL != value && YAJLDom::Value::NUL != value->getType());
+		const JSONValue* value = getParamValue(paramName);
+		return (NULL != value && JSONValue::NUL != value->type);
+	}
+
+	/**
+	 * Get the value of a top-level parameter in the current message,
+	 * without building the YAJLDom tree.
+	 */
+	const JSONValue* MessageStreamJSON::getParamValue(const char* paramName)
+	{
+		if (NULL != mCurrentMessage && JSONValue::MAP == mCurrentMessage->type)
+		{
+			return mDecoder->getValueForKey(mCurrentMessage, paramName);
+		}
+		return NULL;
+	}
+
+	/**
+	 * @return The decoder that holds the message data.
+	 */
+	MessageDecoder* MessageStreamJSON::getDecoder()
+	{
+		return mDecoder;
+	}
+
+	/**
+	 * @return The unescaped value of a string, or an empty
+	 * string if value is not a string.
+	 */
+	String MessageStreamJSON::toString(const JSONValue* value)
+	{
+		if (NULL != value && JSONValue::STRING == value->type)
+		{
+			String result;
+			result.resize(mDecoder->copyString(value, NULL));
+			mDecoder->copyString(value, result.pointer());
+			return result;
+		}
+		return "";
 	}
 
 	/**
@@ -192,9 +230,10 @@ namespace Wormhole
 	 */
 	YAJLDom::Value* MessageStreamJSON::getParamNode(const char* paramName)
 	{
-		if (NULL != mJSONRoot && YAJLDom::Value::ARRAY == mJSONRoot->getType())
+		YAJLDom::Value* root = getJSONRoot();
+		if (NULL != root && YAJLDom::Value::ARRAY == root->getType())
 		{
-			YAJLDom::Value* message = mJSONRoot->getValueByIndex(mCurrentMessageIndex);
+			YAJLDom::Value* message = root->getValueByIndex(mCurrentMessageIndex);
 			if (YAJLDom::Value::MAP == message->getType())
 			{
 				return message->getValueForKey(paramName);
@@ -208,53 +247,44 @@ namespace Wormhole
 	 */
 	MAUtil::YAJLDom::Value* MessageStreamJSON::getJSONRoot()
 	{
+		if (!mJSONRootBuilt)
+		{
+			mJSONRootBuilt = true;
+
+			// Only build the tree for data that the decoder accepted.
+			if (NULL != mDecoder->getRoot())
+			{
+				mJSONRoot = YAJLDom::parse(
+					(const unsigned char*)mDecoder->getData() + 3,
+					mDecoder->getSize() - 3);
+			}
+		}
 		return mJSONRoot;
 	}
 
 	/**
-	 * Parse the message. This finds the message name and
-	 * creates a dictionary with the message parameters.
+	 * Parse the message. This reads the message data into the
+	 * decoder and parses the message array in place.
 	 */
 	void MessageStreamJSON::parse(MAHandle dataHandle)
 	{
 		//lprintfln("@@@ MessageStreamJSON::parse %i", dataHandle);
 
-		// We must have data.
-		if (NULL == dataHandle)
-		{
-			return;
-		}
-
-		// Get length of the data, it is not zero terminated.
-		int dataSize = maGetDataSize(dataHandle);
-
-		// Allocate buffer for string data.
-		char* stringData = (char*) malloc(dataSize + 1);
-
-		// Get the data.
-		maReadData(dataHandle, stringData, 0, dataSize);
-
-		// Zero terminate.
-		stringData[dataSize] = 0;
-
-		//maWriteLog(stringData, dataSize);
+		mCurrentMessage = NULL;
+		mCurrentMessageIndex = -1;
 
 		// Check that we have the "ma:" prefix,
 		// followed by the JSON array.
-		if (stringData[0] != 'm') { return; }
-		if (stringData[1] != 'a') { return; }
-		if (stringData[2] != ':') { return; }
-		if (stringData[3] != '[') { return; }
-
-		// Pointer to the start of the JSOn array at the
-		// opening '[' character.
-		char* jsonData = stringData + 3;
-
-		mJSONRoot = YAJLDom::parse(
-			(const unsigned char*)jsonData,
-			dataSize - 3);
+		if (MessageDecoder::PROTOCOL_JSON != mDecoder->load(dataHandle))
+		{
+			return;
+		}
+		if ('[' != mDecoder->getData()[3])
+		{
+			return;
+		}
 
-		free(stringData);
+		mDecoder->parseJSON();
 	}
 
 } // namespace
@@ -36,6 +36,7 @@ limitations under the License.
 #include <MAUtil/HashMap.h>
 #include <NativeUI/WebView.h>
 #include <yajl/YAJLDom.h>
+#include "MessageDecoder.h"
 
 namespace Wormhole
 {
@@ -128,14 +129,35 @@ public:
 
 	/**
 	 * Get the node of a top-level parameter in the current message.
+	 * The YAJLDom tree is built the first time this is called
+	 * for a message stream.
 	 */
 	MAUtil::YAJLDom::Value* getParamNode(const char* paramName);
 
 	/**
-	 * @return The JSON root node.
+	 * @return The JSON root node. The YAJLDom tree is built
+	 * the first time this is called for a message stream.
 	 */
 	MAUtil::YAJLDom::Value* getJSONRoot();
 
+	/**
+	 * Get the value of a top-level parameter in the current message,
+	 * without building the YAJLDom tree.
+	 * @return The value, NULL if there is no such parameter.
+	 */
+	const JSONValue* getParamValue(const char* paramName);
+
+	/**
+	 * @return The decoder that holds the message data.
+	 */
+	MessageDecoder* getDecoder();
+
+	/**
+	 * @return The unescaped value of a string, or an empty
+	 * string if \a value is not a string.
+	 */
+	MAUtil::String toString(const JSONValue* value);
+
 	/**
 	 * Parse the message. This finds the message name and
 	 * creates a dictionary with the message parameters.
@@ -155,10 +177,25 @@ protected:
 	NativeUI::WebView* mWebView;
 
 	/**
-	 * Table for message parameters.
+	 * The decoder that holds the message data and the parsed messages.
+	 */
+	MessageDecoder* mDecoder;
+
+	/**
+	 * The current message in the decoder, NULL before the first one.
+	 */
+	const JSONValue* mCurrentMessage;
+
+	/**
+	 * Table for message parameters. Built on demand by getJSONRoot().
 	 */
 	MAUtil::YAJLDom::Value* mJSONRoot;
 
+	/**
+	 * true if mJSONRoot has been built.
+	 */
+	bool mJSONRootBuilt;
+
 	/**
 	 * Index of current message.
 	 */
@@ -52,9 +52,12 @@ void crt_tor_chain(int* ptr) {
 }
 
 
+static void flushAll(void);
+
 void _exit(int status) {
 	LOGD("exit(%i)\n", status);
 	fcloseall();
+	flushAll();
 	maExit(status);
 }
 
@@ -103,6 +106,15 @@ struct group* getgrgid(gid_t gid) {
 // check include/sys/_default_fcntl.h to make sure this flag doesn't clash.
 #define O_DIRECTORY 0x1000000
 
+// Each file descriptor has a buffer, so that sequential small reads and writes
+// are done as few large transfers. The buffer holds either bytes read ahead,
+// or one contiguous run of bytes not yet written.
+#define LOWBUF_SIZE (4*1024)
+#define LOWBUF_NONE 0
+#define LOWBUF_READ 1
+#define LOWBUF_WRITE 2
+#define LOWBUF_APPEND 3
+
 struct LOW_FD {
 	int lowFd;
 	int refCount;
@@ -111,16 +123,26 @@ struct LOW_FD {
 	// valid only if flags & O_DIRECTORY.
 	char* name;
 	int listHandle;
+
+	// valid only for files, except buf, bufStart and bufLen,
+	// which directories use for listing; see getdents().
+	// The file position is kept here; the runtime's position is not used.
+	int pos;
+	char* buf;	// allocated on first use.
+	int bufMode;
+	int bufStart;	// file position of buf[0].
+	int bufLen;
 };
 
 #define NFD 32
 static struct LOW_FD* sFda[NFD];
 static struct LOW_FD sLfda[NFD];
 
-static struct LOW_FD sLfConsole = { LOWFD_CONSOLE, 1, O_APPEND, NULL, 0 };
-static struct LOW_FD sLfWriteLog = { LOWFD_WRITELOG, 1, O_APPEND, NULL, 0 };
+static struct LOW_FD sLfConsole = { LOWFD_CONSOLE, 1, O_APPEND, NULL, 0, 0, NULL, LOWBUF_NONE, 0, 0 };
+static struct LOW_FD sLfWriteLog = { LOWFD_WRITELOG, 1, O_APPEND, NULL, 0, 0, NULL, LOWBUF_NONE, 0, 0 };
 
 static int closeLfd(struct LOW_FD* plfd);
+static int lowFlush(struct LOW_FD* plfd);
 static void lowRewindDir(struct LOW_FD* plfd);
 static int doRename(MAHandle oldHandle, const char* newProper);
 
@@ -221,10 +243,109 @@ static int checkMAResult(int res) {
 }
 
 static MAHandle errnoFileOpen(const char* path, int ma_mode) {
-	MAHandle h = maFileOpen(path, ma_mode);
+	MAHandle h;
+	// the runtime can't see bytes that are still in a descriptor's buffer.
+	// anything that opens a path, to stat it, open it again, rename it and so on,
+	// must see them.
+	flushAll();
+	h = maFileOpen(path, ma_mode);
 	return checkMAResult(h);
 }
 
+// The number of maFile calls made to transfer data, for benchmarks.
+static int sFileCalls = 0;
+
+int __mosync_file_calls(void);
+int __mosync_file_calls(void) {
+	return sFileCalls;
+}
+
+// Positional transfers. They use the maFile*At ioctls if the runtime has them,
+// otherwise they seek and then transfer.
+// They return the same as the ioctls do.
+static int sHavePositional = 1;
+
+static int lowReadAt(MAHandle h, void* dst, int len, int offset) {
+	int res, size;
+	sFileCalls++;
+	if(sHavePositional) {
+		res = maFileReadAt(h, dst, len, offset);
+		if(res != IOCTL_UNAVAILABLE)
+			return res;
+		sHavePositional = 0;
+	}
+	sFileCalls += 2;
+	TEST(size = maFileSize(h));
+	if(offset >= size)
+		return 0;
+	len = MIN(len, size - offset);
+	TEST(maFileSeek(h, offset, MA_SEEK_SET));
+	TEST(maFileRead(h, dst, len));
+	return len;
+}
+
+static int lowWriteAt(MAHandle h, const void* src, int len, int offset) {
+	int res;
+	sFileCalls++;
+	if(sHavePositional) {
+		res = maFileWriteAt(h, (MAAddress)src, len, offset);
+		if(res != IOCTL_UNAVAILABLE)
+			return res;
+		sHavePositional = 0;
+	}
+	sFileCalls++;
+	TEST(maFileSeek(h, offset, MA_SEEK_SET));
+	TEST(maFileWrite(h, (MAAddress)src, len));
+	return len;
+}
+
+static int lowAppend(MAHandle h, const void* src, int len) {
+	int res;
+	sFileCalls++;
+	if(sHavePositional) {
+		res = maFileAppend(h, (MAAddress)src, len);
+		if(res != IOCTL_UNAVAILABLE)
+			return res;
+		sHavePositional = 0;
+	}
+	sFileCalls++;
+	TEST(res = maFileSeek(h, 0, MA_SEEK_END));
+	TEST(maFileWrite(h, (MAAddress)src, len));
+	return res + len;
+}
+
+// returns non-zero if the descriptor has a buffer.
+static int lowAllocBuf(struct LOW_FD* plfd) {
+	if(plfd->buf == NULL)
+		plfd->buf = malloc(LOWBUF_SIZE);
+	return plfd->buf != NULL;
+}
+
+// writes out pending bytes. the read buffer, if any, is kept.
+static int lowFlush(struct LOW_FD* plfd) {
+	MAHandle h = plfd->lowFd - LOWFD_OFFSET;
+	int res;
+	if(plfd->bufMode == LOWBUF_WRITE) {
+		res = lowWriteAt(h, plfd->buf, plfd->bufLen, plfd->bufStart);
+	} else if(plfd->bufMode == LOWBUF_APPEND) {
+		res = lowAppend(h, plfd->buf, plfd->bufLen);
+		if(res >= 0)
+			plfd->pos = res;
+	} else {
+		return 0;
+	}
+	plfd->bufMode = LOWBUF_NONE;
+	CHECK(res, EIO);
+	return 0;
+}
+
+static void flushAll(void) {
+	for(int i=0; i<NFD; i++) {
+		if(sLfda[i].refCount > 0 && sLfda[i].lowFd >= LOWFD_OFFSET)
+			lowFlush(sLfda + i);
+	}
+}
+
 int dup(int __fd) {
 	int newFd;
 	LOWFD;
@@ -288,6 +409,7 @@ int fstat(int __fd, struct stat *st) {
 	} else {
 		MAHandle h = lfd - LOWFD_OFFSET;
 		st->st_mode = (plfd->flags & O_DIRECTORY) ? S_IFDIR : S_IFREG;
+		TEST(lowFlush(plfd));
 		return baseStat(h, st);
 	}
 }
@@ -372,45 +494,78 @@ off_t lseek(int __fd, off_t __offset, int __whence) {
 			ERRNOFAIL(EINVAL);
 	}
 	file = lfd - LOWFD_OFFSET;
+	TEST(lowFlush(plfd));
 	switch(__whence) {
-		case SEEK_SET: __whence = MA_SEEK_SET; break;
-		case SEEK_CUR: __whence = MA_SEEK_CUR; break;
-		case SEEK_END: __whence = MA_SEEK_END; break;
+		case SEEK_SET: res = __offset; break;
+		case SEEK_CUR: res = plfd->pos + __offset; break;
+		case SEEK_END:
+			CHECK(res = maFileSize(file), EIO);
+			res += __offset;
+			break;
 		default: ERRNOFAIL(EINVAL);
 	}
-	CHECK(res = maFileSeek(file, __offset, __whence), EINVAL);
+	FAILIF(res < 0, EINVAL);
+	plfd->pos = res;
 	return res;
 }
 
 int ftruncate(int __fd, off_t __length) {
 	LOWFD;
+	TEST(lowFlush(plfd));
+	plfd->bufMode = LOWBUF_NONE;
 	CHECK(maFileTruncate(lfd - LOWFD_OFFSET, __length), EINVAL);
 	return 0;
 }
 
+int fsync(int __fd) {
+	LOWFD;
+	if(lfd < LOWFD_OFFSET)
+		return 0;
+	return lowFlush(plfd);
+}
+
 int read(int __fd, void *__buf, size_t __nbyte) {
-	int remaining, fileSize, fileTell;
+	int res, done = 0;
+	char* dst = __buf;
 	MAHandle file;
 	LOWFD;
 	file = lfd - LOWFD_OFFSET;
 	LOGD("read(%i, %zu)\n", __fd, __nbyte);
+	FAILIF(lfd < LOWFD_OFFSET, EBADF);
+	TEST(lowFlush(plfd));
+
+	// take what we can from the read buffer.
+	if(plfd->bufMode == LOWBUF_READ && plfd->pos >= plfd->bufStart &&
+		plfd->pos < plfd->bufStart + plfd->bufLen)
+	{
+		int offset = plfd->pos - plfd->bufStart;
+		done = MIN((int)__nbyte, plfd->bufLen - offset);
+		memcpy(dst, plfd->buf + offset, done);
+		plfd->pos += done;
+		if((size_t)done == __nbyte)
+			return done;
+	}
 
-	CHECK(fileSize = maFileSize(file), EIO);
-	CHECK(fileTell = maFileTell(file), EIO);
-
-	remaining = fileSize - fileTell;
+	// large reads go straight to the caller.
 	// seeking past the end of the file is allowed. it's treated like ordinary EOF.
-	if(remaining <= 0) return 0;
-	//FAILIF(remaining < 0, EIO);
-	if(remaining < __nbyte)
-		__nbyte = remaining;
+	if(__nbyte - done >= LOWBUF_SIZE || !lowAllocBuf(plfd)) {
+		CHECK(res = lowReadAt(file, dst + done, __nbyte - done, plfd->pos), EIO);
+		plfd->pos += res;
+		return done + res;
+	}
 
-	CHECK(maFileRead(file, __buf, __nbyte), EIO);
-	return __nbyte;
+	CHECK(res = lowReadAt(file, plfd->buf, LOWBUF_SIZE, plfd->pos), EIO);
+	plfd->bufMode = LOWBUF_READ;
+	plfd->bufStart = plfd->pos;
+	plfd->bufLen = res;
+	res = MIN((int)__nbyte - done, res);
+	memcpy(dst + done, plfd->buf, res);
+	plfd->pos += res;
+	return done + res;
 }
 
 int write(int __fd, const void *__buf, size_t __nbyte) {
-	int res;
+	int res, mode;
 	LOWFD;
 	if(lfd == LOWFD_CONSOLE) {
 		WriteConsole(__buf, __nbyte);
@@ -420,30 +575,79 @@ int write(int __fd, const void *__buf, size_t __nbyte) {
 	} else {
 		MAHandle h = lfd - LOWFD_OFFSET;
 		LOGD("write(%i, %zu)\n", __fd, __nbyte);
-		if(plfd->flags & O_APPEND) {
-			int oldPos = maFileTell(h);
-			int fileSize = maFileSize(h);
-			FAILIF(oldPos < 0 || fileSize < 0, EIO);
-			CHECK(maFileSeek(h, 0, MA_SEEK_END), EIO);
-			CHECK(maFileWrite(h, __buf, __nbyte), EIO);
-			if(oldPos != fileSize) {
-				res = maFileSeek(h, oldPos, MA_SEEK_SET);
+		mode = (plfd->flags & O_APPEND) ? LOWBUF_APPEND : LOWBUF_WRITE;
+		if(plfd->bufMode == LOWBUF_READ)
+			plfd->bufMode = LOWBUF_NONE;
+
+		// the buffer holds one contiguous run of bytes.
+		if(plfd->bufMode != LOWBUF_NONE && (plfd->bufMode != mode ||
+			plfd->bufLen + (int)__nbyte > LOWBUF_SIZE ||
+			(mode == LOWBUF_WRITE && plfd->pos != plfd->bufStart + plfd->bufLen)))
+		{
+			TEST(lowFlush(plfd));
+		}
+
+		if(__nbyte >= LOWBUF_SIZE || !lowAllocBuf(plfd)) {
+			if(mode == LOWBUF_APPEND) {
+				CHECK(res = lowAppend(h, __buf, __nbyte), EIO);
+				plfd->pos = res;
+			} else {
+				CHECK(res = lowWriteAt(h, __buf, __nbyte, plfd->pos), EIO);
+				plfd->pos += __nbyte;
 			}
-		} else {
-			res = maFileWrite(h, __buf, __nbyte);
+			return __nbyte;
+		}
+
+		if(plfd->bufMode == LOWBUF_NONE) {
+			plfd->bufMode = mode;
+			plfd->bufStart = plfd->pos;
+			plfd->bufLen = 0;
 		}
+		memcpy(plfd->buf + plfd->bufLen, __buf, __nbyte);
+		plfd->bufLen += __nbyte;
+		if(mode == LOWBUF_WRITE)
+			plfd->pos += __nbyte;
+		return __nbyte;
 	}
 	CHECK(res, EIO);
 	return __nbyte;
 }
 
+ssize_t pread(int __fd, void *__buf, size_t __nbyte, off_t __offset) {
+	int res;
+	LOWFD;
+	LOGD("pread(%i, %zu, %li)\n", __fd, __nbyte, __offset);
+	FAILIF(lfd < LOWFD_OFFSET, ESPIPE);
+	FAILIF(__offset < 0, EINVAL);
+	TEST(lowFlush(plfd));
+	CHECK(res = lowReadAt(lfd - LOWFD_OFFSET, __buf, __nbyte, __offset), EIO);
+	return res;
+}
+
+ssize_t pwrite(int __fd, const void *__buf, size_t __nbyte, off_t __offset) {
+	LOWFD;
+	LOGD("pwrite(%i, %zu, %li)\n", __fd, __nbyte, __offset);
+	FAILIF(lfd < LOWFD_OFFSET, ESPIPE);
+	FAILIF(__offset < 0, EINVAL);
+	TEST(lowFlush(plfd));
+	plfd->bufMode = LOWBUF_NONE;
+	CHECK(lowWriteAt(lfd - LOWFD_OFFSET, __buf, __nbyte, __offset), EIO);
+	return __nbyte;
+}
+
 static int closeLfd(struct LOW_FD* plfd) {
+	int res = 0;
 	LOGD("closeLfd(%i, %i)", plfd->lowFd, plfd->refCount);
 	plfd->refCount--;
-	if(plfd->refCount == 0 && plfd->lowFd > LOWFD_OFFSET) {
+	if(plfd->refCount == 0 && plfd->lowFd >= LOWFD_OFFSET) {
+		res = lowFlush(plfd);
+		if(plfd->flags & O_DIRECTORY)
+			lowRewindDir(plfd);
+		free(plfd->buf);
+		plfd->buf = NULL;
 		CHECK(maFileClose(plfd->lowFd - LOWFD_OFFSET), EIO);
 	}
-	return 0;
+	return res;
 }
 
 int close(int __fd) {
@@ -561,6 +765,9 @@ int openat(int __fd, const char * __filename, int __mode, ...) {
 	newLfd->lowFd = handle + LOWFD_OFFSET;
 	newLfd->refCount = 1;
 	newLfd->flags = __mode;
+	newLfd->pos = 0;
+	newLfd->buf = NULL;
+	newLfd->bufMode = LOWBUF_NONE;
 	if(__mode & O_DIRECTORY) {
 		newLfd->name = malloc(length+1);
 		FAILIF(newLfd->name == NULL, ENOMEM);
@@ -822,8 +1029,16 @@ int nice(int incr) {
 	STDFAIL;
 }
 
+// Directory listings are read several entries at a time with
+// maFileListNextBatch, into the descriptor's buffer. For directories,
+// bufStart is the offset of the next entry in the buffer and bufLen is the
+// number of entries left.
+// -1 until the first listing finds out if the runtime has maFileListNextBatch.
+static int sHaveListBatch = -1;
+
 int getdents(int __fd, dirent* dp, int count) {
-	//int res;
+	const MAFileListEntry* e;
+	int res;
 	LOWFD;
 	MAASSERT(count >= sizeof(dirent));
 	LOGD("getdents(%i)\n", __fd);
@@ -831,12 +1046,41 @@ int getdents(int __fd, dirent* dp, int count) {
 	// if we don't have an open list, open a list.
 	if(plfd->listHandle <= 0) {
 		MAASSERT(plfd->name != NULL);
-		plfd->listHandle = maFileListStart(plfd->name, "*", MA_FL_SORT_NONE);
+		// a lazy list doesn't read the whole directory before returning the first entry.
+		plfd->listHandle = maFileListStart(plfd->name, "*",
+			sHaveListBatch > 0 ? (MA_FL_SORT_NONE | MA_FL_FLAG_LAZY) : MA_FL_SORT_NONE);
 		TEST(checkMAResult(plfd->listHandle));
+		plfd->bufStart = 0;
+		plfd->bufLen = 0;
+	}
+	if(plfd->bufLen == 0 && sHaveListBatch != 0 && lowAllocBuf(plfd)) {
+		res = maFileListNextBatch(plfd->listHandle, (MAAddress)plfd->buf, LOWBUF_SIZE, 0);
+		if(res == IOCTL_UNAVAILABLE) {
+			sHaveListBatch = 0;
+		} else {
+			sHaveListBatch = 1;
+			// a name that doesn't fit in the buffer wouldn't fit in a dirent either.
+			CHECK(res, EIO);
+			if(res == 0)
+				return 0;
+			plfd->bufStart = 0;
+			plfd->bufLen = res;
+		}
+	}
+	if(plfd->bufLen > 0) {
+		e = (const MAFileListEntry*)(plfd->buf + plfd->bufStart);
+		plfd->bufStart += e->entrySize;
+		plfd->bufLen--;
+		FAILIF(e->nameLength >= sizeof(dp->d_name), EINVAL);
+		dp->d_namlen = e->nameLength;
+		memcpy(dp->d_name, e + 1, e->nameLength + 1);
+	} else {
+		CHECK(dp->d_namlen = maFileListNext(plfd->listHandle, dp->d_name, sizeof(dp->d_name)), EIO);
+		FAILIF(dp->d_namlen >= sizeof(dp->d_name), EINVAL);
+		if(dp->d_namlen == 0)
+			return 0;
 	}
-	CHECK(dp->d_namlen = maFileListNext(plfd->listHandle, dp->d_name, sizeof(dp->d_name)), EIO);
 	LOGD("namlen: %i\n", dp->d_namlen);
-	FAILIF(dp->d_namlen >= sizeof(dp->d_name), EINVAL);
 	if(dp->d_name[dp->d_namlen-1] == '/') {
 		LOGD("getdents: directory.\n");
 		dp->d_type = DT_DIR;
@@ -860,6 +1104,7 @@ static void lowRewindDir(struct LOW_FD* plfd) {
 		MAASSERT(res == 0);
 		plfd->listHandle = 0;
 	}
+	plfd->bufLen = 0;
 }
 
 int dirfd(DIR* dir) {
@@ -92,7 +92,8 @@ work.instance_eval do
 			"mktemp.c" => " -DHAVE_MKDIR",
 		}
 
-		@IGNORED_FILES = ["engine.c"]
+		# pread() and pwrite() are implemented in machine.c.
+		@IGNORED_FILES = ["engine.c", "pread.c", "pwrite.c"]
 
 		@EXTRA_OBJECTS = [FileTask.new(self, "libc/sys/mosync/crtlib.s"), FileTask.new(self, "libc/sys/mosync/mastack.s")]
 
@@ -152,17 +152,20 @@ class PipeExeWork < PipeGccWork
 			end
 		end
 
+		# only MoRE can load image atlases.
+		resFlags = defined?(PACK) ? '' : ' -atlas'
+
 		# rescomp support
 		if(@LSTX)
 			lstxTask = RescompTask.new(self, @BUILDDIR_BASE, @LSTX, @RES_PLATFORM)
-			@resourceTask = PipeResourceTask.new(self, 'build/resources', [lstxTask])
+			@resourceTask = PipeResourceTask.new(self, 'build/resources', [lstxTask], resFlags)
 		end
 
 		if(@resourceTask)
 			@prerequisites << @resourceTask
 		elsif(@LSTFILES.size > 0)
 			lstTasks = @LSTFILES.collect do |name| FileTask.new(self, name) end
-			@resourceTask = PipeResourceTask.new(self, "build/resources", lstTasks)
+			@resourceTask = PipeResourceTask.new(self, "build/resources", lstTasks, resFlags)
 			@prerequisites << @resourceTask
 		end
 		if(USE_NEWLIB)
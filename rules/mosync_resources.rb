@@ -213,7 +213,8 @@ class BundleTask < FileTask
 		@srcDir = srcDir
 	end
 	def execute
-		sh "#{mosyncdir}/bin/Bundle -in \"#{@srcDir}\" -out \"#{@NAME}\""
+		# programs built by these rules link with the MAFS that reads version 3.
+		sh "#{mosyncdir}/bin/Bundle -v3 -in \"#{@srcDir}\" -out \"#{@NAME}\""
 	end
 end
 
@@ -65,10 +65,10 @@ end
 
 # adds dependency handling
 class PipeResourceTask < PipeTask
-	def initialize(work, name, objects)
+	def initialize(work, name, objects, flags = '')
 		@depFile = "#{File.dirname(name)}/resources.mf"
 		@tempDepFile = "#{@depFile}t"
-		super(work, name, objects, " -depend=#{@tempDepFile} -R")
+		super(work, name, objects, " -depend=#{@tempDepFile} -R#{flags}")
 
 		# only if the file is not already needed do we care about extra dependencies
 		if(!needed?(false)) then
@@ -43,6 +43,8 @@ AudioChannel::AudioChannel ( int s, AudioSource* audioSource )
 void AudioChannel::setAudioSource ( AudioSource* as )
 {
     mAudioSource = as;
+    mBufferedSamples = 0;
+    mBufferedSamplePos = 0;
 }
 
 /**
@@ -171,12 +173,19 @@ void AudioChannel::mix ( int *dst, int numSamples )
     {
         if ( mBufferedSamples == false )
         {
-            if ( (mBufferedSamples=mAudioSource->fillBuffer( )) == false )
+            int filled = mAudioSource->fillBuffer( );
+            if ( filled == AudioSource::UNDERRUN )
+            {
+                // Nothing decoded yet; the rest of the output stays silent.
+                break;
+            }
+            if ( (mBufferedSamples=filled) == false )
             {
                 mActive = false;
                 break;
             }
             mBufferedSamplePos = 0;
+            src = mAudioSource->getBuffer();
         }
 
         int copySize = numSamples - samplesWritten;
@@ -223,5 +232,10 @@ void AudioChannel::mix ( int *dst, int numSamples )
             mBufferedSamplePos  += scaledCopySize;
             mBufferedSamples    -= scaledCopySize;
         }
+        else
+        {
+            // Less than one output sample is left, which would never be used up.
+            mBufferedSamples = 0;
+        }
     }
 }
@@ -33,7 +33,16 @@ namespace AudioEngine {
 	int getSampleRate();
 	AudioChannel* getChannel(int i);
 	AudioSource* getAudioSource(const char *mimeType, Base::Stream *s);
-	
+
+	/**
+	 * Returns an initialized source for the sound at \a offset in the
+	 * binary resource \a handle, which starts with its MIME type.
+	 * Short sounds are played from the decoded PCM cache when they've
+	 * been played before; other sounds are decoded on the decode thread.
+	 * Returns NULL if the sound couldn't be loaded.
+	 */
+	AudioSource* getSoundSource(int handle, Base::Stream *data, int offset, int size);
+
 };
 
 #endif /* _AUDIO_ENGINE_H_ */
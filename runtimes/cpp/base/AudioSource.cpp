@@ -30,3 +30,7 @@ void AudioSource::close() {
 const AudioSource::Info& AudioSource::getInfo() const {
 	return info;
 }
+
+int AudioSource::getFrameSize() const {
+	return (info.bitDepth >> 3) * info.numChannels;
+}
@@ -51,16 +51,23 @@ public:
 		bool canSeek;
 	};
 
+	// returned by fillBuffer() when nothing is ready yet, but more will be.
+	enum { UNDERRUN = -1 };
+
 	AudioSource();
 	virtual ~AudioSource();
 
 	virtual int init() = 0;
 	virtual void close();
 
-	// return 0 on end reached, return amount of bytes read otherwise.
+	// return 0 on end reached, UNDERRUN if nothing is ready yet,
+	// return amount of samples read otherwise.
 	virtual int fillBuffer() = 0;
+	// valid until the next fillBuffer().
 	virtual const void* getBuffer() const = 0;
 	const Info& getInfo() const;
+	// bytes per sample, in all channels.
+	int getFrameSize() const;
 
 	virtual void setPosition(int ms) = 0;
 	virtual int getPosition() const = 0;
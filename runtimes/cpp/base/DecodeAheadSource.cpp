@@ -0,0 +1,381 @@
+/* Copyright 2013 David Axmark
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+	http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "config_platform.h"
+#include <helpers/helpers.h>
+#include <vector>
+#include <algorithm>
+#include "ThreadPool.h"
+#include "DecodeAheadSource.h"
+#include "PcmCache.h"
+
+// the smallest buffer handed to the mixer.
+#define MIN_BUFFER_SIZE 4096
+
+// how far ahead of playback the decoder may run, in buffers and in time.
+#define MIN_RING_BUFFERS 4
+#define RING_MS 500
+
+// how much init() decodes before playback starts.
+#define PREFILL_BUFFERS 2
+
+namespace AudioDecoder {
+	static void lockAudio();
+	static void unlockAudio();
+};
+
+static int ringSize ( const AudioSource::Info& info, int frameSize )
+{
+	int size = (int)((long long)info.sampleRate * frameSize * RING_MS / 1000);
+	return MAX(size, info.bufferSize * MIN_RING_BUFFERS);
+}
+
+static AudioSource::Info bufferInfo ( AudioSource* decoder )
+{
+	AudioSource::Info info = decoder->getInfo();
+	int frameSize = decoder->getFrameSize();
+	DEBUG_ASSERT(frameSize > 0);
+	info.bufferSize = MAX(info.bufferSize, MIN_BUFFER_SIZE);
+	info.bufferSize -= info.bufferSize % frameSize;
+	return info;
+}
+
+DecodeAheadSource::DecodeAheadSource ( AudioSource* decoder, int recordBytes )
+: mDecoder( decoder ),
+  mRing( ringSize( bufferInfo( decoder ), decoder->getFrameSize() ) ),
+  mFrameSize( decoder->getFrameSize() ),
+  mRegistered( false ),
+  mPending( NULL ),
+  mPendingSize( 0 ),
+  mDecoderDone( false ),
+  mRecording( NULL ),
+  mRecordBytes( recordBytes ),
+  mRecordingOn( false ),
+  mEnd( false ),
+  mUnderruns( 0 )
+{
+	info = bufferInfo( decoder );
+	mBuffer = new char[info.bufferSize];
+	if ( recordBytes > 0 )
+	{
+		mRecording = new PcmBuffer( info );
+		mRecordingOn = true;
+	}
+}
+
+DecodeAheadSource::~DecodeAheadSource()
+{
+	if ( mRegistered )
+		AudioDecoder::remove( this );
+	stopRecording();
+	if ( mRecording )
+		mRecording->release();
+	delete mDecoder;
+	delete[] mBuffer;
+}
+
+int DecodeAheadSource::init()
+{
+	while ( mRing.readable() < info.bufferSize * PREFILL_BUFFERS && !mEnd )
+	{
+		if ( !decodeStep() )
+			break;
+	}
+	AudioDecoder::add( this );
+	mRegistered = true;
+	AudioDecoder::wake();
+	return 0;
+}
+
+void DecodeAheadSource::close()
+{
+	if ( mRegistered )
+	{
+		AudioDecoder::remove( this );
+		mRegistered = false;
+	}
+	stopRecording();
+	mDecoder->close();
+}
+
+int DecodeAheadSource::fillBuffer()
+{
+	int size = mRing.readable();
+	if ( size < mFrameSize && mEnd )
+	{
+		// the last bytes were written before mEnd was set.
+		pcmMemoryBarrier();
+		size = mRing.readable();
+	}
+	size -= size % mFrameSize;
+	size = MIN(size, info.bufferSize);
+	if ( size > 0 )
+	{
+		mRing.read( mBuffer, size );
+		AudioDecoder::wake();
+		return size / mFrameSize;
+	}
+	if ( mEnd )
+		return 0;
+
+	mUnderruns++;
+	AudioDecoder::wake();
+	return UNDERRUN;
+}
+
+const void* DecodeAheadSource::getBuffer() const
+{
+	return mBuffer;
+}
+
+bool DecodeAheadSource::decodeStep ( void )
+{
+	bool worked = false;
+	if ( mPendingSize > 0 )
+	{
+		int n = mRing.write( mPending, mPendingSize );
+		if ( n == 0 )
+			return false;
+		mPending += n;
+		mPendingSize -= n;
+		worked = true;
+		if ( mPendingSize > 0 )
+			return true;
+	}
+	if ( mDecoderDone )
+		return worked;
+
+	int samples = mDecoder->fillBuffer();
+	if ( samples <= 0 )
+	{
+		mDecoderDone = true;
+		if ( mRecordingOn )
+		{
+			// the data is in place before the main thread can see it.
+			pcmMemoryBarrier();
+			mRecording->complete = true;
+			mRecordingOn = false;
+		}
+		pcmMemoryBarrier();
+		mEnd = true;
+		return true;
+	}
+
+	mPending = (const char*)mDecoder->getBuffer();
+	mPendingSize = samples * mFrameSize;
+	if ( mRecordingOn )
+	{
+		if ( (int)mRecording->data.size() + mPendingSize > mRecordBytes )
+			stopRecording();
+		else
+			mRecording->data.insert( mRecording->data.end(), mPending, mPending + mPendingSize );
+	}
+
+	int n = mRing.write( mPending, mPendingSize );
+	mPending += n;
+	mPendingSize -= n;
+	return true;
+}
+
+// Only called when the decode thread can't be in decodeStep().
+void DecodeAheadSource::stopRecording ( void )
+{
+	if ( !mRecordingOn )
+		return;
+	mRecordingOn = false;
+	std::vector<char>().swap( mRecording->data );
+	mRecording->abandoned = true;
+}
+
+// Drops the decoded sound that hasn't been played.
+// Only called when the decode thread can't be in decodeStep().
+void DecodeAheadSource::flush ( void )
+{
+	// the audio callback reads the ring.
+	AudioDecoder::lockAudio();
+	mRing.clear();
+	mPendingSize = 0;
+	AudioDecoder::unlockAudio();
+}
+
+void DecodeAheadSource::setPosition(int ms)
+{
+	AudioDecoder::lock();
+	flush();
+	mDecoder->setPosition( ms );
+	mDecoderDone = false;
+	mEnd = false;
+	stopRecording();
+	AudioDecoder::unlock();
+	AudioDecoder::wake();
+}
+
+int DecodeAheadSource::getPosition() const
+{
+	// the decode thread moves the decoder.
+	AudioDecoder::lock();
+	// the decoder is ahead by what's decoded but not played.
+	int bufferedFrames = (mRing.readable() + mPendingSize) / mFrameSize;
+	int pos = mDecoder->getPosition() -
+		(int)((long long)bufferedFrames * 1000 / info.sampleRate);
+	int length = mDecoder->getLength();
+	AudioDecoder::unlock();
+	if ( pos < 0 )
+	{
+		// the decoder has started the next loop.
+		pos = MAX(0, pos + length);
+	}
+	return pos;
+}
+
+int DecodeAheadSource::getLength() const
+{
+	return mDecoder->getLength();
+}
+
+void DecodeAheadSource::setNumLoops(int i)
+{
+	// what is already in the ring, at most RING_MS, plays with the old
+	// number of loops. Decoding it again would need the decoder's position,
+	// which most decoders don't report.
+	AudioDecoder::lock();
+	mDecoder->setNumLoops( i );
+	if ( i != 1 )
+		stopRecording();
+	AudioDecoder::unlock();
+	AudioDecoder::wake();
+}
+
+int DecodeAheadSource::getNumLoops()
+{
+	return mDecoder->getNumLoops();
+}
+
+PcmBuffer* DecodeAheadSource::getRecording ( void )
+{
+	return mRecording;
+}
+
+int DecodeAheadSource::getUnderruns ( void ) const
+{
+	return mUnderruns;
+}
+
+//*****************************************************************************
+//AudioDecoder
+//*****************************************************************************
+
+namespace AudioDecoder {
+	static MoSyncThread sThread;
+	static MoSyncSemaphore* sWake = NULL;
+	static MoSyncMutex sMutex;
+	static std::vector<DecodeAheadSource*> sSources;
+	static bool sRunning = false;
+	static volatile bool sQuit;
+	static volatile bool sWakePending;
+	static void (*sLockAudio)(void) = NULL;
+	static void (*sUnlockAudio)(void) = NULL;
+
+	static int run(void*) {
+		while(true) {
+			sWake->wait();
+			if(sQuit)
+				break;
+			sWakePending = false;
+
+			// until every ring is full, or every decoder is done.
+			bool worked = true;
+			while(worked && !sQuit) {
+				worked = false;
+				sMutex.lock();
+				for(size_t i=0; i<sSources.size(); i++) {
+					if(sSources[i]->decodeStep())
+						worked = true;
+				}
+				sMutex.unlock();
+			}
+		}
+		return 0;
+	}
+
+	void start(void (*lockAudio)(void), void (*unlockAudio)(void)) {
+		if(sRunning)
+			return;
+		sLockAudio = lockAudio;
+		sUnlockAudio = unlockAudio;
+		sMutex.init();
+		sWake = new MoSyncSemaphore();
+		sQuit = false;
+		sWakePending = false;
+		sRunning = true;
+		sThread.start(run, NULL);
+	}
+
+	void stop() {
+		if(!sRunning)
+			return;
+		sQuit = true;
+		sWake->post();
+		sThread.join();
+		sRunning = false;
+		delete sWake;
+		sWake = NULL;
+		sMutex.close();
+		sSources.clear();
+	}
+
+	void add(DecodeAheadSource* source) {
+		if(!sRunning)
+			return;
+		sMutex.lock();
+		sSources.push_back(source);
+		sMutex.unlock();
+	}
+
+	void remove(DecodeAheadSource* source) {
+		if(!sRunning)
+			return;
+		sMutex.lock();
+		sSources.erase(std::remove(sSources.begin(), sSources.end(), source), sSources.end());
+		sMutex.unlock();
+	}
+
+	void wake() {
+		if(!sRunning || sWakePending)
+			return;
+		sWakePending = true;
+		sWake->post();
+	}
+
+	void lock() {
+		if(sRunning)
+			sMutex.lock();
+	}
+
+	void unlock() {
+		if(sRunning)
+			sMutex.unlock();
+	}
+
+	static void lockAudio() {
+		if(sLockAudio)
+			sLockAudio();
+	}
+
+	static void unlockAudio() {
+		if(sUnlockAudio)
+			sUnlockAudio();
+	}
+};
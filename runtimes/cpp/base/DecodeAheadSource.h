@@ -0,0 +1,129 @@
+/* Copyright 2013 David Axmark
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+	http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef _DECODE_AHEAD_SOURCE_H_
+#define _DECODE_AHEAD_SOURCE_H_
+
+#include "AudioSource.h"
+#include "PcmRing.h"
+
+class PcmBuffer;
+
+/**
+ * Runs a decoder on the AudioDecoder thread, ahead of playback, so that
+ * the audio callback only copies PCM that is already decoded. When the
+ * decoder falls behind, fillBuffer() returns UNDERRUN instead of waiting.
+ */
+class DecodeAheadSource : public AudioSource {
+public:
+	/**
+	 * @param decoder       An initialized source, which is deleted
+	 *                      with this one.
+	 * @param recordBytes   If not 0, the decoded sound is also kept in
+	 *                      getRecording(), unless it is longer than this.
+	 */
+	DecodeAheadSource ( AudioSource* decoder, int recordBytes );
+	virtual ~DecodeAheadSource();
+
+	/**
+	 * Decodes the first buffers, then hands the decoder to the
+	 * AudioDecoder thread.
+	 */
+	int init();
+	void close();
+
+	int fillBuffer();
+	const void* getBuffer() const;
+
+	void setPosition(int ms);
+	int getPosition() const;
+	int getLength() const;
+
+	void setNumLoops(int i);
+	int getNumLoops();
+
+	/**
+	 * Returns the whole decoded sound, once it is complete, or NULL if
+	 * it isn't recorded. The source keeps its reference.
+	 */
+	PcmBuffer* getRecording ( void );
+
+	/**
+	 * Returns the number of times fillBuffer() had nothing to give.
+	 */
+	int getUnderruns ( void ) const;
+
+	/**
+	 * Decodes the next buffer, if there's room for it.
+	 * Only called on the AudioDecoder thread, or before init() returns.
+	 *
+	 * @return false if there was nothing to do.
+	 */
+	bool decodeStep ( void );
+
+private:
+	void stopRecording ( void );
+	void flush ( void );
+
+	AudioSource* mDecoder;
+	PcmRing mRing;
+	char* mBuffer;
+	int mFrameSize;
+	bool mRegistered;
+
+	// the decoder's output that isn't in the ring yet.
+	const char* mPending;
+	int mPendingSize;
+	bool mDecoderDone;
+
+	PcmBuffer* mRecording;
+	int mRecordBytes;
+	bool mRecordingOn;
+
+	// set after the last bytes were written to the ring.
+	volatile bool mEnd;
+	volatile int mUnderruns;
+};
+
+/**
+ * The thread that runs the DecodeAheadSources.
+ */
+namespace AudioDecoder {
+	/**
+	 * \param lockAudio    Keeps the platform's audio callback, which reads
+	 *                     the sources, from running, until unlockAudio is
+	 *                     called. Both may be NULL if the sources are only
+	 *                     read on the thread that seeks them.
+	 */
+	void start(void (*lockAudio)(void), void (*unlockAudio)(void));
+	void stop();
+
+	void add(DecodeAheadSource* source);
+	void remove(DecodeAheadSource* source);
+
+	/**
+	 * Tells the thread that there may be room for more PCM.
+	 * Can be called from any thread.
+	 */
+	void wake();
+
+	/**
+	 * Keeps the thread from running any decoder.
+	 */
+	void lock();
+	void unlock();
+};
+
+#endif /* _DECODE_AHEAD_SOURCE_H_ */
@@ -34,7 +34,9 @@ namespace Base {
 		else if(curPos + size > src_size) {
 			FAIL;
 		}
-#ifndef _android
+#ifdef FILESTREAM_SHARED_FD
+		return new LimitedFileStream(*this, curPos, size);
+#elif !defined(_android)
 		return new LimitedFileStream(getFilename(), curPos, size);
 #else
 		return new LimitedFileStream(getFilename(), curPos, size, jniEnv, jthis);
@@ -43,19 +45,66 @@ namespace Base {
 
 	bool LimitedFileStream::_open() {
 		//make sure it's big enough
-		TEST(FileStream::seek(Seek::Start, mEndPos));
-		//seek to our starting point
-		TEST(FileStream::seek(Seek::Start, mStartPos));
+		int len;
+		TEST(FileStream::length(len));
+		TEST(mStartPos >= 0 && mStartPos <= mEndPos && mEndPos <= len);
+		return true;
+	}
+
+	LimitedFileStream::~LimitedFileStream() {
+		if(mWindow) {
+			free(mWindow);
+		}
+	}
+
+	// the size of LimitedFileStream's read window.
+	// reads of this size or larger go directly to the destination.
+	#define FILE_WINDOW_SIZE (4*1024)
+
+	// refills the read window, which must be empty, with at least needed bytes.
+	bool LimitedFileStream::fillWindow(int needed) {
+		DEBUG_ASSERT(mReadPtr == mReadEnd);
+		int size = MIN(FILE_WINDOW_SIZE, mEndPos - mStartPos);
+		int len = MIN(size, (mEndPos - mStartPos) - mPos);
+		DEBUG_ASSERT(needed <= len);
+		if(!mWindow) {
+			mWindow = (byte*)malloc(size);
+			TEST(mWindow);
+		}
+		mReadPtr = mReadEnd = NULL;
+		TEST(readAt(mWindow, len, mStartPos + mPos));
+		mPos += len;
+		mReadPtr = mWindow;
+		mReadEnd = mWindow + len;
 		return true;
 	}
 
 	bool LimitedFileStream::read(void* dst, int size) {
-		int curPos;
-		TEST(FileStream::tell(curPos));
-		if(curPos + size > mEndPos) {
+		if(size < 0 || position() + size > mEndPos - mStartPos) {
 			FAIL;
 		}
-		TEST(FileStream::read(dst, size));
+		byte* pos = (byte*)dst;
+		int buffered = mReadEnd - mReadPtr;
+		if(buffered >= size) {
+			memcpy(pos, mReadPtr, size);
+			mReadPtr += size;
+			return true;
+		}
+		if(buffered > 0) {
+			memcpy(pos, mReadPtr, buffered);
+			pos += buffered;
+			size -= buffered;
+		}
+		// the window is used up, so mPos is the stream's position.
+		mReadPtr = mReadEnd = NULL;
+		if(size >= FILE_WINDOW_SIZE) {
+			TEST(readAt(pos, size, mStartPos + mPos));
+			mPos += size;
+			return true;
+		}
+		TEST(fillWindow(size));
+		memcpy(pos, mReadPtr, size);
+		mReadPtr += size;
 		return true;
 	}
 
@@ -66,52 +115,63 @@ namespace Base {
 	}
 
 	bool LimitedFileStream::tell(int& aPos) const {
-		TEST(FileStream::tell(aPos));
-		aPos -= mStartPos;
+		TEST(isOpen());
+		aPos = position();
 		return true;
 	}
 
 	bool LimitedFileStream::seek(Seek::Enum mode, int offset) {
+		TEST(isOpen());
 		int newPos;
 		if(mode == Seek::Start) {
-			newPos = mStartPos + offset;
+			newPos = offset;
 		} else if(mode == Seek::Current) {
-			int curPos;
-			TEST(FileStream::tell(curPos));
-			newPos = curPos + offset;
+			newPos = position() + offset;
 		} else if(mode == Seek::End) {
-			newPos = mEndPos + offset;
+			newPos = (mEndPos - mStartPos) + offset;
 		} else {	//unsupported mode
 			FAIL;
 		}
-		if(newPos < mStartPos || newPos > mEndPos) {
+		if(newPos < 0 || newPos > mEndPos - mStartPos) {
 			FAIL;
 		}
-		TEST(FileStream::seek(Seek::Start, newPos));
+		if(mReadEnd && newPos >= mPos - (mReadEnd - mWindow) && newPos <= mPos) {
+			// a seek within the window keeps it.
+			mReadPtr = mReadEnd - (mPos - newPos);
+			return true;
+		}
+		mReadPtr = mReadEnd = NULL;
+		mPos = newPos;
+		return true;
+	}
+
+	bool LimitedFileStream::discardBuffer() {
+		mPos = position();
+		mReadPtr = mReadEnd = NULL;
 		return true;
 	}
 
 	Stream* LimitedFileStream::createLimitedCopy(int size) const {
-		int curPos;
-		TEST(FileStream::tell(curPos));
+		int curPos = mStartPos + position();
 		if(size < 0)
 			size = mEndPos - curPos;
 		else if(curPos + size > mEndPos) {
 			FAIL;
 		}
 
-#ifndef _android
-		return new LimitedFileStream(getFilename(), curPos, mEndPos - curPos);
+#ifdef FILESTREAM_SHARED_FD
+		return new LimitedFileStream(*this, curPos, size);
+#elif !defined(_android)
+		return new LimitedFileStream(getFilename(), curPos, size);
 #else
-		return new LimitedFileStream(getFilename(), curPos, mEndPos - curPos, mJNIEnv, mJThis);
+		return new LimitedFileStream(getFilename(), curPos, size, mJNIEnv, mJThis);
 #endif
 	}
 
 	Stream* LimitedFileStream::createCopy() const {
-		int curPos;
-		TEST(FileStream::tell(curPos));
-
-#ifndef _android
+#ifdef FILESTREAM_SHARED_FD
+		return new LimitedFileStream(*this, mStartPos, mEndPos - mStartPos);
+#elif !defined(_android)
 		return new LimitedFileStream(getFilename(), mStartPos, mEndPos - mStartPos);
 #else
 		return new LimitedFileStream(getFilename(), mStartPos, mEndPos - mStartPos, mJNIEnv, mJThis);
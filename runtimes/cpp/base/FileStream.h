@@ -30,6 +30,9 @@ limitations under the License.
 
 namespace Base {
 
+	//Depending on the platform, reads may go through a buffer.
+	//Data written to the file through another stream is not seen
+	//until the buffer is refilled, or discardBuffer() is called.
 	class FileStream : public Stream {	//read-only
 	public:
 		FileStream(const char* filename);
@@ -54,9 +57,18 @@ namespace Base {
 		virtual Stream* createCopy() const;
 
 		const char* getFilename() const;
+
+		//reads size bytes at offset, without using or changing the stream's position.
+		bool readAt(void* dst, int size, int offset);
+		//the same for writes, which only a WriteFileStream can do.
+		virtual bool writeAt(const void*, int, int) { FAIL; }
 		
 		virtual bool truncate(int size) { FAIL; }
 
+		//forgets any data read ahead, without changing the stream's position.
+		//call it after the file was changed through another stream.
+		virtual bool discardBuffer();
+
 #include "FileImpl.h"
 	};
 
@@ -67,6 +79,7 @@ namespace Base {
 		// else: create a file. overwrite any existing file.
 		WriteFileStream(const char* filename, bool append=false, bool exist=false);
 		bool write(const void* src, int size);
+		bool writeAt(const void* src, int size, int offset);
 		Stream* createLimitedCopy(int /*size*/) const { FAIL; }
 		Stream* createCopy() const { FAIL; }
 		bool truncate(int size);
@@ -79,16 +92,30 @@ namespace Base {
 #else
 		LimitedFileStream(const char* filename, int offset, int len, JNIEnv* jNIEnv, jobject jThis);
 #endif
+#ifdef FILESTREAM_SHARED_FD
+		//uses file's descriptor instead of opening the file again.
+		LimitedFileStream(const FileStream& file, int offset, int len);
+#endif
+		~LimitedFileStream();
 		bool read(void* dst, int size);
 
 		bool length(int& aLength) const;
 		bool seek(Seek::Enum mode, int offset);
 		bool tell(int& aPos) const;
+		bool discardBuffer();
 
 		Stream* createLimitedCopy(int size) const;
 		Stream* createCopy() const;
 	protected:
 		const int mStartPos, mEndPos;
+		//relative to mStartPos. reads use readAt(), so the file's own position
+		//is never used, and the descriptor can be shared.
+		//when mReadPtr and mReadEnd are set, mPos is the position of mReadEnd.
+		int mPos;
+		//the read window, allocated by the first small read.
+		byte* mWindow;
+		bool fillWindow(int needed);
+		int position() const { return mPos - (mReadEnd - mReadPtr); }
 		bool _open();
 #ifdef _android
 		JNIEnv* mJNIEnv;
@@ -45,15 +45,9 @@ inline int32_t fp_mul32(int32_t a, int32_t b) {
 	return (int32_t)(((int64_t)a * (int64_t)b)>>FP_RESOLUTION);
 }
 
-struct Point {
-	int x, y;
-};
+typedef Image::Point Point;
 
 #ifndef SYMBIAN
-static Point clippedPoints[2][16];
-static int numPoints[2];
-static int currentList = 0;
-
 enum ClipResult  {
 	BOTH_IN = 0,
 	BOTH_OUT = 1,
@@ -159,7 +153,10 @@ void initMulTable() {
 #endif
 }
 
-Image::Image() {
+Image::Image() :
+	currentList(0),
+	scissor(NULL)
+{
 }
 
 bool Image::hasData() {if(data==NULL) return false; return true;}
@@ -291,6 +288,8 @@ void Image::init(unsigned char *data, unsigned char *alpha, bool makeCopy, int a
 
 Image::Image(unsigned char *data, unsigned char *alpha, const ImageInitParams &params,
 	bool makeCopy, bool shouldFreeData, int alphaPitch) :
+	currentList(0),
+	scissor(NULL),
 	data(NULL),
 	alpha(NULL),
 	width(params.width),
@@ -321,6 +320,8 @@ Image::Image(unsigned char *data, unsigned char *alpha, const ImageInitParams &p
 }
 
 Image::Image(int width, int height, int pitch, PixelFormat pixelFormat) :
+	currentList(0),
+	scissor(NULL),
 	pixelFormat(pixelFormat),
 	data(NULL),
 	alpha(NULL),
@@ -336,6 +337,8 @@ Image::Image(int width, int height, int pitch, PixelFormat pixelFormat) :
 
 Image::Image(unsigned char *data, unsigned char *alpha, int width, int height, int pitch,
 PixelFormat pixelFormat, bool makeCopy, bool shouldFreeData, int alphaPitch) :
+	currentList(0),
+	scissor(NULL),
 	pixelFormat(pixelFormat),
 	data(NULL),
 	alpha(NULL),
@@ -813,6 +816,11 @@ void Image::drawLine(int x0, int y0, int x1, int y1, int realColor) {
 		y0 = fp_ceil(a.y);
 		y1 = fp_ceil(b.y);
 
+		if(scissor) {
+			drawLineScissored(x0, y0, x1, y1, color);
+			return;
+		}
+
 		int dy = y1 - y0;
 		int dx = x1 - x0;
 
@@ -974,6 +982,78 @@ void Image::drawLine(int x0, int y0, int x1, int y1, int realColor) {
 		*/
 }
 
+static inline void putPixel(Image* img, int x, int y, unsigned int color) {
+	switch(img->bytesPerPixel) {
+		case 2:
+			*((unsigned short*)&img->data[x*2 + y*img->pitch]) = color;
+			break;
+		case 4:
+			*((unsigned int*)&img->data[x*4 + y*img->pitch]) = color;
+			break;
+		default:
+			BIG_PHAT_ERROR(ERR_UNSUPPORTED_BPP);
+	}
+}
+
+// Steps through an already clipped line the same way drawLine() does,
+// but only writes the pixels inside the scissor rectangle.
+void Image::drawLineScissored(int x0, int y0, int x1, int y1, unsigned int color) {
+	int sLeft = scissor->x;
+	int sRight = scissor->x + scissor->width - 1;
+	int sTop = scissor->y;
+	int sBottom = scissor->y + scissor->height - 1;
+
+	int dy = y1 - y0;
+	int dx = x1 - x0;
+	int temp;
+
+	if(dx == 0) {
+		if(dy == 0) return;
+		if(x0 < sLeft || x0 > sRight) return;
+		if(y0 > y1) { SWAP(y1, y0, temp); }
+		if(y0 < sTop) y0 = sTop;
+		if(y1 > sBottom) y1 = sBottom;
+		for(int y = y0; y <= y1; y++)
+			putPixel(this, x0, y, color);
+		return;
+	}
+	else if(dy == 0) {
+		if(y0 < sTop || y0 > sBottom) return;
+		if(x0 > x1) { SWAP(x1, x0, temp); }
+		if(x0 < sLeft) x0 = sLeft;
+		if(x1 > sRight) x1 = sRight;
+		for(int x = x0; x <= x1; x++)
+			putPixel(this, x, y0, color);
+		return;
+	}
+
+	if(abs(dy)>abs(dx)) {
+		if(y1<y0) {SWAP(x1, x0, temp); SWAP(y1, y0, temp); }
+		int dxdy = (dx<<FP_RESOLUTION)/dy;
+		int yStart = y0 < sTop ? sTop : y0;
+		int yEnd = y1 > sBottom ? sBottom : y1;
+		int fx = (x0<<FP_RESOLUTION) + dxdy*(yStart-y0);
+		for(int y = yStart; y <= yEnd; y++) {
+			int x = fp_ceil(fx);
+			if(x >= sLeft && x <= sRight)
+				putPixel(this, x, y, color);
+			fx+=dxdy;
+		}
+	} else {
+		if(x1<x0) {SWAP(x1, x0, temp); SWAP(y1, y0, temp); }
+		int dydx = (dy<<FP_RESOLUTION)/dx;
+		int xStart = x0 < sLeft ? sLeft : x0;
+		int xEnd = x1 > sRight ? sRight : x1;
+		int fy = (y0<<FP_RESOLUTION) + dydx*(xStart-x0);
+		for(int x = xStart; x <= xEnd; x++) {
+			int y = fp_ceil(fy);
+			if(y >= sTop && y <= sBottom)
+				putPixel(this, x, y, color);
+			fy+=dydx;
+		}
+	}
+}
+
 void Image::drawFilledRect(int x, int y, int rectWidth, int rectHeight, int realColor) {
 		/* clip it ! */
 	if (x > clipRect.x + clipRect.width)
@@ -1168,6 +1248,22 @@ void initRecipLut() {
 	}
 }
 
+// Restricts a scanline span to the scissor rectangle, if there is one.
+// Returns false if nothing of the span remains.
+static inline bool scissorSpan(const ClipRect* s, int y, int& x, int& w) {
+	if(s) {
+		if(y < s->y || y >= s->y + s->height)
+			return false;
+		if(x < s->x) {
+			w -= s->x - x;
+			x = s->x;
+		}
+		if(x + w > s->x + s->width)
+			w = s->x + s->width - x;
+	}
+	return w > 0;
+}
+
 void Image::drawTriangleWithoutClipping(int x1, int y1, int x2, int y2, int x3, int y3, int color) {
 	int temp,
 		longest,
@@ -1243,13 +1339,32 @@ void Image::drawTriangleWithoutClipping(int x1, int y1, int x2, int y2, int x3,
 		x_mid_right = x_right + dxdy_right1*(y2-y1);
 	}
 
-	unsigned char *dst = &data[y1*pitch];
+	// row ranges of the upper and lower halves. with a scissor, skip the
+	// rows above it by stepping the edges forward in one go.
+	int ya = y1, yb = y2, yc = y2, yd = y3;
+	if(scissor) {
+		int sTop = scissor->y, sBottom = scissor->y + scissor->height;
+		if(ya < sTop) {
+			x_left += dxdy_left1*(sTop-ya);
+			x_right += dxdy_right1*(sTop-ya);
+			ya = sTop;
+		}
+		if(yc < sTop) {
+			x_mid_left += dxdy_left2*(sTop-yc);
+			x_mid_right += dxdy_right2*(sTop-yc);
+			yc = sTop;
+		}
+		if(yb > sBottom) yb = sBottom;
+		if(yd > sBottom) yd = sBottom;
+	}
+
+	unsigned char *dst = &data[ya*pitch];
 	switch(bytesPerPixel) {
 		case 2:
-			for(int y = y1; y < y2; y++) {
+			for(int y = ya; y < yb; y++) {
 				int x_start = fp_ceil(x_left);
 				int w = (fp_ceil(x_right)-x_start);
-				if(w>0) {
+				if(scissorSpan(scissor, y, x_start, w)) {
 					short *scan = (short*)dst;
 					scan+=x_start;
 					while(w--) *scan++=color;
@@ -1260,11 +1375,11 @@ void Image::drawTriangleWithoutClipping(int x1, int y1, int x2, int y2, int x3,
 			}
 			x_left = x_mid_left;
 			x_right = x_mid_right;
-			dst = &data[y2*pitch];
-			for(int y = y2; y < y3; y++) {
+			dst = &data[yc*pitch];
+			for(int y = yc; y < yd; y++) {
 				int x_start = fp_ceil(x_left);
 				int w = (fp_ceil(x_right)-x_start);
-				if(w>0) {
+				if(scissorSpan(scissor, y, x_start, w)) {
 					short *scan = (short*)dst;
 					scan+=x_start;
 					while(w--) *scan++=color;
@@ -1275,10 +1390,10 @@ void Image::drawTriangleWithoutClipping(int x1, int y1, int x2, int y2, int x3,
 			}
 			break;
 		case 4:
-			for(int y = y1; y < y2; y++) {
+			for(int y = ya; y < yb; y++) {
 				int x_start = fp_ceil(x_left);
 				int w = (fp_ceil(x_right)-x_start);
-				if(w>0) {
+				if(scissorSpan(scissor, y, x_start, w)) {
 					int *scan = (int*)dst;
 					scan+=x_start;
 					while(w--) *scan++=color;
@@ -1289,11 +1404,11 @@ void Image::drawTriangleWithoutClipping(int x1, int y1, int x2, int y2, int x3,
 			}
 			x_left = x_mid_left;
 			x_right = x_mid_right;
-			dst = &data[y2*pitch];
-			for(int y = y2; y < y3; y++) {
+			dst = &data[yc*pitch];
+			for(int y = yc; y < yd; y++) {
 				int x_start = fp_ceil(x_left);
 				int w = (fp_ceil(x_right)-x_start);
-				if(w>0) {
+				if(scissorSpan(scissor, y, x_start, w)) {
 					int *scan = (int*)dst;
 					scan+=x_start;
 					while(w--) *scan++=color;
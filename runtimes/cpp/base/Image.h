@@ -38,13 +38,27 @@ inline uint32_t rgb16_to_rgb32(int a, int redMask, int greenMask, int blueMask,
 
 /* should make it refcounted. */
 class Image {
+public:
+	// fixed-point vertex, used by the clipping code.
+	struct Point {
+		int x, y;
+	};
+
 private:
+	// polygon clipping state. it lives in the instance rather than in static
+	// storage so that separate Image objects sharing one framebuffer can be
+	// rasterised from different threads (see TileRenderer).
+	Point clippedPoints[2][16];
+	int numPoints[2];
+	int currentList;
+
 	bool clipPolygon();
 	void clipPolygonTop(int src, int dst);
 	void clipPolygonLeft(int src, int dst);
 	void clipPolygonRight(int src, int dst);
 	void clipPolygonBottom(int src, int dst);
 	void drawTriangleWithoutClipping(int x1, int y1, int x2, int y2, int x3, int y3, int color);
+	void drawLineScissored(int x0, int y0, int x1, int y1, unsigned int color);
 
 public:
 	enum PixelFormat {
@@ -100,6 +114,12 @@ public:
 
 	ClipRect		clipRect;
 
+	// If non-NULL, lines and triangles only write pixels inside this rectangle.
+	// Unlike clipRect, it does not affect how the primitives are clipped, so
+	// a primitive drawn in pieces with different scissors produces exactly
+	// the same pixels as when drawn in one go.
+	const ClipRect*	scissor;
+
 #ifdef SYMBIAN
 	// must be set before use.
 	unsigned char* mulTable;
@@ -0,0 +1,290 @@
+/* Copyright 2013 David Axmark
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+	http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "config_platform.h"
+#include <helpers/helpers.h>
+#include "Stream.h"
+#include "PcmCache.h"
+#include "PcmRing.h"
+
+using namespace Base;
+
+//*****************************************************************************
+//PcmBuffer
+//*****************************************************************************
+
+PcmBuffer::PcmBuffer ( const AudioSource::Info& i )
+: info( i ),
+  complete( false ),
+  abandoned( false ),
+  mRefs( 1 )
+{
+}
+
+void PcmBuffer::addRef ( void )
+{
+	mRefs++;
+}
+
+void PcmBuffer::release ( void )
+{
+	DEBUG_ASSERT(mRefs > 0);
+	if ( --mRefs == 0 )
+		delete this;
+}
+
+//*****************************************************************************
+//PcmKey
+//*****************************************************************************
+
+// FNV-1a
+static unsigned int hashBytes ( unsigned int hash, const unsigned char* p, int size )
+{
+	for ( int i = 0; i < size; i++ )
+	{
+		hash ^= p[i];
+		hash *= 16777619;
+	}
+	return hash;
+}
+
+bool PcmKey::init ( int h, Stream& data, int o, int s )
+{
+	handle = h;
+	offset = o;
+	size = s;
+	hash = 2166136261u;
+
+	int len;
+	if ( !data.length( len ) || o < 0 || s < 0 || o + s > len )
+		return false;
+
+	const unsigned char* p = (const unsigned char*)data.ptrc( );
+	if ( p )
+	{
+		hash = hashBytes( hash, p + o, s );
+		return true;
+	}
+
+	if ( !data.seek( Seek::Start, o ) )
+		return false;
+	unsigned char buf[4096];
+	while ( s > 0 )
+	{
+		int n = MIN(s, (int)sizeof(buf));
+		if ( !data.read( buf, n ) )
+			return false;
+		hash = hashBytes( hash, buf, n );
+		s -= n;
+	}
+	return true;
+}
+
+bool PcmKey::operator== ( const PcmKey& k ) const
+{
+	return handle == k.handle && offset == k.offset && size == k.size && hash == k.hash;
+}
+
+//*****************************************************************************
+//PcmCache
+//*****************************************************************************
+
+PcmCache::PcmCache ( int maxBytes, int maxEntryBytes )
+: mBytes( 0 ),
+  mMaxBytes( maxBytes ),
+  mMaxEntryBytes( maxEntryBytes )
+{
+}
+
+PcmCache::~PcmCache()
+{
+	clear();
+}
+
+void PcmCache::clear ( void )
+{
+	for ( std::list<Entry>::iterator i = mEntries.begin(); i != mEntries.end(); i++ )
+		i->pcm->release();
+	for ( std::list<Entry>::iterator i = mPending.begin(); i != mPending.end(); i++ )
+		i->pcm->release();
+	mEntries.clear();
+	mPending.clear();
+	mBytes = 0;
+}
+
+int PcmCache::getBytes ( void ) const
+{
+	return mBytes;
+}
+
+int PcmCache::getMaxEntryBytes ( void ) const
+{
+	return mMaxEntryBytes;
+}
+
+void PcmCache::addPending ( const PcmKey& key, PcmBuffer* pcm )
+{
+	Entry e = { key, pcm };
+	pcm->addRef();
+	mPending.push_back(e);
+}
+
+// Moves the buffers that have been completed into the cache,
+// and drops the ones that never will be.
+void PcmCache::collectPending ( void )
+{
+	std::list<Entry>::iterator i = mPending.begin();
+	while ( i != mPending.end() )
+	{
+		if ( i->pcm->complete )
+		{
+			// the data was written before the flag.
+			pcmMemoryBarrier();
+			insert( *i );
+			i = mPending.erase( i );
+		}
+		else if ( i->pcm->abandoned )
+		{
+			i->pcm->release();
+			i = mPending.erase( i );
+		}
+		else
+			i++;
+	}
+}
+
+// Takes over the entry's reference.
+void PcmCache::insert ( const Entry& e )
+{
+	for ( std::list<Entry>::iterator i = mEntries.begin(); i != mEntries.end(); i++ )
+	{
+		if ( i->key == e.key )
+		{
+			// decoded twice, by sources that played at the same time.
+			e.pcm->release();
+			return;
+		}
+	}
+
+	mEntries.push_front( e );
+	mBytes += (int)e.pcm->data.size();
+	while ( mBytes > mMaxBytes && mEntries.size() > 1 )
+	{
+		Entry& last = mEntries.back();
+		mBytes -= (int)last.pcm->data.size();
+		last.pcm->release();
+		mEntries.pop_back();
+	}
+}
+
+PcmBuffer* PcmCache::find ( const PcmKey& key )
+{
+	collectPending();
+	for ( std::list<Entry>::iterator i = mEntries.begin(); i != mEntries.end(); i++ )
+	{
+		if ( i->key == key )
+		{
+			mEntries.splice( mEntries.begin(), mEntries, i );
+			PcmBuffer* pcm = mEntries.front().pcm;
+			pcm->addRef();
+			return pcm;
+		}
+	}
+	return NULL;
+}
+
+//*****************************************************************************
+//PcmCacheSource
+//*****************************************************************************
+
+PcmCacheSource::PcmCacheSource ( PcmBuffer* pcm )
+: mPcm( pcm ),
+  mPos( 0 ),
+  mChunk( 0 ),
+  mNumLoops( 1 )
+{
+	mPcm->addRef();
+	info = mPcm->info;
+}
+
+PcmCacheSource::~PcmCacheSource()
+{
+	mPcm->release();
+}
+
+int PcmCacheSource::init()
+{
+	return 0;
+}
+
+int PcmCacheSource::fillBuffer()
+{
+	MutexHandler mutex(&mMutex);
+	int frameSize = getFrameSize();
+	int size = (int)mPcm->data.size();
+	if ( mPos >= size )
+	{
+		if ( mNumLoops == 1 || size == 0 )
+			return 0;
+		if ( mNumLoops > 1 )
+			mNumLoops--;
+		mPos = 0;
+	}
+	int n = MIN(info.bufferSize, size - mPos);
+	n -= n % frameSize;
+	if ( n <= 0 )
+	{
+		mPos = size;
+		return 0;
+	}
+	mChunk = mPos;
+	mPos += n;
+	return n / frameSize;
+}
+
+const void* PcmCacheSource::getBuffer() const
+{
+	if ( mPcm->data.empty() )
+		return NULL;
+	return &mPcm->data[mChunk];
+}
+
+void PcmCacheSource::setPosition(int ms)
+{
+	MutexHandler mutex(&mMutex);
+	int frameSize = getFrameSize();
+	int pos = (int)(((long long)ms * info.sampleRate / 1000) * frameSize);
+	mPos = MAX(0, MIN(pos, (int)mPcm->data.size()));
+}
+
+int PcmCacheSource::getPosition() const
+{
+	return 0;
+}
+
+int PcmCacheSource::getLength() const
+{
+	return 0;
+}
+
+void PcmCacheSource::setNumLoops(int i)
+{
+	mNumLoops = i;
+}
+
+int PcmCacheSource::getNumLoops()
+{
+	return mNumLoops;
+}
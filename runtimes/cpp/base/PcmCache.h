@@ -0,0 +1,153 @@
+/* Copyright 2013 David Axmark
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+	http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef _PCM_CACHE_H_
+#define _PCM_CACHE_H_
+
+#include <list>
+#include <vector>
+#include "AudioSource.h"
+
+namespace Base {
+	class Stream;
+};
+
+/**
+ * A whole sound, decoded. It is reference counted, because a cache and
+ * any number of sources may share it. The references are only taken and
+ * dropped on the main thread.
+ */
+class PcmBuffer {
+public:
+	PcmBuffer ( const AudioSource::Info& i );
+
+	void addRef ( void );
+	void release ( void );
+
+	AudioSource::Info info;
+	std::vector<char> data;
+
+	// Set by the decode thread when data holds the whole sound.
+	// It doesn't touch the buffer after that.
+	volatile bool complete;
+
+	// Set when the sound won't be complete, because it was too long,
+	// or its decoder was deleted first.
+	volatile bool abandoned;
+
+private:
+	~PcmBuffer() {}
+	int mRefs;
+};
+
+/**
+ * Identifies the encoded sound at \a offset in a binary resource.
+ * The hash of the encoded bytes tells if the resource was changed,
+ * or replaced, since the sound was decoded.
+ */
+struct PcmKey {
+	int handle;
+	int offset;
+	int size;
+	unsigned int hash;
+
+	/**
+	 * Hashes \a size bytes at \a offset in \a data.
+	 *
+	 * @return false if they couldn't be read.
+	 */
+	bool init ( int h, Base::Stream& data, int o, int s );
+
+	bool operator== ( const PcmKey& k ) const;
+};
+
+/**
+ * The decoded PCM of the most recently played short sounds, so that
+ * playing one again doesn't decode it again. The least recently played
+ * sounds are dropped when the cache is full.
+ * Not thread safe; it's used from the main thread.
+ */
+class PcmCache {
+public:
+	/**
+	 * @param maxBytes      The most PCM bytes that are kept.
+	 * @param maxEntryBytes The most PCM bytes of one sound.
+	 */
+	PcmCache ( int maxBytes, int maxEntryBytes );
+	~PcmCache();
+
+	/**
+	 * Returns the PCM of the sound \a key, with a reference the
+	 * caller must release, or NULL if it isn't cached.
+	 */
+	PcmBuffer* find ( const PcmKey& key );
+
+	/**
+	 * Caches \a pcm under \a key once its decoder has completed it.
+	 * Takes a reference.
+	 */
+	void addPending ( const PcmKey& key, PcmBuffer* pcm );
+
+	void clear ( void );
+
+	int getBytes ( void ) const;
+	int getMaxEntryBytes ( void ) const;
+
+private:
+	struct Entry {
+		PcmKey key;
+		PcmBuffer* pcm;
+	};
+
+	void collectPending ( void );
+	void insert ( const Entry& e );
+
+	// the most recently used first.
+	std::list<Entry> mEntries;
+	std::list<Entry> mPending;
+	int mBytes;
+	int mMaxBytes;
+	int mMaxEntryBytes;
+};
+
+/**
+ * Plays a PcmBuffer, without decoding anything.
+ */
+class PcmCacheSource : public AudioSource {
+public:
+	// takes a reference.
+	PcmCacheSource ( PcmBuffer* pcm );
+	virtual ~PcmCacheSource();
+
+	int init();
+
+	int fillBuffer();
+	const void* getBuffer() const;
+
+	void setPosition(int ms);
+	int getPosition() const;
+	int getLength() const;
+
+	void setNumLoops(int i);
+	int getNumLoops();
+
+private:
+	PcmBuffer* mPcm;
+	int mPos;
+	int mChunk;
+	int mNumLoops;
+};
+
+#endif /* _PCM_CACHE_H_ */
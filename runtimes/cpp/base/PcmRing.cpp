@@ -0,0 +1,96 @@
+/* Copyright 2013 David Axmark
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+	http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <string.h>
+#include "PcmRing.h"
+
+PcmRing::PcmRing ( int capacity )
+: mWritten( 0 ),
+  mRead( 0 )
+{
+	unsigned int size = 16;
+	while ( size < (unsigned int)capacity )
+		size <<= 1;
+	mBuffer = new char[size];
+	mMask = size - 1;
+}
+
+PcmRing::~PcmRing()
+{
+	delete[] mBuffer;
+}
+
+int PcmRing::readable ( void ) const
+{
+	return (int)(mWritten - mRead);
+}
+
+int PcmRing::writable ( void ) const
+{
+	return (int)(mMask + 1 - (mWritten - mRead));
+}
+
+int PcmRing::write ( const void* src, int size )
+{
+	unsigned int pos = mWritten;
+	int n = writable();
+	// the reader's index is read before the bytes it has freed are reused.
+	pcmMemoryBarrier();
+	if ( size < n )
+		n = size;
+	if ( n <= 0 )
+		return 0;
+
+	unsigned int start = pos & mMask;
+	int first = (int)(mMask + 1 - start);
+	if ( first > n )
+		first = n;
+	memcpy( mBuffer + start, src, first );
+	memcpy( mBuffer, (const char*)src + first, n - first );
+
+	// the bytes are in place before the reader can see them.
+	pcmMemoryBarrier();
+	mWritten = pos + n;
+	return n;
+}
+
+int PcmRing::read ( void* dst, int size )
+{
+	unsigned int pos = mRead;
+	int n = readable();
+	// the writer's index is read before the bytes it covers.
+	pcmMemoryBarrier();
+	if ( size < n )
+		n = size;
+	if ( n <= 0 )
+		return 0;
+
+	unsigned int start = pos & mMask;
+	int first = (int)(mMask + 1 - start);
+	if ( first > n )
+		first = n;
+	memcpy( dst, mBuffer + start, first );
+	memcpy( (char*)dst + first, mBuffer, n - first );
+
+	// the bytes are copied out before the writer can reuse them.
+	pcmMemoryBarrier();
+	mRead = pos + n;
+	return n;
+}
+
+void PcmRing::clear ( void )
+{
+	mRead = mWritten;
+}
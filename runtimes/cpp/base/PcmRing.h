@@ -0,0 +1,90 @@
+/* Copyright 2013 David Axmark
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+	http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef _PCM_RING_H_
+#define _PCM_RING_H_
+
+#ifdef _MSC_VER
+#include <windows.h>
+#endif
+
+/**
+ * Orders the memory accesses before it with the ones after it,
+ * for the compiler and the CPU.
+ */
+static inline void pcmMemoryBarrier() {
+#ifdef _MSC_VER
+	MemoryBarrier();
+#else
+	__sync_synchronize();
+#endif
+}
+
+/**
+ * A ring buffer of bytes, for one thread that writes and one that reads.
+ * It needs no lock: each side only moves its own index, and publishes
+ * it after the bytes it covers.
+ */
+class PcmRing {
+public:
+	/**
+	 * @param capacity  The minimum number of bytes the ring holds.
+	 *                  It is rounded up to a power of 2.
+	 */
+	PcmRing ( int capacity );
+	~PcmRing();
+
+	/**
+	 * Returns the number of bytes that can be read.
+	 * Only to be called by the reader.
+	 */
+	int readable ( void ) const;
+
+	/**
+	 * Returns the number of bytes that can be written.
+	 * Only to be called by the writer.
+	 */
+	int writable ( void ) const;
+
+	/**
+	 * Copies up to \a size bytes into the ring.
+	 *
+	 * @return The number of bytes copied.
+	 */
+	int write ( const void* src, int size );
+
+	/**
+	 * Copies up to \a size bytes out of the ring.
+	 *
+	 * @return The number of bytes copied.
+	 */
+	int read ( void* dst, int size );
+
+	/**
+	 * Drops everything in the ring.
+	 * Only to be called while neither the writer nor the reader runs.
+	 */
+	void clear ( void );
+
+private:
+	char* mBuffer;
+	unsigned int mMask;
+
+	// free-running; the number of bytes ever written and read.
+	volatile unsigned int mWritten;
+	volatile unsigned int mRead;
+};
+
+#endif /* _PCM_RING_H_ */
@@ -25,10 +25,6 @@ namespace Base {
 	//Stream
 	//******************************************************************************
 
-	bool Stream::readByte(byte& b) {
-		TEST(read(&b, 1));
-		return true;
-	}
 	bool Stream::readUnsignedVarInt(int& res) {
 		int nBytes=0;
 		res = 0;
@@ -68,6 +64,11 @@ namespace Base {
 		return true;
 	}
 	bool Stream::readUnsignedShort(ushort& res) {
+		if(mReadEnd - mReadPtr >= 2) {
+			res = mReadPtr[0] | (mReadPtr[1] << 8);
+			mReadPtr += 2;
+			return true;
+		}
 		Stream& file = *this; //to placate the macros
 		DAR_UBYTE(d);
 		DAR_UBYTE(c);
@@ -75,10 +76,9 @@ namespace Base {
 		return true;
 	}
 	bool Stream::readShort(short& res) {
-		Stream& file = *this; //to placate the macros
-		DAR_UBYTE(d);
-		DAR_UBYTE(c);
-		res = (((ushort(c) & 0xff) << 8) | (ushort(d) & 0xff));
+		ushort u;
+		TEST(readUnsignedShort(u));
+		res = (short)u;
 		return true;
 	}
 	bool Stream::readFully(MemStream& dst) {
@@ -117,6 +117,7 @@ namespace Base {
 	}
 
 	bool Stream::writeStream(Stream& src, int size) {
+		TEST(size >= 0);
 		const void* psrc = src.ptrc();
 		if(psrc) {	//memory source stream
 			int pos;
@@ -125,18 +126,33 @@ namespace Base {
 			TEST(src.length(srcSize));
 			TEST(pos + size <= srcSize);
 			TEST(this->write((char*)psrc + pos, size));
-		} else {
-			void* pdst = this->ptr();
-			if(pdst) {	//memory destination stream
-				TEST(src.read(pdst, size));
-			} else {
-				Smartie<char> temp(new char[size]);
-				TEST(temp);
-				TEST(src.read(temp(), size));
-				TEST(this->write(temp(), size));
-			}
+			return true;
 		}
-		return true;
+		void* pdst = this->ptr();
+		if(pdst) {	//memory destination stream
+			int pos;
+			TEST(this->tell(pos));
+			int dstSize;
+			TEST(this->length(dstSize));
+			TEST(pos + size <= dstSize);
+			TEST(src.read((char*)pdst + pos, size));
+			TEST(this->seek(Seek::Current, size));
+			return true;
+		}
+		//neither stream is in memory. copy through a buffer of bounded size.
+		int chunkSize = MIN(size, (int)COPY_CHUNK_SIZE);
+		if(chunkSize == 0)
+			return true;
+		char* temp = new char[chunkSize];
+		TEST(temp);
+		bool res = true;
+		while(res && size > 0) {
+			int len = MIN(size, chunkSize);
+			res = src.read(temp, len) && this->write(temp, len);
+			size -= len;
+		}
+		delete[] temp;
+		return res;
 	}
 
 }
@@ -42,11 +42,20 @@ namespace Base {
 
 	class Stream {	//A read-write, seekable stream interface
 	public:
+		Stream() : mReadPtr(NULL), mReadEnd(NULL) {}
+
 		virtual bool isOpen() const = 0;
 		virtual bool read(void* dst, int size) = 0;
 		virtual bool write(const void* src, int size) = 0;
 
-		bool readByte(byte& b);
+		//takes the byte from the read buffer, if there is one.
+		bool readByte(byte& b) {
+			if(mReadPtr != mReadEnd) {
+				b = *mReadPtr++;
+				return true;
+			}
+			return read(&b, 1);
+		}
 		bool readUnsignedVarInt(int& res);
 		bool readSignedVarInt(int& res);
 		bool readUnsignedShort(ushort& res);
@@ -65,7 +74,9 @@ namespace Base {
 
 		//writes some of src to this stream.
 		//respects both src's and this stream's position.
+		//if neither stream is in memory, the data is copied in chunks of COPY_CHUNK_SIZE.
 		bool writeStream(Stream& src, int size);
+		enum { COPY_CHUNK_SIZE = 32*1024 };
 
 		//supported by all so far, except connection streams.
 		virtual bool length(int& aLength) const = 0;
@@ -92,6 +103,14 @@ namespace Base {
 		virtual Stream* createCopy() const = 0;
 
 		virtual ~Stream() {}
+
+	protected:
+		//the unread part of the stream's read buffer, if it has one.
+		//readByte() and the functions built on it take bytes from here without
+		//calling read(). a stream that sets these must include the unread bytes
+		//when it reports its position, and drop them when it seeks or writes.
+		const byte* mReadPtr;
+		const byte* mReadEnd;
 	};
 
 } // namespace Base
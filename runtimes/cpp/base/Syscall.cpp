@@ -15,6 +15,7 @@ limitations under the License.
 
 #include <math.h>
 #include <limits.h>
+#include <ctype.h>
 
 #ifndef _WIN32_WCE
 #include <errno.h>
@@ -45,7 +46,7 @@ limitations under the License.
 
 #if !defined(SYMBIAN) && !defined(_android)
 #include <vector>
-#include <set>
+#include <algorithm>
 #include "helpers/mkdir.h"
 #endif
 
@@ -100,27 +101,70 @@ namespace Base {
 #endif	//RESOURCE_MEMORY_LIMIT
 
 #if !defined(SYMBIAN) && !defined(_android)
-#if defined(_WIN32_WCE)
+	/// An entry in a file listing.
 	struct FileListItem {
+		/// Relative to the listed directory. Directory names end with a slash.
 		std::string name;
+		/// One of the FILELIST_TYPE constants.
+		int type;
+		/// True if size and mtime are valid.
+		bool haveInfo;
+		long long size;
+		time_t mtime;
 	};
-	struct FileList {
-		std::vector<FileListItem> files;
-		std::vector<FileListItem>::const_iterator itr;
-	};
-#else
-	struct FileListItem {
-		std::string name;
-		struct stat s;
-		int sorting;
-		bool operator<(const FileListItem&) const;
-	};
-	struct FileList {
-		std::set<FileListItem> files;
-		std::set<FileListItem>::const_iterator itr;
+
+	/// A file listing. Reads the whole tree when it is started, unless it's lazy,
+	/// in which case it reads the directories one entry at a time, as the
+	/// entries are requested.
+	class FileList {
+	public:
+		/// \param realDir The directory on the host file system, ending with a slash.
+		FileList(const std::string& realDir, const std::string& filter,
+			int sorting, int maxDepth);
+		~FileList();
+
+		/// Opens the listed directory and, unless the listing is lazy,
+		/// reads all the entries. Returns false, and leaves the listing
+		/// empty, if the directory can't be opened.
+		bool start();
+
+		/// Adds an entry to a listing that is not lazy, instead of calling start().
+		void add(const FileListItem&);
+
+		/// Returns the next entry, or NULL if there are no more.
+		FileListItem* peek();
+		/// Moves past the entry returned by peek().
+		void advance();
+
+		/// Fills in the size and mtime of an entry, if it doesn't have them already.
+		void getInfo(FileListItem&) const;
+
+	private:
+		/// A directory being read.
+		struct Level {
+			DirectoryStream* ds;
+			/// Path from the listed directory, ending with a slash, or empty.
+			std::string prefix;
+			int depth;
+		};
+
+		/// Reads the next matching entry from the directory tree.
+		bool readNext(FileListItem&);
+
+		std::string mRealDir, mFilter;
+		int mSorting, mMaxDepth;
+		bool mLazy;
+		std::vector<Level> mLevels;
+
+		// Used if not lazy.
+		std::vector<FileListItem> mItems;
+		size_t mPos;
+
+		// Used if lazy.
+		FileListItem mPending;
+		bool mHavePending;
 	};
-#endif	//_WIN32_WCE
-	typedef std::map<int, FileList> FileListMap;
+	typedef std::map<int, FileList*> FileListMap;
 	typedef FileListMap::iterator FileListItr;
 	static FileListMap sFileListings;
 	static int sFileListNextHandle = 1;
@@ -170,6 +214,9 @@ namespace Base {
 
 		// rI is the resource index.
 		int rI = 1;
+#if !defined(SYMBIAN) && !defined(_android)
+		std::vector<AtlasImage> atlasImages;
+#endif
 
 		while(true) {
 			DAR_UBYTE(type);
@@ -180,9 +227,14 @@ namespace Base {
 
 			DAR_UVINT(size);
 			LOG_RES("Type %i, size %i\n", type, size);
+#if !defined(SYMBIAN) && !defined(_android)
+			// the resource replaces whatever was in the handle.
+			forgetTileSetSize(rI);
+#endif
 
 			switch(type) {
 			case RT_BINARY:
+			case RT_TILEMAP:	// a tile map is plain data; see maTileMapAddLayer().
 				{
 #ifndef _android
 					MemStream* ms = new MemStream(size);
@@ -267,6 +319,22 @@ namespace Base {
 #endif
 				}
 				break;
+#if !defined(SYMBIAN) && !defined(_android)
+			case RT_TILESET:
+				TEST(loadTileSet(file, rI, size));
+				break;
+			case RT_ATLAS:
+				TEST(loadAtlas(file, rI));
+				break;
+			case RT_ATLAS_IMAGE:
+				{
+					// the atlas comes after its images, so they are added below.
+					AtlasImage img;
+					TEST(readAtlasImage(file, rI, img));
+					atlasImages.push_back(img);
+				}
+				break;
+#endif
 			case RT_LABEL:
 				{
 					MemStream b(size);
@@ -299,6 +367,11 @@ namespace Base {
 			LOG("rI %i, nR %i\n", rI, nResources);
 			BIG_PHAT_ERROR(ERR_RES_FILE_INCONSISTENT);
 		}
+#if !defined(SYMBIAN) && !defined(_android)
+		for(size_t i = 0; i < atlasImages.size(); i++) {
+			TEST(addAtlasImage(atlasImages[i]));
+		}
+#endif
 		LOG_RES("ResLoad complete\n");
 		return true;
 	}
@@ -332,6 +405,10 @@ namespace Base {
 			return true;
 		}
 
+#ifdef FILESTREAM_SHARED_FD
+		Smartie<FileStream> ubinFile;
+#endif
+
 #define MATCH_BYTE(c) { DAR_UBYTE(b); if(b != c) { FAIL; } }
 		MATCH_BYTE('M');
 		MATCH_BYTE('A');
@@ -374,7 +451,14 @@ namespace Base {
 					int pos;
 					MYASSERT(aFilename, ERR_RES_LOAD_UBIN);
 					TEST(file.tell(pos));
-#ifndef _android
+#ifdef FILESTREAM_SHARED_FD
+					// all the ubins share one descriptor.
+					if(!ubinFile) {
+						ubinFile = new FileStream(aFilename);
+					}
+					ROOM(resources.dadd_RT_BINARY(rI,
+						new LimitedFileStream(*ubinFile, pos, size)));
+#elif !defined(_android)
 					ROOM(resources.dadd_RT_BINARY(rI,
 						new LimitedFileStream(aFilename, pos, size)));
 #else
@@ -460,6 +544,7 @@ namespace Base {
 
 		switch(type) {
 		case RT_BINARY:
+		case RT_TILEMAP:
 			{
 #ifndef _android
 				MemStream* ms = new MemStream(size);
@@ -519,6 +604,23 @@ namespace Base {
 #endif
 				}
 				break;
+#if !defined(SYMBIAN) && !defined(_android)
+			case RT_TILESET:
+				TEST(loadTileSet(file, rI, size));
+				break;
+			case RT_ATLAS:
+				TEST(loadAtlas(file, rI));
+				break;
+			case RT_ATLAS_IMAGE:
+				{
+					AtlasImage img;
+					TEST(readAtlasImage(file, rI, img));
+					if(!resources.is_loaded(img.atlas))
+						TEST(loadResource(file, img.atlas, img.atlas));
+					TEST(addAtlasImage(img));
+				}
+				break;
+#endif
 		default:
 			LOG("Cannot load resource type %d.", type);
 		}
@@ -529,6 +631,71 @@ namespace Base {
 	{
 		return resourcesCount;
 	}
+
+#if !defined(SYMBIAN) && !defined(_android)
+	/*
+	* A tile set is an image, preceded by the size of its tiles.
+	*/
+	bool Syscall::loadTileSet(Stream& file, MAHandle rI, int size) {
+		DAR_USHORT(tileWidth);
+		DAR_USHORT(tileHeight);
+		MemStream b(size - 4);
+		TEST(file.readFully(b));
+		RT_IMAGE_Type* image = loadImage(b);
+		if(!image)
+			BIG_PHAT_ERROR(ERR_IMAGE_LOAD_FAILED);
+		ROOM(resources.dadd_RT_IMAGE(rI, image));
+		mTileSetSizes[rI] = EXTENT(tileWidth, tileHeight);
+		return true;
+	}
+
+	MAExtent Syscall::getTileSetSize(MAHandle tileSet) {
+		std::map<int, MAExtent>::const_iterator itr = mTileSetSizes.find(tileSet);
+		if(itr == mTileSetSizes.end())
+			return 0;
+		return itr->second;
+	}
+
+	void Syscall::forgetTileSetSize(MAHandle handle) {
+		mTileSetSizes.erase(handle);
+	}
+
+	/*
+	* An atlas is one image composed of several image files, and the
+	* atlas images are rects in it. See '.atlas' in the resource compiler.
+	*/
+	bool Syscall::loadAtlas(Stream& file, MAHandle rI) {
+		RT_IMAGE_Type* atlas = loadAtlasPage(file);
+		if(!atlas)
+			BIG_PHAT_ERROR(ERR_IMAGE_LOAD_FAILED);
+		ROOM(resources.dadd_RT_IMAGE(rI, atlas));
+		return true;
+	}
+
+	bool Syscall::readAtlasImage(Stream& file, MAHandle rI, AtlasImage& img) {
+		DAR_USHORT(atlas);
+		DAR_USHORT(left);
+		DAR_USHORT(top);
+		DAR_USHORT(width);
+		DAR_USHORT(height);
+		img.handle = rI;
+		img.atlas = atlas;
+		img.left = left;
+		img.top = top;
+		img.width = width;
+		img.height = height;
+		return true;
+	}
+
+	bool Syscall::addAtlasImage(const AtlasImage& img) {
+		RT_IMAGE_Type* image = loadAtlasImage(resources.get_RT_IMAGE(img.atlas),
+			img.left, img.top, img.width, img.height);
+		if(!image)
+			BIG_PHAT_ERROR(ERR_IMAGE_LOAD_FAILED);
+		ROOM(resources.dadd_RT_IMAGE(img.handle, image));
+		return true;
+	}
+#endif
 }	//namespace Base
 
 	//***************************************************************************
@@ -539,8 +706,10 @@ namespace Base {
 		return ::memcpy(dst, src, size);
 	}
 	SYSCALL(void*, __memcpy(void* dst, const void* src, unsigned long size)) {
+#ifndef SYSCALL_TABLE_DISPATCH	// validated by the core
 		SYSCALL_THIS->ValidateMemRange(dst, size);
 		SYSCALL_THIS->ValidateMemRange(src, size);
+#endif
 		return SPECIAL(memcpy)(dst, src, size);
 	}
 
@@ -548,7 +717,9 @@ namespace Base {
 		return ::memset(dst, val, size);
 	}
 	SYSCALL(void*, __memset(void* dst, int val, unsigned long size)) {
+#ifndef SYSCALL_TABLE_DISPATCH
 		SYSCALL_THIS->ValidateMemRange(dst, size);
+#endif
 		return SPECIAL(memset)(dst, val, size);
 	}
 
@@ -712,6 +883,9 @@ namespace Base {
 		{
 			SYSCALL_THIS->destroyResource(handle);
 		}
+#endif
+#if !defined(SYMBIAN) && !defined(_android)
+		SYSCALL_THIS->forgetTileSetSize(handle);
 #endif
 		SYSCALL_THIS->resources.destroy(handle);
 
@@ -742,13 +916,17 @@ namespace Base {
 		return len;
 	}
 	SYSCALL(void, maReadData(MAHandle data, void* dst, int offset, int size)) {
+#ifndef SYSCALL_TABLE_DISPATCH
 		SYSCALL_THIS->ValidateMemRange(dst, size);
+#endif
 		Stream* b = SYSCALL_THIS->resources.get_RT_BINARY(data);
 		MYASSERT(b->seek(Seek::Start, offset), ERR_DATA_OOB);
 		MYASSERT(b->read(dst, size), ERR_DATA_OOB);
 	}
 	SYSCALL(void, maWriteData(MAHandle data, const void* src, int offset, int size)) {
+#ifndef SYSCALL_TABLE_DISPATCH
 		SYSCALL_THIS->ValidateMemRange(src, size);
+#endif
 		Stream* b = SYSCALL_THIS->resources.get_RT_BINARY(data);
 		MYASSERT(b->seek(Seek::Start, offset), ERR_DATA_OOB);
 		MYASSERT(b->write(src, size), ERR_DATA_OOB);
@@ -1094,6 +1272,19 @@ namespace Base {
 		return *fhp;
 	}
 
+	// called after every write, so that reads through other handles,
+	// like newlib's descriptors, see the new data.
+	void Syscall::discardFileBuffers(const FileHandle& writer) {
+		FileMap::TIteratorC itr = gFileHandles.begin();
+		while(itr.hasMore()) {
+			FileHandle* fhp = itr.next().value;
+			if(fhp == &writer || !fhp->fs)
+				continue;
+			if(strcmp(fhp->name, writer.name) == 0)
+				fhp->fs->discardBuffer();
+		}
+	}
+
 	int Syscall::maFileExists(MAHandle file) {
 		LOGF("maFileExists(%i)\n", file);
 		FileHandle& fh(getFileHandle(file));
@@ -1373,6 +1564,7 @@ namespace Base {
 		if(!fh.fs) FILE_FAIL(MA_FERR_GENERIC);
 		if(!fh.fs->isOpen()) FILE_FAIL(MA_FERR_GENERIC);
 		if(!fh.fs->truncate(offset)) FILE_FAIL(MA_FERR_GENERIC);
+		discardFileBuffers(fh);
 		return 0;
 	}
 #endif	//SYMBIAN && _WIN32_WCE
@@ -1383,6 +1575,7 @@ namespace Base {
 		if(!fh.fs)
 			FILE_FAIL(MA_FERR_GENERIC);
 		bool res = fh.fs->write(src, len);
+		discardFileBuffers(fh);
 		if(!res)
 			FILE_FAIL(MA_FERR_GENERIC);
 		return 0;
@@ -1397,6 +1590,7 @@ namespace Base {
 		if(!fh.fs)
 			FILE_FAIL(MA_FERR_GENERIC);
 		bool res = fh.fs->writeStream(*b, len);
+		discardFileBuffers(fh);
 		if(!res)
 			FILE_FAIL(MA_FERR_GENERIC);
 		return 0;
@@ -1461,112 +1655,368 @@ namespace Base {
 		return pos;
 	}
 
+	// The positional functions don't use or change the file's position,
+	// so that they can be mixed freely with maFileRead() and maFileWrite().
+	int Syscall::maFileReadAt(MAHandle file, void* dst, int len, int offset) {
+		LOGF("maFileReadAt(%i, 0x%"PFP", %i, %i)\n", file, dst, len, offset);
+		FileHandle& fh(getFileHandle(file));
+		MYASSERT(fh.fs, ERR_FILE_CLOSED);
+		if(len < 0 || offset < 0)
+			FILE_FAIL(MA_FERR_GENERIC);
+		int size;
+		if(!fh.fs->length(size))
+			FILE_FAIL(MA_FERR_GENERIC);
+		if(offset >= size)
+			return 0;
+		len = MIN(len, size - offset);
+		if(!fh.fs->readAt(dst, len, offset))
+			FILE_FAIL(MA_FERR_GENERIC);
+		return len;
+	}
+
+	int Syscall::maFileWriteAt(MAHandle file, const void* src, int len, int offset) {
+		LOGF("maFileWriteAt(%i, 0x%"PFP", %i, %i)\n", file, src, len, offset);
+		FileHandle& fh(getFileHandle(file));
+		MYASSERT(fh.fs, ERR_FILE_CLOSED);
+		if(len < 0 || offset < 0)
+			FILE_FAIL(MA_FERR_GENERIC);
+		int size;
+		if(!fh.fs->length(size))
+			FILE_FAIL(MA_FERR_GENERIC);
+		// writing past the end extends the file, like a seek followed by a write.
+		// the gap is filled with zeros, which not every platform's writeAt() does.
+		static const char zeros[1024] = { 0 };
+		while(size < offset) {
+			int gap = MIN((int)sizeof(zeros), offset - size);
+			if(!fh.fs->writeAt(zeros, gap, size))
+				FILE_FAIL(MA_FERR_GENERIC);
+			size += gap;
+		}
+		bool res = fh.fs->writeAt(src, len, offset);
+		discardFileBuffers(fh);
+		if(!res)
+			FILE_FAIL(MA_FERR_GENERIC);
+		return len;
+	}
+
+	int Syscall::maFileAppend(MAHandle file, const void* src, int len) {
+		LOGF("maFileAppend(%i, 0x%"PFP", %i)\n", file, src, len);
+		FileHandle& fh(getFileHandle(file));
+		MYASSERT(fh.fs, ERR_FILE_CLOSED);
+		if(len < 0)
+			FILE_FAIL(MA_FERR_GENERIC);
+		int pos, size;
+		if(!fh.fs->tell(pos) || !fh.fs->length(size))
+			FILE_FAIL(MA_FERR_GENERIC);
+		bool res;
+		if(pos == size) {
+			// the common case; the position follows the end of the file.
+			res = fh.fs->write(src, len);
+		} else {
+			res = fh.fs->seek(Seek::End, 0) && fh.fs->write(src, len);
+			res = fh.fs->seek(Seek::Start, pos) && res;
+		}
+		discardFileBuffers(fh);
+		if(!res)
+			FILE_FAIL(MA_FERR_GENERIC);
+		return size + len;
+	}
+
+	int Syscall::maFileReadSome(MAHandle file, void* dst, int len) {
+		LOGF("maFileReadSome(%i, 0x%"PFP", %i)\n", file, dst, len);
+		FileHandle& fh(getFileHandle(file));
+		MYASSERT(fh.fs, ERR_FILE_CLOSED);
+		if(len < 0)
+			FILE_FAIL(MA_FERR_GENERIC);
+		int pos, size;
+		if(!fh.fs->tell(pos) || !fh.fs->length(size))
+			FILE_FAIL(MA_FERR_GENERIC);
+		// seeking past the end of the file is allowed. it's treated like ordinary EOF.
+		if(pos >= size)
+			return 0;
+		len = MIN(len, size - pos);
+		if(!fh.fs->read(dst, len))
+			FILE_FAIL(MA_FERR_GENERIC);
+		return len;
+	}
+
 #ifndef SYMBIAN
-	static FileList sFileList;
-	static std::string sFileListRealDir;
-#ifndef _WIN32_WCE
-	static int sFileListSorting;
-#ifdef _WIN32
-	typedef ino_t _ino_t;
+	// Filters are matched the way glob() matched them on POSIX hosts, and
+	// FindFirstFile() on Windows: case-insensitively on Windows, and elsewhere
+	// a leading '.' only matches a '.' in the pattern.
+	static inline int foldCase(char c) {
+#ifdef WIN32
+		return tolower((unsigned char)c);
+#else
+		return (unsigned char)c;
 #endif
-#endif	//_WIN32_WCE
+	}
 
-	static void fileListCallback(const char* filename) {
-		if(!strcmp(filename, ".") || !strcmp(filename, ".."))
-			return;
-		std::string fn = filename;
-		if(isDirectory((sFileListRealDir + fn).c_str())) {
-			fn += "/";
+	// Returns true if the first token of \a pattern, a character, '?' or a
+	// "[...]" class, matches \a c. Sets \a next to the token after it.
+	static bool matchChar(const char* pattern, char c, const char*& next) {
+		next = pattern + 1;
+		if(*pattern == '?')
+			return true;
+		if(*pattern == '[') {
+			const char* p = pattern + 1;
+			bool negate = *p == '!' || *p == '^';
+			if(negate)
+				p++;
+			// a ']' right after the '[' is part of the class.
+			const char* first = p;
+			bool found = false;
+			while(*p && (*p != ']' || p == first)) {
+				if(p[1] == '-' && p[2] && p[2] != ']') {
+					if(foldCase(c) >= foldCase(p[0]) && foldCase(c) <= foldCase(p[2]))
+						found = true;
+					p += 3;
+				} else {
+					if(foldCase(*p) == foldCase(c))
+						found = true;
+					p++;
+				}
+			}
+			if(*p == ']') {
+				next = p + 1;
+				return found != negate;
+			}
+			// no closing ']'; the '[' is an ordinary character.
 		}
-		struct FileListItem fli;
-		fli.name = fn;
-#ifdef _WIN32_WCE
-		sFileList.files.push_back(fli);
-#else
-		fli.sorting = sFileListSorting;
-		if(sFileListSorting == MA_FL_SORT_NONE)
-			// hack: we store an ordinal in st_ino.
-			// looks like it would break on Windows if a directory has
-			// more than 65k files. I don't care to fix it.
-			fli.s.st_ino = (ino_t)sFileList.files.size();
-		else
-			stat(fn.c_str(), &fli.s);
+		return *pattern != 0 && foldCase(*pattern) == foldCase(c);
+	}
 
-		sFileList.files.insert(fli);
-#endif	//_WIN32_WCE
+	// Returns true if \a name matches \a pattern, where '*' matches
+	// zero or more characters, '?' matches one and "[...]" matches one of a class.
+	static bool matchWildcard(const char* pattern, const char* name) {
+#ifndef WIN32
+		if(name[0] == '.' && pattern[0] != '.')
+			return false;
+#endif
+		// The pattern position after the last '*', and the name position it matched up to.
+		const char* starPattern = NULL;
+		const char* starName = NULL;
+		while(*name) {
+			const char* next;
+			if(*pattern == '*') {
+				starPattern = ++pattern;
+				starName = name;
+			} else if(matchChar(pattern, *name, next)) {
+				pattern = next;
+				name++;
+			} else if(starPattern) {
+				// let the last '*' match one more character.
+				pattern = starPattern;
+				name = ++starName;
+			} else {
+				return false;
+			}
+		}
+		while(*pattern == '*')
+			pattern++;
+		return *pattern == 0;
 	}
 
-#ifndef _WIN32_WCE
-	bool FileListItem::operator<(const FileListItem& o) const {
-		DEBUG_ASSERT(sorting == o.sorting);
-		if(sorting == MA_FL_SORT_NONE)
-			return s.st_ino < o.s.st_ino;
-		int sortType = sorting & 0xFFFF;
-		int sortOrder = sorting & 0xFFFF0000;
+	// Orders file list items like the std::set that held them did before,
+	// name order quirk included.
+	struct FileListLess {
+		int sortType;
 		bool sortDesc;
-		switch(sortOrder) {
-		case MA_FL_ORDER_ASCENDING:
-			sortDesc = false;
-			break;
-		case MA_FL_ORDER_DESCENDING:
-			sortDesc = true;
-			break;
-		default:
-			BIG_PHAT_ERROR(ERR_FILE_LIST_SORT);
+		bool operator()(const FileListItem& a, const FileListItem& b) const {
+			switch(sortType) {
+			case MA_FL_SORT_DATE:
+				return sortDesc ? a.mtime > b.mtime : a.mtime < b.mtime;
+			case MA_FL_SORT_SIZE:
+				return sortDesc ? a.size > b.size : a.size < b.size;
+			default:	//MA_FL_SORT_NAME
+				if(sortDesc)
+					return stricmp(a.name.c_str(), b.name.c_str()) < 0;
+				else
+					return stricmp(a.name.c_str(), b.name.c_str()) > 0;
+			}
 		}
-		switch(sortType) {
-		case MA_FL_SORT_DATE:
-			if(sortDesc)
-				return s.st_mtime > o.s.st_mtime;
-			else
-				return s.st_mtime < o.s.st_mtime;
-		case MA_FL_SORT_SIZE:
-			if(sortDesc)
-				return s.st_size > o.s.st_size;
-			else
-				return s.st_size < o.s.st_size;
-		case MA_FL_SORT_NAME:
-			if(sortDesc)
-				return stricmp(name.c_str(), o.name.c_str()) < 0;
-			else
-				return stricmp(name.c_str(), o.name.c_str()) > 0;
-		default:
-			BIG_PHAT_ERROR(ERR_FILE_LIST_SORT);
+	};
+
+	FileList::FileList(const std::string& realDir, const std::string& filter,
+		int sorting, int maxDepth)
+		: mRealDir(realDir), mFilter(filter), mSorting(sorting & ~MA_FL_FLAG_LAZY),
+		mMaxDepth(maxDepth), mLazy((sorting & MA_FL_FLAG_LAZY) != 0), mPos(0),
+		mHavePending(false)
+	{
+	}
+
+	FileList::~FileList() {
+		for(size_t i=0; i<mLevels.size(); i++) {
+			closeDirectory(mLevels[i].ds);
 		}
 	}
-#endif	//_WIN32_WCE
+
+	bool FileList::start() {
+		Level root;
+		root.ds = openDirectory(mRealDir.c_str());
+		if(!root.ds)
+			return false;
+		root.depth = 0;
+		mLevels.push_back(root);
+		if(mLazy)
+			return true;
+
+		FileListItem item;
+		bool needInfo = mSorting == MA_FL_SORT_DATE || mSorting == MA_FL_SORT_SIZE;
+		while(readNext(item)) {
+			if(needInfo)
+				getInfo(item);
+			mItems.push_back(item);
+		}
+		if(mSorting != MA_FL_SORT_NONE) {
+			FileListLess less = { mSorting & 0xFFFF, (mSorting & MA_FL_ORDER_DESCENDING) != 0 };
+			// stable, so that entries which compare equal are all kept, in directory order.
+			std::stable_sort(mItems.begin(), mItems.end(), less);
+		}
+		return true;
+	}
+
+	void FileList::add(const FileListItem& item) {
+		DEBUG_ASSERT(!mLazy);
+		mItems.push_back(item);
+	}
+
+	FileListItem* FileList::peek() {
+		if(!mLazy)
+			return mPos < mItems.size() ? &mItems[mPos] : NULL;
+		if(!mHavePending)
+			mHavePending = readNext(mPending);
+		return mHavePending ? &mPending : NULL;
+	}
+
+	void FileList::advance() {
+		if(mLazy)
+			mHavePending = false;
+		else
+			mPos++;
+	}
+
+	void FileList::getInfo(FileListItem& item) const {
+		if(item.haveInfo)
+			return;
+		item.haveInfo = true;
+		item.size = -1;
+		item.mtime = 0;
+#ifndef _WIN32_WCE
+		struct stat s;
+		if(stat((mRealDir + item.name).c_str(), &s) == 0) {
+			item.size = s.st_size;
+			item.mtime = s.st_mtime;
+		}
+#endif
+	}
+
+	bool FileList::readNext(FileListItem& item) {
+		while(!mLevels.empty()) {
+			Level& level(mLevels.back());
+			DirectoryEntry e;
+			if(readDirectory(level.ds, &e) <= 0) {
+				closeDirectory(level.ds);
+				mLevels.pop_back();
+				continue;
+			}
+			item.name = level.prefix + e.name;
+			item.type = e.type;
+			item.haveInfo = e.haveInfo != 0;
+			item.size = e.size;
+			item.mtime = e.mtime;
+			bool descend = e.type == FILELIST_TYPE_DIRECTORY;
+#ifndef WIN32
+			if(e.type == FILELIST_TYPE_UNKNOWN) {
+				// The file system didn't say; ask it, but don't follow
+				// links to directories, which may lead back up the tree.
+				struct stat s;
+				std::string path = mRealDir + item.name;
+				if(lstat(path.c_str(), &s) != 0)
+					continue;
+				descend = S_ISDIR(s.st_mode);
+				if(S_ISLNK(s.st_mode) && stat(path.c_str(), &s) != 0)
+					continue;
+				item.type = S_ISDIR(s.st_mode) ? FILELIST_TYPE_DIRECTORY :
+					S_ISREG(s.st_mode) ? FILELIST_TYPE_FILE : FILELIST_TYPE_OTHER;
+				item.haveInfo = true;
+				item.size = s.st_size;
+				item.mtime = s.st_mtime;
+			}
+#endif	//WIN32
+			bool match = matchWildcard(mFilter.c_str(), e.name);
+			if(item.type == FILELIST_TYPE_DIRECTORY) {
+				item.name += "/";
+				if(descend && level.depth < mMaxDepth) {
+					// pre-order: the directory's entries follow it.
+					Level sub;
+					sub.ds = openDirectory((mRealDir + item.name).c_str());
+					if(sub.ds) {
+						sub.prefix = item.name;
+						sub.depth = level.depth + 1;
+						mLevels.push_back(sub);
+					}
+				}
+			}
+			if(match)
+				return true;
+		}
+		return false;
+	}
+
+	static FileList& getFileList(MAHandle list) {
+		FileListItr itr = sFileListings.find(list);
+		MYASSERT(itr != sFileListings.end(), ERR_FILE_HANDLE_INVALID);
+		return *itr->second;
+	}
 
 	// if this is MoRE, the emulator,
 	// we'll put all filesystem access into a separate directory, like chroot.
 	MAHandle Syscall::maFileListStart(const char* path, const char* filter, int sorting) {
-		LOGF("maFileListStart(%s, %s, 0x%x)\n", path, filter, sorting);
-#ifndef _WIN32_WCE
-		sFileListSorting = sorting;
-#endif
-		sFileList.files.clear();
+		return maFileListStartRecursive(path, filter, sorting, 0);
+	}
+
+	MAHandle Syscall::maFileListStartRecursive(const char* path, const char* filter,
+		int sorting, int maxDepth)
+	{
+		LOGF("maFileListStartRecursive(%s, %s, 0x%x, %i)\n", path, filter, sorting, maxDepth);
+		if(sorting & MA_FL_FLAG_LAZY) {
+			MYASSERT((sorting & ~MA_FL_FLAG_LAZY) == MA_FL_SORT_NONE, ERR_FILE_LIST_SORT);
+		} else if(sorting != MA_FL_SORT_NONE) {
+			int sortType = sorting & 0xFFFF;
+			int sortOrder = sorting & 0xFFFF0000;
+			MYASSERT(sortOrder == MA_FL_ORDER_ASCENDING || sortOrder == MA_FL_ORDER_DESCENDING,
+				ERR_FILE_LIST_SORT);
+			MYASSERT(sortType == MA_FL_SORT_DATE || sortType == MA_FL_SORT_SIZE ||
+				sortType == MA_FL_SORT_NAME, ERR_FILE_LIST_SORT);
+		}
+
+		FileList* fl;
 		if(path[0] == 0) {	//empty string
 			//list filesystem roots
-#if FILESYSTEM_CHROOT || defined(LINUX) || defined(__IPHONE__) || defined(_WIN32_WCE)
+			fl = new FileList("", "*", MA_FL_SORT_NONE, 0);
 			FileListItem fli;
+			fli.type = FILELIST_TYPE_DIRECTORY;
+			fli.haveInfo = true;
+			fli.size = -1;
+			fli.mtime = 0;
+#if FILESYSTEM_CHROOT || defined(LINUX) || defined(__IPHONE__) || defined(_WIN32_WCE)
 			fli.name = "/";
-#ifdef _WIN32_WCE
-			sFileList.files.push_back(fli);
-#else
-			fli.sorting = MA_FL_SORT_NONE;
-			sFileList.files.insert(fli);
-#endif	//_WIN32_WCE
+			fl->add(fli);
 #else	//FILESYSTEM_CHROOT
 #ifdef WIN32
-			FileListItem fli;
 			DWORD res = GetLogicalDrives();
-			GLE(res);
+			if(res == 0) {
+				LOG_GLE;
+				delete fl;
+				FILE_FAIL(MA_FERR_GENERIC);
+			}
 			char buf[] = "X:/";
 			for(int i=0; i<32; i++) {
 				if((res & (1 << i)) != 0) {
 					buf[0] = 'A' + i;
 					fli.name = buf;
-					fli.s.st_ino = i;
-					sFileList.files.insert(fli);
+					fl->add(fli);
 				}
 			}
 #else
@@ -1583,39 +2033,71 @@ namespace Base {
 			scanPath += path;
 			if(scanPath[scanPath.size()-1] != '/')
 				scanPath += "/";
-			sFileListRealDir = scanPath;
-			scanPath += filter;
-			int res = scanDirectory(scanPath.c_str(), fileListCallback);
-			if(res) {
-				LOG("scanDirectory failed: %i\n", res);
-				FILE_FAIL(MA_FERR_GENERIC);
+			fl = new FileList(scanPath, filter, sorting, maxDepth);
+			if(!fl->start()) {
+				// like glob(), which found no matches in a directory that
+				// doesn't exist, the list is empty.
+				LOG("openDirectory failed: %s\n", scanPath.c_str());
 			}
 		}
-		std::pair<FileListItr, bool> ires = sFileListings.insert(
-			std::pair<int, FileList>(sFileListNextHandle, sFileList));
-		DEBUG_ASSERT(ires.second);
-		FileList& fl(ires.first->second);
-		fl.itr = fl.files.begin();
+		sFileListings[sFileListNextHandle] = fl;
 		return sFileListNextHandle++;
 	}
 
 	int Syscall::maFileListNext(MAHandle list, char* nameBuf, int bufSize) {
-		FileListItr itr = sFileListings.find(list);
-		MYASSERT(itr != sFileListings.end(), ERR_FILE_HANDLE_INVALID);
-		FileList& fl(itr->second);
-		if(fl.itr == fl.files.end())
+		FileList& fl(getFileList(list));
+		const FileListItem* item = fl.peek();
+		if(!item)
 			return 0;
-		const std::string& name(fl.itr->name);
+		const std::string& name(item->name);
 		if((int)name.size() >= bufSize)
 			return name.size();
 		memcpy(nameBuf, name.c_str(), name.size() + 1);
-		fl.itr++;
+		fl.advance();
 		return name.size();
 	}
 
+	int Syscall::maFileListNextBatch(MAHandle list, void* buffer, int bufSize, int info) {
+		LOGF("maFileListNextBatch(%i, 0x%"PFP", %i, 0x%x)\n", list, buffer, bufSize, info);
+		FileList& fl(getFileList(list));
+		MYASSERT(((size_t)buffer & 0x3) == 0, ERR_MEMORY_ALIGNMENT);
+		byte* dst = (byte*)buffer;
+		int pos = 0;
+		int count = 0;
+		while(FileListItem* item = fl.peek()) {
+			int nameLength = item->name.size();
+			int entrySize = (sizeof(MAFileListEntry) + nameLength + 1 + 3) & ~3;
+			if(pos + entrySize > bufSize) {
+				if(count == 0)
+					return -entrySize;
+				break;
+			}
+			if(info != 0)
+				fl.getInfo(*item);
+
+			MAFileListEntry* e = (MAFileListEntry*)(dst + pos);
+			e->entrySize = entrySize;
+			e->type = item->type == FILELIST_TYPE_UNKNOWN ? MA_FL_TYPE_OTHER : item->type;
+			e->nameLength = nameLength;
+			e->size = -1;
+			if((info & MA_FL_INFO_SIZE) && item->type == FILELIST_TYPE_FILE && item->size >= 0)
+				e->size = (int)MIN(item->size, (long long)INT_MAX);
+			e->date = (info & MA_FL_INFO_DATE) ? (int)item->mtime : 0;
+			char* name = (char*)(e + 1);
+			memcpy(name, item->name.c_str(), nameLength + 1);
+			memset(name + nameLength + 1, 0, entrySize - sizeof(MAFileListEntry) - nameLength - 1);
+
+			pos += entrySize;
+			count++;
+			fl.advance();
+		}
+		return count;
+	}
+
 	int Syscall::maFileListClose(MAHandle list) {
 		FileListItr itr = sFileListings.find(list);
 		MYASSERT(itr != sFileListings.end(), ERR_FILE_HANDLE_INVALID);
+		delete itr->second;
 		sFileListings.erase(itr);
 		return 0;
 	}
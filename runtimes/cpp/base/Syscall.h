@@ -50,6 +50,26 @@ namespace Base {
 		bool loadResource(Stream& file, MAHandle originalHandle, MAHandle destHandle);
 		int countResources();
 
+#if !defined(SYMBIAN) && !defined(_android)
+		// Returns the tile size of a tile set resource, or 0 if the handle
+		// was not loaded from one.
+		MAExtent getTileSetSize(MAHandle tileSet);
+		// Called when the object of a handle is destroyed or replaced.
+		void forgetTileSetSize(MAHandle handle);
+	private:
+		bool loadTileSet(Stream& file, MAHandle rI, int size);
+		std::map<int, MAExtent> mTileSetSizes;
+
+		struct AtlasImage {
+			MAHandle handle, atlas;
+			ushort left, top, width, height;
+		};
+		bool loadAtlas(Stream& file, MAHandle rI);
+		bool readAtlasImage(Stream& file, MAHandle rI, AtlasImage& img);
+		bool addAtlasImage(const AtlasImage& img);
+	public:
+#endif
+
 		void init();
 		virtual ~Syscall();
 		void platformDestruct();
@@ -119,6 +139,8 @@ namespace Base {
 		int gFileNextHandle;
 
 		FileHandle& getFileHandle(MAHandle file);
+		// makes other handles to the same file forget what they've read ahead.
+		void discardFileBuffers(const FileHandle& writer);
 
 		MAHandle maFileOpen(const char* path, int mode);
 		int maFileExists(MAHandle file);
@@ -140,9 +162,17 @@ namespace Base {
 		int maFileTell(MAHandle file);
 		int maFileSeek(MAHandle file, int offset, int whence);
 
+		int maFileReadAt(MAHandle file, void* dst, int len, int offset);
+		int maFileWriteAt(MAHandle file, const void* src, int len, int offset);
+		int maFileAppend(MAHandle file, const void* src, int len);
+		int maFileReadSome(MAHandle file, void* dst, int len);
+
 		MAHandle maFileListStart(const char* path, const char* filter, int sorting);
 		int maFileListNext(MAHandle list, char* nameBuf, int bufSize);
 		int maFileListClose(MAHandle list);
+		MAHandle maFileListStartRecursive(const char* path, const char* filter, int sorting,
+			int maxDepth);
+		int maFileListNextBatch(MAHandle list, void* buffer, int bufSize, int info);
 
 		ResourceArray resources;
 
@@ -229,6 +259,15 @@ namespace Base {
 #define GVWS(p) SYSCALL_THIS->GetValidatedWStr(p)
 #define GVMRA(type) GVMR(a, type)
 
+// The size of a ranged ioctl argument that is a product, like "count * 8".
+// Returns -1, which GetValidatedMemRange() rejects, if a factor is
+// negative or the product doesn't fit in an int.
+static inline int validatedRangeProduct(int a, int b) {
+	if(a < 0 || b < 0 || (b != 0 && a > 0x7fffffff / b))
+		return -1;
+	return a * b;
+}
+
 #define maIOCtl_case(func) maIOCtl_##func##_case(func)
 #define maIOCtl_syscall_case(func) maIOCtl_##func##_case(SYSCALL_THIS->func)
 
@@ -0,0 +1,300 @@
+/* Copyright 2013 David Axmark
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+	http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "config_platform.h"
+
+#include <helpers/helpers.h>
+#include <helpers/cpp_defs.h>
+
+#include "base_errors.h"
+#include "TileRenderer.h"
+
+using namespace MoSyncError;
+
+//*****************************************************************************
+//TileWorker
+//*****************************************************************************
+
+// Rasterises every mStride'th tile, starting at mIndex, each time it is started.
+class TileWorker {
+public:
+	TileWorker(TileRenderer* renderer, int index, int stride)
+		: mRenderer(renderer), mIndex(index), mStride(stride), mQuit(false)
+	{
+		mThread.start(homeRun, this);
+	}
+
+	~TileWorker() {
+		mQuit = true;
+		mStart.post();
+		mThread.join();
+	}
+
+	void start() {
+		mStart.post();
+	}
+
+	// Also used by the flushing thread to do its own share of the tiles.
+	static void rasteriseShare(TileRenderer* r, int index, int stride) {
+		Image view(*r->mTarget);
+		view.shouldFreeData = false;
+		for(int i = index; i < (int)r->mTiles.size(); i += stride) {
+			if(!r->mTiles[i].commands.empty())
+				r->rasterise(i, view);
+		}
+	}
+
+private:
+	static int homeRun(void* data) {
+		TileWorker* w = (TileWorker*)data;
+		w->run();
+		return 0;
+	}
+
+	void run() {
+		while(true) {
+			mStart.wait();
+			if(mQuit)
+				return;
+			rasteriseShare(mRenderer, mIndex, mStride);
+			mRenderer->mDone.post();
+		}
+	}
+
+	TileRenderer* mRenderer;
+	int mIndex, mStride;
+	bool mQuit;
+	MoSyncThread mThread;
+	MoSyncSemaphore mStart;
+};
+
+//*****************************************************************************
+//TileRenderer
+//*****************************************************************************
+
+static bool intersect(const ClipRect& a, const ClipRect& b, ClipRect& out) {
+	int left = MAX(a.x, b.x);
+	int top = MAX(a.y, b.y);
+	int right = MIN(a.x + a.width, b.x + b.width);
+	int bottom = MIN(a.y + a.height, b.y + b.height);
+	out.x = left;
+	out.y = top;
+	out.width = right - left;
+	out.height = bottom - top;
+	return out.width > 0 && out.height > 0;
+}
+
+TileRenderer::TileRenderer(Image* target, int numThreads, int tileWidth, int tileHeight)
+	: mTarget(target), mTileWidth(tileWidth), mTileHeight(tileHeight)
+{
+	DEBUG_ASSERT(tileWidth > 0 && tileHeight > 0);
+	mTilesX = (target->width + tileWidth - 1) / tileWidth;
+	mTilesY = (target->height + tileHeight - 1) / tileHeight;
+	mTiles.resize(mTilesX * mTilesY);
+	for(int ty = 0; ty < mTilesY; ty++) {
+		for(int tx = 0; tx < mTilesX; tx++) {
+			ClipRect& r = mTiles[tx + ty * mTilesX].rect;
+			r.x = tx * tileWidth;
+			r.y = ty * tileHeight;
+			r.width = MIN(tileWidth, target->width - r.x);
+			r.height = MIN(tileHeight, target->height - r.y);
+		}
+	}
+
+	// the thread calling flush() takes share 0.
+	for(int i = 1; i < numThreads; i++) {
+		mWorkers.push_back(new TileWorker(this, i, numThreads));
+	}
+}
+
+TileRenderer::~TileRenderer() {
+	flush();
+	for(size_t i = 0; i < mWorkers.size(); i++) {
+		delete mWorkers[i];
+	}
+}
+
+// Appends a command and bins it into every tile that the inclusive bounding
+// box (left, top)-(right, bottom), clipped to the current clip rect, touches.
+// Commands that cannot produce any pixels are recorded, but not binned.
+TileRenderer::Command& TileRenderer::record(int type, int color,
+	int left, int top, int right, int bottom)
+{
+	int index = (int)mCommands.size();
+	mCommands.resize(index + 1);
+	Command& c = mCommands[index];
+	c.type = type;
+	c.color = color;
+	c.clip = mTarget->clipRect;
+
+	ClipRect bounds = { left, top, right - left + 1, bottom - top + 1 };
+	ClipRect screen = { 0, 0, mTarget->width, mTarget->height };
+	ClipRect box;
+	if(!intersect(bounds, c.clip, box) || !intersect(box, screen, box))
+		return c;
+
+	int tx0 = box.x / mTileWidth;
+	int ty0 = box.y / mTileHeight;
+	int tx1 = (box.x + box.width - 1) / mTileWidth;
+	int ty1 = (box.y + box.height - 1) / mTileHeight;
+	for(int ty = ty0; ty <= ty1; ty++) {
+		for(int tx = tx0; tx <= tx1; tx++) {
+			mTiles[tx + ty * mTilesX].commands.push_back(index);
+		}
+	}
+	return c;
+}
+
+void TileRenderer::drawPoint(int x, int y, int color) {
+	Command& c = record(CMD_POINT, color, x, y, x, y);
+	c.a[0] = x;
+	c.a[1] = y;
+}
+
+void TileRenderer::drawLine(int x1, int y1, int x2, int y2, int color) {
+	Command& c = record(CMD_LINE, color,
+		MIN(x1, x2), MIN(y1, y2), MAX(x1, x2), MAX(y1, y2));
+	c.a[0] = x1;
+	c.a[1] = y1;
+	c.a[2] = x2;
+	c.a[3] = y2;
+}
+
+void TileRenderer::drawFilledRect(int x, int y, int w, int h, int color) {
+	Command& c = record(CMD_FILLED_RECT, color, x, y, x + w - 1, y + h - 1);
+	c.a[0] = x;
+	c.a[1] = y;
+	c.a[2] = w;
+	c.a[3] = h;
+}
+
+void TileRenderer::drawTriangle(int x1, int y1, int x2, int y2, int x3, int y3, int color) {
+	Command& c = record(CMD_TRIANGLE, color,
+		MIN(x1, MIN(x2, x3)), MIN(y1, MIN(y2, y3)),
+		MAX(x1, MAX(x2, x3)), MAX(y1, MAX(y2, y3)));
+	c.a[0] = x1;
+	c.a[1] = y1;
+	c.a[2] = x2;
+	c.a[3] = y2;
+	c.a[4] = x3;
+	c.a[5] = y3;
+}
+
+void TileRenderer::drawImageRegion(int left, int top, ClipRect *srcRect, Image *src, int transformMode) {
+	// reading from the target itself depends on everything drawn before.
+	if(src->data == mTarget->data) {
+		flush();
+		mTarget->drawImageRegion(left, top, srcRect, src, transformMode);
+		return;
+	}
+
+	// do the checks that Image::drawImageRegion would do here, so that
+	// errors are raised on the calling thread, not on a worker.
+	int w = srcRect->width, h = srcRect->height;
+	switch(transformMode) {
+	case TRANS_NONE:
+	case TRANS_ROT180:
+	case TRANS_MIRROR:
+	case TRANS_MIRROR_ROT180:
+		break;
+	case TRANS_ROT90:
+	case TRANS_ROT270:
+	case TRANS_MIRROR_ROT90:
+	case TRANS_MIRROR_ROT270:
+		w = srcRect->height;
+		h = srcRect->width;
+		break;
+	default:
+		DEBIG_PHAT_ERROR;
+	}
+	if(w <= 0 || h <= 0)
+		return;
+	if(srcRect->x < 0 || srcRect->y < 0 ||
+		srcRect->x + srcRect->width > src->width ||
+		srcRect->y + srcRect->height > src->height)
+	{
+		BIG_PHAT_ERROR(ERR_SOURCE_RECT_OOB);
+	}
+
+	Command& c = record(CMD_IMAGE_REGION, 0, left, top, left + w - 1, top + h - 1);
+	c.a[0] = left;
+	c.a[1] = top;
+	c.srcRect = *srcRect;
+	c.src = src;
+	c.transformMode = transformMode;
+}
+
+void TileRenderer::drawImage(int left, int top, Image *src) {
+	ClipRect srcRect = {0, 0, src->width, src->height};
+	drawImageRegion(left, top, &srcRect, src, TRANS_NONE);
+}
+
+void TileRenderer::rasterise(int tileIndex, Image& view) {
+	Tile& tile = mTiles[tileIndex];
+	for(size_t i = 0; i < tile.commands.size(); i++) {
+		Command& c = mCommands[tile.commands[i]];
+		switch(c.type) {
+		// these are clipped exactly, so the tile can simply be
+		// intersected with the clip rect.
+		case CMD_POINT:
+			view.scissor = NULL;
+			if(intersect(c.clip, tile.rect, view.clipRect))
+				view.drawPoint(c.a[0], c.a[1], c.color);
+			break;
+		case CMD_FILLED_RECT:
+			view.scissor = NULL;
+			if(intersect(c.clip, tile.rect, view.clipRect))
+				view.drawFilledRect(c.a[0], c.a[1], c.a[2], c.a[3], c.color);
+			break;
+		case CMD_IMAGE_REGION:
+			view.scissor = NULL;
+			if(intersect(c.clip, tile.rect, view.clipRect))
+				view.drawImageRegion(c.a[0], c.a[1], &c.srcRect, c.src, c.transformMode);
+			break;
+		// clipping these moves their vertices, so they keep the original
+		// clip rect and use the tile as a scissor.
+		case CMD_LINE:
+			view.clipRect = c.clip;
+			view.scissor = &tile.rect;
+			view.drawLine(c.a[0], c.a[1], c.a[2], c.a[3], c.color);
+			break;
+		case CMD_TRIANGLE:
+			view.clipRect = c.clip;
+			view.scissor = &tile.rect;
+			view.drawTriangle(c.a[0], c.a[1], c.a[2], c.a[3], c.a[4], c.a[5], c.color);
+			break;
+		default:
+			DEBIG_PHAT_ERROR;
+		}
+	}
+}
+
+void TileRenderer::flush() {
+	if(mCommands.empty())
+		return;
+
+	for(size_t i = 0; i < mWorkers.size(); i++) {
+		mWorkers[i]->start();
+	}
+	TileWorker::rasteriseShare(this, 0, (int)mWorkers.size() + 1);
+	for(size_t i = 0; i < mWorkers.size(); i++) {
+		mDone.wait();
+	}
+
+	mCommands.clear();
+	for(size_t i = 0; i < mTiles.size(); i++) {
+		mTiles[i].commands.clear();
+	}
+}
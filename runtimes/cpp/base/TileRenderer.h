@@ -0,0 +1,102 @@
+/* Copyright 2013 David Axmark
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+	http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef TILERENDERER_H
+#define TILERENDERER_H
+
+#include <vector>
+#include "Image.h"
+#include "ThreadPoolImpl.h"
+
+class TileWorker;
+
+/**
+* Deferred rendering backend for Image.
+*
+* Draw calls are recorded into a command list instead of being executed.
+* flush() splits the target into tiles, bins each command into the tiles
+* its bounding box touches, and rasterises the tiles in parallel, each on
+* a private Image view of the target's pixels. Commands are replayed in
+* recording order within every tile, and lines and triangles are clipped
+* against the recorded clip rect (the tile only acts as a scissor), so the
+* result is bit-identical to drawing the same calls directly on the target.
+*
+* The platform should call flush() at maUpdateScreen, and before anything
+* reads or writes the target's pixels, or changes an image that a recorded
+* command uses as its source.
+*/
+class TileRenderer {
+public:
+	/**
+	* \param numThreads Number of rasterising threads, including the caller
+	* of flush(). With 1, flush() rasterises everything on the calling thread.
+	*/
+	TileRenderer(Image* target, int numThreads, int tileWidth = 64, int tileHeight = 64);
+	~TileRenderer();
+
+	// Same semantics as the Image functions with the same names. The target's
+	// current clipRect is captured with each command.
+	void drawPoint(int x, int y, int color);
+	void drawLine(int x1, int y1, int x2, int y2, int color);
+	void drawFilledRect(int x, int y, int w, int h, int color);
+	void drawTriangle(int x1, int y1, int x2, int y2, int x3, int y3, int color);
+	void drawImageRegion(int left, int top, ClipRect *srcRect, Image *src, int transformMode);
+	void drawImage(int left, int top, Image *src);
+
+	/// Rasterises and discards all recorded commands.
+	void flush();
+
+	int numCommands() const { return (int)mCommands.size(); }
+
+private:
+	enum CommandType {
+		CMD_POINT,
+		CMD_LINE,
+		CMD_FILLED_RECT,
+		CMD_TRIANGLE,
+		CMD_IMAGE_REGION
+	};
+
+	struct Command {
+		int type;
+		int color;
+		int a[6];
+		ClipRect clip;
+		ClipRect srcRect;
+		Image* src;
+		int transformMode;
+	};
+
+	struct Tile {
+		ClipRect rect;
+		std::vector<int> commands;
+	};
+
+	Command& record(int type, int color, int left, int top, int right, int bottom);
+	void rasterise(int tileIndex, Image& view);
+
+	Image* mTarget;
+	std::vector<Command> mCommands;
+	std::vector<Tile> mTiles;
+	int mTileWidth, mTileHeight;
+	int mTilesX, mTilesY;
+
+	std::vector<TileWorker*> mWorkers;
+	MoSyncSemaphore mDone;
+
+	friend class TileWorker;
+};
+
+#endif	//TILERENDERER_H
@@ -613,7 +613,9 @@ SYSCALL(int, maConnGetAddr(MAHandle conn, MAConnAddr* addr)) {
 
 SYSCALL(void, maConnRead(MAHandle conn, void* dst, int size)) {
 	LOGST("ConnRead %i %i", conn, size);
+#ifndef SYSCALL_TABLE_DISPATCH	// validated by the core
 	SYSCALL_THIS->ValidateMemRange(dst, size);
+#endif
 	MAStreamConn& mac = getStreamConn(conn);
 	MYASSERT((mac.state & CONNOP_READ) == 0, ERR_CONN_ALREADY_READING);
 	mac.state |= CONNOP_READ;
@@ -622,7 +624,9 @@ SYSCALL(void, maConnRead(MAHandle conn, void* dst, int size)) {
 
 SYSCALL(void, maConnReadFrom(MAHandle conn, void* dst, int size, MAConnAddr* src)) {
 	LOGST("ConnReadFrom %i %i", conn, size);
+#ifndef SYSCALL_TABLE_DISPATCH
 	SYSCALL_THIS->ValidateMemRange(dst, size);
+#endif
 	MAStreamConn& mac = getStreamConn(conn);
 	MYASSERT((mac.state & CONNOP_READ) == 0, ERR_CONN_ALREADY_READING);
 	mac.state |= CONNOP_READ;
@@ -631,7 +635,9 @@ SYSCALL(void, maConnReadFrom(MAHandle conn, void* dst, int size, MAConnAddr* src
 
 SYSCALL(void, maConnWrite(MAHandle conn, const void* src, int size)) {
 	LOGST("ConnWrite %i %i", conn, size);
+#ifndef SYSCALL_TABLE_DISPATCH
 	SYSCALL_THIS->ValidateMemRange(src, size);
+#endif
 	MAStreamConn& mac = getStreamConn(conn);
 	MYASSERT((mac.state & CONNOP_WRITE) == 0, ERR_CONN_ALREADY_WRITING);
 	mac.state |= CONNOP_WRITE;
@@ -640,7 +646,9 @@ SYSCALL(void, maConnWrite(MAHandle conn, const void* src, int size)) {
 
 SYSCALL(void, maConnWriteTo(MAHandle conn, const void* src, int size, const MAConnAddr* dst)) {
 	LOGST("ConnWriteTo %i %i", conn, size);
+#ifndef SYSCALL_TABLE_DISPATCH
 	SYSCALL_THIS->ValidateMemRange(src, size);
+#endif
 	MAStreamConn& mac = getStreamConn(conn);
 	MYASSERT((mac.state & CONNOP_WRITE) == 0, ERR_CONN_ALREADY_WRITING);
 	mac.state |= CONNOP_WRITE;
@@ -46,6 +46,10 @@ limitations under the License.
 #include "GdbCommon.h"
 #endif
 
+#ifdef ENABLE_DEBUGGER
+#include "debugger.h"
+#endif
+
 #include <base/base_errors.h>
 using namespace MoSyncError;
 
@@ -61,6 +65,10 @@ using namespace MoSyncError;
 #include "disassembler.h"
 #endif
 
+#ifdef FUNCTION_PROFILING
+#include "FunctionProfiler.h"
+#endif
+
 #ifdef COUNT_INSTRUCTION_USE
 #include <algorithm>
 #include <vector>
@@ -109,22 +117,131 @@ __inline void chrashTestDummy(const char* fmt, ...) {
 #include <windows.h>
 #endif
 
+#if (defined(LINUX) || defined(DARWIN)) && !defined(_android)
+#include <sys/mman.h>
+#include <unistd.h>
+#define DATA_SEGMENT_MMAP
+#elif defined(_WIN32) && !defined(_WIN32_WCE)
+#define DATA_SEGMENT_VIRTUALALLOC
+#endif
+
 #ifdef FAKE_CALL_STACK
 #include <vector>
 #endif
 
+#ifdef SYSCALL_TABLE_DISPATCH
+#include "syscall_info_cpp.h"
+#endif
+
 namespace Core {
 
 using namespace Base;
 
 void InvokeSysCall(int id);
 
+//****************************************
+//Data segment memory
+//****************************************
+// Where the OS allows it, the data segment is reserved with room to grow,
+// and its pages are committed and zeroed by the OS when first touched,
+// so a large data section costs nothing until it is used, and
+// maHeapGrow() never moves memory the program already uses.
+// Elsewhere, the segment is allocated and cleared up front, and can't grow.
+
+#ifndef DATA_SEGMENT_RESERVE
+#define DATA_SEGMENT_RESERVE (sizeof(void*) == 8 ? (1024*1024*1024) : (256*1024*1024))
+#endif
+
+#if defined(DATA_SEGMENT_MMAP) && !defined(MAP_NORESERVE)
+#define MAP_NORESERVE 0
+#endif
+
+#if defined(DATA_SEGMENT_MMAP)
+static uint pageSize() {
+	static uint sPageSize = (uint)sysconf(_SC_PAGESIZE);
+	return sPageSize;
+}
+#elif defined(DATA_SEGMENT_VIRTUALALLOC)
+static uint pageSize() {
+	static uint sPageSize = 0;
+	if(sPageSize == 0) {
+		SYSTEM_INFO info;
+		GetSystemInfo(&info);
+		sPageSize = info.dwPageSize;
+	}
+	return sPageSize;
+}
+#endif
+
+// Returns \a reserve bytes, of which the first \a commit are usable and zero.
+static void* reserveZeroed(uint reserve, uint commit) {
+#if defined(DATA_SEGMENT_MMAP)
+	void* p = mmap(NULL, reserve, PROT_READ | PROT_WRITE,
+		MAP_PRIVATE | MAP_ANON | MAP_NORESERVE, -1, 0);
+	return p == MAP_FAILED ? NULL : p;
+#elif defined(DATA_SEGMENT_VIRTUALALLOC)
+	void* p = VirtualAlloc(NULL, reserve, MEM_RESERVE, PAGE_NOACCESS);
+	if(p && !VirtualAlloc(p, commit, MEM_COMMIT, PAGE_READWRITE)) {
+		VirtualFree(p, 0, MEM_RELEASE);
+		return NULL;
+	}
+	return p;
+#else
+	byte* p = new byte[commit];
+	if(p)
+		ZEROMEM(p, commit);
+	return p;
+#endif
+}
+
+// Makes bytes \a from to \a to of a reservation usable. They are zero.
+static bool commitZeroed(void* base, uint from, uint to) {
+#if defined(DATA_SEGMENT_MMAP)
+	// the whole reservation is mapped already.
+	return true;
+#elif defined(DATA_SEGMENT_VIRTUALALLOC)
+	return VirtualAlloc((byte*)base + from, to - from, MEM_COMMIT, PAGE_READWRITE) != NULL;
+#else
+	return false;
+#endif
+}
+
+// Gives back the memory of the whole pages in a range. Their contents are lost.
+static void releaseZeroed(void* ptr, uint size) {
+#if defined(DATA_SEGMENT_MMAP) || defined(DATA_SEGMENT_VIRTUALALLOC)
+	uint mask = pageSize() - 1;
+	size_t start = ((size_t)ptr + mask) & ~(size_t)mask;
+	size_t end = ((size_t)ptr + size) & ~(size_t)mask;
+	if(end <= start)
+		return;
+#if defined(DATA_SEGMENT_MMAP)
+	madvise((void*)start, end - start, MADV_DONTNEED);
+#else
+	VirtualAlloc((void*)start, end - start, MEM_RESET, PAGE_READWRITE);
+#endif
+#endif
+}
+
+static void freeZeroed(void* base, uint reserve) {
+	if(!base)
+		return;
+#if defined(DATA_SEGMENT_MMAP)
+	munmap(base, reserve);
+#elif defined(DATA_SEGMENT_VIRTUALALLOC)
+	VirtualFree(base, 0, MEM_RELEASE);
+#else
+	delete[] (byte*)base;
+#endif
+}
+
 class VMCoreInt : public VMCore {
 public:
 
 #ifdef LOG_STATE_CHANGE
 	int csRegs[128];
 	int *csMem;
+	// the size of csMem, in bytes. The data segment may have grown since.
+	uint csMemSize;
 
 	struct StateChange {
 		int type; // 0 = reg state change, 1 = mem state change
@@ -149,6 +266,7 @@ public:
 
 	void initStateChange() {
 		csMem = 0;
+		csMemSize = 0;
 		curStateChange = 0;
 	}
 
@@ -222,6 +340,7 @@ public:
 			curStateChange = 0;
 #if 0
 			csMem = new int[gCore->DATA_SEGMENT_SIZE>>2];
+			csMemSize = gCore->DATA_SEGMENT_SIZE;
 #else
 			csMem = (int*)1;
 #endif
@@ -292,6 +411,15 @@ public:
 		}
 
 #if 0
+		if(csMemSize < gCore->DATA_SEGMENT_SIZE) {
+			// the segment has grown. Its new memory started out zeroed.
+			int* newMem = new int[gCore->DATA_SEGMENT_SIZE>>2];
+			memcpy(newMem, csMem, csMemSize);
+			memset((byte*)newMem + csMemSize, 0, gCore->DATA_SEGMENT_SIZE - csMemSize);
+			delete []csMem;
+			csMem = newMem;
+			csMemSize = gCore->DATA_SEGMENT_SIZE;
+		}
 		unsigned char* mem = (unsigned char*)gCore->mem_ds;
 		unsigned char* oldmem = (unsigned char*)csMem;
 		for(unsigned int i = 0; i < gCore->DATA_SEGMENT_SIZE; i++) {
@@ -341,215 +469,18 @@ public:
 	int fakeCallStackCapacity;	//measured in ints
 
 #ifdef FUNCTION_PROFILING
-	class ProfTree {
-	private:
-		class ProfTime {
-		private:
-			LARGE_INTEGER li;
-		public:
-			static ProfTime now() {
-				ProfTime n;
-#ifdef _WIN32
-				DEBUG_ASSERT(QueryPerformanceCounter(&n.li));
-#else
-				struct timeval tv;
-				DEBUG_ASSERT(!gettimeofday(&tv, NULL));
-				n.li.QuadPart = (int64_t) tv.tv_sec * 1000000 + (int64_t) tv.tv_usec;
-#endif
-				return n;
-			}
-			ProfTime() {
-				li.QuadPart = 0;
-			}
-			ProfTime(const ProfTime& other) : li(other.li) {}
-			ProfTime& operator+=(const ProfTime& other) {
-				li.QuadPart += other.li.QuadPart;
-				return *this;
-			}
-			ProfTime operator-(const ProfTime& other) {
-				ProfTime t;
-				t.li.QuadPart = li.QuadPart - other.li.QuadPart;
-				return t;
-			}
-			double toMilliSeconds() {
-#ifdef _WIN32
-				LARGE_INTEGER freq;
-				DEBUG_ASSERT(QueryPerformanceFrequency(&freq));
-				return double(li.QuadPart) * 1000 / double(freq.QuadPart);
-#else
-				return li.QuadPart / 1000;
-#endif
-			}
-		};
-
-		class ProfNode {
-		private:
-			ProfTime mLastStartTime, mRunTime;
-			int mCount;
-			bool mRunning;
-			std::vector<ProfNode*> mChildren;
-			ProfNode* mParent;
-			const int mIp;
-			friend class ProfTree;
-		public:
-			const std::vector<ProfNode*>& children() const { return mChildren; }
-			bool running() const { return mRunning; }
-
-			ProfNode(int ip, ProfNode* parent) : mCount(0), mRunning(false), mParent(parent), mIp(ip) {}
-			~ProfNode() {
-				for(size_t i=0; i<mChildren.size(); i++) {
-					delete mChildren[i];
-				}
-			}
-			void start() {
-				DEBUG_ASSERT(!mRunning);
-				mRunning = true;
-				mLastStartTime = ProfTime::now();
-				mCount++;
-			}
-			void stop() {
-				DEBUG_ASSERT(mRunning);
-				ProfTime endTime = ProfTime::now();
-				mRunTime += (endTime - mLastStartTime);
-				mRunning = false;
-			}
-			const ProfTime& getRunTime() const {
-				return mRunTime;
-			}
-			int getCount() const {
-				return mCount;
-			}
-
-			void dump(FILE* file) {
-				static int dLev = 0;
-				//if(runTime.toMilliSeconds() > 10 || count > 10)
-				{
-					if(dLev > 0) {
-						fprintf(file, "%*c", dLev, ' ');
-					}
-					fprintf(file, "<f ");
-					const char* fName;
-					if(mIp < 0) {	//hacked syscall number
-						fName = translateSyscall(-mIp);
-					} else {
-						fName = mapFunction(mIp);
-					}
-					if(fName) {
-						char nameBuf[1024];
-						//if(strchr(fName, '&'))
-						{
-							//replace illegal XML character
-							DEBUG_ASSERT(strlen(fName) < sizeof(nameBuf));
-							char* ptr = nameBuf;
-							while(*fName) {
-								switch(*fName) {
-								case '&':
-									ptr += sprintf(ptr, "&amp;");
-									break;
-								case '<':
-									ptr += sprintf(ptr, "&lt;");
-									break;
-								case '>':
-									ptr += sprintf(ptr, "&gt;");
-									break;
-								default:
-									*ptr = *fName;
-									ptr++;
-								}
-								fName++;
-							}
-							*ptr = 0;
-							fName = nameBuf;
-						}
-						fprintf(file, "n=\"%s\"", fName);
-					} else {
-						fprintf(file, "a=\"0x%x\"", mIp);
-					}
-					ProfTime childrenTime;
-					for(size_t i=0; i<mChildren.size(); i++) {
-						ProfNode* n = mChildren[i];
-						childrenTime += n->mRunTime;
-					}
-					fprintf(file, " c=\"%i\" t=\"%f\" lt=\"%f\" ch=\"%i\" cht=\"%f\">\n", mCount,
-						mRunTime.toMilliSeconds(), (mRunTime - childrenTime).toMilliSeconds(),
-						(int)mChildren.size(), childrenTime.toMilliSeconds());
-					for(size_t i=0; i<mChildren.size(); i++) {
-						ProfNode* n = mChildren[i];
-						dLev++;
-						n->dump(file);
-						dLev--;
-					}
-					if(dLev > 0) {
-						fprintf(file, "%*c", dLev, ' ');
-					}
-					fprintf(file, "</f>\n");
-				}
-			}
-		};
-
-		ProfNode* mRoot;
-		ProfNode* mTop;
+	static const char* profileName(int ip) {
+		if(ip < 0)	//hacked syscall number
+			return translateSyscall(-ip);
+		return mapFunction(ip);
+	}
 
-		int level, maxLevel, nodes;	//debug
+	// Writes the profile when the core is destroyed.
+	class ProfTree : public FunctionProfiler {
 	public:
-		ProfTree() : mRoot(NULL) {}
-		void init(int entryPoint) {
-			SAFE_DELETE(mRoot);
-			mRoot = new ProfNode(entryPoint, NULL);
-			DEBUG_ASSERT(mRoot != NULL);
-			mTop = mRoot;
-			level = maxLevel = 0;
-			nodes = 1;
-			mRoot->start();
-		}
 		~ProfTree() {
-			DUMPINT(level);
-			DUMPINT(maxLevel);
-			DUMPINT(nodes);
-			while(level > 0) {
-				ret();
-			}
-			if(mRoot->running())
-				mRoot->stop();
-			{
-				FILE* file = fopen("fp.xml", "w");
-				DEBUG_ASSERT(file);
-				mRoot->dump(file);
-				fclose(file);
-			}
-			SAFE_DELETE(mRoot);
-		}
-
-		void call(int ip) {
-			ProfNode* node = NULL;
-			for(size_t i=0; i<mTop->mChildren.size(); i++) {
-				ProfNode* n = mTop->mChildren[i];
-				if(n->mIp == ip) {
-					node = n;
-					break;
-				}
-			}
-			if(node == NULL) {
-				node = new ProfNode(ip, mTop);
-				nodes++;
-				DEBUG_ASSERT(node != NULL);
-				mTop->mChildren.push_back(node);
-			}
-			mTop = node;
-			node->start();
-			level++;
-			if(level > maxLevel)
-				maxLevel = level;
-		}
-
-		void ret() {
-			mTop->stop();
-			mTop = mTop->mParent;
-			DEBUG_ASSERT(mTop != 0);
-			level--;
+			write("fp.bin", profileName);
 		}
-
-		const ProfNode* getRoot() const { return mRoot; }
 	} profTree;
 #endif	//FUNCTION_PROFILING
 
@@ -760,6 +691,57 @@ public:
 #endif
 	}
 
+	//****************************************
+	//Data segment
+	//****************************************
+	void freeDataSegment() {
+#ifdef _android
+		SAFE_DELETE(mem_ds);
+#else
+		freeZeroed(mem_ds, DATA_SEGMENT_RESERVED);
+		mem_ds = NULL;
+#endif
+#ifdef MEMORY_PROTECTION
+#ifdef _android
+		SAFE_DELETE(protectionSet);
+#else
+		freeZeroed(protectionSet, (DATA_SEGMENT_RESERVED+7)>>3);
+		protectionSet = NULL;
+#endif
+#endif
+	}
+
+	// Returns the address of \a size new bytes at the end of the data segment,
+	// or 0 if they don't fit in the reservation.
+	int GrowDataSegment(int size) {
+		if(size <= 0 || (size & (MA_HEAP_GROW_GRANULARITY - 1)) != 0)
+			return 0;
+		if(dataBreak > DATA_SEGMENT_RESERVED || uint(size) > DATA_SEGMENT_RESERVED - dataBreak)
+			return 0;
+		uint newBreak = dataBreak + size;
+		if(newBreak > DATA_SEGMENT_SIZE) {
+			// the segment size stays a power of 2, for DATA_SEGMENT_MASK.
+			uint newSize = nextPowerOf2(16, newBreak);
+			if(!commitZeroed(mem_ds, DATA_SEGMENT_SIZE, newSize))
+				return 0;
+#ifdef MEMORY_PROTECTION
+			if(!commitZeroed(protectionSet, (DATA_SEGMENT_SIZE+7)>>3, (newSize+7)>>3))
+				return 0;
+#endif
+			DATA_SEGMENT_SIZE = newSize;
+#ifdef ENABLE_DEBUGGER
+			Debugger::setDataSegmentSize(DATA_SEGMENT_SIZE);
+#endif
+		}
+		int address = dataBreak;
+		dataBreak = newBreak;
+		return address;
+	}
+
+	void ReleaseDataMemory(void* ptr, int size) {
+		releaseZeroed(ptr, size);
+	}
+
 	//****************************************
 	//Loader
 	//****************************************
@@ -775,13 +757,9 @@ public:
 		}
 
 		SAFE_DELETE(mem_cs);
-		SAFE_DELETE(mem_ds);
+		freeDataSegment();
 		SAFE_DELETE(mem_cp);
 
-#ifdef MEMORY_PROTECTION
-		SAFE_DELETE(protectionSet);
-#endif
-
 		// Init regs + IP
 		int maxCustomEventSize = getMaxCustomEventSize();
 
@@ -865,16 +843,32 @@ public:
 			mJniEnv->DeleteLocalRef(cls);
 			mJniEnv->DeleteLocalRef(byteBuffer);
 
+			DATA_SEGMENT_RESERVED = DATA_SEGMENT_SIZE;
 #else
-			mem_ds = new int[DATA_SEGMENT_SIZE / sizeof(int)];
+			DATA_SEGMENT_RESERVED = DATA_SEGMENT_SIZE;
+#if (defined(DATA_SEGMENT_MMAP) || defined(DATA_SEGMENT_VIRTUALALLOC)) && !defined(USE_ARM_RECOMPILER)
+			// the recompiler keeps its own copy of the segment mask.
+			if(DATA_SEGMENT_RESERVE > DATA_SEGMENT_SIZE) {
+				DATA_SEGMENT_RESERVED = DATA_SEGMENT_RESERVE;
+				mem_ds = (int*)reserveZeroed(DATA_SEGMENT_RESERVED, DATA_SEGMENT_SIZE);
+			}
 #endif
+			if(!mem_ds) {
+				DATA_SEGMENT_RESERVED = DATA_SEGMENT_SIZE;
+				mem_ds = (int*)reserveZeroed(DATA_SEGMENT_SIZE, DATA_SEGMENT_SIZE);
+			}
+#endif
+			dataBreak = (Head.DataSize + MA_HEAP_GROW_GRANULARITY - 1) &
+				~(MA_HEAP_GROW_GRANULARITY - 1);
 
 			if(!mem_ds) BIG_PHAT_ERROR(ERR_OOM);
 			TEST(file.read(mem_ds, Head.DataLen));
+#ifdef _android
 			ZEROMEM((byte*)mem_ds + Head.DataLen, DATA_SEGMENT_SIZE - Head.DataLen);
+#endif
 #ifdef MEMORY_PROTECTION
-			protectionSet = new byte[(DATA_SEGMENT_SIZE+7)>>3];
-			ZEROMEM(protectionSet, (DATA_SEGMENT_SIZE+7)>>3);
+			protectionSet = (byte*)reserveZeroed((DATA_SEGMENT_RESERVED+7)>>3, (DATA_SEGMENT_SIZE+7)>>3);
+			if(!protectionSet) BIG_PHAT_ERROR(ERR_OOM);
 			//unprotectMemory(0, DATA_SEGMENT_SIZE);
 			//protectMemory(Head.DataSize-Head.StackSize-Head.HeapSize-16, Head.HeapSize);
 #endif
@@ -1224,6 +1218,111 @@ void WRITE_REG(int reg, int value) {
 #define _MOSYNC_SYSCALL_ARGUMENTS_H_
 #include "syscall_arguments.h"
 
+#ifdef SYSCALL_TABLE_DISPATCH
+	typedef void (VMCoreInt::*SyscallHandler)();
+#define SYSCALL_HANDLER(name) &VMCoreInt::_syscall_##name
+#define memset __memset
+#define memcpy __memcpy
+#define strcpy __strcpy
+#define strcmp __strcmp
+#include "syscall_table_cpp.h"
+#undef memset
+#undef memcpy
+#undef strcpy
+#undef strcmp
+#undef SYSCALL_HANDLER
+
+	const SyscallHandler* mSyscallHandlers;
+
+#ifdef SYSCALL_PROFILING
+	// bucket i counts calls that took less than 2^i microseconds.
+#define SYSCALL_HISTOGRAM_BUCKETS 24
+	struct SyscallProfile {
+		uint count;
+		s64 totalMicroSeconds;
+		uint histogram[SYSCALL_HISTOGRAM_BUCKETS];
+	} mSyscallProfile[SYSCALL_COUNT];
+
+	static s64 syscallMicroSeconds() {
+#ifdef _WIN32
+		LARGE_INTEGER li, freq;
+		QueryPerformanceCounter(&li);
+		QueryPerformanceFrequency(&freq);
+		return li.QuadPart * 1000000 / freq.QuadPart;
+#else
+		struct timeval tv;
+		gettimeofday(&tv, NULL);
+		return (s64)tv.tv_sec * 1000000 + tv.tv_usec;
+#endif
+	}
+
+	void profileSyscall(int syscall_id, s64 start) {
+		SyscallProfile& p(mSyscallProfile[syscall_id]);
+		p.count++;
+		if(gSyscallInfo[syscall_id].flags & SCF_BLOCKING)
+			return;
+		s64 time = syscallMicroSeconds() - start;
+		p.totalMicroSeconds += time;
+		int bucket = 0;
+		while(bucket < SYSCALL_HISTOGRAM_BUCKETS - 1 && time >= (1 << bucket))
+			bucket++;
+		p.histogram[bucket]++;
+	}
+
+	void dumpSyscallProfile() {
+		static const char* const costNames[SCC_COUNT] = {
+			"compute", "memory", "graphics", "io", "blocking" };
+		FILE* file = fopen("syscalls.txt", "w");
+		if(!file) {
+			LOG("Syscall profile dump failed; couldn't open file for writing.\n");
+			return;
+		}
+		fprintf(file, "name, cost, count, total ms, histogram (< 2^i us)\n");
+		for(int i=0; i<SYSCALL_COUNT; i++) {
+			const SyscallProfile& p(mSyscallProfile[i]);
+			if(p.count == 0)
+				continue;
+			const SyscallInfo& info(gSyscallInfo[i]);
+			fprintf(file, "%s, %s, %u, %.3f", info.name, costNames[info.cost],
+				p.count, double(p.totalMicroSeconds) / 1000);
+			int last = SYSCALL_HISTOGRAM_BUCKETS;
+			while(last > 0 && p.histogram[last-1] == 0)
+				last--;
+			for(int j=0; j<last; j++)
+				fprintf(file, ", %u", p.histogram[j]);
+			fprintf(file, "\n");
+		}
+		fclose(file);
+		LOG("Syscall profile dumped.\n");
+	}
+#endif	//SYSCALL_PROFILING
+
+	// Validates the memory ranges declared in the IDL, then calls the handler.
+	// The handlers don't validate those ranges again.
+	void ISC2(int syscall_id) {
+		if(uint(syscall_id) >= SYSCALL_COUNT || !mSyscallHandlers[syscall_id])
+			BIG_PHAT_ERROR(ERR_BAD_SYSCALL);
+		const SyscallInfo& info(gSyscallInfo[syscall_id]);
+		for(int i=0; i<info.nRanges; i++) {
+			const SyscallRange& r(info.ranges[i]);
+			uint size = r.scale;
+			if(r.length >= 0) {
+				uint len = REG(REG_i0 + r.length);
+				if(len > DATA_SEGMENT_SIZE / r.scale)
+					BIG_PHAT_ERROR(ERR_MEMORY_OOB);
+				size *= len;
+			}
+			ValidateMemRange((char*)mem_ds + REG(REG_i0 + r.address), size);
+		}
+#ifdef SYSCALL_PROFILING
+		s64 start = syscallMicroSeconds();
+		(this->*mSyscallHandlers[syscall_id])();
+		profileSyscall(syscall_id, start);
+#else
+		(this->*mSyscallHandlers[syscall_id])();
+#endif
+	}
+#else	//SYSCALL_TABLE_DISPATCH
 	void ISC2(int syscall_id) {
 
 		switch(syscall_id) {
@@ -1246,6 +1345,7 @@ void WRITE_REG(int reg, int value) {
 			BIG_PHAT_ERROR(ERR_BAD_SYSCALL);
 		}
 	}
+#endif	//SYSCALL_TABLE_DISPATCH
 
 	void InvokeSysCall(int syscall_id) {
 #ifdef TRACK_SYSCALL_ID
@@ -1340,6 +1440,12 @@ void WRITE_REG(int reg, int value) {
 #endif
 #ifdef LOG_STATE_CHANGE
 		initStateChange();
+#endif
+#ifdef SYSCALL_TABLE_DISPATCH
+		mSyscallHandlers = syscallHandlers();
+#endif
+#ifdef SYSCALL_PROFILING
+		memset(mSyscallProfile, 0, sizeof(mSyscallProfile));
 #endif
 	}
 
@@ -1364,13 +1470,9 @@ void WRITE_REG(int reg, int value) {
 	logInstructionUse();
 #endif
 		delete mem_cs;
-		delete mem_ds;
+		freeDataSegment();
 		delete mem_cp;
 
-#ifdef MEMORY_PROTECTION
-		delete protectionSet;
-#endif
-
 #ifdef LOG_STATE_CHANGE
 		freeStateChange();
 #endif
@@ -1400,6 +1502,9 @@ void WRITE_REG(int reg, int value) {
 		}
 		delete instruction_count;
 #endif
+#ifdef SYSCALL_PROFILING
+		dumpSyscallProfile();
+#endif
 
 	}
 
@@ -1407,7 +1512,8 @@ private:
 	Syscall& mSyscall;
 };
 
-VMCore::VMCore() : mem_cs(NULL), mem_ds(NULL), mem_cp(NULL)
+VMCore::VMCore() : DATA_SEGMENT_RESERVED(0), dataBreak(0),
+	mem_cs(NULL), mem_ds(NULL), mem_cp(NULL)
 #ifdef MEMORY_PROTECTION
 	,protectionSet(NULL)
 	,protectionEnabled(1)
@@ -1550,6 +1656,13 @@ void* GetCustomEventPointer(VMCore* core) {
 #endif
 }
 
+int GrowDataSegment(VMCore* core, int size) {
+	return CORE->GrowDataSegment(size);
+}
+void ReleaseDataMemory(VMCore* core, void* ptr, int size) {
+	CORE->ReleaseDataMemory(ptr, size);
+}
+
 #ifdef MEMORY_PROTECTION
 static void protectMemory(VMCore* core, int start, int length) {
 	CORE->protectMemory(start, length);
@@ -1647,6 +1760,15 @@ int Base::Syscall::getMemoryProtection() {
 }
 #endif
 
+// Defined here for MoRE, and in mosynclib/main.cpp.
+int heapGrow(int size) {
+	return Core::GrowDataSegment(gCore, size);
+}
+int heapRelease(void* ptr, int size) {
+	Core::ReleaseDataMemory(gCore, ptr, size);
+	return 0;
+}
+
 void Base::Syscall::VM_Yield() {
 	Core::GetVMYield(gCore) = 1;
 }
@@ -101,6 +101,11 @@ namespace Core {
 		uint DATA_SEGMENT_SIZE;
 #define DATA_SEGMENT_MASK (DATA_SEGMENT_SIZE - 1)
 
+		// The room mem_ds may grow into, without moving.
+		uint DATA_SEGMENT_RESERVED;
+		// The address maHeapGrow() hands out next.
+		uint dataBreak;
+
 		uint STACK_TOP;
 		uint STACK_BOTTOM;
 
@@ -194,6 +199,8 @@ namespace Core {
 	const char* GetValidatedStr(const VMCore* core, int address);
 	const wchar* GetValidatedWStr(const VMCore* core, int address);
 	void* GetCustomEventPointer(VMCore* core);
+	int GrowDataSegment(VMCore* core, int size);
+	void ReleaseDataMemory(VMCore* core, void* ptr, int size);
 	
 }
 
@@ -0,0 +1,266 @@
+/* Copyright 2013 David Axmark
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+	http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef FUNCTION_PROFILER_H
+#define FUNCTION_PROFILER_H
+
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+#include <algorithm>
+
+#ifdef _WIN32
+#include <windows.h>
+#elif defined(__APPLE__)
+#include <mach/mach_time.h>
+#else
+#include <time.h>
+#endif
+
+// On x86, times are measured in cycles of the time-stamp counter,
+// which is much cheaper to read than the system clocks.
+#if defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__))
+#include <x86intrin.h>
+#define PROFILER_TSC
+#elif defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+#include <intrin.h>
+#define PROFILER_TSC
+#endif
+
+#include <helpers/helpers.h>
+#include <helpers/FunctionProfile.h>
+
+// Measures the time spent in each call path of a program, for FUNCTION_PROFILING.
+// call() and ret() are called for every call and return the core makes,
+// so they read the clock once each, and find the callee's node with
+// one hash table lookup, or none if the caller called it last time, too. A node's self time is added up as its calls return,
+// so nothing is left to compute when the profile is written.
+// See helpers/FunctionProfile.h for the file format.
+class FunctionProfiler {
+public:
+	// Returns the name of the function or syscall, or NULL if it has none.
+	typedef const char* (*NameFunc)(int ip);
+
+	FunctionProfiler() : mDepth(0), maxLevel(0) {}
+
+	// Starts a new profile, with the root node running.
+	void init(int entryPoint) {
+		mNodes.clear();
+		mStack.resize(INITIAL_STACK_SIZE);
+		mTable.assign(INITIAL_TABLE_SIZE, 0);
+		maxLevel = 0;
+		Node root = { 0, 0, -1, entryPoint, 1, 0 };
+		mNodes.push_back(root);
+		mStartNanoSeconds = nanoSeconds();
+		mStartTicks = now();
+		Frame f = { 0, mStartTicks, 0 };
+		mStack[0] = f;
+		mDepth = 1;
+	}
+
+	void call(int ip) {
+		int node = findChild(mStack[mDepth - 1].node, ip);
+		mNodes[node].count++;
+		if(mDepth == (int)mStack.size())
+			mStack.resize(mDepth * 2);
+		Frame& f(mStack[mDepth++]);
+		f.node = node;
+		f.children = 0;
+		f.start = now();
+		if(mDepth > maxLevel)
+			maxLevel = mDepth;
+	}
+
+	void ret() {
+		// a broken call stack may return from the root; that's ignored.
+		if(mDepth > 1)
+			stop(now());
+	}
+
+	// Ends all running calls, including the root,
+	// and writes the profile to \a filename.
+	void write(const char* filename, NameFunc names) {
+		if(mNodes.empty())
+			return;
+		LOG("Function profile: level %i, maxLevel %i, nodes %i\n",
+			mDepth - 1, maxLevel, (int)mNodes.size());
+		s64 t = now();
+		while(mDepth > 0)
+			stop(t);
+
+		FILE* file = fopen(filename, "wb");
+		if(!file) {
+			LOG("Function profile dump failed; couldn't open %s for writing.\n", filename);
+			return;
+		}
+
+		// every function's name is written once.
+		std::vector<int> ips;
+		ips.reserve(mNodes.size());
+		for(size_t i=0; i<mNodes.size(); i++)
+			ips.push_back(mNodes[i].ip);
+		std::sort(ips.begin(), ips.end());
+		ips.erase(std::unique(ips.begin(), ips.end()), ips.end());
+		std::vector<const char*> nameList;
+		std::vector<int> nameIps;
+		for(size_t i=0; i<ips.size(); i++) {
+			const char* name = names(ips[i]);
+			if(name) {
+				nameList.push_back(name);
+				nameIps.push_back(ips[i]);
+			}
+		}
+
+		FunctionProfileHeader h;
+		memcpy(h.magic, FUNCTION_PROFILE_MAGIC, sizeof(h.magic));
+		h.version = FUNCTION_PROFILE_VERSION;
+		h.nodeCount = mNodes.size();
+		h.nameCount = nameList.size();
+		h.ticksPerSecond = ticksPerSecond(t);
+		fwrite(&h, sizeof(h), 1, file);
+		for(size_t i=0; i<mNodes.size(); i++) {
+			const Node& n(mNodes[i]);
+			FunctionProfileNode fn = { n.total, n.self, n.parent, n.ip, n.count, 0 };
+			fwrite(&fn, sizeof(fn), 1, file);
+		}
+		for(size_t i=0; i<nameList.size(); i++) {
+			s32 ipLen[2] = { nameIps[i], (s32)strlen(nameList[i]) };
+			fwrite(ipLen, sizeof(ipLen), 1, file);
+			fwrite(nameList[i], ipLen[1], 1, file);
+		}
+		fclose(file);
+		LOG("Function profile dumped.\n");
+	}
+
+private:
+	enum { INITIAL_TABLE_SIZE = 1024, INITIAL_STACK_SIZE = 64 };
+
+	struct Node {
+		s64 total, self;
+		int parent, ip;
+		uint count;
+		// the child that was called last.
+		int lastChild;
+	};
+
+	// A running call.
+	struct Frame {
+		int node;
+		s64 start;
+		// the total time of the calls it has made.
+		s64 children;
+	};
+
+	std::vector<Node> mNodes;
+	// the running calls; the root is at the bottom.
+	std::vector<Frame> mStack;
+	int mDepth;
+	// Open-addressed, keyed by parent node and ip; node index + 1, or 0 if empty.
+	std::vector<int> mTable;
+
+	s64 mStartNanoSeconds, mStartTicks;
+
+	int maxLevel;	//debug
+
+	void stop(s64 t) {
+		const Frame& f(mStack[--mDepth]);
+		s64 time = t - f.start;
+		Node& n(mNodes[f.node]);
+		n.total += time;
+		n.self += time - f.children;
+		if(mDepth > 0)
+			mStack[mDepth - 1].children += time;
+	}
+
+	static uint hash(int parent, int ip) {
+		return (uint)parent * 0x9E3779B1u ^ (uint)ip * 0x85EBCA6Bu;
+	}
+
+	int findChild(int parent, int ip) {
+		int last = mNodes[parent].lastChild;
+		if(last != 0 && mNodes[last].ip == ip)
+			return last;
+		int child = lookup(parent, ip);
+		mNodes[parent].lastChild = child;
+		return child;
+	}
+
+	int lookup(int parent, int ip) {
+		uint mask = mTable.size() - 1;
+		uint pos = hash(parent, ip) & mask;
+		while(mTable[pos] != 0) {
+			const Node& n(mNodes[mTable[pos] - 1]);
+			if(n.parent == parent && n.ip == ip)
+				return mTable[pos] - 1;
+			pos = (pos + 1) & mask;
+		}
+		Node n = { 0, 0, parent, ip, 0, 0 };
+		mNodes.push_back(n);
+		mTable[pos] = mNodes.size();
+		if(mNodes.size() * 2 > mTable.size())
+			grow();
+		return mNodes.size() - 1;
+	}
+
+	void grow() {
+		mTable.assign(mTable.size() * 2, 0);
+		uint mask = mTable.size() - 1;
+		for(size_t i=0; i<mNodes.size(); i++) {
+			uint pos = hash(mNodes[i].parent, mNodes[i].ip) & mask;
+			while(mTable[pos] != 0)
+				pos = (pos + 1) & mask;
+			mTable[pos] = i + 1;
+		}
+	}
+
+	static s64 now() {
+#ifdef PROFILER_TSC
+		return __rdtsc();
+#else
+		return nanoSeconds();
+#endif
+	}
+
+	// A monotonic clock, with a resolution of a microsecond or better.
+	static s64 nanoSeconds() {
+#ifdef _WIN32
+		LARGE_INTEGER li, freq;
+		QueryPerformanceCounter(&li);
+		QueryPerformanceFrequency(&freq);
+		return s64(double(li.QuadPart) * 1e9 / double(freq.QuadPart));
+#elif defined(__APPLE__)
+		static mach_timebase_info_data_t tb;
+		if(tb.denom == 0)
+			mach_timebase_info(&tb);
+		return mach_absolute_time() * tb.numer / tb.denom;
+#else
+		struct timespec ts;
+		clock_gettime(CLOCK_MONOTONIC, &ts);
+		return (s64)ts.tv_sec * 1000000000 + ts.tv_nsec;
+#endif
+	}
+
+	// The time-stamp counter's rate is measured over the whole profile.
+	s64 ticksPerSecond(s64 ticks) const {
+#ifdef PROFILER_TSC
+		s64 ns = nanoSeconds() - mStartNanoSeconds;
+		if(ns > 0)
+			return s64(double(ticks - mStartTicks) * 1e9 / double(ns));
+#endif
+		return 1000000000;
+	}
+};
+
+#endif	//FUNCTION_PROFILER_H
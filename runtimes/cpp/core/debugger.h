@@ -29,6 +29,12 @@ namespace Debugger {
 	
 	void close();
 
+	/**
+	 * Tells the debugger that the data segment has grown to \a size_mem_ds
+	 * bytes. The segment doesn't move.
+	 */
+	void setDataSegmentSize(unsigned int size_mem_ds);
+
 
 	enum BreakResult {
 		BRK_QUIT,
@@ -20,14 +20,41 @@ limitations under the License.
 #include "maapi_defs.h"
 #include "cpp_defs.h"
 #include "CoreCommon.h"
+#include <string.h>
 
 #define LOGSC(...)
 
 #define CALL_SYSCALL(func) func
 
+#ifdef WIN32
 #define DLLEXPORT __declspec(dllexport)
+#else
+#define DLLEXPORT __attribute__((visibility("default")))
+#endif
 extern "C"
 void DLLEXPORT initializeExtension(ExtensionData* ed, const CoreData* cd);
+extern "C"
+void DLLEXPORT initializeExtension2(ExtensionData2* ed);
+
+// stack arguments, beyond the first three.
+#define MEM(type, addr) (*(type*)((char*)gMemDs + (addr)))
+
+// Version 2 argument validation. Returns NULL if the range is out of bounds.
+static inline void* extensionPointer(const ExtensionMemory* mem, int address, int len) {
+	if(len < 0 || (unsigned)address > mem->size || (unsigned)len > mem->size - (unsigned)address)
+		return NULL;
+	return mem->base + address;
+}
+
+// Returns NULL unless there is a terminated string at \a address.
+static inline char* extensionString(const ExtensionMemory* mem, int address) {
+	if((unsigned)address >= mem->size)
+		return NULL;
+	char* str = mem->base + address;
+	if(!memchr(str, 0, mem->size - address))
+		return NULL;
+	return str;
+}
 
 // requirements for syscall_arguments.h
 #define mem_ds gMemDs
@@ -34,4 +34,53 @@ struct CoreData {
 // Don't mix 32-bit and 64-bit code. (Should be impossible on most systems.)
 typedef void (*InitializeExtension)(ExtensionData*, const CoreData*);
 
+// Version 2 of the extension ABI, generated by mx-invoker alongside version 1.
+// A call's arguments are passed in an invocation block of 32-bit words in VM memory:
+// one word per argument, two for double and long long, followed by the words
+// that receive the return value. Pointer arguments are VM addresses.
+// The generated stub validates every pointer, with its range() if the IDL has one,
+// then calls the implementation with direct pointers into VM memory.
+// A run of blocks can be invoked with a single maExtensionFunctionInvokeV().
+
+// The VM's data memory.
+struct ExtensionMemory {
+	char* base;
+	unsigned int size;
+};
+
+// Returns 0, or EXTENSION_INVALID_ARGUMENT if a pointer argument was out of bounds.
+typedef int (*TypedFunction)(int* block, const ExtensionMemory* mem);
+
+#define EXTENSION_INVALID_ARGUMENT (-2)
+
+struct TypedFunctionInfo {
+	TypedFunction function;
+	unsigned int argWords;
+	unsigned int resultWords;
+};
+
+struct ExtensionData2 {
+	int idlHash;
+	const char* name;
+	unsigned int nFunctions;
+	const TypedFunctionInfo* functions;
+};
+
+// Extensions that have this function use version 2.
+typedef void (*InitializeExtension2)(ExtensionData2*);
+
+// Runs \a count invocations of \a f, on the blocks at \a blocks, \a stride bytes apart.
+// The caller must have validated the whole range of blocks.
+// Returns the number of invocations completed; if it is less than \a count,
+// the next block had an invalid argument.
+static inline int invokeTypedFunctionV(const TypedFunctionInfo& f, char* blocks,
+	int stride, int count, const ExtensionMemory& mem)
+{
+	for(int i=0; i<count; i++) {
+		if(f.function((int*)(blocks + i * stride), &mem) < 0)
+			return i;
+	}
+	return count;
+}
+
 #endif	//_MOSYNC_EXTENSION_COMMON_H_
@@ -14,6 +14,7 @@ limitations under the License.
 */
 
 #include "extensions.h"
+#include "extensionCommon.h"
 #include "dll/dll.h"
 #include "FileStream.h"
 #include "base_errors.h"
@@ -26,25 +27,9 @@ using namespace MoSyncError;
 
 #define EXT_ASSERT(func) MYASSERT(func, ERR_EXT_LOAD)
 
-// each function is void(void), but has access to registers and memory.
-// no function needs to know its number.
-typedef void (*VoidFunction)(void);
-
-struct ExtensionData {
-	int idlHash;
-	unsigned int nFunctions;
-	VoidFunction* functions;
-};
-struct CoreData {
-	int* regs;
-	void* memDs;
-};
-
-// each DLL has this function.
-// don't mix 32-bit and 64-bit code. (should be impossible on most systems.)
-typedef void (*InitializeExtension)(ExtensionData*, const CoreData*);
-
 static VoidFunction* sFunctions;
+// version 2 functions. the entries of version 1 extensions are zero.
+static TypedFunctionInfo* sTypedFunctions;
 static uint snFunctions;
 static Dll* sDlls;
 static uint snDlls;
@@ -92,6 +77,9 @@ void loadExtensions(const char* extConfFileName) {
 	snFunctions = readIntLine(pos, "%u%n");
 	sFunctions = new VoidFunction[snFunctions];
 	EXT_ASSERT(sFunctions);
+	sTypedFunctions = new TypedFunctionInfo[snFunctions];
+	EXT_ASSERT(sTypedFunctions);
+	memset(sTypedFunctions, 0, snFunctions * sizeof(TypedFunctionInfo));
 
 	uint nFunc = 0;
 	uint nDll = 0;
@@ -106,6 +94,23 @@ void loadExtensions(const char* extConfFileName) {
 		EXT_ASSERT(nDll < snDlls);
 		bool success = sDlls[nDll].open(fileName);
 		EXT_ASSERT(success);
+
+		InitializeExtension2 initializeExtension2 = (InitializeExtension2)sDlls[nDll].get("initializeExtension2");
+		if(initializeExtension2) {
+			ExtensionData2 ed;
+			initializeExtension2(&ed);
+			MYASSERT(ed.idlHash == confHash, ERR_EXT_VERSION);
+			EXT_ASSERT(ed.functions);
+			EXT_ASSERT(nFunc + ed.nFunctions <= snFunctions);
+			memcpy(sTypedFunctions + nFunc, ed.functions, ed.nFunctions * sizeof(TypedFunctionInfo));
+			for(uint i=0; i<ed.nFunctions; i++) {
+				sFunctions[nFunc + i] = NULL;
+			}
+			nFunc += ed.nFunctions;
+			nDll++;
+			continue;
+		}
+
 		InitializeExtension initializeExtension = (InitializeExtension)sDlls[nDll].get("initializeExtension");
 		EXT_ASSERT(initializeExtension);
 
@@ -121,7 +126,7 @@ void loadExtensions(const char* extConfFileName) {
 		// copy function pointers
 		EXT_ASSERT(ed.functions);
 		EXT_ASSERT(nFunc + ed.nFunctions <= snFunctions);
-		memcpy(sFunctions + nFunc, ed.functions, ed.nFunctions + sizeof(VoidFunction));
+		memcpy(sFunctions + nFunc, ed.functions, ed.nFunctions * sizeof(VoidFunction));
 		nFunc += ed.nFunctions;
 		nDll++;
 	}
@@ -146,4 +151,21 @@ extern "C" longlong maInvokeExtension(uint function, int a, int b, int c) {
 extern "C" longlong maExtensionFunctionInvoke(uint function, int a, int b, int c);
 extern "C" longlong maExtensionFunctionInvoke(uint function, int a, int b, int c) {
 	return MA_EXTENSION_FUNCTION_UNAVAILABLE;
-}
\ No newline at end of file
+}
+
+int extensionFunctionInvokeV(int function, void* blocks, int stride, int count) {
+	function--;
+	MYASSERT(function >= 0 && (uint)function < snFunctions, ERR_EXT_CALL);
+	const TypedFunctionInfo& f(sTypedFunctions[function]);
+	MYASSERT(f.function, ERR_EXT_CALL);
+	MYASSERT(stride % 4 == 0 && (uint)stride >= (f.argWords + f.resultWords) * 4, ERR_EXT_CALL);
+	// so that the range of blocks, stride * count, can't overflow.
+	MYASSERT(count >= 0 && (stride == 0 || (uint)count <= gCore->DATA_SEGMENT_SIZE / stride), ERR_MEMORY_OOB);
+
+	ExtensionMemory mem;
+	mem.base = (char*)gCore->mem_ds;
+	mem.size = gCore->DATA_SEGMENT_SIZE;
+	int done = invokeTypedFunctionV(f, (char*)blocks, stride, count, mem);
+	MYASSERT(done == count, ERR_MEMORY_OOB);
+	return done;
+}
@@ -20,4 +20,8 @@ limitations under the License.
 
 void loadExtensions(const char* extConfFileName);
 
+// Runs \a count invocations of a version 2 extension function, see maExtensionFunctionInvokeV().
+// \a blocks must have been validated, \a stride * \a count bytes.
+int extensionFunctionInvokeV(int function, void* blocks, int stride, int count);
+
 #endif	//EXTENSIONS_H
@@ -0,0 +1,66 @@
+/* Copyright 2013 David Axmark
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+	http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef _MOSYNC_SYSCALL_INFO_H_
+#define _MOSYNC_SYSCALL_INFO_H_
+
+// Per-syscall metadata, generated by idl2 into syscall_info_cpp.h
+// as gSyscallInfo[], indexed by syscall number.
+
+// Argument kinds, one character per argument in SyscallInfo::argKinds.
+#define SAK_INT 'i'	// one word: int, uint, MAHandle, MAExtent, float...
+#define SAK_DOUBLE 'd'	// two words
+#define SAK_LONG 'l'	// two words
+#define SAK_ADDRESS 'p'	// a VM address
+#define SAK_STRING 's'	// a VM address of a NUL-terminated string
+#define SAK_WSTRING 'w'	// a VM address of a NUL-terminated wide string
+#define SAK_STRUCT 'r'	// a VM address of a struct
+
+// SyscallInfo::flags
+#define SCF_BLOCKING 1	// may suspend the VM thread
+#define SCF_NORETURN 2
+
+// Cost classes, for grouping profiles.
+enum SyscallCost {
+	SCC_COMPUTE,	// pure functions, state getters and setters
+	SCC_MEMORY,	// copies between VM memory and the runtime
+	SCC_GRAPHICS,
+	SCC_IO,	// connections, stores, resources and sound
+	SCC_BLOCKING,
+	SCC_COUNT
+};
+
+// A VM memory range that is validated before the syscall is invoked.
+// The address is in register REG_i0 + address. If length is negative,
+// the range is scale bytes long. Otherwise, it is register REG_i0 + length
+// times scale bytes long.
+struct SyscallRange {
+	signed char address;
+	signed char length;
+	unsigned short scale;
+};
+
+#define SYSCALL_MAX_RANGES 2
+
+struct SyscallInfo {
+	const char* name;
+	const char* argKinds;
+	unsigned char flags;
+	unsigned char cost;
+	unsigned char nRanges;
+	SyscallRange ranges[SYSCALL_MAX_RANGES];
+};
+
+#endif	//_MOSYNC_SYSCALL_INFO_H_
@@ -125,7 +125,7 @@ namespace Base {
 	//LimitedFileStream
 	//******************************************************************************
 	LimitedFileStream::LimitedFileStream(const char* filename, int offset, int len, JNIEnv* jNIEnv, jobject jThis)
-		: FileStream(filename) , mStartPos(offset), mEndPos(offset + len)
+		: FileStream(filename) , mStartPos(offset), mEndPos(offset + len), mPos(0), mWindow(NULL)
 	{
 		//__android_log_write(ANDROID_LOG_INFO, "LimitedFileStream constructor", "1");
 		
@@ -20,6 +20,9 @@ private:
 Surface* loadImage(MemStream& s);
 Surface* loadSprite(void* surface, ushort left, ushort top,
 	ushort width, ushort height, ushort cx, ushort cy);
+Surface* loadAtlasPage(Stream& file);
+Surface* loadAtlasImage(void* atlas, ushort left, ushort top,
+	ushort width, ushort height);
 
 public:
 	Syscall(int w, int h);
@@ -146,6 +146,18 @@ namespace Base {
 		return NULL;
 	}
 
+	// pipe-tool only writes atlases with -atlas, which is not used when packaging.
+	Surface* Syscall::loadAtlasPage(Stream& file)
+	{
+		return NULL;
+	}
+
+	Surface* Syscall::loadAtlasImage(void* atlas, ushort left, ushort top,
+		ushort width, ushort height)
+	{
+		return NULL;
+	}
+
 	//***************************************************************************
 	// Helpers
 	//***************************************************************************
@@ -271,6 +283,10 @@ namespace Base {
 		maIOCtl_syscall_case(maFileReadToData);
 		maIOCtl_syscall_case(maFileTell);
 		maIOCtl_syscall_case(maFileSeek);
+		maIOCtl_syscall_case(maFileReadAt);
+		maIOCtl_syscall_case(maFileWriteAt);
+		maIOCtl_syscall_case(maFileAppend);
+		maIOCtl_syscall_case(maFileReadSome);
 		maIOCtl_syscall_case(maFileRead);
 		maIOCtl_syscall_case(maFileWrite);
 		maIOCtl_syscall_case(maFileExists);
@@ -292,6 +308,8 @@ namespace Base {
         maIOCtl_syscall_case(maFileListStart);
         maIOCtl_syscall_case(maFileListNext);
         maIOCtl_syscall_case(maFileListClose);
+        maIOCtl_syscall_case(maFileListStartRecursive);
+        maIOCtl_syscall_case(maFileListNextBatch);
         maIOCtl_case(maFileSetProperty);
 		maIOCtl_case(maTextBox);
 		maIOCtl_case(maGetSystemProperty);
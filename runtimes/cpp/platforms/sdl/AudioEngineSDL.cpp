@@ -18,7 +18,10 @@ limitations under the License.
 #include "AudioEngine.h"
 #include "AudioChannel.h"
 #include "AudioSource.h"
+#include "DecodeAheadSource.h"
+#include "PcmCache.h"
 #include "Stream.h"
+#include "base_errors.h"
 #include "WaveAudioSource.h"
 #include "AmrAudioSource.h"
 #ifndef __NO_SDL_SOUND__
@@ -30,10 +33,17 @@ limitations under the License.
 #define DEFAULT_AUDIOBUF_SAMPLES 1024*4
 #define MY_SAMPLE_RATE 44100
 
+// sounds up to this size are decoded once and played from the PCM cache.
+#define PCM_CACHE_MAX_ENCODED (64*1024)
+#define PCM_CACHE_MAX_ENTRY (1024*1024)
+#define PCM_CACHE_SIZE (8*1024*1024)
+
 #ifdef LINUX
 #define stricmp(x, y) strcasecmp(x, y)
 #endif
 
+using namespace MoSyncError;
+
 namespace AudioEngine {
 
 	AudioChannel *gChannels[MAX_CHANNELS];
@@ -41,6 +51,8 @@ namespace AudioEngine {
 
 	static Sint32 gTempBuffer[DEFAULT_AUDIOBUF_SAMPLES*2];
 
+	static PcmCache gPcmCache(PCM_CACHE_SIZE, PCM_CACHE_MAX_ENTRY);
+
 	static void soundCallback(void *userdata, Uint8 *buf,int len) {
 		//MutexHandler m(&gMutex);
 
@@ -72,6 +84,8 @@ namespace AudioEngine {
 #ifndef __NO_SDL_SOUND__
 		if(Sound_Init() == 0) return -1;
 #endif		
+
+		AudioDecoder::start(SDL_LockAudio, SDL_UnlockAudio);
 	
 		SDL_AudioSpec desired;
 		desired.freq=MY_SAMPLE_RATE;
@@ -117,6 +131,9 @@ namespace AudioEngine {
 			}			
 		}
 
+		AudioDecoder::stop();
+		gPcmCache.clear();
+
 		return 0;
 	}
 
@@ -163,4 +180,49 @@ namespace AudioEngine {
 		else
 			return audioSource;
 	}
+
+	AudioSource* getSoundSource(int handle, Base::Stream *data, int offset, int size)
+	{
+		PcmKey key;
+		bool cacheable = size <= PCM_CACHE_MAX_ENCODED &&
+			key.init(handle, *data, offset, size);
+		if(cacheable) {
+			PcmBuffer* pcm = gPcmCache.find(key);
+			if(pcm) {
+				AudioSource* cached = new PcmCacheSource(pcm);
+				pcm->release();
+				return cached;
+			}
+		}
+
+		MYASSERT(data->seek(Base::Seek::Start, offset), ERR_DATA_ACCESS_FAILED);
+
+		//read the MIME type
+		char mime[1024];
+		size_t i=0;
+		byte b;
+		do {
+			if(!data->readByte(b) || i >= sizeof(mime)) {
+				BIG_PHAT_ERROR(ERR_MIME_READ_FAILED);
+			}
+			mime[i++] = b;
+		} while(b);
+
+		int pos;
+		data->tell(pos);
+		int encodedSize = size - pos + offset;
+		LOGA("encodedSize: %i\n", encodedSize);
+		Base::Stream* copy = data->createLimitedCopy(encodedSize);
+
+		AudioSource* decoder = getAudioSource(mime, copy);
+		if(decoder == NULL || decoder->getFrameSize() <= 0)
+			return decoder;
+
+		DecodeAheadSource* source = new DecodeAheadSource(decoder,
+			cacheable ? gPcmCache.getMaxEntryBytes() : 0);
+		if(cacheable)
+			gPcmCache.addPending(key, source->getRecording());
+		source->init();
+		return source;
+	}
 };
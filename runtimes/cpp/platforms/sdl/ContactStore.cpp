@@ -0,0 +1,547 @@
+/* Copyright 2013 David Axmark
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+	http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "config_platform.h"
+#include <helpers/helpers.h>
+#include <helpers/cpp_defs.h>
+#include <helpers/CPP_IX_PIM.h>
+#include "ContactStore.h"
+
+#include <string.h>
+#include <wctype.h>
+#ifdef WIN32
+#include <windows.h>
+#endif
+
+using namespace std;
+
+//******************************************************************************
+// File format
+//******************************************************************************
+
+// All numbers are 32-bit little-endian.
+//
+// header: "MACS", version.
+// record: op, id, length, <length> bytes of contact, checksum.
+//
+// contact: number of values, then for each value:
+// field, attr, type, and either an int or the number of strings
+// followed by the strings. A string is its length followed by
+// 16-bit characters.
+
+static const char sMagic[4] = { 'M', 'A', 'C', 'S' };
+#define STORE_VERSION 1
+#define HEADER_SIZE 8
+#define RECORD_OVERHEAD 16
+
+// The journal is compacted when it's more than twice this much larger than
+// its live contents, so that small stores aren't rewritten all the time.
+#define COMPACT_SLACK (64*1024)
+
+static void putU32(string& s, unsigned v) {
+	char b[4] = { (char)v, (char)(v >> 8), (char)(v >> 16), (char)(v >> 24) };
+	s.append(b, 4);
+}
+
+static bool getU32(const char*& p, const char* end, unsigned& v) {
+	if(end - p < 4)
+		return false;
+	const unsigned char* u = (const unsigned char*)p;
+	v = u[0] | (u[1] << 8) | (u[2] << 16) | ((unsigned)u[3] << 24);
+	p += 4;
+	return true;
+}
+
+static unsigned checksum(const char* data, size_t size, unsigned hash) {
+	// FNV-1a
+	for(size_t i=0; i<size; i++) {
+		hash ^= (unsigned char)data[i];
+		hash *= 16777619;
+	}
+	return hash;
+}
+
+static bool writeRecord(FILE* file, int op, int id, const string& blob) {
+	string head;
+	putU32(head, op);
+	putU32(head, id);
+	putU32(head, blob.size());
+	unsigned sum = checksum(blob.data(), blob.size(), checksum(head.data(), head.size(), 2166136261u));
+	string tail;
+	putU32(tail, sum);
+	return fwrite(head.data(), 1, head.size(), file) == head.size() &&
+		fwrite(blob.data(), 1, blob.size(), file) == blob.size() &&
+		fwrite(tail.data(), 1, tail.size(), file) == tail.size();
+}
+
+// Reads the record at \a p, and moves \a p past it.
+// Returns false if the record is cut off or damaged.
+static bool readRecord(const char*& p, const char* end, unsigned& op, unsigned& id,
+	const char*& blob, unsigned& len)
+{
+	// no TEST(); replay() tries this at every byte of a damaged stretch.
+	const char* start = p;
+	unsigned sum;
+	if(!getU32(p, end, op) || !getU32(p, end, id) || !getU32(p, end, len))
+		return false;
+	if((unsigned)(end - p) < len)
+		return false;
+	blob = p;
+	p += len;
+	if(!getU32(p, end, sum))
+		return false;
+	return sum == checksum(blob, len, checksum(start, 12, 2166136261u));
+}
+
+// Opens an existing file for appending. Unlike fopen(.., "ab"),
+// this doesn't create an empty file, without a header, if it's gone.
+static FILE* openForAppend(const char* filename) {
+	FILE* file = fopen(filename, "r+b");
+	if(file && fseek(file, 0, SEEK_END) != 0) {
+		fclose(file);
+		file = NULL;
+	}
+	return file;
+}
+
+static bool writeHeader(FILE* file) {
+	string head(sMagic, 4);
+	putU32(head, STORE_VERSION);
+	return fwrite(head.data(), 1, head.size(), file) == head.size();
+}
+
+//******************************************************************************
+// Encoding
+//******************************************************************************
+
+static bool hasStrings(int type) {
+	return type == MA_PIM_TYPE_STRING || type == MA_PIM_TYPE_STRING_ARRAY;
+}
+
+void ContactStore::encode(const ContactRecord& record, string& blob) {
+	blob.clear();
+	putU32(blob, record.size());
+	for(size_t i=0; i<record.size(); i++) {
+		const ContactRecordValue& v(record[i]);
+		putU32(blob, v.field);
+		putU32(blob, v.attr);
+		putU32(blob, v.type);
+		if(!hasStrings(v.type)) {
+			putU32(blob, v.intValue);
+			continue;
+		}
+		putU32(blob, v.strings.size());
+		for(size_t j=0; j<v.strings.size(); j++) {
+			const wstring& s(v.strings[j]);
+			putU32(blob, s.size());
+			for(size_t k=0; k<s.size(); k++) {
+				char c[2] = { (char)s[k], (char)(s[k] >> 8) };
+				blob.append(c, 2);
+			}
+		}
+	}
+}
+
+bool ContactStore::decode(const string& blob, ContactRecord& record) {
+	const char* p = blob.data();
+	const char* end = p + blob.size();
+	unsigned nValues;
+	TEST(getU32(p, end, nValues));
+	record.resize(nValues);
+	for(unsigned i=0; i<nValues; i++) {
+		ContactRecordValue& v(record[i]);
+		unsigned field, attr, type;
+		TEST(getU32(p, end, field) && getU32(p, end, attr) && getU32(p, end, type));
+		v.field = field;
+		v.attr = attr;
+		v.type = type;
+		v.intValue = 0;
+		v.strings.clear();
+		if(!hasStrings(type)) {
+			unsigned intValue;
+			TEST(getU32(p, end, intValue));
+			v.intValue = intValue;
+			continue;
+		}
+		unsigned nStrings;
+		TEST(getU32(p, end, nStrings));
+		v.strings.resize(nStrings);
+		for(unsigned j=0; j<nStrings; j++) {
+			unsigned len;
+			TEST(getU32(p, end, len));
+			TEST((unsigned)(end - p) / 2 >= len);
+			wstring& s(v.strings[j]);
+			s.resize(len);
+			const unsigned char* u = (const unsigned char*)p;
+			for(unsigned k=0; k<len; k++) {
+				s[k] = u[k*2] | (u[k*2 + 1] << 8);
+			}
+			p += len * 2;
+		}
+	}
+	return p == end;
+}
+
+//******************************************************************************
+// Indexes
+//******************************************************************************
+
+static wstring lowercase(const wstring& s) {
+	wstring res(s);
+	for(size_t i=0; i<res.size(); i++) {
+		res[i] = towlower(res[i]);
+	}
+	return res;
+}
+
+static wstring digits(const wstring& s) {
+	wstring res;
+	for(size_t i=0; i<s.size(); i++) {
+		if(s[i] >= '0' && s[i] <= '9')
+			res += s[i];
+	}
+	return res;
+}
+
+// the key that \a s is stored under in \a index.
+static wstring normalize(ContactStore::Index index, const wstring& s) {
+	return index == ContactStore::INDEX_TEL ? digits(s) : lowercase(s);
+}
+
+static void addKey(vector<pair<int, wstring> >& keys, ContactStore::Index index,
+	const wstring& s)
+{
+	wstring key = normalize(index, s);
+	if(!key.empty())
+		keys.push_back(pair<int, wstring>(index, key));
+}
+
+static void getKeys(const ContactRecord& record, vector<pair<int, wstring> >& keys) {
+	for(size_t i=0; i<record.size(); i++) {
+		const ContactRecordValue& v(record[i]);
+		switch(v.field) {
+		case MA_PIM_FIELD_CONTACT_NAME:
+			if(v.strings.size() > MA_PIM_CONTACT_NAME_GIVEN) {
+				addKey(keys, ContactStore::INDEX_NAME, v.strings[MA_PIM_CONTACT_NAME_FAMILY]);
+				addKey(keys, ContactStore::INDEX_NAME, v.strings[MA_PIM_CONTACT_NAME_GIVEN]);
+			}
+			break;
+		case MA_PIM_FIELD_CONTACT_FORMATTED_NAME:
+			if(!v.strings.empty())
+				addKey(keys, ContactStore::INDEX_NAME, v.strings[0]);
+			break;
+		case MA_PIM_FIELD_CONTACT_TEL:
+			if(!v.strings.empty())
+				addKey(keys, ContactStore::INDEX_TEL, v.strings[0]);
+			break;
+		case MA_PIM_FIELD_CONTACT_EMAIL:
+			if(!v.strings.empty())
+				addKey(keys, ContactStore::INDEX_EMAIL, v.strings[0]);
+			break;
+		}
+	}
+}
+
+void ContactStore::index(int id, const string& blob, bool add) {
+	ContactRecord record;
+	if(!decode(blob, record))
+		return;
+	vector<pair<int, wstring> > keys;
+	getKeys(record, keys);
+	for(size_t i=0; i<keys.size(); i++) {
+		KeyMap& map(mIndex[keys[i].first]);
+		if(add) {
+			map.insert(KeyMap::value_type(keys[i].second, id));
+			continue;
+		}
+		pair<KeyMap::iterator, KeyMap::iterator> range = map.equal_range(keys[i].second);
+		for(KeyMap::iterator itr = range.first; itr != range.second; ++itr) {
+			if(itr->second == id) {
+				map.erase(itr);
+				break;
+			}
+		}
+	}
+}
+
+void ContactStore::find(Index index, const wstring& key, vector<int>& ids) const {
+	const KeyMap& map(mIndex[index]);
+	pair<KeyMap::const_iterator, KeyMap::const_iterator> range =
+		map.equal_range(normalize(index, key));
+	for(KeyMap::const_iterator itr = range.first; itr != range.second; ++itr) {
+		ids.push_back(itr->second);
+	}
+}
+
+void ContactStore::findPrefix(Index index, const wstring& prefix, vector<int>& ids) const {
+	const KeyMap& map(mIndex[index]);
+	wstring key = normalize(index, prefix);
+	KeyMap::const_iterator itr = map.lower_bound(key);
+	for(; itr != map.end(); ++itr) {
+		if(itr->first.compare(0, key.size(), key) != 0)
+			break;
+		ids.push_back(itr->second);
+	}
+}
+
+//******************************************************************************
+// Journal
+//******************************************************************************
+
+ContactStore::ContactStore() : mFile(NULL), mFileSize(0), mLiveSize(0),
+	mNextId(1), mGeneration(0)
+{
+}
+
+ContactStore::~ContactStore() {
+	close();
+}
+
+void ContactStore::close() {
+	if(mFile)
+		fclose(mFile);
+	mFile = NULL;
+	mRecords.clear();
+	for(int i=0; i<INDEX_COUNT; i++) {
+		mIndex[i].clear();
+	}
+	mFileSize = mLiveSize = 0;
+	mNextId = 1;
+}
+
+bool ContactStore::create(const char* filename) {
+	close();
+	mFilename = filename;
+	mFile = fopen(filename, "wb");
+	if(!mFile) {
+		LOG("ContactStore: could not create %s\n", filename);
+		return false;
+	}
+	if(!writeHeader(mFile) || fflush(mFile) != 0) {
+		close();
+		return false;
+	}
+	mFileSize = mLiveSize = HEADER_SIZE;
+	mGeneration++;
+	return true;
+}
+
+bool ContactStore::open(const char* filename) {
+	close();
+	mFilename = filename;
+	FILE* file = fopen(filename, "rb");
+	if(!file)
+		return false;
+	fseek(file, 0, SEEK_END);
+	long size = ftell(file);
+	fseek(file, 0, SEEK_SET);
+	// one read is much faster than one per record.
+	vector<char> data(size > 0 ? size : 1);
+	bool res = size >= HEADER_SIZE && fread(&data[0], 1, size, file) == (size_t)size;
+	fclose(file);
+	if(!res || memcmp(&data[0], sMagic, 4) != 0) {
+		LOG("ContactStore: %s is not a contact store\n", filename);
+		return false;
+	}
+	const char* p = &data[4];
+	unsigned version;
+	getU32(p, p + 4, version);
+	if(version != STORE_VERSION) {
+		LOG("ContactStore: %s has unknown version %u\n", filename, version);
+		return false;
+	}
+
+	int goodSize, damaged;
+	mLiveSize = HEADER_SIZE;
+	replay(&data[0], (int)size, goodSize, damaged);
+	mFileSize = goodSize;
+
+	mFile = openForAppend(filename);
+	if(!mFile) {
+		close();
+		return false;
+	}
+	if(goodSize != size || damaged != 0) {
+		// a record was cut off, probably by a crash, or damaged. Drop it.
+		if(goodSize != size)
+			LOG("ContactStore: dropping %i bytes at the end of %s\n", (int)size - goodSize, filename);
+		if(!compact()) {
+			close();
+			return false;
+		}
+	}
+	mGeneration++;
+	return true;
+}
+
+bool ContactStore::replay(const char* data, int size, int& goodSize, int& damaged) {
+	const char* p = data + HEADER_SIZE;
+	const char* end = data + size;
+	goodSize = HEADER_SIZE;
+	damaged = 0;
+	while(p != end) {
+		const char* start = p;
+		unsigned op, id, len;
+		const char* blob;
+		if(!readRecord(p, end, op, id, blob, len)) {
+			// find the next good record, so that one damaged record doesn't
+			// take all the later ones with it. The checksum keeps the middle
+			// of a record from passing for one.
+			const char* next = start;
+			do {
+				p = ++next;
+			} while(next != end && !readRecord(p, end, op, id, blob, len));
+			if(next == end) {
+				// cut off at the end.
+				return true;
+			}
+			LOG("ContactStore: skipping %i damaged bytes at offset %i\n",
+				(int)(next - start), (int)(start - data));
+			damaged += next - start;
+		}
+
+		RecordMap::iterator itr = mRecords.find(id);
+		if(itr != mRecords.end() && op != OP_NOP) {
+			index(id, itr->second, false);
+			mLiveSize -= RECORD_OVERHEAD + itr->second.size();
+			if(op == OP_REMOVE)
+				mRecords.erase(itr);
+		}
+		if(op == OP_PUT) {
+			string& s(mRecords[id]);
+			s.assign(blob, len);
+			index(id, s, true);
+			mLiveSize += RECORD_OVERHEAD + len;
+			if((int)id >= mNextId)
+				mNextId = id + 1;
+		}
+		goodSize = p - data;
+	}
+	return true;
+}
+
+bool ContactStore::append(int op, int id, const string& blob) {
+	TEST(mFile);
+	if(!writeRecord(mFile, op, id, blob) || fflush(mFile) != 0) {
+		LOG("ContactStore: could not write %s\n", mFilename.c_str());
+		return false;
+	}
+	mFileSize += RECORD_OVERHEAD + blob.size();
+	return true;
+}
+
+int ContactStore::put(int id, const ContactRecord& record) {
+	string blob;
+	encode(record, blob);
+	if(id == 0)
+		id = mNextId;
+	RecordMap::iterator itr = mRecords.find(id);
+	if(itr != mRecords.end() && itr->second == blob)
+		return id;
+	if(!append(OP_PUT, id, blob))
+		return 0;
+	if(itr != mRecords.end()) {
+		index(id, itr->second, false);
+		mLiveSize -= RECORD_OVERHEAD + itr->second.size();
+		itr->second.swap(blob);
+	} else {
+		itr = mRecords.insert(RecordMap::value_type(id, blob)).first;
+	}
+	index(id, itr->second, true);
+	mLiveSize += RECORD_OVERHEAD + itr->second.size();
+	if(id >= mNextId)
+		mNextId = id + 1;
+	mGeneration++;
+	maybeCompact();
+	return id;
+}
+
+bool ContactStore::remove(int id) {
+	RecordMap::iterator itr = mRecords.find(id);
+	if(itr == mRecords.end())
+		return false;
+	TEST(append(OP_REMOVE, id, string()));
+	index(id, itr->second, false);
+	mLiveSize -= RECORD_OVERHEAD + itr->second.size();
+	mRecords.erase(itr);
+	mGeneration++;
+	maybeCompact();
+	return true;
+}
+
+bool ContactStore::touch() {
+	return append(OP_NOP, 0, string());
+}
+
+bool ContactStore::get(int id, ContactRecord& record) const {
+	RecordMap::const_iterator itr = mRecords.find(id);
+	if(itr == mRecords.end())
+		return false;
+	return decode(itr->second, record);
+}
+
+void ContactStore::ids(vector<int>& ids) const {
+	ids.reserve(ids.size() + mRecords.size());
+	for(RecordMap::const_iterator itr = mRecords.begin(); itr != mRecords.end(); ++itr) {
+		ids.push_back(itr->first);
+	}
+}
+
+void ContactStore::maybeCompact() {
+	if(mFileSize > 2 * mLiveSize + COMPACT_SLACK)
+		compact();
+}
+
+bool ContactStore::compact() {
+	TEST(mFile);
+	string tempName = mFilename + ".tmp";
+	FILE* file = fopen(tempName.c_str(), "wb");
+	if(!file) {
+		LOG("ContactStore: could not create %s\n", tempName.c_str());
+		return false;
+	}
+	bool res = writeHeader(file);
+	for(RecordMap::const_iterator itr = mRecords.begin(); res && itr != mRecords.end(); ++itr) {
+		res = writeRecord(file, OP_PUT, itr->first, itr->second);
+	}
+	res = (fclose(file) == 0) && res;
+	if(!res) {
+		::remove(tempName.c_str());
+		LOG("ContactStore: could not write %s\n", tempName.c_str());
+		return false;
+	}
+
+	// the old file is replaced in one step, so that a crash leaves either
+	// the old or the new journal. Windows can't replace an open file.
+	fclose(mFile);
+#ifdef WIN32
+	res = MoveFileExA(tempName.c_str(), mFilename.c_str(), MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+	res = rename(tempName.c_str(), mFilename.c_str()) == 0;
+#endif
+	if(!res) {
+		// keep appending to the old journal.
+		LOG("ContactStore: could not replace %s\n", mFilename.c_str());
+		::remove(tempName.c_str());
+	} else {
+		mFileSize = mLiveSize;
+	}
+	mFile = openForAppend(mFilename.c_str());
+	if(!mFile) {
+		LOG("ContactStore: could not reopen %s\n", mFilename.c_str());
+		return false;
+	}
+	return res;
+}
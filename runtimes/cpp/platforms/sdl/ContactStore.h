@@ -0,0 +1,133 @@
+/* Copyright 2013 David Axmark
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+	http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef CONTACTSTORE_H
+#define CONTACTSTORE_H
+
+#include <stdio.h>
+#include <string>
+#include <vector>
+#include <map>
+
+// One value of a contact field.
+struct ContactRecordValue {
+	int field;
+	int attr;
+	int type;	// MA_PIM_TYPE_*
+	// MA_PIM_TYPE_INT, _DATE and _BOOLEAN.
+	int intValue;
+	// one string for MA_PIM_TYPE_STRING, one per element for _STRING_ARRAY.
+	std::vector<std::wstring> strings;
+};
+
+typedef std::vector<ContactRecordValue> ContactRecord;
+
+// The emulator's contact list, kept in a binary journal file.
+//
+// The journal starts with a header, followed by records that each put or remove
+// one contact. Opening the store replays the journal; changes are appended to it,
+// so committing one contact doesn't rewrite the file. When more than half of
+// the file is records that have been replaced or removed, the journal is
+// compacted: rewritten with only the live contacts.
+//
+// The contacts are kept in memory, encoded, and are decoded by get().
+// Names, phone numbers and email addresses are indexed for lookups.
+class ContactStore {
+public:
+	enum Index {
+		// the given and family names, and the formatted name. Case-insensitive.
+		INDEX_NAME,
+		// phone numbers. Only the digits are compared.
+		INDEX_TEL,
+		// email addresses. Case-insensitive.
+		INDEX_EMAIL,
+		INDEX_COUNT
+	};
+
+	ContactStore();
+	~ContactStore();
+
+	// Opens an existing store.
+	// Returns false if the file doesn't exist or isn't a contact store.
+	// A record that was only partly written, or that is damaged, is dropped.
+	bool open(const char* filename);
+
+	// Creates an empty store, replacing \a filename if it exists.
+	bool create(const char* filename);
+
+	void close();
+	bool isOpen() const { return mFile != NULL; }
+
+	// Stores a contact. \a id is 0 for a new contact.
+	// Returns the contact's id, or 0 if the journal could not be written.
+	// Nothing is written if the contact is unchanged.
+	int put(int id, const ContactRecord& record);
+
+	// Returns false if there is no contact \a id.
+	bool remove(int id);
+
+	// Returns false if there is no contact \a id.
+	bool get(int id, ContactRecord& record) const;
+
+	int size() const { return (int)mRecords.size(); }
+
+	// Appends the ids of all contacts to \a ids, in ascending order.
+	void ids(std::vector<int>& ids) const;
+
+	// Appends the ids of the contacts that have \a key in \a index.
+	void find(Index index, const std::wstring& key, std::vector<int>& ids) const;
+	// Appends the ids of the contacts that have a key that starts with \a prefix.
+	void findPrefix(Index index, const std::wstring& prefix, std::vector<int>& ids) const;
+
+	// Rewrites the journal with only the live contacts.
+	bool compact();
+
+	// Incremented by every change. Used to tell if the contacts need exporting.
+	int generation() const { return mGeneration; }
+
+	// Appends a record that changes nothing, to make the file newer than
+	// another file written from it, like an exported contacts.xml.
+	bool touch();
+
+	int fileSize() const { return mFileSize; }
+
+	static void encode(const ContactRecord& record, std::string& blob);
+	static bool decode(const std::string& blob, ContactRecord& record);
+
+private:
+	enum { OP_PUT = 1, OP_REMOVE = 2, OP_NOP = 3 };
+
+	bool append(int op, int id, const std::string& blob);
+	// \a goodSize is set to the end of the last good record.
+	// \a damaged is set to the number of bytes of damaged records before it.
+	bool replay(const char* data, int size, int& goodSize, int& damaged);
+	void index(int id, const std::string& blob, bool add);
+	void maybeCompact();
+
+	typedef std::map<int, std::string> RecordMap;
+	typedef std::multimap<std::wstring, int> KeyMap;
+
+	RecordMap mRecords;
+	KeyMap mIndex[INDEX_COUNT];
+	std::string mFilename;
+	FILE* mFile;
+	int mFileSize;
+	// the size the journal would have if it were compacted.
+	int mLiveSize;
+	int mNextId;
+	int mGeneration;
+};
+
+#endif	//CONTACTSTORE_H
@@ -58,14 +58,18 @@ static int myOpen(const char* filename, MyOpenMode mode) {
 }
 
 namespace Base {
+	// the size of FileStream's read buffer.
+	// reads of this size or larger go directly to the destination.
+	#define FILE_BUFFER_SIZE (4*1024)
+
 	//******************************************************************************
 	//FileStream
 	//******************************************************************************
 	const char* FileStream::getFilename() const {
 		return mFilename ? mFilename : "";
 	}
-	FileStream::FileStream() : mFilename(NULL) {}
-	FileStream::FileStream(const char* filename) {
+	FileStream::FileStream() : mFd(-1), mFilename(NULL), mFdRefs(NULL), mBuf(NULL), mBufStart(0) {}
+	FileStream::FileStream(const char* filename) : mFdRefs(NULL), mBuf(NULL), mBufStart(0) {
 		int size = strlen(filename) + 1;
 		mFilename = (char*)malloc(size);
 		memcpy(mFilename, filename, size);
@@ -82,12 +86,51 @@ namespace Base {
 		if(mFilename) {
 			free(mFilename);
 		}
+		if(mBuf) {
+			free(mBuf);
+		}
+		closeFd();
+	}
+	void FileStream::closeFd() {
+#ifdef FILESTREAM_SHARED_FD
+		if(mFdRefs) {
+			// other streams may still use the descriptor,
+			// and they may be on other threads.
+			if(__sync_sub_and_fetch(mFdRefs, 1) == 0) {
+				delete mFdRefs;
+				::close(mFd);
+			}
+			mFdRefs = NULL;
+			mFd = -1;
+			return;
+		}
+#endif
 		if(isOpen()) {
 			::close(mFd);
 		}
+		mFd = -1;
 	}
-	bool FileStream::read(void* dst, int size) {
-		TEST(isOpen());
+#ifdef FILESTREAM_SHARED_FD
+	void FileStream::shareFd(const FileStream& other) {
+		if(other.mFilename) {
+			int size = strlen(other.mFilename) + 1;
+			mFilename = (char*)malloc(size);
+			memcpy(mFilename, other.mFilename, size);
+		}
+		if(!other.isOpen())
+			return;
+		if(!other.mFdRefs) {
+			// another thread may be sharing the descriptor at the same time.
+			int* refs = new int(1);
+			if(!__sync_bool_compare_and_swap(&other.mFdRefs, (int*)NULL, refs))
+				delete refs;
+		}
+		mFdRefs = other.mFdRefs;
+		__sync_add_and_fetch(mFdRefs, 1);
+		mFd = other.mFd;
+	}
+#endif
+	bool FileStream::readRaw(void* dst, int size) {
 		byte* pos = (byte*)dst;
 		byte* end = pos + size;
 		while(pos != end) {
@@ -103,16 +146,128 @@ namespace Base {
 		}
 		return true;
 	}
-	bool FileStream::length(int& aLength) const {
+	// refills the read buffer, which must be empty, with at least needed bytes.
+	bool FileStream::fillBuffer(int needed) {
+		DEBUG_ASSERT(mReadPtr == mReadEnd);
+		DEBUG_ASSERT(needed <= FILE_BUFFER_SIZE);
+		if(mReadEnd) {
+			mBufStart += mReadEnd - mBuf;
+		} else {
+			LTEST(mBufStart = lseek(mFd, 0, SEEK_CUR));
+		}
+		if(!mBuf) {
+			mBuf = (byte*)malloc(FILE_BUFFER_SIZE);
+			TEST(mBuf);
+		}
+		int len = 0;
+		mReadPtr = mReadEnd = mBuf;
+		while(len < needed) {
+			int res = ::read(mFd, mBuf + len, FILE_BUFFER_SIZE - len);
+			if(res == 0) {
+				LOG("Unexpected EOF.\n");
+				FAIL;
+			}
+			LTEST(res);
+			len += res;
+			mReadEnd = mBuf + len;
+		}
+		return true;
+	}
+	// forgets the read buffer, and moves the descriptor back to the stream's position.
+	bool FileStream::dropBuffer() {
+		int unread = mReadEnd - mReadPtr;
+		mReadPtr = mReadEnd = NULL;
+		if(unread > 0) {
+			LTEST(lseek(mFd, -unread, SEEK_CUR));
+		}
+		return true;
+	}
+	bool FileStream::discardBuffer() {
+		if(!mReadEnd)
+			return true;
+		// start over at the stream's position.
+		int pos = mBufStart + (mReadPtr - mBuf);
+		mReadPtr = mReadEnd = NULL;
+		LTEST(lseek(mFd, pos, SEEK_SET));
+		return true;
+	}
+	bool FileStream::read(void* dst, int size) {
+		TEST(isOpen());
+		byte* pos = (byte*)dst;
+		int buffered = mReadEnd - mReadPtr;
+		if(buffered >= size) {
+			memcpy(pos, mReadPtr, size);
+			mReadPtr += size;
+			return true;
+		}
+		if(buffered > 0) {
+			memcpy(pos, mReadPtr, buffered);
+			mReadPtr += buffered;
+			pos += buffered;
+			size -= buffered;
+		}
+		if(size >= FILE_BUFFER_SIZE) {
+			// the buffer is used up, so the descriptor is at the stream's position.
+			mReadPtr = mReadEnd = NULL;
+			return readRaw(pos, size);
+		}
+		TEST(fillBuffer(size));
+		memcpy(pos, mReadPtr, size);
+		mReadPtr += size;
+		return true;
+	}
+	bool FileStream::readAt(void* dst, int size, int offset) {
 		TEST(isOpen());
+#ifdef WIN32
+		// there's no pread(). put the descriptor back where it was,
+		// for read(). the descriptor isn't shared, see FileImpl.h.
 		int oldpos;
 		LTEST(oldpos = lseek(mFd, 0, SEEK_CUR));
-		LTEST(aLength = lseek(mFd, 0, SEEK_END));
+		LTEST(lseek(mFd, offset, SEEK_SET));
+		bool res = readRaw(dst, size);
 		LTEST(lseek(mFd, oldpos, SEEK_SET));
+		return res;
+#else
+		byte* pos = (byte*)dst;
+		byte* end = pos + size;
+		while(pos != end) {
+			int len = end - pos;
+			int res = ::pread(mFd, pos, len, offset);
+			if(res == 0) {
+				LOG("Unexpected EOF.\n");
+				FAIL;
+			}
+			LTEST(res);
+			DEBUG_ASSERT(res <= len);
+			pos += res;
+			offset += res;
+		}
+		return true;
+#endif
+	}
+	bool FileStream::length(int& aLength) const {
+		TEST(isOpen());
+		struct stat s;
+		LTEST(fstat(mFd, &s));
+		aLength = s.st_size;
 		return true;
 	}
 	bool FileStream::seek(Seek::Enum mode, int offset) {
 		TEST(isOpen());
+		if(mReadEnd) {
+			// a seek within the buffer doesn't need the descriptor.
+			int pos = mBufStart + (mReadPtr - mBuf);
+			int target = -1;
+			if(mode == Seek::Start)
+				target = offset;
+			else if(mode == Seek::Current)
+				target = pos + offset;
+			if(target >= mBufStart && target <= mBufStart + (mReadEnd - mBuf)) {
+				mReadPtr = mBuf + (target - mBufStart);
+				return true;
+			}
+			TEST(dropBuffer());
+		}
 		int lm;
 		switch(mode) {
 			case Seek::Start: lm = SEEK_SET; break;
@@ -125,6 +280,10 @@ namespace Base {
 	}
 	bool FileStream::tell(int& aPos) const {
 		TEST(isOpen());
+		if(mReadEnd) {
+			aPos = mBufStart + (mReadPtr - mBuf);
+			return true;
+		}
 		LTEST(aPos = lseek(mFd, 0, SEEK_CUR));
 		return true;
 	}
@@ -137,7 +296,7 @@ namespace Base {
 	};
 
 #ifdef _android
-	FileStream::FileStream(int fd) : mFilename(NULL) {
+	FileStream::FileStream(int fd) : mFilename(NULL), mFdRefs(NULL), mBuf(NULL), mBufStart(0) {
 		mFd = fd;
 	}
 #endif
@@ -147,13 +306,23 @@ namespace Base {
 	//LimitedFileStream
 	//******************************************************************************
 	LimitedFileStream::LimitedFileStream(const char* filename, int offset, int len)
-		: FileStream(filename), mStartPos(offset), mEndPos(offset + len)
+		: FileStream(filename), mStartPos(offset), mEndPos(offset + len), mPos(0), mWindow(NULL)
 	{
 		if(!_open()) {
-			::close(mFd);
-			mFd = -1;
+			closeFd();
+		}
+	}
+
+#ifdef FILESTREAM_SHARED_FD
+	LimitedFileStream::LimitedFileStream(const FileStream& file, int offset, int len)
+		: mStartPos(offset), mEndPos(offset + len), mPos(0), mWindow(NULL)
+	{
+		shareFd(file);
+		if(isOpen() && !_open()) {
+			closeFd();
 		}
 	}
+#endif
 #endif	//_android
 
 	//******************************************************************************
@@ -166,6 +335,7 @@ namespace Base {
 	}
 	bool WriteFileStream::write(const void* src, int size) {
 		TEST(isOpen());
+		TEST(dropBuffer());
 		const byte* pos = (const byte*)src;
 		const byte* end = pos + size;
 		while(pos != end) {
@@ -181,11 +351,41 @@ namespace Base {
 		}
 		return true;
 	}
+	bool WriteFileStream::writeAt(const void* src, int size, int offset) {
+		TEST(isOpen());
+		// the write may change what's in the buffer.
+		TEST(dropBuffer());
+#ifdef WIN32
+		int oldpos;
+		LTEST(oldpos = lseek(mFd, 0, SEEK_CUR));
+		LTEST(lseek(mFd, offset, SEEK_SET));
+		bool res = write(src, size);
+		LTEST(lseek(mFd, oldpos, SEEK_SET));
+		return res;
+#else
+		const byte* pos = (const byte*)src;
+		const byte* end = pos + size;
+		while(pos != end) {
+			int len = end - pos;
+			int res = ::pwrite(mFd, pos, len, offset);
+			if(res == 0) {
+				LOG("Unexpected EOF.\n");
+				FAIL;
+			}
+			LTEST(res);
+			DEBUG_ASSERT(res <= len);
+			pos += res;
+			offset += res;
+		}
+		return true;
+#endif
+	}
 #ifdef _MSC_VER
 #define ftruncate _chsize
 #endif
 	bool WriteFileStream::truncate(int size) {
 		TEST(isOpen());
+		TEST(dropBuffer());
 		LTEST(ftruncate(mFd, size));
 		return true;
 	}
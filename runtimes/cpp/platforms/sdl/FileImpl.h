@@ -17,5 +17,26 @@ int mFd;
 protected:
 char* mFilename;
 
+// the number of streams that share mFd, or NULL if it isn't shared.
+mutable int* mFdRefs;
+
+// the read buffer, allocated by the first small read.
+// mReadPtr and mReadEnd point into it, and mBufStart is the file offset of its first byte.
+// when they are set, the descriptor's position is at mReadEnd.
+byte* mBuf;
+int mBufStart;
+
 protected:
 FileStream();
+bool readRaw(void* dst, int size);
+bool fillBuffer(int needed);
+bool dropBuffer();
+void shareFd(const FileStream& other);
+void closeFd();
+
+#if !defined(_android) && !defined(WIN32)
+// LimitedFileStreams can share the descriptor of the stream they're created from.
+// Not on Windows, where readAt() has to move the descriptor's position, and
+// streams on other threads would read from the wrong place meanwhile.
+#define FILESTREAM_SHARED_FD
+#endif
@@ -51,7 +51,7 @@ namespace Debugger {
 		gMemDS = mem_ds;
 		gSizeMemDS = size_mem_ds;
 		gMemCS = mem_cs;
-		gSizeMemDS = size_mem_cs;
+		gSizeMemCS = size_mem_cs;
 		gPc = pc;
 
 		return true;
@@ -114,6 +114,10 @@ namespace Debugger {
 			SDLNet_TCP_Close(server_tcpsock);
 	}
 
+	void setDataSegmentSize(unsigned int size_mem_ds) {
+		gSizeMemDS = size_mem_ds;
+	}
+
 	enum DebugCommands {
 		CMD_NULL		= 0,
 		CMD_ECHO		= 1,
@@ -29,12 +29,15 @@ limitations under the License.
 #include "helpers/hash_map.h"
 #include "helpers/hash_set.h"
 #include "ConfigParser.h"
+#include "ContactStore.h"
 #include <expat.h>
 #include <limits.h>
 #include <vector>
 #include <map>
 #include <stdexcept>
 #include <fstream>
+#include <algorithm>
+#include <sys/stat.h>
 
 #ifdef WIN32
 #include <stdio.h>
@@ -80,6 +83,9 @@ struct ContactValue;
 static int createContactValue(ContactValue*& v, int field, void* buf, int bufSize,
 	int attributes);
 
+// returns NULL if the type is not supported.
+static ContactValue* newContactValue(int field, int type);
+
 //******************************************************************************
 // Contacts
 //******************************************************************************
@@ -107,6 +113,8 @@ struct ContactValue {
 	virtual int getValue(void* buf, size_t bufSize) const = 0;
 	virtual void setValue(void* buf, size_t bufSize) = 0;
 	virtual void saveValue(ostream& stream) const = 0;
+	virtual void getRecordValue(ContactRecordValue& v) const = 0;
+	virtual void setRecordValue(const ContactRecordValue& v) = 0;
 	virtual ContactValue* clone() const = 0;
 	void save(ostream& stream) const;
 };
@@ -118,6 +126,8 @@ template<class T> struct TContactValue : ContactValue {
 	int getValue(void* buf, size_t bufSize) const;
 	void setValue(void* buf, size_t bufSize);
 	void saveValue(ostream& stream) const;
+	void getRecordValue(ContactRecordValue& v) const;
+	void setRecordValue(const ContactRecordValue& v);
 
 	ContactValue* clone() const {
 		TContactValue* tcv = new TContactValue(*this);
@@ -181,6 +191,16 @@ void TContactValue<int>::saveValue(ostream& stream) const {
 	stream <<"\"";
 }
 
+template<>
+void TContactValue<int>::getRecordValue(ContactRecordValue& v) const {
+	v.intValue = mValue;
+}
+
+template<>
+void TContactValue<int>::setRecordValue(const ContactRecordValue& v) {
+	mValue = v.intValue;
+}
+
 // no bounds check. converts any wchar_t to 16-bit wchar, which MoSync uses.
 static void wstringCpy(wchar* dst, const wstring& s) {
 	for(size_t i=0; i<s.length(); i++) {
@@ -249,6 +269,19 @@ void TContactValue<wstring>::saveValue(ostream& stream) const {
 	stream << " value=\""<<mValue<<"\"";
 }
 
+template<>
+void TContactValue<wstring>::getRecordValue(ContactRecordValue& v) const {
+	v.strings.assign(1, mValue);
+}
+
+template<>
+void TContactValue<wstring>::setRecordValue(const ContactRecordValue& v) {
+	if(v.strings.empty())
+		mValue.clear();
+	else
+		mValue = v.strings[0];
+}
+
 template<>
 int TContactValue<StringArray>::getValue(void* buf, size_t bufSize) const {
 	const vector<wstring>& sa(mValue.sa);
@@ -300,6 +333,19 @@ void TContactValue<StringArray>::saveValue(ostream& stream) const {
 	}
 }
 
+template<>
+void TContactValue<StringArray>::getRecordValue(ContactRecordValue& v) const {
+	v.strings = mValue.sa;
+}
+
+template<>
+void TContactValue<StringArray>::setRecordValue(const ContactRecordValue& v) {
+	// the number of strings is given by the field.
+	size_t size = mValue.sa.size();
+	mValue.sa = v.strings;
+	mValue.sa.resize(size);
+}
+
 class ContactItem : public PimItem {
 public:
 	int count() const {
@@ -451,6 +497,42 @@ public:
 
 	void save(ostream& stream) const;
 
+	// the fields are stored in ascending order, so that an unchanged item
+	// always gives the same record.
+	void toRecord(ContactRecord& record) const {
+		vector<int> fields;
+		for(FieldMap::const_iterator itr = mFields.begin(); itr != mFields.end(); itr++) {
+			fields.push_back(itr->first);
+		}
+		sort(fields.begin(), fields.end());
+		record.clear();
+		for(size_t i=0; i<fields.size(); i++) {
+			const vector<ContactValue*>& vcv(getVCV(fields[i]));
+			for(size_t j=0; j<vcv.size(); j++) {
+				record.push_back(ContactRecordValue());
+				ContactRecordValue& v(record.back());
+				v.field = fields[i];
+				v.attr = vcv[j]->attr;
+				v.type = vcv[j]->type;
+				v.intValue = 0;
+				vcv[j]->getRecordValue(v);
+			}
+		}
+	}
+
+	void fromRecord(const ContactRecord& record) {
+		clear();
+		for(size_t i=0; i<record.size(); i++) {
+			const ContactRecordValue& v(record[i]);
+			ContactValue* cv = newContactValue(v.field, pimContactFieldType(v.field));
+			if(cv == NULL)
+				continue;
+			cv->setRecordValue(v);
+			cv->attr = v.attr;
+			addValue(v.field, cv);
+		}
+	}
+
 	// key: fieldId
 	typedef hash_map<int, vector<ContactValue*> > FieldMap;
 	FieldMap mFields;
@@ -458,23 +540,24 @@ public:
 
 class ContactList : public PimList {
 private:
-	// commited items.
-	typedef hash_set<ContactItem*> ItemSet;
-	// opened => commited items.
-	typedef hash_map<ContactItem*, ContactItem*> ItemMap;
-	typedef pair<ContactItem*, ContactItem*> ItemPair;
+	// opened item => id of the stored contact, or 0 for a new item.
+	typedef hash_map<ContactItem*, int> ItemMap;
+	typedef pair<ContactItem*, int> ItemPair;
 
 	ItemMap mOpenItems;
-	ItemSet mItems;
-	ItemSet::const_iterator mItr;
-	string mFilename;
+	// the contacts returned by next(); the ones in the store when the list was opened.
+	vector<int> mIds;
+	size_t mPos;
+	ContactStore& mStore;
 	const MAHandle mPlh;
 public:
-	ContactList(MAHandle plh) : mPlh(plh) {}
-	bool open(const string& fn) {
-		mFilename = fn;
+	ContactList(MAHandle plh, ContactStore& store) : mPos(0), mStore(store), mPlh(plh) {
+		mStore.ids(mIds);
+	}
+	// adds the contacts in an xml file to the store.
+	bool import(const string& fn) {
+		XML_Parser xmlParser = XML_ParserCreate("UTF-8");
 		try {
-			XML_Parser xmlParser = XML_ParserCreate("UTF-8");
 			XML_SetUserData(xmlParser, this);
 			XML_SetElementHandler(xmlParser, ContactParser::start, ContactParser::end);
 			int fileLength;
@@ -485,81 +568,64 @@ public:
 			delete contents;
 		} catch (exception& e) {
 			LOG("ContactParser exception: %s\n", e.what());
+			XML_ParserFree(xmlParser);
 			return false;
 		}
-		mItr = mItems.begin();
+		XML_ParserFree(xmlParser);
 		return true;
 	}
-	virtual ~ContactList() {
-		for(ItemSet::const_iterator itr=mItems.begin(); itr!=mItems.end(); ++itr) {
-			delete *itr;
-		}
-	}
-	bool save(const string& fn) {
-		mFilename = fn;
-		ofstream stream(fn.c_str());
-		stream << "<?xml version=\"1.0\" encoding=\"utf-8\"?>\n";
-		stream << "<contacts>\n";
-		for(ItemSet::const_iterator itr=mItems.begin(); itr!=mItems.end(); ++itr) {
-			(*itr)->save(stream);
-		}
-		stream << "</contacts>\n";
-		return stream.good();
-	}
 	PimItem* next() {
-		if(mItr == mItems.end())
-			return NULL;
-		ContactItem* ci = new ContactItem(**mItr);
-		mOpenItems.insert(ItemPair(ci, *mItr));
-		mItr++;
-		return ci;
+		while(mPos < mIds.size()) {
+			int id = mIds[mPos++];
+			ContactRecord record;
+			// skip contacts that have been removed since the list was opened.
+			if(!mStore.get(id, record))
+				continue;
+			ContactItem* ci = new ContactItem(mPlh);
+			ci->fromRecord(record);
+			mOpenItems.insert(ItemPair(ci, id));
+			return ci;
+		}
+		return NULL;
 	}
 	int type(int field) const {
 		return pimContactFieldType(field);
 	}
 	PimItem* createItem() {
-		//mItr = mItems.end();	// disable next()
 		DEBUG_ASSERT(gSyscall->mPimLists.find(mPlh) == this);
 		ContactItem* ci = new ContactItem(mPlh);
 		// item is uncommited and won't be saved until closed.
-		mOpenItems.insert(ItemPair(ci, (ContactItem*)NULL));
+		mOpenItems.insert(ItemPair(ci, 0));
 		return ci;
 	}
 	int removeItem(PimItem* pi) {
-		//mItr = mItems.end();	// disable next()
 		ItemMap::iterator itr = mOpenItems.find((ContactItem*)pi);
 		DEBUG_ASSERT(itr != mOpenItems.end());
-		if(itr->second) {
-			mItems.erase(itr->second);
-			save(mFilename);
-		}
+		if(itr->second)
+			mStore.remove(itr->second);
 		mOpenItems.erase(itr);
 		return 0;
 	}
 
 	// used by parser.
 	void add(ContactItem* ci) {
-		mItems.insert(ci);
+		ContactRecord record;
+		ci->toRecord(record);
+		delete ci;
+		if(mStore.put(0, record) == 0)
+			ContactParser::error("store write fail");
 	}
 
 	// used by ContactItem::close().
 	void close(ContactItem* ci) {
 		ItemMap::iterator itr = mOpenItems.find((ContactItem*)ci);
 		DEBUG_ASSERT(itr != mOpenItems.end());
-		bool modified = false;
-		ContactItem* orig = itr->second;
-		if(orig) {	// existing item
-			if(*orig != *ci) {
-				*orig = *ci;
-				modified = true;
-			}
-		} else {	// new item
-			//mItr = mItems.end();	// disable next()
-			mItems.insert(new ContactItem(*ci));
-			modified = true;
+		ContactRecord record;
+		ci->toRecord(record);
+		// the store only writes the contact if it has changed.
+		if(mStore.put(itr->second, record) == 0) {
+			LOG("Could not save contact\n");
 		}
-		if(modified)
-			save(mFilename);
 		mOpenItems.erase(itr);
 	}
 };
@@ -903,20 +969,14 @@ void ContactItem::close() {
 		cl->close(this);
 }
 
-// returns 0 on success, error code otherwise.
-static int createContactValue(ContactValue*& v, int field, void* buf, int bufSize,
-	int attributes)
-{
-	int type = pimContactFieldType(field);
+static ContactValue* newContactValue(int field, int type) {
 	switch(type) {
 	case MA_PIM_TYPE_BOOLEAN:
 	case MA_PIM_TYPE_DATE:
 	case MA_PIM_TYPE_INT:
-		v = new TContactValue<int>(type);
-		break;
+		return new TContactValue<int>(type);
 	case MA_PIM_TYPE_STRING:
-		v = new TContactValue<wstring>(type);
-		break;
+		return new TContactValue<wstring>(type);
 	case MA_PIM_TYPE_STRING_ARRAY:
 		{
 			// set mNames here, so setValue() can check for validity.
@@ -933,17 +993,125 @@ static int createContactValue(ContactValue*& v, int field, void* buf, int bufSiz
 			default:
 				DEBIG_PHAT_ERROR;
 			}
-			v = sav;
+			return sav;
 		}
-		break;
 	default:
-		return MA_PIM_ERR_FIELD_UNSUPPORTED;
+		return NULL;
 	}
+}
+
+// returns 0 on success, error code otherwise.
+static int createContactValue(ContactValue*& v, int field, void* buf, int bufSize,
+	int attributes)
+{
+	v = newContactValue(field, pimContactFieldType(field));
+	if(v == NULL)
+		return MA_PIM_ERR_FIELD_UNSUPPORTED;
 	v->setValue(buf, bufSize);
 	v->attr = attributes;
 	return 0;
 }
 
+//******************************************************************************
+// Contact store
+//******************************************************************************
+
+// The contacts are kept in a ContactStore, which is opened by the first
+// maPimListOpen() and shared by all contact lists until the runtime closes.
+// contacts.xml is imported when it's newer than the store,
+// and is written again when the runtime closes, if the contacts have changed.
+static ContactStore sContactStore;
+static string sContactsXml;
+// sContactStore.generation() when contacts.xml was last read or written.
+static int sExportedGeneration = 0;
+
+// returns true if \a a exists and was modified after \a b, or \a b doesn't exist.
+static bool isNewer(const string& a, const string& b) {
+	struct stat sa, sb;
+	if(stat(a.c_str(), &sa) != 0)
+		return false;
+	if(stat(b.c_str(), &sb) != 0)
+		return true;
+	return sa.st_mtime > sb.st_mtime;
+}
+
+static bool importContacts(const string& fn) {
+	LOG("Reading %s...\n", fn.c_str());
+	ContactList cl(gSyscall->mPimListNextHandle, sContactStore);
+	bool res = cl.import(fn);
+	if(!res) {
+		ContactParser::sCL = NULL;
+		SAFE_DELETE(ContactParser::sCI);
+	}
+	return res;
+}
+
+static bool exportContacts(const string& fn) {
+	LOG("Writing %s...\n", fn.c_str());
+	ofstream stream(fn.c_str());
+	stream << "<?xml version=\"1.0\" encoding=\"utf-8\"?>\n";
+	stream << "<contacts>\n";
+	vector<int> ids;
+	sContactStore.ids(ids);
+	ContactRecord record;
+	for(size_t i=0; i<ids.size(); i++) {
+		sContactStore.get(ids[i], record);
+		ContactItem ci(0);
+		ci.fromRecord(record);
+		ci.save(stream);
+	}
+	stream << "</contacts>\n";
+	return stream.good();
+}
+
+static bool openContactStore() {
+	if(sContactStore.isOpen())
+		return true;
+	string mosyncDir = getenv("MOSYNCDIR");
+	string db = mosyncDir + "/etc/contacts.db";
+	sContactsXml = mosyncDir + "/etc/contacts.xml";
+
+	if(!isNewer(sContactsXml, db) && sContactStore.open(db.c_str())) {
+		LOG("Read %i contacts from %s\n", sContactStore.size(), db.c_str());
+		sExportedGeneration = sContactStore.generation();
+		return true;
+	}
+
+	bool res = sContactStore.create(db.c_str()) && importContacts(sContactsXml);
+	if(!res) {
+		// default contacts file
+		res = sContactStore.create(db.c_str()) &&
+			importContacts(mosyncDir + "/bin/default_contacts.xml");
+		if(res) {
+			// save a copy
+			if(exportContacts(sContactsXml))
+				sContactStore.touch();
+			else
+				LOG("Could not write %s\n", sContactsXml.c_str());
+		}
+	}
+	if(!res) {
+		sContactStore.close();
+		remove(db.c_str());
+		return false;
+	}
+	sExportedGeneration = sContactStore.generation();
+	return true;
+}
+
+void closeContactStore() {
+	if(!sContactStore.isOpen())
+		return;
+	if(sContactStore.generation() != sExportedGeneration) {
+		// touch the store, so that it's newer than contacts.xml and not imported again.
+		if(exportContacts(sContactsXml))
+			sContactStore.touch();
+		else
+			LOG("Could not write %s\n", sContactsXml.c_str());
+	}
+	sContactStore.close();
+}
+
 //******************************************************************************
 // Syscalls
 //******************************************************************************
@@ -951,31 +1119,9 @@ static int createContactValue(ContactValue*& v, int field, void* buf, int bufSiz
 MAHandle Syscall::maPimListOpen(int listType) {
 	PimList* pl;
 	if(listType == MA_PIM_CONTACTS) {
-		ContactList* cl = new ContactList(mPimListNextHandle);
-		string mosyncDir = getenv("MOSYNCDIR");
-		string fn = mosyncDir + "/etc/contacts.xml";
-		LOG("Reading %s...\n", fn.c_str());
-		bool res = cl->open(fn);
-		if(!res) {
-			// default contacts file
-			string ofn = mosyncDir + "/bin/default_contacts.xml";
-			LOG("Reading %s...\n", ofn.c_str());
-			res = cl->open(ofn);
-			if(res) {
-				// save a copy
-				res = cl->save(fn);
-				if(!res) {
-					LOG("Could not write %s\n", fn.c_str());
-				}
-			}
-		}
-		if(!res) {
-			delete cl;
-			ContactParser::sCL = NULL;
-			SAFE_DELETE(ContactParser::sCI);
+		if(!openContactStore())
 			return MA_PIM_ERR_LIST_UNAVAILABLE;
-		}
-		pl = cl;
+		pl = new ContactList(mPimListNextHandle, sContactStore);
 	} else {
 		return MA_PIM_ERR_LIST_UNAVAILABLE;
 	}
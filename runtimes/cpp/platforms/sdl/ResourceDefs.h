@@ -19,11 +19,16 @@ limitations under the License.
 #include <SDL/SDL.h>
 #include "Stream.h"
 
+namespace Base {
+	// SDL_FreeSurface(), and the atlas that the surface may be a part of.
+	void freeImage(SDL_Surface* surf);
+}
+
 #define TYPES(m)\
 	m(RT_BINARY, Base::Stream, delete)\
 	m(RT_PLACEHOLDER, void, NULA)\
 	m(RT_LABEL, Label, delete) \
-	m(RT_IMAGE, SDL_Surface, SDL_FreeSurface)\
+	m(RT_IMAGE, SDL_Surface, Base::freeImage)\
 	m(RT_FLUX, void, NULA)\
 
 #endif // _RESOURCE_DEFS_H_
@@ -48,6 +48,9 @@ limitations under the License.
 #include <map>
 #include <time.h>
 #include <limits.h>
+#ifdef DARWIN
+#include <mach/mach_time.h>
+#endif
 
 
 #include <helpers/fifo.h>
@@ -87,6 +90,7 @@ extern "C" {
 #include "ConfigParser.h"
 #include "sdl_stream.h"
 #include "MoSyncDB.h"
+#include "TileMap.h"
 
 #include "Skinning/Screen.h"
 #include "Skinning/SkinManager.h"
@@ -132,6 +136,12 @@ namespace Base {
 	static CircularFifo<MAEvent, EVENT_BUFFER_SIZE> gEventFifo;
 	static bool gEventOverflow = false, gClosing = false;
 
+	static HashMap<TileMap> gTileMaps;
+	static int gTileMapNextHandle = 1;
+
+	// atlas images and the atlas surfaces that own their pixels.
+	static std::map<SDL_Surface*, SDL_Surface*> gAtlasPages;
+
 	static SDL_TimerID gTimerId = NULL;
 	static int gTimerSequence;
 	static SDL_mutex* gTimerMutex = NULL;
@@ -236,8 +246,10 @@ namespace Base {
 	void Syscall::platformDestruct() {
 #ifdef EMULATOR
 		gSyscall->pimClose();
+		closeContactStore();
 #endif
 		MoSyncDBClose();
+		gTileMaps.close();
 	}
 
 	//***************************************************************************
@@ -582,6 +594,80 @@ namespace Base {
 		return surf;
 	}
 
+	// Decodes the next image of an atlas and draws it into \a page.
+	bool Syscall::loadAtlasPageImage(Stream& file, SDL_Surface* page) {
+		DAR_USHORT(x);
+		DAR_USHORT(y);
+		DAR_UVINT(len);
+		// don't allocate more than the file could hold.
+		int pos, fileLen;
+		TEST(file.tell(pos));
+		TEST(file.length(fileLen));
+		TEST(len >= 0 && len <= fileLen - pos);
+		MemStream b(len);
+		TEST(file.readFully(b));
+		SDL_Surface* img = loadImage(b);
+		TEST(img);
+		// copy the alpha channel, rather than blending with it.
+		SDL_SetAlpha(img, 0, 0);
+		SDL_Rect dst = { (Sint16)x, (Sint16)y, 0, 0 };
+		SDL_BlitSurface(img, NULL, page, &dst);
+		SDL_FreeSurface(img);
+		return true;
+	}
+
+	// Decodes the images of an atlas and composes them into one surface.
+	SDL_Surface* Syscall::loadAtlasPage(Stream& file) {
+		DAR_USHORT(width);
+		DAR_USHORT(height);
+		DAR_USHORT(count);
+		SDL_Surface* page = SDL_CreateRGBSurface(SDL_SWSURFACE, width, height, 32,
+			0x00ff0000, 0x0000ff00, 0x000000ff, 0xff000000);
+		if(!page)
+			return NULL;
+		SDL_FillRect(page, NULL, 0);
+		for(int i = 0; i < count; i++) {
+			if(!loadAtlasPageImage(file, page)) {
+				SDL_FreeSurface(page);
+				return NULL;
+			}
+		}
+		SDL_Surface* surf = SDL_DisplayFormatAlpha(page);
+		SDL_FreeSurface(page);
+		return surf;
+	}
+
+	// Returns a surface that shares its pixels with a part of the atlas.
+	// The atlas surface is kept alive until all of its images are freed.
+	// Drawing into the returned surface also draws into the atlas.
+	SDL_Surface* Syscall::loadAtlasImage(SDL_Surface* atlas, ushort left, ushort top,
+		ushort width, ushort height)
+	{
+		if(left + width > atlas->w || top + height > atlas->h)
+			return NULL;
+		SDL_PixelFormat* f = atlas->format;
+		Uint8* pixels = (Uint8*)atlas->pixels + top * atlas->pitch + left * f->BytesPerPixel;
+		SDL_Surface* surf = SDL_CreateRGBSurfaceFrom(pixels, width, height,
+			f->BitsPerPixel, atlas->pitch, f->Rmask, f->Gmask, f->Bmask, f->Amask);
+		if(!surf)
+			return NULL;
+		if(atlas->flags & SDL_SRCALPHA)
+			SDL_SetAlpha(surf, SDL_SRCALPHA, f->alpha);
+		atlas->refcount++;
+		gAtlasPages[surf] = atlas;
+		return surf;
+	}
+
+	void freeImage(SDL_Surface* surf) {
+		std::map<SDL_Surface*, SDL_Surface*>::iterator itr = gAtlasPages.find(surf);
+		SDL_FreeSurface(surf);
+		if(itr != gAtlasPages.end()) {
+			// drops the reference taken by loadAtlasImage().
+			SDL_FreeSurface(itr->second);
+			gAtlasPages.erase(itr);
+		}
+	}
+
 	//***************************************************************************
 	// SDL Streams
 	//***************************************************************************
@@ -1257,13 +1343,19 @@ namespace Base {
 		SDL_FreeSurface(srcSurface);
 	}
 
+	static void drawImageRegion(SDL_Surface* surf, const MARect* src, const MAPoint2d* dstTopLeft, int transformMode);
+
 	SYSCALL(void, maDrawImageRegion(MAHandle image, const MARect* src, const MAPoint2d* dstTopLeft, int transformMode)) {
 		//LOG("Entering DrawImageRegion start\n");
 
 		SDL_Surface* surf = gSyscall->resources.get_RT_IMAGE(image);
 		gSyscall->ValidateMemRange(src, sizeof(MARect));
 		gSyscall->ValidateMemRange(dstTopLeft, sizeof(MAPoint2d));
+		drawImageRegion(surf, src, dstTopLeft, transformMode);
+	}
 
+	// shared by maDrawImageRegion() and maSpriteBatchDraw(); the arguments are already validated.
+	static void drawImageRegion(SDL_Surface* surf, const MARect* src, const MAPoint2d* dstTopLeft, int transformMode) {
 		unsigned int* srcPixels = (unsigned int*) surf->pixels;
 		unsigned int* destPixels = (unsigned int*) gDrawSurface->pixels;
 		int dstPitchY = gDrawSurface->pitch>>2;
@@ -1710,33 +1802,19 @@ namespace Base {
 	SYSCALL(int, maSoundPlay(MAHandle sound_res, int offset, int size)) {
 		int chan = 0;
 		Stream *src = gSyscall->resources.get_RT_BINARY(sound_res);
-		MYASSERT(src->seek(Seek::Start, offset), ERR_DATA_ACCESS_FAILED);
-
-		//read the MIME type
-		char mime[1024];
-		size_t i=0;
-		byte b;
-		do {
-			if(!src->readByte(b) || i >= sizeof(mime)) {
-				BIG_PHAT_ERROR(ERR_MIME_READ_FAILED);
-			}
-			mime[i++] = b;
-		} while(b);
-
-		int pos;
-		src->tell(pos);
-		int encodedSize = size - pos + offset;
-		LOGA("encodedSize: %i\n", encodedSize);
-		Stream* copy = src->createLimitedCopy(encodedSize);
 
+		// the audio thread must be done with the old source first.
 		AudioChannel *chnl = AudioEngine::getChannel(chan);
+		SDL_LockAudio();
 		AudioSource *audioSource = chnl->getAudioSource();
+		chnl->setAudioSource(NULL);
+		SDL_UnlockAudio();
 		if(audioSource!=NULL) {
 			audioSource->close();
 			delete audioSource;
 		}
 
-		audioSource = AudioEngine::getAudioSource(mime, copy);
+		audioSource = AudioEngine::getSoundSource(sound_res, src, offset, size);
 		MYASSERT(audioSource, SDLERR_SOUND_LOAD_FAILED);
 
 		chnl->setAudioSource(audioSource);
@@ -1846,6 +1924,230 @@ namespace Base {
 	}
 
 
+	//***************************************************************************
+	// Tile maps
+	//***************************************************************************
+
+	// keeps each copy of a layer's tiles at 8 MiB or less.
+	#define TILEMAP_MAX_LAYER_TILES (2048 * 2048)
+
+	static int maTileMapCreate(MAHandle tileSet, int tileWidth, int tileHeight) {
+		// panics if the handle is not an image, like the drawing syscalls do.
+		gSyscall->resources.get_RT_IMAGE(tileSet);
+		if(tileWidth == 0 && tileHeight == 0) {
+			MAExtent size = gSyscall->getTileSetSize(tileSet);
+			tileWidth = EXTENT_X(size);
+			tileHeight = EXTENT_Y(size);
+		}
+		if(tileWidth <= 0 || tileHeight <= 0 ||
+			tileWidth > TileMap::MAX_TILE_SIZE || tileHeight > TileMap::MAX_TILE_SIZE)
+			return MA_TILEMAP_RES_INVALID_DATA;
+		int handle = gTileMapNextHandle++;
+		gTileMaps.insert(handle, new TileMap(tileSet, tileWidth, tileHeight));
+		return handle;
+	}
+
+	static int maTileMapAddLayer(MAHandle tileMap, MAHandle mapData, int parallaxX, int parallaxY) {
+		TileMap* tm = gTileMaps.find(tileMap);
+		if(!tm)
+			return MA_TILEMAP_RES_INVALID_HANDLE;
+		Stream* b = gSyscall->resources.get_RT_BINARY(mapData);
+
+		// little-endian width, height and tiles.
+		int len;
+		byte header[4];
+		if(!b->length(len) || len < 4 || !b->seek(Seek::Start, 0) || !b->read(header, 4))
+			return MA_TILEMAP_RES_INVALID_DATA;
+		int width = header[0] | (header[1] << 8);
+		int height = header[2] | (header[3] << 8);
+		// both are 16-bit, so the product can't overflow in 64 bits.
+		long long numTiles = (long long)width * height;
+		if(numTiles > TILEMAP_MAX_LAYER_TILES || len - 4 < numTiles * 2)
+			return MA_TILEMAP_RES_INVALID_DATA;
+		std::vector<byte> raw(width * height * 2);
+		std::vector<unsigned short> tiles(width * height);
+		if(!raw.empty() && !b->read(&raw[0], (int)raw.size()))
+			return MA_TILEMAP_RES_INVALID_DATA;
+		for(size_t i = 0; i < tiles.size(); i++) {
+			tiles[i] = raw[i * 2] | (raw[i * 2 + 1] << 8);
+		}
+		return tm->addLayer(width, height, tiles.empty() ? NULL : &tiles[0], parallaxX, parallaxY);
+	}
+
+	static int checkTileMapPosition(TileMap* tm, int layer, int x, int y) {
+		if(!tm)
+			return MA_TILEMAP_RES_INVALID_HANDLE;
+		if(layer < 0 || layer >= tm->numLayers())
+			return MA_TILEMAP_RES_INVALID_LAYER;
+		if(!tm->isInside(layer, x, y))
+			return MA_TILEMAP_RES_OUT_OF_BOUNDS;
+		return MA_TILEMAP_RES_OK;
+	}
+
+	static int maTileMapSetTile(MAHandle tileMap, int layer, int x, int y, int tile) {
+		TileMap* tm = gTileMaps.find(tileMap);
+		int res = checkTileMapPosition(tm, layer, x, y);
+		if(res < 0)
+			return res;
+		if(tile < 0 || tile > 0xffff)
+			return MA_TILEMAP_RES_INVALID_DATA;
+		tm->setTile(layer, x, y, tile);
+		return MA_TILEMAP_RES_OK;
+	}
+
+	static int maTileMapGetTile(MAHandle tileMap, int layer, int x, int y) {
+		TileMap* tm = gTileMaps.find(tileMap);
+		int res = checkTileMapPosition(tm, layer, x, y);
+		if(res < 0)
+			return res;
+		return tm->getTile(layer, x, y);
+	}
+
+	static int maTileMapDraw(MAHandle tileMap, const MARect* dst, int scrollX, int scrollY) {
+		TileMap* tm = gTileMaps.find(tileMap);
+		if(!tm)
+			return MA_TILEMAP_RES_INVALID_HANDLE;
+		SDL_Surface* tileSet = gSyscall->resources.get_RT_IMAGE(tm->tileSet());
+		tm->draw(tileSet, gDrawSurface, dst->left, dst->top, MAX(0, dst->width),
+			MAX(0, dst->height), scrollX, scrollY);
+		return MA_TILEMAP_RES_OK;
+	}
+
+	static int maTileMapDestroy(MAHandle tileMap) {
+		if(!gTileMaps.find(tileMap))
+			return MA_TILEMAP_RES_INVALID_HANDLE;
+		gTileMaps.erase(tileMap);
+		return MA_TILEMAP_RES_OK;
+	}
+
+	// Defined in core/extensions.cpp for MoRE, where the VM memory is known,
+	// and in mosynclib/main.cpp.
+	int extensionFunctionInvokeV(int function, void* blocks, int stride, int count);
+
+	// The blocks are declared as input, but the results are written back into them.
+	static int maExtensionFunctionInvokeV(int fn, const void* blocks, int stride, int count) {
+		return extensionFunctionInvokeV(fn, (void*)blocks, stride, count);
+	}
+
+	// Defined in core/Core.cpp for MoRE, which owns the data segment,
+	// and in mosynclib/main.cpp.
+	int heapGrow(int size);
+	int heapRelease(void* ptr, int size);
+
+	static int maHeapGrow(int size) {
+		return heapGrow(size);
+	}
+
+	static int maGetMicroSecondCount() {
+#ifdef WIN32
+		static LARGE_INTEGER sFrequency = { 0 };
+		if(sFrequency.QuadPart == 0)
+			QueryPerformanceFrequency(&sFrequency);
+		LARGE_INTEGER count;
+		QueryPerformanceCounter(&count);
+		// Split the division, so that the multiplication doesn't overflow.
+		int us = (int)((count.QuadPart / sFrequency.QuadPart) * 1000000 +
+			((count.QuadPart % sFrequency.QuadPart) * 1000000) / sFrequency.QuadPart);
+#elif defined(DARWIN)
+		static mach_timebase_info_data_t sTimebase = { 0, 0 };
+		if(sTimebase.denom == 0)
+			mach_timebase_info(&sTimebase);
+		int us = (int)(mach_absolute_time() * sTimebase.numer / sTimebase.denom / 1000);
+#else
+		// monotonic, so that setting the system clock doesn't make it jump.
+		struct timespec ts;
+		clock_gettime(CLOCK_MONOTONIC, &ts);
+		int us = (int)((long long)ts.tv_sec * 1000000 + ts.tv_nsec / 1000);
+#endif
+		// -1 tells the caller that the ioctl is unavailable.
+		return us == IOCTL_UNAVAILABLE ? 0 : us;
+	}
+
+	static double maMathPow(double x, double y) { return ::pow(x, y); }
+	static double maMathLog(double x) { return ::log(x); }
+	static double maMathAtan2(double y, double x) { return ::atan2(y, x); }
+	static float maMathSinf(float x) { return ::sinf(x); }
+	static float maMathCosf(float x) { return ::cosf(x); }
+	static float maMathSqrtf(float x) { return ::sqrtf(x); }
+	static float maMathPowf(float x, float y) { return ::powf(x, y); }
+	static float maMathLogf(float x) { return ::logf(x); }
+	static float maMathAtan2f(float y, float x) { return ::atan2f(y, x); }
+
+	// The loops are written once for both precisions, so that each
+	// function switch is done once per array rather than once per element.
+	template<class T> static int mathEvaluate(int func, const T* src, T* dst, int count) {
+		switch(func) {
+		case MA_MATH_FUNC_SIN:
+			for(int i=0; i<count; i++)
+				dst[i] = (T)::sin(src[i]);
+			break;
+		case MA_MATH_FUNC_COS:
+			for(int i=0; i<count; i++)
+				dst[i] = (T)::cos(src[i]);
+			break;
+		case MA_MATH_FUNC_SQRT:
+			for(int i=0; i<count; i++)
+				dst[i] = (T)::sqrt(src[i]);
+			break;
+		case MA_MATH_FUNC_LOG:
+			for(int i=0; i<count; i++)
+				dst[i] = (T)::log(src[i]);
+			break;
+		default:
+			return -1;
+		}
+		return count;
+	}
+
+	// GetValidatedMemRange() returns NULL for address 0 without looking at
+	// the size, so the element count is checked here as well.
+	static void validateMathArrays(const void* src, const void* dst, int count) {
+		MYASSERT(count >= 0, ERR_MEMORY_OOB);
+		if(count > 0) {
+			MYASSERT(src && dst, ERR_MEMORY_NULL);
+		}
+	}
+
+	static int maSpriteBatchDraw(MAHandle image, const void* entries, int count) {
+		MYASSERT(count >= 0, ERR_MEMORY_OOB);
+		if(count > 0) {
+			MYASSERT(entries, ERR_MEMORY_NULL);
+		}
+		SDL_Surface* surf = gSyscall->resources.get_RT_IMAGE(image);
+		const MASpriteBatchEntry* e = (const MASpriteBatchEntry*)entries;
+		for(int i=0; i<count; i++, e++) {
+			MARect src = { e->srcLeft, e->srcTop, e->width, e->height };
+			MAPoint2d dst = { e->dstLeft, e->dstTop };
+			drawImageRegion(surf, &src, &dst, e->transformMode);
+		}
+		return count;
+	}
+
+	static int maMathEvaluate(int func, const void* src, void* dst, int count) {
+		validateMathArrays(src, dst, count);
+		return mathEvaluate(func, (const double*)src, (double*)dst, count);
+	}
+
+	static int maMathEvaluatef(int func, const void* src, void* dst, int count) {
+		validateMathArrays(src, dst, count);
+		return mathEvaluate(func, (const float*)src, (float*)dst, count);
+	}
+
+	static int maMathTransformPointsf(const void* matrix, const void* src, void* dst, int count) {
+		validateMathArrays(src, dst, count);
+		MYASSERT(matrix, ERR_MEMORY_NULL);
+		const float* m = (const float*)matrix;
+		const float* s = (const float*)src;
+		float* d = (float*)dst;
+		for(int i=0; i<count; i++, s+=3, d+=3) {
+			float x = s[0], y = s[1], z = s[2];
+			d[0] = m[0]*x + m[1]*y + m[2]*z + m[3];
+			d[1] = m[4]*x + m[5]*y + m[6]*z + m[7];
+			d[2] = m[8]*x + m[9]*y + m[10]*z + m[11];
+		}
+		return count;
+	}
+
 #ifdef MA_PROF_SUPPORT_VIDEO_STREAMING
 	RtspConnection *rtspConnection;
 	SYSCALL(int, maStreamVideoStart(const char* url)) {
@@ -2188,11 +2490,25 @@ namespace Base {
 
 			maIOCtl_syscall_case(maFileTell);
 			maIOCtl_syscall_case(maFileSeek);
+		case maIOCtl_maFileReadAt:
+			return SYSCALL_THIS->maFileReadAt(a, SYSCALL_THIS->GetValidatedMemRange(b, c), c,
+				SYSCALL_THIS->GetValidatedStackValue(0 VSV_ARGPTR_USE));
+		case maIOCtl_maFileWriteAt:
+			return SYSCALL_THIS->maFileWriteAt(a, SYSCALL_THIS->GetValidatedMemRange(b, c), c,
+				SYSCALL_THIS->GetValidatedStackValue(0 VSV_ARGPTR_USE));
+		case maIOCtl_maFileAppend:
+			return SYSCALL_THIS->maFileAppend(a, SYSCALL_THIS->GetValidatedMemRange(b, c), c);
+		case maIOCtl_maFileReadSome:
+			return SYSCALL_THIS->maFileReadSome(a, SYSCALL_THIS->GetValidatedMemRange(b, c), c);
 
 			maIOCtl_syscall_case(maFileListStart);
 		case maIOCtl_maFileListNext:
 			return SYSCALL_THIS->maFileListNext(a, (char*)SYSCALL_THIS->GetValidatedMemRange(b, c), c);
 			maIOCtl_syscall_case(maFileListClose);
+			maIOCtl_syscall_case(maFileListStartRecursive);
+		case maIOCtl_maFileListNextBatch:
+			return SYSCALL_THIS->maFileListNextBatch(a, SYSCALL_THIS->GetValidatedMemRange(b, c), c,
+				SYSCALL_THIS->GetValidatedStackValue(0 VSV_ARGPTR_USE));
 
 			maIOCtl_case(maCameraFormatNumber);
 			maIOCtl_case(maCameraFormat);
@@ -2210,6 +2526,32 @@ namespace Base {
 			maIOCtl_case(maDBCursorGetColumnText);
 			maIOCtl_case(maDBCursorGetColumnInt);
 			maIOCtl_case(maDBCursorGetColumnDouble);
+
+			maIOCtl_case(maTileMapCreate);
+			maIOCtl_case(maTileMapAddLayer);
+			maIOCtl_case(maTileMapSetTile);
+			maIOCtl_case(maTileMapGetTile);
+			maIOCtl_case(maTileMapDraw);
+			maIOCtl_case(maTileMapDestroy);
+			maIOCtl_case(maSpriteBatchDraw);
+
+			maIOCtl_case(maMathPow);
+			maIOCtl_case(maMathLog);
+			maIOCtl_case(maMathAtan2);
+			maIOCtl_case(maMathSinf);
+			maIOCtl_case(maMathCosf);
+			maIOCtl_case(maMathSqrtf);
+			maIOCtl_case(maMathPowf);
+			maIOCtl_case(maMathLogf);
+			maIOCtl_case(maMathAtan2f);
+			maIOCtl_case(maMathEvaluate);
+			maIOCtl_case(maMathEvaluatef);
+			maIOCtl_case(maMathTransformPointsf);
+			maIOCtl_case(maExtensionFunctionInvokeV);
+			maIOCtl_case(maGetMicroSecondCount);
+			maIOCtl_case(maHeapGrow);
+		case maIOCtl_maHeapRelease:
+			return heapRelease(SYSCALL_THIS->GetValidatedMemRange(a, b), b);
 #ifdef EMULATOR
 		maIOCtl_syscall_case(maPimListOpen);
 		maIOCtl_syscall_case(maPimListNext);
@@ -21,6 +21,10 @@ public:
 SDL_Surface* loadImage(MemStream& s);
 SDL_Surface* loadSprite(SDL_Surface* surface, ushort left, ushort top,
 	ushort width, ushort height, ushort cx, ushort cy);
+SDL_Surface* loadAtlasPage(Stream& file);
+bool loadAtlasPageImage(Stream& file, SDL_Surface* page);
+SDL_Surface* loadAtlasImage(SDL_Surface* atlas, ushort left, ushort top,
+	ushort width, ushort height);
 
 public:
 		struct STARTUP_SETTINGS {
@@ -0,0 +1,206 @@
+/* Copyright 2013 David Axmark
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+	http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "config_platform.h"
+
+#include <helpers/helpers.h>
+
+#include <limits.h>
+
+#include "TileMap.h"
+
+namespace Base {
+
+TileMap::TileMap(int tileSet, int tileWidth, int tileHeight)
+	: mTileSet(tileSet), mTileWidth(tileWidth), mTileHeight(tileHeight), mCachedTileSet(NULL)
+{
+}
+
+TileMap::~TileMap() {
+	flushChunks();
+	for(size_t i = 0; i < mLayers.size(); i++) {
+		delete mLayers[i];
+	}
+}
+
+int TileMap::addLayer(int width, int height, const unsigned short* tiles,
+	int parallaxX, int parallaxY)
+{
+	Layer* l = new Layer;
+	l->width = width;
+	l->height = height;
+	l->chunksX = (width + CHUNK_TILES - 1) / CHUNK_TILES;
+	l->chunksY = (height + CHUNK_TILES - 1) / CHUNK_TILES;
+	l->parallaxX = parallaxX;
+	l->parallaxY = parallaxY;
+	l->tiles.assign(tiles, tiles + width * height);
+	l->chunks.resize(l->chunksX * l->chunksY, NULL);
+	mLayers.push_back(l);
+	return (int)mLayers.size() - 1;
+}
+
+bool TileMap::isInside(int layer, int x, int y) const {
+	const Layer* l = mLayers[layer];
+	return x >= 0 && y >= 0 && x < l->width && y < l->height;
+}
+
+bool TileMap::setTile(int layer, int x, int y, int tile) {
+	if(layer < 0 || layer >= numLayers() || !isInside(layer, x, y))
+		return false;
+	Layer& l = *mLayers[layer];
+	unsigned short& t = l.tiles[x + y * l.width];
+	if(t == tile)
+		return true;
+	t = (unsigned short)tile;
+
+	// only the chunk holding this tile needs to be redrawn.
+	SDL_Surface*& chunk = l.chunks[x / CHUNK_TILES + (y / CHUNK_TILES) * l.chunksX];
+	if(chunk) {
+		SDL_FreeSurface(chunk);
+		chunk = NULL;
+	}
+	return true;
+}
+
+int TileMap::getTile(int layer, int x, int y) const {
+	const Layer& l = *mLayers[layer];
+	return l.tiles[x + y * l.width];
+}
+
+void TileMap::flushChunks() {
+	for(size_t i = 0; i < mLayers.size(); i++) {
+		std::vector<SDL_Surface*>& chunks = mLayers[i]->chunks;
+		for(size_t j = 0; j < chunks.size(); j++) {
+			if(chunks[j]) {
+				SDL_FreeSurface(chunks[j]);
+				chunks[j] = NULL;
+			}
+		}
+	}
+}
+
+SDL_Surface* TileMap::renderChunk(Layer& layer, int cx, int cy, SDL_Surface* tileSet) {
+	int tx0 = cx * CHUNK_TILES, ty0 = cy * CHUNK_TILES;
+	int tw = MIN((int)CHUNK_TILES, layer.width - tx0);
+	int th = MIN((int)CHUNK_TILES, layer.height - ty0);
+
+	SDL_Surface* chunk = SDL_CreateRGBSurface(SDL_SWSURFACE|SDL_SRCALPHA,
+		tw * mTileWidth, th * mTileHeight, 32,
+		0x00ff0000, 0x0000ff00, 0x000000ff, 0xff000000);
+	if(!chunk)
+		return NULL;
+	SDL_FillRect(chunk, NULL, 0);
+
+	// copy the tiles' alpha as-is; it is applied when the chunk is drawn.
+	bool srcAlpha = (tileSet->flags & SDL_SRCALPHA) != 0;
+	Uint8 alpha = tileSet->format->alpha;
+	if(srcAlpha)
+		SDL_SetAlpha(tileSet, 0, 0);
+
+	int tilesPerRow = tileSet->w / mTileWidth;
+	int numTiles = tilesPerRow * (tileSet->h / mTileHeight);
+	for(int y = 0; y < th; y++) {
+		const unsigned short* row = &layer.tiles[tx0 + (ty0 + y) * layer.width];
+		for(int x = 0; x < tw; x++) {
+			int t = row[x];
+			if(t == 0 || t > numTiles)
+				continue;
+			t--;
+			// tiles that SDL can't address in a very large tile set are left empty.
+			// the size is checked by maTileMapCreate(), so dst always fits.
+			int sx = (t % tilesPerRow) * mTileWidth;
+			int sy = (t / tilesPerRow) * mTileHeight;
+			if(sx > SHRT_MAX || sy > SHRT_MAX)
+				continue;
+			SDL_Rect src = { (Sint16)sx, (Sint16)sy, (Uint16)mTileWidth, (Uint16)mTileHeight };
+			SDL_Rect dst = { (Sint16)(x * mTileWidth), (Sint16)(y * mTileHeight), 0, 0 };
+			SDL_BlitSurface(tileSet, &src, chunk, &dst);
+		}
+	}
+
+	if(srcAlpha)
+		SDL_SetAlpha(tileSet, SDL_SRCALPHA, alpha);
+	return chunk;
+}
+
+void TileMap::drawLayer(Layer& l, SDL_Surface* tileSet, SDL_Surface* dst,
+	const SDL_Rect& clip, long long originX, long long originY)
+{
+	int chunkW = CHUNK_TILES * mTileWidth;
+	int chunkH = CHUNK_TILES * mTileHeight;
+
+	// the range of chunks that intersect the clip rect.
+	// the origin may be far outside the surface, so this is done in 64 bits.
+	long long left = clip.x - originX, top = clip.y - originY;
+	long long right = left + clip.w - 1, bottom = top + clip.h - 1;
+	if(right < 0 || bottom < 0)
+		return;
+	int cx0 = (int)MAX(0LL, left / chunkW), cy0 = (int)MAX(0LL, top / chunkH);
+	int cx1 = (int)MIN((long long)l.chunksX - 1, right / chunkW);
+	int cy1 = (int)MIN((long long)l.chunksY - 1, bottom / chunkH);
+
+	for(int cy = cy0; cy <= cy1; cy++) {
+		for(int cx = cx0; cx <= cx1; cx++) {
+			SDL_Surface*& chunk = l.chunks[cx + cy * l.chunksX];
+			if(!chunk) {
+				chunk = renderChunk(l, cx, cy, tileSet);
+				if(!chunk)
+					continue;
+			}
+			// the clip rect lies within the surface, so a chunk that intersects it
+			// starts within SDL's range; skip it anyway rather than wrap around.
+			long long x = originX + (long long)cx * chunkW;
+			long long y = originY + (long long)cy * chunkH;
+			if(x < SHRT_MIN || x > SHRT_MAX || y < SHRT_MIN || y > SHRT_MAX)
+				continue;
+			SDL_Rect r = { (Sint16)x, (Sint16)y, 0, 0 };
+			SDL_BlitSurface(chunk, NULL, dst, &r);
+		}
+	}
+}
+
+void TileMap::draw(SDL_Surface* tileSet, SDL_Surface* dst, int x, int y, int w, int h,
+	int scrollX, int scrollY)
+{
+	if(tileSet != mCachedTileSet) {
+		flushChunks();
+		mCachedTileSet = tileSet;
+	}
+
+	// draw within both the area and the current clip rect.
+	// the result lies within the clip rect, so it fits in an SDL_Rect.
+	SDL_Rect oldClip = dst->clip_rect;
+	long long left = MAX((long long)x, (long long)oldClip.x);
+	long long top = MAX((long long)y, (long long)oldClip.y);
+	long long right = MIN((long long)x + w, (long long)oldClip.x + oldClip.w);
+	long long bottom = MIN((long long)y + h, (long long)oldClip.y + oldClip.h);
+	if(right <= left || bottom <= top)
+		return;
+	SDL_Rect clip = { (Sint16)left, (Sint16)top, (Uint16)(right - left), (Uint16)(bottom - top) };
+	SDL_SetClipRect(dst, &clip);
+	// SDL_SetClipRect also clips against the surface bounds.
+	clip = dst->clip_rect;
+
+	for(size_t i = 0; i < mLayers.size(); i++) {
+		Layer& l = *mLayers[i];
+		long long offsetX = ((long long)scrollX * l.parallaxX) >> 16;
+		long long offsetY = ((long long)scrollY * l.parallaxY) >> 16;
+		drawLayer(l, tileSet, dst, clip, x - offsetX, y - offsetY);
+	}
+
+	dst->clip_rect = oldClip;
+}
+
+}
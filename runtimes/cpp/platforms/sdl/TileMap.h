@@ -0,0 +1,86 @@
+/* Copyright 2013 David Axmark
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+	http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef TILEMAP_H
+#define TILEMAP_H
+
+#include <SDL/SDL.h>
+#include <vector>
+
+namespace Base {
+
+/**
+* The runtime side of maTileMapCreate().
+*
+* Each layer is divided into chunks of CHUNK_TILES x CHUNK_TILES tiles.
+* A chunk is pre-rendered into a surface the first time it becomes visible,
+* and drawing a layer is then one blit per visible chunk instead of one
+* per visible tile. Editing a tile only invalidates the chunk containing it.
+*/
+class TileMap {
+public:
+	enum { CHUNK_TILES = 16 };
+	/// The largest tile width or height; a chunk must fit in SDL's 16-bit coordinates.
+	enum { MAX_TILE_SIZE = 0x7fff / CHUNK_TILES };
+
+	/// \a tileSet is the image handle that the tiles are drawn from.
+	/// The tile size must be in the range 1 to MAX_TILE_SIZE.
+	TileMap(int tileSet, int tileWidth, int tileHeight);
+	~TileMap();
+
+	int tileSet() const { return mTileSet; }
+
+	/// Takes a copy of \a tiles, which must hold width*height entries.
+	/// Returns the index of the new layer.
+	int addLayer(int width, int height, const unsigned short* tiles, int parallaxX, int parallaxY);
+
+	/// Returns false if the layer or position is invalid.
+	bool setTile(int layer, int x, int y, int tile);
+	int getTile(int layer, int x, int y) const;
+
+	int numLayers() const { return (int)mLayers.size(); }
+	bool isInside(int layer, int x, int y) const;
+
+	/// Draws all layers into \a dst, within the area at (\a x, \a y) of size
+	/// \a w x \a h and the surface's clip rect.
+	/// The area is not limited to SDL's 16-bit coordinates.
+	void draw(SDL_Surface* tileSet, SDL_Surface* dst, int x, int y, int w, int h,
+		int scrollX, int scrollY);
+
+private:
+	struct Layer {
+		int width, height;
+		int chunksX, chunksY;
+		int parallaxX, parallaxY;
+		std::vector<unsigned short> tiles;
+		std::vector<SDL_Surface*> chunks;	// NULL until rendered.
+	};
+
+	void drawLayer(Layer& layer, SDL_Surface* tileSet, SDL_Surface* dst,
+		const SDL_Rect& clip, long long originX, long long originY);
+	SDL_Surface* renderChunk(Layer& layer, int cx, int cy, SDL_Surface* tileSet);
+	void flushChunks();
+
+	int mTileSet;
+	int mTileWidth, mTileHeight;
+	std::vector<Layer*> mLayers;
+	// the surface that the cached chunks were rendered from.
+	// if the tile set image is replaced, all chunks are redrawn.
+	SDL_Surface* mCachedTileSet;
+};
+
+}
+
+#endif	//TILEMAP_H
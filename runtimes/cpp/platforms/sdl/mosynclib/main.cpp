@@ -161,6 +161,18 @@ SYSCALL(longlong, maExtensionFunctionInvoke(int function, int a, int b, int c))
 	return -1;
 }
 
+int extensionFunctionInvokeV(int function, void* blocks, int stride, int count) {
+	return IOCTL_UNAVAILABLE;
+}
+
+int heapGrow(int size) {
+	return IOCTL_UNAVAILABLE;
+}
+
+int heapRelease(void* ptr, int size) {
+	return IOCTL_UNAVAILABLE;
+}
+
 void MoSyncError::addRuntimeSpecificPanicInfo(char* ptr, bool newLines) {
 }
 
@@ -45,6 +45,11 @@ void MANetworkInit();
 void MANetworkReset();
 void MANetworkClose();
 
+#ifdef EMULATOR
+// from PIMImpl.cpp. writes contacts.xml if the contacts have changed.
+void closeContactStore();
+#endif
+
 #define NUMBER_KEYS(m) m(0) m(1) m(2) m(3) m(4)	m(5) m(6) m(7) m(8) m(9)
 #define DIRECT_KEYS(m) m(LEFT) m(RIGHT) m(UP) m(DOWN) NUMBER_KEYS(m)
 #define MULTI_KEYS(mac) mac(FIRE, RCTRL) mac(FIRE, LCTRL)\
@@ -27,7 +27,7 @@ work.instance_eval do
 			@EXTRA_CPPFLAGS += " -D__USE_FULLSCREEN__ -D__USE_SYSTEM_RESOLUTION__"
 		end
 		if(NATIVE_RUNTIME == "true")
-			@IGNORED_FILES += ["PIMImpl.cpp", "pim.cpp"]
+			@IGNORED_FILES += ["PIMImpl.cpp", "ContactStore.cpp", "pim.cpp"]
 		end
 		@EXTRA_INCLUDES = common_includes
 		@EXTRA_CPPFLAGS += ' ' + open('|pkg-config --cflags gtk+-2.0').read.strip
@@ -86,6 +86,12 @@ namespace Base {
 		TEST_SYMBIAN(mFile.Read(des));
 		return des.Length() == des.MaxLength();
 	}
+	bool FileStream::readAt(void* dst, int size, int offset) {
+		TEST(isOpen());
+		TPtr8 des((byte*)dst, size);
+		TEST_SYMBIAN(mFile.Read(offset, des));
+		return des.Length() == des.MaxLength();
+	}
 	bool FileStream::length(int& aLength) const {
 		TEST(isOpen());
 		TEST_SYMBIAN(mFile.Size(aLength));
@@ -109,6 +115,10 @@ namespace Base {
 		TEST_SYMBIAN(mFile.Seek(ESeekCurrent, aPos));
 		return true;
 	}
+	bool FileStream::discardBuffer() {
+		// RFile reads aren't buffered here.
+		return true;
+	}
 	bool FileStream::mTime(time_t& t) const {
 		// TODO
 		FAIL;
@@ -118,7 +128,7 @@ namespace Base {
 	//LimitedFileStream
 	//******************************************************************************
 	LimitedFileStream::LimitedFileStream(const char* filename, int offset, int len)
-		: FileStream(filename), mStartPos(offset), mEndPos(offset + len)
+		: FileStream(filename), mStartPos(offset), mEndPos(offset + len), mPos(0), mWindow(NULL)
 	{
 		if(!_open()) {
 			mOpenResult = KErrGeneral;
@@ -138,6 +148,12 @@ namespace Base {
 		TEST_SYMBIAN(mFile.Write(desc));
 		return true;
 	}
+	bool WriteFileStream::writeAt(const void* src, int size, int offset) {
+		TEST(isOpen());
+		TPtrC8 desc(CBP src, size);
+		TEST_SYMBIAN(mFile.Write(offset, desc));
+		return true;
+	}
 	bool WriteFileStream::truncate(int size) {
 		// TODO
 		FAIL;
@@ -48,6 +48,16 @@ namespace Base {
 		int res = fread(dst, 1, size, file);
 		return res == size;
 	}
+	bool FileStream::readAt(void* dst, int size, int offset) {
+		TEST(isOpen());
+		int oldpos = ftell(file);
+		if(fseek(file, offset, SEEK_SET) != 0) {
+			FAIL;
+		}
+		int res = fread(dst, 1, size, file);
+		fseek(file, oldpos, SEEK_SET);
+		return res == size;
+	}
 	bool FileStream::length(int& aLength) const {
 		TEST(isOpen());
 		int oldpos = ftell(file);
@@ -81,6 +91,12 @@ namespace Base {
 		aPos = ftell(file);
 		return true;
 	}
+	bool FileStream::discardBuffer() {
+		if(!isOpen())
+			return true;
+		// a seek makes stdio forget what it has read ahead.
+		return fseek(file, 0, SEEK_CUR) == 0;
+	}
 	bool FileStream::mTime(time_t& t) const {
 		// TODO
 		FAIL;
@@ -90,9 +106,9 @@ namespace Base {
 	//LimitedFileStream
 	//******************************************************************************
 	LimitedFileStream::LimitedFileStream(const char* filename, int offset, int len)
-		: FileStream(filename), mStartPos(offset), mEndPos(offset + len)
+		: FileStream(filename), mStartPos(offset), mEndPos(offset + len), mPos(0), mWindow(NULL)
 	{
-		if(!_open()) {
+		if(isOpen() && !_open()) {
 			fclose(file);
 			file = NULL;
 		}
@@ -126,6 +142,16 @@ namespace Base {
 		int res = fwrite(src, 1, size, file);
 		return res == size;
 	}
+	bool WriteFileStream::writeAt(const void* src, int size, int offset) {
+		TEST(isOpen());
+		int oldpos = ftell(file);
+		if(fseek(file, offset, SEEK_SET) != 0) {
+			FAIL;
+		}
+		int res = fwrite(src, 1, size, file);
+		fseek(file, oldpos, SEEK_SET);
+		return res == size;
+	}
 	bool WriteFileStream::truncate(int size) {
 		// TODO. Will probably require rewrite of this entire file to use Win32 functions.
 		FAIL;
@@ -20,11 +20,16 @@ limitations under the License.
 #include "../../base/Stream.h"
 #include "Image.h"
 
+namespace Base {
+	// Deletes the image, once no drawing waits to use it.
+	void freeImage(Image* img);
+}
+
 #define TYPES(m)\
 	m(RT_BINARY, Base::Stream, delete)\
 	m(RT_PLACEHOLDER, void, NUL)\
 	m(RT_LABEL, Label, delete) \
-	m(RT_IMAGE, Image, delete)\
+	m(RT_IMAGE, Image, Base::freeImage)\
 	m(RT_FLUX, void, NUL)\
 
 #endif // _RESOURCE_DEFS_H_
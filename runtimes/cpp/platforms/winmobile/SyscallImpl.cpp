@@ -40,6 +40,9 @@ limitations under the License.
 #include "Syscall.h"
 #include "TextOutput.h"
 #include "ImageLoad.h"
+#ifdef TILE_RENDERER
+#include "TileRenderer.h"
+#endif
 #include <helpers/CPP_IX_GUIDO.h>
 #include "netImpl.h"
 #define NETWORKING_H
@@ -161,6 +164,48 @@ namespace Base {
 	unsigned int screenPitchX, screenPitchY;
 	MAHandle drawTargetHandle = HANDLE_SCREEN;
 
+#ifdef TILE_RENDERER
+	// records the drawing on the back buffer, while there is no frame buffer.
+	static TileRenderer* sTileRenderer = NULL;
+
+	// draws on the current surface; on the back buffer, through sTileRenderer.
+#define DRAW(call) do { if(sTileRenderer && currentDrawSurface == backBuffer)\
+	sTileRenderer->call; else currentDrawSurface->call; } while(0)
+#else
+#define DRAW(call) currentDrawSurface->call
+#endif
+
+	// rasterises the recorded drawing. call it before anything else uses
+	// the back buffer's pixels, or changes or deletes an image.
+	static void flushDrawing() {
+#ifdef TILE_RENDERER
+		if(sTileRenderer)
+			sTileRenderer->flush();
+#endif
+	}
+
+	static void startTileRenderer() {
+#ifdef TILE_RENDERER
+		SYSTEM_INFO info;
+		GetSystemInfo(&info);
+		sTileRenderer = new TileRenderer(backBuffer, MAX(1, (int)info.dwNumberOfProcessors));
+#endif
+	}
+
+	// called before the back buffer is deleted or replaced.
+	static void stopTileRenderer() {
+#ifdef TILE_RENDERER
+		flushDrawing();
+		delete sTileRenderer;
+		sTileRenderer = NULL;
+#endif
+	}
+
+	void freeImage(Image* img) {
+		flushDrawing();
+		delete img;
+	}
+
 	bool gGraphicsActive = true;
 
 	uint realColor;
@@ -240,6 +285,18 @@ namespace Base {
 	{
 		return NULL;
 	}
+
+	// pipe-tool only writes atlases with -atlas, which is not used when packaging.
+	Image* Syscall::loadAtlasPage(Stream& file)
+	{
+		return NULL;
+	}
+
+	Image* Syscall::loadAtlasImage(void* atlas, ushort left, ushort top,
+		ushort width, ushort height)
+	{
+		return NULL;
+	}
 	
 	//***************************************************************************
 	// Helpers
@@ -1070,6 +1127,8 @@ DWORD GetScreenOrientation()
 #endif
 
 	BOOL InitGraphics() {
+		// on a screen change, the old back buffer may go away here.
+		stopTileRenderer();
 #if (_WIN32_WCE >= 0x502)
 		if(!InitDDraw()) {
 			LOG("InitDDraw failed.\n");
@@ -1084,11 +1143,13 @@ DWORD GetScreenOrientation()
 			}
 		}
 #endif
+		startTileRenderer();
 		return TRUE;
 	}
 
 	void CloseGraphics() 
 	{
+		stopTileRenderer();
 #if _WIN32_WCE < 0x502
 		switch(graphicsMode) {
 			case GRAPHICSMODE_GX:
@@ -1135,6 +1196,7 @@ DWORD GetScreenOrientation()
 
 	static void MAUpdateScreen() 
 	{
+		flushDrawing();
 		if(GetForegroundWindow()!=g_hwndMain || gGraphicsActive==false) return;
 
 #if (_WIN32_WCE < 0x502)
@@ -1351,15 +1413,15 @@ DWORD GetScreenOrientation()
 	}
 
 	SYSCALL(void, maPlot(int posX, int posY)) {
-		currentDrawSurface->drawPoint(posX, posY, realColor);
+		DRAW(drawPoint(posX, posY, realColor));
 	}
 
 	SYSCALL(void, maLine(int x0, int y0, int x1, int y1)) {
-		currentDrawSurface->drawLine(x0, y0, x1, y1, realColor);
+		DRAW(drawLine(x0, y0, x1, y1, realColor));
 	}
 
 	SYSCALL(void, maFillRect(int left, int top, int width, int height)) {
-		currentDrawSurface->drawFilledRect(left, top, width, height, realColor);
+		DRAW(drawFilledRect(left, top, width, height, realColor));
 	}
 
 	SYSCALL(void, maFillTriangleStrip(const MAPoint2d *points, int count)) {
@@ -1367,14 +1429,14 @@ DWORD GetScreenOrientation()
 		CHECK_INT_ALIGNMENT(points);
 		MYASSERT(count >= 3, ERR_POLYGON_TOO_FEW_POINTS);
 		for(int i = 2; i < count; i++) {
-			currentDrawSurface->drawTriangle(
+			DRAW(drawTriangle(
 				points[i-2].x,
 				points[i-2].y,
 				points[i-1].x,
 				points[i-1].y,
 				points[i].x,
 				points[i].y,
-				realColor);
+				realColor));
 		}
 	}
 
@@ -1383,14 +1445,14 @@ DWORD GetScreenOrientation()
 		CHECK_INT_ALIGNMENT(points);
 		MYASSERT(count >= 3, ERR_POLYGON_TOO_FEW_POINTS);
 		for(int i = 2; i < count; i++) {
-			currentDrawSurface->drawTriangle(
+			DRAW(drawTriangle(
 				points[0].x,
 				points[0].y,
 				points[i-1].x,
 				points[i-1].y,
 				points[i].x,
 				points[i].y,
-				realColor);
+				realColor));
 		}
 	}
 
@@ -1405,10 +1467,12 @@ DWORD GetScreenOrientation()
 	}
 
 	SYSCALL(void, maDrawText(int left, int top, const char* str)) {
+		flushDrawing();
 		TextOutput::drawText(currentDrawSurface, left, top, str, realColor, false);
 	}
 
 	SYSCALL(void, maDrawTextW(int left, int top, const wchar* str)) {
+		flushDrawing();
 		TextOutput::drawText(currentDrawSurface, left, top, str, realColor, true);
 	}
 
@@ -1436,6 +1500,7 @@ DWORD GetScreenOrientation()
 		str[n] = 0;
 
 		// show mosync non-commercial text
+		flushDrawing();
 		int startTime = maGetMilliSecondCount();
 		while(maGetMilliSecondCount() < startTime + PERIOD_MS) 
 		{
@@ -1472,7 +1537,7 @@ DWORD GetScreenOrientation()
 
 	SYSCALL(void, maDrawImage(MAHandle image, int left, int top)) {
 		Image* img = gSyscall->resources.get_RT_IMAGE(image);	
-		currentDrawSurface->drawImage(left, top, img);
+		DRAW(drawImage(left, top, img));
 	}
 
 	SYSCALL(void, maDrawRGB(const MAPoint2d* dstPoint, const void* src, const MARect* srcRect,
@@ -1520,6 +1585,8 @@ DWORD GetScreenOrientation()
 		}
 
 		Image *image = new Image(img, alpha, srcRect->width, srcRect->height, srcRect->width*currentDrawSurface->bytesPerPixel, pixelFormat, false, true);
+		// the image is gone before the recorded drawing would run.
+		flushDrawing();
 		currentDrawSurface->drawImage(dstPoint->x, dstPoint->y, image);
 		delete image;
 	}
@@ -1531,7 +1598,7 @@ DWORD GetScreenOrientation()
 		gSyscall->ValidateMemRange(src, sizeof(MARect));	
 		Image* img = gSyscall->resources.get_RT_IMAGE(image);
 		ClipRect srcRect = {src->left, src->top, src->width, src->height};
-		currentDrawSurface->drawImageRegion(dstTopLeft->x, dstTopLeft->y, &srcRect, img, transformMode);
+		DRAW(drawImageRegion(dstTopLeft->x, dstTopLeft->y, &srcRect, img, transformMode));
 	}
 
 	SYSCALL(MAExtent, maGetImageSize(MAHandle image)) {
@@ -1624,6 +1691,8 @@ DWORD GetScreenOrientation()
 	}
 
 	SYSCALL(MAHandle, maSetDrawTarget(MAHandle handle)) {
+		// recorded drawing may use the new target as a source.
+		flushDrawing();
 		MAHandle temp = drawTargetHandle;
 		if(drawTargetHandle != HANDLE_SCREEN) {
 			SYSCALL_THIS->resources.extract_RT_FLUX(drawTargetHandle);
@@ -2333,6 +2402,8 @@ DWORD GetScreenOrientation()
 	SYSCALL(int, maFrameBufferInit(const void* addr)) {
 		gSyscall->ValidateMemRange(addr, backBuffer->pitch*backBuffer->height);
 		if(sInternalBackBuffer!=NULL) return 0;
+		// the program writes the frame buffer directly, so drawing isn't deferred.
+		stopTileRenderer();
 		sInternalBackBuffer = backBuffer;
 		backBuffer = new Image((unsigned char*)addr, NULL, backBuffer->width,
 			backBuffer->height, backBuffer->pitch, backBuffer->pixelFormat, false, false);
@@ -2346,6 +2417,7 @@ DWORD GetScreenOrientation()
 		backBuffer = sInternalBackBuffer;
 		sInternalBackBuffer = NULL;
 		currentDrawSurface = backBuffer;
+		startTileRenderer();
 		return 1;
 	}
 
@@ -3014,11 +3086,25 @@ retry:
 
 		maIOCtl_syscall_case(maFileTell);
 		maIOCtl_syscall_case(maFileSeek);
+		case maIOCtl_maFileReadAt:
+			return SYSCALL_THIS->maFileReadAt(a, SYSCALL_THIS->GetValidatedMemRange(b, c), c,
+				SYSCALL_THIS->GetValidatedStackValue(0 VSV_ARGPTR_USE));
+		case maIOCtl_maFileWriteAt:
+			return SYSCALL_THIS->maFileWriteAt(a, SYSCALL_THIS->GetValidatedMemRange(b, c), c,
+				SYSCALL_THIS->GetValidatedStackValue(0 VSV_ARGPTR_USE));
+		case maIOCtl_maFileAppend:
+			return SYSCALL_THIS->maFileAppend(a, SYSCALL_THIS->GetValidatedMemRange(b, c), c);
+		case maIOCtl_maFileReadSome:
+			return SYSCALL_THIS->maFileReadSome(a, SYSCALL_THIS->GetValidatedMemRange(b, c), c);
 
 		maIOCtl_syscall_case(maFileListStart);
 		case maIOCtl_maFileListNext:
 			return SYSCALL_THIS->maFileListNext(a, (char*)SYSCALL_THIS->GetValidatedMemRange(b, c), c);
 		maIOCtl_syscall_case(maFileListClose);
+		maIOCtl_syscall_case(maFileListStartRecursive);
+		case maIOCtl_maFileListNextBatch:
+			return SYSCALL_THIS->maFileListNextBatch(a, SYSCALL_THIS->GetValidatedMemRange(b, c), c,
+				SYSCALL_THIS->GetValidatedStackValue(0 VSV_ARGPTR_USE));
 
 			/*
 		case maIOCtl_maWlanStartDiscovery:
@@ -18,6 +18,9 @@ private:
 Image* loadImage(MemStream& s);
 Image* loadSprite(void* surface, ushort left, ushort top,
 	ushort width, ushort height, ushort cx, ushort cy);
+Image* loadAtlasPage(Stream& file);
+Image* loadAtlasImage(void* atlas, ushort left, ushort top,
+	ushort width, ushort height);
 
 public:
 	Syscall(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPWSTR lpCmdLine, int nShowCmd);
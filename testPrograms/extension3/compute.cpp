@@ -0,0 +1,32 @@
+/* Copyright 2013 David Axmark
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+	http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "cpp_mx_Compute.h"
+
+int cmpAdler32(const char* data, int len) {
+	const unsigned char* p = (const unsigned char*)data;
+	unsigned int a = 1, b = 0;
+	for(int i=0; i<len; i++) {
+		a = (a + p[i]) % 65521;
+		b = (b + a) % 65521;
+	}
+	return (int)((b << 16) | a);
+}
+
+void cmpSaxpy(float a, const float* x, float* y, int n) {
+	for(int i=0; i<n; i++) {
+		y[i] += a * x[i];
+	}
+}
@@ -0,0 +1,134 @@
+/* Copyright 2013 David Axmark
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+	http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+// Calls cmpAdler32() through the generated invoker, the way the runtime
+// would, on a fake data segment: through the version 1 entry point, with
+// the arguments in registers, then through the version 2 entry point, one
+// block at a time and then all blocks in one vectored call.
+// Only the cost of the stubs is measured; not the ioctl into the runtime.
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "extensionCommon.h"
+#include "CoreCommon.h"
+#include "cpp_mx_Compute.h"
+
+extern "C" void initializeExtension(ExtensionData* ed, const CoreData* cd);
+extern "C" void initializeExtension2(ExtensionData2* ed);
+
+#define BUFFERS 4096
+#define BUFFER_SIZE 16
+#define REPEATS 500
+
+// the index of cmpAdler32 in the extension's function tables.
+#define FN_ADLER32 0
+
+// a block is the words { data, len, result }.
+#define STRIDE 12
+
+#define DATA_ADDRESS 0
+#define BLOCKS_ADDRESS (BUFFERS * BUFFER_SIZE)
+#define MEM_SIZE (BLOCKS_ADDRESS + BUFFERS * STRIDE)
+
+static int sMemWords[MEM_SIZE / 4];
+static char* const sMem = (char*)sMemWords;
+
+static int* block(int i) {
+	return (int*)(sMem + BLOCKS_ADDRESS + i * STRIDE);
+}
+
+static double nsPerCall(clock_t start) {
+	return double(clock() - start) / CLOCKS_PER_SEC * 1e9 / (double(REPEATS) * BUFFERS);
+}
+
+int main() {
+	for(int i=0; i<BUFFERS; i++) {
+		for(int j=0; j<BUFFER_SIZE; j++)
+			sMem[DATA_ADDRESS + i * BUFFER_SIZE + j] = (char)(i + j);
+		block(i)[0] = DATA_ADDRESS + i * BUFFER_SIZE;
+		block(i)[1] = BUFFER_SIZE;
+		block(i)[2] = 0;
+	}
+
+	// the implementation itself, for reference.
+	int expected = 0;
+	clock_t start = clock();
+	for(int r=0; r<REPEATS; r++) {
+		expected = 0;
+		for(int i=0; i<BUFFERS; i++)
+			expected ^= cmpAdler32(sMem + DATA_ADDRESS + i * BUFFER_SIZE, BUFFER_SIZE);
+	}
+	double directNs = nsPerCall(start);
+
+	// version 1
+	int regs[32];
+	memset(regs, 0, sizeof(regs));
+	CoreData cd = { regs, sMem };
+	ExtensionData ed;
+	initializeExtension(&ed, &cd);
+	VoidFunction adler1 = ed.functions[FN_ADLER32];
+
+	int v1 = 0;
+	start = clock();
+	for(int r=0; r<REPEATS; r++) {
+		v1 = 0;
+		for(int i=0; i<BUFFERS; i++) {
+			regs[REG_i1] = DATA_ADDRESS + i * BUFFER_SIZE;
+			regs[REG_i2] = BUFFER_SIZE;
+			adler1();
+			v1 ^= regs[REG_r14];
+		}
+	}
+	double registerNs = nsPerCall(start);
+
+	// version 2
+	ExtensionData2 ed2;
+	initializeExtension2(&ed2);
+	const TypedFunctionInfo& adler2(ed2.functions[FN_ADLER32]);
+	ExtensionMemory mem = { sMem, MEM_SIZE };
+	char* blocks = sMem + BLOCKS_ADDRESS;
+
+	start = clock();
+	for(int r=0; r<REPEATS; r++) {
+		for(int i=0; i<BUFFERS; i++)
+			invokeTypedFunctionV(adler2, blocks + i * STRIDE, STRIDE, 1, mem);
+	}
+	double singleNs = nsPerCall(start);
+	int v2 = 0;
+	for(int i=0; i<BUFFERS; i++) {
+		v2 ^= block(i)[2];
+		block(i)[2] = 0;
+	}
+
+	int done = 0;
+	start = clock();
+	for(int r=0; r<REPEATS; r++)
+		done = invokeTypedFunctionV(adler2, blocks, STRIDE, BUFFERS, mem);
+	double vectoredNs = nsPerCall(start);
+	int vectored = 0;
+	for(int i=0; i<BUFFERS; i++)
+		vectored ^= block(i)[2];
+
+	printf("%i calls of %i bytes, ns per call:\n", BUFFERS * REPEATS, BUFFER_SIZE);
+	printf("direct:                      %6.1f\n", directNs);
+	printf("version 1, registers:        %6.1f\n", registerNs);
+	printf("version 2, one block a call: %6.1f\n", singleNs);
+	printf("version 2, vectored:         %6.1f\n", vectoredNs);
+
+	bool ok = v1 == expected && v2 == expected && vectored == expected && done == BUFFERS;
+	printf(ok ? "results match\n" : "results differ\n");
+	return ok ? 0 : 1;
+}
@@ -0,0 +1,34 @@
+#!/usr/bin/ruby
+
+# Host build of the Compute extension's invoker, timing the version 1
+# register ABI against the version 2 block ABI without a runtime.
+
+require File.expand_path('../../../../rules/exe.rb')
+require File.expand_path('../../../../rules/mosync_util.rb')
+
+class MxInvokerTask < MultiFileTask
+	def initialize(work, sourceIdl, name)
+		super(work, 'output/invoke-extension.cpp', ["output/cpp_mx_#{name}.h"])
+		@source = sourceIdl
+		@mxInvoker = mosyncdir + '/bin/mx-invoker'
+		@prerequisites << DirTask.new(work, 'output')
+		@prerequisites << FileTask.new(work, @source)
+		@prerequisites << FileTask.new(work, @mxInvoker + EXE_FILE_ENDING)
+	end
+	def execute
+		sh "#{@mxInvoker} -i #{@source} -o output"
+	end
+end
+
+work = ExeWork.new
+work.instance_eval do
+	@invokerTask = MxInvokerTask.new(self, '../compute.idl', 'Compute')
+	@EXTRA_SOURCETASKS = [@invokerTask]
+	@SOURCES = ['.']
+	@EXTRA_SOURCEFILES = ['../compute.cpp']
+	@EXTRA_INCLUDES = [mosyncdir + '/ext-include', 'output']
+	@EXTRA_CPPFLAGS = ''
+	@NAME = "ext3_host"
+end
+
+work.invoke
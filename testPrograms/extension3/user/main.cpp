@@ -0,0 +1,64 @@
+/* Copyright 2013 David Axmark
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+	http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+// Calls the Compute extension through maExtensionFunctionInvokeV(),
+// once per buffer and then once for all buffers, and logs the time taken.
+// MoRE has no version 1 dispatch; host/ times the version 1 stubs.
+
+#include "mx_Compute.h"
+#include <conprint.h>
+#include <maassert.h>
+#include <mavsprintf.h>
+
+#define BUFFERS 4096
+#define BUFFER_SIZE 64
+
+struct AdlerBlock {
+	const char* data;
+	int len;
+	int result;
+};
+// MX_WORDS_CMPADLER32 words.
+#define STRIDE ((int)sizeof(AdlerBlock))
+
+static char sData[BUFFERS][BUFFER_SIZE];
+static AdlerBlock sBlocks[BUFFERS];
+
+int MAMain() GCCATTRIB(noreturn);
+int MAMain() {
+	for(int i=0; i<BUFFERS; i++) {
+		for(int j=0; j<BUFFER_SIZE; j++)
+			sData[i][j] = (char)(i + j);
+		sBlocks[i].data = sData[i];
+		sBlocks[i].len = BUFFER_SIZE;
+		sBlocks[i].result = 0;
+	}
+
+	int start = maGetMilliSecondCount();
+	for(int i=0; i<BUFFERS; i++) {
+		maExtensionFunctionInvokeV(MX_FN_CMPADLER32, sBlocks + i, STRIDE, 1);
+	}
+	int single = maGetMilliSecondCount() - start;
+	int first = sBlocks[BUFFERS-1].result;
+
+	start = maGetMilliSecondCount();
+	int count = maExtensionFunctionInvokeV(MX_FN_CMPADLER32, sBlocks, STRIDE, BUFFERS);
+	int vectored = maGetMilliSecondCount() - start;
+
+	printf("%i calls: %i ms one at a time, %i ms vectored\n", BUFFERS, single, vectored);
+	printf("count %i, results %s\n", count,
+		first == sBlocks[BUFFERS-1].result ? "match" : "differ");
+	FREEZE;
+}
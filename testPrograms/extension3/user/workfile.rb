@@ -0,0 +1,14 @@
+#!/usr/bin/ruby
+
+require File.expand_path('../../../rules/mosync_exe.rb')
+
+work = PipeExeWork.new
+work.instance_eval do
+	@EXTENSIONS = [['../compute.idl', 'Compute']]
+	@SOURCES = ['.']
+	@EXTRA_INCLUDES = ['build']
+	@EXTRA_CPPFLAGS = ''
+	@NAME = "ext3_user"
+end
+
+work.invoke
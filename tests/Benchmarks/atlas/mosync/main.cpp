@@ -0,0 +1,72 @@
+/* Copyright 2013 David Axmark
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+	http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+// Loads and draws the same images, first as separate image resources,
+// then as images packed into an atlas by the resource compiler.
+
+#include <ma.h>
+#include <conprint.h>
+#include "MAHeaders.h"
+
+#define NUM_IMAGES 48
+#define LOAD_ROUNDS 20
+#define DRAW_FRAMES 200
+
+// the atlas page follows the last atlas image. the images fit in one page.
+#define ATLAS_PAGE (ATL_47 + 1)
+
+static int loadImages(MAHandle first, MAHandle pagesEnd) {
+	int start = maGetMilliSecondCount();
+	for(int r = 0; r < LOAD_ROUNDS; r++) {
+		for(MAHandle h = first; h < first + NUM_IMAGES; h++) {
+			maDestroyObject(h);
+		}
+		for(MAHandle h = first + NUM_IMAGES; h < pagesEnd; h++) {
+			maDestroyObject(h);
+		}
+		for(MAHandle h = first; h < first + NUM_IMAGES; h++) {
+			maLoadResource(h, h, MA_RESOURCE_OPEN | MA_RESOURCE_CLOSE);
+		}
+	}
+	return maGetMilliSecondCount() - start;
+}
+
+static int drawImages(MAHandle first) {
+	MAExtent scr = maGetScrSize();
+	int w = EXTENT_X(scr), h = EXTENT_Y(scr);
+	int start = maGetMilliSecondCount();
+	for(int f = 0; f < DRAW_FRAMES; f++) {
+		for(int i = 0; i < NUM_IMAGES * 4; i++) {
+			maDrawImage(first + i % NUM_IMAGES, (i * 37 + f) % w, (i * 23 + f) % h);
+		}
+		maUpdateScreen();
+	}
+	return maGetMilliSecondCount() - start;
+}
+
+extern "C" int MAMain() {
+	int plainLoad = loadImages(IMG_00, IMG_00 + NUM_IMAGES);
+	int atlasLoad = loadImages(ATL_00, ATLAS_PAGE + 1);
+	int plainDraw = drawImages(IMG_00);
+	int atlasDraw = drawImages(ATL_00);
+
+	printf("%i images, %i loads, %i frames\n", NUM_IMAGES, LOAD_ROUNDS, DRAW_FRAMES);
+	printf("load separate: %i ms\n", plainLoad);
+	printf("load atlas:    %i ms\n", atlasLoad);
+	printf("draw separate: %i ms\n", plainDraw);
+	printf("draw atlas:    %i ms\n", atlasDraw);
+	maWait(0);
+	return 0;
+}
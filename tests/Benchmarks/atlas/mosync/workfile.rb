@@ -0,0 +1,11 @@
+#!/usr/bin/ruby
+
+require File.expand_path('../../../../rules/mosync_exe.rb')
+
+work = PipeExeWork.new
+work.instance_eval do
+	@SOURCES = ["."]
+	@NAME = "AtlasBench"
+end
+
+work.invoke
@@ -0,0 +1,13 @@
+#build the MATest benchmarks and run them on MoRE without a screen.
+#each benchmark compares with the baseline store in its directory
+#(stores/<name>.baseline, created by the first run) and exits
+#with the number of regressions. remove the store to reset the baseline.
+failed=0
+for bench in linpack membench stropbench
+do
+	cd ../$bench/mosync/
+	ruby workfile.rb CONFIG=
+	ruby workfile.rb run CONFIG= || failed=1
+	cd ../../benchmark_suites/
+done
+exit $failed
@@ -0,0 +1,233 @@
+/* Copyright 2013 David Axmark
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+	http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+// Compares MAUtil::BTreeMap with the kazlib based MAUtil::Map.
+// Both get the same random inserts, lookups, erases and iterations;
+// the contents are checked to be equal after every phase and the
+// time of each phase is printed.
+//
+// Usage: btreebench [max elements]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <MAUtil/Map.h>
+#include <MAUtil/BTreeMap.h>
+
+using namespace MAUtil;
+
+typedef Map<int, int> IntMap;
+typedef BTreeMap<int, int> IntBTreeMap;
+
+static double seconds(clock_t start) {
+	return double(clock() - start) / CLOCKS_PER_SEC;
+}
+
+static unsigned int sSeed;
+
+static int nextRandom() {
+	sSeed = sSeed * 1103515245 + 12345;
+	return (int)((sSeed >> 1) & 0x3fffffff);
+}
+
+static bool same(const IntMap& m, const IntBTreeMap& b) {
+	if(m.size() != b.size())
+		return false;
+	IntMap::ConstIterator mi = m.begin();
+	IntBTreeMap::ConstIterator bi = b.begin();
+	for(; mi != m.end(); ++mi, ++bi) {
+		if(bi == b.end() || mi->first != bi->first || mi->second != bi->second)
+			return false;
+	}
+	if(bi != b.end())
+		return false;
+
+	// Backwards from end().
+	if(m.size() > 0) {
+		mi = m.end();
+		bi = b.end();
+		do {
+			--mi;
+			--bi;
+			if(mi->first != bi->first)
+				return false;
+		} while(mi != m.begin());
+		if(bi != b.begin())
+			return false;
+	}
+	return true;
+}
+
+// Checks lowerBound() and upperBound() against a linear scan of the Map.
+static bool sameBounds(const IntMap& m, const IntBTreeMap& b, int probes) {
+	for(int i = 0; i < probes; i++) {
+		int key = nextRandom() % (int)(m.size() * 4 + 1);
+		IntMap::ConstIterator lower = m.begin();
+		while(lower != m.end() && lower->first < key)
+			++lower;
+		IntMap::ConstIterator upper = lower;
+		if(upper != m.end() && upper->first == key)
+			++upper;
+		IntBTreeMap::ConstIterator bl = b.lowerBound(key);
+		IntBTreeMap::ConstIterator bu = b.upperBound(key);
+		if((lower == m.end()) != (bl == b.end()) || (upper == m.end()) != (bu == b.end()))
+			return false;
+		if(lower != m.end() && lower->first != bl->first)
+			return false;
+		if(upper != m.end() && upper->first != bu->first)
+			return false;
+	}
+	return true;
+}
+
+template<class M> static void insert(M& map, const int* keys, int count) {
+	for(int i = 0; i < count; i++)
+		map.insert(keys[i], i);
+}
+
+template<class M> static int lookup(const M& map, const int* keys, int count) {
+	int found = 0;
+	for(int i = 0; i < count; i++) {
+		typename M::ConstIterator itr = map.find(keys[i]);
+		if(itr != map.end())
+			found += itr->second & 1;
+	}
+	return found;
+}
+
+template<class M> static int iterate(const M& map, int times) {
+	int sum = 0;
+	for(int t = 0; t < times; t++)
+		for(typename M::ConstIterator itr = map.begin(); itr != map.end(); ++itr)
+			sum += itr->second;
+	return sum;
+}
+
+template<class M> static void erase(M& map, const int* keys, int count) {
+	for(int i = 0; i < count; i++)
+		map.erase(keys[i]);
+}
+
+static bool run(int count) {
+	int* keys = new int[count];
+	int* probes = new int[count];
+	sSeed = count;
+	for(int i = 0; i < count; i++) {
+		keys[i] = nextRandom() % (count * 4);
+		probes[i] = nextRandom() % (count * 4);
+	}
+	int times = count < 100000 ? 100000 / count : 1;
+	double mt[4], bt[4];
+	bool ok = true;
+
+	IntMap m;
+	IntBTreeMap b;
+
+	clock_t start = clock();
+	insert(m, keys, count);
+	mt[0] = seconds(start);
+	start = clock();
+	insert(b, keys, count);
+	bt[0] = seconds(start);
+	ok = ok && same(m, b);
+	if(count <= 10000)
+		ok = ok && sameBounds(m, b, 100);
+
+	start = clock();
+	int mf = lookup(m, probes, count);
+	mt[1] = seconds(start);
+	start = clock();
+	int bf = lookup(b, probes, count);
+	bt[1] = seconds(start);
+	ok = ok && mf == bf;
+
+	start = clock();
+	int ms = iterate(m, times);
+	mt[2] = seconds(start) / times;
+	start = clock();
+	int bs = iterate(b, times);
+	bt[2] = seconds(start) / times;
+	ok = ok && ms == bs;
+
+	start = clock();
+	erase(m, probes, count);
+	mt[3] = seconds(start);
+	start = clock();
+	erase(b, probes, count);
+	bt[3] = seconds(start);
+	ok = ok && same(m, b);
+
+	// Copying inserts in order, which packs the leaves.
+	IntBTreeMap copy(b);
+	ok = ok && same(m, copy);
+
+	static const char* phases[] = { "insert", "lookup", "iterate", "erase" };
+	for(int i = 0; i < 4; i++) {
+		printf("%8i %-8s %10.3f ms Map %10.3f ms BTreeMap %6.2fx\n", count, phases[i],
+			1000 * mt[i], 1000 * bt[i], bt[i] > 0 ? mt[i] / bt[i] : 0);
+	}
+	printf("%8i elements %s\n", count, ok ? "match" : "MISMATCH");
+
+	delete[] keys;
+	delete[] probes;
+	return ok;
+}
+
+// Random inserts and erases in small maps, where the nodes split,
+// borrow and merge often, checked against Map after every operation.
+static bool stress() {
+	sSeed = 1;
+	for(int round = 0; round < 100; round++) {
+		IntMap m;
+		IntBTreeMap b;
+		int range = 16 + round * 10;
+		for(int i = 0; i < range * 4; i++) {
+			int key = nextRandom() % range;
+			if(nextRandom() % 3 == 0) {
+				bool me = m.erase(key);
+				if(me != b.erase(key))
+					return false;
+			} else if(nextRandom() % 7 == 0) {
+				IntBTreeMap::Iterator itr = b.lowerBound(key);
+				if(itr != b.end()) {
+					int k = itr->first;
+					IntBTreeMap::Iterator next = b.erase(itr);
+					m.erase(k);
+					if(next != b.upperBound(k))
+						return false;
+				}
+			} else {
+				bool mi = m.insert(key, i).second;
+				Pair<IntBTreeMap::Iterator, bool> res = b.insert(key, i);
+				if(mi != res.second || res.first->first != key)
+					return false;
+			}
+			if(!same(m, b))
+				return false;
+		}
+	}
+	return true;
+}
+
+int main(int argc, char** argv) {
+	int max = argc > 1 ? atoi(argv[1]) : 1000000;
+	bool ok = stress();
+	printf("stress %s\n", ok ? "match" : "MISMATCH");
+	for(int count = 1000; count <= max; count *= 10)
+		ok = run(count) && ok;
+	return ok ? 0 : 1;
+}
@@ -0,0 +1,19 @@
+#!/usr/bin/ruby
+
+# Host build of the MAUtil BTreeMap benchmark.
+
+require File.expand_path('../../../../rules/exe.rb')
+
+work = ExeWork.new
+work.instance_eval do
+	@SOURCES = ["."]
+	@EXTRA_SOURCEFILES = [
+		"../../../../libs/kazlib/dict.c",
+	]
+	@EXTRA_INCLUDES = ["../../common/host/stub", "../../../../libs"]
+	# Without NDEBUG, kazlib verifies the whole tree on every change.
+	@EXTRA_CFLAGS = " -DNDEBUG"
+	@NAME = "btreebench"
+end
+
+work.invoke
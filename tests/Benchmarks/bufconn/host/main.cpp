@@ -0,0 +1,461 @@
+/* Copyright 2013 David Axmark
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+	http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+// Compares MAUtil::BufferedConnection with a plain MAUtil::Connection,
+// against a line and frame server in a child process.
+//
+// The server sends LINES lines of text and FRAMES frames with a 2-byte
+// big-endian length header, then reads RECORDS small records and answers
+// with a line that has their count and checksum.
+// With a plain Connection, lines are read one byte at a time, frames
+// with one read() for the header and one for the body, and every record
+// is written with its own write(). BufferedConnection uses readLine(),
+// readFrame() and write() with a flush() at the end.
+//
+// The connection syscalls run over a socket pair. Their events are queued,
+// like the runtime does, and passed to Environment::fireConnEvent().
+// The number of maConnRead() and maConnWrite() calls is printed for each
+// test, with its time.
+//
+// Usage: bufconnbench [lines] [buffer size]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+
+#include <MAUtil/BufferedConnection.h>
+
+using namespace MAUtil;
+
+#define FRAMES 20000
+#define FRAME_MAX 1000
+#define RECORDS 100000
+#define RECORD_SIZE 12
+#define LINE_MAX 100
+
+static double seconds(clock_t start) {
+	return double(clock() - start) / CLOCKS_PER_SEC;
+}
+
+static unsigned int sSeed;
+
+static int nextRandom() {
+	sSeed = sSeed * 1103515245 + 12345;
+	return (int)((sSeed >> 1) & 0x3fffffff);
+}
+
+//******************************************************************************
+// Syscalls
+//******************************************************************************
+
+#define HANDLE 1
+#define QUEUE_SIZE 16
+
+static int sSocket = -1;
+static int sReads, sWrites;
+static int sBufferSize = BufferedConnection::DEFAULT_BUFFER_SIZE;
+
+// maConnRead() and maConnWrite() finish at once, but their events wait
+// for the pump, like they would wait for maGetEvent().
+static MAConnEventData sQueue[QUEUE_SIZE];
+static int sQueueLen;
+
+static void post(int opType, int result) {
+	if(sQueueLen == QUEUE_SIZE)
+		abort();
+	MAConnEventData d = { HANDLE, opType, result };
+	sQueue[sQueueLen++] = d;
+}
+
+void maConnRead(MAHandle conn, void* dst, int size) {
+	sReads++;
+	int res = ::read(sSocket, dst, size);
+	post(CONNOP_READ, res > 0 ? res : res == 0 ? CONNERR_CLOSED : CONNERR_GENERIC);
+}
+
+void maConnWrite(MAHandle conn, const void* src, int size) {
+	sWrites++;
+	const char* p = (const char*)src;
+	while(size > 0) {
+		int res = ::write(sSocket, p, size);
+		if(res <= 0) {
+			post(CONNOP_WRITE, CONNERR_GENERIC);
+			return;
+		}
+		p += res;
+		size -= res;
+	}
+	post(CONNOP_WRITE, 1);
+}
+
+void maConnClose(MAHandle conn) {
+	::close(sSocket);
+	sSocket = -1;
+}
+
+int maGetMilliSecondCount() {
+	return int(clock() / (CLOCKS_PER_SEC / 1000));
+}
+
+int maGetSystemProperty(const char* key, char* buf, int size) {
+	return -2;
+}
+
+MAHandle maConnect(const char* url) { abort(); }
+void maConnReadToData(MAHandle conn, MAHandle data, int offset, int size) { abort(); }
+void maConnWriteFromData(MAHandle conn, MAHandle data, int offset, int size) { abort(); }
+void maConnReadFrom(MAHandle conn, void* dst, int size, MAConnAddr* src) { abort(); }
+void maConnWriteTo(MAHandle conn, const void* src, int size, const MAConnAddr* dst) { abort(); }
+int maConnGetAddr(MAHandle conn, MAConnAddr* addr) { abort(); }
+MAHandle maHttpCreate(const char* url, int method) { abort(); }
+void maHttpSetRequestHeader(MAHandle conn, const char* key, const char* value) { abort(); }
+int maHttpGetResponseHeader(MAHandle conn, const char* key, char* buffer, int bufSize) { abort(); }
+void maHttpFinish(MAHandle conn) { abort(); }
+
+namespace MAUtil {
+	int dummy(int a) { return a; }
+}
+
+class Pump : public Environment {
+public:
+	// Passes events to the connection until it has none.
+	void run() {
+		while(sQueueLen > 0) {
+			MAConnEventData d = sQueue[0];
+			sQueueLen--;
+			memmove(sQueue, sQueue + 1, sQueueLen * sizeof(MAConnEventData));
+			fireConnEvent(d);
+		}
+	}
+};
+
+//******************************************************************************
+// Server
+//******************************************************************************
+
+static void writeAll(int s, const char* p, int len) {
+	while(len > 0) {
+		int res = ::write(s, p, len);
+		if(res <= 0)
+			_exit(1);
+		p += res;
+		len -= res;
+	}
+}
+
+// Random line contents, and frame lengths, which the client checks.
+static int makeLine(char* line) {
+	int len = nextRandom() % (LINE_MAX - 2);
+	for(int i = 0; i < len; i++)
+		line[i] = 'a' + nextRandom() % 26;
+	if(nextRandom() & 1)
+		line[len++] = '\r';
+	line[len++] = '\n';
+	return len;
+}
+
+static void server(int s, int lines) {
+	static char buf[64 * 1024];
+	int len = 0;
+	sSeed = 3;
+	for(int i = 0; i < lines; i++) {
+		len += makeLine(buf + len);
+		if(len > (int)sizeof(buf) - LINE_MAX) {
+			writeAll(s, buf, len);
+			len = 0;
+		}
+	}
+	for(int i = 0; i < FRAMES; i++) {
+		int flen = nextRandom() % FRAME_MAX;
+		if(len + 2 + flen > (int)sizeof(buf)) {
+			writeAll(s, buf, len);
+			len = 0;
+		}
+		buf[len++] = (char)(flen >> 8);
+		buf[len++] = (char)flen;
+		memset(buf + len, i, flen);
+		len += flen;
+	}
+	writeAll(s, buf, len);
+
+	// the records.
+	int total = RECORDS * RECORD_SIZE;
+	unsigned int sum = 0;
+	while(total > 0) {
+		int res = ::read(s, buf, total < (int)sizeof(buf) ? total : sizeof(buf));
+		if(res <= 0)
+			_exit(1);
+		for(int i = 0; i < res; i++)
+			sum = sum * 31 + (byte)buf[i];
+		total -= res;
+	}
+	len = sprintf(buf, "%i %u\r\n", RECORDS, sum);
+	writeAll(s, buf, len);
+	::close(s);
+	_exit(0);
+}
+
+static pid_t startServer(int lines) {
+	int s[2];
+	if(socketpair(AF_UNIX, SOCK_STREAM, 0, s) != 0) {
+		printf("socketpair failed.\n");
+		exit(1);
+	}
+	pid_t pid = fork();
+	if(pid == 0) {
+		::close(s[0]);
+		server(s[1], lines);
+	}
+	::close(s[1]);
+	sSocket = s[0];
+	sReads = sWrites = 0;
+	return pid;
+}
+
+//******************************************************************************
+// Clients
+//******************************************************************************
+
+static void makeRecord(byte* rec, int i) {
+	for(int j = 0; j < RECORD_SIZE; j++)
+		rec[j] = (byte)(i * 7 + j);
+}
+
+static unsigned int recordSum() {
+	unsigned int sum = 0;
+	byte rec[RECORD_SIZE];
+	for(int i = 0; i < RECORDS; i++) {
+		makeRecord(rec, i);
+		for(int j = 0; j < RECORD_SIZE; j++)
+			sum = sum * 31 + rec[j];
+	}
+	return sum;
+}
+
+// The client's steps, as the server runs them.
+enum Stage { LINES_STAGE, FRAMES_STAGE, RECORDS_STAGE, REPLY_STAGE, DONE_STAGE };
+
+// Counts the lines and frames, and checks them against the server's.
+class Checker {
+public:
+	Checker(int lines) : mLines(lines), mLine(0), mFrame(0), mFailed(false), mStage(LINES_STAGE) {
+		sSeed = 3;
+	}
+
+	void line(const char* text, int len) {
+		char expected[LINE_MAX];
+		int elen = makeLine(expected);
+		elen--;
+		if(elen > 0 && expected[elen - 1] == '\r')
+			elen--;
+		if(len != elen || memcmp(text, expected, len) != 0)
+			mFailed = true;
+		if(++mLine == mLines)
+			mStage = FRAMES_STAGE;
+	}
+
+	void frame(const byte* data, int len) {
+		int elen = nextRandom() % FRAME_MAX;
+		if(len != elen || (len > 0 && (data[0] != (byte)mFrame || data[len - 1] != (byte)mFrame)))
+			mFailed = true;
+		if(++mFrame == FRAMES)
+			mStage = RECORDS_STAGE;
+	}
+
+	void reply(const char* text) {
+		char expected[64];
+		sprintf(expected, "%i %u", RECORDS, recordSum());
+		if(strcmp(text, expected) != 0)
+			mFailed = true;
+		mStage = DONE_STAGE;
+	}
+
+	const int mLines;
+	int mLine, mFrame;
+	bool mFailed;
+	Stage mStage;
+};
+
+// Reads like a Connection user does without a buffer.
+class PlainClient : public ConnectionListener, public Checker {
+public:
+	PlainClient(int lines) : Checker(lines), mConn(this, HANDLE), mLen(0), mRecord(0) {
+		mConn.read(mBuf, 1);
+	}
+
+	void connReadFinished(Connection* conn, int result) {
+		if(result < 0) {
+			mFailed = true;
+			return;
+		}
+		switch(mStage) {
+		case LINES_STAGE:
+		case REPLY_STAGE:
+			if(mBuf[mLen] == '\n') {
+				int len = mLen;
+				if(len > 0 && mBuf[len - 1] == '\r')
+					len--;
+				mBuf[len] = 0;
+				mLen = 0;
+				if(mStage == REPLY_STAGE) {
+					reply((char*)mBuf);
+					return;
+				}
+				line((char*)mBuf, len);
+			} else if(++mLen == LINE_MAX) {
+				mFailed = true;
+				return;
+			}
+			if(mStage == FRAMES_STAGE)
+				mConn.read(mBuf, 2);
+			else
+				mConn.read(mBuf + mLen, 1);
+			break;
+		case FRAMES_STAGE:
+			if(mLen == 0) {
+				mLen = (mBuf[0] << 8) | mBuf[1];
+				if(mLen > 0) {
+					mConn.read(mBuf, mLen);
+					break;
+				}
+			}
+			frame(mBuf, mLen);
+			mLen = 0;
+			if(mStage == RECORDS_STAGE)
+				writeRecord();
+			else
+				mConn.read(mBuf, 2);
+			break;
+		default:
+			mFailed = true;
+		}
+	}
+
+	void connWriteFinished(Connection* conn, int result) {
+		if(result < 0) {
+			mFailed = true;
+			return;
+		}
+		if(mRecord < RECORDS) {
+			writeRecord();
+		} else {
+			mStage = REPLY_STAGE;
+			mConn.read(mBuf, 1);
+		}
+	}
+
+	void writeRecord() {
+		makeRecord(mRecordBuf, mRecord++);
+		mConn.write(mRecordBuf, RECORD_SIZE);
+	}
+
+	Connection mConn;
+	byte mBuf[FRAME_MAX + LINE_MAX];
+	byte mRecordBuf[RECORD_SIZE];
+	int mLen;
+	int mRecord;
+};
+
+class BufferedClient : public BufferedConnectionListener, public Checker {
+public:
+	BufferedClient(int lines) : Checker(lines), mConn(this, sBufferSize, HANDLE) {
+		mConn.readLine((char*)mBuf, LINE_MAX);
+	}
+
+	void connReadLineFinished(BufferedConnection* conn, int result) {
+		if(result < 0) {
+			mFailed = true;
+			return;
+		}
+		if(mStage == REPLY_STAGE) {
+			reply((char*)mBuf);
+			return;
+		}
+		line((char*)mBuf, result);
+		if(mStage == FRAMES_STAGE)
+			mConn.readFrame(mBuf, FRAME_MAX, 2);
+		else
+			mConn.readLine((char*)mBuf, LINE_MAX);
+	}
+
+	void connReadFrameFinished(BufferedConnection* conn, int result) {
+		if(result < 0) {
+			mFailed = true;
+			return;
+		}
+		frame(mBuf, result);
+		if(mStage == FRAMES_STAGE) {
+			mConn.readFrame(mBuf, FRAME_MAX, 2);
+			return;
+		}
+		byte rec[RECORD_SIZE];
+		for(int i = 0; i < RECORDS; i++) {
+			makeRecord(rec, i);
+			mConn.write(rec, RECORD_SIZE);
+		}
+		mConn.flush();
+	}
+
+	void connWriteFinished(Connection* conn, int result) {
+		if(result < 0) {
+			mFailed = true;
+			return;
+		}
+		mStage = REPLY_STAGE;
+		mConn.readLine((char*)mBuf, LINE_MAX);
+	}
+
+	BufferedConnection mConn;
+	byte mBuf[FRAME_MAX + LINE_MAX];
+};
+
+template<class Client> static bool test(Pump& pump, const char* name, int lines) {
+	pid_t pid = startServer(lines);
+	clock_t start = clock();
+	Client client(lines);
+	pump.run();
+	double time = seconds(start);
+	client.mConn.close();
+	int status;
+	waitpid(pid, &status, 0);
+	if(client.mFailed || client.mStage != DONE_STAGE || status != 0) {
+		printf("%s failed.\n", name);
+		return false;
+	}
+	printf("%-20s %8i maConnRead %8i maConnWrite %8.3f s\n", name, sReads, sWrites, time);
+	return true;
+}
+
+int main(int argc, const char** argv) {
+	int lines = 100000;
+	if(argc > 1)
+		lines = atoi(argv[1]);
+	if(argc > 2)
+		sBufferSize = atoi(argv[2]);
+
+	printf("%i lines, %i frames, %i records of %i bytes, %i byte buffer\n",
+		lines, FRAMES, RECORDS, RECORD_SIZE, sBufferSize);
+	Pump pump;
+	if(!test<PlainClient>(pump, "Connection:", lines))
+		return 1;
+	if(!test<BufferedClient>(pump, "BufferedConnection:", lines))
+		return 1;
+	return 0;
+}
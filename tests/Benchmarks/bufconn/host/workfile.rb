@@ -0,0 +1,24 @@
+#!/usr/bin/ruby
+
+# Host build of the MAUtil BufferedConnection benchmark.
+# main.cpp implements the connection syscalls over a socket.
+
+require File.expand_path('../../../../rules/exe.rb')
+
+MAUTIL_DIR = "../../../../libs/MAUtil"
+
+work = ExeWork.new
+work.instance_eval do
+	@SOURCES = ["."]
+	@EXTRA_SOURCEFILES = [
+		"#{MAUTIL_DIR}/Connection.cpp",
+		"#{MAUTIL_DIR}/BufferedConnection.cpp",
+		"#{MAUTIL_DIR}/Environment.cpp",
+		"#{MAUTIL_DIR}/String.cpp",
+		"#{MAUTIL_DIR}/RefCounted.cpp",
+	]
+	@EXTRA_INCLUDES = ["../../common/host/stub", "../../../../libs"]
+	@NAME = "bufconnbench"
+end
+
+work.invoke
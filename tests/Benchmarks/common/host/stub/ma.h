@@ -0,0 +1,114 @@
+/* Copyright 2013 David Axmark
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+	http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+// Host stand-ins for the MoSync API, shared by the host benchmarks.
+// The benchmarks that use data, images or connections implement those
+// functions in their main.cpp; drawing does nothing. The rest are only
+// declared, so that MAUtil compiles.
+
+#ifndef MA_H
+#define MA_H
+
+#include <stddef.h>
+#include <string.h>
+// maPanic(), which the real ma.h declares.
+#include <maassert.h>
+
+typedef int MAHandle;
+typedef int MAExtent;
+typedef unsigned char byte;
+typedef unsigned int uint;
+
+typedef struct MARect {
+	int left, top, width, height;
+} MARect;
+
+typedef struct MAPoint2d {
+	int x, y;
+} MAPoint2d;
+
+typedef struct MAConnEventData {
+	MAHandle handle;
+	int opType;
+	int result;
+} MAConnEventData;
+
+typedef struct MAConnAddr {
+	int family;
+} MAConnAddr;
+
+typedef struct MASensor {
+	int type;
+	float values[4];
+} MASensor;
+
+typedef struct MAEvent {
+	int type;
+	int mediaType;
+	MAHandle mediaHandle;
+	int operationResultCode;
+} MAEvent;
+
+#define EXTENT_X(e) ((short)((e) >> 16))
+#define EXTENT_Y(e) ((short)(e))
+#define EXTENT(x, y) ((MAExtent)((((int)(x)) << 16) | ((y) & 0xFFFF)))
+
+#define CONNERR_GENERIC -2
+#define CONNERR_CLOSED -6
+#define CONNERR_PROTOCOL -14
+
+#define CONNOP_READ 1
+#define CONNOP_WRITE 2
+#define CONNOP_CONNECT 7
+#define CONNOP_FINISH 11
+
+#define RES_OK 1
+#define RES_OUT_OF_MEMORY -1
+#define RES_BAD_INPUT -2
+
+#define MAK_FIRST 0
+#define MA_MEDIA_TYPE_IMAGE 0
+#define MA_MEDIA_RES_OK 0
+#define MA_TB_RES_OK 1
+#define MA_SCREEN_ORIENTATION_PORTRAIT 0x3
+
+int maGetMilliSecondCount(void);
+int maGetSystemProperty(const char* key, char* buf, int size);
+
+int maGetDataSize(MAHandle data);
+void maReadData(MAHandle data, void* dst, int offset, int size);
+MAHandle maCreatePlaceholder(void);
+void maDestroyPlaceholder(MAHandle handle);
+int maCreateImageFromData(MAHandle placeholder, MAHandle data, int offset, int size);
+
+MAExtent maGetImageSize(MAHandle image);
+void maGetImageData(MAHandle image, void* dst, const MARect* srcRect, int scanlength);
+void maDrawImageRegion(MAHandle image, const MARect* srcRect, const MAPoint2d* dstPoint, int transformMode);
+
+MAHandle maConnect(const char* url);
+void maConnClose(MAHandle conn);
+void maConnRead(MAHandle conn, void* dst, int size);
+void maConnWrite(MAHandle conn, const void* src, int size);
+void maConnReadToData(MAHandle conn, MAHandle data, int offset, int size);
+void maConnWriteFromData(MAHandle conn, MAHandle data, int offset, int size);
+void maConnReadFrom(MAHandle conn, void* dst, int size, MAConnAddr* src);
+void maConnWriteTo(MAHandle conn, const void* src, int size, const MAConnAddr* dst);
+int maConnGetAddr(MAHandle conn, MAConnAddr* addr);
+MAHandle maHttpCreate(const char* url, int method);
+void maHttpSetRequestHeader(MAHandle conn, const char* key, const char* value);
+int maHttpGetResponseHeader(MAHandle conn, const char* key, char* buffer, int bufSize);
+void maHttpFinish(MAHandle conn);
+
+#endif	//MA_H
@@ -0,0 +1,35 @@
+/* Copyright 2013 David Axmark
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+	http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef MAASSERT_H
+#define MAASSERT_H
+
+#include <assert.h>
+#include <stddef.h>
+#include <stdlib.h>
+
+#define MAASSERT(a) assert(a)
+#define ASSERT_MSG(a, msg) assert(a)
+#define BIG_PHAT_ERROR abort()
+#define PANIC_MESSAGE(msg) abort()
+#define ATTRIBUTE(a, func) func __attribute__ ((a))
+#define GCCATTRIB(a) __attribute__((a))
+
+#define maPanic(result, message) abort()
+
+// collection_common.h's OFFSETOF truncates pointers on 64-bit hosts.
+#define OFFSETOF(type, member) ((int)offsetof(type, member))
+
+#endif	//MAASSERT_H
@@ -0,0 +1,232 @@
+/* Copyright 2013 David Axmark
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+	http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+// Measures what loading a program costs the runtime, before and after
+// the data segment was reserved instead of allocated, for programs that
+// declare more and more data. Linux only; the resident set is read from
+// /proc/self/statm.
+//
+// A program is loaded the way Core::LoadVM() does it: the data segment
+// and its protection bits are allocated, DATA_LEN bytes of initialized
+// data are read into it, and the rest is cleared. The old way allocates
+// and clears the whole segment; the new way maps the reservation Core.cpp
+// maps, which the OS clears when it is first touched.
+// Then the program "runs": it touches its stack, at the top of the data,
+// and a heap of HEAP_USED bytes, grown the way tlsf grows it with
+// maHeapGrow() in the new case, and frees it again, which releases it.
+//
+// Usage: datasegmentbench [megabytes...]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#ifndef MAP_NORESERVE
+#define MAP_NORESERVE 0
+#endif
+
+#define DATA_LEN (256*1024)
+#define STACK_SIZE (128*1024)
+#define HEAP_USED (8*1024*1024)
+#define GROW_GRANULARITY (64*1024)
+#define RESERVE (sizeof(void*) == 8 ? (1024u*1024*1024) : (256u*1024*1024))
+
+static double seconds(clock_t start) {
+	return double(clock() - start) / CLOCKS_PER_SEC;
+}
+
+static unsigned int sSeed;
+
+static int nextRandom() {
+	sSeed = sSeed * 1103515245 + 12345;
+	return (int)((sSeed >> 1) & 0x3fffffff);
+}
+
+static double residentMB() {
+	long size, resident;
+	FILE* file = fopen("/proc/self/statm", "r");
+	if(!file)
+		return -1;
+	int n = fscanf(file, "%li %li", &size, &resident);
+	fclose(file);
+	if(n != 2)
+		return -1;
+	return double(resident) * sysconf(_SC_PAGESIZE) / (1024 * 1024);
+}
+
+static unsigned int nextPowerOf2(unsigned int minPow, unsigned int x) {
+	unsigned int i = 1 << minPow;
+	while(i < x) i <<= 1;
+	return i;
+}
+
+// the initialized data of the "program file".
+static char sFileData[DATA_LEN];
+
+struct Segment {
+	unsigned int size, reserved, dataBreak;
+	char* mem;
+	unsigned char* protection;
+	bool mapped;
+};
+
+// Core::LoadVM() as it was.
+static void oldLoad(Segment& s, unsigned int dataSize) {
+	s.size = s.reserved = nextPowerOf2(16, dataSize);
+	s.mapped = false;
+	s.mem = (char*)new int[s.size / sizeof(int)];
+	memcpy(s.mem, sFileData, DATA_LEN);
+	memset(s.mem + DATA_LEN, 0, s.size - DATA_LEN);
+	s.protection = new unsigned char[(s.size+7)>>3];
+	memset(s.protection, 0, (s.size+7)>>3);
+	s.dataBreak = s.size;
+}
+
+static void* reserveZeroed(unsigned int size) {
+	void* p = mmap(NULL, size, PROT_READ | PROT_WRITE,
+		MAP_PRIVATE | MAP_ANON | MAP_NORESERVE, -1, 0);
+	return p == MAP_FAILED ? NULL : p;
+}
+
+// Core::LoadVM() with the reservation.
+static void newLoad(Segment& s, unsigned int dataSize) {
+	s.size = nextPowerOf2(16, dataSize);
+	s.reserved = s.size > RESERVE ? s.size : RESERVE;
+	s.mapped = true;
+	s.mem = (char*)reserveZeroed(s.reserved);
+	memcpy(s.mem, sFileData, DATA_LEN);
+	s.protection = (unsigned char*)reserveZeroed((s.reserved+7)>>3);
+	s.dataBreak = (dataSize + GROW_GRANULARITY - 1) & ~(GROW_GRANULARITY - 1);
+}
+
+static void unload(Segment& s) {
+	if(s.mapped) {
+		munmap(s.mem, s.reserved);
+		munmap(s.protection, (s.reserved+7)>>3);
+	} else {
+		delete[] (int*)s.mem;
+		delete[] s.protection;
+	}
+}
+
+// maHeapGrow(): the heap's memory, in the new case. The old runtime
+// can't grow, so the old program's heap is in its declared data.
+static char* heapGrow(Segment& s, unsigned int size) {
+	if(s.dataBreak > s.reserved || size > s.reserved - s.dataBreak)
+		return NULL;
+	char* p = s.mem + s.dataBreak;
+	s.dataBreak += size;
+	if(s.dataBreak > s.size)
+		s.size = nextPowerOf2(16, s.dataBreak);
+	return p;
+}
+
+// maHeapRelease(), on the whole pages of the range.
+static void heapRelease(char* ptr, unsigned int size) {
+	size_t mask = sysconf(_SC_PAGESIZE) - 1;
+	size_t start = ((size_t)ptr + mask) & ~mask;
+	size_t end = ((size_t)ptr + size) & ~mask;
+	if(end > start)
+		madvise((void*)start, end - start, MADV_DONTNEED);
+}
+
+struct Result {
+	double load, loadedMB, usedMB, freedMB;
+	unsigned int checksum;
+};
+
+static Result run(bool lazy, unsigned int dataSize) {
+	Result r;
+	double base = residentMB();
+	Segment s;
+	clock_t start = clock();
+	if(lazy)
+		newLoad(s, dataSize);
+	else
+		oldLoad(s, dataSize);
+	r.load = seconds(start);
+	r.loadedMB = residentMB() - base;
+
+	// the stack, at the top of the declared data.
+	memset(s.mem + dataSize - STACK_SIZE, 1, STACK_SIZE);
+	// with no room left to grow, the heap is in the declared data.
+	char* heap = NULL;
+	if(lazy)
+		heap = heapGrow(s, HEAP_USED);
+	if(!heap)
+		heap = s.mem + DATA_LEN;
+	for(int i=0; i<HEAP_USED; i += 64)
+		heap[i] = (char)nextRandom();
+	r.usedMB = residentMB() - base;
+	r.checksum = 0;
+	for(int i=0; i<HEAP_USED; i += 4096)
+		r.checksum += (unsigned char)heap[i];
+
+	// free() of a large block; only the new tlsf releases it.
+	if(lazy)
+		heapRelease(heap + 8, HEAP_USED - 8);
+	r.freedMB = residentMB() - base;
+
+	unload(s);
+	return r;
+}
+
+static bool bench(unsigned int megabytes) {
+	unsigned int dataSize = megabytes * 1024 * 1024;
+	if(dataSize < DATA_LEN + HEAP_USED + STACK_SIZE) {
+		printf("The data must be at least %i MB.\n",
+			(DATA_LEN + HEAP_USED + STACK_SIZE) / (1024 * 1024) + 1);
+		return false;
+	}
+	sSeed = 1;
+	Result old = run(false, dataSize);
+	sSeed = 1;
+	Result lazy = run(true, dataSize);
+	if(old.checksum != lazy.checksum) {
+		printf("The heaps differ: 0x%08x, 0x%08x.\n", old.checksum, lazy.checksum);
+		return false;
+	}
+	printf("%5u MB of data: load old %8.3f ms, new %6.3f ms;"
+		" resident after load old %7.1f MB, new %5.1f MB;"
+		" used old %7.1f MB, new %5.1f MB; freed old %7.1f MB, new %5.1f MB\n",
+		megabytes, old.load * 1000, lazy.load * 1000,
+		old.loadedMB, lazy.loadedMB, old.usedMB, lazy.usedMB, old.freedMB, lazy.freedMB);
+	return true;
+}
+
+int main(int argc, const char** argv) {
+	for(int i=0; i<DATA_LEN; i++)
+		sFileData[i] = (char)nextRandom();
+	if(argc > 1) {
+		for(int i=1; i<argc; i++) {
+			int n = atoi(argv[i]);
+			if(n < 1) {
+				printf("Usage: datasegmentbench [megabytes...]\n");
+				return 1;
+			}
+			if(!bench(n))
+				return 1;
+		}
+		return 0;
+	}
+	for(unsigned int n = 16; n <= 1024; n *= 4) {
+		if(!bench(n))
+			return 1;
+	}
+	return 0;
+}
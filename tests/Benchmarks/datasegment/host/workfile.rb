@@ -0,0 +1,14 @@
+#!/usr/bin/ruby
+
+# Host build of the data segment benchmark. It has its own copies of the
+# runtime's allocation code; Core.cpp can't be built without a runtime.
+
+require File.expand_path('../../../../rules/exe.rb')
+
+work = ExeWork.new
+work.instance_eval do
+	@SOURCES = ["."]
+	@NAME = "datasegmentbench"
+end
+
+work.invoke
@@ -0,0 +1,136 @@
+/* Copyright 2013 David Axmark
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+	http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+// Line-oriented fprintf() and fgets() workloads through newlib.
+// Each is run with stdio's own buffering, and unbuffered, so that every line
+// reaches the file descriptor layer in machine.c.
+// For comparison, the unbuffered workloads are then replayed with the
+// maFile call sequences that machine.c used before it had positional
+// calls and descriptor buffers.
+// Prints time, bytes/s and the number of maFile calls for each.
+
+#include <ma.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#define LINES 5000
+#define PATH "/fileio-bench.txt"
+
+// defined in machine.c.
+int __mosync_file_calls(void);
+
+static int sLineLen[LINES];
+static int sBytes;
+
+static void report(const char* name, int start, int calls) {
+	int ms = maGetMilliSecondCount() - start;
+	printf("%-22s %5i ms %8i B/s %6i calls\n", name, ms,
+		ms > 0 ? (int)((long long)sBytes * 1000 / ms) : 0, calls);
+}
+
+static void writeLines(const char* name, const char* mode, int buffered) {
+	int start = maGetMilliSecondCount();
+	int calls = __mosync_file_calls();
+	FILE* f = fopen(PATH, mode);
+	if(!buffered)
+		setvbuf(f, NULL, _IONBF, 0);
+	sBytes = 0;
+	for(int i = 0; i < LINES; i++) {
+		sLineLen[i] = fprintf(f, "%i,%i,row %i of the benchmark\n", i, i * 7, i);
+		sBytes += sLineLen[i];
+	}
+	fclose(f);
+	report(name, start, __mosync_file_calls() - calls);
+}
+
+static void readLines(const char* name, int buffered) {
+	char line[256];
+	int start = maGetMilliSecondCount();
+	int calls = __mosync_file_calls();
+	FILE* f = fopen(PATH, "r");
+	if(!buffered)
+		setvbuf(f, NULL, _IONBF, 0);
+	sBytes = 0;
+	while(fgets(line, sizeof(line), f))
+		sBytes += strlen(line);
+	fclose(f);
+	report(name, start, __mosync_file_calls() - calls);
+}
+
+// the old append write: tell, size, seek to the end, write.
+static void replayAppend(MAHandle h) {
+	char line[256];
+	int start = maGetMilliSecondCount();
+	int calls = 0;
+	sBytes = 0;
+	for(int i = 0; i < LINES; i++) {
+		int len = sprintf(line, "%i,%i,row %i of the benchmark\n", i, i * 7, i);
+		maFileTell(h);
+		maFileSize(h);
+		maFileSeek(h, 0, MA_SEEK_END);
+		maFileWrite(h, line, len);
+		calls += 4;
+		sBytes += len;
+	}
+	report("append, old calls", start, calls);
+}
+
+// the old read: size, tell and read, for each byte that unbuffered
+// stdio asks for.
+static void replayRead(MAHandle h) {
+	char c;
+	int start = maGetMilliSecondCount();
+	int calls = 0;
+	maFileSeek(h, 0, MA_SEEK_SET);
+	sBytes = 0;
+	while(1) {
+		int size, tell;
+		size = maFileSize(h);
+		tell = maFileTell(h);
+		calls += 2;
+		if(tell >= size)
+			break;
+		maFileRead(h, &c, 1);
+		calls++;
+		sBytes++;
+	}
+	report("fgets, old calls", start, calls);
+}
+
+int main(void) {
+	char path[1024];
+	MAHandle h;
+
+	maGetSystemProperty("mosync.path.local", path, sizeof(path));
+	chroot(path);
+	printf("%i lines\n", LINES);
+
+	writeLines("fprintf", "w", 1);
+	readLines("fgets", 1);
+	writeLines("fprintf unbuffered", "w", 0);
+	writeLines("append unbuffered", "a", 0);
+	readLines("fgets unbuffered", 0);
+
+	strcat(path, PATH + 1);
+	h = maFileOpen(path, MA_ACCESS_READ_WRITE);
+	replayAppend(h);
+	replayRead(h);
+	maFileDelete(h);
+	maFileClose(h);
+
+	maWait(0);
+	return 0;
+}
@@ -0,0 +1,150 @@
+/* Copyright 2013 David Axmark
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+	http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+// Lists a directory tree of DIRS directories with FILES files each,
+// with the size and date of every file, the way a file manager would:
+// first with maFileListNext() followed by maFileOpen(), maFileSize() and
+// maFileDate() for each file, recursing by hand, and then with a lazy
+// maFileListStartRecursive() and maFileListNextBatch().
+// Then reads the top directory with readdir(), which uses the batched calls.
+// Prints the time and the number of syscalls for each, and checks that
+// they found the same files.
+
+#include <ma.h>
+#include <stdio.h>
+#include <string.h>
+#include <dirent.h>
+
+#define DIRS 20
+#define FILES 500
+#define ROOT "/filelist-bench/"
+
+static int sCalls;
+static int sCount;
+static int sTotalSize;
+
+static void report(const char* name, int start) {
+	printf("%-26s %5i ms %6i calls %6i files %9i bytes\n", name,
+		maGetMilliSecondCount() - start, sCalls, sCount, sTotalSize);
+}
+
+static void createFile(const char* path, int size) {
+	char data[64];
+	MAHandle h = maFileOpen(path, MA_ACCESS_READ_WRITE);
+	if(maFileExists(h) == 0) {
+		maFileCreate(h);
+		memset(data, 'x', sizeof(data));
+		maFileWrite(h, data, size % sizeof(data));
+	}
+	maFileClose(h);
+}
+
+static void createTree(void) {
+	char path[256];
+	createFile(ROOT, 0);
+	for(int d = 0; d < DIRS; d++) {
+		sprintf(path, ROOT "dir%i/", d);
+		createFile(path, 0);
+		for(int f = 0; f < FILES; f++) {
+			sprintf(path, ROOT "dir%i/file%i.dat", d, f);
+			createFile(path, d + f);
+		}
+	}
+}
+
+// the old way: one call per name, four per file for its size and date.
+static void listByName(const char* dir) {
+	char name[256];
+	char path[512];
+	MAHandle list = maFileListStart(dir, "*", MA_FL_SORT_NONE);
+	sCalls++;
+	for(;;) {
+		int len = maFileListNext(list, name, sizeof(name));
+		sCalls++;
+		if(len <= 0)
+			break;
+		sprintf(path, "%s%s", dir, name);
+		if(name[len-1] == '/') {
+			listByName(path);
+		} else {
+			MAHandle h = maFileOpen(path, MA_ACCESS_READ);
+			sTotalSize += maFileSize(h);
+			maFileDate(h);
+			maFileClose(h);
+			sCalls += 4;
+			sCount++;
+		}
+	}
+	maFileListClose(list);
+	sCalls++;
+}
+
+static void listBatched(const char* dir) {
+	static int buf[1024];
+	MAHandle list = maFileListStartRecursive(dir, "*",
+		MA_FL_SORT_NONE | MA_FL_FLAG_LAZY, 16);
+	sCalls++;
+	for(;;) {
+		const char* p = (const char*)buf;
+		int count = maFileListNextBatch(list, buf, sizeof(buf), MA_FL_INFO_SIZE | MA_FL_INFO_DATE);
+		sCalls++;
+		if(count <= 0)
+			break;
+		for(int i = 0; i < count; i++) {
+			const MAFileListEntry* e = (const MAFileListEntry*)p;
+			if(e->type == MA_FL_TYPE_FILE) {
+				sTotalSize += e->size;
+				sCount++;
+			}
+			p += e->entrySize;
+		}
+	}
+	maFileListClose(list);
+	sCalls++;
+}
+
+int MAMain(void) {
+	int start, count, size;
+	DIR* dir;
+	dirent* d;
+
+	createTree();
+
+	sCalls = sCount = sTotalSize = 0;
+	start = maGetMilliSecondCount();
+	listByName(ROOT);
+	report("maFileListNext + maFile*", start);
+	count = sCount;
+	size = sTotalSize;
+
+	sCalls = sCount = sTotalSize = 0;
+	start = maGetMilliSecondCount();
+	listBatched(ROOT);
+	report("maFileListNextBatch", start);
+	if(count != sCount || size != sTotalSize)
+		printf("MISMATCH\n");
+
+	sCount = 0;
+	start = maGetMilliSecondCount();
+	dir = opendir(ROOT "dir0");
+	while((d = readdir(dir)) != NULL)
+		sCount++;
+	closedir(dir);
+	printf("%-26s %5i ms %6i files\n", "readdir", maGetMilliSecondCount() - start, sCount);
+	if(sCount != FILES)
+		printf("MISMATCH\n");
+
+	return 0;
+}
@@ -0,0 +1,15 @@
+#!/usr/bin/ruby
+
+require File.expand_path('../../../../rules/mosync_exe.rb')
+
+work = PipeExeWork.new
+work.instance_eval do
+	@SOURCES = ["."]
+	@NAME = "FileListBench"
+end
+
+Targets.setup
+
+raise unless(USE_NEWLIB)
+
+work.invoke
@@ -0,0 +1,346 @@
+/* Copyright 2013 David Axmark
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+	http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+// Measures how MAP's GeoPointLayer draws and picks points, before and
+// after GeoPointIndex, without a screen.
+//
+// The points are spread around CITIES cities, with some in between.
+// For each magnification, the viewport is panned for FRAMES frames
+// around one of the cities, and PICKS random pixels are picked.
+// The old layer projects every point when the magnification changes,
+// then draws every point and scans every point to pick one.
+// The new one queries the index for the viewport, or the picked pixel.
+// "Drawing" calls a renderer that only counts.
+// The index's hits are checked against a scan of all points.
+//
+// Usage: geopointbench [points...]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <time.h>
+#include <vector>
+
+#include "GeoPointIndex.h"
+
+using namespace MAP;
+
+#define CITIES 50
+#define FRAMES 50
+#define PICKS 1000
+#define WIDTH 480
+#define HEIGHT 800
+#define MARKER_SIZE 16
+#define CLUSTER_SIZE 64
+
+static double seconds(clock_t start) {
+	return double(clock() - start) / CLOCKS_PER_SEC;
+}
+
+static unsigned int sSeed;
+
+static int nextRandom() {
+	sSeed = sSeed * 1103515245 + 12345;
+	return (int)((sSeed >> 1) & 0x3fffffff);
+}
+
+static double nextDouble() {
+	return nextRandom() / double(0x40000000);
+}
+
+// LonLat::toPixels(), without the MoSync headers.
+static const double PI = 3.14159265358979323846;
+static const double InvInitialResolution = 256 / (2.0 * PI * 6378137.09);
+static const double OriginShift = PI * 6378137.09;
+
+static void toPixels(double lon, double lat, int magnification, int& x, int& y) {
+	double meterX = lon * OriginShift / 180.0;
+	double meterY = log(tan((90.0 + lat) * PI / 360.0)) * OriginShift / PI;
+	double invres = pow(2.0, magnification) * InvInitialResolution;
+	x = (int)((meterX + OriginShift) * invres + 0.5f);
+	y = (int)((meterY + OriginShift) * invres + 0.5f);
+}
+
+struct Point {
+	double lon, lat;
+};
+
+class Renderer {
+public:
+	int items;
+	virtual ~Renderer() {}
+	virtual void renderItem(int item, int x, int y) { items++; }
+	virtual void renderCluster(int item, int count, int x, int y) { items++; }
+};
+
+struct Viewport {
+	int magnification;
+	// global pixel at the center of the viewport.
+	int cx, cy;
+	void toViewport(int x, int y, int& vx, int& vy) const {
+		vx = x - cx + WIDTH / 2;
+		vy = -(y - cy) + HEIGHT / 2;
+	}
+	void toWorld(int vx, int vy, int& x, int& y) const {
+		x = vx - WIDTH / 2 + cx;
+		y = -(vy - HEIGHT / 2) + cy;
+	}
+};
+
+static bool hitTest(int x, int y, int px, int py) {
+	int half = MARKER_SIZE / 2;
+	return abs(x - px) < MARKER_SIZE && abs(y - py) < MARKER_SIZE &&
+		px >= x - half && px < x - half + MARKER_SIZE &&
+		py >= y - half && py < y - half + MARKER_SIZE;
+}
+
+// GeoPointLayer as it was: each point caches its pixel at the last
+// magnification it was drawn at.
+class OldLayer {
+public:
+	struct Item {
+		Point p;
+		int magnification, x, y;
+	};
+	std::vector<Item> items;
+
+	OldLayer(const std::vector<Point>& points) {
+		for(size_t i=0; i<points.size(); i++) {
+			Item item = { points[i], -1, 0, 0 };
+			items.push_back(item);
+		}
+	}
+	void pixel(Item& item, int magnification) {
+		if(item.magnification != magnification) {
+			toPixels(item.p.lon, item.p.lat, magnification, item.x, item.y);
+			item.magnification = magnification;
+		}
+	}
+	void draw(const Viewport& v, Renderer& r) {
+		for(size_t i=0; i<items.size(); i++) {
+			pixel(items[i], v.magnification);
+			int vx, vy;
+			v.toViewport(items[i].x, items[i].y, vx, vy);
+			r.renderItem(i, vx, vy);
+		}
+	}
+	int pick(const Viewport& v, int px, int py) {
+		int selected = -1;
+		for(size_t i=0; i<items.size(); i++) {
+			pixel(items[i], v.magnification);
+			int vx, vy;
+			v.toViewport(items[i].x, items[i].y, vx, vy);
+			if(hitTest(vx, vy, px, py))
+				selected = i;
+		}
+		return selected;
+	}
+};
+
+// GeoPointLayer with the index.
+class NewLayer {
+public:
+	GeoPointIndex index;
+	Vector<GeoPointHit> hits;
+
+	NewLayer(const std::vector<Point>& points) {
+		for(size_t i=0; i<points.size(); i++) {
+			int x, y;
+			toPixels(points[i].lon, points[i].lat, GeoPointIndex::ProjectionMagnification, x, y);
+			index.add(x, y);
+		}
+		index.build();
+	}
+	void findVisible(const Viewport& v, int clusterSize) {
+		int left, top, right, bottom;
+		v.toWorld(0, 0, left, top);
+		v.toWorld(WIDTH, HEIGHT, right, bottom);
+		left -= MARKER_SIZE; top += MARKER_SIZE;
+		right += MARKER_SIZE; bottom -= MARKER_SIZE;
+		if(clusterSize > 0)
+			index.cluster(v.magnification, left, bottom, right, top, clusterSize, hits);
+		else
+			index.query(v.magnification, left, bottom, right, top, hits);
+	}
+	void draw(const Viewport& v, Renderer& r, int clusterSize) {
+		findVisible(v, clusterSize);
+		for(int i=0; i<hits.size(); i++) {
+			int vx, vy;
+			v.toViewport(hits[i].x, hits[i].y, vx, vy);
+			if(hits[i].count > 1)
+				r.renderCluster(hits[i].item, hits[i].count, vx, vy);
+			else
+				r.renderItem(hits[i].item, vx, vy);
+		}
+	}
+	int pick(const Viewport& v, int px, int py) {
+		int x, y;
+		v.toWorld(px, py, x, y);
+		index.query(v.magnification, x - MARKER_SIZE, y - MARKER_SIZE,
+			x + MARKER_SIZE, y + MARKER_SIZE, hits);
+		int selected = -1;
+		for(int i=0; i<hits.size(); i++) {
+			int vx, vy;
+			v.toViewport(hits[i].x, hits[i].y, vx, vy);
+			if(hitTest(vx, vy, px, py))
+				selected = hits[i].item;
+		}
+		return selected;
+	}
+	// the number of points in the viewport, by scanning them all.
+	int scan(const Viewport& v) {
+		int left, top, right, bottom;
+		v.toWorld(0, 0, left, top);
+		v.toWorld(WIDTH, HEIGHT, right, bottom);
+		left -= MARKER_SIZE; top += MARKER_SIZE;
+		right += MARKER_SIZE; bottom -= MARKER_SIZE;
+		int n = 0;
+		for(int i=0; i<index.size(); i++) {
+			int x, y;
+			index.getPixel(i, v.magnification, x, y);
+			if(x >= left && x <= right && y >= bottom && y <= top)
+				n++;
+		}
+		return n;
+	}
+};
+
+static std::vector<Point> makePoints(int n) {
+	std::vector<Point> cities;
+	for(int i=0; i<CITIES; i++) {
+		Point c = { nextDouble() * 340 - 170, nextDouble() * 120 - 55 };
+		cities.push_back(c);
+	}
+	std::vector<Point> points;
+	for(int i=0; i<n; i++) {
+		Point p;
+		if(nextRandom() % 5 == 0) {
+			p.lon = nextDouble() * 360 - 180;
+			p.lat = nextDouble() * 140 - 70;
+		} else {
+			// roughly normal, with a spread of about a degree.
+			const Point& c(cities[nextRandom() % CITIES]);
+			double d = (nextDouble() + nextDouble() + nextDouble() - 1.5) * 2;
+			double a = nextDouble() * 2 * PI;
+			p.lon = c.lon + d * cos(a);
+			p.lat = c.lat + d * sin(a);
+		}
+		points.push_back(p);
+	}
+	return points;
+}
+
+static bool run(int n) {
+	static const int magnifications[] = { 1, 3, 8, 12, 16 };
+	sSeed = 1;
+	std::vector<Point> points = makePoints(n);
+	printf("%i points:\n", n);
+
+	clock_t start = clock();
+	OldLayer old(points);
+	double oldBuild = seconds(start);
+	start = clock();
+	NewLayer idx(points);
+	printf("  build: old %.3f s, new %.3f s\n", oldBuild, seconds(start));
+
+	Renderer r;
+	for(size_t m=0; m<sizeof(magnifications)/sizeof(int); m++) {
+		Viewport v;
+		v.magnification = magnifications[m];
+		toPixels(points[0].lon, points[0].lat, v.magnification, v.cx, v.cy);
+		int startX = v.cx;
+
+		// panning; the old layer reprojects in the first frame.
+		r.items = 0;
+		start = clock();
+		for(int f=0; f<FRAMES; f++) {
+			v.cx = startX + f * 5;
+			old.draw(v, r);
+		}
+		double oldDraw = seconds(start) * 1000 / FRAMES;
+		int oldItems = r.items / FRAMES;
+
+		r.items = 0;
+		start = clock();
+		for(int f=0; f<FRAMES; f++) {
+			v.cx = startX + f * 5;
+			idx.draw(v, r, 0);
+		}
+		double newDraw = seconds(start) * 1000 / FRAMES;
+		int newItems = r.items / FRAMES;
+		for(int f=0; f<FRAMES; f += 7) {
+			v.cx = startX + f * 5;
+			idx.findVisible(v, 0);
+			int found = idx.hits.size();
+			if(found != idx.scan(v)) {
+				printf("Index found %i points, scan found %i.\n", found, idx.scan(v));
+				return false;
+			}
+		}
+
+		r.items = 0;
+		start = clock();
+		for(int f=0; f<FRAMES; f++) {
+			v.cx = startX + f * 5;
+			idx.draw(v, r, CLUSTER_SIZE);
+		}
+		double clusterDraw = seconds(start) * 1000 / FRAMES;
+		int clusters = r.items / FRAMES;
+
+		// picking; both layers get the same pixels.
+		unsigned int seed = sSeed;
+		int oldFound = 0;
+		start = clock();
+		for(int i=0; i<PICKS; i++) {
+			if(old.pick(v, nextRandom() % WIDTH, nextRandom() % HEIGHT) >= 0)
+				oldFound++;
+		}
+		double oldPick = seconds(start) * 1e6 / PICKS;
+		sSeed = seed;
+		int newFound = 0;
+		start = clock();
+		for(int i=0; i<PICKS; i++) {
+			if(idx.pick(v, nextRandom() % WIDTH, nextRandom() % HEIGHT) >= 0)
+				newFound++;
+		}
+		double newPick = seconds(start) * 1e6 / PICKS;
+
+		printf("  magnification %2i: draw old %8.3f ms (%i items), new %7.3f ms (%i items),"
+			" clustered %7.3f ms (%i), pick old %9.1f us, new %6.2f us (%i/%i found)\n",
+			v.magnification, oldDraw, oldItems, newDraw, newItems, clusterDraw, clusters,
+			oldPick, newPick, oldFound, newFound);
+	}
+	return true;
+}
+
+int main(int argc, const char** argv) {
+	if(argc > 1) {
+		for(int i=1; i<argc; i++) {
+			int n = atoi(argv[i]);
+			if(n < 1) {
+				printf("Usage: geopointbench [points...]\n");
+				return 1;
+			}
+			if(!run(n))
+				return 1;
+		}
+		return 0;
+	}
+	for(int n = 1000; n <= 1000000; n *= 10) {
+		if(!run(n))
+			return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,18 @@
+#!/usr/bin/ruby
+
+# Host build of the MAP GeoPointLayer benchmark. Only GeoPointIndex is
+# compiled from MAP; the layer itself needs a map viewport.
+
+require File.expand_path('../../../../rules/exe.rb')
+
+MAP_DIR = "../../../../libs/MAP"
+
+work = ExeWork.new
+work.instance_eval do
+	@SOURCES = ["."]
+	@EXTRA_SOURCEFILES = ["#{MAP_DIR}/GeoPointIndex.cpp"]
+	@EXTRA_INCLUDES = [MAP_DIR, "../../common/host/stub", "../../../../libs"]
+	@NAME = "geopointbench"
+end
+
+work.invoke
@@ -0,0 +1,269 @@
+/* Copyright 2013 David Axmark
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+	http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+// Steps Hybris rooms with moving items and compares the collisions
+// reported by Room::update with the ones found by testing every pair
+// of items, the way Room did before it had a spatial hash. Prints the
+// time per step for both, with and without collision masks.
+//
+// Usage: hybrisbench [steps]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include <MAUtil/Vector.h>
+#include "Room.h"
+
+using namespace Hybris;
+using namespace MAUtil;
+
+// Sprite images. Each frame is a filled circle, smaller for later frames.
+struct Image {
+	int size;
+	int numFrames;
+};
+static const Image sImages[] = {
+	{ 16, 4 },
+	{ 24, 4 },
+	{ 32, 4 },
+};
+static const int sImageCount = sizeof(sImages) / sizeof(Image);
+
+MAExtent maGetImageSize(MAHandle image) {
+	const Image& i = sImages[image - 1];
+	return EXTENT(i.size * i.numFrames, i.size);
+}
+
+void maGetImageData(MAHandle image, void* dst, const MARect* srcRect, int scanlength) {
+	const Image& i = sImages[image - 1];
+	int frame = srcRect->left / i.size;
+	int r = i.size / 2 - frame * 2;
+	int* pixels = (int*)dst;
+	for(int y = 0; y < srcRect->height; y++) {
+		for(int x = 0; x < srcRect->width; x++) {
+			int dx = 2 * x + 1 - i.size, dy = 2 * y + 1 - i.size;
+			bool inside = dx * dx + dy * dy <= 4 * r * r;
+			pixels[y * scanlength + x] = inside ? 0xff808080 : 0x00808080;
+		}
+	}
+}
+
+void maDrawImageRegion(MAHandle image, const MARect* srcRect, const MAPoint2d* dstPoint, int transformMode) {
+}
+
+struct Collision {
+	int itemId1, spriteId1, itemId2, spriteId2;
+};
+
+class Recorder : public CollisionListener {
+public:
+	void onItemCollision(int itemId1, int spriteId1, int itemId2, int spriteId2) {
+		Collision c = { itemId1, spriteId1, itemId2, spriteId2 };
+		collisions.add(c);
+	}
+	Vector<Collision> collisions;
+};
+
+// The items of the room as the old Room kept them: found by linear
+// search on every move, and tested pair by pair in update().
+class BruteForceRoom {
+public:
+	~BruteForceRoom() {
+		for(int i = 0; i < items.size(); i++)
+			delete items[i];
+	}
+
+	void makeItem(int id, Sprite* sprite, int x, int y) {
+		items.add(new Item(id, sprite, x, y));
+	}
+
+	Item* findItem(int id) {
+		for(int i = 0; i < items.size(); i++)
+			if(items[i]->getId() == id)
+				return items[i];
+		return NULL;
+	}
+
+	void killItem(int id) {
+		for(int i = 0; i < items.size(); i++) {
+			if(items[i]->getId() == id) {
+				delete items[i];
+				items.remove(i);
+				return;
+			}
+		}
+	}
+
+	void update(Recorder& recorder) {
+		for(int i = 0; i < items.size(); i++) {
+			for(int j = i + 1; j < items.size(); j++) {
+				if(items[i]->collideWith(items[j])) {
+					recorder.onItemCollision(items[i]->getId(), items[i]->getSprite()->getId(),
+						items[j]->getId(), items[j]->getSprite()->getId());
+				}
+			}
+		}
+	}
+
+	Vector<Item*> items;
+};
+
+struct Motion {
+	int dx, dy;
+};
+
+static double seconds(clock_t start) {
+	return double(clock() - start) / CLOCKS_PER_SEC;
+}
+
+static bool sameCollisions(const Recorder& a, const Recorder& b) {
+	if(a.collisions.size() != b.collisions.size())
+		return false;
+	for(int i = 0; i < a.collisions.size(); i++) {
+		const Collision& x = a.collisions[i];
+		const Collision& y = b.collisions[i];
+		if(x.itemId1 != y.itemId1 || x.spriteId1 != y.spriteId1 ||
+			x.itemId2 != y.itemId2 || x.spriteId2 != y.spriteId2)
+			return false;
+	}
+	return true;
+}
+
+// Turns items around at the edges of the world.
+static void bounce(BruteForceRoom& bf, Vector<Motion>& motion, int worldSize) {
+	for(int i = 0; i < bf.items.size(); i++) {
+		Motion& m = motion[i];
+		const MAUtil::Point& p = bf.items[i]->getPosition();
+		if(p.x + m.dx < 0 || p.x + m.dx >= worldSize) m.dx = -m.dx;
+		if(p.y + m.dy < 0 || p.y + m.dy >= worldSize) m.dy = -m.dy;
+	}
+}
+
+static void move(Room& room, const Vector<Motion>& motion) {
+	for(int i = 0; i < motion.size(); i++) {
+		const Motion& m = motion[i];
+		int id = 1000 + i;
+		if(m.dx < 0) room.moveItemLeft(id, -m.dx); else room.moveItemRight(id, m.dx);
+		if(m.dy < 0) room.moveItemUp(id, -m.dy); else room.moveItemDown(id, m.dy);
+		room.setItemFrame(id, (i + m.dx) & 3);
+	}
+}
+
+static void move(BruteForceRoom& bf, const Vector<Motion>& motion) {
+	for(int i = 0; i < motion.size(); i++) {
+		const Motion& m = motion[i];
+		Item* item = bf.findItem(1000 + i);
+		if(m.dx < 0) item->moveLeft(-m.dx); else item->moveRight(m.dx);
+		if(m.dy < 0) item->moveUp(-m.dy); else item->moveDown(m.dy);
+		item->setFrame((i + m.dx) & 3);
+	}
+}
+
+static bool run(int count, int steps, bool masks) {
+	Sprite* sprites[sImageCount];
+	for(int i = 0; i < sImageCount; i++) {
+		sprites[i] = new Sprite(i + 1, sImages[i].size, sImages[i].size, sImages[i].numFrames, i + 1);
+		if(masks)
+			sprites[i]->createCollisionMask();
+	}
+
+	// About ten items per 256x256 area, so density is the same for all counts.
+	int worldSize = 1;
+	while(worldSize * worldSize < count * 6554)
+		worldSize++;
+
+	Room room(1);
+	Recorder recorder;
+	room.addCollisionListener(&recorder);
+	room.setCellSize(32);
+	BruteForceRoom bf;
+	Recorder bfRecorder;
+	Vector<Motion> motion;
+
+	srand(count);
+	for(int i = 0; i < sImageCount; i++)
+		room.addSprite(sprites[i]);
+	for(int i = 0; i < count; i++) {
+		int x = rand() % worldSize, y = rand() % worldSize;
+		Sprite* sprite = sprites[i % sImageCount];
+		room.makeItem(1000 + i, sprite->getId(), x, y);
+		bf.makeItem(1000 + i, sprite, x, y);
+		Motion m = { rand() % 9 - 4, rand() % 9 - 4 };
+		motion.add(m);
+	}
+
+	// Check every step against the brute force result.
+	bool same = true;
+	double gridTime = 0, bfTime = 0;
+	int collisions = 0;
+	for(int step = 0; step < steps; step++) {
+		bounce(bf, motion, worldSize);
+
+		clock_t start = clock();
+		move(room, motion);
+		room.update();
+		gridTime += seconds(start);
+
+		start = clock();
+		move(bf, motion);
+		bf.update(bfRecorder);
+		bfTime += seconds(start);
+
+		collisions += recorder.collisions.size();
+		same = same && sameCollisions(recorder, bfRecorder);
+		recorder.collisions.clear();
+		bfRecorder.collisions.clear();
+	}
+
+	// Kill every other item, in random order, and check that the rest
+	// still collide in the same order.
+	Vector<int> victims;
+	for(int i = 0; i < count; i += 2)
+		victims.add(1000 + i);
+	for(int i = victims.size() - 1; i > 0; i--) {
+		int j = rand() % (i + 1);
+		int t = victims[i]; victims[i] = victims[j]; victims[j] = t;
+	}
+	clock_t start = clock();
+	for(int i = 0; i < victims.size(); i++)
+		room.killItem(victims[i]);
+	double killTime = seconds(start);
+	for(int i = 0; i < victims.size(); i++)
+		bf.killItem(victims[i]);
+	room.update();
+	bf.update(bfRecorder);
+	same = same && sameCollisions(recorder, bfRecorder);
+
+	printf("%6i items %-8s %8.3f ms/step spatial hash %10.3f ms/step pairwise %8i collisions %8.3f us/kill %s\n",
+		count, masks ? "masks" : "boxes", 1000 * gridTime / steps, 1000 * bfTime / steps,
+		collisions, 1000000 * killTime / victims.size(), same ? "match" : "MISMATCH");
+
+	for(int i = 0; i < sImageCount; i++)
+		delete sprites[i];
+	return same;
+}
+
+int main(int argc, char** argv) {
+	int steps = argc > 1 ? atoi(argv[1]) : 10;
+	static const int counts[] = { 100, 1000, 3000, 10000 };
+	bool same = true;
+	for(int i = 0; i < (int)(sizeof(counts) / sizeof(int)); i++) {
+		int n = counts[i] >= 3000 ? (steps + 4) / 5 : steps;
+		same = run(counts[i], n, false) && same;
+		same = run(counts[i], n, true) && same;
+	}
+	return same ? 0 : 1;
+}
@@ -0,0 +1,26 @@
+#!/usr/bin/ruby
+
+# Host build of the Hybris collision benchmark.
+
+require File.expand_path('../../../../rules/exe.rb')
+
+work = ExeWork.new
+work.instance_eval do
+	@SOURCES = ["."]
+	@EXTRA_SOURCEFILES = [
+		"../../../../libs/Hybris/Room.cpp",
+		"../../../../libs/Hybris/Item.cpp",
+		"../../../../libs/Hybris/Sprite.cpp",
+		"../../../../libs/MAUtil/Geometry.cpp",
+		"../../../../libs/MAUtil/HashMap.cpp",
+		"../../../../libs/MAUtil/String.cpp",
+		"../../../../libs/MAUtil/RefCounted.cpp",
+		"../../../../libs/kazlib/hash.c",
+	]
+	@EXTRA_INCLUDES = ["../../common/host/stub", "../../../../libs", "../../../../libs/Hybris"]
+	# Without NDEBUG, kazlib verifies the whole table on every change.
+	@EXTRA_CFLAGS = " -DNDEBUG"
+	@NAME = "hybrisbench"
+end
+
+work.invoke
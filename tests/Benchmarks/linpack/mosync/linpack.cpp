@@ -13,7 +13,7 @@
 ** - Defaults to double precision.
 ** - Averages ROLLed and UNROLLed performance.
 ** - User selectable array sizes.
-** - Automatically does enough repetitions to take at least 10 CPU seconds.
+** - Repetitions are calibrated and sampled by MATest::Benchmark.
 ** - Prints machine precision.
 ** - ANSI prototyping.
 **
@@ -30,8 +30,7 @@
 #include <conprint.h>
 #include <limits.h>
 #include <maassert.h>
-#include "headers/benchdb.h"
-#include "buildinfo.h"
+#include <MATest/BenchmarkRunner.h>
 
 #define SP
 
@@ -53,7 +52,6 @@ typedef float	REAL;
 typedef double	REAL;
 #endif
 
-static REAL linpack	 (long nreps,int arsize);
 static void matgen	 (REAL *a,int lda,int n,REAL *b,REAL *norma);
 static void dgefa	 (REAL *a,int lda,int n,int *ipvt,int *info,int roll);
 static void dgesl	 (REAL *a,int lda,int n,int *ipvt,REAL *b,int job,int roll);
@@ -64,168 +62,75 @@ static void daxpy_ur (int n,REAL da,REAL *dx,int incx,REAL *dy,int incy);
 static REAL ddot_ur	 (int n,REAL *dx,int incx,REAL *dy,int incy);
 static void dscal_ur (int n,REAL da,REAL *dx,int incx);
 static int	idamax	 (int n,REAL *dx,int incx);
-static REAL second	 (void);
 //static void print_matrix(float *mat, int i_dim, int j_dim);
 
 static void *mempool;
 
-#include <MAUtil/Moblet.h>
-#include <conprint.h>
-
-using namespace MAUtil;
-
 /**
- * Need this moblet to make an environment (which is needed to make http-requests using a httpconn-listener)
- * This is used to send the results to the benchmark database
+ * One iteration generates a system of equations and solves it,
+ * with the rolled or the unrolled BLAS routines. An iteration is
+ * ops floating point operations, so the MFLOPS are about ops divided
+ * by the median in microseconds. The time includes matgen.
  */
-class DBMoblet : public MAUtil::Moblet
+class LinpackCase : public MATest::BenchmarkCase
 {
 public:
-	/**
-	 * Initialize the application in the constructor.
-	 */
-	DBMoblet(BenchResult & br)
-	{
-		/*
-		 * Read build info from buildinfo.h
-		 */
-
-		br.git_hash = BUILDVAR2;
-		br.revision = BUILDVAR1;
-
-		BenchDBConnector * bdbc = new BenchDBConnector(br);
-		printf("bdbc: %p\n", bdbc);
-		//this->mRun = false; //make the Moblet::run() func return so that the benchmark can quit without user interaction
-		//this->exit();
-	}
-
-};
-
-int g_startTime;
-int MAMain ( void )
-{
-
-
-
-	//char	  buf[80];
-	int		arsize;
-	long	arsize2d,memreq,nreps;
-	size_t	malloc_arg;
+	LinpackCase(const MAUtil::String& name,int arsize,int rolled) :
+		MATest::BenchmarkCase(name),
+		lda(arsize),
+		n(arsize/2),
+		roll(rolled)
+		{
+		a=(REAL *)mempool;
+		b=a+(long)arsize*(long)arsize;
+		ipvt=(int *)&b[arsize];
+		}
 
-	g_startTime = maGetMilliSecondCount( );
-	//while (1)
+	virtual void run(int iterations)
 		{
-		/*
-		printf("Enter array size (q to quit) [200]:	 ");
-		fgets(buf,79,stdin);
-		if (buf[0]=='q' || buf[0]=='Q')
-			break;
-		if (buf[0]=='\0' || buf[0]=='\n')
-			arsize=200;
-		else
-			arsize=atoi(buf);
-		*/
-		arsize = 200;
-		arsize/=2;
-		arsize*=2;
-		if (arsize<10)
+		REAL norma;
+		int	 info;
+
+		for (int i=0;i<iterations;i++)
 			{
-			printf("Too small.\n");
-			//continue;
+			matgen(a,lda,n,b,&norma);
+			dgefa(a,lda,n,ipvt,&info,roll);
+			dgesl(a,lda,n,ipvt,b,0,roll);
 			}
-		arsize2d = (long)arsize*(long)arsize;
-		memreq=arsize2d*sizeof(REAL)+(long)arsize*sizeof(REAL)+(long)arsize*sizeof(int);
-		printf("Memory required:  %ldK.\n",(memreq+512L)>>10);
-		malloc_arg=(size_t)memreq;
-		/*if (malloc_arg!=memreq || (mempool=malloc(malloc_arg))==NULL)
-			{
-			printf("Not enough memory available for given array size.\n\n");
-			//continue;
-			}*/
-		mempool=malloc(malloc_arg);
-		printf("\n\nLINPACK benchmark, %s precision.\n",PREC);
-		//printf("Machine precision:  %d digits.\n",BASE10DIG);
-		printf("Array size %d X %d.\n",arsize,arsize);
-		printf("Average rolled and unrolled performance:\n\n");
-		printf("	Reps Time(s) DGEFA	 DGESL	OVERHEAD	MFLOPS\n");
-		printf("----------------------------------------------------\n");
-		nreps=4;
-//		  linpack(nreps, arsize);
-		while (linpack(nreps,arsize)<10.)
-			nreps*=2;
-		free(mempool);
-		printf("Finished!\n");
 		}
 
-		//FREEZE;
-		return 0;
-	}
-
-
-static REAL linpack(long nreps,int arsize)
+private:
+	REAL *a,*b;
+	int	 *ipvt,lda,n,roll;
+};
 
+int MAMain ( void )
 	{
-	REAL  *a,*b;
-	REAL   norma,t1,kflops,tdgesl,tdgefa,totalt,toverhead,ops;
-	int	  *ipvt,n,info,lda;
-	long   i,arsize2d;
+	int		arsize;
+	long	arsize2d,memreq;
+	REAL	n,ops;
 
-	lda = arsize;
-	n = arsize/2;
+	arsize = 200;
 	arsize2d = (long)arsize*(long)arsize;
-	ops=((2.0*n*n*n)/3.0+2.0*n*n);
-	a=(REAL *)mempool;
-	b=a+arsize2d;
-	ipvt=(int *)&b[arsize];
-	tdgesl=0;
-	tdgefa=0;
-	totalt=second();
-	for (i=0;i<nreps;i++)
+	memreq=arsize2d*sizeof(REAL)+(long)arsize*sizeof(REAL)+(long)arsize*sizeof(int);
+	printf("Memory required:  %ldK.\n",(memreq+512L)>>10);
+	mempool=malloc((size_t)memreq);
+	if (mempool==NULL)
 		{
-		matgen(a,lda,n,b,&norma);
-		t1 = second();
-		dgefa(a,lda,n,ipvt,&info,1);
-		tdgefa += second()-t1;
-		t1 = second();
-		dgesl(a,lda,n,ipvt,b,0,1);
-		tdgesl += second()-t1;
+		printf("Not enough memory available for given array size.\n\n");
+		return 1;
 		}
-	for (i=0;i<nreps;i++)
-		{
-		matgen(a,lda,n,b,&norma);
-		t1 = second();
-		dgefa(a,lda,n,ipvt,&info,0);
-		tdgefa += second()-t1;
-		t1 = second();
-		dgesl(a,lda,n,ipvt,b,0,0);
-		tdgesl += second()-t1;
-		}
-	totalt=second()-totalt;
-	if (totalt<0.5 || tdgefa+tdgesl<0.2)
-		return(0.);
-	kflops=2.*nreps*ops/(1000.*(tdgefa+tdgesl));
-	toverhead=totalt-tdgefa-tdgesl;
-	if (tdgefa<0.)
-		tdgefa=0.;
-	if (tdgesl<0.)
-		tdgesl=0.;
-	if (toverhead<0.)
-		toverhead=0.;
-	printf("%8ld %6.2f %6.2f%% %6.2f%% %6.2f%%	%9.3f\n",
-			nreps,totalt,100.*tdgefa/totalt,
-			100.*tdgesl/totalt,100.*toverhead/totalt,
-			kflops/1000.0);
-	if(totalt > 10.){ //publish the result in the benchmark database when we get a run that lasts for more than 10 seconds
-		BenchResult br;
-
-		br.benchmark = "linpack"; //specify the name of this benchmark
-		br.mflops = kflops/1000.0; //the result to pass
-
-
-		MAUtil::Moblet::run(new DBMoblet(br));
-
-	}
-	return(totalt);
+	n=arsize/2;
+	ops=((2.0*n*n*n)/3.0+2.0*n*n);
+	printf("\n\nLINPACK benchmark, %s precision.\n",PREC);
+	printf("Array size %d X %d.\n",arsize,arsize);
+	printf("%.0f operations per iteration, MFLOPS = %.0f / median.\n\n",ops,ops);
+
+	MATest::BenchmarkRunner *runner = new MATest::BenchmarkRunner("linpack");
+	runner->addBenchmark(new LinpackCase("linpack_rolled",arsize,1));
+	runner->addBenchmark(new LinpackCase("linpack_unrolled",arsize,0));
+	runner->runBenchmarks();
+	return 0;
 	}
 
 
@@ -946,8 +851,3 @@ static int idamax(int n,REAL *dx,int incx)
 		printf("%f ", a[i]);
 	}
 }*/
-
-static REAL second(void)
-{
-	return (maGetMilliSecondCount( )-g_startTime)/1000.0f;
-}
@@ -0,0 +1,14 @@
+#!/usr/bin/ruby
+
+require File.expand_path('../../../../rules/mosync_exe.rb')
+
+work = PipeExeWork.new
+work.instance_eval do
+	@SOURCES = []
+	@EXTRA_SOURCEFILES = ["linpack.cpp"]
+	@LIBRARIES = ["mautil", "matest"]
+	@NAME = "linpack"
+	@EXTRA_EMUFLAGS = " -noscreen"
+end
+
+work.invoke
@@ -6,7 +6,7 @@ work = PipeExeWork.new
 work.instance_eval do
 	@SOURCES = []
 	@EXTRA_SOURCEFILES = ["linpack.cpp"]
-	@LIBRARIES = ["mautil", "benchdb"]
+	@LIBRARIES = ["mautil", "matest"]
 	@NAME = "linpack"
 	@PACK_PARAMETERS = ' --ios-bundle-id "com.MoSync.linpack" --ios-sdk iphoneos4.3 --ios-xcode-target Release -i /Applications/MoSync/etc/default.icon'
 end
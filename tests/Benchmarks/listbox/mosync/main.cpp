@@ -0,0 +1,165 @@
+/* Copyright 2013 David Axmark
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+	http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+// Scrolls lists of 100 to 100000 items of different heights, in a ListBox
+// with one widget per item and in a VirtualListBox that only has widgets
+// for the visible items. Prints the time to build each list, the average
+// time per frame, and the heap used by the list.
+//
+// The ListBox is skipped for lists that don't fit in the heap.
+
+#include <ma.h>
+#include <maheap.h>
+#include <conprint.h>
+#include <MAUtil/Graphics.h>
+#include <MAUI/ListBox.h>
+#include <MAUI/VirtualListBox.h>
+
+using namespace MAUI;
+
+#define FRAMES 200
+#define SCROLL_STEP 7
+
+// the ListBox needs about 150 bytes per item.
+#define MAX_LISTBOX_ITEMS 10000
+
+static int itemExtent(int index) {
+	return 16 + (index * 7) % 24;
+}
+
+class Row : public Widget {
+public:
+	Row(int index, int height) : Widget(0, 0, 0, height, NULL), mIndex(index) {
+		setDrawBackground(false);
+	}
+
+	void setIndex(int index) {
+		mIndex = index;
+		requestRepaint();
+	}
+
+protected:
+	void drawWidget() {
+		maSetColor(isSelected() ? 0xffffff : 0x203040 + (mIndex & 0xff) * 0x10101 / 4);
+		Gfx_fillRect(0, 0, paddedBounds.width, paddedBounds.height - 1);
+	}
+
+	int mIndex;
+};
+
+class RowAdapter : public ListBoxAdapter {
+public:
+	RowAdapter(int count) : mCount(count), mCreated(0) {}
+
+	int getItemCount() {
+		return mCount;
+	}
+
+	int getItemExtent(int index) {
+		return itemExtent(index);
+	}
+
+	Widget* getItemWidget(int index, Widget* recycled) {
+		if(recycled) {
+			((Row*)recycled)->setIndex(index);
+			return recycled;
+		}
+		mCreated++;
+		return new Row(index, itemExtent(index));
+	}
+
+	int created() const {
+		return mCreated;
+	}
+
+private:
+	int mCount;
+	int mCreated;
+};
+
+static int heapUsed() {
+	return (int)(heapTotalMemory() - heapFreeMemory());
+}
+
+static void frame(Widget* w) {
+	w->update();
+	w->draw(true);
+	maUpdateScreen();
+}
+
+static void benchListBox(int count, int width, int height) {
+	if(count > MAX_LISTBOX_ITEMS) {
+		printf("ListBox        %6i: skipped\n", count);
+		return;
+	}
+	int heap = heapUsed();
+	int start = maGetMilliSecondCount();
+	ListBox* list = new ListBox(0, 0, width, height, NULL,
+		ListBox::LBO_VERTICAL, ListBox::LBA_NONE, false);
+	for(int i = 0; i < count; i++) {
+		list->add(new Row(i, itemExtent(i)));
+	}
+	int build = maGetMilliSecondCount() - start;
+	int used = heapUsed() - heap;
+
+	// ListBox only scrolls by moving the selection.
+	start = maGetMilliSecondCount();
+	for(int f = 0; f < FRAMES; f++) {
+		list->selectNextItem(false);
+		frame(list);
+	}
+	int time = maGetMilliSecondCount() - start;
+	delete list;
+
+	printf("ListBox        %6i: build %5i ms, %4i us/frame, heap %8i\n",
+		count, build, time * 1000 / FRAMES, used);
+}
+
+static void benchVirtualListBox(int count, int width, int height) {
+	int heap = heapUsed();
+	int start = maGetMilliSecondCount();
+	RowAdapter* adapter = new RowAdapter(count);
+	VirtualListBox* list = new VirtualListBox(0, 0, width, height, NULL);
+	list->setAdapter(adapter);
+	int build = maGetMilliSecondCount() - start;
+	int used = heapUsed() - heap;
+
+	start = maGetMilliSecondCount();
+	for(int f = 0; f < FRAMES; f++) {
+		list->setScrollOffset(list->getScrollOffset() + SCROLL_STEP);
+		frame(list);
+	}
+	int time = maGetMilliSecondCount() - start;
+	int created = adapter->created();
+	delete list;
+	delete adapter;
+
+	printf("VirtualListBox %6i: build %5i ms, %4i us/frame, heap %8i, %i widgets\n",
+		count, build, time * 1000 / FRAMES, used, created);
+}
+
+extern "C" int MAMain() {
+	MAExtent scr = maGetScrSize();
+	int width = EXTENT_X(scr), height = EXTENT_Y(scr);
+	Gfx_clearMatrix();
+
+	static const int counts[] = { 100, 1000, 10000, 100000 };
+	for(unsigned i = 0; i < sizeof(counts) / sizeof(counts[0]); i++) {
+		benchListBox(counts[i], width, height);
+		benchVirtualListBox(counts[i], width, height);
+	}
+	maWait(0);
+	return 0;
+}
@@ -0,0 +1,381 @@
+/* Copyright 2013 David Axmark
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+	http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+// Compares MAUtil's listener containers with the ones they replaced,
+// for 10 to 50000 registered handles or listeners.
+//
+// Connections: sets a listener for every handle, like Environment::setConnListener(),
+// dispatches events to random handles, like Environment::fireConnEvent(),
+// and removes the listeners. Every tenth event makes its listener move to
+// another handle, from within the dispatch. The old way kept the listeners in
+// a ListenerSet that was searched for the handle; the new way is the
+// HandleTable that Environment uses now.
+// Listeners: adds listeners to a ListenerSet, fires it, with a tenth of the
+// listeners removing themselves while it runs, and removes the rest in
+// random order. The old ListenerSet searched for the listener to remove.
+//
+// The old containers are skipped for more than OLD_MAX handles,
+// where they take minutes.
+//
+// Usage: listenerbench [max handles]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include <MAUtil/ListenerSet.h>
+#include <MAUtil/HandleTable.h>
+
+using namespace MAUtil;
+
+#define EVENTS 200000
+#define FIRES 20
+#define OLD_MAX 10000
+
+static double seconds(clock_t start) {
+	return double(clock() - start) / CLOCKS_PER_SEC;
+}
+
+static unsigned int sSeed;
+
+static int nextRandom() {
+	sSeed = sSeed * 1103515245 + 12345;
+	return (int)((sSeed >> 1) & 0x3fffffff);
+}
+
+// ListenerSet as it was: every add and remove searches the whole set.
+template<typename T> class OldListenerSet {
+private:
+	struct Combo {
+		T* listener;
+		int refCount;
+	};
+
+public:
+	class iterator {
+	public:
+		T& operator*() { return *mVec[mIndex].listener; }
+		T* operator->() { return mVec[mIndex].listener; }
+		iterator& operator++() {
+			do {
+				mIndex++;
+				if(mIndex == mCount)
+					break;
+			} while(mVec[mIndex].refCount == 0);
+			return *this;
+		}
+		bool hasNext() { return mIndex < mCount; }
+
+		iterator(Vector<Combo>& vec, int index) : mVec(vec), mCount(vec.size()), mIndex(index) {
+			if(index < mCount) if(vec[index].refCount == 0)
+				++(*this);
+		}
+	private:
+		Vector<Combo>& mVec;
+		const int mCount;
+		int mIndex;
+	};
+
+	OldListenerSet() : mRunning(false), mUpdateRequired(false) {}
+
+	iterator begin() {
+		return iterator(mVec, 0);
+	}
+
+	void add(T* t) {
+		templateVector_each(Combo, i, mVec) {
+			if(i->listener == t) {
+				i->refCount = 1;
+				return;
+			}
+		}
+		Combo c = { t, 1 };
+		mVec.add(c);
+	}
+
+	void remove(T* t) {
+		templateVector_each(Combo, i, mVec) {
+			if(i->listener == t) {
+				if(mRunning) {
+					i->refCount = 0;
+					mUpdateRequired = true;
+				} else {
+					mVec.remove(i);
+				}
+				return;
+			}
+		}
+	}
+
+	void setRunning(bool r=true) {
+		mRunning = r;
+		if(mRunning == false && mUpdateRequired) {
+			int s = mVec.size();
+			templateVector_each(Combo, itr, mVec) {
+				if(itr->refCount <= 0) {
+					*itr = mVec[--s];
+				}
+			}
+			mVec.resize(s);
+			mUpdateRequired = false;
+		}
+	}
+
+	int size() const {
+		return mVec.size();
+	}
+
+private:
+	bool mRunning, mUpdateRequired;
+	Vector<Combo> mVec;
+};
+
+// A connection listener that moves to another handle on every tenth event.
+class Conn {
+public:
+	Conn() : handle(0), events(0) {}
+	template<class Table> void connEvent(Table& table, int h) {
+		events++;
+		if(events % 10 == 0) {
+			table.removeConnListener(h);
+			table.setConnListener(h + 1000000, this);
+		}
+	}
+	int handle;
+	int events;
+};
+
+// Environment's connection listeners as they were.
+class OldConnTable {
+public:
+	void setConnListener(int conn, Conn* cl) {
+		removeConnListener(conn);
+		cl->handle = conn;
+		mListeners.add(cl);
+	}
+	void removeConnListener(int conn) {
+		for(OldListenerSet<Conn>::iterator itr = mListeners.begin(); itr.hasNext(); ++itr) {
+			if(itr->handle == conn) {
+				mListeners.remove(&*itr);
+			}
+		}
+	}
+	bool fireConnEvent(int h) {
+		bool found = false;
+		mListeners.setRunning(true);
+		for(OldListenerSet<Conn>::iterator itr = mListeners.begin(); itr.hasNext(); ++itr) {
+			if(itr->handle == h) {
+				itr->connEvent(*this, h);
+				found = true;
+				break;
+			}
+		}
+		mListeners.setRunning(false);
+		return found;
+	}
+	int size() const { return mListeners.size(); }
+private:
+	OldListenerSet<Conn> mListeners;
+};
+
+// Environment's connection listeners as they are.
+class ConnTable {
+public:
+	void setConnListener(int conn, Conn* cl) {
+		mListeners.set(conn, cl);
+	}
+	void removeConnListener(int conn) {
+		mListeners.remove(conn);
+	}
+	bool fireConnEvent(int h) {
+		Conn* cl = mListeners.get(h);
+		if(!cl)
+			return false;
+		cl->connEvent(*this, h);
+		return true;
+	}
+	int size() const { return mListeners.size(); }
+private:
+	HandleTable<Conn> mListeners;
+};
+
+// Returns the number of events that found their listener, or -1 on failure.
+template<class Table> static int connections(int nHandles, double& set, double& fire, double& remove) {
+	Table table;
+	Conn* conns = new Conn[nHandles];
+	int* handles = new int[nHandles];
+	for(int i = 0; i < nHandles; i++)
+		handles[i] = i + 1;
+
+	clock_t start = clock();
+	for(int i = 0; i < nHandles; i++)
+		table.setConnListener(handles[i], &conns[i]);
+	set = seconds(start);
+	if(table.size() != nHandles)
+		return -1;
+
+	sSeed = 1;
+	int found = 0;
+	start = clock();
+	for(int i = 0; i < EVENTS; i++) {
+		if(table.fireConnEvent(handles[nextRandom() % nHandles]))
+			found++;
+	}
+	fire = seconds(start);
+
+	if(table.size() != nHandles)
+		return -1;
+
+	start = clock();
+	for(int i = 0; i < nHandles; i++) {
+		table.removeConnListener(handles[i]);
+		table.removeConnListener(handles[i] + 1000000);
+	}
+	remove = seconds(start);
+	if(table.size() != 0)
+		return -1;
+
+	delete[] conns;
+	delete[] handles;
+	return found;
+}
+
+// A listener that removes itself when called, if it is one of every ten.
+class Listener {
+public:
+	void fired() {
+		calls++;
+		if(oneShot)
+			set->remove(this);
+	}
+	int calls;
+	bool oneShot;
+	ListenerSet<Listener>* set;
+};
+
+class OldListener {
+public:
+	void fired() {
+		calls++;
+		if(oneShot)
+			set->remove(this);
+	}
+	int calls;
+	bool oneShot;
+	OldListenerSet<OldListener>* set;
+};
+
+// Returns the number of calls, or -1 on failure.
+template<class L, class Set> static int listeners(int nListeners, double& add, double& fire, double& remove) {
+	Set set(false);
+	L* ls = new L[nListeners];
+	int* order = new int[nListeners];
+	for(int i = 0; i < nListeners; i++) {
+		ls[i].calls = 0;
+		ls[i].oneShot = i % 10 == 0;
+		ls[i].set = &set;
+		order[i] = i;
+	}
+	sSeed = 2;
+	for(int i = nListeners - 1; i > 0; i--) {
+		int j = nextRandom() % (i + 1);
+		int t = order[i];
+		order[i] = order[j];
+		order[j] = t;
+	}
+
+	clock_t start = clock();
+	for(int i = 0; i < nListeners; i++)
+		set.add(&ls[i]);
+	add = seconds(start);
+
+	start = clock();
+	for(int f = 0; f < FIRES; f++) {
+		// ListenerSet_fire, for either set.
+		set.setRunning(true);
+		for(typename Set::iterator i = set.begin(); i.hasNext(); ++i)
+			i->fired();
+		set.setRunning(false);
+	}
+	fire = seconds(start);
+	if(set.size() != nListeners - (nListeners + 9) / 10)
+		return -1;
+
+	start = clock();
+	for(int i = 0; i < nListeners; i++)
+		set.remove(&ls[order[i]]);
+	remove = seconds(start);
+	if(set.size() != 0)
+		return -1;
+
+	int calls = 0;
+	for(int i = 0; i < nListeners; i++)
+		calls += ls[i].calls;
+	delete[] ls;
+	delete[] order;
+	return calls;
+}
+
+// OldListenerSet has no shouldDelete flag.
+template<typename T> class OldSet : public OldListenerSet<T> {
+public:
+	OldSet(bool) {}
+};
+
+int main(int argc, const char** argv) {
+	int maxHandles = 50000;
+	if(argc > 1)
+		maxHandles = atoi(argv[1]);
+
+	printf("%i events per test, %i fires per test\n", EVENTS, FIRES);
+	for(int n = 10; n <= maxHandles; n = (n * 10 > maxHandles && n < maxHandles) ? maxHandles : n * 10) {
+		double set, fire, remove;
+		printf("%i handles:\n", n);
+
+		if(n <= OLD_MAX) {
+			int oldFound = connections<OldConnTable>(n, set, fire, remove);
+			if(oldFound < 0) { printf("Old connections failed.\n"); return 1; }
+			printf("  old connections: set %.3f s, fire %.3f s, remove %.3f s\n", set, fire, remove);
+			if(connections<ConnTable>(n, set, fire, remove) != oldFound) {
+				printf("Connections failed.\n");
+				return 1;
+			}
+		} else if(connections<ConnTable>(n, set, fire, remove) < 0) {
+			printf("Connections failed.\n");
+			return 1;
+		}
+		printf("  connections:     set %.3f s, fire %.3f s, remove %.3f s\n", set, fire, remove);
+
+		// the old ListenerSet lost listeners when it removed the ones
+		// that removed themselves while it ran, so its calls aren't checked.
+		if(n <= OLD_MAX) {
+			if(listeners<OldListener, OldSet<OldListener> >(n, set, fire, remove) < 0) {
+				printf("Old listeners failed.\n");
+				return 1;
+			}
+			printf("  old listeners:   add %.3f s, fire %.3f s, remove %.3f s\n", set, fire, remove);
+		}
+		int oneShots = (n + 9) / 10;
+		if(listeners<Listener, ListenerSet<Listener> >(n, set, fire, remove) != n + (FIRES - 1) * (n - oneShots)) {
+			printf("Listeners failed.\n");
+			return 1;
+		}
+		printf("  listeners:       add %.3f s, fire %.3f s, remove %.3f s\n", set, fire, remove);
+
+		if(n == maxHandles)
+			break;
+	}
+	return 0;
+}
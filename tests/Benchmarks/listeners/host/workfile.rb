@@ -0,0 +1,14 @@
+#!/usr/bin/ruby
+
+# Host build of the MAUtil listener benchmark.
+
+require File.expand_path('../../../../rules/exe.rb')
+
+work = ExeWork.new
+work.instance_eval do
+	@SOURCES = ["."]
+	@EXTRA_INCLUDES = ["../../common/host/stub", "../../../../libs"]
+	@NAME = "listenerbench"
+end
+
+work.invoke
@@ -0,0 +1,199 @@
+/* Copyright 2013 David Axmark
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+	http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+// Generates a bundle of DIRS * FILES_PER_DIR small files, in the version 2
+// (directory tree) and version 3 (path index) formats, the same way the
+// Bundle tool writes them. Mounts each with MAFS and logs the time taken
+// to mount it, and to open, read and close every file in it.
+
+#include <ma.h>
+#include <maheap.h>
+#include <mastring.h>
+#include <mavsprintf.h>
+#include <conprint.h>
+#include <maassert.h>
+#include <MAFS/File.h>
+
+#define DIRS 64
+#define FILES_PER_DIR 64
+#define FILE_SIZE 64
+
+#define MAGIC2 0x22345678
+#define MAGIC3 0x32345678
+
+static char* sBuf;
+static int sPos;
+
+static void putInt(int i) {
+	memcpy(sBuf + sPos, &i, 4);
+	sPos += 4;
+}
+
+static void putByte(int b) {
+	sBuf[sPos++] = (char)b;
+}
+
+static void putString(const char* s) {
+	int len = strlen(s) + 1;
+	memcpy(sBuf + sPos, s, len);
+	sPos += len;
+}
+
+static void dirName(char* buf, int d) {
+	sprintf(buf, "dir%02i", d);
+}
+
+static void fileName(char* buf, int f) {
+	sprintf(buf, "file%04i.txt", f);
+}
+
+static void filePath(char* buf, int d, int f) {
+	sprintf(buf, "dir%02i/file%04i.txt", d, f);
+}
+
+static void putHeader(int magic, int startOfData) {
+	putInt(magic);
+	putInt(16);
+	putInt(startOfData);
+	putInt(0);
+}
+
+static void putData(void) {
+	int i;
+	for(i = 0; i < DIRS * FILES_PER_DIR; i++) {
+		memset(sBuf + sPos, i & 0xff, FILE_SIZE);
+		sPos += FILE_SIZE;
+	}
+}
+
+static void putTree(void) {
+	char name[32];
+	int d, f;
+	putByte(0);
+	putString("Root");
+	putInt(DIRS);
+	for(d = 0; d < DIRS; d++) {
+		putByte(0);
+		dirName(name, d);
+		putString(name);
+		putInt(FILES_PER_DIR);
+		for(f = 0; f < FILES_PER_DIR; f++) {
+			putByte(1);
+			fileName(name, f);
+			putString(name);
+			putInt((d * FILES_PER_DIR + f) * FILE_SIZE);
+			putInt(FILE_SIZE);
+		}
+	}
+}
+
+// The paths are generated in sorted order, each directory before its files.
+static void putIndex(void) {
+	char path[32];
+	int d, f;
+	int str = 0;
+	putInt(DIRS * (FILES_PER_DIR + 1));
+	for(d = 0; d < DIRS; d++) {
+		dirName(path, d);
+		putInt(str);
+		putInt(0);
+		putInt(0);
+		putInt(0);
+		str += strlen(path) + 1;
+		for(f = 0; f < FILES_PER_DIR; f++) {
+			filePath(path, d, f);
+			putInt(str);
+			putInt(1);
+			putInt((d * FILES_PER_DIR + f) * FILE_SIZE);
+			putInt(FILE_SIZE);
+			str += strlen(path) + 1;
+		}
+	}
+	for(d = 0; d < DIRS; d++) {
+		dirName(path, d);
+		putString(path);
+		for(f = 0; f < FILES_PER_DIR; f++) {
+			filePath(path, d, f);
+			putString(path);
+		}
+	}
+}
+
+static MAHandle createBundle(int version) {
+	MAHandle h;
+	int startOfData;
+
+	// sized generously, the paths are less than 32 bytes each.
+	sBuf = (char*)malloc(DIRS * FILES_PER_DIR * (FILE_SIZE + 64) + 1024);
+	sPos = 16;
+	if(version == 2)
+		putTree();
+	else
+		putIndex();
+	startOfData = sPos;
+	putData();
+	sPos = 0;
+	putHeader(version == 2 ? MAGIC2 : MAGIC3, startOfData);
+	sPos = startOfData + DIRS * FILES_PER_DIR * FILE_SIZE;
+
+	h = maCreatePlaceholder();
+	maCreateData(h, sPos);
+	maWriteData(h, sBuf, 0, sPos);
+	free(sBuf);
+	return h;
+}
+
+static void run(int version) {
+	char path[32];
+	unsigned char data[FILE_SIZE];
+	MAHandle bundle = createBundle(version);
+	int start, mountMs, errors = 0;
+	int d, f;
+
+	start = maGetMilliSecondCount();
+	setCurrentFileSystem(bundle, 0);
+	mountMs = maGetMilliSecondCount() - start;
+
+	start = maGetMilliSecondCount();
+	for(d = 0; d < DIRS; d++) {
+		for(f = 0; f < FILES_PER_DIR; f++) {
+			MA_FILE* file;
+			filePath(path, d, f);
+			file = fopen(path, "r");
+			if(!file) {
+				errors++;
+				continue;
+			}
+			if(fread(data, 1, FILE_SIZE, file) != FILE_SIZE ||
+				data[0] != ((d * FILES_PER_DIR + f) & 0xff))
+			{
+				errors++;
+			}
+			fclose(file);
+		}
+	}
+	lprintfln("version %i: mount %i ms, open all %i ms, %i files, %i errors",
+		version, mountMs, maGetMilliSecondCount() - start, DIRS * FILES_PER_DIR, errors);
+
+	freeCurrentFileSystem();
+	maDestroyObject(bundle);
+}
+
+int MAMain(void) {
+	run(2);
+	run(3);
+	lprintfln("done");
+	FREEZE;
+}
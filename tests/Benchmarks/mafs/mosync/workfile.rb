@@ -0,0 +1,13 @@
+#!/usr/bin/ruby
+
+require File.expand_path('../../../../rules/mosync_exe.rb')
+
+work = PipeExeWork.new
+work.instance_eval do
+	@SOURCES = ["."]
+	@LIBRARIES = ["mafs"]
+	@EXTRA_LINKFLAGS = " -heapsize=2048000"
+	@NAME = "MAFSBench"
+end
+
+work.invoke
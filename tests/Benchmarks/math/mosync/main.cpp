@@ -0,0 +1,85 @@
+/* Copyright 2013 David Axmark
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+	http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+// Times the math functions through MAStd, which uses the runtime's native
+// implementations where available, against the portable fdlibm code,
+// and per-element calls against the batched array functions.
+
+#include <ma.h>
+#include <madmath.h>
+#include <conprint.h>
+
+extern "C" double __ieee754_pow(double, double);
+extern "C" double __ieee754_log(double);
+extern "C" double __ieee754_atan2(double, double);
+
+#define N 1000
+#define ROUNDS 20
+
+static double sSrc[N], sDst[N];
+static float sSrcf[N], sDstf[N];
+static float sPoints[N*3];
+
+// keeps the results alive, so that the loops can't be optimised away.
+static double sSink;
+
+#define TIME(name, ...) { \
+	int start = maGetMilliSecondCount(); \
+	for(int r = 0; r < ROUNDS; r++) { __VA_ARGS__; } \
+	printf("%-16s %5i ms\n", name, maGetMilliSecondCount() - start); }
+
+extern "C" int MAMain() {
+	for(int i = 0; i < N; i++) {
+		sSrc[i] = (i + 1) * 0.01;
+		sSrcf[i] = (float)sSrc[i];
+		sPoints[i*3] = sSrcf[i];
+		sPoints[i*3+1] = -sSrcf[i];
+		sPoints[i*3+2] = 1.0f;
+	}
+	const float matrix[12] = {
+		0.8f, -0.6f, 0, 1,
+		0.6f, 0.8f, 0, 2,
+		0, 0, 1, 3 };
+
+	printf("native math: %s\n", mathIsNative() ? "yes" : "no");
+	printf("%i elements, %i rounds\n", N, ROUNDS);
+
+	TIME("pow fdlibm", for(int i = 0; i < N; i++) sSink += __ieee754_pow(sSrc[i], 1.5));
+	TIME("pow", for(int i = 0; i < N; i++) sSink += pow(sSrc[i], 1.5));
+	TIME("log fdlibm", for(int i = 0; i < N; i++) sSink += __ieee754_log(sSrc[i]));
+	TIME("log", for(int i = 0; i < N; i++) sSink += log(sSrc[i]));
+	TIME("atan2 fdlibm", for(int i = 0; i < N; i++) sSink += __ieee754_atan2(sSrc[i], 0.5));
+	TIME("atan2", for(int i = 0; i < N; i++) sSink += atan2(sSrc[i], 0.5));
+	TIME("sinf", for(int i = 0; i < N; i++) sSink += sinf(sSrcf[i]));
+	TIME("powf", for(int i = 0; i < N; i++) sSink += powf(sSrcf[i], 1.5f));
+
+	TIME("sin per element", for(int i = 0; i < N; i++) sDst[i] = sin(sSrc[i]));
+	TIME("sin batched", mathEvaluate(MA_MATH_FUNC_SIN, sSrc, sDst, N));
+	TIME("sqrtf per elem.", for(int i = 0; i < N; i++) sDstf[i] = sqrtf(sSrcf[i]));
+	TIME("sqrtf batched", mathEvaluatef(MA_MATH_FUNC_SQRT, sSrcf, sDstf, N));
+
+	TIME("transform loop", for(int i = 0; i < N; i++) {
+		float* p = sPoints + i*3;
+		float x = p[0], y = p[1], z = p[2];
+		p[0] = matrix[0]*x + matrix[1]*y + matrix[2]*z + matrix[3];
+		p[1] = matrix[4]*x + matrix[5]*y + matrix[6]*z + matrix[7];
+		p[2] = matrix[8]*x + matrix[9]*y + matrix[10]*z + matrix[11];
+	});
+	TIME("transform batch", mathTransformPointsf(matrix, sPoints, sPoints, N));
+
+	printf("(%i)\n", (int)sSink);
+	maWait(0);
+	return 0;
+}
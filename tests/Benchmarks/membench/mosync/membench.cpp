@@ -32,166 +32,59 @@ limitations under the License.
  */
 
 #include "membench.h"
-#include "buildinfo.h"
 #include <MAUtil/String.h>
-#include <benchdb/benchdb.h>
 
 MemBench::MemBench() {
-	this->bench();
+	mArray = (char*) malloc(100 * sizeof(char));
+	for(int k = 0; k < 100; ++k){
+		mArray[k] = (char)k;
+		mVector.add(k);
+	}
 }
 
 MemBench::~MemBench() {
-
-}
-
-void MemBench::bench() {
-
-	int time;
-	int i;
-
-	/* stand alone test vars */
-	float allocStr10 = 0.0;
-	float allocStr100 = 0.0;
-	float allocVoid1 = 0.0;
-	float allocVoid100 = 0.0;
-	float allocVoid1000 = 0.0;
-	float allocDummy = 0.0;
-	float allocDummyStruct = 0.0;
-	float allocDummyMix = 0.0;
-	float accessArray = 0.0;
-	float accessVector = 0.0;
-	float addVector = 0.0;
-	float accessDummy = 0.0;
-	float accessDummyStruct = 0.0;
-	float accessDummyMix = 0.0;
-
-	/* merged tests vars */
-	float strFlops = 0.0;
-	float mallocFlops = 0.0;
-	float accessFlops = 0.0;
-
-
-
-	printf("Memory Benchmark started");
-
-	//double the amount of test runs until the test take more than RUNNING_TIME to perform
-	for(i = 1; (time = this->heapBench(i, 10, MAUTIL_STRING)) < RUNNING_TIME; i*=2);
-	printf("allocating/freeing %d MAUtil::Strings of capacity 10 ", ALOT*i);
-	printf("Time: %d msecs, %1.2f KMEMOPS.\n", time, (allocStr10 = (float)(ALOT*i)/(float) time));
-	strFlops += (float)(ALOT*i)/(float) time;
-
-
-	for(i = 1; (time = this->heapBench(i, 100, MAUTIL_STRING)) < RUNNING_TIME; i*=2);
-	printf("allocating/freeing %d MAUtil::Strings of capacity: 100 ", ALOT*i);
-	printf("Time: %d msecs, %1.2f KMEMOPS.\n", time, (allocStr100 = (float)(ALOT*i)/(float) time));
-	strFlops += (float)(ALOT*i)/(float) time;
-
-	for(i = 1; (time = this->heapBench(i, 1, MALLOC)) < RUNNING_TIME; i*=2);
-	printf("allocating/freeing %d heap blocks of size 1 using malloc() ", ALOT*i);
-	printf("Time: %d msecs, %1.2f KMEMOPS.\n", time, (allocVoid1 = (float)(ALOT*i)/(float) time));
-	mallocFlops += (float)(ALOT*i)/(float) time;
-
-	for(i = 1; (time = this->heapBench(i, 100, MALLOC)) < RUNNING_TIME; i*=2);
-	printf("allocating/freeing %d heap blocks of size 100 using malloc() ", ALOT*i);
-	printf("Time: %d msecs, %1.2f KMEMOPS.\n", time, (allocVoid100 = (float)(ALOT*i)/(float) time));
-	mallocFlops += (float)(ALOT*i)/(float) time;
-
-	for(i = 1; (time = this->heapBench(i, 1000, MALLOC)) < RUNNING_TIME; i*=2);
-	printf("allocating/freeing %d heap blocks of size 1000 using malloc() ", ALOT*i);
-	printf("Time: %d msecs, %1.2f KMEMOPS.\n", time, (allocVoid1000 = (float)(ALOT*i)/(float) time));
-	mallocFlops += (float)(ALOT*i)/(float) time;
-
-	for(i = 1; (time = this->heapBench(i, -1, DUMMY)) < RUNNING_TIME; i*=2);
-	printf("allocating/freeing %d dummy objects ", ALOT*i);
-	printf("Time: %d msecs, %1.2f KMEMOPS.\n", time, (allocDummy = (float)(ALOT*i)/(float) time));
-	mallocFlops += (float)(ALOT*i)/(float) time;
-
-	for(i = 1; (time = this->heapBench(i, -1, DUMMY_STRUCT)) < RUNNING_TIME; i*=2);
-	printf("allocating/freeing %d dummy structs ", ALOT*i);
-	printf("Time: %d msecs, %1.2f KMEMOPS.\n", time, (allocDummyStruct = (float)(ALOT*i)/(float) time));
-	mallocFlops += (float)(ALOT*i)/(float) time;
-
-	for(i = 1; (time = this->heapBench(i, -1, DUMMY_MIX)) < RUNNING_TIME; i*=2);
-	printf("allocating/freeing %d larger dummy objects ", ALOT*i);
-	printf("Time: %d msecs, %1.2f KMEMOPS.\n", time, (allocDummyMix = (float)(ALOT*i)/(float) time));
-	mallocFlops += (float)(ALOT*i)/(float) time;
-
-	mArray = (char*) malloc(100 * sizeof(char));
-	for(i = 1; (time = this->memAccess(i, 100, ARRAY)) < RUNNING_TIME; i*=2);
-	printf("accessing each element in a char array[100] %d times ", ALOT*i);
-	printf("Time: %d msecs, %1.2f KMEMOPS.\n", time, (accessArray = (float)(ALOT*i)/(float) time));
-	accessFlops += (float)(ALOT*i)/(float) time;
 	free(mArray);
+}
 
-	for(i = 1; (time = this->memAccess(i, 100, VECTOR_ACCESS)) < RUNNING_TIME; i*=2);
-	printf("accessing 100 int:s in a MAUtil::vector<int> %d times ", ALOT*i);
-	printf("Time: %d msecs, %1.2f KMEMOPS.\n", time, (accessVector = (float)(ALOT*i)/(float) time));
-	accessFlops += (float)(ALOT*i)/(float) time;
-
-	for(i = 1; (time = this->memAccess(i, 100, VECTOR_ADD)) < RUNNING_TIME; i*=2);
-	printf("adding 100 int:s to a MAUtil::vector<int> %d times ", ALOT*i);
-	printf("Time: %d msecs, %1.2f KMEMOPS.\n", time, (addVector = (float)(ALOT*i)/(float) time));
-	accessFlops += (float)(ALOT*i)/(float) time;
-
-	for(i = 1; (time = this->memAccess(i, 1, DUMMY_ACCESS)) < RUNNING_TIME; i*=2);
-	printf("DUMMY_ACCESS %d times ", ALOT*i);
-	printf("Time: %d msecs, %1.2f KMEMOPS.\n", time, (accessDummy = (float)(ALOT*i)/(float) time));
-	accessFlops += (float)(ALOT*i)/(float) time;
-
-	for(i = 1; (time = this->memAccess(i, 1, DUMMY_STRUCT_ACCESS)) < RUNNING_TIME; i*=2);
-	printf("DUMMY_STRUCT_ACCESS %d times ", ALOT*i);
-	printf("Time: %d msecs, %1.2f KMEMOPS.\n", time, (accessDummyStruct = (float)(ALOT*i)/(float) time));
-	accessFlops += (float)(ALOT*i)/(float) time;
-
-	for(i = 1; (time = this->memAccess(i, 1, DUMMY_MIX_ACCESS)) < RUNNING_TIME; i*=2);
-	printf("DUMMY_MIX_ACCESS %d times ", ALOT*i);
-	printf("Time: %d msecs, %1.2f KMEMOPS.\n", time, (accessDummyMix = (float)(ALOT*i)/(float) time));
-	accessFlops += (float)(ALOT*i)/(float) time;
-
-	printf("String ops: %1.2f KMEMOPS.\n", strFlops);
-	printf("Malloc ops: %1.2f KMEMOPS.\n", mallocFlops);
-	printf("Mem access ops: %1.2f KMEMOPS.\n", accessFlops);
-	printf("Total: %1.2f KMEMOPS.\n", strFlops + mallocFlops + accessFlops);
-
-	/* Send result to the benchmark database here */
-	/*publish_membench_result("http://127.0.0.1/benchmarks/publish_result.php", "1337", "MoSync", "987123ab", "HTC%20Wildfire",
-	"2", allocStr10, allocStr100, allocVoid1, allocVoid100, allocVoid1000, allocDummy, allocDummyStruct, allocDummyMix,
-	accessArray, accessVector, addVector, accessDummy, accessDummyStruct, accessDummyMix);*/
-
-	BenchResult br;
-
-	//str_alloc_100, alloc_void_1, alloc_void_100, alloc_void_1000, alloc_dummy, alloc_dummy_struct, alloc_dummy_mix,
-	//access_array, access_dummy, access_vector, add_vector, access_dummy_struct, access_dummy_mix;
-
-	br.benchmark = "membench";
-	br.str_alloc_10 = allocStr10;
-	br.str_alloc_100 = allocStr100;
-	br.alloc_dummy = allocDummy;
-	br.alloc_dummy_struct = allocDummyStruct;
-	br.alloc_dummy_mix = allocDummyMix;
-	br.access_array = accessArray;
-	br.access_dummy = accessDummy;
-	br.access_dummy_mix = accessDummyMix;
-	br.access_dummy_struct = accessDummyStruct;
-	br.access_vector = accessVector;
-	br.add_vector = addVector;
-	br.alloc_void_1 = allocVoid1;
-	br.alloc_void_100 = allocVoid100;
-	br.alloc_void_1000 = allocVoid1000;
-
-	br.git_hash = BUILDVAR2;
-	br.revision = BUILDVAR1;
-
-	BenchDBConnector * bdbc = new BenchDBConnector(br);
-	printf("bdbc: %p\n", bdbc);
-
-	//FREEZE;
+/*
+ * Each benchmark is ALOT operations per iteration, so the
+ * median in microseconds is the time for ALOT operations.
+ */
+void MemBench::addBenchmarks(MATest::BenchmarkRunner* runner) {
+
+	/* string ops */
+	runner->addBenchmark(new MemBenchCase("str_alloc_10", this, true, 10, MAUTIL_STRING));
+	runner->addBenchmark(new MemBenchCase("str_alloc_100", this, true, 100, MAUTIL_STRING));
+
+	/* malloc ops */
+	runner->addBenchmark(new MemBenchCase("alloc_void_1", this, true, 1, MALLOC));
+	runner->addBenchmark(new MemBenchCase("alloc_void_100", this, true, 100, MALLOC));
+	runner->addBenchmark(new MemBenchCase("alloc_void_1000", this, true, 1000, MALLOC));
+	runner->addBenchmark(new MemBenchCase("alloc_dummy", this, true, -1, DUMMY));
+	runner->addBenchmark(new MemBenchCase("alloc_dummy_struct", this, true, -1, DUMMY_STRUCT));
+	runner->addBenchmark(new MemBenchCase("alloc_dummy_mix", this, true, -1, DUMMY_MIX));
+
+	/* mem access ops */
+	runner->addBenchmark(new MemBenchCase("access_array", this, false, 100, ARRAY));
+	runner->addBenchmark(new MemBenchCase("access_vector", this, false, 100, VECTOR_ACCESS));
+	runner->addBenchmark(new MemBenchCase("add_vector", this, false, 100, VECTOR_ADD));
+	runner->addBenchmark(new MemBenchCase("access_dummy", this, false, 1, DUMMY_ACCESS));
+	runner->addBenchmark(new MemBenchCase("access_dummy_struct", this, false, 1, DUMMY_STRUCT_ACCESS));
+	runner->addBenchmark(new MemBenchCase("access_dummy_mix", this, false, 1, DUMMY_MIX_ACCESS));
+}
 
+MemBenchCase::MemBenchCase(const MAUtil::String& name, MemBench* bench, bool heap, int size, int testType) :
+	MATest::BenchmarkCase(name), mBench(bench), mHeap(heap), mSize(size), mTestType(testType) {
 }
 
-int MemBench::heapBench(int numRuns, int size, int testType) {
+void MemBenchCase::run(int iterations) {
+	if(mHeap)
+		mBench->heapBench(iterations, mSize, mTestType);
+	else
+		mBench->memAccess(iterations, mSize, mTestType);
+}
 
-	int startTime = currTime();
+void MemBench::heapBench(int numRuns, int size, int testType) {
 
 	switch(testType){
 
@@ -251,13 +144,9 @@ int MemBench::heapBench(int numRuns, int size, int testType) {
 		break;
 
 	}
-	return currTime() - startTime;
-
 }
 
-int MemBench::memAccess(int numRuns, int size, int testType) {
-
-	int startTime = currTime();
+void MemBench::memAccess(int numRuns, int size, int testType) {
 
 	switch(testType){
 
@@ -336,13 +225,4 @@ int MemBench::memAccess(int numRuns, int size, int testType) {
 		break;
 
 	}
-	return currTime() - startTime;
-
-}
-
-/*
- * Wrapper around mosync syscall so that we can have the same call on different platforms
- */
-int MemBench::currTime() {
-	return maGetMilliSecondCount();
 }
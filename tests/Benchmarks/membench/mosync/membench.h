@@ -24,7 +24,8 @@ limitations under the License.
 #define MEMBENCH_H_
 
 #include <MAUtil/String.h>
-#include <MAUtil/Moblet.h>
+#include <MAUtil/Vector.h>
+#include <MATest/BenchmarkRunner.h>
 #include <ma.h>
 #include <conprint.h>
 #include <maassert.h> //give access to FREEZE macro
@@ -32,7 +33,6 @@ limitations under the License.
 #include <maheap.h>
 
 #define ALOT 1024 //used as number of iterations when we want to do a lot of operations
-#define	RUNNING_TIME 1000 //running time per test in msecs
 
 /* Test types */
 #define MAUTIL_STRING 0
@@ -85,21 +85,19 @@ public:
 
 };
 
-class MemBench : public MAUtil::Moblet {
+class MemBench {
 public:
 	MemBench();
 	~MemBench();
 
-	/* start benching! */
-	void bench();
+	/* add the benchmarks to a runner */
+	void addBenchmarks(MATest::BenchmarkRunner* runner);
 
-private:
-
-	int heapBench(int numRuns, int size, int testType);
-	int memAccess(int numRuns, int size, int testType);
+	/* one iteration is ALOT operations */
+	void heapBench(int numRuns, int size, int testType);
+	void memAccess(int numRuns, int size, int testType);
 
-	/* Timer functions */
-	int currTime();
+private:
 
 	/* member variables */
 	char *mArray;
@@ -110,6 +108,22 @@ private:
 
 };
 
+/*
+ * Measures one of the MemBench tests as a benchmark
+ */
+class MemBenchCase : public MATest::BenchmarkCase {
+public:
+	MemBenchCase(const MAUtil::String& name, MemBench* bench, bool heap, int size, int testType);
+
+	virtual void run(int iterations);
+
+private:
+	MemBench* mBench;
+	bool mHeap;
+	int mSize;
+	int mTestType;
+};
+
 
 
 #endif /* MEMBENCH_H_ */
@@ -5,7 +5,7 @@ require File.expand_path(ENV['MOSYNCDIR']+'/rules/mosync_exe.rb')
 work = PipeExeWork.new
 work.instance_eval do
 	@SOURCES = ["."]
-	@LIBRARIES = ["mautil", "benchdb"]
+	@LIBRARIES = ["mautil", "matest"]
 	@NAME = "MemBench"
 	@PACK_PARAMETERS = ' --ios-bundle-id "com.MoSync.MemBench" --ios-sdk iphoneos4.3 --ios-xcode-target Release -i /Applications/MoSync/etc/default.icon'
 end
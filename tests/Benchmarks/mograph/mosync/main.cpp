@@ -0,0 +1,138 @@
+/* Copyright 2013 David Axmark
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+	http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+// Renders a 100x100 bar grid with MoGraph and logs the time per frame,
+// first with static data, then with every bar changing each frame,
+// then zoomed in so that most of the grid is culled.
+// Runs on MoRE with a software GL implementation as well.
+
+#include <ma.h>
+#include <mavsprintf.h>
+#include <MAUtil/GLMoblet.h>
+#include <glm/glm.hpp>
+#include <glm/gtx/transform.hpp>
+#include "MAHeaders.h"
+#include <MoGraph/MoGraph.h>
+
+using namespace MAUtil;
+
+#define GRID 100
+#define FRAMES 100
+
+class BenchMoblet : public GLMoblet
+{
+private:
+	MoGraph::Graph *mGraph;
+	IFont *mFont;
+	float mValues[GRID*GRID];
+	glm::vec4 mColors[GRID*GRID];
+	int mFrame;
+	int mStart;
+
+	void fill(float phase)
+	{
+		for(int j=0; j<GRID; j++)
+		{
+			for(int i=0; i<GRID; i++)
+			{
+				const int id = j*GRID+i;
+				mValues[id] = 2.0f+sin(i*0.3f+phase)+cos(j*0.3f+phase);
+				mColors[id] = glm::vec4((float)i/GRID, 0.0f, (float)j/GRID, 1.0f);
+			}
+		}
+	}
+
+	void report(const char *phase)
+	{
+		int ms = maGetMilliSecondCount()-mStart;
+		MoGraph::BarMgr &bars = mGraph->getScene().getBarMgr();
+		lprintfln("%s: %d frames, %d ms, %d of %d chunks drawn", phase, FRAMES, ms,
+			bars.getDrawnChunks(), bars.getChunkCount());
+		mStart = maGetMilliSecondCount();
+	}
+
+public:
+	BenchMoblet() : GLMoblet(GLMoblet::GL2), mGraph(0), mFont(0), mFrame(0), mStart(0) {}
+
+	virtual ~BenchMoblet()
+	{
+		delete mGraph;
+		delete mFont;
+	}
+
+	void init()
+	{
+		int w = EXTENT_X(maGetScrSize());
+		int h = EXTENT_Y(maGetScrSize());
+		mFont = new BMFont();
+		std::vector<MAHandle> fontTexArray;
+		fontTexArray.push_back(R_BOX_TEXTURE);
+		mFont->Init(R_BOX_FNT, fontTexArray);
+
+		MoGraph::GraphDesc desc;
+		desc.scrWidth = w;
+		desc.scrHeight = h;
+		desc.gridX = GRID;
+		desc.gridZ = GRID;
+		desc.gridYLines = 10;
+		desc.gridStepYLines = 0.5f;
+		desc.gridStepValue = 0.5f;
+		desc.gridDecimals = 1;
+		desc.gridOffsetStartLine = -1;
+		desc.gridOffsetStartValue = -2.0f;
+		desc.bFitScreen = true;
+		desc.flagGridLines = MoGraph::DEFAULT_GRIDS;
+		desc.bUseGridValue = true;
+		desc.font = mFont;
+
+		mGraph = new MoGraph::Graph();
+		if (!mGraph->init(&desc))
+			maPanic(1, "Failed to initiate Graph");
+		fill(0.0f);
+		mGraph->setValues(mValues, GRID*GRID);
+		mGraph->setColors(mColors, GRID*GRID);
+		mStart = maGetMilliSecondCount();
+	}
+
+	void draw()
+	{
+		if (mFrame == FRAMES)
+		{
+			report("static");
+		}
+		else if (mFrame == 2*FRAMES)
+		{
+			report("animated");
+			glm::mat4 zoom = glm::scale(4.0f, 4.0f, 4.0f);
+			mGraph->getScene().setWorldMat(zoom);
+		}
+		else if (mFrame == 3*FRAMES)
+		{
+			report("zoomed");
+			maExit(0);
+		}
+
+		if (mFrame >= FRAMES)
+			fill(mFrame*0.05f);
+		mGraph->draw();
+		mFrame++;
+	}
+};
+
+extern "C" int MAMain()
+{
+	Moblet::run(new BenchMoblet());
+	return 0;
+}
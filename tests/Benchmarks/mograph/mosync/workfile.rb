@@ -0,0 +1,15 @@
+#!/usr/bin/ruby
+
+require File.expand_path('../../../../rules/mosync_exe.rb')
+
+work = PipeExeWork.new
+work.instance_eval do
+	@SOURCES = ["."]
+	@EXTRA_INCLUDES = ["#{mosyncdir}/include/newlib/stlport", "#{mosyncdir}/include/newlib/glm", "#{mosyncdir}/include/newlib/MoGraph"]
+	@EXTRA_CPPFLAGS = ' -Wno-float-equal -Wno-unreachable-code -Wno-shadow -Wno-missing-noreturn'
+	@LIBRARIES = ["stlport", "mautil", "mograph"]
+	@EXTRA_LINKFLAGS = ' -datasize=4096000 -heapsize=3072000 -stacksize=128000'
+	@NAME = "MoGraphBench"
+end
+
+work.invoke
@@ -0,0 +1,249 @@
+/* Copyright 2013 David Axmark
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+	http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+// Benchmarks the emulator's contact store with synthetic contacts.
+//
+// Import: puts all the contacts in a new store, like importing contacts.xml.
+// Open: replays the journal, like the first maPimListOpen() does.
+// Edit: changes the phone number of single contacts, like maPimItemClose().
+// The emulator used to rewrite contacts.xml for every edit; a full rewrite
+// of the store is timed for comparison, which is faster than writing the xml.
+// Search: looks up contacts by phone number, email address and name prefix,
+// with the indexes and by decoding every contact.
+// Last, damages a record in the middle of the journal, and checks that
+// only that contact is lost.
+//
+// The store is created in the current directory and removed afterwards.
+//
+// Usage: pimbench [number of contacts]
+
+#include "config_platform.h"
+#include <helpers/helpers.h>
+#include <helpers/cpp_defs.h>
+#include <helpers/CPP_IX_PIM.h>
+#include "ContactStore.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+using namespace std;
+
+void MoSyncErrorExit(int code) {
+	printf("MoSyncErrorExit(%i)\n", code);
+	exit(code);
+}
+
+static double seconds(clock_t start) {
+	return double(clock() - start) / CLOCKS_PER_SEC;
+}
+
+static const char* sStoreFile = "pimbench.db";
+
+#define EDITS 1000
+#define REWRITES 10
+#define SEARCHES 10000
+#define SCANS 10
+
+static wstring widen(const char* s) {
+	wstring w;
+	while(*s)
+		w += (wchar_t)*(s++);
+	return w;
+}
+
+static wstring number(const char* prefix, int i) {
+	char buf[64];
+	sprintf(buf, "%s%i", prefix, i);
+	return widen(buf);
+}
+
+static wstring tel(int i) {
+	char buf[32];
+	sprintf(buf, "+46 70-%03i %04i", i / 10000, i % 10000);
+	return widen(buf);
+}
+
+static wstring email(int i) {
+	char buf[64];
+	sprintf(buf, "User.%i@Example.com", i);
+	return widen(buf);
+}
+
+static void addString(ContactRecord& r, int field, int attr, const wstring& s) {
+	r.push_back(ContactRecordValue());
+	ContactRecordValue& v(r.back());
+	v.field = field;
+	v.attr = attr;
+	v.type = MA_PIM_TYPE_STRING;
+	v.intValue = 0;
+	v.strings.push_back(s);
+}
+
+static void makeContact(ContactRecord& r, int i) {
+	r.clear();
+	r.push_back(ContactRecordValue());
+	ContactRecordValue& name(r.back());
+	name.field = MA_PIM_FIELD_CONTACT_NAME;
+	name.attr = 0;
+	name.type = MA_PIM_TYPE_STRING_ARRAY;
+	name.intValue = 0;
+	name.strings.resize(5);
+	name.strings[MA_PIM_CONTACT_NAME_FAMILY] = number("Family", i);
+	name.strings[MA_PIM_CONTACT_NAME_GIVEN] = number("Given", i % 1000);
+	addString(r, MA_PIM_FIELD_CONTACT_FORMATTED_NAME, 0, number("Given Family", i));
+	addString(r, MA_PIM_FIELD_CONTACT_TEL, MA_PIM_ATTR_MOBILE, tel(i));
+	addString(r, MA_PIM_FIELD_CONTACT_TEL, MA_PIM_ATTR_HOME, tel(i + 5000000));
+	addString(r, MA_PIM_FIELD_CONTACT_EMAIL, MA_PIM_ATTR_HOME, email(i));
+	addString(r, MA_PIM_FIELD_CONTACT_NOTE, 0,
+		widen("A note that makes the contact about as large as a real one."));
+	r.push_back(ContactRecordValue());
+	ContactRecordValue& birthday(r.back());
+	birthday.field = MA_PIM_FIELD_CONTACT_BIRTHDAY;
+	birthday.attr = 0;
+	birthday.type = MA_PIM_TYPE_DATE;
+	birthday.intValue = i * 1000;
+}
+
+// finds a contact by decoding all of them, like the xml store had to.
+static int scan(const ContactStore& store, const vector<int>& ids, int field, const wstring& value) {
+	ContactRecord r;
+	for(size_t i=0; i<ids.size(); i++) {
+		store.get(ids[i], r);
+		for(size_t j=0; j<r.size(); j++) {
+			if(r[j].field == field && r[j].strings[0] == value)
+				return ids[i];
+		}
+	}
+	return 0;
+}
+
+static bool contains(const vector<int>& ids, int id) {
+	for(size_t i=0; i<ids.size(); i++) {
+		if(ids[i] == id)
+			return true;
+	}
+	return false;
+}
+
+int main(int argc, const char** argv) {
+	int nContacts = 100000;
+	if(argc > 1)
+		nContacts = atoi(argv[1]);
+	srand(1);
+	clock_t start;
+	ContactRecord r;
+
+	printf("%i contacts\n", nContacts);
+
+	{
+		ContactStore store;
+		if(!store.create(sStoreFile)) { printf("Could not create %s\n", sStoreFile); return 1; }
+		start = clock();
+		for(int i = 0; i < nContacts; i++) {
+			makeContact(r, i);
+			if(store.put(0, r) == 0) { printf("Import failed.\n"); return 1; }
+		}
+		printf("import:   %.3f s, %i bytes\n", seconds(start), store.fileSize());
+	}
+
+	ContactStore store;
+	start = clock();
+	if(!store.open(sStoreFile) || store.size() != nContacts) { printf("Open failed.\n"); return 1; }
+	printf("open:     %.3f s\n", seconds(start));
+
+	vector<int> ids;
+	store.ids(ids);
+
+	start = clock();
+	for(int i = 0; i < REWRITES; i++) {
+		if(!store.compact()) { printf("Rewrite failed.\n"); return 1; }
+	}
+	double rewrite = seconds(start) / REWRITES;
+
+	start = clock();
+	for(int i = 0; i < EDITS; i++) {
+		int id = ids[rand() % ids.size()];
+		store.get(id, r);
+		r[2].strings[0] = tel(nContacts + i);
+		if(store.put(id, r) != id) { printf("Edit failed.\n"); return 1; }
+	}
+	double edit = seconds(start) / EDITS;
+	printf("edit:     %.1f us per contact, full rewrite %.1f us\n", edit * 1e6, rewrite * 1e6);
+
+	// the edits must survive a reopen.
+	store.close();
+	if(!store.open(sStoreFile) || store.size() != nContacts) { printf("Reopen failed.\n"); return 1; }
+
+	int found = 0;
+	vector<int> result;
+	start = clock();
+	for(int i = 0; i < SEARCHES; i++) {
+		int c = rand() % nContacts;
+		int id = ids[c];
+		result.clear();
+		switch(i % 3) {
+		case 0:
+			store.find(ContactStore::INDEX_TEL, tel(c + 5000000), result);
+			break;
+		case 1:
+			store.find(ContactStore::INDEX_EMAIL, email(c), result);
+			break;
+		case 2:
+			store.findPrefix(ContactStore::INDEX_NAME, number("family", c), result);
+			break;
+		}
+		if(!contains(result, id)) { printf("Search for contact %i failed.\n", id); return 1; }
+		found += result.size();
+	}
+	double search = seconds(start) / SEARCHES;
+
+	start = clock();
+	for(int i = 0; i < SCANS; i++) {
+		int c = rand() % nContacts;
+		if(scan(store, ids, MA_PIM_FIELD_CONTACT_EMAIL, email(c)) != ids[c]) {
+			printf("Scan failed.\n");
+			return 1;
+		}
+	}
+	double linear = seconds(start) / SCANS;
+	printf("search:   %.1f us indexed, %.1f us by decoding every contact (%i matches)\n",
+		search * 1e6, linear * 1e6, found);
+
+	start = clock();
+	int before = store.fileSize();
+	if(!store.compact()) { printf("Compact failed.\n"); return 1; }
+	printf("compact:  %.3f s, %i to %i bytes\n", seconds(start), before, store.fileSize());
+
+	// a damaged record in the middle loses only that contact.
+	int size = store.fileSize();
+	store.close();
+	FILE* file = fopen(sStoreFile, "r+b");
+	if(!file) { printf("Could not damage %s\n", sStoreFile); return 1; }
+	fseek(file, size / 2, SEEK_SET);
+	int c = fgetc(file);
+	fseek(file, size / 2, SEEK_SET);
+	fputc(c ^ 0xff, file);
+	fclose(file);
+	if(!store.open(sStoreFile) || store.size() != nContacts - 1) {
+		printf("Damaged open failed: %i contacts\n", store.size());
+		return 1;
+	}
+	printf("damaged:  %i of %i contacts kept\n", store.size(), nContacts);
+
+	store.close();
+	remove(sStoreFile);
+	return 0;
+}
@@ -0,0 +1,26 @@
+#!/usr/bin/ruby
+
+# Host build of the emulator's contact store benchmark.
+# Uses the SDL runtime's ContactStore and its config_platform.h.
+
+require File.expand_path('../../../../rules/native_mosync.rb')
+
+SDL_DIR = "../../../../runtimes/cpp/platforms/sdl"
+
+work = MoSyncExe.new
+work.instance_eval do
+	@SOURCES = ["."]
+	@EXTRA_SOURCEFILES = [
+		"#{SDL_DIR}/ContactStore.cpp",
+	]
+	@EXTRA_INCLUDES = ["../../../../runtimes/cpp/base", SDL_DIR]
+	@LOCAL_LIBS = ["mosync_log_file"]
+	@NAME = "pimbench"
+end
+
+if(!File.exist?("#{SDL_DIR}/config_platform.h"))
+	CopyFileTask.new(work, "#{SDL_DIR}/config_platform.h",
+		FileTask.new(work, "#{SDL_DIR}/config_platform.h.example")).invoke
+end
+
+work.invoke
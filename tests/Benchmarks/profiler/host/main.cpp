@@ -0,0 +1,292 @@
+/* Copyright 2013 David Axmark
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+	http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+// Measures the overhead per call of the core's function profiler,
+// and compares it with the profiler it replaced.
+//
+// The calls are those a call-heavy program would make: a recursive
+// Fibonacci function, and a main loop that calls FUNCS functions,
+// which call some of LEAVES small functions. The same calls are made
+// without a profiler, with the old profiler and with FunctionProfiler.
+// The difference in time, divided by the number of calls, is the overhead.
+// Both profilers then write their output, whose size and time are printed.
+//
+// Usage: profbench [fib depth]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sys/time.h>
+#include <sys/stat.h>
+#include <vector>
+
+#include "FunctionProfiler.h"
+
+#define FUNCS 200
+#define LEAVES 50
+#define LOOPS 200
+
+static double seconds(clock_t start) {
+	return double(clock() - start) / CLOCKS_PER_SEC;
+}
+
+static unsigned int sSeed;
+
+static int nextRandom() {
+	sSeed = sSeed * 1103515245 + 12345;
+	return (int)((sSeed >> 1) & 0x3fffffff);
+}
+
+static const char* noName(int ip) {
+	return NULL;
+}
+
+static long fileSize(const char* name) {
+	struct stat s;
+	if(stat(name, &s) != 0)
+		return -1;
+	return s.st_size;
+}
+
+// The core's profiler as it was.
+class OldProfTree {
+private:
+	class ProfTime {
+	private:
+		s64 li;
+	public:
+		static ProfTime now() {
+			ProfTime n;
+			struct timeval tv;
+			gettimeofday(&tv, NULL);
+			n.li = (s64) tv.tv_sec * 1000000 + (s64) tv.tv_usec;
+			return n;
+		}
+		ProfTime() {
+			li = 0;
+		}
+		ProfTime(const ProfTime& other) : li(other.li) {}
+		ProfTime& operator+=(const ProfTime& other) {
+			li += other.li;
+			return *this;
+		}
+		ProfTime operator-(const ProfTime& other) {
+			ProfTime t;
+			t.li = li - other.li;
+			return t;
+		}
+		double toMilliSeconds() {
+			return li / 1000;
+		}
+	};
+
+	class ProfNode {
+	private:
+		ProfTime mLastStartTime, mRunTime;
+		int mCount;
+		bool mRunning;
+		std::vector<ProfNode*> mChildren;
+		ProfNode* mParent;
+		const int mIp;
+		friend class OldProfTree;
+	public:
+		bool running() const { return mRunning; }
+
+		ProfNode(int ip, ProfNode* parent) : mCount(0), mRunning(false), mParent(parent), mIp(ip) {}
+		~ProfNode() {
+			for(size_t i=0; i<mChildren.size(); i++) {
+				delete mChildren[i];
+			}
+		}
+		void start() {
+			mRunning = true;
+			mLastStartTime = ProfTime::now();
+			mCount++;
+		}
+		void stop() {
+			ProfTime endTime = ProfTime::now();
+			mRunTime += (endTime - mLastStartTime);
+			mRunning = false;
+		}
+
+		void dump(FILE* file) {
+			static int dLev = 0;
+			if(dLev > 0) {
+				fprintf(file, "%*c", dLev, ' ');
+			}
+			fprintf(file, "<f ");
+			fprintf(file, "a=\"0x%x\"", mIp);
+			ProfTime childrenTime;
+			for(size_t i=0; i<mChildren.size(); i++) {
+				ProfNode* n = mChildren[i];
+				childrenTime += n->mRunTime;
+			}
+			fprintf(file, " c=\"%i\" t=\"%f\" lt=\"%f\" ch=\"%i\" cht=\"%f\">\n", mCount,
+				mRunTime.toMilliSeconds(), (mRunTime - childrenTime).toMilliSeconds(),
+				(int)mChildren.size(), childrenTime.toMilliSeconds());
+			for(size_t i=0; i<mChildren.size(); i++) {
+				ProfNode* n = mChildren[i];
+				dLev++;
+				n->dump(file);
+				dLev--;
+			}
+			if(dLev > 0) {
+				fprintf(file, "%*c", dLev, ' ');
+			}
+			fprintf(file, "</f>\n");
+		}
+	};
+
+	ProfNode* mRoot;
+	ProfNode* mTop;
+
+public:
+	int nodes;
+
+	OldProfTree() : mRoot(NULL) {}
+	void init(int entryPoint) {
+		mRoot = new ProfNode(entryPoint, NULL);
+		mTop = mRoot;
+		nodes = 1;
+		mRoot->start();
+	}
+	~OldProfTree() {
+		delete mRoot;
+	}
+	void write(const char* name) {
+		while(mTop != mRoot)
+			ret();
+		if(mRoot->running())
+			mRoot->stop();
+		FILE* file = fopen(name, "w");
+		mRoot->dump(file);
+		fclose(file);
+	}
+
+	void call(int ip) {
+		ProfNode* node = NULL;
+		for(size_t i=0; i<mTop->mChildren.size(); i++) {
+			ProfNode* n = mTop->mChildren[i];
+			if(n->mIp == ip) {
+				node = n;
+				break;
+			}
+		}
+		if(node == NULL) {
+			node = new ProfNode(ip, mTop);
+			nodes++;
+			mTop->mChildren.push_back(node);
+		}
+		mTop = node;
+		node->start();
+	}
+
+	void ret() {
+		mTop->stop();
+		mTop = mTop->mParent;
+	}
+};
+
+class NoProfiler {
+public:
+	void call(int ip) {}
+	void ret() {}
+};
+
+#define FIB_IP 0x100
+#define FUNC_IP 0x1000
+#define LEAF_IP 0x2000
+
+static int sCalls;
+
+template<class P> static int fib(P& p, int n) {
+	if(n < 2)
+		return n;
+	sCalls += 2;
+	p.call(FIB_IP);
+	int a = fib(p, n - 1);
+	p.ret();
+	p.call(FIB_IP);
+	int b = fib(p, n - 2);
+	p.ret();
+	return a + b;
+}
+
+template<class P> static int program(P& p, int fibDepth) {
+	sCalls = 0;
+	sSeed = 1;
+	int sum = fib(p, fibDepth);
+	for(int l = 0; l < LOOPS; l++) {
+		for(int f = 0; f < FUNCS; f++) {
+			p.call(FUNC_IP + f * 16);
+			sCalls++;
+			int leaves = nextRandom() % 8;
+			for(int i = 0; i < leaves; i++) {
+				p.call(LEAF_IP + (nextRandom() % LEAVES) * 16);
+				sCalls++;
+				sum += i;
+				p.ret();
+			}
+			p.ret();
+		}
+	}
+	return sum;
+}
+
+int main(int argc, const char** argv) {
+	int fibDepth = 27;
+	if(argc > 1)
+		fibDepth = atoi(argv[1]);
+
+	NoProfiler none;
+	clock_t start = clock();
+	int sum = program(none, fibDepth);
+	double base = seconds(start);
+	int calls = sCalls;
+	printf("%i calls, %.3f s without a profiler\n", calls, base);
+
+	OldProfTree old;
+	old.init(0);
+	start = clock();
+	if(program(old, fibDepth) != sum)
+		return 1;
+	double oldTime = seconds(start);
+	printf("old profiler: %.1f ns per call, %i nodes\n",
+		(oldTime - base) * 1e9 / calls, old.nodes);
+
+	FunctionProfiler fp;
+	fp.init(0);
+	start = clock();
+	if(program(fp, fibDepth) != sum)
+		return 1;
+	double newTime = seconds(start);
+	printf("new profiler: %.1f ns per call\n", (newTime - base) * 1e9 / calls);
+
+	start = clock();
+	old.write("profbench_old.xml");
+	printf("old output: %.3f s, %li bytes\n", seconds(start), fileSize("profbench_old.xml"));
+	start = clock();
+	fp.write("profbench_new.bin", noName);
+	long size = fileSize("profbench_new.bin");
+	printf("new output: %.3f s, %li bytes\n", seconds(start), size);
+	if(size != long(sizeof(FunctionProfileHeader) + old.nodes * sizeof(FunctionProfileNode))) {
+		printf("Node counts differ.\n");
+		return 1;
+	}
+	remove("profbench_old.xml");
+	remove("profbench_new.bin");
+	return 0;
+}
@@ -0,0 +1,29 @@
+/* Copyright 2013 David Axmark
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+	http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+// Host stand-in for intlibs' helpers.h, with the macros that
+// runtimes/cpp/core/FunctionProfiler.h uses.
+
+#ifndef HELPERS_H
+#define HELPERS_H
+
+#include <assert.h>
+#include <stdio.h>
+#include <helpers/types.h>
+
+#define DEBUG_ASSERT(a) assert(a)
+#define LOG(...)
+
+#endif	//HELPERS_H
@@ -0,0 +1,14 @@
+#!/usr/bin/ruby
+
+# Host build of the core's function profiler benchmark.
+
+require File.expand_path('../../../../rules/exe.rb')
+
+work = ExeWork.new
+work.instance_eval do
+	@SOURCES = ["."]
+	@EXTRA_INCLUDES = ["stub", "../../../../intlibs", "../../../../runtimes/cpp/core"]
+	@NAME = "profbench"
+end
+
+work.invoke
@@ -0,0 +1,329 @@
+/* Copyright 2013 David Axmark
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+	http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+// Compares the runtime's buffered FileStream and positional LimitedFileStream
+// with unbuffered streams that work like the old ones: one read() per call,
+// and a tell() before every read of a limited stream.
+//
+// Program load: a header, code and data, read in a few large reads.
+// Resource parsing: a resource file like the one the runtime loads at startup,
+// read with readByte(), readUnsignedVarInt() and readUnsignedShort().
+// Copy: maCopyData() style copies from a ubin to a binary in memory,
+// and a file to file copy like maWriteStore() does.
+//
+// The files are created in the current directory and removed afterwards.
+//
+// Usage: streambench [number of resources]
+
+#include "config_platform.h"
+#include <helpers/helpers.h>
+#include "FileStream.h"
+#include "MemStream.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#ifdef _MSC_VER
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+using namespace Base;
+
+void MoSyncErrorExit(int code) {
+	printf("MoSyncErrorExit(%i)\n", code);
+	exit(code);
+}
+
+#ifdef WIN32
+#define OPEN_FLAGS (O_RDONLY | O_BINARY)
+#else
+#define OPEN_FLAGS O_RDONLY
+#endif
+
+// Reads like FileStream did before it had a buffer.
+class RawFileStream : public Stream {
+public:
+	RawFileStream(const char* filename) {
+		mFd = ::open(filename, OPEN_FLAGS);
+	}
+	~RawFileStream() {
+		if(isOpen())
+			::close(mFd);
+	}
+	bool isOpen() const { return mFd > 0; }
+	bool read(void* dst, int size) {
+		byte* pos = (byte*)dst;
+		byte* end = pos + size;
+		while(pos != end) {
+			int res = ::read(mFd, pos, end - pos);
+			TEST(res > 0);
+			pos += res;
+		}
+		return true;
+	}
+	bool write(const void*, int) { FAIL; }
+	bool length(int& aLength) const {
+		int oldpos = lseek(mFd, 0, SEEK_CUR);
+		aLength = lseek(mFd, 0, SEEK_END);
+		lseek(mFd, oldpos, SEEK_SET);
+		return true;
+	}
+	bool seek(Seek::Enum mode, int offset) {
+		int lm = mode == Seek::Start ? SEEK_SET : (mode == Seek::Current ? SEEK_CUR : SEEK_END);
+		return lseek(mFd, offset, lm) >= 0;
+	}
+	bool tell(int& aPos) const {
+		aPos = lseek(mFd, 0, SEEK_CUR);
+		return aPos >= 0;
+	}
+	Stream* createLimitedCopy(int) const { FAIL; }
+	Stream* createCopy() const { FAIL; }
+protected:
+	int mFd;
+};
+
+// Reads like LimitedFileStream did: its own descriptor, and a tell() before every read.
+class RawLimitedFileStream : public RawFileStream {
+public:
+	RawLimitedFileStream(const char* filename, int offset, int len)
+		: RawFileStream(filename), mStartPos(offset), mEndPos(offset + len)
+	{
+		lseek(mFd, offset, SEEK_SET);
+	}
+	bool read(void* dst, int size) {
+		int curPos;
+		TEST(RawFileStream::tell(curPos));
+		TEST(curPos + size <= mEndPos);
+		return RawFileStream::read(dst, size);
+	}
+	bool length(int& aLength) const {
+		aLength = mEndPos - mStartPos;
+		return true;
+	}
+	bool seek(Seek::Enum mode, int offset) {
+		TEST(mode == Seek::Start);
+		return RawFileStream::seek(Seek::Start, mStartPos + offset);
+	}
+	bool tell(int& aPos) const {
+		TEST(RawFileStream::tell(aPos));
+		aPos -= mStartPos;
+		return true;
+	}
+protected:
+	const int mStartPos, mEndPos;
+};
+
+static double seconds(clock_t start) {
+	return double(clock() - start) / CLOCKS_PER_SEC;
+}
+
+static const char* sProgramFile = "streambench.program";
+static const char* sResourceFile = "streambench.resources";
+static const char* sCopyFile = "streambench.copy";
+
+#define CODE_SIZE (512*1024)
+#define DATA_SIZE (2*1024*1024)
+
+// The sizes of the binary resources. Every 16th resource is a large one.
+#define SMALL_BINARY 24
+#define LARGE_BINARY (64*1024)
+#define COPY_SIZE 64
+
+// Resource types, as in the runtime's resource files.
+enum { TYPE_SPRITE = 3, TYPE_BINARY = 4 };
+
+struct ProgramHeader {
+	int magic, codeLen, dataLen, dataSize, stackSize, heapSize, entryPoint;
+};
+
+static void writeVarInt(FILE* f, unsigned int v) {
+	// the format that Stream::readUnsignedVarInt() reads:
+	// 7 bits per byte, least significant first, the last byte has the top bit set.
+	while(v > 0x7f) {
+		fputc(v & 0x7f, f);
+		v >>= 7;
+	}
+	fputc(v | 0x80, f);
+}
+
+static void writeFiles(int nResources) {
+	FILE* f = fopen(sProgramFile, "wb");
+	ProgramHeader head = { 0x5844414d, CODE_SIZE, DATA_SIZE, DATA_SIZE, 64*1024, 512*1024, 0 };
+	fwrite(&head, sizeof(head), 1, f);
+	for(int i = 0; i < CODE_SIZE + DATA_SIZE; i++)
+		fputc(i * 13, f);
+	fclose(f);
+
+	f = fopen(sResourceFile, "wb");
+	fputs("MARS", f);
+	writeVarInt(f, nResources);
+	writeVarInt(f, 0);
+	for(int i = 0; i < nResources; i++) {
+		if(i % 2 == 0) {
+			// a sprite: seven shorts.
+			fputc(TYPE_SPRITE, f);
+			writeVarInt(f, 14);
+			for(int j = 0; j < 7; j++) {
+				fputc(i + j, f);
+				fputc(j, f);
+			}
+		} else {
+			int size = (i % 16 == 1) ? LARGE_BINARY : SMALL_BINARY;
+			fputc(TYPE_BINARY, f);
+			writeVarInt(f, size);
+			for(int j = 0; j < size; j++)
+				fputc(i + j, f);
+		}
+	}
+	fputc(0, f);
+	fclose(f);
+}
+
+static bool loadProgram(Stream& file, int& checksum) {
+	ProgramHeader head;
+	TEST(file.readObject(head));
+	TEST(head.magic == 0x5844414d);
+	char* code = new char[head.codeLen];
+	char* data = new char[head.dataLen];
+	bool res = file.read(code, head.codeLen) && file.read(data, head.dataLen);
+	checksum += code[head.codeLen - 1] + data[head.dataLen - 1];
+	delete[] code;
+	delete[] data;
+	return res;
+}
+
+// Parses the resource file like Syscall::loadResources() does.
+// Small binaries are read into memory, large ones are skipped like ubins.
+// The offsets of the small binaries are stored for the copy benchmark.
+static bool parseResources(Stream& file, int* offsets, int& nOffsets, int& checksum) {
+	byte m, a, r, s;
+	TEST(file.readByte(m) && file.readByte(a) && file.readByte(r) && file.readByte(s));
+	TEST(m == 'M' && a == 'A' && r == 'R' && s == 'S');
+	DAR_UVINT(nResources);
+	DAR_UVINT(rSize);
+	nOffsets = 0;
+	for(int i = 0; i < nResources; i++) {
+		DAR_UBYTE(type);
+		DAR_UVINT(size);
+		if(type == TYPE_SPRITE) {
+			for(int j = 0; j < 7; j++) {
+				DAR_USHORT(v);
+				checksum += v;
+			}
+		} else if(size > SMALL_BINARY) {
+			TEST(file.seek(Seek::Current, size));
+		} else {
+			TEST(file.tell(offsets[nOffsets++]));
+			MemStream b(size);
+			TEST(file.readFully(b));
+			checksum += ((byte*)b.ptr())[0];
+		}
+	}
+	DAR_UBYTE(end);
+	TEST(end == 0);
+	return true;
+}
+
+// Copies from the small binaries in a ubin to a binary in memory,
+// like maCopyData() does.
+static bool copyData(Stream& ubin, const int* offsets, int nOffsets, int& checksum) {
+	MemStream dst(nOffsets * COPY_SIZE / 2);
+	for(int i = 0; i < nOffsets / 2; i++) {
+		TEST(dst.seek(Seek::Start, i * COPY_SIZE));
+		TEST(ubin.seek(Seek::Start, offsets[i * 2]));
+		TEST(dst.writeStream(ubin, COPY_SIZE));
+	}
+	checksum += ((byte*)dst.ptr())[COPY_SIZE];
+	return true;
+}
+
+static bool copyFile(Stream& src) {
+	WriteFileStream dst(sCopyFile);
+	TEST(dst.writeFully(src));
+	return true;
+}
+
+int main(int argc, const char** argv) {
+	int nResources = 20000;
+	if(argc > 1)
+		nResources = atoi(argv[1]);
+	writeFiles(nResources);
+	int* offsets = new int[nResources];
+	int nOffsets = 0;
+	int rawSum = 0, sum = 0;
+	clock_t start;
+
+	printf("%i resources\n", nResources);
+
+	{
+		RawFileStream raw(sProgramFile);
+		start = clock();
+		if(!loadProgram(raw, rawSum)) { printf("Raw program load failed.\n"); return 1; }
+		double rawTime = seconds(start);
+		FileStream buffered(sProgramFile);
+		start = clock();
+		if(!loadProgram(buffered, sum)) { printf("Program load failed.\n"); return 1; }
+		printf("program load:      unbuffered %.3f s, buffered %.3f s\n", rawTime, seconds(start));
+	}
+
+	{
+		RawFileStream raw(sResourceFile);
+		start = clock();
+		if(!parseResources(raw, offsets, nOffsets, rawSum)) { printf("Raw resource parsing failed.\n"); return 1; }
+		double rawTime = seconds(start);
+		FileStream buffered(sResourceFile);
+		start = clock();
+		if(!parseResources(buffered, offsets, nOffsets, sum)) { printf("Resource parsing failed.\n"); return 1; }
+		printf("resource parsing:  unbuffered %.3f s, buffered %.3f s\n", rawTime, seconds(start));
+	}
+
+	{
+		int len;
+		FileStream file(sResourceFile);
+		file.length(len);
+		RawLimitedFileStream raw(sResourceFile, 0, len);
+		start = clock();
+		if(!copyData(raw, offsets, nOffsets, rawSum)) { printf("Raw copy failed.\n"); return 1; }
+		double rawTime = seconds(start);
+		Stream* ubin = file.createLimitedCopy(len);
+		start = clock();
+		if(!copyData(*ubin, offsets, nOffsets, sum)) { printf("Copy failed.\n"); return 1; }
+		printf("ubin to memory:    old %.3f s, positional %.3f s (%i copies of %i bytes)\n",
+			rawTime, seconds(start), nOffsets / 2, COPY_SIZE);
+		delete ubin;
+	}
+
+	{
+		FileStream src(sProgramFile);
+		start = clock();
+		if(!copyFile(src)) { printf("File copy failed.\n"); return 1; }
+		printf("file to file:      %.3f s, in chunks of %i bytes\n", seconds(start), Stream::COPY_CHUNK_SIZE);
+	}
+
+	if(rawSum != sum) {
+		printf("Checksum mismatch: %i != %i\n", rawSum, sum);
+		return 1;
+	}
+
+	delete[] offsets;
+	remove(sProgramFile);
+	remove(sResourceFile);
+	remove(sCopyFile);
+	return 0;
+}
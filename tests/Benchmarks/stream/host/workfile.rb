@@ -0,0 +1,29 @@
+#!/usr/bin/ruby
+
+# Host build of the runtime Stream benchmark.
+# Uses the SDL runtime's FileStream and its config_platform.h.
+
+require File.expand_path('../../../../rules/native_mosync.rb')
+
+SDL_DIR = "../../../../runtimes/cpp/platforms/sdl"
+
+work = MoSyncExe.new
+work.instance_eval do
+	@SOURCES = ["."]
+	@EXTRA_SOURCEFILES = [
+		"../../../../runtimes/cpp/base/Stream.cpp",
+		"../../../../runtimes/cpp/base/MemStream.cpp",
+		"../../../../runtimes/cpp/base/FileStream.cpp",
+		"#{SDL_DIR}/FileImpl.cpp",
+	]
+	@EXTRA_INCLUDES = ["../../../../runtimes/cpp/base", SDL_DIR]
+	@LOCAL_LIBS = ["mosync_log_file"]
+	@NAME = "streambench"
+end
+
+if(!File.exist?("#{SDL_DIR}/config_platform.h"))
+	CopyFileTask.new(work, "#{SDL_DIR}/config_platform.h",
+		FileTask.new(work, "#{SDL_DIR}/config_platform.h.example")).invoke
+end
+
+work.invoke
@@ -35,172 +35,72 @@ StropBencher::~StropBencher() {
 }
 
 /*
- * Do the benchmarks and print the results to the console
+ * Add the benchmarks to a runner. Each iteration is ALOT string
+ * operations, so the median in microseconds is the time for ALOT operations.
  */
-void StropBencher::bench() {
-
-	int time;
-	int i;
-
-	printf("STROPS Benchmark started\n");
-	printf("std::string tests:\n");
+void StropBencher::addBenchmarks(MATest::BenchmarkRunner* runner) {
 
 	/*******************************************
 	 * std::string tests					   *
 	 *******************************************/
 
-	for(i = 1; (time = this->appender(i, STD_STRING, 0)) < RUNNING_TIME; i*=2);
-	printf("append(char*) %dK times: ", ALOT*i/1000);
-	printf("%1.2f KSTROPS\n", (float) (ALOT*i)/(float) time);
-
-	for(i = 1; (time = this->appender(i, STD_STRING, 1)) < RUNNING_TIME; i*=2);
-	printf("append(string) %dK times: ", ALOT*i/1000);
-	printf("%1.2f KSTROPS\n", (float) (ALOT*i)/(float) time);
-
-	for(i = 1; (time = this->copy(i, STD_STRING)) < RUNNING_TIME; i*=2);
-	printf("copying strings %dK times: ", ALOT*i/1000);
-	printf("%1.2f KSTROPS\n", (float) (ALOT*i)/(float) time);
-
-	for(i = 1; (time = this->find(i, STD_STRING, 0)) < RUNNING_TIME; i*=2);
-	printf("find() %dK times: ", ALOT*i/1000);
-	printf("%1.2f KSTROPS\n", (float) (ALOT*i)/(float) time);
-
-	for(i = 1; (time = this->find(i, STD_STRING, 1)) < RUNNING_TIME; i*=2);
-	printf("findLastOf() %dK times: ", ALOT*i/1000);
-	printf("%1.2f KSTROPS\n", (float) (ALOT*i)/(float) time);
-
-	for(i = 1; (time = this->find(i, STD_STRING, 2)) < RUNNING_TIME; i*=2);
-	printf("findFirstOf() %dK times: ", ALOT*i/1000);
-	printf("%1.2f KSTROPS\n", (float) (ALOT*i)/(float) time);
-
-	for(i = 1; (time = this->find(i, STD_STRING, 3)) < RUNNING_TIME; i*=2);
-	printf("findFirstNotOf() %dK times: ", ALOT*i/1000);
-	printf("%1.2f KSTROPS\n", (float) (ALOT*i)/(float) time);
-
-	for(i = 1; (time = this->substr(i, STD_STRING)) < RUNNING_TIME; i*=2);
-	printf("substring(string) %dK times: ", ALOT*i/1000);
-	printf("%1.2f KSTROPS\n", (float) (ALOT*i)/(float) time);
-
-	for(i = 1; (time = this->insert(i, STD_STRING, 0)) < RUNNING_TIME; i*=2);
-	printf("insert(char*) %dK times: ", ALOT*i/1000);
-	printf("%1.2f KSTROPS\n", (float) (ALOT*i)/(float) time);
-
-	for(i = 1; (time = this->insert(i, STD_STRING, 1)) < RUNNING_TIME; i*=2);
-	printf("insert(string) %dK times: ", ALOT*i/1000);
-	printf("%1.2f KSTROPS\n", (float) (ALOT*i)/(float) time);
-
-//	for(i = 1; (time = this->remove(i, STD_STRING)) < RUNNING_TIME; i*=2); NOT IMPLEMENTED IN STD::STRING!
-//	printf("Removing parts of a MAUtil::String %d times", ALOT*i);
-//	printf("%1.2f KSTROPS\n", (float) (ALOT*i)/(float) time);
-
-	for(i = 1; (time = this->resize(i, STD_STRING)) < RUNNING_TIME; i*=2);
-	printf("Resizing a string %dK times: ", ALOT*i/1000);
-	printf("%1.2f KSTROPS\n", (float) (ALOT*i)/(float) time);
-
-	for(i = 1; (time = this->compare(i, STD_STRING, 0)) < RUNNING_TIME; i*=2);
-	printf("operator== %dK times: ", ALOT*i/1000);
-	printf("%1.2f KSTROPS\n", (float) (ALOT*i)/(float) time);
-
-	for(i = 1; (time = this->compare(i, STD_STRING, 1)) < RUNNING_TIME; i*=2);
-	printf("operator!= %dK times: ", ALOT*i/1000);
-	printf("%1.2f KSTROPS\n", (float) (ALOT*i)/(float) time);
-
-	for(i = 1; (time = this->compare(i, STD_STRING, 2)) < RUNNING_TIME; i*=2);
-	printf("operator<= %dK times: ", ALOT*i/1000);
-	printf("%1.2f KSTROPS\n", (float) (ALOT*i)/(float) time);
-
-	for(i = 1; (time = this->compare(i, STD_STRING, 3)) < RUNNING_TIME; i*=2);
-	printf("operator>= %dK times: ", ALOT*i/1000);
-	printf("%1.2f KSTROPS\n", (float) (ALOT*i)/(float) time);
-
-	for(i = 1; (time = this->compare(i, STD_STRING, 4)) < RUNNING_TIME; i*=2);
-	printf("operator< %dK times: ", ALOT*i/1000);
-	printf("%1.2f KSTROPS\n", (float) (ALOT*i)/(float) time);
-
-	for(i = 1; (time = this->compare(i, STD_STRING, 5)) < RUNNING_TIME; i*=2);
-	printf("operator> %dK times: ", ALOT*i/1000);
-	printf("%1.2f KSTROPS\n", (float) (ALOT*i)/(float) time);
+	runner->addBenchmark(new StropBenchCase("std_append_char", this, APPEND, STD_STRING, 0));
+	runner->addBenchmark(new StropBenchCase("std_append_string", this, APPEND, STD_STRING, 1));
+	runner->addBenchmark(new StropBenchCase("std_copy", this, COPY, STD_STRING, 0));
+	runner->addBenchmark(new StropBenchCase("std_find", this, FIND, STD_STRING, 0));
+	runner->addBenchmark(new StropBenchCase("std_find_last_of", this, FIND, STD_STRING, 1));
+	runner->addBenchmark(new StropBenchCase("std_find_first_of", this, FIND, STD_STRING, 2));
+	runner->addBenchmark(new StropBenchCase("std_find_first_not_of", this, FIND, STD_STRING, 3));
+	runner->addBenchmark(new StropBenchCase("std_substr", this, SUBSTR, STD_STRING, 0));
+	runner->addBenchmark(new StropBenchCase("std_insert_char", this, INSERT, STD_STRING, 0));
+	runner->addBenchmark(new StropBenchCase("std_insert_string", this, INSERT, STD_STRING, 1));
+	runner->addBenchmark(new StropBenchCase("std_resize", this, RESIZE, STD_STRING, 0));
+	runner->addBenchmark(new StropBenchCase("std_equal", this, COMPARE, STD_STRING, 0));
+	runner->addBenchmark(new StropBenchCase("std_not_equal", this, COMPARE, STD_STRING, 1));
+	runner->addBenchmark(new StropBenchCase("std_less_equal", this, COMPARE, STD_STRING, 2));
+	runner->addBenchmark(new StropBenchCase("std_greater_equal", this, COMPARE, STD_STRING, 3));
+	runner->addBenchmark(new StropBenchCase("std_less", this, COMPARE, STD_STRING, 4));
+	runner->addBenchmark(new StropBenchCase("std_greater", this, COMPARE, STD_STRING, 5));
 
 	/************************************
 	 * MAUtil::String tests				*
 	 ************************************/
 
-	printf("MAUtil::String tests:\n");
-	//double the amount of test runs until the test take more than RUNNING_TIME to perform
-	for(i = 1; (time = this->appender(i, MAUTIL_STRING, 0)) < RUNNING_TIME; i*=2);
-	printf("append(char*) %dK times: ", ALOT*i/1000);
-	printf("%1.2f KSTROPS\n", (float) (ALOT*i)/(float) time);
-
-	for(i = 1; (time = this->appender(i, MAUTIL_STRING, 1)) < RUNNING_TIME; i*=2);
-	printf("append(string) %dK times: ", ALOT*i/1000);
-	printf("%1.2f KSTROPS\n", (float) (ALOT*i)/(float) time);
-
-	for(i = 1; (time = this->copy(i, MAUTIL_STRING)) < RUNNING_TIME; i*=2);
-	printf("copying strings %dK times: ", ALOT*i/1000);
-	printf("%1.2f KSTROPS\n", (float) (ALOT*i)/(float) time);
-
-	for(i = 1; (time = this->find(i, MAUTIL_STRING, 0)) < RUNNING_TIME; i*=2);
-	printf("find() %dK times: ", ALOT*i/1000);
-	printf("%1.2f KSTROPS\n", (float) (ALOT*i)/(float) time);
-
-	for(i = 1; (time = this->find(i, MAUTIL_STRING, 1)) < RUNNING_TIME; i*=2);
-	printf("findLastOf() %dK times: ", ALOT*i/1000);
-	printf("%1.2f KSTROPS\n", (float) (ALOT*i)/(float) time);
-
-	for(i = 1; (time = this->find(i, MAUTIL_STRING, 2)) < RUNNING_TIME; i*=2);
-	printf("findFirstOf() %dK times: ", ALOT*i/1000);
-	printf("%1.2f KSTROPS\n", (float) (ALOT*i)/(float) time);
-
-	for(i = 1; (time = this->find(i, MAUTIL_STRING, 3)) < RUNNING_TIME; i*=2);
-	printf("findFirstNotOf() %dK times: ", ALOT*i/1000);
-	printf("%1.2f KSTROPS\n", (float) (ALOT*i)/(float) time);
-
-	for(i = 1; (time = this->substr(i, MAUTIL_STRING)) < RUNNING_TIME; i*=2);
-	printf("substring(string) %dK times: ", ALOT*i/1000);
-	printf("%1.2f KSTROPS\n", (float) (ALOT*i)/(float) time);
-
-	for(i = 1; (time = this->insert(i, MAUTIL_STRING, 0)) < RUNNING_TIME; i*=2);
-	printf("insert(char*) %dK times: ", ALOT*i/1000);
-	printf("%1.2f KSTROPS\n", (float) (ALOT*i)/(float) time);
-
-	for(i = 1; (time = this->insert(i, MAUTIL_STRING, 1)) < RUNNING_TIME; i*=2);
-	printf("insert(string) %dK times: ", ALOT*i/1000);
-	printf("%1.2f KSTROPS\n", (float) (ALOT*i)/(float) time);
-
-	for(i = 1; (time = this->remove(i, MAUTIL_STRING)) < RUNNING_TIME; i*=2);
-	printf("remove() parts of a string %dK times: ", ALOT*i/1000);
-	printf("%1.2f KSTROPS\n", (float) (ALOT*i)/(float) time);
-
-	for(i = 1; (time = this->resize(i, MAUTIL_STRING)) < RUNNING_TIME; i*=2);
-	printf("Resizing a string %dK times: ", ALOT*i/1000);
-	printf("%1.2f KSTROPS\n", (float) (ALOT*i)/(float) time);
-
-	for(i = 1; (time = this->compare(i, MAUTIL_STRING, 0)) < RUNNING_TIME; i*=2);
-	printf("operator== %dK times: ", ALOT*i/1000);
-	printf("%1.2f KSTROPS\n", (float) (ALOT*i)/(float) time);
-
-	for(i = 1; (time = this->compare(i, MAUTIL_STRING, 1)) < RUNNING_TIME; i*=2);
-	printf("operator!= %dK times: ", ALOT*i/1000);
-	printf("%1.2f KSTROPS\n", (float) (ALOT*i)/(float) time);
-
-	for(i = 1; (time = this->compare(i, MAUTIL_STRING, 2)) < RUNNING_TIME; i*=2);
-	printf("operator<= %dK times: ", ALOT*i/1000);
-	printf("%1.2f KSTROPS\n", (float) (ALOT*i)/(float) time);
-
-	for(i = 1; (time = this->compare(i, MAUTIL_STRING, 3)) < RUNNING_TIME; i*=2);
-	printf("operator>= %dK times: ", ALOT*i/1000);
-	printf("%1.2f KSTROPS\n", (float) (ALOT*i)/(float) time);
-
-	for(i = 1; (time = this->compare(i, MAUTIL_STRING, 4)) < RUNNING_TIME; i*=2);
-	printf("operator< %dK times: ", ALOT*i/1000);
-	printf("%1.2f KSTROPS\n", (float) (ALOT*i)/(float) time);
+	runner->addBenchmark(new StropBenchCase("mautil_append_char", this, APPEND, MAUTIL_STRING, 0));
+	runner->addBenchmark(new StropBenchCase("mautil_append_string", this, APPEND, MAUTIL_STRING, 1));
+	runner->addBenchmark(new StropBenchCase("mautil_copy", this, COPY, MAUTIL_STRING, 0));
+	runner->addBenchmark(new StropBenchCase("mautil_find", this, FIND, MAUTIL_STRING, 0));
+	runner->addBenchmark(new StropBenchCase("mautil_find_last_of", this, FIND, MAUTIL_STRING, 1));
+	runner->addBenchmark(new StropBenchCase("mautil_find_first_of", this, FIND, MAUTIL_STRING, 2));
+	runner->addBenchmark(new StropBenchCase("mautil_find_first_not_of", this, FIND, MAUTIL_STRING, 3));
+	runner->addBenchmark(new StropBenchCase("mautil_substr", this, SUBSTR, MAUTIL_STRING, 0));
+	runner->addBenchmark(new StropBenchCase("mautil_insert_char", this, INSERT, MAUTIL_STRING, 0));
+	runner->addBenchmark(new StropBenchCase("mautil_insert_string", this, INSERT, MAUTIL_STRING, 1));
+	runner->addBenchmark(new StropBenchCase("mautil_remove", this, REMOVE, MAUTIL_STRING, 0));
+	runner->addBenchmark(new StropBenchCase("mautil_resize", this, RESIZE, MAUTIL_STRING, 0));
+	runner->addBenchmark(new StropBenchCase("mautil_equal", this, COMPARE, MAUTIL_STRING, 0));
+	runner->addBenchmark(new StropBenchCase("mautil_not_equal", this, COMPARE, MAUTIL_STRING, 1));
+	runner->addBenchmark(new StropBenchCase("mautil_less_equal", this, COMPARE, MAUTIL_STRING, 2));
+	runner->addBenchmark(new StropBenchCase("mautil_greater_equal", this, COMPARE, MAUTIL_STRING, 3));
+	runner->addBenchmark(new StropBenchCase("mautil_less", this, COMPARE, MAUTIL_STRING, 4));
+	runner->addBenchmark(new StropBenchCase("mautil_greater", this, COMPARE, MAUTIL_STRING, 5));
+}
 
-	for(i = 1; (time = this->compare(i, MAUTIL_STRING, 5)) < RUNNING_TIME; i*=2);
-	printf("operator> %dK times: ", ALOT*i/1000);
-	printf("%1.2f KSTROPS\n", (float) (ALOT*i)/(float) time);
+StropBenchCase::StropBenchCase(const MAUtil::String& name, StropBencher* bencher, int func, int strType, int arg) :
+	MATest::BenchmarkCase(name), mBencher(bencher), mFunc(func), mStrType(strType), mArg(arg) {
+}
 
-	//freeze until 0 is pressed
-	FREEZE;
+void StropBenchCase::run(int iterations) {
+	switch(mFunc) {
+	case APPEND: mBencher->appender(iterations, mStrType, mArg); break;
+	case COPY: mBencher->copy(iterations, mStrType); break;
+	case FIND: mBencher->find(iterations, mStrType, mArg); break;
+	case INSERT: mBencher->insert(iterations, mStrType, mArg); break;
+	case SUBSTR: mBencher->substr(iterations, mStrType); break;
+	case REMOVE: mBencher->remove(iterations, mStrType); break;
+	case RESIZE: mBencher->resize(iterations, mStrType); break;
+	case COMPARE: mBencher->compare(iterations, mStrType, mArg); break;
+	}
 }
 
 
@@ -24,6 +24,7 @@ limitations under the License.
 #define STROPBENCH_H_
 
 #include <MAUtil/String.h>
+#include <MATest/BenchmarkRunner.h>
 #include <ma.h>
 #include <conprint.h>
 #include <maassert.h> //give access to FREEZE macro
@@ -33,7 +34,16 @@ limitations under the License.
 #define ALOT 256 //used as number of iterations when we want to do a lot of operations
 #define MAUTIL_STRING 0
 #define STD_STRING 1
-#define	RUNNING_TIME 1000 //running time per test in msecs
+
+/* Benchmark functions */
+#define APPEND 0
+#define COPY 1
+#define FIND 2
+#define INSERT 3
+#define SUBSTR 4
+#define REMOVE 5
+#define RESIZE 6
+#define COMPARE 7
 
 class StropBencher {
 public:
@@ -41,11 +51,10 @@ public:
 	StropBencher();
 	~StropBencher();
 
-	void bench();
-
-private:
+	/* add the benchmarks to a runner */
+	void addBenchmarks(MATest::BenchmarkRunner* runner);
 
-	/* Benchmark functions, returns STROPS */
+	/* Benchmark functions, one run is ALOT operations, returns the time in msecs */
 	int appender(int numRuns, int strType, int func);
 	int copy(int numRuns, int strType);
 	int find(int numRuns, int strType, int func);
@@ -55,6 +64,8 @@ private:
 	int resize(int numRuns, int strType);
 	int compare(int numRuns, int strType, int cmpType);
 
+private:
+
 	/* Timer functions */
 	int currTime();
 
@@ -66,4 +77,20 @@ private:
 
 };
 
+/*
+ * Measures one of the StropBencher functions as a benchmark
+ */
+class StropBenchCase : public MATest::BenchmarkCase {
+public:
+	StropBenchCase(const MAUtil::String& name, StropBencher* bencher, int func, int strType, int arg);
+
+	virtual void run(int iterations);
+
+private:
+	StropBencher* mBencher;
+	int mFunc;
+	int mStrType;
+	int mArg;
+};
+
 #endif /* STROPBENCH_H_ */
@@ -0,0 +1,13 @@
+#!/usr/bin/ruby
+
+require File.expand_path('../../../../rules/mosync_exe.rb')
+
+work = PipeExeWork.new
+work.instance_eval do
+	@SOURCES = ["."]
+	@LIBRARIES = ["stlport", "mautil", "matest"]
+	@NAME = "StropBench"
+	@EXTRA_EMUFLAGS = " -noscreen"
+end
+
+work.invoke
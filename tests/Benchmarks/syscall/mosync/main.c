@@ -0,0 +1,67 @@
+/* Copyright 2013 David Axmark
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+	http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+// Measures syscall dispatch overhead: tight loops of cheap syscalls,
+// and of syscalls with memory ranges that the core validates.
+// Logs the number of calls per millisecond for each.
+
+#include <ma.h>
+#include <mavsprintf.h>
+#include <maassert.h>
+
+#define CALLS 1000000
+#define BUFFER_SIZE 16
+
+static char sSrc[BUFFER_SIZE], sDst[BUFFER_SIZE];
+// not a constant, so that the compiler can't inline memcpy.
+static int sSize = BUFFER_SIZE;
+
+static void report(const char* name, int start) {
+	int ms = maGetMilliSecondCount() - start;
+	if(ms == 0)
+		ms = 1;
+	lprintfln("%s: %i calls, %i ms, %i calls/ms", name, CALLS, ms, CALLS / ms);
+}
+
+int MAMain(void) {
+	MAHandle data = maCreatePlaceholder();
+	int i, start;
+
+	maCreateData(data, BUFFER_SIZE);
+
+	start = maGetMilliSecondCount();
+	for(i = 0; i < CALLS; i++)
+		maGetMilliSecondCount();
+	report("maGetMilliSecondCount", start);
+
+	start = maGetMilliSecondCount();
+	for(i = 0; i < CALLS; i++)
+		maSetColor(i);
+	report("maSetColor", start);
+
+	start = maGetMilliSecondCount();
+	for(i = 0; i < CALLS; i++)
+		memcpy(sDst, sSrc, sSize);
+	report("memcpy", start);
+
+	start = maGetMilliSecondCount();
+	for(i = 0; i < CALLS; i++)
+		maReadData(data, sDst, 0, sSize);
+	report("maReadData", start);
+
+	maDestroyObject(data);
+	lprintfln("done");
+	FREEZE;
+}
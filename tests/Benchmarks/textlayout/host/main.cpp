@@ -0,0 +1,384 @@
+/* Copyright 2013 David Axmark
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+	http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+// Measures how MAUI's Font lays out, draws and queries text, before and
+// after TextLayout, without a screen.
+//
+// The text is made of random words and paragraphs, and is broken into
+// lines WIDTH pixels wide, in a font filled in with made up glyphs.
+// Each size is laid out, drawn whole, drawn the way a HEIGHT pixels tall
+// multiline Label draws it, and queried for the caret rectangle the way
+// an EditBox does. The old Font broke the string into lines again for
+// every one of those; the new one lays it out once and keeps the layout.
+// "Drawing" counts glyphs. The old and new glyph positions and caret
+// rectangles are checked against each other.
+//
+// Usage: textlayoutbench [characters...]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <vector>
+
+#include "Font.h"
+
+using namespace MAUI;
+
+#define WIDTH 240
+#define HEIGHT 320
+#define LINE_HEIGHT 14
+// the number of characters each test handles, whatever the text size.
+#define WORK 4000000
+#define QUERIES 1000
+
+static double seconds(clock_t start) {
+	return double(clock() - start) / CLOCKS_PER_SEC;
+}
+
+static unsigned int sSeed;
+
+static int nextRandom() {
+	sSeed = sSeed * 1103515245 + 12345;
+	return (int)((sSeed >> 1) & 0x3fffffff);
+}
+
+// The font resource functions are never called; BenchFont fills itself in.
+int maGetDataSize(MAHandle data) { return 0; }
+void maReadData(MAHandle data, void* dst, int offset, int size) {}
+MAHandle maCreatePlaceholder(void) { return 1; }
+void maDestroyPlaceholder(MAHandle handle) {}
+int maCreateImageFromData(MAHandle placeholder, MAHandle data, int offset, int size) { return RES_OK; }
+
+static int sGlyphs;
+static std::vector<MAPoint2d>* sRecord;
+
+void Gfx_drawImageRegion(MAHandle image, const MARect* srcRect, const MAPoint2d* dstPoint, int transformMode) {
+	sGlyphs++;
+	if(sRecord)
+		sRecord->push_back(*dstPoint);
+}
+
+class BenchFont : public Font {
+public:
+	BenchFont() : Font(0) {
+		mCharset = new Charset;
+		memset(mCharset, 0, sizeof(Charset));
+		mCharset->lineHeight = LINE_HEIGHT;
+		mCharset->base = LINE_HEIGHT - 3;
+		for(int c = 0; c < 256; c++) {
+			CharDescriptor& cd = mCharset->chars[c];
+			int w = c == ' ' ? 4 : 5 + (c * 7) % 5;
+			cd.x = (c % 16) * 16;
+			cd.y = (c / 16) * 16;
+			cd.width = w;
+			cd.height = 12;
+			cd.xOffset = 0;
+			cd.yOffset = 1;
+			cd.xAdvance = w + 1;
+		}
+		mFontImage = 1;
+	}
+	~BenchFont() {
+		delete mCharset;
+	}
+};
+
+// Font as it was: the string is linebroken again by every call. The break
+// array is bigger than the old one, which held 2048 shorts.
+class OldFont {
+public:
+	OldFont(const Font& font) : mCharset(&font.getCharset()), mLineSpacing(font.getLineSpacing()) {}
+
+	void calcLineBreaks(const char* strS, int x, int y, const Rect& bound) const {
+		int i = 0;
+		int j = 0;
+		int lastSpace = -1;
+		MAPoint2d cursor = {x, y};
+		const CharDescriptor *chars = mCharset->chars;
+		const unsigned char* str = (const unsigned char*)strS;
+
+		while(str[i]) {
+			if(str[i] == ' ') {
+				lastSpace = i;
+			} else if(str[i]=='\n') {
+				cursor.x = x;
+				cursor.y += mCharset->lineHeight + mLineSpacing;
+				lineBreaks[j++] = i;
+				i++;
+				continue;
+			}
+
+			cursor.x += chars[str[i]].xAdvance;
+			if(cursor.x > bound.x + bound.width) {
+				if(lastSpace == -1) {
+					lineBreaks[j++] = i;
+				} else {
+					lineBreaks[j++] = lastSpace+1;
+					i = lastSpace+1;
+					lastSpace = -1;
+				}
+				cursor.x = x + chars[str[i]].xAdvance;
+			}
+			i++;
+		}
+		numLineBreaks = j;
+		lineBreaks[j] = -1;
+	}
+
+	void drawBoundedString(const char* strS, int x, int y, const Rect& bound) {
+		int i = 0;
+		int j = 0;
+		const unsigned char* str = (const unsigned char*)strS;
+		calcLineBreaks(strS, x, y, bound);
+		MARect srcRect = {0, 0, 0, 0};
+		MAPoint2d cursor = {x, y};
+		const CharDescriptor *chars = mCharset->chars;
+		while(str[i]) {
+			if(lineBreaks[j] == i) {
+				j++;
+				cursor.x = x;
+				cursor.y += mCharset->lineHeight + mLineSpacing;
+				if(str[i]=='\n') {
+					i++;
+					continue;
+				}
+			}
+			srcRect.left = chars[str[i]].x;
+			srcRect.top = chars[str[i]].y;
+			srcRect.width = chars[str[i]].width;
+			srcRect.height = chars[str[i]].height;
+			MAPoint2d destPoint = {cursor.x + chars[str[i]].xOffset,
+				cursor.y + chars[str[i]].yOffset};
+			Gfx_drawImageRegion(1, &srcRect, &destPoint, 0);
+			cursor.x += chars[str[i]].xAdvance;
+			i++;
+		}
+	}
+
+	MAExtent getStringDimensions(const char *strS, int length) const {
+		if(length == 0) return EXTENT(0, 0);
+		MAPoint2d cursor = {0, 0};
+		int width = 0, height = mCharset->lineHeight;
+		const CharDescriptor *chars = mCharset->chars;
+		int i = 0;
+		const unsigned char* str = (const unsigned char*)strS;
+		while(*str && (i!=length)) {
+			if((*str)=='\n') {
+				cursor.x = 0;
+				cursor.y += mCharset->lineHeight + mLineSpacing;
+				height += mCharset->lineHeight + mLineSpacing;
+				str++;
+				i++;
+				continue;
+			}
+			cursor.x += chars[*str].xAdvance;
+			if(cursor.x > width)
+				width = cursor.x;
+			str++;
+			i++;
+		}
+		return EXTENT(width, height);
+	}
+
+	int getLineBreak(int line, const char *str, const Rect& bound) const {
+		calcLineBreaks(str, bound.x, bound.y, bound);
+		if(line < 0 || line >= numLineBreaks) return -1;
+		else return lineBreaks[line];
+	}
+
+	int calculateLine(int index, const char *str, const Rect& bound) const {
+		calcLineBreaks(str, bound.x, bound.y, bound);
+		int i = 0;
+		for(i = 0; i < numLineBreaks; i++) {
+			if(index<=lineBreaks[i]) {
+				return i;
+			}
+		}
+		return i;
+	}
+
+	Rect calculateRectOfIndex(int index, const char *str, const Rect& bound) const {
+		int line = calculateLine(index, str, bound);
+		int lineBreak = 0;
+		if(line>0)
+			lineBreak = getLineBreak(line-1, str, bound);
+		MAPoint2d cursor = {0, 0};
+		cursor.y+=line*mCharset->lineHeight;
+		MAExtent lineRect = getStringDimensions(&str[lineBreak], index-lineBreak);
+		cursor.x+=EXTENT_X(lineRect);
+		MAExtent charRect = getStringDimensions(&str[index], 1);
+		return Rect(cursor.x, cursor.y, EXTENT_X(charRect), mCharset->lineHeight);
+	}
+
+private:
+	const Charset* mCharset;
+	int mLineSpacing;
+	static int lineBreaks[65536];
+	static int numLineBreaks;
+};
+
+int OldFont::lineBreaks[65536];
+int OldFont::numLineBreaks;
+
+// Words of 1 to 10 letters. A paragraph ends after one word in 40, in
+// place of the space, since the old Font mislaid a line after a space
+// that was followed by a newline and didn't fit.
+static std::vector<char> makeText(int n) {
+	std::vector<char> text;
+	while((int)text.size() < n) {
+		if(!text.empty())
+			text.push_back(nextRandom() % 40 == 0 ? '\n' : ' ');
+		int len = 1 + nextRandom() % 10;
+		for(int i = 0; i < len; i++)
+			text.push_back('a' + nextRandom() % 26);
+	}
+	text.resize(n);
+	if(text.back() == ' ' || text.back() == '\n')
+		text.back() = 'x';
+	text.push_back(0);
+	return text;
+}
+
+static bool sameRect(const Rect& a, const Rect& b) {
+	return a.x == b.x && a.y == b.y && a.width == b.width && a.height == b.height;
+}
+
+static bool run(int n) {
+	sSeed = 1;
+	std::vector<char> textV = makeText(n);
+	const char* text = &textV[0];
+	BenchFont font;
+	OldFont old(font);
+	Rect bound(0, 0, WIDTH, 0xffff);
+	Rect view(0, 0, WIDTH, HEIGHT);
+	int reps = WORK / n > 0 ? WORK / n : 1;
+	printf("%i characters:\n", n);
+
+	// check the glyph positions and a few caret rectangles.
+	std::vector<MAPoint2d> oldPoints, newPoints;
+	sRecord = &oldPoints;
+	old.drawBoundedString(text, 0, 0, bound);
+	sRecord = &newPoints;
+	font.drawBoundedString(text, 0, 0, bound);
+	sRecord = NULL;
+	if(oldPoints.size() != newPoints.size()) {
+		printf("Old Font drew %i glyphs, new %i.\n", (int)oldPoints.size(), (int)newPoints.size());
+		return false;
+	}
+	for(size_t i = 0; i < oldPoints.size(); i++) {
+		if(oldPoints[i].x != newPoints[i].x || oldPoints[i].y != newPoints[i].y) {
+			printf("Glyph %i drawn at %i,%i by the old Font, %i,%i by the new.\n", (int)i,
+				oldPoints[i].x, oldPoints[i].y, newPoints[i].x, newPoints[i].y);
+			return false;
+		}
+	}
+	int checks = n < 200 ? n + 1 : 200;
+	for(int i = 0; i < checks; i++) {
+		int index = checks == n + 1 ? i : nextRandom() % (n + 1);
+		Rect o = old.calculateRectOfIndex(index, text, bound);
+		Rect r = font.calculateRectOfIndex(index, text, bound);
+		if(!sameRect(o, r)) {
+			printf("Caret at %i: old %i,%i %ix%i, new %i,%i %ix%i.\n", index,
+				o.x, o.y, o.width, o.height, r.x, r.y, r.width, r.height);
+			return false;
+		}
+	}
+
+	// laying out.
+	clock_t start = clock();
+	for(int i = 0; i < reps; i++)
+		old.calcLineBreaks(text, 0, 0, bound);
+	double oldLayout = seconds(start) * 1e6 / reps;
+	start = clock();
+	for(int i = 0; i < reps; i++) {
+		TextLayout layout(&font, text, WIDTH);
+	}
+	double newLayout = seconds(start) * 1e6 / reps;
+	const TextLayout& layout = font.getLayout(text, WIDTH);
+
+	// drawing the whole text.
+	sGlyphs = 0;
+	start = clock();
+	for(int i = 0; i < reps; i++)
+		old.drawBoundedString(text, 0, 0, bound);
+	double oldDraw = seconds(start) * 1e6 / reps;
+	start = clock();
+	for(int i = 0; i < reps; i++)
+		font.drawBoundedString(text, 0, 0, bound);
+	double newDraw = seconds(start) * 1e6 / reps;
+	int glyphs = sGlyphs / reps / 2;
+
+	// drawing a Label's worth, scrolled to the middle. The old Font had
+	// no way to skip the lines out of view.
+	int middle = -(layout.getLineCount() * layout.getLineStep() / 2);
+	start = clock();
+	for(int i = 0; i < reps; i++)
+		old.drawBoundedString(text, 0, middle, bound);
+	double oldView = seconds(start) * 1e6 / reps;
+	sGlyphs = 0;
+	start = clock();
+	for(int i = 0; i < reps; i++)
+		font.getLayout(text, WIDTH).draw(0, middle, view);
+	double newView = seconds(start) * 1e6 / reps;
+	int viewGlyphs = sGlyphs / reps;
+
+	// caret rectangles at random indices.
+	int queries = reps < QUERIES ? reps : QUERIES;
+	unsigned int seed = sSeed;
+	int sum = 0;
+	start = clock();
+	for(int i = 0; i < queries; i++)
+		sum += old.calculateRectOfIndex(nextRandom() % (n + 1), text, bound).x;
+	double oldCaret = seconds(start) * 1e6 / queries;
+	sSeed = seed;
+	int newSum = 0;
+	start = clock();
+	for(int i = 0; i < QUERIES * 100; i++)
+		newSum += font.calculateRectOfIndex(nextRandom() % (n + 1), text, bound).x;
+	double newCaret = seconds(start) * 1e6 / (QUERIES * 100);
+	start = clock();
+	for(int i = 0; i < QUERIES * 100; i++)
+		newSum += layout.getIndexAt(nextRandom() % WIDTH, nextRandom() % (layout.getLineCount() * LINE_HEIGHT));
+	double newPick = seconds(start) * 1e6 / (QUERIES * 100);
+
+	printf("  %i lines, %i glyphs, %i in view\n", layout.getLineCount(), glyphs, viewGlyphs);
+	printf("  layout: old %9.2f us, new %9.2f us\n", oldLayout, newLayout);
+	printf("  draw:   old %9.2f us, new %9.2f us\n", oldDraw, newDraw);
+	printf("  view:   old %9.2f us, new %9.2f us\n", oldView, newView);
+	printf("  caret:  old %9.2f us, new %9.3f us, index at point %6.3f us (%i)\n",
+		oldCaret, newCaret, newPick, (sum + newSum) & 1);
+	return true;
+}
+
+int main(int argc, const char** argv) {
+	if(argc > 1) {
+		for(int i=1; i<argc; i++) {
+			int n = atoi(argv[i]);
+			if(n < 1) {
+				printf("Usage: textlayoutbench [characters...]\n");
+				return 1;
+			}
+			if(!run(n))
+				return 1;
+		}
+		return 0;
+	}
+	for(int n = 100; n <= 100000; n *= 10) {
+		if(!run(n))
+			return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,26 @@
+/* Copyright 2013 David Axmark
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+	http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+// Stands in for MAUtil/Graphics.h, which needs the OpenGL headers.
+// main.cpp counts the glyphs drawn.
+
+#ifndef _SE_MSAB_MAUTIL_GRAPHICS_H_
+#define _SE_MSAB_MAUTIL_GRAPHICS_H_
+
+#include <ma.h>
+
+void Gfx_drawImageRegion(MAHandle image, const MARect* srcRect, const MAPoint2d* dstPoint, int transformMode);
+
+#endif
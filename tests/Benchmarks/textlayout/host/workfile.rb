@@ -0,0 +1,25 @@
+#!/usr/bin/ruby
+
+# Host build of the MAUI text layout benchmark. Only Font and TextLayout
+# are compiled from MAUI; stub replaces MAUtil/Graphics.h, so that main.cpp
+# can count the glyphs drawn.
+
+require File.expand_path('../../../../rules/exe.rb')
+
+MAUI_DIR = "../../../../libs/MAUI"
+
+work = ExeWork.new
+work.instance_eval do
+	@SOURCES = ["."]
+	@EXTRA_SOURCEFILES = [
+		"#{MAUI_DIR}/Font.cpp",
+		"#{MAUI_DIR}/TextLayout.cpp",
+		"../../../../libs/MAUtil/Geometry.cpp",
+		"../../../../libs/MAUtil/String.cpp",
+		"../../../../libs/MAUtil/RefCounted.cpp",
+	]
+	@EXTRA_INCLUDES = ["stub", "../../common/host/stub", MAUI_DIR, "../../../../libs"]
+	@NAME = "textlayoutbench"
+end
+
+work.invoke
@@ -0,0 +1,122 @@
+/* Copyright 2013 David Axmark
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+	http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+// Scrolls a large two-layer map across the screen, first drawing it with
+// one maDrawImageRegion() per visible tile, then with maTileMapDraw().
+
+#include <ma.h>
+#include <maheap.h>
+#include <conprint.h>
+
+#define TILE_SIZE 16
+#define TILES_PER_ROW 16
+#define NUM_TILES (TILES_PER_ROW * TILES_PER_ROW)
+#define MAP_SIZE 512
+#define FRAMES 300
+
+static unsigned short sGround[MAP_SIZE * MAP_SIZE];
+static unsigned short sClouds[MAP_SIZE * MAP_SIZE];
+
+// a tile set of NUM_TILES differently coloured squares.
+static MAHandle createTileSet() {
+	MAHandle img = maCreatePlaceholder();
+	maCreateDrawableImage(img, TILES_PER_ROW * TILE_SIZE, TILES_PER_ROW * TILE_SIZE);
+	maSetDrawTarget(img);
+	for(int i = 0; i < NUM_TILES; i++) {
+		int x = (i % TILES_PER_ROW) * TILE_SIZE, y = (i / TILES_PER_ROW) * TILE_SIZE;
+		maSetColor(i * 0x010305);
+		maFillRect(x, y, TILE_SIZE, TILE_SIZE);
+		maSetColor(0xffffff);
+		maLine(x, y, x + TILE_SIZE - 1, y + TILE_SIZE - 1);
+	}
+	maSetDrawTarget(HANDLE_SCREEN);
+	return img;
+}
+
+// map data in the .tilemap resource format.
+static MAHandle createMapData(const unsigned short* tiles) {
+	MAHandle data = maCreatePlaceholder();
+	unsigned short header[2] = { MAP_SIZE, MAP_SIZE };
+	maCreateData(data, sizeof(header) + MAP_SIZE * MAP_SIZE * 2);
+	maWriteData(data, header, 0, sizeof(header));
+	maWriteData(data, tiles, sizeof(header), MAP_SIZE * MAP_SIZE * 2);
+	return data;
+}
+
+static void drawLayerPerTile(MAHandle tileSet, const unsigned short* tiles,
+	int scrollX, int scrollY, int screenW, int screenH)
+{
+	int tx0 = scrollX / TILE_SIZE, ty0 = scrollY / TILE_SIZE;
+	int tx1 = (scrollX + screenW - 1) / TILE_SIZE;
+	int ty1 = (scrollY + screenH - 1) / TILE_SIZE;
+	for(int ty = ty0; ty <= ty1 && ty < MAP_SIZE; ty++) {
+		for(int tx = tx0; tx <= tx1 && tx < MAP_SIZE; tx++) {
+			int t = tiles[tx + ty * MAP_SIZE];
+			if(t == 0)
+				continue;
+			t--;
+			MARect src = { (t % TILES_PER_ROW) * TILE_SIZE, (t / TILES_PER_ROW) * TILE_SIZE,
+				TILE_SIZE, TILE_SIZE };
+			MAPoint2d dst = { tx * TILE_SIZE - scrollX, ty * TILE_SIZE - scrollY };
+			maDrawImageRegion(tileSet, &src, &dst, TRANS_NONE);
+		}
+	}
+}
+
+extern "C" int MAMain() {
+	MAExtent scr = maGetScrSize();
+	int w = EXTENT_X(scr), h = EXTENT_Y(scr);
+
+	for(int i = 0; i < MAP_SIZE * MAP_SIZE; i++) {
+		sGround[i] = 1 + (i * 7 + i / MAP_SIZE) % NUM_TILES;
+		sClouds[i] = (i % 5 == 0) ? 1 + i % NUM_TILES : 0;
+	}
+	MAHandle tileSet = createTileSet();
+
+	// per tile. the cloud layer scrolls at half speed.
+	int start = maGetMilliSecondCount();
+	for(int f = 0; f < FRAMES; f++) {
+		drawLayerPerTile(tileSet, sGround, f * 3, f * 2, w, h);
+		drawLayerPerTile(tileSet, sClouds, (f * 3) / 2, f, w, h);
+		maUpdateScreen();
+	}
+	int perTile = maGetMilliSecondCount() - start;
+
+	MAHandle tileMap = maTileMapCreate(tileSet, TILE_SIZE, TILE_SIZE);
+	if(tileMap < 0) {
+		printf("maTileMapCreate: %i\n", tileMap);
+		maWait(0);
+		return 0;
+	}
+	maTileMapAddLayer(tileMap, createMapData(sGround), 0x10000, 0x10000);
+	maTileMapAddLayer(tileMap, createMapData(sClouds), 0x8000, 0x8000);
+	MARect area = { 0, 0, w, h };
+
+	start = maGetMilliSecondCount();
+	for(int f = 0; f < FRAMES; f++) {
+		// an edit every frame, to include the cost of redrawing a chunk.
+		maTileMapSetTile(tileMap, 0, (f * 3) / TILE_SIZE + 1, (f * 2) / TILE_SIZE + 1, 1 + f % NUM_TILES);
+		maTileMapDraw(tileMap, &area, f * 3, f * 2);
+		maUpdateScreen();
+	}
+	int chunked = maGetMilliSecondCount() - start;
+	maTileMapDestroy(tileMap);
+
+	printf("%ix%i, %i frames\n", w, h, FRAMES);
+	printf("per tile:    %i ms\n", perTile);
+	printf("maTileMap:   %i ms\n", chunked);
+	maWait(0);
+	return 0;
+}
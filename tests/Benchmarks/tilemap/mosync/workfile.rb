@@ -0,0 +1,12 @@
+#!/usr/bin/ruby
+
+require File.expand_path('../../../../rules/mosync_exe.rb')
+
+work = PipeExeWork.new
+work.instance_eval do
+	@SOURCES = ["."]
+	@EXTRA_LINKFLAGS = " -heapsize=1024000"
+	@NAME = "TileMapBench"
+end
+
+work.invoke
@@ -0,0 +1,285 @@
+/* Copyright 2013 David Axmark
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+	http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+// Feeds recorded Wormhole message batches to the MessageDecoder and
+// dispatches each message the way MessageHandler does, through a
+// sorted function table. Prints messages per second and heap allocations
+// per message, and the same for the old decoding of "ms:" streams,
+// which copied each batch into a new buffer. First checks that strings
+// with truncated \\u escapes are rejected.
+//
+// Usage: wormholebench [iterations]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <new>
+
+#include <ma.h>
+#include "MessageDecoder.h"
+
+using namespace Wormhole;
+
+static int sAllocations = 0;
+
+void* countedMalloc(size_t size) {
+	sAllocations++;
+	return (malloc)(size);
+}
+
+void* countedRealloc(void* ptr, size_t size) {
+	sAllocations++;
+	return (realloc)(ptr, size);
+}
+
+void* operator new(size_t size) {
+	sAllocations++;
+	void* p = (malloc)(size);
+	if(!p)
+		throw std::bad_alloc();
+	return p;
+}
+
+void operator delete(void* p) throw() {
+	free(p);
+}
+
+// Data handles.
+struct Data {
+	char* bytes;
+	int size;
+};
+static Data sData[4];
+static int sDataCount = 0;
+
+int maGetDataSize(MAHandle data) {
+	return sData[data - 1].size;
+}
+
+void maReadData(MAHandle data, void* dst, int offset, int size) {
+	memcpy(dst, sData[data - 1].bytes + offset, size);
+}
+
+static MAHandle loadStream(const char* path) {
+	FILE* file = fopen(path, "rb");
+	if(!file) {
+		printf("Could not open %s\n", path);
+		exit(1);
+	}
+	fseek(file, 0, SEEK_END);
+	Data& d = sData[sDataCount++];
+	d.size = ftell(file);
+	fseek(file, 0, SEEK_SET);
+	d.bytes = (char*)(malloc)(d.size);
+	if(fread(d.bytes, 1, d.size, file) != (size_t)d.size) {
+		printf("Could not read %s\n", path);
+		exit(1);
+	}
+	fclose(file);
+	return sDataCount;
+}
+
+// A stand-in for a handler that reads the rest of its message.
+typedef void (*StreamFun)(MessageDecoder* decoder);
+
+static int sChecksum = 0;
+
+static void consume(const char* s) {
+	if(s)
+		sChecksum += s[0];
+}
+
+static void nativeUI(MessageDecoder* decoder) {
+	const char* command = decoder->nextString();
+	bool set = 0 == strcmp(command, "maWidgetSetProperty");
+	for(int i = 0; i < (set ? 4 : 3); i++)
+		consume(decoder->nextString());
+}
+
+static void oneArg(MessageDecoder* decoder) {
+	consume(decoder->nextString());
+	consume(decoder->nextString());
+}
+
+static void resource(MessageDecoder* decoder) {
+	for(int i = 0; i < 3; i++)
+		consume(decoder->nextString());
+}
+
+struct StreamEntry {
+	const char* name;
+	StreamFun fun;
+};
+
+// Sorted by name, for binary search as in FunTable.
+static const StreamEntry sStreamFuns[] = {
+	{ "Custom", oneArg },
+	{ "MoSync", oneArg },
+	{ "NativeUI", nativeUI },
+	{ "Resource", resource },
+};
+static const int sStreamFunCount = sizeof(sStreamFuns) / sizeof(StreamEntry);
+
+static StreamFun findStreamFun(const char* name) {
+	int low = 0, high = sStreamFunCount;
+	while(low < high) {
+		int mid = (low + high) / 2;
+		int result = strcmp(sStreamFuns[mid].name, name);
+		if(result == 0)
+			return sStreamFuns[mid].fun;
+		if(result < 0)
+			low = mid + 1;
+		else
+			high = mid;
+	}
+	return NULL;
+}
+
+static int decodeStream(MAHandle data) {
+	int messages = 0;
+	MessageDecoder* decoder = MessageDecoder::acquire();
+	if(decoder->load(data) == MessageDecoder::PROTOCOL_STREAM) {
+		const char* name;
+		while((name = decoder->nextString()) != NULL) {
+			StreamFun fun = findStreamFun(name);
+			if(!fun) {
+				printf("Unknown message %s\n", name);
+				exit(1);
+			}
+			fun(decoder);
+			messages++;
+		}
+	}
+	MessageDecoder::release(decoder);
+	return messages;
+}
+
+static int decodeJSON(MAHandle data) {
+	int messages = 0;
+	char buf[256];
+	MessageDecoder* decoder = MessageDecoder::acquire();
+	if(decoder->load(data) == MessageDecoder::PROTOCOL_JSON && decoder->parseJSON()) {
+		const JSONValue* message = decoder->getFirstChild(decoder->getRoot());
+		for(; message; message = decoder->getNextSibling(message)) {
+			const JSONValue* name = decoder->getValueForKey(message, "messageName");
+			if(decoder->stringEquals(name, "PhoneGap")) {
+				consume(decoder->getValueForKey(message, "service")->text.data);
+				consume(decoder->getValueForKey(message, "action")->text.data);
+				const JSONValue* args = decoder->getValueForKey(message, "args");
+				const JSONValue* value = decoder->getValueForKey(args, "data");
+				if(value && decoder->copyString(value, NULL) < (int)sizeof(buf)) {
+					decoder->copyString(value, buf);
+					consume(buf);
+				}
+				sChecksum += decoder->toInt(decoder->getValueForKey(args, "position"));
+				sChecksum += decoder->toBoolean(decoder->getValueForKey(args, "append"));
+				consume(decoder->getValueForKey(message, "PhoneGapCallBackId")->text.data);
+			} else if(decoder->stringEquals(name, "Custom")) {
+				sChecksum += decoder->toInt(decoder->getValueForKey(message, "score"));
+			} else {
+				printf("Unknown message\n");
+				exit(1);
+			}
+			messages++;
+		}
+	}
+	MessageDecoder::release(decoder);
+	return messages;
+}
+
+// The decoding done by MessageStream before MessageDecoder.
+static int decodeStreamLegacy(MAHandle data) {
+	int messages = 0;
+	int dataSize = maGetDataSize(data);
+	char* buf = (char*)countedMalloc(dataSize + 1);
+	maReadData(data, buf, 0, dataSize);
+	buf[dataSize] = 0;
+	char* end = NULL;
+	for(;;) {
+		char* p = end ? end + 1 : buf + 3;
+		if(p - buf >= dataSize)
+			break;
+		int len = 0, factor = 1, i;
+		for(i = 0; p[i] != ' '; i++) {
+			len += factor * (p[i] - 33);
+			factor *= 93;
+		}
+		p += i;
+		end = p + 1 + len;
+		if(end - buf >= dataSize)
+			break;
+		*end = 0;
+		if(findStreamFun(p + 1))
+			messages++;
+	}
+	free(buf);
+	return messages;
+}
+
+// Returns true if the decoder rejects every message.
+static bool rejectsBadEscapes() {
+	static const char* bad[] = {
+		"ma:[\"\\u", "ma:[\"\\u12", "ma:[\"\\u12\"]", "ma:[\"\\u12g4\"]", "ma:[\"\\uD800\\u\"]",
+	};
+	bool ok = true;
+	MessageDecoder* decoder = MessageDecoder::acquire();
+	for(size_t i = 0; i < sizeof(bad) / sizeof(*bad); i++) {
+		if(decoder->load(bad[i], strlen(bad[i])) == MessageDecoder::PROTOCOL_JSON && decoder->parseJSON()) {
+			printf("accepted %s\n", bad[i]);
+			ok = false;
+		}
+	}
+	const char* good = "ma:[\"\\u00e5\\uD83D\\uDE00\"]";
+	if(decoder->load(good, strlen(good)) != MessageDecoder::PROTOCOL_JSON || !decoder->parseJSON()) {
+		printf("rejected %s\n", good);
+		ok = false;
+	}
+	MessageDecoder::release(decoder);
+	return ok;
+}
+
+typedef int (*DecodeFun)(MAHandle data);
+
+static void run(const char* title, DecodeFun decode, MAHandle data, int iterations) {
+	// Warm up, so that the decoder's buffers have grown.
+	int perBatch = decode(data);
+	int allocations = sAllocations;
+	clock_t start = clock();
+	int messages = 0;
+	for(int i = 0; i < iterations; i++)
+		messages += decode(data);
+	double seconds = double(clock() - start) / CLOCKS_PER_SEC;
+	allocations = sAllocations - allocations;
+	printf("%-24s %4i messages/batch %10.0f messages/s %6.3f allocations/message\n",
+		title, perBatch, seconds > 0 ? messages / seconds : 0,
+		double(allocations) / messages);
+}
+
+int main(int argc, char** argv) {
+	int iterations = argc > 1 ? atoi(argv[1]) : 20000;
+	MAHandle stream = loadStream("streams/nativeui.txt");
+	MAHandle json = loadStream("streams/phonegap.txt");
+	if(!rejectsBadEscapes())
+		return 1;
+
+	// The legacy decoder only counts the message names it finds,
+	// so compare it with a full decode of the same batch.
+	run("ms: legacy", decodeStreamLegacy, stream, iterations);
+	run("ms: MessageDecoder", decodeStream, stream, iterations);
+	run("ma: MessageDecoder", decodeJSON, json, iterations);
+	printf("checksum %i\n", sChecksum);
+	return 0;
+}
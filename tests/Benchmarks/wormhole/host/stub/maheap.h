@@ -0,0 +1,29 @@
+/* Copyright 2013 David Axmark
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+	http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+// Routes the decoder's heap allocations through the counters in main.cpp.
+
+#ifndef MAHEAP_H
+#define MAHEAP_H
+
+#include <stdlib.h>
+
+void* countedMalloc(size_t size);
+void* countedRealloc(void* ptr, size_t size);
+
+#define malloc countedMalloc
+#define realloc countedRealloc
+
+#endif	//MAHEAP_H
@@ -0,0 +1,17 @@
+#!/usr/bin/ruby
+
+# Host build of the Wormhole message decoder benchmark.
+# Run it from this directory, it reads the recorded streams from streams/.
+# The stub directory's maheap.h counts the decoder's allocations.
+
+require File.expand_path('../../../../rules/exe.rb')
+
+work = ExeWork.new
+work.instance_eval do
+	@SOURCES = ["."]
+	@EXTRA_SOURCEFILES = ["../../../../libs/Wormhole/MessageDecoder.cpp"]
+	@EXTRA_INCLUDES = ["stub", "../../common/host/stub", "../../../../libs/Wormhole"]
+	@NAME = "wormholebench"
+end
+
+work.invoke
@@ -0,0 +1,306 @@
+/* Copyright 2013 David Axmark
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+	http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+// Checks that DecodeAheadSource and PcmCacheSource deliver exactly the PCM
+// of the decoder they wrap, then drives an AudioChannel at the audio
+// callback's pace, without an audio device, with a decoder that is now
+// and then slow: once decoding in the callback, the way the SDL runtime
+// did it, and once on the decode thread. Last, plays a short effect
+// repeatedly through the PcmCache, and counts how often it was decoded.
+// Then seeks while playing, and checks that nothing decoded before the
+// seek is played after it.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include <config_platform.h>
+#include <helpers/helpers.h>
+#include <helpers/timer.h>
+#include <MemStream.h>
+#include <AudioChannel.h>
+#include <DecodeAheadSource.h>
+#include <PcmCache.h>
+#include "ThreadPoolImpl.h"
+
+void MoSyncErrorExit(int code) {
+	printf("MoSyncErrorExit(%i)\n", code);
+	exit(code);
+}
+
+#define SAMPLE_RATE 44100
+#define CHUNK_FRAMES 4096
+#define CALLBACK_FRAMES 1024
+// one callback's worth of time, in ms.
+#define CALLBACK_MS (CALLBACK_FRAMES * 1000 / SAMPLE_RATE)
+
+// what one chunk costs to decode; every SPIKE_EVERY:th costs more,
+// like a decoder that reads a new page, or resyncs.
+#define CHUNK_MS 2
+#define SPIKE_MS 60
+#define SPIKE_EVERY 8
+
+static volatile int sDecodedChunks = 0;
+
+static void burn(int ms) {
+	ProfTime start = ProfTime::now();
+	while((ProfTime::now() - start).toMilliSeconds() < ms) {}
+}
+
+// 16-bit stereo, a different ramp in each channel.
+class SlowDecoder : public AudioSource {
+public:
+	SlowDecoder(int frames, bool slow) : mFrames(frames), mPos(0), mChunks(0), mSlow(slow) {}
+
+	int init() {
+		info.numChannels = 2;
+		info.sampleRate = SAMPLE_RATE;
+		info.fmt = FMT_S16;
+		info.bitDepth = 16;
+		info.bytesPerSample = 2;
+		info.bufferSize = CHUNK_FRAMES * 4;
+		info.canSeek = true;
+		return 0;
+	}
+
+	int fillBuffer() {
+		if(mPos >= mFrames)
+			return 0;
+		sDecodedChunks++;
+		if(mSlow)
+			burn((++mChunks % SPIKE_EVERY) == 0 ? SPIKE_MS : CHUNK_MS);
+		int n = MIN(CHUNK_FRAMES, mFrames - mPos);
+		for(int i=0; i<n; i++) {
+			mBuffer[i*2+0] = (short)((mPos + i) * 37);
+			mBuffer[i*2+1] = (short)((mPos + i) * -53);
+		}
+		mPos += n;
+		return n;
+	}
+	const void* getBuffer() const { return mBuffer; }
+
+	void setPosition(int ms) { mPos = (int)((long long)ms * SAMPLE_RATE / 1000); }
+	int getPosition() const { return (int)((long long)mPos * 1000 / SAMPLE_RATE); }
+	int getLength() const { return (int)((long long)mFrames * 1000 / SAMPLE_RATE); }
+	void setNumLoops(int) {}
+	int getNumLoops() { return 1; }
+
+private:
+	int mFrames, mPos, mChunks;
+	bool mSlow;
+	short mBuffer[CHUNK_FRAMES * 2];
+};
+
+static SlowDecoder* newDecoder(int frames, bool slow) {
+	SlowDecoder* d = new SlowDecoder(frames, slow);
+	d->init();
+	return d;
+}
+
+// All of a source's PCM, waiting whenever it isn't ready.
+static std::vector<char> drain(AudioSource* src) {
+	std::vector<char> pcm;
+	int frameSize = src->getFrameSize();
+	while(true) {
+		int n = src->fillBuffer();
+		if(n == 0)
+			break;
+		if(n == AudioSource::UNDERRUN) {
+			MoSyncThread::sleep(1);
+			continue;
+		}
+		const char* p = (const char*)src->getBuffer();
+		pcm.insert(pcm.end(), p, p + n * frameSize);
+	}
+	return pcm;
+}
+
+static bool testIdentical() {
+	int frames = SAMPLE_RATE * 2 + 123;
+	AudioSource* direct = newDecoder(frames, false);
+	std::vector<char> expected = drain(direct);
+	delete direct;
+
+	DecodeAheadSource ahead(newDecoder(frames, false), 1024 * 1024);
+	ahead.init();
+	std::vector<char> decoded = drain(&ahead);
+	PcmBuffer* rec = ahead.getRecording();
+
+	printf("decode ahead: %i bytes, %s; recording %s\n", (int)decoded.size(),
+		decoded == expected ? "identical" : "DIFFERENT",
+		rec->complete && rec->data == expected ? "identical" : "DIFFERENT");
+	if(decoded != expected || !rec->complete || rec->data != expected)
+		return false;
+
+	PcmCacheSource cached(rec);
+	std::vector<char> replayed = drain(&cached);
+	printf("cached: %i bytes, %s\n", (int)replayed.size(),
+		replayed == expected ? "identical" : "DIFFERENT");
+	return replayed == expected;
+}
+
+struct RunResult {
+	int lateCallbacks;
+	int maxMixMs;
+	int underruns;
+};
+
+// Calls mix() once per callback period, like SDL does.
+static RunResult runRealtime(AudioSource* src, int frames) {
+	RunResult r = { 0, 0, 0 };
+	static int mixBuffer[CALLBACK_FRAMES * 2];
+	AudioChannel channel(SAMPLE_RATE, src);
+	channel.setActive(true);
+
+	int callbacks = frames / CALLBACK_FRAMES;
+	ProfTime start = ProfTime::now();
+	for(int i=0; i<callbacks && channel.isActive(); i++) {
+		int wait = (int)(i * CALLBACK_MS - (ProfTime::now() - start).toMilliSeconds());
+		if(wait > 0)
+			MoSyncThread::sleep(wait);
+		ProfTime t = ProfTime::now();
+		memset(mixBuffer, 0, sizeof(mixBuffer));
+		channel.mix(mixBuffer, CALLBACK_FRAMES);
+		int ms = (int)(ProfTime::now() - t).toMilliSeconds();
+		r.maxMixMs = MAX(r.maxMixMs, ms);
+		if(ms >= CALLBACK_MS)
+			r.lateCallbacks++;
+	}
+	return r;
+}
+
+static void testRealtime() {
+	int frames = SAMPLE_RATE * 3;
+
+	sDecodedChunks = 0;
+	AudioSource* direct = newDecoder(frames, true);
+	RunResult old = runRealtime(direct, frames);
+	delete direct;
+
+	sDecodedChunks = 0;
+	DecodeAheadSource* ahead = new DecodeAheadSource(newDecoder(frames, true), 0);
+	ahead->init();
+	RunResult now = runRealtime(ahead, frames);
+	now.underruns = ahead->getUnderruns();
+	delete ahead;
+
+	printf("%i callbacks of %i ms, a %i ms decode every %i chunks\n",
+		frames / CALLBACK_FRAMES, CALLBACK_MS, SPIKE_MS, SPIKE_EVERY);
+	printf("decode in callback: %3i late callbacks, longest mix %3i ms\n",
+		old.lateCallbacks, old.maxMixMs);
+	printf("decode ahead:       %3i late callbacks, longest mix %3i ms, %i underruns\n",
+		now.lateCallbacks, now.maxMixMs, now.underruns);
+}
+
+static bool testCache() {
+	// the "resource": a short effect, and a longer sound.
+	char encoded[2][256];
+	for(int i=0; i<256; i++) {
+		encoded[0][i] = (char)i;
+		encoded[1][i] = (char)(i * 7);
+	}
+	Base::MemStreamC res0(encoded[0], sizeof(encoded[0]));
+	Base::MemStreamC res1(encoded[1], sizeof(encoded[1]));
+	Base::Stream* res[2] = { &res0, &res1 };
+	int frames[2] = { SAMPLE_RATE / 4, SAMPLE_RATE * 4 };
+
+	const int maxEntry = 256 * 1024;
+	PcmCache cache(4 * 1024 * 1024, maxEntry);
+	std::vector<char> expected[2];
+	for(int s=0; s<2; s++) {
+		AudioSource* d = newDecoder(frames[s], false);
+		expected[s] = drain(d);
+		delete d;
+	}
+
+	sDecodedChunks = 0;
+	int hits = 0;
+	const int plays = 10;
+	for(int i=0; i<plays * 2; i++) {
+		int s = i & 1;
+		PcmKey key;
+		if(!key.init(s + 1, *res[s], 0, sizeof(encoded[s])))
+			return false;
+		AudioSource* src;
+		PcmBuffer* pcm = cache.find(key);
+		if(pcm) {
+			src = new PcmCacheSource(pcm);
+			pcm->release();
+			hits++;
+		} else {
+			DecodeAheadSource* ahead = new DecodeAheadSource(newDecoder(frames[s], false), maxEntry);
+			cache.addPending(key, ahead->getRecording());
+			ahead->init();
+			src = ahead;
+		}
+		if(drain(src) != expected[s]) {
+			printf("play %i: DIFFERENT\n", i);
+			return false;
+		}
+		delete src;
+	}
+
+	int chunks[2] = { (frames[0] + CHUNK_FRAMES - 1) / CHUNK_FRAMES,
+		(frames[1] + CHUNK_FRAMES - 1) / CHUNK_FRAMES };
+	printf("%i plays each of a %i ms effect and a %i ms sound: %i cache hits,"
+		" %i chunks decoded (%i without the cache); %i bytes cached\n",
+		plays, frames[0] * 1000 / SAMPLE_RATE, frames[1] * 1000 / SAMPLE_RATE,
+		hits, (int)sDecodedChunks, plays * (chunks[0] + chunks[1]), cache.getBytes());
+	// only the effect fits in an entry.
+	return hits == plays - 1;
+}
+
+static bool testSeek() {
+	int frames = SAMPLE_RATE * 4;
+	DecodeAheadSource ahead(newDecoder(frames, false), 0);
+	ahead.init();
+	// let the decoder fill the ring.
+	MoSyncThread::sleep(50);
+
+	int played = 0;
+	for(int i=0; i<4; i++) {
+		int n;
+		while((n = ahead.fillBuffer()) == AudioSource::UNDERRUN)
+			MoSyncThread::sleep(1);
+		played += n;
+	}
+	int expectedPos = (int)((long long)played * 1000 / SAMPLE_RATE);
+	int pos = ahead.getPosition();
+
+	const int seekMs = 2000;
+	ahead.setPosition(seekMs);
+	int n;
+	while((n = ahead.fillBuffer()) == AudioSource::UNDERRUN)
+		MoSyncThread::sleep(1);
+	const short* pcm = (const short*)ahead.getBuffer();
+	int frame = seekMs * SAMPLE_RATE / 1000;
+	bool seeked = n > 0 && pcm[0] == (short)(frame * 37) && pcm[1] == (short)(frame * -53);
+
+	printf("position %i ms after %i played frames (expected %i); after a seek to %i ms: %s\n",
+		pos, played, expectedPos, seekMs, seeked ? "ok" : "STALE");
+	return seeked && pos >= expectedPos - 1 && pos <= expectedPos + 1;
+}
+
+int main() {
+	// the "audio callback" here is the main thread.
+	AudioDecoder::start(NULL, NULL);
+	bool ok = testIdentical();
+	testRealtime();
+	ok = testCache() && ok;
+	ok = testSeek() && ok;
+	AudioDecoder::stop();
+	printf(ok ? "OK\n" : "FAILED\n");
+	return ok ? 0 : 1;
+}
@@ -0,0 +1,39 @@
+#!/usr/bin/ruby
+
+require File.expand_path('../../../rules/native_mosync.rb')
+
+work = MoSyncExe.new
+work.instance_eval do
+	@SOURCES = ['.']
+	@EXTRA_SOURCEFILES = [
+		'../../../runtimes/cpp/base/AudioChannel.cpp',
+		'../../../runtimes/cpp/base/AudioSource.cpp',
+		'../../../runtimes/cpp/base/DecodeAheadSource.cpp',
+		'../../../runtimes/cpp/base/PcmCache.cpp',
+		'../../../runtimes/cpp/base/PcmRing.cpp',
+		'../../../runtimes/cpp/base/Stream.cpp',
+		'../../../runtimes/cpp/base/MemStream.cpp',
+		'../../../runtimes/cpp/platforms/sdl/ThreadPoolImpl.cpp',
+		'../../../runtimes/cpp/platforms/sdl/mutexImpl.cpp',
+	]
+	@EXTRA_INCLUDES = ['../../../intlibs', '../../../runtimes/cpp/base', '../../../runtimes/cpp/platforms/sdl']
+	@LOCAL_LIBS = ['mosync_log_file']
+
+	if(HOST == :win32) then
+		@CUSTOM_LIBS = ['SDL.lib', 'SDLmain.lib']
+	else
+		@LIBRARIES = ['SDL', 'SDLmain']
+	end
+
+	@NAME = 'audioDecode'
+end
+
+target :default do
+	work.invoke
+end
+
+target :run => :default do
+	sh work.target
+end
+
+Targets.invoke
@@ -0,0 +1,168 @@
+/* Copyright 2013 David Axmark
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+	http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+// Checks that TileRenderer produces exactly the same pixels as drawing
+// directly on an Image, then measures how it scales with thread count.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <config_platform.h>
+#include <helpers/helpers.h>
+#include <helpers/timer.h>
+#include <Image.h>
+#include <TileRenderer.h>
+
+void MoSyncErrorExit(int code) {
+	printf("MoSyncErrorExit(%i)\n", code);
+	exit(code);
+}
+
+// own generator, so that both passes see the same sequence everywhere.
+static unsigned int sSeed;
+static int rnd(int n) {
+	sSeed = sSeed * 1103515245 + 12345;
+	return (int)((sSeed >> 8) % (unsigned int)n);
+}
+
+// Issues the same pseudo-random frame to either an Image or a TileRenderer.
+template<class Drawer>
+static void drawFrame(Drawer& d, Image& target, Image& sprite, unsigned int seed, int count) {
+	sSeed = seed;
+	int w = target.width, h = target.height;
+	for(int i = 0; i < count; i++) {
+		int color = rnd(0x1000000) | 0xff000000;
+		switch(rnd(7)) {
+		case 0: {
+			target.clipRect.x = rnd(w);
+			target.clipRect.y = rnd(h);
+			target.clipRect.width = rnd(w - target.clipRect.x) + 1;
+			target.clipRect.height = rnd(h - target.clipRect.y) + 1;
+			break;
+		}
+		case 1:
+			d.drawPoint(rnd(w), rnd(h), color);
+			break;
+		case 2:
+			d.drawLine(rnd(w * 2) - w / 2, rnd(h * 2) - h / 2,
+				rnd(w * 2) - w / 2, rnd(h * 2) - h / 2, color);
+			break;
+		case 3:
+			d.drawFilledRect(rnd(w) - 20, rnd(h) - 20, rnd(w / 2) + 1, rnd(h / 2) + 1, color);
+			break;
+		case 4:
+			d.drawTriangle(rnd(w * 2) - w / 2, rnd(h * 2) - h / 2,
+				rnd(w * 2) - w / 2, rnd(h * 2) - h / 2,
+				rnd(w * 2) - w / 2, rnd(h * 2) - h / 2, color);
+			break;
+		case 5: {
+			ClipRect src;
+			src.x = rnd(sprite.width / 2);
+			src.y = rnd(sprite.height / 2);
+			src.width = rnd(sprite.width - src.x) + 1;
+			src.height = rnd(sprite.height - src.y) + 1;
+			d.drawImageRegion(rnd(w + 64) - 32, rnd(h + 64) - 32, &src, &sprite, rnd(8));
+			break;
+		}
+		case 6:
+			d.drawImage(rnd(w + 64) - 32, rnd(h + 64) - 32, &sprite);
+			break;
+		}
+	}
+	target.clipRect.x = 0;
+	target.clipRect.y = 0;
+	target.clipRect.width = w;
+	target.clipRect.height = h;
+}
+
+static void fillSprite(Image& sprite) {
+	for(int y = 0; y < sprite.height; y++) {
+		for(int x = 0; x < sprite.width; x++) {
+			int c = ((x * 255) / sprite.width << 16) | ((y * 255) / sprite.height << 8) | ((x ^ y) & 0xff);
+			if(sprite.bytesPerPixel == 2)
+				((unsigned short*)(sprite.data + y * sprite.pitch))[x] = c;
+			else
+				((unsigned int*)(sprite.data + y * sprite.pitch))[x] = c;
+		}
+	}
+}
+
+static bool testDeterminism(Image::PixelFormat format, int bpp, int numThreads, int tileSize) {
+	const int W = 333, H = 251;
+	Image direct(W, H, W * bpp, format);
+	Image deferred(W, H, W * bpp, format);
+	Image sprite(48, 40, 48 * bpp, format);
+	memset(direct.data, 0, direct.pitch * H);
+	memset(deferred.data, 0, deferred.pitch * H);
+	fillSprite(sprite);
+
+	TileRenderer tr(&deferred, numThreads, tileSize, tileSize);
+	for(unsigned int frame = 1; frame <= 20; frame++) {
+		drawFrame(direct, direct, sprite, frame, 500);
+		drawFrame(tr, deferred, sprite, frame, 500);
+		tr.flush();
+		if(memcmp(direct.data, deferred.data, direct.pitch * H) != 0) {
+			printf("FAIL: bpp %i, %i threads, %ix%i tiles, frame %u differs\n",
+				bpp, numThreads, tileSize, tileSize, frame);
+			return false;
+		}
+	}
+	return true;
+}
+
+static void benchmark(int w, int h, int numThreads) {
+	Image target(w, h, w * 4, Image::PIXELFORMAT_ARGB8888);
+	Image sprite(64, 64, 64 * 4, Image::PIXELFORMAT_ARGB8888);
+	fillSprite(sprite);
+	const int frames = 20, commands = 20000;
+
+	ProfTime start = ProfTime::now();
+	if(numThreads == 0) {
+		for(int f = 0; f < frames; f++)
+			drawFrame(target, target, sprite, f + 1, commands);
+	} else {
+		TileRenderer tr(&target, numThreads);
+		for(int f = 0; f < frames; f++) {
+			drawFrame(tr, target, sprite, f + 1, commands);
+			tr.flush();
+		}
+	}
+	double ms = (ProfTime::now() - start).toMilliSeconds();
+	if(numThreads == 0)
+		printf("%ix%i immediate:  %.1f ms/frame\n", w, h, ms / frames);
+	else
+		printf("%ix%i %2i threads: %.1f ms/frame\n", w, h, numThreads, ms / frames);
+}
+
+int main() {
+	initMulTable();
+	initRecipLut();
+
+	bool ok = true;
+	static const int threads[] = { 1, 2, 3, 8 };
+	static const int tiles[] = { 16, 64, 100 };
+	for(size_t t = 0; t < sizeof(threads) / sizeof(int); t++) {
+		for(size_t s = 0; s < sizeof(tiles) / sizeof(int); s++) {
+			ok &= testDeterminism(Image::PIXELFORMAT_RGB565, 2, threads[t], tiles[s]);
+			ok &= testDeterminism(Image::PIXELFORMAT_ARGB8888, 4, threads[t], tiles[s]);
+		}
+	}
+	printf("determinism: %s\n", ok ? "OK" : "FAILED");
+
+	benchmark(1920, 1080, 0);
+	for(int n = 1; n <= 16; n *= 2)
+		benchmark(1920, 1080, n);
+	return ok ? 0 : 1;
+}
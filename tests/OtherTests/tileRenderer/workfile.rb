@@ -0,0 +1,33 @@
+#!/usr/bin/ruby
+
+require File.expand_path('../../../rules/native_mosync.rb')
+
+work = MoSyncExe.new
+work.instance_eval do
+	@SOURCES = ['.']
+	@EXTRA_SOURCEFILES = [
+		'../../../runtimes/cpp/base/Image.cpp',
+		'../../../runtimes/cpp/base/TileRenderer.cpp',
+		'../../../runtimes/cpp/platforms/sdl/ThreadPoolImpl.cpp',
+	]
+	@EXTRA_INCLUDES = ['../../../intlibs', '../../../runtimes/cpp/base', '../../../runtimes/cpp/platforms/sdl']
+	@LOCAL_LIBS = ['mosync_log_file']
+
+	if(HOST == :win32) then
+		@CUSTOM_LIBS = ['SDL.lib', 'SDLmain.lib']
+	else
+		@LIBRARIES = ['SDL', 'SDLmain']
+	end
+
+	@NAME = 'tileRenderer'
+end
+
+target :default do
+	work.invoke
+end
+
+target :run => :default do
+	sh work.target
+end
+
+Targets.invoke
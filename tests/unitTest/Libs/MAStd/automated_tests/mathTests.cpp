@@ -20,6 +20,11 @@ limitations under the License.
 #include <conprint.h>
 #include <madmath.h>
 
+// The portable fdlibm code, which the native implementations must agree with.
+extern "C" double __ieee754_pow(double, double);
+extern "C" double __ieee754_log(double);
+extern "C" double __ieee754_atan2(double, double);
+
 class MathTestCase : public TestCase {
 
 public:
@@ -102,6 +107,91 @@ public:
 		assert("testing sqrt()", numFailed==0);
 	}
 
+	// Compares the math functions, which use the runtime's native
+	// implementations where available, against fdlibm.
+	void nativeTest() {
+		printf("native math: %s\n", mathIsNative() ? "yes" : "no");
+		int numFailed = 0;
+		for(int i = 1; i <= 32; i++) {
+			double x = i * 0.37;
+			double y = i * 0.11 - 1.5;
+			double correct = __ieee754_pow(x, y);
+			double test = pow(x, y);
+			if(!((test>=correct-EPS)&&(test<=correct+EPS)))
+				numFailed++;
+			correct = __ieee754_log(x);
+			test = log(x);
+			if(!((test>=correct-EPS)&&(test<=correct+EPS)))
+				numFailed++;
+			correct = __ieee754_atan2(y, x - 6.0);
+			test = atan2(y, x - 6.0);
+			if(!((test>=correct-EPS)&&(test<=correct+EPS)))
+				numFailed++;
+		}
+		assert("testing pow(), log(), atan2()", numFailed==0);
+
+		// float results are compared at float precision.
+#undef EPS
+#define EPS MAX(fabs(correct / 10000), 0.0001)
+		numFailed = 0;
+		for(int i = 1; i <= 32; i++) {
+			float x = i * 0.37f;
+			double correct = sin((double)x);
+			if(fabs(sinf(x) - correct) > EPS) numFailed++;
+			correct = cos((double)x);
+			if(fabs(cosf(x) - correct) > EPS) numFailed++;
+			correct = sqrt((double)x);
+			if(fabs(sqrtf(x) - correct) > EPS) numFailed++;
+			correct = __ieee754_pow(x, 1.5);
+			if(fabs(powf(x, 1.5f) - correct) > EPS) numFailed++;
+			correct = __ieee754_log(x);
+			if(fabs(logf(x) - correct) > EPS) numFailed++;
+			correct = __ieee754_atan2(x, -3.0);
+			if(fabs(atan2f(x, -3.0f) - correct) > EPS) numFailed++;
+		}
+		assert("testing float math", numFailed==0);
+
+		double src[32], dst[32];
+		float srcf[32], dstf[32];
+		for(int i = 0; i < 32; i++) {
+			src[i] = (i + 1) * 0.37;
+			srcf[i] = (float)src[i];
+		}
+		numFailed = 0;
+		for(int func = MA_MATH_FUNC_SIN; func <= MA_MATH_FUNC_LOG; func++) {
+			assert("mathEvaluate() count", mathEvaluate(func, src, dst, 32) == 32);
+			assert("mathEvaluatef() count", mathEvaluatef(func, srcf, dstf, 32) == 32);
+			for(int i = 0; i < 32; i++) {
+				double correct;
+				switch(func) {
+				case MA_MATH_FUNC_SIN: correct = sin(src[i]); break;
+				case MA_MATH_FUNC_COS: correct = cos(src[i]); break;
+				case MA_MATH_FUNC_SQRT: correct = sqrt(src[i]); break;
+				default: correct = __ieee754_log(src[i]); break;
+				}
+				if(fabs(dst[i] - correct) > EPS) numFailed++;
+				if(fabs(dstf[i] - correct) > EPS) numFailed++;
+			}
+		}
+		assert("testing mathEvaluate()", numFailed==0);
+		assert("mathEvaluate() bad func", mathEvaluate(0, src, dst, 32) < 0);
+
+		// rotate 90 degrees around z, then translate by (1, 2, 3).
+		const float matrix[12] = {
+			0, -1, 0, 1,
+			1, 0, 0, 2,
+			0, 0, 1, 3 };
+		float points[6] = { 1, 0, 0, 0, 2, 5 };
+		const float expected[6] = { 1, 3, 3, -1, 2, 8 };
+		assert("mathTransformPointsf() count", mathTransformPointsf(matrix, points, points, 2) == 2);
+		numFailed = 0;
+		for(int i = 0; i < 6; i++) {
+			double correct = expected[i];
+			if(fabs(points[i] - correct) > EPS) numFailed++;
+		}
+		assert("testing mathTransformPointsf()", numFailed==0);
+	}
+
 	void doubleTest() {
 		double a, b;
 
@@ -159,6 +249,7 @@ public:
 		doubleTest();
 		trigTest();
 		sqrtTest();
+		nativeTest();
 		suite->runNextCase();
 	}
 
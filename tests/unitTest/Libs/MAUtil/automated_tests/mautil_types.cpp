@@ -19,6 +19,10 @@ limitations under the License.
 #include <MAUtil/Map.h>
 #include <MAUtil/HashMap.h>
 #include <MAUtil/HashSet.h>
+#include <MAUtil/BTreeSet.h>
+#include <MAUtil/BTreeMap.h>
+#include <MAUtil/HandleTable.h>
+#include <MAUtil/ListenerSet.h>
 #include <conprint.h>
 
 #include "common.h"
@@ -55,6 +59,18 @@ public:
 		hashMapInt();
 		printf("-mapInt\n");
 		mapInt();
+		printf("-btreeSet\n");
+		btreeSet();
+		printf("-btreeSetInt\n");
+		btreeSetInt();
+		printf("-btreeMap\n");
+		btreeMap();
+		printf("-btreeMapVsMap\n");
+		btreeMapVsMap();
+		printf("-handleTable\n");
+		handleTable();
+		printf("-listenerSet\n");
+		listenerSet();
 		/*
 		list();
 		*/
@@ -260,6 +276,19 @@ public:
 		assert("Iterator++", itr != s.end());
 	}
 
+	template<class Key, class Storage, class Slot, class KeyOf, class L, class ITR>
+	void basicIteratorTest(ITR& itr, BTreeDictionary<Key, Storage, Slot, KeyOf, L>& s)
+	{
+		--itr;
+		assert("Iterator--", itr != s.end());
+		itr--;
+		itr++;
+		itr++;
+		assert("Iterator++", itr == s.end());
+		itr--;
+		assert("Iterator--", itr != s.end());
+	}
+
 	void set() {
 		testSetString<Set<String> >(
 			&MAUtilTypesTest::setStringIterate<Set<String>, Set<String>::Iterator>,
@@ -347,6 +376,18 @@ public:
 			&MAUtilTypesTest::setIntIterate<Set<int>, Set<int>::ConstIterator>);
 	}
 
+	void btreeSet() {
+		testSetString<BTreeSet<String> >(
+			&MAUtilTypesTest::setStringIterate<BTreeSet<String>, BTreeSet<String>::Iterator>,
+			&MAUtilTypesTest::setStringIterate<BTreeSet<String>, BTreeSet<String>::ConstIterator>);
+	}
+
+	void btreeSetInt() {
+		testSetInt<BTreeSet<int> >(
+			&MAUtilTypesTest::setIntIterate<BTreeSet<int>, BTreeSet<int>::Iterator>,
+			&MAUtilTypesTest::setIntIterate<BTreeSet<int>, BTreeSet<int>::ConstIterator>);
+	}
+
 	void hashSetInt() {
 		testSetInt<HashSet<int> >(
 			&MAUtilTypesTest::setIntIterate<HashSet<int>, HashSet<int>::Iterator>,
@@ -575,6 +616,176 @@ public:
 		itr = m.find(3);
 		assert("Map::clear()", m.size()==0 && itr == m.end());
 	}
+
+	void btreeMap() {
+		BTreeMap<String, String> m;
+
+		//operator[] and insert
+		m["Abraham"] = "Lincoln";
+		m["Benjamin"] = "Franklin";
+		m.insert(BTreeMap<String, String>::MutableStorage("George", "Washington"));
+		assert("BTreeMap::size()", m.size() == 3);
+
+		//iterate
+		{
+			BTreeMap<String, String>::ConstIterator itr = m.begin();
+			assert("BTreeMap::begin()", itr->first == "Abraham" && itr->second == "Lincoln");
+			++itr;
+			assert("BTreeMap::ConstIterator()", itr->first == "Benjamin" && itr->second == "Franklin");
+			itr++;
+			assert("BTreeMap::ConstIterator()", itr->first == "George" && itr->second == "Washington");
+			itr++;
+			assert("BTreeMap::end()", itr == m.end());
+		}
+
+		//lowerBound and upperBound
+		BTreeMap<String, String>::Iterator itr = m.lowerBound("B");
+		assert("BTreeMap::lowerBound()", itr != m.end() && itr->first == "Benjamin");
+		itr = m.lowerBound("Benjamin");
+		assert("BTreeMap::lowerBound()", itr != m.end() && itr->first == "Benjamin");
+		itr = m.upperBound("Benjamin");
+		assert("BTreeMap::upperBound()", itr != m.end() && itr->first == "George");
+		itr = m.upperBound("George");
+		assert("BTreeMap::upperBound()", itr == m.end());
+
+		//find
+		itr = m.find("Benjamin");
+		assert("BTreeMap::find()", itr != m.end() && itr->second == "Franklin");
+		itr = m.find("Edgar");
+		assert("BTreeMap::find()", itr == m.end());
+
+		//erase
+		bool e = m.erase("Benjamin");
+		assert("BTreeMap::erase()", e);
+		itr = m.find("Benjamin");
+		assert("BTreeMap::erase()", itr == m.end());
+		itr = m.erase(m.find("Abraham"));
+		assert("BTreeMap::erase()", itr != m.end() && itr->first == "George");
+		itr = m.find("Abraham");
+		assert("BTreeMap::erase()", itr == m.end());
+
+		//clear
+		m.clear();
+		itr = m.find("George");
+		assert("BTreeMap::clear()", m.size()==0 && itr == m.end());
+	}
+
+	static bool sameMap(const Map<int, int>& m, const BTreeMap<int, int>& b) {
+		if(m.size() != b.size())
+			return false;
+		Map<int, int>::ConstIterator mi = m.begin();
+		BTreeMap<int, int>::ConstIterator bi = b.begin();
+		for(; mi != m.end(); ++mi, ++bi) {
+			if(bi == b.end() || mi->first != bi->first || mi->second != bi->second)
+				return false;
+		}
+		return bi == b.end();
+	}
+
+	// Enough elements for the nodes to split, borrow and merge.
+	void btreeMapVsMap() {
+		Map<int, int> m;
+		BTreeMap<int, int> b;
+		unsigned int seed = 1;
+		bool insertOk = true, eraseOk = true;
+		for(int i = 0; i < 6000; i++) {
+			seed = seed * 1103515245 + 12345;
+			int key = (seed >> 8) % 2000;
+			if(i >= 4000 || (seed >> 4) % 3 == 0)
+				eraseOk = (m.erase(key) == b.erase(key)) && eraseOk;
+			else
+				insertOk = (m.insert(key, i).second == b.insert(key, i).second) && insertOk;
+		}
+		assert("BTreeMap::insert() vs Map", insertOk);
+		assert("BTreeMap::erase() vs Map", eraseOk);
+		assert("BTreeMap vs Map", sameMap(m, b));
+
+		BTreeMap<int, int> copy(b);
+		assert("BTreeMap::BTreeMap(BTreeMap) vs Map", sameMap(m, copy));
+
+		bool boundsOk = true;
+		for(int key = -1; key <= 2000; key += 7) {
+			Map<int, int>::ConstIterator mi = m.begin();
+			while(mi != m.end() && mi->first < key)
+				++mi;
+			BTreeMap<int, int>::ConstIterator bi = b.lowerBound(key);
+			boundsOk = boundsOk && (mi == m.end()) == (bi == b.end());
+			if(mi != m.end() && bi != b.end())
+				boundsOk = boundsOk && mi->first == bi->first;
+		}
+		assert("BTreeMap::lowerBound() vs Map", boundsOk);
+	}
+
+	void handleTable() {
+		static int values[3];
+		HandleTable<int> t;
+		assert("HandleTable::get() empty", t.get(1) == NULL && t.size() == 0);
+		t.set(1, &values[0]);
+		t.set(2, &values[1]);
+		t.set(1, &values[2]);
+		assert("HandleTable::set()", t.size() == 2 && t.get(1) == &values[2] && t.get(2) == &values[1]);
+		t.remove(1);
+		t.remove(3);
+		assert("HandleTable::remove()", t.size() == 1 && t.get(1) == NULL && t.get(2) == &values[1]);
+
+		// enough handles to grow the table, removed in a different order.
+		bool ok = true;
+		for(int i = 0; i < 1000; i++)
+			t.set(i * 7, &values[i % 3]);
+		for(int i = 0; i < 1000; i += 2)
+			t.remove(i * 7);
+		for(int i = 0; i < 1000; i++)
+			ok = ok && t.get(i * 7) == ((i % 2) ? &values[i % 3] : NULL);
+		// handle 2 is still set.
+		assert("HandleTable many", ok && t.size() == 501);
+	}
+
+	struct CountingListener {
+		ListenerSet<CountingListener>* set;
+		int calls;
+		bool removeSelf;
+		void fired() {
+			calls++;
+			if(removeSelf)
+				set->remove(this);
+		}
+	};
+
+	void listenerSet() {
+		ListenerSet<CountingListener> set(false);
+		CountingListener ls[40];
+		for(int i = 0; i < 40; i++) {
+			ls[i].set = &set;
+			ls[i].calls = 0;
+			ls[i].removeSelf = (i % 3 == 0);
+			set.add(&ls[i]);
+		}
+		set.add(&ls[5]);
+		assert("ListenerSet::add()", set.size() == 40 && set.contains(&ls[39]));
+
+		ListenerSet_fire(CountingListener, set, fired());
+		ListenerSet_fire(CountingListener, set, fired());
+		bool ok = true;
+		for(int i = 0; i < 40; i++)
+			ok = ok && ls[i].calls == (ls[i].removeSelf ? 1 : 2);
+		assert("ListenerSet remove while running", ok && set.size() == 26 && !set.contains(&ls[0]));
+
+		// the order is kept, and a listener that is added again goes last.
+		set.remove(&ls[1]);
+		set.add(&ls[1]);
+		int prev = -1;
+		ok = true;
+		ListenerSet_each(CountingListener, i, set) {
+			int index = &*i - ls;
+			ok = ok && (index > prev || index == 1);
+			prev = index;
+		}
+		assert("ListenerSet order", ok && prev == 1);
+
+		for(int i = 39; i >= 0; i--)
+			set.remove(&ls[i]);
+		assert("ListenerSet::remove()", set.size() == 0 && !set.contains(&ls[1]));
+	}
 };
 
 void addMAUtilTypeTests(MATest::TestSuite* suite);
@@ -21,6 +21,7 @@ limitations under the License.
 
 #include "File.h"
 #include <vector>
+#include <algorithm>
 #include <cstring>
 #include <stdlib.h>
 
@@ -33,7 +34,15 @@ limitations under the License.
 //#define MAGIC 0x12345678
 
 // Version 2 magic number.
-#define MAGIC 0x22345678
+#define MAGIC2 0x22345678
+
+// Version 3 magic number.
+#define MAGIC3 0x32345678
+
+// Bundle version to write, 2 or 3.
+// Applications linked with MAFS libraries older than version 3
+// can't read version 3 images, so it must be asked for.
+int gVersion = 2;
 
 // List of input files.
 std::vector<std::string> gInFiles;
@@ -88,6 +97,21 @@ struct VolumeEntryDirectory {
 	char *name;
 	int numVolumeEntries;
 };
+
+// Version 3 replaces the tree of volume entries with a path index,
+// that MAFS loads with a single read and searches with a binary search.
+struct PathIndex {
+	int numEntries;
+	IndexEntry entries[numEntries]; // sorted, see comparePaths()
+	char strings[]; // full paths, '/' separated, without the root
+}
+
+struct IndexEntry {
+	int path; // offset into strings
+	int type; // 0 = directory, 1 = file
+	int dataOffset;
+	int dataLength;
+};
 */
 
 static char to_upper(char c) {
@@ -166,7 +190,7 @@ static void saveFileData() {
 
 static void writeHeader() {
 	// Magic number.
-	int magic = MAGIC;
+	int magic = gVersion == 2 ? MAGIC2 : MAGIC3;
 
 	// Compute checksum.
 	unsigned long checksum = adler32(gFileData, gFileDataPtr);
@@ -205,6 +229,73 @@ static void saveVolumeEntries(VolumeEntry *root) {
 	}
 }
 
+struct IndexEntry {
+	std::string path;
+	VolumeEntry *vol;
+};
+
+static int foldChar(int c, bool caseFold) {
+	if(c == '\\')
+		return '/';
+	// bytes from 0x80 up must stay positive, like MAFS' toupper((unsigned char)c).
+	return caseFold ? (unsigned char)to_upper((char)c) : c;
+}
+
+// Must match comparePaths() in libs/MAFS/File.c.
+static int comparePaths(const char *a, const char *b, bool caseFold) {
+	int ca, cb;
+	do {
+		ca = foldChar((unsigned char)*a++, caseFold);
+		cb = foldChar((unsigned char)*b++, caseFold);
+	} while(ca && ca == cb);
+	return ca - cb;
+}
+
+static bool indexEntryLess(const IndexEntry &a, const IndexEntry &b) {
+	int res = comparePaths(a.path.c_str(), b.path.c_str(), true);
+	if(res == 0)
+		res = comparePaths(a.path.c_str(), b.path.c_str(), false);
+	return res < 0;
+}
+
+static void collectIndexEntries(VolumeEntry *dir, const std::string &prefix,
+	std::vector<IndexEntry> &entries)
+{
+	for(size_t i = 0; i < dir->children.size(); i++) {
+		IndexEntry e;
+		e.vol = dir->children[i];
+		e.path = prefix + e.vol->name;
+		entries.push_back(e);
+		if(e.vol->type == 0)
+			collectIndexEntries(e.vol, e.path + "/", entries);
+	}
+}
+
+static void writeInt(int i) {
+	fwrite(&i, 4, 1, gOutFile);
+}
+
+static void savePathIndex(VolumeEntry *root) {
+	std::vector<IndexEntry> entries;
+	collectIndexEntries(root, "", entries);
+	// Stable, so that duplicate paths are found in the order they were added.
+	std::stable_sort(entries.begin(), entries.end(), indexEntryLess);
+
+	writeInt(entries.size());
+	int path = 0;
+	for(size_t i = 0; i < entries.size(); i++) {
+		VolumeEntry *vol = entries[i].vol;
+		writeInt(path);
+		writeInt(vol->type);
+		writeInt(vol->type == 1 ? vol->dataOffset : 0);
+		writeInt(vol->type == 1 ? vol->dataLength : 0);
+		path += entries[i].path.size() + 1;
+	}
+	for(size_t i = 0; i < entries.size(); i++) {
+		fwrite(entries[i].path.c_str(), 1, entries[i].path.size() + 1, gOutFile);
+	}
+}
+
 void parse(File file, VolumeEntry *vol);
 
 static void parseDirectory(File file, VolumeEntry *vol)
@@ -280,7 +371,11 @@ int main(int argc, char **argv)
 				"                             image (multiple -in directives may be added).\n"
 				"  -out <output file>         the name of the image to be created (only one).\n"
 				"  -toUpper/-toLower          change case of all file names to upper or lower\n"
-				"                             case.\n\n"
+				"                             case.\n"
+				"  -v3                        write a version 3 image, with a path index.\n"
+				"                             Applications built with MAFS libraries older\n"
+				"                             than the index can't read it.\n"
+				"  -v2                        write a version 2 image (the default).\n\n"
 				"Example:\n"
 				"  bundle -in data -out anotherworld.bun -toLower\n"
 				);
@@ -314,6 +409,12 @@ int main(int argc, char **argv)
 		}
 		else if(strcmp(argv[i], "-toLower")==0) {
 			changeCase = 2;
+		}
+		else if(strcmp(argv[i], "-v2")==0) {
+			gVersion = 2;
+		}
+		else if(strcmp(argv[i], "-v3")==0) {
+			gVersion = 3;
 		} else {
 			printf("invalid argument");
 			return 1;
@@ -348,7 +449,10 @@ int main(int argc, char **argv)
 
 	// Write volume entires and actual file data.
 	fseek(gOutFile, START_OF_VOLUME_ENTRIES, SEEK_SET);
-	saveVolumeEntries(root);
+	if(gVersion == 2)
+		saveVolumeEntries(root);
+	else
+		savePathIndex(root);
 	saveFileData();
 
 	// Write header.
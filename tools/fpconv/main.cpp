@@ -0,0 +1,245 @@
+/* Copyright 2013 David Axmark
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+	http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+// Converts MoRE's binary function profile, fp.bin, to the fp.xml that
+// ProfileViewer reads, and to folded stacks, one line per call path
+// with its self time in microseconds, for flame graph tools.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include <map>
+
+#include <helpers/FunctionProfile.h>
+
+using namespace std;
+
+struct Node {
+	FunctionProfileNode n;
+	int firstChild, lastChild, next;
+};
+
+static vector<Node> sNodes;
+static map<int, string> sNames;
+static double sTicksPerMs;
+
+static void usage() {
+	printf("Usage: fpconv [-xml <file>] [-folded <file>] [-min <ms>] <fp.bin>\n"
+		"\n"
+		" -xml <file>     Writes the profile as XML, for ProfileViewer.\n"
+		" -folded <file>  Writes the profile as folded stacks.\n"
+		" -min <ms>       Leaves out the calls that took less than <ms> milliseconds\n"
+		"                 in total, with their callees.\n");
+	exit(1);
+}
+
+static void error(const char* msg, const char* file) {
+	printf("%s: %s\n", file, msg);
+	exit(1);
+}
+
+static void read(FILE* file, void* dst, size_t size, const char* name) {
+	if(fread(dst, size, 1, file) != 1)
+		error("unexpected end of file", name);
+}
+
+static void load(const char* name) {
+	FILE* file = fopen(name, "rb");
+	if(!file)
+		error("couldn't open file", name);
+	FunctionProfileHeader h;
+	read(file, &h, sizeof(h), name);
+	if(memcmp(h.magic, FUNCTION_PROFILE_MAGIC, sizeof(h.magic)) != 0)
+		error("not a function profile", name);
+	if(h.version != FUNCTION_PROFILE_VERSION)
+		error("unsupported version", name);
+	if(h.nodeCount <= 0 || h.nameCount < 0 || h.ticksPerSecond <= 0)
+		error("bad header", name);
+	sTicksPerMs = double(h.ticksPerSecond) / 1000;
+
+	sNodes.resize(h.nodeCount);
+	for(int i=0; i<h.nodeCount; i++) {
+		Node& node(sNodes[i]);
+		read(file, &node.n, sizeof(node.n), name);
+		node.firstChild = node.lastChild = node.next = -1;
+		int p = node.n.parent;
+		if(i == 0 ? p != -1 : (p < 0 || p >= i))
+			error("bad node parent", name);
+		if(i > 0) {
+			Node& parent(sNodes[p]);
+			if(parent.lastChild < 0)
+				parent.firstChild = i;
+			else
+				sNodes[parent.lastChild].next = i;
+			parent.lastChild = i;
+		}
+	}
+
+	for(int i=0; i<h.nameCount; i++) {
+		s32 ipLen[2];
+		read(file, ipLen, sizeof(ipLen), name);
+		if(ipLen[1] < 0)
+			error("bad name", name);
+		string s(ipLen[1], 0);
+		if(ipLen[1] > 0)
+			read(file, &s[0], ipLen[1], name);
+		sNames[ipLen[0]] = s;
+	}
+	fclose(file);
+}
+
+static const string* findName(int ip) {
+	map<int, string>::const_iterator itr = sNames.find(ip);
+	return itr == sNames.end() ? NULL : &itr->second;
+}
+
+static bool shown(int i, double minMs) {
+	return i == 0 || sNodes[i].n.totalTicks / sTicksPerMs >= minMs;
+}
+
+static void writeXmlNode(FILE* file, int i, int level, double minMs) {
+	const FunctionProfileNode& n(sNodes[i].n);
+	if(level > 0)
+		fprintf(file, "%*c", level, ' ');
+	fprintf(file, "<f ");
+	const string* name = findName(n.ip);
+	if(name) {
+		fprintf(file, "n=\"");
+		for(size_t j=0; j<name->size(); j++) {
+			char c = (*name)[j];
+			switch(c) {
+			case '&': fputs("&amp;", file); break;
+			case '<': fputs("&lt;", file); break;
+			case '>': fputs("&gt;", file); break;
+			case '"': fputs("&quot;", file); break;
+			default: fputc(c, file);
+			}
+		}
+		fprintf(file, "\"");
+	} else {
+		fprintf(file, "a=\"0x%x\"", n.ip);
+	}
+	int nChildren = 0;
+	for(int c = sNodes[i].firstChild; c >= 0; c = sNodes[c].next) {
+		if(shown(c, minMs))
+			nChildren++;
+	}
+	fprintf(file, " c=\"%u\" t=\"%f\" lt=\"%f\" ch=\"%i\" cht=\"%f\">\n", n.count,
+		n.totalTicks / sTicksPerMs, n.selfTicks / sTicksPerMs,
+		nChildren, (n.totalTicks - n.selfTicks) / sTicksPerMs);
+}
+
+// The nodes are written without recursion; call paths can be very deep.
+static void writeXml(const char* name, double minMs) {
+	FILE* file = fopen(name, "w");
+	if(!file)
+		error("couldn't open file for writing", name);
+	vector<int> stack;
+	writeXmlNode(file, 0, 0, minMs);
+	stack.push_back(sNodes[0].firstChild);
+	while(!stack.empty()) {
+		int& c(stack.back());
+		while(c >= 0 && !shown(c, minMs))
+			c = sNodes[c].next;
+		int level = stack.size();
+		if(c < 0) {
+			stack.pop_back();
+			level--;
+			if(level > 0)
+				fprintf(file, "%*c", level, ' ');
+			fprintf(file, "</f>\n");
+			continue;
+		}
+		int node = c;
+		c = sNodes[c].next;
+		writeXmlNode(file, node, level, minMs);
+		stack.push_back(sNodes[node].firstChild);
+	}
+	fclose(file);
+}
+
+static void writeFolded(const char* name, double minMs) {
+	FILE* file = fopen(name, "w");
+	if(!file)
+		error("couldn't open file for writing", name);
+	// the path to the current node, and where each name starts in it.
+	string path;
+	vector<size_t> starts;
+	vector<int> stack;
+	stack.push_back(0);
+	while(!stack.empty()) {
+		int& c(stack.back());
+		while(c >= 0 && !shown(c, minMs))
+			c = sNodes[c].next;
+		if(c < 0) {
+			stack.pop_back();
+			if(!starts.empty()) {
+				path.resize(starts.back());
+				starts.pop_back();
+			}
+			continue;
+		}
+		int node = c;
+		c = sNodes[c].next;
+		const FunctionProfileNode& n(sNodes[node].n);
+		starts.push_back(path.size());
+		if(!path.empty())
+			path += ';';
+		const string* fn = findName(n.ip);
+		if(fn) {
+			path += *fn;
+		} else {
+			char buf[16];
+			sprintf(buf, "0x%x", n.ip);
+			path += buf;
+		}
+		long long us = (long long)(n.selfTicks / sTicksPerMs * 1000 + 0.5);
+		if(us > 0)
+			fprintf(file, "%s %lld\n", path.c_str(), us);
+		stack.push_back(sNodes[node].firstChild);
+	}
+	fclose(file);
+}
+
+int main(int argc, const char** argv) {
+	const char* xml = NULL;
+	const char* folded = NULL;
+	const char* input = NULL;
+	double minMs = 0;
+	for(int i=1; i<argc; i++) {
+		if(strcmp(argv[i], "-xml") == 0 && i + 1 < argc) {
+			xml = argv[++i];
+		} else if(strcmp(argv[i], "-folded") == 0 && i + 1 < argc) {
+			folded = argv[++i];
+		} else if(strcmp(argv[i], "-min") == 0 && i + 1 < argc) {
+			minMs = atof(argv[++i]);
+		} else if(argv[i][0] != '-' && !input) {
+			input = argv[i];
+		} else {
+			usage();
+		}
+	}
+	if(!input || (!xml && !folded))
+		usage();
+
+	load(input);
+	if(xml)
+		writeXml(xml, minMs);
+	if(folded)
+		writeFolded(folded, minMs);
+	return 0;
+}
@@ -0,0 +1,12 @@
+#!/usr/bin/ruby
+
+require File.expand_path('../../rules/native_mosync.rb')
+
+work = MoSyncExe.new
+work.instance_eval do
+	@SOURCES = ["."]
+	@NAME = "fpconv"
+	@INSTALLDIR = mosyncdir + '/bin'
+end
+
+work.invoke
@@ -48,6 +48,8 @@ static void outputInvokeSyscallArmRecompiler(const Interface& maapi);
 static void outputInvokeSyscallJava(const Interface& maapi);
 static void outputSyscallStaticJava(const Interface& maapi);
 static void outputSyscallStaticCpp(const Interface& maapi);
+static void outputSyscallTableCpp(const Interface& maapi);
+static void outputSyscallInfoCpp(const Interface& maapi);
 static void outputCoreConsts();
 static void outputConsts(const string& filename, const Interface& inf, int ix);
 static void outputConstSets(const Interface& maapi);
@@ -193,6 +195,8 @@ int main() {
 		copy("maapi_defs.h", "../../intlibs/helpers/");
 
 		copy("Output/invoke_syscall_cpp.h", "../../runtimes/cpp/core/");
+		copy("Output/syscall_table_cpp.h", "../../runtimes/cpp/core/");
+		copy("Output/syscall_info_cpp.h", "../../runtimes/cpp/core/");
 		copy("Output/syscall_static_cpp.h", "../../runtimes/cpp/platforms/iphone/Classes/");
 		copy("Output/invoke_syscall_arm_recompiler.h", "../../runtimes/cpp/core/");
 		copy("Output/asm_config.h", "../../intlibs/helpers/");
@@ -1048,6 +1052,8 @@ static void outputRuntimeBuilderFiles(const Interface& maapi) {
 //	outputInvokeSyscallJavascript(maapi);
 	outputSyscallStaticJava(maapi);
 	outputSyscallStaticCpp(maapi);
+	outputSyscallTableCpp(maapi);
+	outputSyscallInfoCpp(maapi);
 	outputConstSets(maapi);
 }
 
@@ -1278,8 +1284,15 @@ static void outputInvokeSyscallCpp(const Interface& maapi) {
 	streamInvokeSyscall(stream, maapi, false);
 }
 
+// If true, streamInvokeSyscall() outputs one function per syscall
+// instead of switch cases.
+static bool sInvokeFunctions = false;
+
 void streamInvokePrefix(ostream& stream, const Function& f) {
-	stream << "case " << f.number << ":\n";
+	if(sInvokeFunctions)
+		stream << "SAFUNC void _syscall_" << f.name << "()\n";
+	else
+		stream << "case " << f.number << ":\n";
 }
 
 static void outputInvokeSyscallJava(const Interface& maapi) {
@@ -1409,6 +1422,215 @@ static void outputSyscallStaticCpp(const Interface& maapi) {
 	}
 }
 
+// Outputs one handler function per syscall, to be included in the core's class,
+// and a dense table of them, indexed by syscall number.
+// The core defines SyscallHandler and SYSCALL_HANDLER(name).
+static void outputSyscallTableCpp(const Interface& maapi) {
+	ofstream stream("Output/syscall_table_cpp.h");
+	sInvokeFunctions = true;
+	streamInvokeSyscall(stream, maapi, false);
+	sInvokeFunctions = false;
+
+	int count = 0;
+	for(size_t i=0; i<maapi.functions.size(); i++) {
+		count = MAX(count, maapi.functions[i].number + 1);
+	}
+	vector<const Function*> byNumber(count, (const Function*)NULL);
+	for(size_t i=0; i<maapi.functions.size(); i++) {
+		const Function& f(maapi.functions[i]);
+		byNumber[f.number] = &f;
+	}
+
+	stream << "\n#define SYSCALL_COUNT " << count << "\n\n";
+	stream << "SAFUNC const SyscallHandler* syscallHandlers() {\n";
+	stream << "\tstatic const SyscallHandler handlers[SYSCALL_COUNT] = {\n";
+	for(int i=0; i<count; i++) {
+		if(byNumber[i])
+			stream << "\t\tSYSCALL_HANDLER(" << byNumber[i]->name << "),\n";
+		else
+			stream << "\t\tNULL,\n";
+	}
+	stream << "\t};\n";
+	stream << "\treturn handlers;\n";
+	stream << "}\n";
+}
+
+static bool beginsWith(const string& s, const char* prefix) {
+	return s.compare(0, strlen(prefix), prefix) == 0;
+}
+
+static string trim(const string& s) {
+	size_t beg = s.find_first_not_of(" \t");
+	if(beg == string::npos)
+		return "";
+	size_t end = s.find_last_not_of(" \t");
+	return s.substr(beg, end - beg + 1);
+}
+
+// Returns the register of each argument of \a f relative to REG_i0,
+// or -1 if the argument is passed on the stack.
+static vector<int> argRegisters(const Interface& maapi, const Function& f) {
+	vector<int> regs;
+	int ireg = 0;
+	for(size_t j=0; j<f.args.size(); j++) {
+		string ct = cType(maapi, f.args[j].type);
+		int size = (ct == "double" || ct == "long") ? 2 : 1;
+		if(ireg + size > 4) {
+			regs.push_back(-1);
+		} else {
+			regs.push_back(ireg);
+			ireg += size;
+		}
+	}
+	return regs;
+}
+
+static int argIndex(const Function& f, const string& name) {
+	for(size_t j=0; j<f.args.size(); j++) {
+		if(f.args[j].name == name)
+			return (int)j;
+	}
+	return -1;
+}
+
+// Converts the range of argument \a j of syscall \a f to a SyscallRange.
+// The core validates these ranges before the syscall is invoked, so the
+// range must be a product of integer constants and at most one register argument.
+static void streamSyscallRange(ostream& stream, const Interface& maapi,
+	const Function& f, size_t j)
+{
+	const Argument& a(f.args[j]);
+	vector<int> regs = argRegisters(maapi, f);
+	if(regs[j] < 0)
+		Error("logic", f.name + ": ranged argument " + a.name + " is not in a register");
+
+	int length = -1;
+	int scale = 1;
+	string range = a.range;
+	size_t pos = 0;
+	while(pos <= range.size()) {
+		size_t end = range.find('*', pos);
+		if(end == string::npos)
+			end = range.size();
+		string factor = trim(range.substr(pos, end - pos));
+		pos = end + 1;
+		if(!factor.empty() && isdigit(factor[0])) {
+			scale *= atoi(factor.c_str());
+			continue;
+		}
+		int k = argIndex(f, factor);
+		if(k < 0 || length >= 0 || regs[k] < 0 || isPointerType(maapi, f.args[k].type))
+			Error("logic", f.name + ": unsupported range \"" + range + "\"");
+		length = regs[k];
+	}
+	if(scale <= 0 || scale > 0xffff)
+		Error("logic", f.name + ": unsupported range \"" + range + "\"");
+	stream << "{ " << regs[j] << ", " << length << ", " << scale << " }";
+}
+
+static char argKind(const Interface& maapi, const Argument& a) {
+	if(a.type == "MAString")
+		return 's';
+	if(a.type == "MAWString")
+		return 'w';
+	string ct = cType(maapi, a.type);
+	if(ct == "double")
+		return 'd';
+	if(ct == "long")
+		return 'l';
+	for(size_t i=0; i<maapi.structs.size(); i++) {
+		if(a.type == maapi.structs[i].name)
+			return 'r';
+	}
+	if(isPointerType(maapi, a.type))
+		return 'p';
+	return 'i';
+}
+
+// Syscalls that may suspend the VM thread.
+static bool syscallMayBlock(const Function& f) {
+	return f.name == "maWait";
+}
+
+// Classifies syscalls by name; the IDL has no annotation for this.
+static const char* syscallCost(const Interface& maapi, const Function& f) {
+	if(syscallMayBlock(f))
+		return "SCC_BLOCKING";
+	if(beginsWith(f.name, "maConn") || beginsWith(f.name, "maHttp") ||
+		f.name.find("Store") != string::npos || beginsWith(f.name, "maLoadResource") ||
+		beginsWith(f.name, "maSound") || f.name == "maVibrate")
+	{
+		return "SCC_IO";
+	}
+	if(beginsWith(f.name, "maDraw") || beginsWith(f.name, "maFill") ||
+		beginsWith(f.name, "maPlot") || beginsWith(f.name, "maLine") ||
+		beginsWith(f.name, "maGetTextSize") || f.name == "maUpdateScreen" ||
+		f.name.find("Image") != string::npos || f.name == "maSetDrawTarget")
+	{
+		return "SCC_GRAPHICS";
+	}
+	for(size_t j=0; j<f.args.size(); j++) {
+		char kind = argKind(maapi, f.args[j]);
+		if(kind == 'p' || (kind == 's' && !f.args[j].in))
+			return "SCC_MEMORY";
+	}
+	if(f.name == "maCopyData" || f.name == "strcpy")
+		return "SCC_MEMORY";
+	return "SCC_COMPUTE";
+}
+
+// Outputs gSyscallInfo[], the metadata of each syscall, indexed by syscall number.
+static void outputSyscallInfoCpp(const Interface& maapi) {
+	ofstream stream("Output/syscall_info_cpp.h");
+	int count = 0;
+	for(size_t i=0; i<maapi.functions.size(); i++) {
+		count = MAX(count, maapi.functions[i].number + 1);
+	}
+	vector<const Function*> byNumber(count, (const Function*)NULL);
+	for(size_t i=0; i<maapi.functions.size(); i++) {
+		const Function& f(maapi.functions[i]);
+		byNumber[f.number] = &f;
+	}
+
+	stream << "#include \"syscall_info.h\"\n\n";
+	stream << "static const SyscallInfo gSyscallInfo[" << count << "] = {\n";
+	for(int i=0; i<count; i++) {
+		if(!byNumber[i]) {
+			stream << "\t{ NULL, \"\", 0, SCC_COMPUTE, 0, { { 0, 0, 0 }, { 0, 0, 0 } } },\n";
+			continue;
+		}
+		const Function& f(*byNumber[i]);
+		string kinds;
+		vector<size_t> ranged;
+		for(size_t j=0; j<f.args.size(); j++) {
+			kinds += argKind(maapi, f.args[j]);
+			if(!f.args[j].range.empty())
+				ranged.push_back(j);
+		}
+		if(ranged.size() > 2)
+			Error("logic", f.name + ": too many ranged arguments");
+
+		stream << "\t{ \"" << f.name << "\", \"" << kinds << "\", ";
+		if(syscallMayBlock(f))
+			stream << "SCF_BLOCKING";
+		else if(f.returnType == "noreturn")
+			stream << "SCF_NORETURN";
+		else
+			stream << "0";
+		stream << ", " << syscallCost(maapi, f) << ", " << ranged.size() << ", { ";
+		for(size_t k=0; k<2; k++) {
+			if(k != 0)
+				stream << ", ";
+			if(k < ranged.size())
+				streamSyscallRange(stream, maapi, f, ranged[k]);
+			else
+				stream << "{ 0, 0, 0 }";
+		}
+		stream << " } },\n";
+	}
+	stream << "};\n";
+}
+
 static void outputCoreConsts() {
 #define DO(id) { file << "#define "<<#id<<" "<<i<<"\n"; i++; }
 	int i=0;
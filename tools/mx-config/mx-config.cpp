@@ -22,6 +22,7 @@ limitations under the License.
 #include <stdlib.h>
 
 #include <idl-common/idl-common.h>
+#include <idl-common/stringFunctions.h>
 
 using namespace std;
 
@@ -132,6 +133,13 @@ static void outputMxHeader(const char* output, const Interface& inf, int fnOffse
 		streamIoctlFunction(stream, inf, inf.functions[i], "maInvokeExtension", fnOffset);
 	}
 
+	// For maExtensionFunctionInvokeV().
+	for(size_t i=0; i<inf.functions.size(); i++) {
+		const Function& f(inf.functions[i]);
+		stream << "#define MX_FN_" << toupper(f.name) << " " << (fnOffset + f.number) << "\n";
+	}
+	streamTypedBlockDefines(stream, inf);
+
 	stream << "#ifdef __cplusplus\n"
 		"}\n"
 		"#endif\n\n";
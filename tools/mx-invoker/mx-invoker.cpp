@@ -101,6 +101,16 @@ static void outputInvoker(const char* output, const Interface& inf) {
 		"\n"
 		"\tgRegs = cd->regs;\n"
 		"\tgMemDs = cd->memDs;\n"
+		"}\n"
+		"\n";
+	streamTypedInvokeExtension(stream, inf);
+	stream << "\n"
+		"extern \"C\"\n"
+		"void DLLEXPORT initializeExtension2(ExtensionData2* ed) {\n"
+		"\ted->nFunctions = sizeof(sTypedFunctions) / sizeof(*sTypedFunctions);\n"
+		"\ted->functions = sTypedFunctions;\n"
+		"\ted->idlHash = IDL_HASH_"<<inf.name<<";\n"
+		"\ted->name = \""<<inf.name<<"\";\n"
 		"}\n";
 	flushStream(stream);
 }
@@ -39,124 +39,6 @@ void RebuildInit()
 {
 }
 
-//****************************************
-//		  Peephole Optimizer
-//****************************************
-
-void Peeper(uchar *ip, uchar *ip_end)
-{
-	OpcodeInfo opi[4];
-	uchar *start_ip = ip;
-	int n;
-	int op_count = 0;
-
-	for (n=0;n<4;n++)
-	{
-		if (ip > ip_end)
-			break;
-
-		ip = DecodeOpcode(&opi[n], ip);
-		op_count++;
-	}
-
-	if (op_count != 4)
-		return;
-
-
-	// Double optimizer
-
-	while(1)
-	{
-/*
-	ld r0,r14
-	ld r1,r15
-	ld r14,r0
-	ld r15,r1
-*/
-		// All are ldr
-
-		if (opi[0].op != _LDR)
-			break;
-		if (opi[1].op != _LDR)
-			break;
-		if (opi[2].op != _LDR)
-			break;
-		if (opi[3].op != _LDR)
-			break;
-
-		// check r0's
-		if (opi[0].rd != opi[2].rs)
-			break;
-
-		// check r1's
-		if (opi[1].rd != opi[3].rs)
-			break;
-
-		// check r14's
-		if (opi[0].rs != opi[2].rd)
-			break;
-
-		// check r15's
-		if (opi[1].rs != opi[3].rd)
-			break;
-
-		*start_ip++ = 0;
-		*start_ip++ = 0;
-		*start_ip++ = 0;
-
-		*start_ip++ = 0;
-		*start_ip++ = 0;
-		*start_ip++ = 0;
-
-		*start_ip++ = 0;
-		*start_ip++ = 0;
-		*start_ip++ = 0;
-
-		*start_ip++ = 0;
-		*start_ip++ = 0;
-		*start_ip++ = 0;
-		return;
-	}
-
-
-	// Register to register switches
-
-	while(1)
-	{
-/*
-		ld r0,r1
-		ld r1,r0
-*/
-		// All are ldr
-
-		if (opi[0].op != _LDR)
-			break;
-		if (opi[1].op != _LDR)
-			break;
-
-		// check r0's
-		if (opi[0].rd != opi[1].rs)
-			break;
-
-		// check r1's
-		if (opi[1].rd != opi[0].rs)
-			break;
-
-		*start_ip++ = 0;
-		*start_ip++ = 0;
-		*start_ip++ = 0;
-
-		*start_ip++ = 0;
-		*start_ip++ = 0;
-		*start_ip++ = 0;
-		return;
-	}
-
-
-	//memset(start_ip, 0, start_ip - ip);
-}
-
-
 //***************************************
 //
 //***************************************
@@ -216,12 +98,13 @@ char * RebuildRetType(int type)
 
 void RebuildFunc(SYMBOL *sym)
 {
-	OpcodeInfo thisOp;
+	PeepInst *inst, *thisInst;
 	SYMBOL *ref;
 
 	uchar *ip, *ip_end, *ip_last;
 
 	int real_ip;
+	int count, n;
 	char str[256];
 
 	if (!sym)
@@ -258,6 +141,9 @@ void RebuildFunc(SYMBOL *sym)
 	ip_end = (uchar *) ArrayPtr(&CodeMemArray, sym->EndIP);
 	ip = (uchar *) ArrayPtr(&CodeMemArray, sym->Value);
 	real_ip	= sym->Value;
+	count = 0;
+
+	// Decode the function
 
 	while(1)
 	{
@@ -266,6 +152,30 @@ void RebuildFunc(SYMBOL *sym)
 		if (ip > ip_end)
 			break;
 
+		thisInst = (PeepInst *) ArrayPtr(&PeepArray, count++);
+
+		ref = (SYMBOL *) ArrayGet(&CodeLabelArray, real_ip);
+
+		ip = DecodeOpcode(&thisInst->orig, ip);
+		thisInst->op = thisInst->orig;
+		thisInst->live = ArgSkipElim || ArrayGet(&CodeTouchArray, real_ip);
+		thisInst->label = (ref != 0);
+		thisInst->deleted = 0;
+		thisInst->changed = 0;
+
+		real_ip += (ip - ip_last);
+	}
+
+	inst = (PeepInst *) ArrayPtr(&PeepArray, 0);
+
+	if (ArgPeephole)
+		Peeper(sym, inst, count);
+
+	for (n=0;n<count;n++)
+	{
+		thisInst = &inst[n];
+		real_ip = thisInst->orig.rip;
+
 		// Print labels
 
 		ref = (SYMBOL *) ArrayGet(&CodeLabelArray, real_ip);
@@ -278,16 +188,18 @@ void RebuildFunc(SYMBOL *sym)
 
 		RebuildEmitStabs(real_ip);
 
-//		Peeper(ip, ip_end);
+		// Eliminated code, and code removed by the peephole optimizer
 
-		if (ArgSkipElim == 0)
-			if (ArrayGet(&CodeTouchArray, real_ip) == 0)
-				RebuildEmit("// ");
+		if (!thisInst->live || thisInst->deleted)
+			RebuildEmit("// ");
 
 		CaseRef = 0;
 
-		ip = DecodeOpcode(&thisOp, ip);
-		DecodeAsmString(&thisOp, str, 1);
+		if (thisInst->changed)
+			PeepAsmString(&thisInst->op, str);
+		else
+			DecodeAsmString(&thisInst->op, str, 1);
+
 		RebuildEmit("\t%s", str);
 
 //		DecodeAsmString(&thisOp, str, 0);			// Sanity testing
@@ -320,8 +232,6 @@ void RebuildFunc(SYMBOL *sym)
 			Rebuild_Data(CaseRef);
 			RebuildEmit(".code\n");
 		}
-
-		real_ip += (ip - ip_last);
 	}
 }
 
@@ -606,6 +516,9 @@ void Rebuild_Main()
 {
 	ArrayInit(&RebuildArray, sizeof(char), 0);
 	ArrayInit(&LabelDone, sizeof(char), 0);
+	ArrayInit(&PeepArray, sizeof(PeepInst), 0);
+
+	PeepInit();
 
 	lastfileno = -1;
 	Rebuild_Mode = 1;
@@ -623,6 +536,10 @@ void Rebuild_Main()
 	Rebuild_Memory();
 
 	ArrayWrite(&RebuildArray, "rebuild.s");
+	ArrayDispose(&PeepArray);
+
+	if (ArgPeephole)
+		PeepReport();
 }
 
 //****************************************
@@ -247,6 +247,19 @@ int main(int argc,char *argv[])
 			continue;
 		}
 
+		if (Token("peephole-verify"))
+		{
+			ArgPeephole = 1;
+			ArgPeepVerify = 1;
+			continue;
+		}
+
+		if (Token("peephole"))
+		{
+			ArgPeephole = 1;
+			continue;
+		}
+
 		if (Token("sld="))
 		{
 			ArgSLD = 1;
@@ -340,6 +353,12 @@ int main(int argc,char *argv[])
 			continue;
 		}
 
+		if (Token("atlas"))
+		{
+			ArgAtlas = 1;
+			continue;
+		}
+
 		if (Token("gcj="))
 		{
 			GetCmdString();
@@ -740,6 +759,8 @@ Build application (-B) options:\n\
   -sld=file            output source/line translation\n\
   -stabs=file          output debug information\n\
   -elim                eliminate unreferenced code/data\n\
+  -peephole            with -elim: optimize the rebuilt code\n\
+  -peephole-verify     with -elim: optimize, and test the result in an emulator\n\
   -no-verify           prevent code verification\n\
   -java                build a Java class file\n\
   -gcj=flags           for -java option: set flags for GCJ\n\
@@ -748,6 +769,7 @@ Build application (-B) options:\n\
 \n\
 Resource compiler (-R) options:\n\
   -depend=file         output dependencies in makefile syntax\n\
+  -atlas               pack the images in '.atlas' blocks; only MoRE loads them\n\
 \n\
 Librarian (-L) options:\n\
   -quiet               don't display the component files\n\
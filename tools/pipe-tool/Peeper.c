@@ -18,194 +18,1300 @@ limitations under the License.
 // 						   		Written by A.R.Hartley
 //*********************************************************************************************
 
+// The peephole optimizer runs on each function when the code is rebuilt
+// after elimination (-elim -peephole). The function is decoded into an
+// array of PeepInst, the patterns below are applied until nothing changes,
+// and CodeRebuild emits the result.
+//
+// Patterns never look across a label or a control transfer, so every
+// basic block computes the same registers and memory as before.
+// With -peephole-verify that is checked: each block of the optimized
+// function is run against the original in a small emulator, and a function
+// that differs is rebuilt unoptimized.
+
 #include "compile.h"
 
+#define PEEP_MAX_PASSES		16
+#define PEEP_MAX_WINDOW		16
+#define PEEP_MAX_HOPS		8
+#define PEEP_VERIFY_RUNS	24
+
+extern int OpcodeFetch[256];
+extern char *OpcodeStrings[256];
+
+typedef struct
+{
+	char *name;
+	int (*func)(int n);
+	int hits;
+} PeepPattern;
+
+static PeepInst *Peep;
+static int PeepCount;
+static SYMBOL *PeepSym;
+
+static int PeepFuncHits[32];
+
+static int PeepFuncs;
+static int PeepReverted;
+static int PeepInstBefore;
+static int PeepInstAfter;
+static int PeepBytesBefore;
+static int PeepBytesAfter;
+
+static unsigned int PeepSeed;
 
 //****************************************
-//		  Peephole Optimizer
+//		  Instruction properties
 //****************************************
 
-#if 0
+int PeepIsJump(int op)
+{
+	if (op >= _JC_EQ && op <= _JC_LTU)
+		return 1;
+
+	return (op == _JPI);
+}
+
+//****************************************
 
-void Peeper(uchar *ip, uchar *ip_end)
+int PeepIsBarrier(int op)
 {
-	OpcodeInfo op[4];
-	uchar *start_ip = ip;
-	int n;
-	int op_count = 0;
-	
-	for (n=0;n<4;n++)
+	switch(op)
 	{
-		if (ip > ip_end)
-			break;
+		case _PUSH:
+		case _POP:
+		case _CALL:
+		case _CALLI:
+		case _RET:
+		case _JPR:
+		case _SYSCALL:
+		case _CASE:
+		case _FAR:
+			return 1;
+	}
+
+	return 0;
+}
+
+//****************************************
+
+int PeepEndsBlock(int op)
+{
+	return PeepIsJump(op) || PeepIsBarrier(op);
+}
+
+//****************************************
+
+int PeepIsStore(int op)
+{
+	return (op == _STB || op == _STH || op == _STW);
+}
+
+//****************************************
+// True if the instruction has a symbol
+// reference, which must be kept as it is
+//****************************************
 
-		ip = DecodeOpcode(&op[n], ip);
-		op_count++;
+int PeepHasReloc(OpcodeInfo *op)
+{
+	if (ArrayGet(&CallArray, op->rip))
+		return 1;
+
+	if (ArrayGet(&DataAccessArray, op->rip))
+		return 1;
+
+	return 0;
+}
+
+//****************************************
+//	  Register written by instruction
+//****************************************
+
+int PeepDefs(OpcodeInfo *op)
+{
+	switch(op->op)
+	{
+		case _LDB:		case _LDH:		case _LDW:
+		case _LDI:		case _LDR:
+		case _ADD:		case _ADDI:		case _MUL:		case _MULI:
+		case _SUB:		case _SUBI:		case _AND:		case _ANDI:
+		case _OR:		case _ORI:		case _XOR:		case _XORI:
+		case _DIVU:		case _DIVUI:	case _DIV:		case _DIVI:
+		case _SLL:		case _SLLI:		case _SRA:		case _SRAI:
+		case _SRL:		case _SRLI:
+		case _NOT:		case _NEG:		case _XB:		case _XH:
+			return op->rd;
 	}
 
-	if (op_count != 4)
-		return;
+	return -1;
+}
 
+//****************************************
+//		True if reg is read by
+//			  instruction
+//****************************************
+
+int PeepUses(OpcodeInfo *op, int reg)
+{
+	int rs = op->rs;
 
-	// Double optimizer
+	// Registers above 31 are constants
 
-	while(1)
+	if (rs >= 32)
+		rs = -1;
+
+	if (PeepIsBarrier(op->op))
+		return 1;
+
+	switch(op->op)
 	{
-/*
-	ld r0,r14	
-	ld r1,r15	
-	ld r14,r0	
-	ld r15,r1	
-*/
-		// All are ldr
-		
-		if (op[0].op != _LDR)
-			break;
-		if (op[1].op != _LDR)
-			break;
-		if (op[2].op != _LDR)
-			break;
-		if (op[3].op != _LDR)
-			break;
+		case _LDB:		case _LDH:		case _LDW:
+		case _LDR:
+		case _NOT:		case _NEG:		case _XB:		case _XH:
+			return (rs == reg);
 
-		// check r0's
-		if (op[0].rd != op[2].rs)
-			break;
+		case _STB:		case _STH:		case _STW:
+		case _ADD:		case _MUL:		case _SUB:		case _AND:
+		case _OR:		case _XOR:		case _DIVU:		case _DIV:
+		case _SLL:		case _SRA:		case _SRL:
+			return (op->rd == reg || rs == reg);
 
-		// check r1's
-		if (op[1].rd != op[3].rs)
-			break;
+		case _ADDI:		case _MULI:		case _SUBI:		case _ANDI:
+		case _ORI:		case _XORI:		case _DIVUI:	case _DIVI:
+		case _SLLI:		case _SRAI:		case _SRLI:
+			return (op->rd == reg);
+	}
 
-		// check r14's
-		if (op[0].rs != op[2].rd)
-			break;
+	if (op->op >= _JC_EQ && op->op <= _JC_LTU)
+		return (op->rd == reg || rs == reg);
+
+	return 0;
+}
+
+//****************************************
+//	  True if the instruction only sets
+//	 rd, and can be removed if rd is dead
+//****************************************
+
+int PeepIsPure(int op)
+{
+	switch(op)
+	{
+		case _LDI:		case _LDR:
+		case _ADD:		case _ADDI:		case _MUL:		case _MULI:
+		case _SUB:		case _SUBI:		case _AND:		case _ANDI:
+		case _OR:		case _ORI:		case _XOR:		case _XORI:
+		case _SLL:		case _SLLI:		case _SRA:		case _SRAI:
+		case _SRL:		case _SRLI:
+		case _NOT:		case _NEG:		case _XB:		case _XH:
+			return 1;
+	}
+
+	// Loads may fault and divides may trap
+
+	return 0;
+}
+
+//****************************************
+//	 Find the instruction at a code ip
+//****************************************
+
+int PeepFind(int ip)
+{
+	int lo = 0;
+	int hi = PeepCount - 1;
+	int mid;
+
+	while (lo <= hi)
+	{
+		mid = (lo + hi) / 2;
+
+		if (Peep[mid].orig.rip == ip)
+			return mid;
 
-		// check r15's
-		if (op[1].rs != op[3].rd)
+		if (Peep[mid].orig.rip < ip)
+			lo = mid + 1;
+		else
+			hi = mid - 1;
+	}
+
+	return -1;
+}
+
+//****************************************
+//	 First instruction that will run at
+//	 or after n, PeepCount if there is none
+//****************************************
+
+int PeepResolve(int n)
+{
+	while (n < PeepCount)
+	{
+		if (Peep[n].live && !Peep[n].deleted)
 			break;
 
-		*start_ip++ = 0;
-		*start_ip++ = 0;
-		*start_ip++ = 0;
+		n++;
+	}
 
-		*start_ip++ = 0;
-		*start_ip++ = 0;
-		*start_ip++ = 0;
+	return n;
+}
 
-		*start_ip++ = 0;
-		*start_ip++ = 0;
-		*start_ip++ = 0;
+//****************************************
+//	Previous instruction in the same block,
+//	  -1 if n is the start of the block
+//****************************************
 
-		*start_ip++ = 0;
-		*start_ip++ = 0;
-		*start_ip++ = 0;
-		return;
+int PeepPrev(int n)
+{
+	int p;
+
+	if (Peep[n].label)
+		return -1;
+
+	for (p=n-1;p>=0;p--)
+	{
+		if (Peep[p].live && !Peep[p].deleted)
+		{
+			if (PeepEndsBlock(Peep[p].op.op))
+				return -1;
+
+			return p;
+		}
+
+		if (Peep[p].label)
+			return -1;
 	}
-	
-	
-	// Register to register switches
-	
-	while(1)
+
+	return -1;
+}
+
+//****************************************
+//	  Next instruction in the same block,
+//	    -1 if n is the end of the block
+//****************************************
+
+int PeepNext(int n)
+{
+	int p;
+
+	if (PeepEndsBlock(Peep[n].op.op))
+		return -1;
+
+	for (p=n+1;p<PeepCount;p++)
 	{
-/*
-		ld r0,r1	
-		ld r1,r0	
-*/
-		// All are ldr
+		if (Peep[p].label)
+			return -1;
 
-		if (op[0].op != _LDR)
-			break;
-		if (op[1].op != _LDR)
-			break;
+		if (Peep[p].live && !Peep[p].deleted)
+			return p;
+	}
 
-		// check r0's
-		if (op[0].rd != op[1].rs)
-			break;
+	return -1;
+}
+
+//****************************************
+//		   Change an instruction
+//****************************************
+
+void PeepSetOp(int n, int op, int rd, int rs, int imm)
+{
+	OpcodeInfo *thisOp = &Peep[n].op;
+
+	thisOp->op = op;
+	thisOp->rd = rd;
+	thisOp->rs = rs;
+	thisOp->imm = imm;
+	thisOp->flags = OpcodeFetch[op];
+	thisOp->str = OpcodeStrings[op];
+
+	Peep[n].changed = 1;
+}
+
+//****************************************
+//	Value of a register before n, if it
+//	  is set by an LDI in the same block
+//****************************************
+
+int PeepRegValue(int n, int reg, int *value)
+{
+	int p;
+	int count = 0;
+
+	if (reg == REG_zero)
+	{
+		*value = 0;
+		return 1;
+	}
+
+	p = n;
+
+	while (count++ < PEEP_MAX_WINDOW)
+	{
+		p = PeepPrev(p);
+
+		if (p < 0)
+			return 0;
+
+		if (PeepDefs(&Peep[p].op) != reg)
+			continue;
+
+		if (Peep[p].op.op != _LDI || PeepHasReloc(&Peep[p].op))
+			return 0;
+
+		*value = Peep[p].op.imm;
+		return 1;
+	}
+
+	return 0;
+}
+
+//****************************************
+//	Final target of a jump, following
+//	  jumps to unconditional jumps
+//****************************************
+
+int PeepJumpTarget(int ip)
+{
+	SYMBOL *ref;
+	int hops;
+	int n;
+
+	for (hops=0;hops<PEEP_MAX_HOPS;hops++)
+	{
+		n = PeepFind(ip);
+
+		if (n < 0)
+			return ip;
+
+		n = PeepResolve(n);
+
+		if (n >= PeepCount || Peep[n].op.op != _JPI)
+			return ip;
+
+		// Only jump to labels in this function
+
+		ref = (SYMBOL *) ArrayGet(&CodeLabelArray, Peep[n].op.imm);
+
+		if (!ref || ref->LabelType != label_Local || PeepFind(Peep[n].op.imm) < 0)
+			return ip;
+
+		ip = Peep[n].op.imm;
+	}
+
+	// A loop of jumps, leave it
+
+	return -1;
+}
+
+//****************************************
+//				Patterns
+//****************************************
+
+//	jp L1 ... L1: jp L2		->	jp L2
+
+int PeepJumpThread(int n)
+{
+	OpcodeInfo *thisOp = &Peep[n].op;
+	int target;
+
+	if (!PeepIsJump(thisOp->op))
+		return 0;
+
+	target = PeepJumpTarget(thisOp->imm);
+
+	if (target < 0 || target == thisOp->imm)
+		return 0;
+
+	thisOp->imm = target;
+	Peep[n].changed = 1;
+	return 1;
+}
+
+//	jp L1; L1:				->	L1:
+
+int PeepJumpNext(int n)
+{
+	OpcodeInfo *thisOp = &Peep[n].op;
+	int target;
+
+	if (!PeepIsJump(thisOp->op))
+		return 0;
+
+	target = PeepFind(thisOp->imm);
+
+	if (target <= n)
+		return 0;
+
+	if (PeepResolve(target) != PeepResolve(n + 1))
+		return 0;
+
+	Peep[n].deleted = 1;
+	return 1;
+}
+
+//	ld r0,r0				->
+
+int PeepSelfMove(int n)
+{
+	OpcodeInfo *thisOp = &Peep[n].op;
+
+	if (thisOp->op != _LDR || thisOp->rd != thisOp->rs)
+		return 0;
+
+	Peep[n].deleted = 1;
+	return 1;
+}
+
+//	add r0,#0 / add r0,zr	->
+
+int PeepIdentity(int n)
+{
+	OpcodeInfo *thisOp = &Peep[n].op;
+	int identity;
+
+	switch(thisOp->op)
+	{
+		case _ADD:	case _SUB:	case _OR:	case _XOR:
+		case _SLL:	case _SRA:	case _SRL:
+			identity = (thisOp->rs == REG_zero);
+		break;
+
+		case _ADDI:	case _SUBI:	case _ORI:	case _XORI:
+		case _SLLI:	case _SRAI:	case _SRLI:
+			identity = (thisOp->imm == 0);
+		break;
+
+		case _MULI:
+			identity = (thisOp->imm == 1);
+		break;
+
+		case _ANDI:
+			identity = (thisOp->imm == -1);
+		break;
+
+		default:
+			return 0;
+	}
+
+	if (!identity || PeepHasReloc(thisOp))
+		return 0;
+
+	Peep[n].deleted = 1;
+	return 1;
+}
+
+//	ld r0,r1 ... ld r1,r0	->	ld r0,r1 ...
+
+int PeepMoveBack(int n)
+{
+	OpcodeInfo *thisOp = &Peep[n].op;
+	OpcodeInfo *prevOp;
+	int p = n;
+	int count = 0;
+	int def;
+
+	if (thisOp->op != _LDR || thisOp->rs >= 32)
+		return 0;
+
+	if (thisOp->rd == REG_zero || thisOp->rs == REG_zero || thisOp->rd == thisOp->rs)
+		return 0;
+
+	while (count++ < PEEP_MAX_WINDOW)
+	{
+		p = PeepPrev(p);
+
+		if (p < 0)
+			return 0;
+
+		prevOp = &Peep[p].op;
+
+		if (prevOp->op == _LDR && prevOp->rd == thisOp->rs && prevOp->rs == thisOp->rd)
+		{
+			Peep[n].deleted = 1;
+			return 1;
+		}
+
+		def = PeepDefs(prevOp);
+
+		if (def == thisOp->rd || def == thisOp->rs)
+			return 0;
+	}
+
+	return 0;
+}
+
+//	ld [r0,4],r1 ... ld r2,[r0,4]	->	ld [r0,4],r1 ... ld r2,r1
+
+int PeepStoreLoad(int n)
+{
+	OpcodeInfo *thisOp = &Peep[n].op;
+	OpcodeInfo *prevOp;
+	int p = n;
+	int count = 0;
+	uint written = 0;
+	int def;
+
+	if (thisOp->op != _LDW || thisOp->rs >= 32)
+		return 0;
+
+	while (count++ < PEEP_MAX_WINDOW)
+	{
+		p = PeepPrev(p);
+
+		if (p < 0)
+			return 0;
+
+		prevOp = &Peep[p].op;
+
+		if (prevOp->op == _STW && prevOp->rd == thisOp->rs && prevOp->imm == thisOp->imm)
+		{
+			if (prevOp->rs >= 32 || (written & (1u << prevOp->rs)))
+				return 0;
+
+			PeepSetOp(n, _LDR, thisOp->rd, prevOp->rs, 0);
+			return 1;
+		}
+
+		// Another store may write the same memory
+
+		if (PeepIsStore(prevOp->op))
+			return 0;
+
+		def = PeepDefs(prevOp);
+
+		if (def == thisOp->rs)
+			return 0;
+
+		if (def >= 0)
+			written |= 1u << def;
+	}
+
+	return 0;
+}
+
+//	ld r1,[r0,4] ... ld [r0,4],r1	->	ld r1,[r0,4] ...
+
+int PeepLoadStore(int n)
+{
+	OpcodeInfo *thisOp = &Peep[n].op;
+	OpcodeInfo *prevOp;
+	int p = n;
+	int count = 0;
+	int def;
+
+	if (thisOp->op != _STW || thisOp->rs >= 32 || thisOp->rs == thisOp->rd)
+		return 0;
+
+	while (count++ < PEEP_MAX_WINDOW)
+	{
+		p = PeepPrev(p);
+
+		if (p < 0)
+			return 0;
+
+		prevOp = &Peep[p].op;
+
+		if (prevOp->op == _LDW && prevOp->rd == thisOp->rs && prevOp->rs == thisOp->rd && prevOp->imm == thisOp->imm)
+		{
+			Peep[n].deleted = 1;
+			return 1;
+		}
+
+		if (PeepIsStore(prevOp->op))
+			return 0;
+
+		def = PeepDefs(prevOp);
+
+		if (def == thisOp->rd || def == thisOp->rs)
+			return 0;
+	}
 
-		// check r1's
-		if (op[1].rd != op[0].rs)
+	return 0;
+}
+
+//	ld r0,#1; add r0,#2		->	ld r0,#3
+//	add r0,#1; add r0,#2	->	add r0,#3
+
+int PeepAddFold(int n)
+{
+	OpcodeInfo *thisOp = &Peep[n].op;
+	OpcodeInfo *prevOp;
+	int p;
+	int add;
+
+	if (thisOp->op != _ADDI && thisOp->op != _SUBI)
+		return 0;
+
+	if (PeepHasReloc(thisOp))
+		return 0;
+
+	p = PeepPrev(n);
+
+	if (p < 0)
+		return 0;
+
+	prevOp = &Peep[p].op;
+
+	if (prevOp->rd != thisOp->rd || PeepHasReloc(prevOp))
+		return 0;
+
+	add = thisOp->imm;
+
+	if (thisOp->op == _SUBI)
+		add = -add;
+
+	switch(prevOp->op)
+	{
+		case _LDI:
+			PeepSetOp(p, _LDI, prevOp->rd, 0, prevOp->imm + add);
+		break;
+
+		case _ADDI:
+			PeepSetOp(p, _ADDI, prevOp->rd, 0, prevOp->imm + add);
+		break;
+
+		case _SUBI:
+			PeepSetOp(p, _ADDI, prevOp->rd, 0, add - prevOp->imm);
+		break;
+
+		default:
+			return 0;
+	}
+
+	Peep[n].deleted = 1;
+	return 1;
+}
+
+//	ld r1,#4 ... add r0,r1	->	ld r1,#4 ... add r0,#4
+//
+// Only for values that constreg.c keeps in a constant register, which
+// the final assembly turns back into the register form, so the code
+// doesn't grow. The ld often becomes a dead write.
+
+int PeepConstReg(int n)
+{
+	OpcodeInfo *thisOp = &Peep[n].op;
+	int value;
+	int op;
+
+	switch(thisOp->op)
+	{
+		case _LDR:	op = _LDI;		break;
+		case _ADD:	op = _ADDI;		break;
+		case _MUL:	op = _MULI;		break;
+		case _SUB:	op = _SUBI;		break;
+		case _AND:	op = _ANDI;		break;
+		case _OR:	op = _ORI;		break;
+		case _XOR:	op = _XORI;		break;
+		case _DIVU:	op = _DIVUI;	break;
+		case _DIV:	op = _DIVI;		break;
+		case _SLL:	op = _SLLI;		break;
+		case _SRA:	op = _SRAI;		break;
+		case _SRL:	op = _SRLI;		break;
+
+		default:
+			return 0;
+	}
+
+	if (thisOp->rs >= 32 || PeepHasReloc(thisOp))
+		return 0;
+
+	// ld r0,zr is already as short as it gets
+
+	if (op == _LDI && thisOp->rs == REG_zero)
+		return 0;
+
+	if (!PeepRegValue(n, thisOp->rs, &value))
+		return 0;
+
+	if (ConstRegIndex(value) < 0)
+		return 0;
+
+	if ((op == _DIVUI || op == _DIVI) && value == 0)
+		return 0;
+
+	if ((op == _SLLI || op == _SRAI || op == _SRLI) && (value < 0 || value > 31))
+		return 0;
+
+	PeepSetOp(n, op, thisOp->rd, 0, value);
+	return 1;
+}
+
+//	ld r0,r1 ... ld r0,r2	->	... ld r0,r2		(r0 not read between)
+
+int PeepDeadWrite(int n)
+{
+	OpcodeInfo *thisOp = &Peep[n].op;
+	int reg = thisOp->rd;
+	int p = n;
+
+	if (!PeepIsPure(thisOp->op) || reg == REG_zero)
+		return 0;
+
+	while (1)
+	{
+		p = PeepNext(p);
+
+		// Live at the end of the block
+
+		if (p < 0)
+			return 0;
+
+		if (PeepUses(&Peep[p].op, reg))
+			return 0;
+
+		if (PeepDefs(&Peep[p].op) == reg)
 			break;
+	}
+
+	Peep[n].deleted = 1;
+	return 1;
+}
+
+//****************************************
+
+static PeepPattern PeepPatterns[] =
+{
+	{"jump threading",			PeepJumpThread,		0},
+	{"jump to next",			PeepJumpNext,		0},
+	{"self move",				PeepSelfMove,		0},
+	{"identity arithmetic",		PeepIdentity,		0},
+	{"move back",				PeepMoveBack,		0},
+	{"store then load",			PeepStoreLoad,		0},
+	{"load then store",			PeepLoadStore,		0},
+	{"add folding",				PeepAddFold,		0},
+	{"constant registers",		PeepConstReg,		0},
+	{"dead register write",		PeepDeadWrite,		0},
+	{0, 0, 0}
+};
+
+//****************************************
+//			 Emulator memory
+//****************************************
+
+uchar PeepReadByte(PeepState *s, int addr)
+{
+	unsigned int h;
+	int n;
+
+	for (n=s->writes-1;n>=0;n--)
+	{
+		if (s->waddr[n] == addr)
+			return s->wbyte[n];
+	}
 
-		*start_ip++ = 0;
-		*start_ip++ = 0;
-		*start_ip++ = 0;
+	// Memory that hasn't been written has a value made from its address
 
-		*start_ip++ = 0;
-		*start_ip++ = 0;
-		*start_ip++ = 0;
+	h = (unsigned int) addr * 0x9e3779b1;
+	h ^= h >> 15;
+	return (uchar) (h ^ PeepSeed);
+}
+
+//****************************************
+
+void PeepWriteByte(PeepState *s, int addr, int v)
+{
+	if (s->writes >= PEEP_MAX_WRITES)
+	{
+		s->trap = 2;
 		return;
 	}
-	
-	
-	//memset(start_ip, 0, start_ip - ip);
+
+	s->waddr[s->writes] = addr;
+	s->wbyte[s->writes] = (uchar) v;
+	s->writes++;
 }
 
-#endif
+//****************************************
+
+int PeepRead(PeepState *s, int addr, int size)
+{
+	uint v = 0;
+	int n;
+
+	addr &= ~(size - 1);
+
+	for (n=size-1;n>=0;n--)
+		v = (v << 8) | PeepReadByte(s, addr + n);
+
+	if (size == 1)
+		return (signed char) v;
+
+	if (size == 2)
+		return (short) v;
+
+	return (int) v;
+}
+
+//****************************************
+
+void PeepWrite(PeepState *s, int addr, int size, int v)
+{
+	int n;
+
+	addr &= ~(size - 1);
+
+	for (n=0;n<size;n++)
+		PeepWriteByte(s, addr + n, v >> (n * 8));
+}
+
+//****************************************
+//	  Run one instruction, returns 1 if
+//	  it jumps, 2 if it leaves the block
+//****************************************
+
+int PeepExec(PeepState *s, OpcodeInfo *op)
+{
+	int *reg = s->reg;
+	int rd = op->rd;
+	int a, b;
+
+	if (op->rs < 32)
+		b = reg[op->rs];
+	else
+		b = ConstRegValue(op->rs);
 
+	a = reg[rd & 31];
 
+	switch(op->op)
+	{
+		case _NOP:														return 0;
+
+		case _LDB:	reg[rd] = PeepRead(s, b + op->imm, 1);				return 0;
+		case _LDH:	reg[rd] = PeepRead(s, b + op->imm, 2);				return 0;
+		case _LDW:	reg[rd] = PeepRead(s, b + op->imm, 4);				return 0;
+		case _STB:	PeepWrite(s, a + op->imm, 1, b);					return 0;
+		case _STH:	PeepWrite(s, a + op->imm, 2, b);					return 0;
+		case _STW:	PeepWrite(s, a + op->imm, 4, b);					return 0;
+
+		case _LDI:	reg[rd] = op->imm;									return 0;
+		case _LDR:	reg[rd] = b;										return 0;
+
+		case _ADD:	reg[rd] = a + b;									return 0;
+		case _ADDI:	reg[rd] = a + op->imm;								return 0;
+		case _MUL:	reg[rd] = a * b;									return 0;
+		case _MULI:	reg[rd] = a * op->imm;								return 0;
+		case _SUB:	reg[rd] = a - b;									return 0;
+		case _SUBI:	reg[rd] = a - op->imm;								return 0;
+		case _AND:	reg[rd] = a & b;									return 0;
+		case _ANDI:	reg[rd] = a & op->imm;								return 0;
+		case _OR:	reg[rd] = a | b;									return 0;
+		case _ORI:	reg[rd] = a | op->imm;								return 0;
+		case _XOR:	reg[rd] = a ^ b;									return 0;
+		case _XORI:	reg[rd] = a ^ op->imm;								return 0;
+
+		case _DIVU:
+		case _DIVUI:
+		case _DIV:
+		case _DIVI:
+			if (op->op == _DIVUI || op->op == _DIVI)
+				b = op->imm;
+
+			if (b == 0)
+			{
+				s->trap = 1;
+				return 2;
+			}
+
+			if (op->op == _DIVU || op->op == _DIVUI)
+				reg[rd] = (int) ((uint) a / (uint) b);
+			else if (b == -1)
+				reg[rd] = (int) (0 - (uint) a);
+			else
+				reg[rd] = a / b;
+			return 0;
+
+		case _SLL:	reg[rd] = (int) ((uint) a << (b & 31));				return 0;
+		case _SLLI:	reg[rd] = (int) ((uint) a << (op->imm & 31));		return 0;
+		case _SRA:	reg[rd] = a >> (b & 31);							return 0;
+		case _SRAI:	reg[rd] = a >> (op->imm & 31);						return 0;
+		case _SRL:	reg[rd] = (int) ((uint) a >> (b & 31));				return 0;
+		case _SRLI:	reg[rd] = (int) ((uint) a >> (op->imm & 31));		return 0;
 
-#define INTPART(addr) ((addr) >> 2)
-#define BYTEPART(addr) ((addr) & 0x3)
+		case _NOT:	reg[rd] = ~b;										return 0;
+		case _NEG:	reg[rd] = (int) (0 - (uint) b);						return 0;
+		case _XB:	reg[rd] = (signed char) b;							return 0;
+		case _XH:	reg[rd] = (short) b;								return 0;
 
-#define RBYTE(a, ret) { \
-	int addr = (a);\
-	ret = (byte)((mem_ds[INTPART(addr)] >> (BYTEPART(addr) << 3)) & 0x0ff); \
+		case _JC_EQ:	return (a == b);
+		case _JC_NE:	return (a != b);
+		case _JC_GE:	return (a >= b);
+		case _JC_GEU:	return ((uint) a >= (uint) b);
+		case _JC_GT:	return (a > b);
+		case _JC_GTU:	return ((uint) a > (uint) b);
+		case _JC_LE:	return (a <= b);
+		case _JC_LEU:	return ((uint) a <= (uint) b);
+		case _JC_LT:	return (a < b);
+		case _JC_LTU:	return ((uint) a < (uint) b);
+		case _JPI:		return 1;
+	}
+
+	return 2;
 }
 
-#define WBYTE(a, b) {\
-	int addr = (a);\
-	int shift = BYTEPART(addr) << 3;\
-	mem_ds[INTPART(addr)] = (mem_ds[INTPART(addr)] & ~(0x000000ff << shift)) |\
-	((((int)b) & 0x0ff) << shift);\
+//****************************************
+//	Where execution really continues from
+//	  instruction n. Blocks that start with
+//	removed code or a jump exit to the same
+//	  place as the instructions after them
+//****************************************
+
+int PeepCanon(int n)
+{
+	int hops;
+
+	for (hops=0;hops<PEEP_MAX_HOPS;hops++)
+	{
+		while (n < PeepCount && (!Peep[n].live || Peep[n].deleted))
+			n++;
+
+		if (n >= PeepCount || Peep[n].orig.op != _JPI)
+			return n;
+
+		n = PeepFind(Peep[n].orig.imm);
+
+		if (n < 0)
+			return -1;
+	}
+
+	return n;
 }
 
-#define RINT(addr) mem_ds[INTPART(addr)]
-#define WINT(addr, i) mem_ds[INTPART(addr)] = i;
-#define RSHORT(a, ret) {\
-	int addr = (a);\
-	ret = (short)((mem_ds[INTPART(addr)] >> (BYTEPART(addr) << 3)) & (0xffff));\
+//****************************************
+//	  Run a block, returns where it exits
+//****************************************
+
+int PeepRunBlock(PeepState *s, int start, int end, int opt)
+{
+	OpcodeInfo *op;
+	int n, r;
+
+	for (n=start;n<end;n++)
+	{
+		if (!Peep[n].live)
+			continue;
+
+		if (opt && Peep[n].deleted)
+			continue;
+
+		op = opt ? &Peep[n].op : &Peep[n].orig;
+
+		r = PeepExec(s, op);
+
+		if (s->trap)
+			return -2;
+
+		if (r == 1)
+		{
+			r = PeepFind(op->imm);
+
+			if (r < 0)
+				return -3 - op->imm;
+
+			return PeepCanon(r);
 		}
 
-#define WSHORT(a, s) {\
-	int addr = (a);\
-	int shift = BYTEPART(addr) << 3;\
-	CORE.mem_ds[INTPART(addr)] = (mem_ds[INTPART(addr)] & ~(0x0000ffff << shift)) |\
-	((((int)s) & (0xffff)) << shift);\
+		if (r == 2)
+			return PeepCount + 1 + n;
 	}
 
-//#define byte uchar
+	return PeepCanon(end);
+}
+
+//****************************************
+
+uint PeepRandom()
+{
+	PeepSeed = PeepSeed * 1103515245 + 12345;
+	return PeepSeed >> 8;
+}
 
-uchar mem_ds[100];
+//****************************************
+//	 Compare a block before and after
+//****************************************
 
-void test_1(int rs,int rd,int imm)
+int PeepVerifyBlock(int start, int end)
 {
-//	RBYTE(rs + imm, rd);
-//	x = RSHORT(rs + imm, rd);
-//	x = RINT(rs + imm);
+	static const int special[] = {0, 1, -1, 2, 4, 0x80, 0xff, 0x7fffffff, -0x7fffffff - 1};
+	static PeepState a, b;
+	int exitA, exitB;
+	int run, n, v;
+
+	for (run=0;run<PEEP_VERIFY_RUNS;run++)
+	{
+		// Registers are random, often small or equal to each other,
+		// so that conditional jumps go both ways
+
+		for (n=0;n<32;n++)
+		{
+			v = PeepRandom();
 
-	WBYTE(rd + imm, (byte)rs);
-//	WSHORT(rd + imm, (short)rs);
-//	WINT(rd + imm, RS);
+			if (v & 1)
+				v = special[(v >> 1) % (sizeof(special) / sizeof(special[0]))];
+
+			a.reg[n] = v;
+		}
+
+		a.reg[REG_zero] = 0;
+		a.trap = 0;
+		a.writes = 0;
+		b = a;
+
+		exitA = PeepRunBlock(&a, start, end, 0);
+		exitB = PeepRunBlock(&b, start, end, 1);
+
+		if (a.trap == 2 || b.trap == 2)
+			return 0;
+
+		if (exitA != exitB || a.trap != b.trap)
+			return 0;
+
+		// A division by zero stops the program, so the state doesn't matter
+
+		if (a.trap)
+			continue;
+
+		if (memcmp(a.reg, b.reg, sizeof(a.reg)) != 0)
+			return 0;
+
+		for (n=0;n<a.writes;n++)
+		{
+			if (PeepReadByte(&a, a.waddr[n]) != PeepReadByte(&b, a.waddr[n]))
+				return 0;
+		}
+
+		for (n=0;n<b.writes;n++)
+		{
+			if (PeepReadByte(&a, b.waddr[n]) != PeepReadByte(&b, b.waddr[n]))
+				return 0;
+		}
+	}
+
+	return 1;
 }
 
-/*
+//****************************************
+//	  Compare all blocks of the function
+//****************************************
 
-ReadByte
+int PeepVerify()
 {
-	return (mem_ds[i0 >> 2] >> ((i0 & 3) << 3)) & 0x0f;
-	return rd & 0xff;
+	int start = 0;
+	int n;
+
+	PeepSeed = PeepSym->Value;
+
+	for (n=0;n<PeepCount;n++)
+	{
+		if (n + 1 < PeepCount && !Peep[n + 1].label)
+			if (!Peep[n].live || !PeepEndsBlock(Peep[n].orig.op))
+				continue;
+
+		if (!PeepVerifyBlock(start, n + 1))
+		{
+			ErrorOnIP(Error_Warning, Peep[start].orig.rip, "Peephole verification failed in '%s', not optimized", PeepSym->Name);
+			return 0;
+		}
+
+		start = n + 1;
+	}
+
+	return 1;
 }
 
-public static int RBYTE(int addr)
+//****************************************
+//	  Code size after final assembly
+//****************************************
+
+int PeepSize(PeepInst *thisInst)
 {
-	return ((mem_ds[addr>>2] >> ((addr & 3) << 3)) & 0x0ff);
+	OpcodeInfo *op = &thisInst->op;
+
+	// An immediate in the constant table becomes a register
+
+	if ((op->flags & fetch_i) && op->op != _LDB && op->op != _LDH && op->op != _LDW
+		&& op->op != _STB && op->op != _STH && op->op != _STW && !PeepHasReloc(op))
+	{
+		if (ConstRegIndex(op->imm) >= 0)
+			return 3;
+
+		if (thisInst->changed)
+			return 4;
+	}
+
+	if (thisInst->changed && !(op->flags & fetch_a))
+	{
+		if (op->flags & (fetch_s | fetch_j))
+			return 3;
+	}
+
+	return op->len;
 }
 
-public static void WBYTE(int addr, int b)
+//****************************************
+//		Count live instructions
+//****************************************
+
+void PeepCountCode(int *insts, int *bytes)
 {
-	int shift = (addr & 3) << 3;
-	mem_ds[addr >> 2] = (mem_ds[addr >> 2] & ~(0x000000ff << shift)) | ((b & 0x0ff) << shift);
+	int n;
+
+	for (n=0;n<PeepCount;n++)
+	{
+		if (!Peep[n].live || Peep[n].deleted)
+			continue;
+
+		(*insts)++;
+		(*bytes) += PeepSize(&Peep[n]);
+	}
 }
 
+//****************************************
+//	   Optimize a decoded function
+//****************************************
 
-*/
\ No newline at end of file
+void Peeper(SYMBOL *sym, PeepInst *inst, int count)
+{
+	PeepPattern *pattern;
+	int pass, changed;
+	int n, p;
+
+	Peep = inst;
+	PeepCount = count;
+	PeepSym = sym;
+
+	memset(PeepFuncHits, 0, sizeof(PeepFuncHits));
+
+	PeepCountCode(&PeepInstBefore, &PeepBytesBefore);
+
+	for (pass=0;pass<PEEP_MAX_PASSES;pass++)
+	{
+		changed = 0;
+
+		for (n=0;n<count;n++)
+		{
+			for (p=0;PeepPatterns[p].name;p++)
+			{
+				if (!inst[n].live || inst[n].deleted)
+					break;
+
+				if (PeepPatterns[p].func(n))
+				{
+					PeepFuncHits[p]++;
+					changed = 1;
+				}
+			}
+		}
+
+		if (!changed)
+			break;
+	}
+
+	if (ArgPeepVerify && !PeepVerify())
+	{
+		for (n=0;n<count;n++)
+		{
+			inst[n].op = inst[n].orig;
+			inst[n].deleted = 0;
+			inst[n].changed = 0;
+		}
+
+		memset(PeepFuncHits, 0, sizeof(PeepFuncHits));
+		PeepReverted++;
+	}
+
+	for (pattern=PeepPatterns,p=0;pattern->name;pattern++,p++)
+		pattern->hits += PeepFuncHits[p];
+
+	PeepCountCode(&PeepInstAfter, &PeepBytesAfter);
+	PeepFuncs++;
+}
+
+//****************************************
+//	  Disassemble a changed instruction
+//****************************************
+
+void PeepAsmString(OpcodeInfo *thisOp, char *out)
+{
+	SYMBOL *ref;
+	char *str;
+	char c;
+
+	if (!PeepIsJump(thisOp->op))
+	{
+		DecodeAsmString(thisOp, out, 1);
+		return;
+	}
+
+	// The jump target has changed, so use the label at the new target
+
+	ref = (SYMBOL *) ArrayGet(&CodeLabelArray, thisOp->imm);
+
+	if (!ref)
+		ErrorOnIP(Error_Fatal, thisOp->rip, "(PeepAsmString) no label at jump target");
+
+	out[0] = 0;
+	SetStrCondition('1', 1);
+
+	for (str=thisOp->str;*str;str++)
+	{
+		c = *str;
+
+		switch(c)
+		{
+			case 'd':
+				DecodeAsmEmit(out, "%s", DecodeRegName(thisOp->rd, 1));
+			break;
+
+			case 's':
+				DecodeAsmEmit(out, "%s", DecodeRegName(thisOp->rs, 1));
+			break;
+
+			case 'a':
+				DecodeAsmEmit(out, "&%s<@1_%d>", ref->Name, ref->LocalScope);
+			break;
+
+			default:
+				if (isalpha(c))
+					DecodeAsmEmit(out, "%c", tolower(c));
+				else
+					DecodeAsmEmit(out, "%c", c);
+		}
+	}
+}
+
+//****************************************
+//				Statistics
+//****************************************
+
+void PeepInit()
+{
+	PeepPattern *pattern;
+
+	for (pattern=PeepPatterns;pattern->name;pattern++)
+		pattern->hits = 0;
+
+	PeepFuncs = 0;
+	PeepReverted = 0;
+	PeepInstBefore = 0;
+	PeepInstAfter = 0;
+	PeepBytesBefore = 0;
+	PeepBytesAfter = 0;
+}
+
+//****************************************
+
+void PeepReport()
+{
+	PeepPattern *pattern;
+
+	printf("Peephole: %d functions, %d -> %d instructions, %d -> %d bytes\n",
+		PeepFuncs, PeepInstBefore, PeepInstAfter, PeepBytesBefore, PeepBytesAfter);
+
+	for (pattern=PeepPatterns;pattern->name;pattern++)
+		printf("  %-24s %d\n", pattern->name, pattern->hits);
+
+	if (ArgPeepVerify)
+		printf("  %d functions failed verification\n", PeepReverted);
+}
@@ -357,6 +357,31 @@ typedef struct
 	int len;
 } OpcodeInfo;
 
+//****************************************
+//		  Peephole structures
+//****************************************
+
+typedef struct
+{
+	OpcodeInfo op;			// Instruction as it is emitted
+	OpcodeInfo orig;		// Instruction as it was decoded
+	int live;				// Not removed by code elimination
+	int label;				// A label points to this instruction
+	int deleted;
+	int changed;			// op has been rewritten
+} PeepInst;
+
+#define PEEP_MAX_WRITES		256
+
+typedef struct
+{
+	int reg[32];
+	int trap;
+	int writes;
+	int waddr[PEEP_MAX_WRITES];
+	uchar wbyte[PEEP_MAX_WRITES];
+} PeepState;
+
 //****************************************
 //		  Analyser structure
 //****************************************
@@ -678,8 +703,31 @@ enum
 	ResType_Label = 9,
 //	ResType_Media = 10,
 //	ResType_UMedia = 11
+	ResType_Atlas = 12,
+	ResType_AtlasImage = 13
 };
 
+// Image atlases
+
+#define ATLAS_MAX_IMAGES	4096
+#define ATLAS_MAX_BLOCKS	256
+
+typedef struct
+{
+	char	*FileName;
+	int		w, h;
+	int		page;		// -1 if the image is not packed
+	int		x, y;
+} ATLAS_IMAGE;
+
+typedef struct
+{
+	int		first;		// index of the first image in AtlasImages
+	int		count;
+	int		pages;
+	int		firstPage;	// resource index of the first page
+} ATLAS_BLOCK;
+
 //****************************************
 //
 //****************************************
@@ -733,6 +781,7 @@ decset(int ArgCustomConfig, 0)
 decset(int SizeConstOpt, 1)
 decset(int FarAddressing, 1)
 decset(int ArgRes, 0)
+decset(int ArgAtlas, 0)
 decset(int ArgJavaNative, 0)
 decset(int ArgBrewGen, 0)
 decset(int ArgCppGen, 0)
@@ -743,6 +792,8 @@ decset(int ArgOptimize, 1)
 decset(int Do_Elimination, 0)
 decset(int ArgDebugRebuild, 0)
 decset(int ArgSkipElim, 0)
+decset(int ArgPeephole, 0)
+decset(int ArgPeepVerify, 0)
 decset(int ArgSLD, 0)
 decset(int ArgUseStabs, 0)
 decset(int ArgWriteMeta, 0)
@@ -865,6 +916,14 @@ dec(int IndexTable[32768])
 dec(short IndexCount)
 dec(int IndexWidth)
 
+dec(ATLAS_IMAGE AtlasImages[ATLAS_MAX_IMAGES])
+dec(ATLAS_BLOCK AtlasBlocks[ATLAS_MAX_BLOCKS])
+dec(int AtlasImageCount)
+dec(int AtlasBlockCount)
+dec(int AtlasMaxWidth)
+dec(int AtlasMaxHeight)
+decset(int InAtlas, 0)
+
 // Eval
 
 dec(char xName[NAME_MAX])
@@ -953,6 +1012,7 @@ dec(ArrayStore SLD_Line_Array)
 dec(ArrayStore SLD_File_Array)
 
 dec(ArrayStore RebuildArray)
+dec(ArrayStore PeepArray)
 
 dec(ArrayStore CodeMemArray)
 dec(ArrayStore CodeMemArrayCopy)
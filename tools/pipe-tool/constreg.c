@@ -116,14 +116,24 @@ void GenRegConst()
 
 int IsConst(int v)
 {
-	int *ConstPtr;
-	int n;
-
 	// If constant optimization is off return not found
 
 	if (ArgConstOpt == 0)
 		return -1;
-			
+
+	return ConstRegIndex(v);
+}
+
+//***************************************
+//	 Find the register holding a value,
+//	   even if the optimization is off
+//***************************************
+
+int ConstRegIndex(int v)
+{
+	int *ConstPtr;
+	int n;
+
 	// If value == 0 then return reg0
 	
 	if (v == 0)
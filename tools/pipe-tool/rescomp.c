@@ -45,11 +45,13 @@ void ResourceMain()
 	ResetResource();
 
 	CurrentResource = 1;
+	ResetAtlas();
 
 	Pass = 1;
 	pass_count++;
 
 	ResourceComp();
+	CheckAtlasClosed();
 	FinalizeResource();
 
 	printf("Pass 1 - Size %d\n", ResIP);
@@ -69,11 +71,13 @@ void ResourceMain()
 	ResetResource();
 
 	CurrentResource = 1;
+	ResetAtlas();
 
 	Pass = 2;
 	pass_count++;
 
 	ResourceComp();
+	CheckAtlasClosed();
 
 	FinalizeResource();
 
@@ -727,6 +731,62 @@ short ResourceCommands()
 
 	}
 
+//------------------------------------
+//
+//------------------------------------
+
+// ResType_Atlas = 12
+// ushort width, height, count
+// count * (ushort x, y, encint len, bytes png_image)
+//
+// ResType_AtlasImage = 13
+// ushort atlas, x, y, w, h
+
+	// Without -atlas, the images in the block stay ordinary image
+	// resources, since most runtimes can't load atlases.
+
+	if (QToken(".atlas"))			// max width, max height
+	{
+		if (InAtlas)
+			Error(Error_Fatal, "'.atlas' blocks cannot be nested");
+
+		if (AtlasBlockCount >= ATLAS_MAX_BLOCKS)
+			Error(Error_Fatal, "Too many '.atlas' blocks");
+
+		SkipWhiteSpace();
+
+		AtlasMaxWidth = GetExpression();
+
+		SkipWhiteSpace();
+		NeedToken(",");
+		SkipWhiteSpace();
+
+		AtlasMaxHeight = GetExpression();
+
+		if (AtlasMaxWidth <= 0 || AtlasMaxHeight <= 0 || AtlasMaxWidth > 0xffff || AtlasMaxHeight > 0xffff)
+			Error(Error_Fatal, "Bad atlas size %d,%d", AtlasMaxWidth, AtlasMaxHeight);
+
+		if (Pass == 1)
+		{
+			AtlasBlocks[AtlasBlockCount].first = AtlasImageCount;
+			AtlasBlocks[AtlasBlockCount].count = 0;
+		}
+
+		InAtlas = 1;
+		return 1;
+	}
+
+	// must come before '.end'
+
+	if (QToken(".endatlas"))
+	{
+		if (!InAtlas)
+			Error(Error_Fatal, "'.endatlas' without '.atlas'");
+
+		EndAtlas();
+		return 1;
+	}
+
 //------------------------------------
 //
 //------------------------------------
@@ -772,6 +832,15 @@ short ResourceCommands()
 
 		filelen = FileAlloc_Len();
 
+		if (InAtlas && ArgAtlas)
+		{
+			if (AtlasImageCommand(filemem, filelen))
+			{
+				Free_File(filemem);
+				return 1;
+			}
+		}
+
 		// write the length
 		//WriteEncodedInt(filelen);
 
@@ -1317,6 +1386,310 @@ void ExportFileDependency(const char* name) {
 	fprintf(DependFile, "\t%s \\\n", EscapeSpaceDependency(AddRelPrefix(Name)));
 }
 
+//****************************************
+//			  Image atlases
+//
+// Images between '.atlas' and '.endatlas'
+// are packed into a few large pages. Each
+// image resource then only holds its page
+// and rect, and the pages are written as
+// resources of their own after the block.
+//
+// The packing is done in pass 1; pass 2
+// writes the results. The images are
+// composed into the pages by the runtime,
+// so only their sizes are needed here.
+//****************************************
+
+void ResetAtlas()
+{
+	AtlasImageCount = 0;
+	AtlasBlockCount = 0;
+	InAtlas = 0;
+}
+
+void CheckAtlasClosed()
+{
+	if (InAtlas)
+		Error(Error_Fatal, "'.atlas' without '.endatlas'");
+}
+
+//****************************************
+//	   Get the size of a PNG image
+//****************************************
+
+int GetPNGLong(unsigned char *p)
+{
+	return (p[0] << 24) | (p[1] << 16) | (p[2] << 8) | p[3];
+}
+
+int GetPNGSize(char *filemem, int filelen, int *w, int *h)
+{
+	static const unsigned char sig[8] = { 0x89, 'P', 'N', 'G', 0x0d, 0x0a, 0x1a, 0x0a };
+	unsigned char *p = (unsigned char *) filemem;
+
+	if (filelen < 24)
+		return 0;
+
+	if (memcmp(p, sig, 8) != 0 || memcmp(p + 12, "IHDR", 4) != 0)
+		return 0;
+
+	*w = GetPNGLong(p + 16);
+	*h = GetPNGLong(p + 20);
+	return 1;
+}
+
+//****************************************
+//  Handle an '.image' in an atlas block
+// returns 0 if the image is not packed
+//****************************************
+
+short AtlasImageCommand(char *filemem, int filelen)
+{
+	ATLAS_BLOCK *block = &AtlasBlocks[AtlasBlockCount];
+	ATLAS_IMAGE *img;
+	char *path;
+	int w, h;
+
+	if (Pass == 1)
+	{
+		if (AtlasImageCount >= ATLAS_MAX_IMAGES)
+			Error(Error_Fatal, "Too many atlas images");
+
+		img = &AtlasImages[AtlasImageCount];
+
+		path = AddRelPrefix(Name);
+		img->FileName = NewPtrClear(strlen(path) + 1);
+		strcpy(img->FileName, path);
+
+		img->w = img->h = 0;
+		img->page = -1;
+
+		if (GetPNGSize(filemem, filelen, &w, &h) && w > 0 && h > 0 &&
+			w <= AtlasMaxWidth && h <= AtlasMaxHeight)
+		{
+			img->w = w;
+			img->h = h;
+			img->page = 0;		// set by PackAtlas
+		}
+
+		block->count++;
+	}
+
+	img = &AtlasImages[AtlasImageCount++];
+
+	if (img->page < 0)
+	{
+		if (Pass == 2)
+			Error(Error_Warning, "'%s' is not a PNG image that fits in %dx%d, so it is not packed",
+				Name, AtlasMaxWidth, AtlasMaxHeight);
+		return 0;
+	}
+
+	ResType = ResType_AtlasImage;
+
+	WriteWord(block->firstPage + img->page);
+	WriteWord(img->x);
+	WriteWord(img->y);
+	WriteWord(img->w);
+	WriteWord(img->h);
+
+	infoprintf("%d: Atlas image '%s' page %d, xy %d,%d, wh %d,%d\n",
+		CurrentResource, Name, block->firstPage + img->page, img->x, img->y, img->w, img->h);
+	return 1;
+}
+
+//****************************************
+//	   Pack the images of a block
+//
+// First fit decreasing height, on
+// shelves spanning the width of a page.
+//****************************************
+
+typedef struct
+{
+	int page;
+	int y, h;		// top and height of the shelf
+	int x;			// first free column
+} ATLAS_SHELF;
+
+int CompareAtlasImages(const void *a, const void *b)
+{
+	ATLAS_IMAGE *ia = &AtlasImages[*(const int *) a];
+	ATLAS_IMAGE *ib = &AtlasImages[*(const int *) b];
+
+	if (ia->h != ib->h)
+		return ib->h - ia->h;
+
+	if (ia->w != ib->w)
+		return ib->w - ia->w;
+
+	return *(const int *) a - *(const int *) b;		// keep the order stable
+}
+
+void PackAtlas(ATLAS_BLOCK *block)
+{
+	ATLAS_SHELF *shelves;
+	int *pageBottom;
+	int *order;
+	int shelfCount = 0;
+	int n, i, s;
+
+	block->pages = 0;
+
+	if (block->count == 0)
+		return;
+
+	order = (int *) NewPtrClear(block->count * sizeof(int));
+	shelves = (ATLAS_SHELF *) NewPtrClear(block->count * sizeof(ATLAS_SHELF));
+	pageBottom = (int *) NewPtrClear(block->count * sizeof(int));
+
+	for (n=0;n<block->count;n++)
+		order[n] = block->first + n;
+
+	qsort(order, block->count, sizeof(int), CompareAtlasImages);
+
+	for (n=0;n<block->count;n++)
+	{
+		ATLAS_IMAGE *img = &AtlasImages[order[n]];
+
+		if (img->page < 0)
+			continue;
+
+		// Find the first shelf with room
+
+		for (s=0;s<shelfCount;s++)
+		{
+			if (img->h <= shelves[s].h && shelves[s].x + img->w <= AtlasMaxWidth)
+				break;
+		}
+
+		// Or start a new shelf, on a new page if needed
+
+		if (s == shelfCount)
+		{
+			for (i=0;i<block->pages;i++)
+			{
+				if (pageBottom[i] + img->h <= AtlasMaxHeight)
+					break;
+			}
+
+			if (i == block->pages)
+			{
+				pageBottom[i] = 0;
+				block->pages++;
+			}
+
+			shelves[s].page = i;
+			shelves[s].y = pageBottom[i];
+			shelves[s].h = img->h;
+			shelves[s].x = 0;
+			pageBottom[i] += img->h;
+			shelfCount++;
+		}
+
+		img->page = shelves[s].page;
+		img->x = shelves[s].x;
+		img->y = shelves[s].y;
+		shelves[s].x += img->w;
+	}
+
+	DisposePtr((char *) pageBottom);
+	DisposePtr((char *) shelves);
+	DisposePtr((char *) order);
+}
+
+//****************************************
+//	 Write the pages of an atlas block
+//****************************************
+
+void EndAtlas()
+{
+	ATLAS_BLOCK *block = &AtlasBlocks[AtlasBlockCount];
+	char *filemem;
+	int filelen;
+	int page, n, i;
+	int w, h, count;
+
+	// Finish the last image
+
+	if (ResType != 0)
+		FinalizeResource();
+
+	if (Pass == 1)
+	{
+		PackAtlas(block);
+		block->firstPage = CurrentResource;
+	}
+
+	if (block->firstPage != CurrentResource)
+		Error(Error_Fatal, "Atlas pages moved between passes");
+
+	for (page=0;page<block->pages;page++)
+	{
+		ResType = ResType_Atlas;
+
+		// Trim the page to the images on it
+
+		w = h = count = 0;
+
+		for (n=0;n<block->count;n++)
+		{
+			ATLAS_IMAGE *img = &AtlasImages[block->first + n];
+
+			if (img->page != page)
+				continue;
+
+			if (img->x + img->w > w)
+				w = img->x + img->w;
+
+			if (img->y + img->h > h)
+				h = img->y + img->h;
+
+			count++;
+		}
+
+		WriteWord(w);
+		WriteWord(h);
+		WriteWord(count);
+
+		for (n=0;n<block->count;n++)
+		{
+			ATLAS_IMAGE *img = &AtlasImages[block->first + n];
+
+			if (img->page != page)
+				continue;
+
+			WriteWord(img->x);
+			WriteWord(img->y);
+
+			filemem = Open_FileAlloc(img->FileName);
+
+			if (!filemem)
+			{
+				Error(Error_Fatal, "Error reading image file '%s'", img->FileName);
+				return;
+			}
+
+			filelen = FileAlloc_Len();
+
+			WriteEncodedInt(filelen);
+
+			for (i=0;i<filelen;i++)
+				WriteByte(filemem[i]);
+
+			Free_File(filemem);
+		}
+
+		infoprintf("%d: Atlas page %d, wh %d,%d, %d images\n", CurrentResource, page, w, h, count);
+
+		FinalizeResource();
+	}
+
+	AtlasBlockCount++;
+	InAtlas = 0;
+}
+
 //****************************************
 //		  Create a new resource
 // Name holds the res symbol name
@@ -6,7 +6,7 @@ require File.expand_path('../../rules/mosync_util.rb')
 work = MoSyncExe.new
 work.instance_eval do
 	@SOURCES = ["."]
-	@IGNORED_FILES = ["Emu.c", "BrewRebuild.c", "Peeper.c", "JavaCodeGen.c", "disas.c"]
+	@IGNORED_FILES = ["Emu.c", "BrewRebuild.c", "JavaCodeGen.c", "disas.c"]
 
 	@EXTRA_CFLAGS = " -Wno-strict-prototypes -Wno-missing-prototypes -Wno-old-style-definition" +
 		" -Wno-missing-noreturn -Wno-shadow -Wno-unreachable-code -Wno-write-strings -Wno-multichar" +
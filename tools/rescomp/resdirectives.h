@@ -37,7 +37,9 @@ enum
 	ResType_TileMap = 8,
 	ResType_Label = 9,
 //	ResType_Media = 10,
-//	ResType_UMedia = 11
+//	ResType_UMedia = 11,
+	ResType_Atlas = 12,
+	ResType_AtlasImage = 13
 };
 
 using namespace std;